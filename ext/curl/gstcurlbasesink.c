@@ -25,6 +25,11 @@
  * This is a network sink that uses libcurl as a client to upload data to
  * a server (e.g. a HTTP/FTP server).
  *
+ * Rendered buffers are queued for a separate transfer thread that feeds them
+ * to libcurl, so the streaming thread only blocks while the queue holds more
+ * than #GstCurlBaseSink:max-queue-bytes or #GstCurlBaseSink:max-queue-time
+ * worth of data.
+ *
  * <refsect2>
  * <title>Example launch line (upload a JPEG file to an HTTP server)</title>
  * |[
@@ -70,6 +75,8 @@
 #define DEFAULT_URL                    "localhost:5555"
 #define DEFAULT_TIMEOUT                30
 #define DEFAULT_QOS_DSCP               0
+#define DEFAULT_MAX_QUEUE_BYTES        (1024 * 1024)
+#define DEFAULT_MAX_QUEUE_TIME         0
 
 #define DSCP_MIN                       0
 #define DSCP_MAX                       63
@@ -91,7 +98,9 @@ enum
   PROP_USER_PASSWD,
   PROP_FILE_NAME,
   PROP_TIMEOUT,
-  PROP_QOS_DSCP
+  PROP_QOS_DSCP,
+  PROP_MAX_QUEUE_BYTES,
+  PROP_MAX_QUEUE_TIME
 };
 
 /* Object class function declarations */
@@ -141,6 +150,7 @@ static void gst_curl_base_sink_new_file_notify_unlocked
 static void gst_curl_base_sink_wait_for_transfer_thread_to_send_unlocked
     (GstCurlBaseSink * sink);
 static void gst_curl_base_sink_data_sent_notify (GstCurlBaseSink * sink);
+static void gst_curl_base_sink_queue_flush_unlocked (GstCurlBaseSink * sink);
 static void gst_curl_base_sink_wait_for_response (GstCurlBaseSink * sink);
 static void gst_curl_base_sink_got_response_notify (GstCurlBaseSink * sink);
 
@@ -234,6 +244,16 @@ gst_curl_base_sink_class_init (GstCurlBaseSinkClass * klass)
           "Quality of Service, differentiated services code point (0 default)",
           DSCP_MIN, DSCP_MAX, DEFAULT_QOS_DSCP,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_MAX_QUEUE_BYTES,
+      g_param_spec_uint ("max-queue-bytes", "Max. queue bytes",
+          "Max. amount of data waiting to be transferred (0=disable)",
+          0, G_MAXUINT, DEFAULT_MAX_QUEUE_BYTES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_MAX_QUEUE_TIME,
+      g_param_spec_uint64 ("max-queue-time", "Max. queue time",
+          "Max. duration of the data waiting to be transferred, in ns "
+          "(0=disable)", 0, G_MAXUINT64, DEFAULT_MAX_QUEUE_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&sinktemplate));
@@ -245,11 +265,13 @@ gst_curl_base_sink_init (GstCurlBaseSink * sink)
   sink->transfer_buf = g_malloc (sizeof (TransferBuffer));
   sink->transfer_cond = g_malloc (sizeof (TransferCondition));
   g_cond_init (&sink->transfer_cond->cond);
-  sink->transfer_cond->data_sent = FALSE;
   sink->transfer_cond->data_available = FALSE;
   sink->transfer_cond->wait_for_response = FALSE;
+  g_queue_init (&sink->queue);
   sink->timeout = DEFAULT_TIMEOUT;
   sink->qos_dscp = DEFAULT_QOS_DSCP;
+  sink->max_queue_bytes = DEFAULT_MAX_QUEUE_BYTES;
+  sink->max_queue_time = DEFAULT_MAX_QUEUE_TIME;
   sink->url = g_strdup (DEFAULT_URL);
   sink->transfer_thread_close = FALSE;
   sink->new_file = TRUE;
@@ -269,6 +291,7 @@ gst_curl_base_sink_finalize (GObject * gobject)
   }
 
   gst_curl_base_sink_transfer_cleanup (this);
+  gst_curl_base_sink_queue_flush_unlocked (this);
   g_cond_clear (&this->transfer_cond->cond);
   g_free (this->transfer_cond);
   g_free (this->transfer_buf);
@@ -290,9 +313,16 @@ gst_curl_base_sink_transfer_thread_notify_unlocked (GstCurlBaseSink * sink)
   GST_LOG ("more data to send");
 
   sink->transfer_cond->data_available = TRUE;
-  sink->transfer_cond->data_sent = FALSE;
   sink->transfer_cond->wait_for_response = TRUE;
-  g_cond_signal (&sink->transfer_cond->cond);
+  g_cond_broadcast (&sink->transfer_cond->cond);
+}
+
+void
+gst_curl_base_sink_transfer_thread_drain (GstCurlBaseSink * sink)
+{
+  GST_OBJECT_LOCK (sink);
+  gst_curl_base_sink_wait_for_transfer_thread_to_send_unlocked (sink);
+  GST_OBJECT_UNLOCK (sink);
 }
 
 void
@@ -301,7 +331,7 @@ gst_curl_base_sink_transfer_thread_close (GstCurlBaseSink * sink)
   GST_OBJECT_LOCK (sink);
   GST_LOG_OBJECT (sink, "setting transfer thread close flag");
   sink->transfer_thread_close = TRUE;
-  g_cond_signal (&sink->transfer_cond->cond);
+  g_cond_broadcast (&sink->transfer_cond->cond);
   GST_OBJECT_UNLOCK (sink);
 
   if (sink->transfer_thread != NULL) {
@@ -335,25 +365,111 @@ gst_curl_base_sink_is_live (GstCurlBaseSink * sink)
   return result;
 }
 
+static gboolean
+gst_curl_base_sink_queue_is_full_unlocked (GstCurlBaseSink * sink)
+{
+  if (sink->max_queue_bytes > 0 && sink->queued_bytes >= sink->max_queue_bytes)
+    return TRUE;
+  if (sink->max_queue_time > 0 && sink->queued_time >= sink->max_queue_time)
+    return TRUE;
+
+  return FALSE;
+}
+
+/* makes @buf the buffer the transfer thread reads from, takes ownership */
+static gboolean
+gst_curl_base_sink_transfer_buffer_set_unlocked (GstCurlBaseSink * sink,
+    GstBuffer * buf)
+{
+  g_assert (sink->transfer_buffer == NULL);
+
+  if (!gst_buffer_map (buf, &sink->transfer_map, GST_MAP_READ)) {
+    gst_buffer_unref (buf);
+    return FALSE;
+  }
+
+  sink->transfer_buffer = buf;
+  sink->transfer_buf->ptr = sink->transfer_map.data;
+  sink->transfer_buf->len = sink->transfer_map.size;
+  sink->transfer_buf->offset = 0;
+
+  return TRUE;
+}
+
+static void
+gst_curl_base_sink_transfer_buffer_release_unlocked (GstCurlBaseSink * sink)
+{
+  GstBuffer *buf = sink->transfer_buffer;
+
+  if (buf == NULL)
+    return;
+
+  sink->queued_bytes -= sink->transfer_map.size;
+  if (GST_BUFFER_DURATION_IS_VALID (buf))
+    sink->queued_time -= GST_BUFFER_DURATION (buf);
+
+  gst_buffer_unmap (buf, &sink->transfer_map);
+  gst_buffer_unref (buf);
+  sink->transfer_buffer = NULL;
+  sink->transfer_buf->ptr = NULL;
+  sink->transfer_buf->len = 0;
+  sink->transfer_buf->offset = 0;
+}
+
+/* moves on to the next queued buffer, returns FALSE when there is none */
+static gboolean
+gst_curl_base_sink_transfer_buffer_next_unlocked (GstCurlBaseSink * sink)
+{
+  GstBuffer *buf;
+
+  gst_curl_base_sink_transfer_buffer_release_unlocked (sink);
+
+  while ((buf = g_queue_pop_head (&sink->queue))) {
+    if (gst_curl_base_sink_transfer_buffer_set_unlocked (sink,
+            gst_buffer_ref (buf))) {
+      gst_buffer_unref (buf);
+      return TRUE;
+    }
+
+    GST_WARNING_OBJECT (sink, "failed to map buffer, skipping it");
+    sink->queued_bytes -= gst_buffer_get_size (buf);
+    if (GST_BUFFER_DURATION_IS_VALID (buf))
+      sink->queued_time -= GST_BUFFER_DURATION (buf);
+    gst_buffer_unref (buf);
+  }
+
+  return FALSE;
+}
+
+static void
+gst_curl_base_sink_queue_flush_unlocked (GstCurlBaseSink * sink)
+{
+  gst_curl_base_sink_transfer_buffer_release_unlocked (sink);
+  g_queue_foreach (&sink->queue, (GFunc) gst_buffer_unref, NULL);
+  g_queue_clear (&sink->queue);
+  sink->queued_bytes = 0;
+  sink->queued_time = 0;
+  sink->transfer_cond->data_available = FALSE;
+}
+
 static GstFlowReturn
 gst_curl_base_sink_render (GstBaseSink * bsink, GstBuffer * buf)
 {
   GstCurlBaseSink *sink;
-  GstMapInfo map;
-  guint8 *data;
-  size_t size;
   GstFlowReturn ret;
+  gboolean flushing = FALSE;
   gchar *error;
 
   GST_LOG ("enter render");
 
   sink = GST_CURL_BASE_SINK (bsink);
 
-  GST_OBJECT_LOCK (sink);
+  if (gst_buffer_get_size (buf) == 0) {
+    GST_LOG_OBJECT (sink, "skipping empty buffer");
+    return GST_FLOW_OK;
+  }
 
-  gst_buffer_map (buf, &map, GST_MAP_READ);
-  data = map.data;
-  size = map.size;
+  GST_OBJECT_LOCK (sink);
 
   /* check if the transfer thread has encountered problems while the
    * pipeline thread was working elsewhere */
@@ -361,8 +477,6 @@ gst_curl_base_sink_render (GstBaseSink * bsink, GstBuffer * buf)
     goto done;
   }
 
-  g_assert (sink->transfer_cond->data_available == FALSE);
-
   /* if there is no transfer thread created, lets create one */
   if (sink->transfer_thread == NULL) {
     if (!gst_curl_base_sink_transfer_start_unlocked (sink)) {
@@ -371,24 +485,46 @@ gst_curl_base_sink_render (GstBaseSink * bsink, GstBuffer * buf)
     }
   }
 
-  /* make data available for the transfer thread and notify */
-  sink->transfer_buf->ptr = data;
-  sink->transfer_buf->len = size;
-  sink->transfer_buf->offset = 0;
-  gst_curl_base_sink_transfer_thread_notify_unlocked (sink);
+  /* only block while the queue is full, the transfer thread signals every
+   * time it is done with a buffer */
+  while (gst_curl_base_sink_queue_is_full_unlocked (sink) &&
+      sink->flow_ret == GST_FLOW_OK && !sink->flushing) {
+    GST_LOG_OBJECT (sink, "queue full (%" G_GUINT64_FORMAT " bytes, %"
+        GST_TIME_FORMAT "), waiting", sink->queued_bytes,
+        GST_TIME_ARGS (sink->queued_time));
+    g_cond_wait (&sink->transfer_cond->cond, GST_OBJECT_GET_LOCK (sink));
+  }
 
-  /* wait for the transfer thread to send the data. This will be notified
-   * either when transfer is completed by the curl read callback or by
-   * the thread function if an error has occurred. */
-  gst_curl_base_sink_wait_for_transfer_thread_to_send_unlocked (sink);
+  if (sink->flushing) {
+    flushing = TRUE;
+    goto done;
+  }
+  if (sink->flow_ret != GST_FLOW_OK) {
+    goto done;
+  }
 
-done:
-  gst_buffer_unmap (buf, &map);
+  if (sink->transfer_buffer == NULL) {
+    /* the transfer thread is idle, make data available and notify */
+    if (!gst_curl_base_sink_transfer_buffer_set_unlocked (sink,
+            gst_buffer_ref (buf))) {
+      sink->error = g_strdup ("failed to map buffer");
+      sink->flow_ret = GST_FLOW_ERROR;
+      goto done;
+    }
+    gst_curl_base_sink_transfer_thread_notify_unlocked (sink);
+  } else {
+    g_queue_push_tail (&sink->queue, gst_buffer_ref (buf));
+  }
 
+  sink->queued_bytes += gst_buffer_get_size (buf);
+  if (GST_BUFFER_DURATION_IS_VALID (buf))
+    sink->queued_time += GST_BUFFER_DURATION (buf);
+
+done:
   /* Hand over error from transfer thread to streaming thread */
   error = sink->error;
   sink->error = NULL;
-  ret = sink->flow_ret;
+  ret = flushing ? GST_FLOW_FLUSHING : sink->flow_ret;
   GST_OBJECT_UNLOCK (sink);
 
   if (error != NULL) {
@@ -411,6 +547,7 @@ gst_curl_base_sink_event (GstBaseSink * bsink, GstEvent * event)
   switch (event->type) {
     case GST_EVENT_EOS:
       GST_DEBUG_OBJECT (sink, "received EOS");
+      gst_curl_base_sink_transfer_thread_drain (sink);
       gst_curl_base_sink_transfer_thread_close (sink);
       gst_curl_base_sink_wait_for_response (sink);
       break;
@@ -436,11 +573,11 @@ gst_curl_base_sink_start (GstBaseSink * bsink)
   sink = GST_CURL_BASE_SINK (bsink);
 
   /* reset flags */
-  sink->transfer_cond->data_sent = FALSE;
   sink->transfer_cond->data_available = FALSE;
   sink->transfer_cond->wait_for_response = FALSE;
   sink->transfer_thread_close = FALSE;
   sink->new_file = TRUE;
+  sink->flushing = FALSE;
   sink->flow_ret = GST_FLOW_OK;
 
   if ((sink->fdset = gst_poll_new (TRUE)) == NULL) {
@@ -460,6 +597,12 @@ gst_curl_base_sink_stop (GstBaseSink * bsink)
   GstCurlBaseSink *sink = GST_CURL_BASE_SINK (bsink);
 
   gst_curl_base_sink_transfer_thread_close (sink);
+
+  /* whatever the transfer thread did not get to is dropped */
+  GST_OBJECT_LOCK (sink);
+  gst_curl_base_sink_queue_flush_unlocked (sink);
+  GST_OBJECT_UNLOCK (sink);
+
   if (sink->fdset != NULL) {
     gst_poll_free (sink->fdset);
     sink->fdset = NULL;
@@ -478,6 +621,11 @@ gst_curl_base_sink_unlock (GstBaseSink * bsink)
   GST_LOG_OBJECT (sink, "Flushing");
   gst_poll_set_flushing (sink->fdset, TRUE);
 
+  GST_OBJECT_LOCK (sink);
+  sink->flushing = TRUE;
+  g_cond_broadcast (&sink->transfer_cond->cond);
+  GST_OBJECT_UNLOCK (sink);
+
   return TRUE;
 }
 
@@ -491,6 +639,10 @@ gst_curl_base_sink_unlock_stop (GstBaseSink * bsink)
   GST_LOG_OBJECT (sink, "No longer flushing");
   gst_poll_set_flushing (sink->fdset, FALSE);
 
+  GST_OBJECT_LOCK (sink);
+  sink->flushing = FALSE;
+  GST_OBJECT_UNLOCK (sink);
+
   return TRUE;
 }
 
@@ -538,6 +690,16 @@ gst_curl_base_sink_set_property (GObject * object, guint prop_id,
         gst_curl_base_sink_setup_dscp_unlocked (sink);
         GST_DEBUG_OBJECT (sink, "dscp set to %d", sink->qos_dscp);
         break;
+      case PROP_MAX_QUEUE_BYTES:
+        sink->max_queue_bytes = g_value_get_uint (value);
+        GST_DEBUG_OBJECT (sink, "max queue bytes set to %u",
+            sink->max_queue_bytes);
+        break;
+      case PROP_MAX_QUEUE_TIME:
+        sink->max_queue_time = g_value_get_uint64 (value);
+        GST_DEBUG_OBJECT (sink, "max queue time set to %" GST_TIME_FORMAT,
+            GST_TIME_ARGS (sink->max_queue_time));
+        break;
       default:
         GST_DEBUG_OBJECT (sink, "invalid property id %d", prop_id);
         break;
@@ -556,6 +718,8 @@ gst_curl_base_sink_set_property (GObject * object, guint prop_id,
       g_free (sink->file_name);
       sink->file_name = g_value_dup_string (value);
       GST_DEBUG_OBJECT (sink, "file_name set to %s", sink->file_name);
+      /* what is already queued still belongs to the previous file */
+      gst_curl_base_sink_wait_for_transfer_thread_to_send_unlocked (sink);
       gst_curl_base_sink_new_file_notify_unlocked (sink);
       break;
     case PROP_TIMEOUT:
@@ -567,6 +731,18 @@ gst_curl_base_sink_set_property (GObject * object, guint prop_id,
       gst_curl_base_sink_setup_dscp_unlocked (sink);
       GST_DEBUG_OBJECT (sink, "dscp set to %d", sink->qos_dscp);
       break;
+    case PROP_MAX_QUEUE_BYTES:
+      sink->max_queue_bytes = g_value_get_uint (value);
+      GST_DEBUG_OBJECT (sink, "max queue bytes set to %u",
+          sink->max_queue_bytes);
+      g_cond_broadcast (&sink->transfer_cond->cond);
+      break;
+    case PROP_MAX_QUEUE_TIME:
+      sink->max_queue_time = g_value_get_uint64 (value);
+      GST_DEBUG_OBJECT (sink, "max queue time set to %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (sink->max_queue_time));
+      g_cond_broadcast (&sink->transfer_cond->cond);
+      break;
     default:
       GST_WARNING_OBJECT (sink, "cannot set property when PLAYING");
       break;
@@ -603,6 +779,12 @@ gst_curl_base_sink_get_property (GObject * object, guint prop_id,
     case PROP_QOS_DSCP:
       g_value_set_int (value, sink->qos_dscp);
       break;
+    case PROP_MAX_QUEUE_BYTES:
+      g_value_set_uint (value, sink->max_queue_bytes);
+      break;
+    case PROP_MAX_QUEUE_TIME:
+      g_value_set_uint64 (value, sink->max_queue_time);
+      break;
     default:
       GST_DEBUG_OBJECT (sink, "invalid property id");
       break;
@@ -1204,6 +1386,9 @@ done:
    * occurred there is no response to receive, so notify the event function
    * so it doesn't block indefinitely waiting for a response. */
   if (ret != GST_FLOW_OK) {
+    GST_OBJECT_LOCK (sink);
+    gst_curl_base_sink_queue_flush_unlocked (sink);
+    GST_OBJECT_UNLOCK (sink);
     gst_curl_base_sink_data_sent_notify (sink);
     gst_curl_base_sink_got_response_notify (sink);
   }
@@ -1291,23 +1476,22 @@ gst_curl_base_sink_new_file_notify_unlocked (GstCurlBaseSink * sink)
 {
   GST_LOG ("new file name");
   sink->new_file = TRUE;
-  g_cond_signal (&sink->transfer_cond->cond);
+  g_cond_broadcast (&sink->transfer_cond->cond);
 }
 
 static void
     gst_curl_base_sink_wait_for_transfer_thread_to_send_unlocked
     (GstCurlBaseSink * sink)
 {
-  GST_LOG ("waiting for buffer send to complete");
+  GST_LOG ("waiting for queued buffers to be sent");
 
-  /* this function should not check if the transfer thread is set to be closed
-   * since that flag only can be set by the EOS event (by the pipeline thread).
-   * This can therefore never happen while this function is running since this
-   * function also is called by the pipeline thread (in the render function) */
-  while (!sink->transfer_cond->data_sent) {
+  /* the transfer thread keeps data_available set until it runs out of
+   * queued buffers, and notifies when it stops because of an error */
+  while (sink->transfer_cond->data_available && sink->transfer_thread &&
+      sink->flow_ret == GST_FLOW_OK && !sink->flushing) {
     g_cond_wait (&sink->transfer_cond->cond, GST_OBJECT_GET_LOCK (sink));
   }
-  GST_LOG ("buffer send completed");
+  GST_LOG ("queued buffers sent");
 }
 
 static void
@@ -1315,9 +1499,9 @@ gst_curl_base_sink_data_sent_notify (GstCurlBaseSink * sink)
 {
   GST_LOG ("transfer completed");
   GST_OBJECT_LOCK (sink);
-  sink->transfer_cond->data_available = FALSE;
-  sink->transfer_cond->data_sent = TRUE;
-  g_cond_signal (&sink->transfer_cond->cond);
+  if (!gst_curl_base_sink_transfer_buffer_next_unlocked (sink))
+    sink->transfer_cond->data_available = FALSE;
+  g_cond_broadcast (&sink->transfer_cond->cond);
   GST_OBJECT_UNLOCK (sink);
 }
 
@@ -1342,7 +1526,7 @@ gst_curl_base_sink_got_response_notify (GstCurlBaseSink * sink)
 
   GST_OBJECT_LOCK (sink);
   sink->transfer_cond->wait_for_response = FALSE;
-  g_cond_signal (&sink->transfer_cond->cond);
+  g_cond_broadcast (&sink->transfer_cond->cond);
   GST_OBJECT_UNLOCK (sink);
 }
 
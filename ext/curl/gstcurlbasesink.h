@@ -53,7 +53,6 @@ struct _TransferBuffer
 struct _TransferCondition
 {
   GCond cond;
-  gboolean data_sent;
   gboolean data_available;
   gboolean wait_for_response;
 };
@@ -73,6 +72,14 @@ struct _GstCurlBaseSink
   GstFlowReturn flow_ret;
   TransferBuffer *transfer_buf;
   TransferCondition *transfer_cond;
+  GstBuffer *transfer_buffer;
+  GstMapInfo transfer_map;
+  GQueue queue;
+  guint64 queued_bytes;
+  GstClockTime queued_time;
+  guint max_queue_bytes;
+  guint64 max_queue_time;
+  gboolean flushing;
   gint num_buffers_per_packet;
   gint timeout;
   gchar *url;
@@ -111,6 +118,7 @@ GType gst_curl_base_sink_get_type (void);
 
 void gst_curl_base_sink_transfer_thread_notify_unlocked
     (GstCurlBaseSink * sink);
+void gst_curl_base_sink_transfer_thread_drain (GstCurlBaseSink * sink);
 void gst_curl_base_sink_transfer_thread_close (GstCurlBaseSink * sink);
 void gst_curl_base_sink_set_live (GstCurlBaseSink * sink, gboolean live);
 gboolean gst_curl_base_sink_is_live (GstCurlBaseSink * sink);
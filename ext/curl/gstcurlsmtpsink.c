@@ -198,6 +198,8 @@ gst_curl_smtp_sink_event (GstBaseSink * bsink, GstEvent * event)
   switch (event->type) {
     case GST_EVENT_EOS:
       GST_DEBUG_OBJECT (sink, "received EOS");
+      /* encode whatever is still queued before closing the mail */
+      gst_curl_base_sink_transfer_thread_drain (bcsink);
       gst_curl_base_sink_set_live (bcsink, FALSE);
 
       GST_OBJECT_LOCK (sink);
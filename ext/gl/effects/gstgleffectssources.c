@@ -85,9 +85,7 @@ const gchar *mirror_fragment_source_gles2 =
   "uniform sampler2D tex;"
   "void main () {"
   "  vec2 texturecoord = v_texcoord.xy;"
-  "  float normcoord = texturecoord.x - 0.5;"
-  "  normcoord *= sign (normcoord);"
-  "  texturecoord.x = normcoord + 0.5;"
+  MIRROR_WARP_SOURCE
   "  gl_FragColor = texture2D (tex, texturecoord);"
   "}";
 
@@ -99,11 +97,7 @@ const gchar *squeeze_fragment_source_gles2 =
   "uniform sampler2D tex;"
   "void main () {"
   "  vec2 texturecoord = v_texcoord.xy;"
-  "  vec2 normcoord = texturecoord - 0.5;"
-  "  float r = length (normcoord);"
-  "  r = pow(r, 0.40)*1.3;"
-  "  normcoord = normcoord / r;"
-  "  texturecoord = (normcoord + 0.5);"
+  SQUEEZE_WARP_SOURCE
   "  gl_FragColor = texture2D (tex, texturecoord);"
   "}";
 
@@ -114,12 +108,8 @@ const gchar *stretch_fragment_source_gles2 =
   "varying vec2 v_texcoord;"
   "uniform sampler2D tex;"
   "void main () {"
-	"  vec2 texturecoord = v_texcoord.xy;"
-  "  vec2 normcoord;"
-  "  normcoord = texturecoord - 0.5;"
-  "  float r = length (normcoord);"
-  "  normcoord *= 2.0 - smoothstep(0.0, 0.35, r);"
-  "  texturecoord = normcoord + 0.5;"
+  "  vec2 texturecoord = v_texcoord.xy;"
+  STRETCH_WARP_SOURCE
   "  gl_FragColor = texture2D (tex, texturecoord);"
   "}";
 
@@ -131,13 +121,7 @@ const gchar *tunnel_fragment_source_gles2 =
   "uniform sampler2D tex;"
   "void main () {"
   "  vec2 texturecoord = v_texcoord.xy;"
-  "  vec2 normcoord;"
-  /* little trick with normalized coords to obtain a circle with
-   * rect textures */
-  "  normcoord = (texturecoord - 0.5);"
-  "  float r = length(normcoord);"
-  "  normcoord *= clamp (r, 0.0, 0.275) / r;"
-  "  texturecoord = normcoord + 0.5;"
+  TUNNEL_WARP_SOURCE
   "  gl_FragColor = texture2D (tex, texturecoord);"
   "}";
 
@@ -149,11 +133,7 @@ const gchar *fisheye_fragment_source_gles2 =
   "uniform sampler2D tex;"
   "void main () {"
   "  vec2 texturecoord = v_texcoord.xy;"
-  "  vec2 normcoord;"
-  "  normcoord = texturecoord - 0.5;"
-  "  float r = length (normcoord);"
-  "  normcoord *= r * sqrt(2);"
-  "  texturecoord = normcoord + 0.5;"
+  FISHEYE_WARP_SOURCE
   "  gl_FragColor = texture2D (tex, texturecoord);"
   "}";
 
@@ -162,21 +142,10 @@ const gchar *twirl_fragment_source_gles2 =
   "precision mediump float;\n"
   "#endif\n"
   "varying vec2 v_texcoord;"
-	"uniform sampler2D tex;"
+  "uniform sampler2D tex;"
   "void main () {"
   "  vec2 texturecoord = v_texcoord.xy;"
-  "  vec2 normcoord;"
-  "  normcoord = texturecoord - 0.5;"
-  "  float r = length (normcoord);"
-  /* calculate rotation angle: maximum (about pi/2) at the origin and
-   * gradually decrease it up to 0.6 of each quadrant */
-  "  float phi = (1.0 - smoothstep (0.0, 0.3, r)) * 1.6;"
-  /* precalculate sin phi and cos phi, save some alu */
-  "  float s = sin(phi);"
-  "  float c = cos(phi);"
-  /* rotate */
-  "  normcoord *= mat2(c, s, -s, c);"
-  "  texturecoord = normcoord + 0.5;"
+  TWIRL_WARP_SOURCE
   "  gl_FragColor = texture2D (tex, texturecoord);"
   "}";
 
@@ -188,11 +157,7 @@ const gchar *bulge_fragment_source_gles2 =
   "uniform sampler2D tex;"
   "void main () {"
   "  vec2 texturecoord = v_texcoord.xy;"
-  "  vec2 normcoord;"
-  "  normcoord = texturecoord - 0.5;"
-  "  float r =  length (normcoord);"
-  "  normcoord *= smoothstep (-0.05, 0.25, r);"
-  "  texturecoord = normcoord + 0.5;"
+  BULGE_WARP_SOURCE
   "  gl_FragColor = texture2D (tex, texturecoord);"
   "}";
 
@@ -204,12 +169,7 @@ const gchar *square_fragment_source_gles2 =
   "uniform sampler2D tex;"
   "void main () {"
   "  vec2 texturecoord = v_texcoord.xy;"
-  "  vec2 normcoord;"
-  "  normcoord = texturecoord - 0.5;"
-  "  float r = length (normcoord);"
-  "  normcoord *= 1.0 + smoothstep(0.125, 0.25, abs(normcoord));"
-  "  normcoord /= 2.0; /* zoom amount */"
-  "  texturecoord = normcoord + 0.5;"
+  SQUARE_WARP_SOURCE
   "  gl_FragColor = texture2D (tex, texturecoord);"
   "}";
 
@@ -443,26 +403,9 @@ const gchar *sin_fragment_source_gles2 =
   "varying vec2 v_texcoord;"
   "uniform sampler2D tex;"
   "void main () {"
-  "  vec4 color = texture2D (tex, vec2(v_texcoord.xy));"
-  "  float luma = dot(color.rgb, vec3(0.2125, 0.7154, 0.0721));"
-/* calculate hue with the Preucil formula */
-  "  float cosh = color.r - 0.5*(color.g + color.b);"
-/* sqrt(3)/2 = 0.866 */
-  "  float sinh = 0.866*(color.g - color.b);"
-/* hue = atan2 h */
-  "  float sch = (1.0-sinh)*cosh;"
-/* ok this is a little trick I came up because I didn't find any
- * detailed proof of the Preucil formula. The issue is that tan(h) is
- * pi-periodic so the smoothstep thing gives both reds (h = 0) and
- * cyans (h = 180). I don't want to use atan since it requires
- * branching and doesn't work on i915. So take only the right half of
- * the circle where cosine is positive */
-/* take a slightly purple color trying to get rid of human skin reds */
-/* tanh = +-1.0 for h = +-45, where yellow=60, magenta=-60 */
-  "  float a = smoothstep (0.3, 1.0, sch);"
-  "  float b = smoothstep (-0.4, -0.1, sinh);"
-  "  float mix = a * b;"
-  "  gl_FragColor = color * mix + luma * (1.0 - mix);"
+  "  vec4 color = texture2D (tex, v_texcoord.xy);"
+  SIN_COLOR_SOURCE
+  "  gl_FragColor = color;"
   "}";
 
 const gchar *interpolate_fragment_source =
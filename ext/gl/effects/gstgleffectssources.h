@@ -21,6 +21,85 @@
 #ifndef __GST_GL_EFFECTS_SOURCES_H__
 #define __GST_GL_EFFECTS_SOURCES_H__
 
+/* The bodies of the effects that only move the texture coordinate, as
+ * statements on a vec2 texturecoord, and of the ones that only change the
+ * colour, as statements on a vec4 color. glfilterchain chains them in a
+ * single shader. */
+/* *INDENT-OFF* */
+#define MIRROR_WARP_SOURCE \
+  "  float normcoord = texturecoord.x - 0.5;\n" \
+  "  normcoord *= sign (normcoord);\n" \
+  "  texturecoord.x = normcoord + 0.5;\n"
+
+#define SQUEEZE_WARP_SOURCE \
+  "  vec2 normcoord = texturecoord - 0.5;\n" \
+  "  float r = length (normcoord);\n" \
+  "  r = pow (r, 0.40) * 1.3;\n" \
+  "  normcoord = normcoord / r;\n" \
+  "  texturecoord = normcoord + 0.5;\n"
+
+#define STRETCH_WARP_SOURCE \
+  "  vec2 normcoord = texturecoord - 0.5;\n" \
+  "  float r = length (normcoord);\n" \
+  "  normcoord *= 2.0 - smoothstep (0.0, 0.35, r);\n" \
+  "  texturecoord = normcoord + 0.5;\n"
+
+/* little trick with normalized coords to obtain a circle with rect
+ * textures */
+#define TUNNEL_WARP_SOURCE \
+  "  vec2 normcoord = texturecoord - 0.5;\n" \
+  "  float r = length (normcoord);\n" \
+  "  normcoord *= clamp (r, 0.0, 0.275) / r;\n" \
+  "  texturecoord = normcoord + 0.5;\n"
+
+#define FISHEYE_WARP_SOURCE \
+  "  vec2 normcoord = texturecoord - 0.5;\n" \
+  "  float r = length (normcoord);\n" \
+  "  normcoord *= r * sqrt (2.0);\n" \
+  "  texturecoord = normcoord + 0.5;\n"
+
+/* the rotation angle is maximum (about pi/2) at the origin and gradually
+ * decreases up to 0.6 of each quadrant */
+#define TWIRL_WARP_SOURCE \
+  "  vec2 normcoord = texturecoord - 0.5;\n" \
+  "  float r = length (normcoord);\n" \
+  "  float phi = (1.0 - smoothstep (0.0, 0.3, r)) * 1.6;\n" \
+  "  float s = sin (phi);\n" \
+  "  float c = cos (phi);\n" \
+  "  normcoord *= mat2 (c, s, -s, c);\n" \
+  "  texturecoord = normcoord + 0.5;\n"
+
+#define BULGE_WARP_SOURCE \
+  "  vec2 normcoord = texturecoord - 0.5;\n" \
+  "  float r = length (normcoord);\n" \
+  "  normcoord *= smoothstep (-0.05, 0.25, r);\n" \
+  "  texturecoord = normcoord + 0.5;\n"
+
+/* the division is the zoom amount */
+#define SQUARE_WARP_SOURCE \
+  "  vec2 normcoord = texturecoord - 0.5;\n" \
+  "  normcoord *= 1.0 + smoothstep (0.125, 0.25, abs (normcoord));\n" \
+  "  normcoord /= 2.0;\n" \
+  "  texturecoord = normcoord + 0.5;\n"
+
+/* Keeps the reds and desaturates everything else. The hue is calculated
+ * with the Preucil formula, sqrt(3)/2 = 0.866 and hue = atan2 h. tan(h) is
+ * pi-periodic so the smoothstep gives both reds (h = 0) and cyans
+ * (h = 180), and atan requires branching and doesn't work on i915, so only
+ * the right half of the circle where the cosine is positive is taken. A
+ * slightly purple colour tries to get rid of human skin reds, tanh = +-1.0
+ * for h = +-45, where yellow = 60 and magenta = -60 */
+#define SIN_COLOR_SOURCE \
+  "  float luma = dot (color.rgb, vec3 (0.2125, 0.7154, 0.0721));\n" \
+  "  float cosh = color.r - 0.5 * (color.g + color.b);\n" \
+  "  float sinh = 0.866 * (color.g - color.b);\n" \
+  "  float sch = (1.0 - sinh) * cosh;\n" \
+  "  float a = smoothstep (0.3, 1.0, sch);\n" \
+  "  float b = smoothstep (-0.4, -0.1, sinh);\n" \
+  "  float m = a * b;\n" \
+  "  color = color * m + luma * (1.0 - m);\n"
+/* *INDENT-ON* */
+
 extern const gchar *mirror_fragment_source_gles2;
 extern const gchar *squeeze_fragment_source_gles2;
 extern const gchar *stretch_fragment_source_gles2;
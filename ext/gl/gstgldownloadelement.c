@@ -25,6 +25,12 @@
 #include <gst/gl/gl.h>
 #include "gstgldownloadelement.h"
 
+#if GST_GL_HAVE_DMABUF
+#include <unistd.h>
+#include <gst/allocators/gstdmabuf.h>
+#include <gst/gl/egl/gsteglimagememory.h>
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (gst_gl_download_element_debug);
 #define GST_CAT_DEFAULT gst_gl_download_element_debug
 
@@ -34,6 +40,27 @@ G_DEFINE_TYPE_WITH_CODE (GstGLDownloadElement, gst_gl_download_element,
     GST_DEBUG_CATEGORY_INIT (gst_gl_download_element_debug, "gldownloadelement",
         0, "download element"););
 
+#define DEFAULT_LATENCY 0
+#define DEFAULT_EXPORT_DMABUF FALSE
+
+enum
+{
+  PROP_0,
+  PROP_LATENCY,
+  PROP_EXPORT_DMABUF
+};
+
+static void gst_gl_download_element_finalize (GObject * object);
+static void gst_gl_download_element_set_property (GObject * object,
+    guint prop_id, const GValue * value, GParamSpec * pspec);
+static void gst_gl_download_element_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec);
+static gboolean gst_gl_download_element_stop (GstBaseTransform * bt);
+static gboolean gst_gl_download_element_sink_event (GstBaseTransform * bt,
+    GstEvent * event);
+static gboolean gst_gl_download_element_query (GstBaseTransform * bt,
+    GstPadDirection direction, GstQuery * query);
+
 static gboolean gst_gl_download_element_get_unit_size (GstBaseTransform * trans,
     GstCaps * caps, gsize * size);
 static GstCaps *gst_gl_download_element_transform_caps (GstBaseTransform * bt,
@@ -45,6 +72,9 @@ gst_gl_download_element_prepare_output_buffer (GstBaseTransform * bt,
     GstBuffer * buffer, GstBuffer ** outbuf);
 static GstFlowReturn gst_gl_download_element_transform (GstBaseTransform * bt,
     GstBuffer * buffer, GstBuffer * outbuf);
+static GstFlowReturn
+gst_gl_download_element_generate_output (GstBaseTransform * bt,
+    GstBuffer ** outbuf);
 
 static GstStaticPadTemplate gst_gl_download_element_src_pad_template =
     GST_STATIC_PAD_TEMPLATE ("src",
@@ -63,6 +93,11 @@ gst_gl_download_element_class_init (GstGLDownloadElementClass * klass)
 {
   GstBaseTransformClass *bt_class = GST_BASE_TRANSFORM_CLASS (klass);
   GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_gl_download_element_finalize;
+  gobject_class->set_property = gst_gl_download_element_set_property;
+  gobject_class->get_property = gst_gl_download_element_get_property;
 
   bt_class->transform_caps = gst_gl_download_element_transform_caps;
   bt_class->set_caps = gst_gl_download_element_set_caps;
@@ -70,9 +105,42 @@ gst_gl_download_element_class_init (GstGLDownloadElementClass * klass)
   bt_class->prepare_output_buffer =
       gst_gl_download_element_prepare_output_buffer;
   bt_class->transform = gst_gl_download_element_transform;
+  bt_class->generate_output = gst_gl_download_element_generate_output;
+  bt_class->sink_event = gst_gl_download_element_sink_event;
+  bt_class->query = gst_gl_download_element_query;
+  bt_class->stop = gst_gl_download_element_stop;
 
   bt_class->passthrough_on_same_caps = TRUE;
 
+  /**
+   * GstGLDownloadElement:latency:
+   *
+   * Number of frames to hold back while their readback into system memory
+   * completes.  With 0 the CPU waits for every frame as soon as it is
+   * mapped, otherwise the transfer of each frame is started when it arrives
+   * and the frame is only pushed downstream @latency frames later.
+   */
+  g_object_class_install_property (gobject_class, PROP_LATENCY,
+      g_param_spec_uint ("latency", "Latency",
+          "Number of frames to delay the output by while they are downloaded",
+          0, 16, DEFAULT_LATENCY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstGLDownloadElement:export-dmabuf:
+   *
+   * Instead of reading the textures back, export them as dmabufs when
+   * downstream asks for system memory, e.g. for waylandsink.  The
+   * buffers can still be mapped, but mapping them is usually slower than
+   * a readback.  Only available with EGL implementations supporting
+   * EGL_MESA_image_dma_buf_export, otherwise the textures are read back
+   * as usual.
+   */
+  g_object_class_install_property (gobject_class, PROP_EXPORT_DMABUF,
+      g_param_spec_boolean ("export-dmabuf", "Export dmabuf",
+          "Export the textures as dmabufs instead of downloading them",
+          DEFAULT_EXPORT_DMABUF, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&gst_gl_download_element_src_pad_template));
   gst_element_class_add_pad_template (element_class,
@@ -88,17 +156,110 @@ gst_gl_download_element_init (GstGLDownloadElement * download)
 {
   gst_base_transform_set_prefer_passthrough (GST_BASE_TRANSFORM (download),
       TRUE);
+
+  download->latency = DEFAULT_LATENCY;
+  download->export_dmabuf = DEFAULT_EXPORT_DMABUF;
+  g_queue_init (&download->pending);
+}
+
+static void
+gst_gl_download_element_finalize (GObject * object)
+{
+  GstGLDownloadElement *download = GST_GL_DOWNLOAD_ELEMENT (object);
+
+  g_queue_foreach (&download->pending, (GFunc) gst_buffer_unref, NULL);
+  g_queue_clear (&download->pending);
+
+  if (download->dmabuf_allocator) {
+    gst_object_unref (download->dmabuf_allocator);
+    download->dmabuf_allocator = NULL;
+  }
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_gl_download_element_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstGLDownloadElement *download = GST_GL_DOWNLOAD_ELEMENT (object);
+
+  switch (prop_id) {
+    case PROP_LATENCY:
+      GST_OBJECT_LOCK (download);
+      download->latency = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (download);
+      gst_element_post_message (GST_ELEMENT (download),
+          gst_message_new_latency (GST_OBJECT (download)));
+      break;
+    case PROP_EXPORT_DMABUF:
+      GST_OBJECT_LOCK (download);
+      download->export_dmabuf = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (download);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_gl_download_element_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstGLDownloadElement *download = GST_GL_DOWNLOAD_ELEMENT (object);
+
+  switch (prop_id) {
+    case PROP_LATENCY:
+      GST_OBJECT_LOCK (download);
+      g_value_set_uint (value, download->latency);
+      GST_OBJECT_UNLOCK (download);
+      break;
+    case PROP_EXPORT_DMABUF:
+      GST_OBJECT_LOCK (download);
+      g_value_set_boolean (value, download->export_dmabuf);
+      GST_OBJECT_UNLOCK (download);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+_clear_pending (GstGLDownloadElement * download)
+{
+  GstBuffer *buf;
+
+  while ((buf = g_queue_pop_head (&download->pending)))
+    gst_buffer_unref (buf);
+}
+
+static gboolean
+gst_gl_download_element_stop (GstBaseTransform * bt)
+{
+  _clear_pending (GST_GL_DOWNLOAD_ELEMENT (bt));
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->stop (bt);
 }
 
 static gboolean
 gst_gl_download_element_set_caps (GstBaseTransform * bt, GstCaps * in_caps,
     GstCaps * out_caps)
 {
+  GstGLDownloadElement *download = GST_GL_DOWNLOAD_ELEMENT (bt);
+  GstCapsFeatures *features;
   GstVideoInfo out_info;
 
   if (!gst_video_info_from_caps (&out_info, out_caps))
     return FALSE;
 
+  features = gst_caps_get_features (out_caps, 0);
+  download->do_download = !features || gst_caps_features_contains (features,
+      GST_CAPS_FEATURE_MEMORY_SYSTEM_MEMORY);
+  download->out_info = out_info;
+  download->dmabuf_failed = FALSE;
+
   return TRUE;
 }
 
@@ -193,3 +354,340 @@ gst_gl_download_element_transform (GstBaseTransform * bt,
 {
   return GST_FLOW_OK;
 }
+
+/* Starts reading back the textures of @inbuf into their PBOs and fences
+ * the transfer so that it can be waited for later without blocking the
+ * GL thread on the whole pipeline */
+static GstBuffer *
+_start_download (GstGLDownloadElement * download, GstBuffer * inbuf)
+{
+  GstGLContext *context = GST_GL_BASE_FILTER (download)->context;
+  GstGLSyncMeta *sync_meta;
+  gint i, n;
+
+  n = gst_buffer_n_memory (inbuf);
+  for (i = 0; i < n; i++) {
+    GstMemory *mem = gst_buffer_peek_memory (inbuf, i);
+
+    if (gst_is_gl_memory (mem))
+      gst_gl_memory_download_transfer ((GstGLMemory *) mem);
+  }
+
+  inbuf = gst_buffer_make_writable (inbuf);
+  sync_meta = gst_buffer_get_gl_sync_meta (inbuf);
+  if (!sync_meta)
+    sync_meta = gst_buffer_add_gl_sync_meta (context, inbuf);
+  gst_gl_sync_meta_set_sync_point (sync_meta, context);
+
+  return inbuf;
+}
+
+static GstBuffer *
+_finish_download (GstGLDownloadElement * download)
+{
+  GstBuffer *buf = g_queue_pop_head (&download->pending);
+  GstGLSyncMeta *sync_meta = gst_buffer_get_gl_sync_meta (buf);
+
+  if (sync_meta)
+    gst_gl_sync_meta_wait (sync_meta, GST_GL_BASE_FILTER (download)->context);
+
+  return buf;
+}
+
+static GstFlowReturn
+_drain (GstGLDownloadElement * download)
+{
+  GstPad *srcpad = GST_BASE_TRANSFORM_SRC_PAD (download);
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  while (!g_queue_is_empty (&download->pending)) {
+    GstBuffer *buf = _finish_download (download);
+
+    if (ret == GST_FLOW_OK)
+      ret = gst_pad_push (srcpad, buf);
+    else
+      gst_buffer_unref (buf);
+  }
+
+  return ret;
+}
+
+#if GST_GL_HAVE_DMABUF
+/* The dmabuf a texture was exported as is kept on its memory, the GL
+ * memories upstream are recycled through a pool */
+typedef struct
+{
+  gint fd;
+  gint stride;
+  gsize offset;
+  gsize size;
+} DmabufExport;
+
+static GQuark
+_dmabuf_export_quark (void)
+{
+  static GQuark quark = 0;
+
+  if (!quark)
+    quark = g_quark_from_static_string ("GstGLDownloadDmabufExport");
+
+  return quark;
+}
+
+static void
+_dmabuf_export_free (DmabufExport * export)
+{
+  close (export->fd);
+  g_slice_free (DmabufExport, export);
+}
+
+struct ExportDmabuf
+{
+  GstBuffer *buffer;
+  GstVideoInfo *info;
+  DmabufExport *exports[GST_VIDEO_MAX_PLANES];
+  gboolean result;
+};
+
+static void
+_export_dmabuf_gl_thread (GstGLContext * context, struct ExportDmabuf *data)
+{
+  guint i, n = gst_buffer_n_memory (data->buffer);
+
+  data->result = TRUE;
+
+  for (i = 0; i < n && data->result; i++) {
+    GstMemory *mem = gst_buffer_peek_memory (data->buffer, i);
+    GstGLMemory *gl_mem;
+    DmabufExport *export;
+    GstMapInfo map_info;
+    off_t size;
+
+    if (!gst_is_gl_memory (mem)) {
+      data->result = FALSE;
+      break;
+    }
+
+    /* the exported layout follows the texture, which has to match what was
+     * negotiated downstream */
+    gl_mem = (GstGLMemory *) mem;
+    if (GST_VIDEO_INFO_FORMAT (&gl_mem->info) !=
+        GST_VIDEO_INFO_FORMAT (data->info)
+        || GST_VIDEO_INFO_WIDTH (&gl_mem->info) !=
+        GST_VIDEO_INFO_WIDTH (data->info)
+        || GST_VIDEO_INFO_HEIGHT (&gl_mem->info) !=
+        GST_VIDEO_INFO_HEIGHT (data->info) || gl_mem->plane != i) {
+      data->result = FALSE;
+      break;
+    }
+
+    /* makes sure the texture holds the latest contents */
+    if (!gst_memory_map (mem, &map_info, GST_MAP_READ | GST_MAP_GL)) {
+      data->result = FALSE;
+      break;
+    }
+    gst_memory_unmap (mem, &map_info);
+
+    export = gst_mini_object_get_qdata (GST_MINI_OBJECT (mem),
+        _dmabuf_export_quark ());
+    if (!export) {
+      export = g_slice_new (DmabufExport);
+
+      if (!gst_egl_image_memory_export_dmabuf (gl_mem, &export->fd,
+              &export->stride, &export->offset)) {
+        g_slice_free (DmabufExport, export);
+        data->result = FALSE;
+        break;
+      }
+
+      size = lseek (export->fd, 0, SEEK_END);
+      if (size > 0)
+        export->size = size;
+      else
+        export->size = export->offset + export->stride *
+            GST_VIDEO_INFO_COMP_HEIGHT (&gl_mem->info, gl_mem->plane);
+
+      gst_mini_object_set_qdata (GST_MINI_OBJECT (mem),
+          _dmabuf_export_quark (), export,
+          (GDestroyNotify) _dmabuf_export_free);
+    }
+
+    data->exports[i] = export;
+  }
+
+  /* there is no way to hand a GL fence to the consumer, so the rendering
+   * has to be complete before the dmabufs leave the GL pipeline */
+  if (data->result)
+    context->gl_vtable->Finish ();
+}
+
+/* Returns a buffer holding the textures of @inbuf exported as dmabufs, or
+ * %NULL when they cannot be exported */
+static GstBuffer *
+_export_dmabuf (GstGLDownloadElement * download, GstBuffer * inbuf)
+{
+  GstGLContext *context = GST_GL_BASE_FILTER (download)->context;
+  GstVideoInfo *info = &download->out_info;
+  gsize offset[GST_VIDEO_MAX_PLANES];
+  gint stride[GST_VIDEO_MAX_PLANES];
+  struct ExportDmabuf data = { inbuf, info, {NULL,}, FALSE };
+  GstBuffer *outbuf;
+  gsize total = 0;
+  guint i, n;
+
+  n = gst_buffer_n_memory (inbuf);
+  if (n != GST_VIDEO_INFO_N_PLANES (info))
+    return NULL;
+
+  gst_gl_context_thread_add (context,
+      (GstGLContextThreadFunc) _export_dmabuf_gl_thread, &data);
+  if (!data.result)
+    return NULL;
+
+  if (!download->dmabuf_allocator)
+    download->dmabuf_allocator = gst_dmabuf_allocator_new ();
+
+  outbuf = gst_buffer_new ();
+  for (i = 0; i < n; i++) {
+    DmabufExport *export = data.exports[i];
+    GstMemory *mem;
+
+    /* the memories own their descriptor, the cached one stays with the
+     * texture */
+    mem = gst_dmabuf_allocator_alloc (download->dmabuf_allocator,
+        dup (export->fd), export->size);
+    gst_memory_resize (mem, export->offset, export->size - export->offset);
+    gst_buffer_append_memory (outbuf, mem);
+
+    offset[i] = total;
+    stride[i] = export->stride;
+    total += export->size - export->offset;
+  }
+
+  gst_buffer_add_video_meta_full (outbuf, 0, GST_VIDEO_INFO_FORMAT (info),
+      GST_VIDEO_INFO_WIDTH (info), GST_VIDEO_INFO_HEIGHT (info), n, offset,
+      stride);
+  gst_buffer_copy_into (outbuf, inbuf,
+      GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+  /* the textures must not be reused upstream while the dmabufs are */
+  gst_buffer_add_parent_buffer_meta (outbuf, inbuf);
+
+  return outbuf;
+}
+#endif
+
+static GstFlowReturn
+gst_gl_download_element_generate_output (GstBaseTransform * bt,
+    GstBuffer ** outbuf)
+{
+  GstGLDownloadElement *download = GST_GL_DOWNLOAD_ELEMENT (bt);
+  gboolean export_dmabuf;
+  guint latency;
+
+  GST_OBJECT_LOCK (download);
+  latency = download->latency;
+  export_dmabuf = download->export_dmabuf;
+  GST_OBJECT_UNLOCK (download);
+
+  if (download->do_download && export_dmabuf && !download->dmabuf_failed
+      && bt->queued_buf && g_queue_is_empty (&download->pending)) {
+#if GST_GL_HAVE_DMABUF
+    GstBuffer *exported = _export_dmabuf (download, bt->queued_buf);
+
+    if (exported) {
+      gst_buffer_unref (bt->queued_buf);
+      bt->queued_buf = NULL;
+      *outbuf = exported;
+
+      return GST_FLOW_OK;
+    }
+#endif
+
+    GST_INFO_OBJECT (download, "cannot export dmabufs, downloading instead");
+    download->dmabuf_failed = TRUE;
+  }
+
+  if (!download->do_download || (latency == 0
+          && g_queue_is_empty (&download->pending)))
+    return GST_BASE_TRANSFORM_CLASS (parent_class)->generate_output (bt,
+        outbuf);
+
+  *outbuf = NULL;
+
+  if (bt->queued_buf) {
+    GstBuffer *inbuf = bt->queued_buf;
+
+    bt->queued_buf = NULL;
+    g_queue_push_tail (&download->pending, _start_download (download, inbuf));
+  }
+
+  /* chain () calls us again until we stop returning buffers, which also
+   * drains the excess when the latency was lowered */
+  if (g_queue_get_length (&download->pending) > latency)
+    *outbuf = _finish_download (download);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+gst_gl_download_element_sink_event (GstBaseTransform * bt, GstEvent * event)
+{
+  GstGLDownloadElement *download = GST_GL_DOWNLOAD_ELEMENT (bt);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_EOS:
+    case GST_EVENT_CAPS:
+    case GST_EVENT_SEGMENT:
+    case GST_EVENT_GAP:
+      /* the frames in flight belong before the event */
+      _drain (download);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      _clear_pending (download);
+      break;
+    default:
+      break;
+  }
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->sink_event (bt, event);
+}
+
+static gboolean
+gst_gl_download_element_query (GstBaseTransform * bt,
+    GstPadDirection direction, GstQuery * query)
+{
+  GstGLDownloadElement *download = GST_GL_DOWNLOAD_ELEMENT (bt);
+  GstClockTime min, max, delay;
+  gboolean live;
+  guint latency;
+
+  if (!GST_BASE_TRANSFORM_CLASS (parent_class)->query (bt, direction, query))
+    return FALSE;
+
+  if (direction != GST_PAD_SRC || GST_QUERY_TYPE (query) != GST_QUERY_LATENCY)
+    return TRUE;
+
+  GST_OBJECT_LOCK (download);
+  latency = download->latency;
+  GST_OBJECT_UNLOCK (download);
+
+  if (latency == 0 || !download->do_download
+      || GST_VIDEO_INFO_FPS_N (&download->out_info) <= 0)
+    return TRUE;
+
+  delay = gst_util_uint64_scale_int (latency * GST_SECOND,
+      GST_VIDEO_INFO_FPS_D (&download->out_info),
+      GST_VIDEO_INFO_FPS_N (&download->out_info));
+
+  gst_query_parse_latency (query, &live, &min, &max);
+  min += delay;
+  if (GST_CLOCK_TIME_IS_VALID (max))
+    max += delay;
+  gst_query_set_latency (query, live, min, max);
+
+  GST_DEBUG_OBJECT (download, "added %" GST_TIME_FORMAT " of latency for %u "
+      "frames", GST_TIME_ARGS (delay), latency);
+
+  return TRUE;
+}
@@ -43,6 +43,16 @@ struct _GstGLDownloadElement
 {
   /* <private> */
   GstGLBaseFilter  parent;
+
+  guint            latency;
+  gboolean         export_dmabuf;
+
+  GstVideoInfo     out_info;
+  gboolean         do_download;
+  GQueue           pending;
+
+  GstAllocator    *dmabuf_allocator;
+  gboolean         dmabuf_failed;
 };
 
 struct _GstGLDownloadElementClass
@@ -0,0 +1,386 @@
+/*
+ * GStreamer
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-glfilterchain
+ *
+ * Applies a chain of per-pixel GL effects in a single pass.
+ *
+ * Each effect of a chain of gleffects elements renders the whole frame
+ * into its own texture.  glfilterchain generates one fragment shader out
+ * of the effects listed in #GstGLFilterChain:effects instead, and draws
+ * the frame once.  Only the effects that read a single input pixel can be
+ * merged like this: the coordinate warps (mirror, squeeze, stretch,
+ * tunnel, fisheye, twirl, bulge and square) and sin.  The effects that
+ * look at neighbouring pixels or use curve textures still need their own
+ * gleffects element.
+ *
+ * <refsect2>
+ * <title>Examples</title>
+ * |[
+ * gst-launch-1.0 videotestsrc ! glupload ! glfilterchain effects="mirror,squeeze,sin" ! glimagesink
+ * ]| Is equivalent to, but cheaper than
+ * |[
+ * gst-launch-1.0 videotestsrc ! glupload ! gleffects effect=mirror ! gleffects effect=squeeze ! gleffects effect=sin ! glimagesink
+ * ]|
+ * </refsect2>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstglfilterchain.h"
+#include "effects/gstgleffectssources.h"
+
+#define GST_CAT_DEFAULT gst_gl_filter_chain_debug
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+
+enum
+{
+  PROP_0,
+  PROP_EFFECTS
+};
+
+/* A stage either moves the coordinate the input is sampled at, or changes
+ * the sampled colour.  Sampling B's input at B (p) and A's input at A (q)
+ * for a chain A ! B is the same as sampling A's input at A (B (p)), so the
+ * warps are applied in reverse order before the single texture lookup and
+ * the colour stages in order after it. */
+typedef struct
+{
+  const gchar *name;
+  gboolean warp;
+  const gchar *body;
+} GstGLFilterChainStage;
+
+/* *INDENT-OFF* */
+static const GstGLFilterChainStage stages[] = {
+  {"identity", TRUE, ""},
+  {"mirror", TRUE, MIRROR_WARP_SOURCE},
+  {"squeeze", TRUE, SQUEEZE_WARP_SOURCE},
+  {"stretch", TRUE, STRETCH_WARP_SOURCE},
+  {"tunnel", TRUE, TUNNEL_WARP_SOURCE},
+  {"fisheye", TRUE, FISHEYE_WARP_SOURCE},
+  {"twirl", TRUE, TWIRL_WARP_SOURCE},
+  {"bulge", TRUE, BULGE_WARP_SOURCE},
+  {"square", TRUE, SQUARE_WARP_SOURCE},
+  {"sin", FALSE, SIN_COLOR_SOURCE},
+};
+
+static const gchar *chain_header =
+    "#ifdef GL_ES\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "varying vec2 v_texcoord;\n"
+    "uniform sampler2D tex;\n";
+/* *INDENT-ON* */
+
+#define DEBUG_INIT \
+  GST_DEBUG_CATEGORY_INIT (gst_gl_filter_chain_debug, "glfilterchain", 0, \
+      "glfilterchain element");
+#define gst_gl_filter_chain_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstGLFilterChain, gst_gl_filter_chain,
+    GST_TYPE_GL_FILTER, DEBUG_INIT);
+
+static void gst_gl_filter_chain_finalize (GObject * object);
+static void gst_gl_filter_chain_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_gl_filter_chain_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
+static gboolean gst_gl_filter_chain_init_shader (GstGLFilter * filter);
+static gboolean gst_gl_filter_chain_reset (GstBaseTransform * trans);
+static gboolean gst_gl_filter_chain_filter_texture (GstGLFilter * filter,
+    guint in_tex, guint out_tex);
+
+static void
+gst_gl_filter_chain_class_init (GstGLFilterChainClass * klass)
+{
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstGLFilterClass *filter_class = GST_GL_FILTER_CLASS (klass);
+
+  gobject_class->finalize = gst_gl_filter_chain_finalize;
+  gobject_class->set_property = gst_gl_filter_chain_set_property;
+  gobject_class->get_property = gst_gl_filter_chain_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_EFFECTS,
+      g_param_spec_string ("effects", "Effects",
+          "Comma separated list of the gleffects effects to apply, in order "
+          "(identity, mirror, squeeze, stretch, tunnel, fisheye, twirl, "
+          "bulge, square, sin)", NULL,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_set_metadata (element_class, "OpenGL filter chain",
+      "Filter/Effect/Video", "Applies a chain of GL effects in a single pass",
+      "Renesas Electronics Corporation");
+
+  filter_class->init_fbo = GST_DEBUG_FUNCPTR (gst_gl_filter_chain_init_shader);
+  filter_class->filter_texture = gst_gl_filter_chain_filter_texture;
+
+  GST_BASE_TRANSFORM_CLASS (klass)->stop =
+      GST_DEBUG_FUNCPTR (gst_gl_filter_chain_reset);
+
+  GST_GL_BASE_FILTER_CLASS (klass)->supported_gl_api =
+      GST_GL_API_OPENGL | GST_GL_API_OPENGL3 | GST_GL_API_GLES2;
+}
+
+static void
+gst_gl_filter_chain_init (GstGLFilterChain * chain)
+{
+  chain->stages = g_ptr_array_new ();
+  chain->shader = NULL;
+}
+
+static void
+gst_gl_filter_chain_finalize (GObject * object)
+{
+  GstGLFilterChain *chain = GST_GL_FILTER_CHAIN (object);
+
+  g_ptr_array_unref (chain->stages);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static const GstGLFilterChainStage *
+_find_stage (const gchar * name)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (stages); i++) {
+    if (g_strcmp0 (stages[i].name, name) == 0)
+      return &stages[i];
+  }
+
+  return NULL;
+}
+
+static void
+_set_effects (GstGLFilterChain * chain, const gchar * effects)
+{
+  gchar **names = g_strsplit (effects ? effects : "", ",", -1);
+  guint i;
+
+  GST_OBJECT_LOCK (chain);
+  g_ptr_array_set_size (chain->stages, 0);
+
+  for (i = 0; names[i]; i++) {
+    const GstGLFilterChainStage *stage;
+
+    g_strstrip (names[i]);
+    if (names[i][0] == '\0')
+      continue;
+
+    stage = _find_stage (names[i]);
+    if (!stage) {
+      GST_WARNING_OBJECT (chain, "effect '%s' can not be chained, ignoring",
+          names[i]);
+      continue;
+    }
+
+    g_ptr_array_add (chain->stages, (gpointer) stage);
+  }
+
+  chain->stages_changed = TRUE;
+  GST_OBJECT_UNLOCK (chain);
+
+  g_strfreev (names);
+}
+
+static gchar *
+_get_effects (GstGLFilterChain * chain)
+{
+  GString *str = g_string_new (NULL);
+  guint i;
+
+  GST_OBJECT_LOCK (chain);
+  for (i = 0; i < chain->stages->len; i++) {
+    const GstGLFilterChainStage *stage =
+        g_ptr_array_index (chain->stages, i);
+
+    if (i > 0)
+      g_string_append_c (str, ',');
+    g_string_append (str, stage->name);
+  }
+  GST_OBJECT_UNLOCK (chain);
+
+  return g_string_free (str, FALSE);
+}
+
+static void
+gst_gl_filter_chain_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstGLFilterChain *chain = GST_GL_FILTER_CHAIN (object);
+
+  switch (prop_id) {
+    case PROP_EFFECTS:
+      _set_effects (chain, g_value_get_string (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_gl_filter_chain_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstGLFilterChain *chain = GST_GL_FILTER_CHAIN (object);
+
+  switch (prop_id) {
+    case PROP_EFFECTS:
+      g_value_take_string (value, _get_effects (chain));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+/* Generates a fragment shader with a function per stage */
+static gchar *
+_generate_fragment_source (GstGLFilterChain * chain)
+{
+  GString *str = g_string_new (chain_header);
+  GString *warps = g_string_new (NULL);
+  GString *colors = g_string_new (NULL);
+  guint i;
+
+  GST_OBJECT_LOCK (chain);
+  for (i = 0; i < chain->stages->len; i++) {
+    const GstGLFilterChainStage *stage =
+        g_ptr_array_index (chain->stages, i);
+    gchar *call;
+
+    if (stage->body[0] == '\0')
+      continue;
+
+    if (stage->warp) {
+      g_string_append_printf (str, "vec2 stage%d (vec2 texturecoord)\n{\n%s"
+          "  return clamp (texturecoord, 0.0, 1.0);\n}\n", i, stage->body);
+      /* the later stages move the coordinate first */
+      call = g_strdup_printf ("  texturecoord = stage%d (texturecoord);\n", i);
+      g_string_prepend (warps, call);
+      g_free (call);
+    } else {
+      g_string_append_printf (str, "vec4 stage%d (vec4 color)\n{\n%s"
+          "  return color;\n}\n", i, stage->body);
+      g_string_append_printf (colors, "  color = stage%d (color);\n", i);
+    }
+  }
+  chain->stages_changed = FALSE;
+  GST_OBJECT_UNLOCK (chain);
+
+  g_string_append_printf (str, "void main ()\n{\n"
+      "  vec2 texturecoord = v_texcoord.xy;\n%s"
+      "  vec4 color = texture2D (tex, texturecoord);\n%s"
+      "  gl_FragColor = color;\n}\n", warps->str, colors->str);
+
+  g_string_free (warps, TRUE);
+  g_string_free (colors, TRUE);
+
+  return g_string_free (str, FALSE);
+}
+
+static void
+_compile_shader (GstGLContext * context, GstGLFilterChain * chain)
+{
+  GstGLFilter *filter = GST_GL_FILTER (chain);
+  gchar *frag_src = _generate_fragment_source (chain);
+
+  GST_DEBUG_OBJECT (chain, "fragment shader:\n%s", frag_src);
+
+  if (chain->shader) {
+    gst_object_unref (chain->shader);
+    chain->shader = NULL;
+  }
+
+  chain->shader = gst_gl_shader_new (context);
+  if (!gst_gl_shader_compile_with_default_v_and_check (chain->shader,
+          frag_src, &filter->draw_attr_position_loc,
+          &filter->draw_attr_texture_loc)) {
+    gst_gl_context_clear_shader (context);
+    gst_object_unref (chain->shader);
+    chain->shader = NULL;
+  }
+
+  g_free (frag_src);
+}
+
+static gboolean
+_update_shader (GstGLFilterChain * chain)
+{
+  GstGLContext *context = GST_GL_BASE_FILTER (chain)->context;
+
+  gst_gl_context_thread_add (context,
+      (GstGLContextThreadFunc) _compile_shader, chain);
+
+  if (!chain->shader) {
+    GST_ELEMENT_ERROR (chain, RESOURCE, NOT_FOUND, ("%s",
+            gst_gl_context_get_error ()), (NULL));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_gl_filter_chain_init_shader (GstGLFilter * filter)
+{
+  return _update_shader (GST_GL_FILTER_CHAIN (filter));
+}
+
+static gboolean
+gst_gl_filter_chain_reset (GstBaseTransform * trans)
+{
+  GstGLFilterChain *chain = GST_GL_FILTER_CHAIN (trans);
+
+  if (chain->shader) {
+    gst_gl_context_del_shader (GST_GL_BASE_FILTER (trans)->context,
+        chain->shader);
+    chain->shader = NULL;
+  }
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->stop (trans);
+}
+
+static gboolean
+gst_gl_filter_chain_filter_texture (GstGLFilter * filter, guint in_tex,
+    guint out_tex)
+{
+  GstGLFilterChain *chain = GST_GL_FILTER_CHAIN (filter);
+  gboolean changed;
+
+  GST_OBJECT_LOCK (chain);
+  changed = chain->stages_changed;
+  GST_OBJECT_UNLOCK (chain);
+
+  if (changed && !_update_shader (chain))
+    return FALSE;
+
+  gst_gl_filter_render_to_target_with_shader (filter, TRUE, in_tex, out_tex,
+      chain->shader);
+
+  return TRUE;
+}
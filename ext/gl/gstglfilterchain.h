@@ -0,0 +1,58 @@
+/*
+ * GStreamer
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _GST_GL_FILTER_CHAIN_H_
+#define _GST_GL_FILTER_CHAIN_H_
+
+#include <gst/gl/gstglfilter.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_GL_FILTER_CHAIN            (gst_gl_filter_chain_get_type())
+#define GST_GL_FILTER_CHAIN(obj)            (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_GL_FILTER_CHAIN,GstGLFilterChain))
+#define GST_IS_GL_FILTER_CHAIN(obj)         (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_GL_FILTER_CHAIN))
+#define GST_GL_FILTER_CHAIN_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass) ,GST_TYPE_GL_FILTER_CHAIN,GstGLFilterChainClass))
+#define GST_IS_GL_FILTER_CHAIN_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass) ,GST_TYPE_GL_FILTER_CHAIN))
+#define GST_GL_FILTER_CHAIN_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS((obj) ,GST_TYPE_GL_FILTER_CHAIN,GstGLFilterChainClass))
+
+typedef struct _GstGLFilterChain GstGLFilterChain;
+typedef struct _GstGLFilterChainClass GstGLFilterChainClass;
+
+struct _GstGLFilterChain
+{
+  GstGLFilter filter;
+
+  /* the stages in pipeline order, protected by the object lock */
+  GPtrArray *stages;
+  gboolean stages_changed;
+
+  GstGLShader *shader;
+};
+
+struct _GstGLFilterChainClass
+{
+  GstGLFilterClass filter_class;
+};
+
+GType gst_gl_filter_chain_get_type (void);
+
+G_END_DECLS
+
+#endif /* _GST_GL_FILTER_CHAIN_H_ */
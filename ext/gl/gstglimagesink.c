@@ -95,6 +95,7 @@
 
 #if GST_GL_HAVE_PLATFORM_EGL
 #include <gst/gl/egl/gsteglimagememory.h>
+#include <gst/gl/egl/gstglcontext_egl.h>
 #endif
 
 #include <gst/gl/gstglviewconvert.h>
@@ -106,6 +107,8 @@ GST_DEBUG_CATEGORY (gst_debug_glimage_sink);
 #define DEFAULT_HANDLE_EVENTS       TRUE
 #define DEFAULT_FORCE_ASPECT_RATIO  TRUE
 #define DEFAULT_IGNORE_ALPHA        TRUE
+#define DEFAULT_REFRESH_RATE_N      0
+#define DEFAULT_REFRESH_RATE_D      1
 
 #define DEFAULT_MULTIVIEW_MODE GST_VIDEO_MULTIVIEW_MODE_MONO
 #define DEFAULT_MULTIVIEW_FLAGS GST_VIDEO_MULTIVIEW_FLAGS_NONE
@@ -127,7 +130,11 @@ enum
   PROP_BIN_SHOW_PREROLL_FRAME,
   PROP_BIN_OUTPUT_MULTIVIEW_LAYOUT,
   PROP_BIN_OUTPUT_MULTIVIEW_FLAGS,
-  PROP_BIN_OUTPUT_MULTIVIEW_DOWNMIX_MODE
+  PROP_BIN_OUTPUT_MULTIVIEW_DOWNMIX_MODE,
+  PROP_BIN_REFRESH_RATE,
+  PROP_BIN_FRAMES_DRAWN,
+  PROP_BIN_FRAMES_SKIPPED,
+  PROP_BIN_FRAMES_LATE
 };
 
 enum
@@ -250,6 +257,24 @@ gst_gl_image_sink_bin_class_init (GstGLImageSinkBinClass * klass)
           "Output anaglyph type to generate when downmixing to mono",
           GST_TYPE_GL_STEREO_DOWNMIX_MODE_TYPE, DEFAULT_MULTIVIEW_DOWNMIX,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_BIN_REFRESH_RATE,
+      gst_param_spec_fraction ("refresh-rate", "Refresh rate",
+          "Maximum rate at which the window is redrawn (0/1 = unlimited)",
+          0, 1, G_MAXINT, 1, DEFAULT_REFRESH_RATE_N, DEFAULT_REFRESH_RATE_D,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_BIN_FRAMES_DRAWN,
+      g_param_spec_uint64 ("frames-drawn", "Frames drawn",
+          "Number of times the window was redrawn", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_BIN_FRAMES_SKIPPED,
+      g_param_spec_uint64 ("frames-skipped", "Frames skipped",
+          "Number of unchanged frames that did not need a redraw", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_BIN_FRAMES_LATE,
+      g_param_spec_uint64 ("frames-late", "Frames late",
+          "Number of frames drawn more than one frame period late", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gst_gl_image_sink_bin_signals[SIGNAL_BIN_CLIENT_DRAW] =
       g_signal_new ("client-draw", G_TYPE_FROM_CLASS (klass), G_SIGNAL_RUN_LAST,
       0, NULL, NULL, g_cclosure_marshal_generic, G_TYPE_BOOLEAN, 2,
@@ -308,6 +333,8 @@ static GstFlowReturn gst_glimage_sink_show_frame (GstVideoSink * bsink,
     GstBuffer * buf);
 static gboolean gst_glimage_sink_propose_allocation (GstBaseSink * bsink,
     GstQuery * query);
+static gboolean gst_glimage_sink_unlock (GstBaseSink * bsink);
+static gboolean gst_glimage_sink_unlock_stop (GstBaseSink * bsink);
 
 static void gst_glimage_sink_video_overlay_init (GstVideoOverlayInterface *
     iface);
@@ -344,7 +371,11 @@ enum
   PROP_IGNORE_ALPHA,
   PROP_OUTPUT_MULTIVIEW_LAYOUT,
   PROP_OUTPUT_MULTIVIEW_FLAGS,
-  PROP_OUTPUT_MULTIVIEW_DOWNMIX_MODE
+  PROP_OUTPUT_MULTIVIEW_DOWNMIX_MODE,
+  PROP_REFRESH_RATE,
+  PROP_FRAMES_DRAWN,
+  PROP_FRAMES_SKIPPED,
+  PROP_FRAMES_LATE
 };
 
 enum
@@ -516,6 +547,55 @@ gst_glimage_sink_class_init (GstGLImageSinkClass * klass)
           GST_TYPE_GL_STEREO_DOWNMIX_MODE_TYPE, DEFAULT_MULTIVIEW_DOWNMIX,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstGLImageSink:refresh-rate:
+   *
+   * The maximum rate at which the window is redrawn, usually the refresh
+   * rate of the display.  Frames arriving faster than that wait for the
+   * next refresh period instead of being drawn and thrown away by the
+   * display.  0/1 disables the throttling.
+   */
+  g_object_class_install_property (gobject_class, PROP_REFRESH_RATE,
+      gst_param_spec_fraction ("refresh-rate", "Refresh rate",
+          "Maximum rate at which the window is redrawn (0/1 = unlimited)",
+          0, 1, G_MAXINT, 1, DEFAULT_REFRESH_RATE_N, DEFAULT_REFRESH_RATE_D,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstGLImageSink:frames-drawn:
+   *
+   * The number of times the window was redrawn since the last
+   * READY to PAUSED state change.
+   */
+  g_object_class_install_property (gobject_class, PROP_FRAMES_DRAWN,
+      g_param_spec_uint64 ("frames-drawn", "Frames drawn",
+          "Number of times the window was redrawn", 0, G_MAXUINT64, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstGLImageSink:frames-skipped:
+   *
+   * The number of frames that were not drawn because neither the frame nor
+   * the window changed since the previous redraw, e.g. repeated frames
+   * marked as gaps by videorate.
+   */
+  g_object_class_install_property (gobject_class, PROP_FRAMES_SKIPPED,
+      g_param_spec_uint64 ("frames-skipped", "Frames skipped",
+          "Number of unchanged frames that did not need a redraw", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstGLImageSink:frames-late:
+   *
+   * The number of frames that were submitted for drawing more than one
+   * refresh period (or frame duration if #GstGLImageSink:refresh-rate is
+   * not set) after their presentation time.
+   */
+  g_object_class_install_property (gobject_class, PROP_FRAMES_LATE,
+      g_param_spec_uint64 ("frames-late", "Frames late",
+          "Number of frames drawn more than one frame period late", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_metadata (element_class, "OpenGL video sink",
       "Sink/Video", "A videosink based on OpenGL",
       "Julien Isorce <julien.isorce@gmail.com>");
@@ -569,6 +649,9 @@ gst_glimage_sink_class_init (GstGLImageSinkClass * klass)
   gstbasesink_class->get_times = gst_glimage_sink_get_times;
   gstbasesink_class->prepare = gst_glimage_sink_prepare;
   gstbasesink_class->propose_allocation = gst_glimage_sink_propose_allocation;
+  gstbasesink_class->unlock = GST_DEBUG_FUNCPTR (gst_glimage_sink_unlock);
+  gstbasesink_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_glimage_sink_unlock_stop);
 
   gstvideosink_class->show_frame =
       GST_DEBUG_FUNCPTR (gst_glimage_sink_show_frame);
@@ -587,12 +670,16 @@ gst_glimage_sink_init (GstGLImageSink * glimage_sink)
   glimage_sink->handle_events = TRUE;
   glimage_sink->ignore_alpha = TRUE;
   glimage_sink->overlay_compositor = NULL;
+  glimage_sink->damaged = TRUE;
+  glimage_sink->refresh_n = DEFAULT_REFRESH_RATE_N;
+  glimage_sink->refresh_d = DEFAULT_REFRESH_RATE_D;
 
   glimage_sink->mview_output_mode = DEFAULT_MULTIVIEW_MODE;
   glimage_sink->mview_output_flags = DEFAULT_MULTIVIEW_FLAGS;
   glimage_sink->mview_downmix_mode = DEFAULT_MULTIVIEW_DOWNMIX;
 
   g_mutex_init (&glimage_sink->drawing_lock);
+  g_cond_init (&glimage_sink->throttle_cond);
 }
 
 static void
@@ -608,13 +695,19 @@ gst_glimage_sink_set_property (GObject * object, guint prop_id,
   switch (prop_id) {
     case PROP_FORCE_ASPECT_RATIO:
     {
+      GST_GLIMAGE_SINK_LOCK (glimage_sink);
       glimage_sink->keep_aspect_ratio = g_value_get_boolean (value);
+      glimage_sink->damaged = TRUE;
+      GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
       break;
     }
     case PROP_PIXEL_ASPECT_RATIO:
     {
+      GST_GLIMAGE_SINK_LOCK (glimage_sink);
       glimage_sink->par_n = gst_value_get_fraction_numerator (value);
       glimage_sink->par_d = gst_value_get_fraction_denominator (value);
+      glimage_sink->damaged = TRUE;
+      GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
       break;
     }
     case PROP_HANDLE_EVENTS:
@@ -622,7 +715,10 @@ gst_glimage_sink_set_property (GObject * object, guint prop_id,
           g_value_get_boolean (value));
       break;
     case PROP_IGNORE_ALPHA:
+      GST_GLIMAGE_SINK_LOCK (glimage_sink);
       glimage_sink->ignore_alpha = g_value_get_boolean (value);
+      glimage_sink->damaged = TRUE;
+      GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
       break;
     case PROP_OUTPUT_MULTIVIEW_LAYOUT:
       GST_GLIMAGE_SINK_LOCK (glimage_sink);
@@ -642,6 +738,12 @@ gst_glimage_sink_set_property (GObject * object, guint prop_id,
       glimage_sink->output_mode_changed = TRUE;
       GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
       break;
+    case PROP_REFRESH_RATE:
+      GST_GLIMAGE_SINK_LOCK (glimage_sink);
+      glimage_sink->refresh_n = gst_value_get_fraction_numerator (value);
+      glimage_sink->refresh_d = gst_value_get_fraction_denominator (value);
+      GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -657,6 +759,7 @@ gst_glimage_sink_finalize (GObject * object)
 
   glimage_sink = GST_GLIMAGE_SINK (object);
   g_mutex_clear (&glimage_sink->drawing_lock);
+  g_cond_clear (&glimage_sink->throttle_cond);
 
   GST_DEBUG ("finalized");
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -697,6 +800,27 @@ gst_glimage_sink_get_property (GObject * object, guint prop_id,
     case PROP_OUTPUT_MULTIVIEW_DOWNMIX_MODE:
       g_value_set_enum (value, glimage_sink->mview_downmix_mode);
       break;
+    case PROP_REFRESH_RATE:
+      GST_GLIMAGE_SINK_LOCK (glimage_sink);
+      gst_value_set_fraction (value, glimage_sink->refresh_n,
+          glimage_sink->refresh_d);
+      GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+      break;
+    case PROP_FRAMES_DRAWN:
+      GST_GLIMAGE_SINK_LOCK (glimage_sink);
+      g_value_set_uint64 (value, glimage_sink->frames_drawn);
+      GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+      break;
+    case PROP_FRAMES_SKIPPED:
+      GST_GLIMAGE_SINK_LOCK (glimage_sink);
+      g_value_set_uint64 (value, glimage_sink->frames_skipped);
+      GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+      break;
+    case PROP_FRAMES_LATE:
+      GST_GLIMAGE_SINK_LOCK (glimage_sink);
+      g_value_set_uint64 (value, glimage_sink->frames_late);
+      GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -945,6 +1069,14 @@ gst_glimage_sink_change_state (GstElement * element, GstStateChange transition)
       glimage_sink->overlay_compositor =
           gst_gl_overlay_compositor_new (glimage_sink->context);
 
+      GST_GLIMAGE_SINK_LOCK (glimage_sink);
+      glimage_sink->damaged = TRUE;
+      glimage_sink->last_draw_time = 0;
+      glimage_sink->frames_drawn = 0;
+      glimage_sink->frames_skipped = 0;
+      glimage_sink->frames_late = 0;
+      GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+
       g_atomic_int_set (&glimage_sink->to_quit, 0);
       break;
     case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
@@ -1215,6 +1347,7 @@ update_output_format (GstGLImageSink * glimage_sink)
   }
 
   glimage_sink->output_mode_changed = FALSE;
+  glimage_sink->damaged = TRUE;
 
   if (glimage_sink->context)
     window = gst_gl_context_get_window (glimage_sink->context);
@@ -1434,6 +1567,112 @@ convert_views_failed:
   }
 }
 
+static gboolean
+gst_glimage_sink_unlock (GstBaseSink * bsink)
+{
+  GstGLImageSink *glimage_sink = GST_GLIMAGE_SINK (bsink);
+
+  GST_GLIMAGE_SINK_LOCK (glimage_sink);
+  glimage_sink->throttle_unlocked = TRUE;
+  g_cond_broadcast (&glimage_sink->throttle_cond);
+  GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+
+  return TRUE;
+}
+
+static gboolean
+gst_glimage_sink_unlock_stop (GstBaseSink * bsink)
+{
+  GstGLImageSink *glimage_sink = GST_GLIMAGE_SINK (bsink);
+
+  GST_GLIMAGE_SINK_LOCK (glimage_sink);
+  glimage_sink->throttle_unlocked = FALSE;
+  GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+
+  return TRUE;
+}
+
+/* Wait until at least one refresh period has passed since the previous
+ * redraw.  Drawing faster than the display refreshes only produces frames
+ * that are never seen.  Returns FALSE if the wait was interrupted by
+ * unlock. */
+static gboolean
+_throttle_redraw (GstGLImageSink * glimage_sink)
+{
+  gint64 period, end_time;
+  gboolean ret;
+
+  GST_GLIMAGE_SINK_LOCK (glimage_sink);
+  if (glimage_sink->refresh_n <= 0 || glimage_sink->last_draw_time == 0) {
+    GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+    return TRUE;
+  }
+
+  period = gst_util_uint64_scale_int (G_USEC_PER_SEC, glimage_sink->refresh_d,
+      glimage_sink->refresh_n);
+  end_time = glimage_sink->last_draw_time + period;
+
+  GST_TRACE_OBJECT (glimage_sink, "throttling redraw for %" G_GINT64_FORMAT
+      " us", end_time - g_get_monotonic_time ());
+  while (!glimage_sink->throttle_unlocked) {
+    if (!g_cond_wait_until (&glimage_sink->throttle_cond,
+            &GST_GLIMAGE_SINK_GET_LOCK (glimage_sink), end_time))
+      break;
+  }
+  ret = !glimage_sink->throttle_unlocked;
+  GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+
+  return ret;
+}
+
+/* Count @buf as late if it is submitted more than one refresh period (or its
+ * own duration) after the clock time it should have been presented at */
+static void
+_update_lateness (GstGLImageSink * glimage_sink, GstBuffer * buf)
+{
+  GstBaseSink *bsink = GST_BASE_SINK (glimage_sink);
+  GstClockTime running_time, period, now;
+  GstClock *clock;
+  gint refresh_n, refresh_d;
+
+  if (GST_STATE (glimage_sink) != GST_STATE_PLAYING
+      || !gst_base_sink_get_sync (bsink) || !GST_BUFFER_PTS_IS_VALID (buf))
+    return;
+
+  GST_GLIMAGE_SINK_LOCK (glimage_sink);
+  refresh_n = glimage_sink->refresh_n;
+  refresh_d = glimage_sink->refresh_d;
+  GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+
+  if (refresh_n > 0)
+    period = gst_util_uint64_scale_int (GST_SECOND, refresh_d, refresh_n);
+  else if (GST_BUFFER_DURATION_IS_VALID (buf))
+    period = GST_BUFFER_DURATION (buf);
+  else
+    return;
+
+  running_time = gst_segment_to_running_time (&bsink->segment,
+      GST_FORMAT_TIME, GST_BUFFER_PTS (buf));
+  if (!GST_CLOCK_TIME_IS_VALID (running_time))
+    return;
+
+  clock = gst_element_get_clock (GST_ELEMENT (glimage_sink));
+  if (!clock)
+    return;
+  now = gst_clock_get_time (clock);
+  gst_object_unref (clock);
+
+  running_time += gst_element_get_base_time (GST_ELEMENT (glimage_sink)) +
+      gst_base_sink_get_latency (bsink);
+  if (now > running_time + period) {
+    GST_LOG_OBJECT (glimage_sink, "frame late by %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (now - running_time));
+    GST_GLIMAGE_SINK_LOCK (glimage_sink);
+    glimage_sink->frames_late++;
+    GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+  }
+}
+
 static GstFlowReturn
 gst_glimage_sink_show_frame (GstVideoSink * vsink, GstBuffer * buf)
 {
@@ -1443,6 +1682,17 @@ gst_glimage_sink_show_frame (GstVideoSink * vsink, GstBuffer * buf)
 
   glimage_sink = GST_GLIMAGE_SINK (vsink);
 
+  if (!_throttle_redraw (glimage_sink)) {
+    GstFlowReturn ret;
+
+    /* unlocked for a flush or a state change, don't draw unless we are
+     * told to go on */
+    ret = gst_base_sink_wait_preroll (GST_BASE_SINK (glimage_sink));
+    if (ret != GST_FLOW_OK)
+      return ret;
+  }
+  _update_lateness (glimage_sink, buf);
+
   GST_TRACE ("redisplay texture:%u of size:%ux%u, window size:%ux%u",
       glimage_sink->next_tex, GST_VIDEO_INFO_WIDTH (&glimage_sink->out_info),
       GST_VIDEO_INFO_HEIGHT (&glimage_sink->out_info),
@@ -1491,7 +1741,10 @@ gst_glimage_sink_set_window_handle (GstVideoOverlay * overlay, guintptr id)
 
   GST_DEBUG ("set_xwindow_id %" G_GUINT64_FORMAT, (guint64) window_id);
 
+  GST_GLIMAGE_SINK_LOCK (glimage_sink);
   glimage_sink->new_window_id = window_id;
+  glimage_sink->damaged = TRUE;
+  GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
 }
 
 
@@ -1512,6 +1765,10 @@ gst_glimage_sink_expose (GstVideoOverlay * overlay)
       gst_object_unref (window);
     }
 
+    GST_GLIMAGE_SINK_LOCK (glimage_sink);
+    glimage_sink->damaged = TRUE;
+    GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
+
     gst_glimage_sink_redisplay (glimage_sink);
   }
 }
@@ -1544,10 +1801,13 @@ gst_glimage_sink_set_render_rectangle (GstVideoOverlay * overlay,
     gst_object_unref (window);
   }
 
+  GST_GLIMAGE_SINK_LOCK (glimage_sink);
   glimage_sink->x = x;
   glimage_sink->y = y;
   glimage_sink->width = width;
   glimage_sink->height = height;
+  glimage_sink->damaged = TRUE;
+  GST_GLIMAGE_SINK_UNLOCK (glimage_sink);
 }
 
 static gboolean
@@ -1777,6 +2037,10 @@ gst_glimage_sink_on_resize (GstGLImageSink * gl_sink, gint width, gint height)
   gl_sink->window_width = width;
   gl_sink->window_height = height;
 
+  /* the window contents are undefined after a resize */
+  gl_sink->damaged = TRUE;
+  gl_sink->partial_redraw = FALSE;
+
   if (reconfigure) {
     GST_DEBUG ("Sending reconfigure event on sinkpad.");
     gst_pad_push_event (GST_BASE_SINK (gl_sink)->sinkpad,
@@ -1917,8 +2181,20 @@ gst_glimage_sink_on_draw (GstGLImageSink * gl_sink)
       gl->Disable (GL_BLEND);
 
     gst_gl_overlay_compositor_draw_overlays (gl_sink->overlay_compositor);
+
+#if GST_GL_HAVE_PLATFORM_EGL
+    /* only the video area changed since the last frame, the borders around
+     * it are still the same.  Both the viewport and EGL count from the
+     * bottom left corner. */
+    if (gl_sink->partial_redraw && GST_GL_IS_CONTEXT_EGL (gl_sink->context))
+      gst_gl_context_egl_set_swap_damage (GST_GL_CONTEXT_EGL
+          (gl_sink->context), gl_sink->display_rect.x, gl_sink->display_rect.y,
+          gl_sink->display_rect.w, gl_sink->display_rect.h);
+#endif
   }
   /* end default opengl scene */
+  /* draws requested by the window system itself always swap everything */
+  gl_sink->partial_redraw = FALSE;
   window->is_drawing = FALSE;
   gst_object_unref (window);
 
@@ -1946,6 +2222,56 @@ gst_glimage_sink_on_close (GstGLImageSink * gl_sink)
   gst_object_unref (window);
 }
 
+/* Whether @a shows the same picture as @b.  Only frames that upstream
+ * marked as repeated (e.g. the duplicates inserted by videorate) are
+ * compared, anything else might have been rendered into the same memory. */
+static gboolean
+_is_same_frame (GstBuffer * a, GstBuffer * b)
+{
+  GstVideoOverlayCompositionMeta *ometa_a, *ometa_b;
+  guint i, n;
+
+  if (a == b)
+    return TRUE;
+  if (a == NULL || b == NULL)
+    return FALSE;
+
+  if (!GST_BUFFER_FLAG_IS_SET (a, GST_BUFFER_FLAG_GAP))
+    return FALSE;
+
+  n = gst_buffer_n_memory (a);
+  if (n != gst_buffer_n_memory (b))
+    return FALSE;
+
+  for (i = 0; i < n; i++) {
+    if (gst_buffer_peek_memory (a, i) != gst_buffer_peek_memory (b, i))
+      return FALSE;
+  }
+
+  ometa_a = gst_buffer_get_video_overlay_composition_meta (a);
+  ometa_b = gst_buffer_get_video_overlay_composition_meta (b);
+  if (ometa_a && ometa_b)
+    return ometa_a->overlay == ometa_b->overlay;
+
+  return ometa_a == ometa_b;
+}
+
+/* The application may draw something else than the frame from client-draw,
+ * never skip a redraw then */
+static gboolean
+_has_client_draw (GstGLImageSink * gl_sink)
+{
+  GstObject *parent = GST_OBJECT_PARENT (gl_sink);
+
+  if (parent && G_TYPE_CHECK_INSTANCE_TYPE (parent,
+          gst_gl_image_sink_bin_get_type ()))
+    return g_signal_has_handler_pending (parent,
+        gst_gl_image_sink_bin_signals[SIGNAL_BIN_CLIENT_DRAW], 0, FALSE);
+
+  return g_signal_has_handler_pending (gl_sink,
+      gst_glimage_sink_signals[CLIENT_DRAW_SIGNAL], 0, FALSE);
+}
+
 static gboolean
 gst_glimage_sink_redisplay (GstGLImageSink * gl_sink)
 {
@@ -1993,6 +2319,22 @@ gst_glimage_sink_redisplay (GstGLImageSink * gl_sink)
       return TRUE;
     }
 
+    if (!gl_sink->damaged
+        && _is_same_frame (gl_sink->next_buffer, gl_sink->stored_buffer[0])
+        && _is_same_frame (gl_sink->next_buffer2, gl_sink->stored_buffer[1])
+        && !_has_client_draw (gl_sink)) {
+      GST_TRACE ("frame and window unchanged, skipping redraw");
+      gl_sink->frames_skipped++;
+      GST_GLIMAGE_SINK_UNLOCK (gl_sink);
+      gst_object_unref (window);
+      return TRUE;
+    }
+
+    gl_sink->partial_redraw = !gl_sink->damaged;
+    gl_sink->damaged = FALSE;
+    gl_sink->frames_drawn++;
+    gl_sink->last_draw_time = g_get_monotonic_time ();
+
     /* Avoid to release the texture while drawing */
     gl_sink->redisplay_texture = gl_sink->next_tex;
     old_stored_buffer[0] = gl_sink->stored_buffer[0];
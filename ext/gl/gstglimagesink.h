@@ -117,6 +117,21 @@ struct _GstGLImageSink
     GstGLStereoDownmix mview_downmix_mode;
 
     GstGLOverlayCompositor *overlay_compositor;
+
+    /* whether the whole window needs to be redrawn on the next frame */
+    gboolean damaged;
+    gboolean partial_redraw;
+
+    /* redraw throttling, the wait is cut short by unlock */
+    gint refresh_n, refresh_d;
+    gint64 last_draw_time;
+    GCond throttle_cond;
+    gboolean throttle_unlocked;
+
+    /* frame submission statistics */
+    guint64 frames_drawn;
+    guint64 frames_skipped;
+    guint64 frames_late;
 };
 
 struct _GstGLImageSinkClass
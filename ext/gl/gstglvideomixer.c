@@ -25,6 +25,12 @@
  * a similar fashion to compositor and videomixer. See the compositor plugin
  * for documentation about the #GstGLVideoMixerPad properties.
  *
+ * With #GstGLVideoMixer:batch enabled and OpenGL 3.3 or OpenGL ES 3.0
+ * available, all the inputs are copied into the layers of a texture array
+ * and composited with a single instanced draw call instead of one draw call
+ * and set of state changes per input, which is much cheaper with many
+ * inputs.
+ *
  * <refsect2>
  * <title>Examples</title>
  * |[
@@ -46,6 +52,16 @@
 #include "gstglvideomixer.h"
 #include "gstglmixerbin.h"
 
+#ifndef GL_TEXTURE_2D_ARRAY
+#define GL_TEXTURE_2D_ARRAY 0x8C1A
+#endif
+#ifndef GL_MAX_ARRAY_TEXTURE_LAYERS
+#define GL_MAX_ARRAY_TEXTURE_LAYERS 0x88FF
+#endif
+#ifndef GL_RGBA8
+#define GL_RGBA8 0x8058
+#endif
+
 #define GST_CAT_DEFAULT gst_gl_video_mixer_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 
@@ -357,8 +373,10 @@ enum
 {
   PROP_BIN_0,
   PROP_BIN_BACKGROUND,
+  PROP_BIN_BATCH,
 };
 #define DEFAULT_BACKGROUND GST_GL_VIDEO_MIXER_BACKGROUND_CHECKER
+#define DEFAULT_BATCH FALSE
 
 static void gst_gl_video_mixer_bin_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec);
@@ -396,6 +414,11 @@ gst_gl_video_mixer_bin_class_init (GstGLVideoMixerBinClass * klass)
       g_param_spec_enum ("background", "Background", "Background type",
           GST_GL_TYPE_VIDEO_MIXER_BACKGROUND,
           DEFAULT_BACKGROUND, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_BIN_BATCH,
+      g_param_spec_boolean ("batch", "Batch",
+          "Composite all inputs with a single instanced draw call when "
+          "supported", DEFAULT_BATCH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_set_metadata (element_class, "OpenGL video_mixer bin",
       "Bin/Filter/Effect/Video/Compositor", "OpenGL video_mixer bin",
@@ -426,6 +449,7 @@ enum
 {
   PROP_0,
   PROP_BACKGROUND,
+  PROP_BATCH,
 };
 
 #define DEBUG_INIT \
@@ -473,6 +497,40 @@ static const gchar *video_mixer_f_src =
     "  gl_FragColor = vec4(rgba.rgb, rgba.a * alpha);\n"
     "}                                                   \n";
 
+/* batched vertex source, one instance per input.
+ * a_rect: position and size of the input in clip coordinates
+ * a_params: texture array layer, alpha and the part of the layer used */
+static const gchar *video_mixer_batch_v_src =
+    "in vec2 a_position;\n"
+    "in vec4 a_rect;\n"
+    "in vec4 a_params;\n"
+    "uniform vec2 texel_size;\n"
+    "out vec3 v_texCoord;\n"
+    "out vec2 v_texMax;\n"
+    "out float v_alpha;\n"
+    "void main()\n"
+    "{\n"
+    "   gl_Position = vec4(a_rect.xy + a_position * a_rect.zw, 0.0, 1.0);\n"
+    "   v_texCoord = vec3(a_position * a_params.zw, a_params.x);\n"
+    "   v_texMax = a_params.zw - 0.5 * texel_size;\n"
+    "   v_alpha = a_params.y;\n"
+    "}\n";
+
+/* batched fragment source, clamps to the part of the layer holding the
+ * input so that filtering never reads from the unused texels */
+static const gchar *video_mixer_batch_f_src =
+    "uniform sampler2DArray tex;\n"
+    "in vec3 v_texCoord;\n"
+    "in vec2 v_texMax;\n"
+    "in float v_alpha;\n"
+    "out vec4 fragColor;\n"
+    "void main()\n"
+    "{\n"
+    "  vec2 coord = min(v_texCoord.xy, v_texMax);\n"
+    "  vec4 rgba = texture(tex, vec3(coord, v_texCoord.z));\n"
+    "  fragColor = vec4(rgba.rgb, rgba.a * v_alpha);\n"
+    "}\n";
+
 /* checker vertex source */
 static const gchar *checker_v_src =
     "attribute vec4 a_position;\n"
@@ -684,6 +742,12 @@ gst_gl_video_mixer_class_init (GstGLVideoMixerClass * klass)
           GST_GL_TYPE_VIDEO_MIXER_BACKGROUND,
           DEFAULT_BACKGROUND, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_BATCH,
+      g_param_spec_boolean ("batch", "Batch",
+          "Composite all inputs with a single instanced draw call when "
+          "supported", DEFAULT_BATCH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   GST_GL_MIXER_CLASS (klass)->set_caps = gst_gl_video_mixer_init_shader;
   GST_GL_MIXER_CLASS (klass)->reset = gst_gl_video_mixer_reset;
   GST_GL_MIXER_CLASS (klass)->process_textures =
@@ -701,6 +765,7 @@ static void
 gst_gl_video_mixer_init (GstGLVideoMixer * video_mixer)
 {
   video_mixer->background = DEFAULT_BACKGROUND;
+  video_mixer->batch = DEFAULT_BATCH;
   video_mixer->shader = NULL;
   video_mixer->input_frames = NULL;
 }
@@ -715,6 +780,9 @@ gst_gl_video_mixer_set_property (GObject * object, guint prop_id,
     case PROP_BACKGROUND:
       mixer->background = g_value_get_enum (value);
       break;
+    case PROP_BATCH:
+      mixer->batch = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -731,6 +799,9 @@ gst_gl_video_mixer_get_property (GObject * object, guint prop_id,
     case PROP_BACKGROUND:
       g_value_set_enum (value, mixer->background);
       break;
+    case PROP_BATCH:
+      g_value_set_boolean (value, mixer->batch);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -864,6 +935,28 @@ _reset_gl (GstGLContext * context, GstGLVideoMixer * video_mixer)
     video_mixer->vbo_indices = 0;
   }
 
+  if (video_mixer->batch_texture) {
+    gl->DeleteTextures (1, &video_mixer->batch_texture);
+    video_mixer->batch_texture = 0;
+  }
+  video_mixer->batch_width = video_mixer->batch_height = 0;
+  video_mixer->batch_layers = 0;
+
+  if (video_mixer->batch_fbo) {
+    gl->DeleteFramebuffers (1, &video_mixer->batch_fbo);
+    video_mixer->batch_fbo = 0;
+  }
+
+  if (video_mixer->batch_vbo) {
+    gl->DeleteBuffers (1, &video_mixer->batch_vbo);
+    video_mixer->batch_vbo = 0;
+  }
+
+  if (video_mixer->batch_instance_vbo) {
+    gl->DeleteBuffers (1, &video_mixer->batch_instance_vbo);
+    video_mixer->batch_instance_vbo = 0;
+  }
+
   gst_aggregator_iterate_sinkpads (GST_AGGREGATOR (video_mixer), _reset_pad_gl,
       NULL);
 }
@@ -886,6 +979,11 @@ gst_gl_video_mixer_reset (GstGLMixer * mixer)
     gst_gl_context_del_shader (context, video_mixer->checker);
   video_mixer->checker = NULL;
 
+  if (video_mixer->batch_shader)
+    gst_gl_context_del_shader (context, video_mixer->batch_shader);
+  video_mixer->batch_shader = NULL;
+  video_mixer->batch_unsupported = FALSE;
+
   if (GST_GL_BASE_MIXER (mixer)->context)
     gst_gl_context_thread_add (context, (GstGLContextThreadFunc) _reset_gl,
         mixer);
@@ -1017,39 +1115,19 @@ _draw_background (GstGLVideoMixer * video_mixer)
   return TRUE;
 }
 
-/* opengl scene, params: input texture (not the output mixer->texture) */
+/* the per-input path: one draw call, with its own vertex buffer and
+ * uniforms, per input */
 static void
-gst_gl_video_mixer_callback (gpointer stuff)
+_draw_pads (GstGLVideoMixer * video_mixer, guint out_width, guint out_height)
 {
-  GstGLVideoMixer *video_mixer = GST_GL_VIDEO_MIXER (stuff);
-  GstVideoAggregator *vagg = GST_VIDEO_AGGREGATOR (stuff);
   GstGLMixer *mixer = GST_GL_MIXER (video_mixer);
   GstGLFuncs *gl = GST_GL_BASE_MIXER (mixer)->context->gl_vtable;
 
   GLint attr_position_loc = 0;
   GLint attr_texture_loc = 0;
-  guint out_width, out_height;
 
   guint count = 0;
 
-  out_width = GST_VIDEO_INFO_WIDTH (&vagg->info);
-  out_height = GST_VIDEO_INFO_HEIGHT (&vagg->info);
-
-  gst_gl_context_clear_shader (GST_GL_BASE_MIXER (mixer)->context);
-  gl->BindTexture (GL_TEXTURE_2D, 0);
-
-  gl->Disable (GL_DEPTH_TEST);
-  gl->Disable (GL_CULL_FACE);
-
-  if (gl->GenVertexArrays) {
-    if (!video_mixer->vao)
-      gl->GenVertexArrays (1, &video_mixer->vao);
-    gl->BindVertexArray (video_mixer->vao);
-  }
-
-  if (!_draw_background (video_mixer))
-    return;
-
   gst_gl_shader_use (video_mixer->shader);
 
   attr_position_loc =
@@ -1057,8 +1135,6 @@ gst_gl_video_mixer_callback (gpointer stuff)
   attr_texture_loc =
       gst_gl_shader_get_attribute_location (video_mixer->shader, "a_texCoord");
 
-  gl->Enable (GL_BLEND);
-
   while (count < video_mixer->input_frames->len) {
     GstGLMixerFrameData *frame;
     GstGLVideoMixerPad *pad;
@@ -1159,6 +1235,303 @@ gst_gl_video_mixer_callback (gpointer stuff)
 
   gl->DisableVertexAttribArray (attr_position_loc);
   gl->DisableVertexAttribArray (attr_texture_loc);
+}
+
+static gboolean
+_batch_supported (GstGLContext * context)
+{
+  const GstGLFuncs *gl = context->gl_vtable;
+
+  /* instanced attributes are core in OpenGL 3.3 and OpenGL ES 3.0, the
+   * OpenGL 3.2 the shaders need may still have them as an extension */
+  if (!gst_gl_context_check_gl_version (context, GST_GL_API_OPENGL3, 3, 3)
+      && !gst_gl_context_check_gl_version (context, GST_GL_API_GLES2, 3, 0)
+      && !(gst_gl_context_check_gl_version (context, GST_GL_API_OPENGL3, 3, 2)
+          && gst_gl_context_check_feature (context,
+              "GL_ARB_instanced_arrays")))
+    return FALSE;
+
+  return gl->TexImage3D && gl->CopyTexSubImage3D && gl->DrawElementsInstanced
+      && gl->VertexAttribDivisor;
+}
+
+static gboolean
+_init_batch (GstGLVideoMixer * video_mixer)
+{
+  GstGLContext *context = GST_GL_BASE_MIXER (video_mixer)->context;
+  const GstGLFuncs *gl = context->gl_vtable;
+  const gchar *v_header, *f_header;
+  gchar *v_src, *f_src;
+  gboolean ret;
+
+  /* *INDENT-OFF* */
+  const gfloat corners[] = {
+    0.0f, 0.0f,
+    1.0f, 0.0f,
+    1.0f, 1.0f,
+    0.0f, 1.0f,
+  };
+  /* *INDENT-ON* */
+
+  if (!_batch_supported (context)) {
+    GST_INFO_OBJECT (video_mixer, "batching needs OpenGL 3.3, OpenGL ES 3.0 "
+        "or GL_ARB_instanced_arrays, falling back to drawing each input");
+    return FALSE;
+  }
+
+  if (gst_gl_context_check_gl_version (context, GST_GL_API_GLES2, 3, 0)) {
+    v_header = "#version 300 es\n";
+    f_header = "#version 300 es\n"
+        "precision mediump float;\n" "precision mediump sampler2DArray;\n";
+  } else {
+    v_header = f_header = "#version 150\n";
+  }
+
+  v_src = g_strconcat (v_header, video_mixer_batch_v_src, NULL);
+  f_src = g_strconcat (f_header, video_mixer_batch_f_src, NULL);
+  ret = gst_gl_context_gen_shader (context, v_src, f_src,
+      &video_mixer->batch_shader);
+  g_free (v_src);
+  g_free (f_src);
+
+  if (!ret) {
+    GST_WARNING_OBJECT (video_mixer, "failed to compile the batch shader, "
+        "falling back to drawing each input");
+    return FALSE;
+  }
+
+  gl->GenFramebuffers (1, &video_mixer->batch_fbo);
+  gl->GenBuffers (1, &video_mixer->batch_instance_vbo);
+  gl->GenBuffers (1, &video_mixer->batch_vbo);
+  gl->BindBuffer (GL_ARRAY_BUFFER, video_mixer->batch_vbo);
+  gl->BufferData (GL_ARRAY_BUFFER, sizeof (corners), corners, GL_STATIC_DRAW);
+  gl->BindBuffer (GL_ARRAY_BUFFER, 0);
+
+  return TRUE;
+}
+
+/* (re)allocate the texture array so that it holds at least @n_layers
+ * layers of @width x @height */
+static gboolean
+_ensure_batch_texture (GstGLVideoMixer * video_mixer, guint width,
+    guint height, guint n_layers)
+{
+  const GstGLFuncs *gl = GST_GL_BASE_MIXER (video_mixer)->context->gl_vtable;
+  GLint max_layers = 0;
+
+  if (video_mixer->batch_texture && width <= video_mixer->batch_width
+      && height <= video_mixer->batch_height
+      && n_layers <= video_mixer->batch_layers)
+    return TRUE;
+
+  gl->GetIntegerv (GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+  if ((gint) n_layers > max_layers) {
+    GST_DEBUG_OBJECT (video_mixer, "%u inputs is more than the %i texture "
+        "array layers supported", n_layers, max_layers);
+    return FALSE;
+  }
+
+  /* only ever grow, so that inputs coming and going do not reallocate */
+  width = MAX (width, video_mixer->batch_width);
+  height = MAX (height, video_mixer->batch_height);
+  n_layers = MAX (n_layers, video_mixer->batch_layers);
+
+  if (!video_mixer->batch_texture)
+    gl->GenTextures (1, &video_mixer->batch_texture);
+
+  GST_DEBUG_OBJECT (video_mixer, "allocating texture array of %u layers of "
+      "%ux%u", n_layers, width, height);
+
+  gl->BindTexture (GL_TEXTURE_2D_ARRAY, video_mixer->batch_texture);
+  gl->TexImage3D (GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, n_layers,
+      0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  gl->TexParameteri (GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  gl->TexParameteri (GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  gl->TexParameteri (GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  gl->TexParameteri (GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  video_mixer->batch_width = width;
+  video_mixer->batch_height = height;
+  video_mixer->batch_layers = n_layers;
+
+  return TRUE;
+}
+
+/* the batched path: copy every input into a layer of the texture array and
+ * draw them all with one instanced draw call.  The instances are drawn in
+ * the order of the pads, so the zorder is kept.  Returns %FALSE when the
+ * inputs could not be batched, nothing has been drawn then. */
+static gboolean
+_draw_batched (GstGLVideoMixer * video_mixer, guint out_width,
+    guint out_height)
+{
+  GstGLMixer *mixer = GST_GL_MIXER (video_mixer);
+  GstGLFuncs *gl = GST_GL_BASE_MIXER (mixer)->context->gl_vtable;
+  GstGLMixerFrameData **frames;
+  gfloat *instances;
+  guint max_width = 0, max_height = 0;
+  guint i, n = 0;
+  GLint attr_position_loc, attr_rect_loc, attr_params_loc;
+
+  if (video_mixer->batch_unsupported)
+    return FALSE;
+
+  if (!video_mixer->batch_shader && !_init_batch (video_mixer)) {
+    video_mixer->batch_unsupported = TRUE;
+    return FALSE;
+  }
+
+  frames = g_newa (GstGLMixerFrameData *, video_mixer->input_frames->len);
+  for (i = 0; i < video_mixer->input_frames->len; i++) {
+    GstGLMixerFrameData *frame;
+    GstGLVideoMixerPad *pad;
+    GstVideoInfo *v_info;
+
+    frame = g_ptr_array_index (video_mixer->input_frames, i);
+    if (!frame || !frame->texture)
+      continue;
+
+    pad = (GstGLVideoMixerPad *) frame->pad;
+    v_info = &GST_VIDEO_AGGREGATOR_PAD (pad)->info;
+    if (GST_VIDEO_INFO_WIDTH (v_info) <= 0
+        || GST_VIDEO_INFO_HEIGHT (v_info) <= 0 || pad->alpha == 0.0f)
+      continue;
+
+    max_width = MAX (max_width, GST_VIDEO_INFO_WIDTH (v_info));
+    max_height = MAX (max_height, GST_VIDEO_INFO_HEIGHT (v_info));
+    frames[n++] = frame;
+  }
+
+  if (n == 0)
+    return TRUE;
+
+  if (!_ensure_batch_texture (video_mixer, max_width, max_height, n))
+    return FALSE;
+
+  /* copy the inputs into the layers, through a framebuffer reading from
+   * each input texture in turn */
+  gl->BindFramebuffer (GL_FRAMEBUFFER, video_mixer->batch_fbo);
+  gl->BindTexture (GL_TEXTURE_2D_ARRAY, video_mixer->batch_texture);
+
+  instances = g_newa (gfloat, 8 * n);
+  for (i = 0; i < n; i++) {
+    GstGLVideoMixerPad *pad = (GstGLVideoMixerPad *) frames[i]->pad;
+    GstVideoInfo *v_info = &GST_VIDEO_AGGREGATOR_PAD (pad)->info;
+    guint in_width = GST_VIDEO_INFO_WIDTH (v_info);
+    guint in_height = GST_VIDEO_INFO_HEIGHT (v_info);
+    gint pad_width, pad_height;
+    gfloat *inst = &instances[8 * i];
+
+    gl->FramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+        GL_TEXTURE_2D, frames[i]->texture, 0);
+    gl->CopyTexSubImage3D (GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, 0, 0, in_width,
+        in_height);
+
+    _mixer_pad_get_output_size (video_mixer, pad, &pad_width, &pad_height);
+
+    /* same geometry as the per-input vertices */
+    inst[0] = 2.0f * (gfloat) pad->xpos / (gfloat) out_width - 1.0f;
+    inst[1] = 2.0f * (gfloat) pad->ypos / (gfloat) out_height - 1.0f;
+    inst[2] = 2.0f * (gfloat) pad_width / (gfloat) out_width;
+    inst[3] = 2.0f * (gfloat) pad_height / (gfloat) out_height;
+    inst[4] = (gfloat) i;
+    inst[5] = pad->alpha;
+    inst[6] = (gfloat) in_width / (gfloat) video_mixer->batch_width;
+    inst[7] = (gfloat) in_height / (gfloat) video_mixer->batch_height;
+  }
+
+  gl->FramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+      GL_TEXTURE_2D, 0, 0);
+  gl->BindFramebuffer (GL_FRAMEBUFFER, mixer->fbo);
+
+  gl->BindBuffer (GL_ARRAY_BUFFER, video_mixer->batch_instance_vbo);
+  gl->BufferData (GL_ARRAY_BUFFER, 8 * n * sizeof (GLfloat), instances,
+      GL_STREAM_DRAW);
+
+  gst_gl_shader_use (video_mixer->batch_shader);
+  gst_gl_shader_set_uniform_1i (video_mixer->batch_shader, "tex", 0);
+  gst_gl_shader_set_uniform_2f (video_mixer->batch_shader, "texel_size",
+      1.0f / (gfloat) video_mixer->batch_width,
+      1.0f / (gfloat) video_mixer->batch_height);
+
+  attr_position_loc = gst_gl_shader_get_attribute_location
+      (video_mixer->batch_shader, "a_position");
+  attr_rect_loc = gst_gl_shader_get_attribute_location
+      (video_mixer->batch_shader, "a_rect");
+  attr_params_loc = gst_gl_shader_get_attribute_location
+      (video_mixer->batch_shader, "a_params");
+
+  gl->VertexAttribPointer (attr_rect_loc, 4, GL_FLOAT, GL_FALSE,
+      8 * sizeof (GLfloat), (void *) 0);
+  gl->VertexAttribPointer (attr_params_loc, 4, GL_FLOAT, GL_FALSE,
+      8 * sizeof (GLfloat), (void *) (4 * sizeof (GLfloat)));
+  gl->VertexAttribDivisor (attr_rect_loc, 1);
+  gl->VertexAttribDivisor (attr_params_loc, 1);
+  gl->EnableVertexAttribArray (attr_rect_loc);
+  gl->EnableVertexAttribArray (attr_params_loc);
+
+  gl->BindBuffer (GL_ARRAY_BUFFER, video_mixer->batch_vbo);
+  gl->VertexAttribPointer (attr_position_loc, 2, GL_FLOAT, GL_FALSE,
+      2 * sizeof (GLfloat), (void *) 0);
+  gl->EnableVertexAttribArray (attr_position_loc);
+
+  _init_vbo_indices (video_mixer);
+  gl->BindBuffer (GL_ELEMENT_ARRAY_BUFFER, video_mixer->vbo_indices);
+
+  gl->BlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  gl->BlendEquation (GL_FUNC_ADD);
+
+  gl->ActiveTexture (GL_TEXTURE0);
+  gl->BindTexture (GL_TEXTURE_2D_ARRAY, video_mixer->batch_texture);
+
+  GST_TRACE_OBJECT (video_mixer, "drawing %u inputs in one call", n);
+  gl->DrawElementsInstanced (GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0, n);
+
+  gl->BindTexture (GL_TEXTURE_2D_ARRAY, 0);
+
+  gl->VertexAttribDivisor (attr_rect_loc, 0);
+  gl->VertexAttribDivisor (attr_params_loc, 0);
+  gl->DisableVertexAttribArray (attr_position_loc);
+  gl->DisableVertexAttribArray (attr_rect_loc);
+  gl->DisableVertexAttribArray (attr_params_loc);
+
+  return TRUE;
+}
+
+/* opengl scene, params: input texture (not the output mixer->texture) */
+static void
+gst_gl_video_mixer_callback (gpointer stuff)
+{
+  GstGLVideoMixer *video_mixer = GST_GL_VIDEO_MIXER (stuff);
+  GstVideoAggregator *vagg = GST_VIDEO_AGGREGATOR (stuff);
+  GstGLMixer *mixer = GST_GL_MIXER (video_mixer);
+  GstGLFuncs *gl = GST_GL_BASE_MIXER (mixer)->context->gl_vtable;
+
+  guint out_width, out_height;
+
+  out_width = GST_VIDEO_INFO_WIDTH (&vagg->info);
+  out_height = GST_VIDEO_INFO_HEIGHT (&vagg->info);
+
+  gst_gl_context_clear_shader (GST_GL_BASE_MIXER (mixer)->context);
+  gl->BindTexture (GL_TEXTURE_2D, 0);
+
+  gl->Disable (GL_DEPTH_TEST);
+  gl->Disable (GL_CULL_FACE);
+
+  if (gl->GenVertexArrays) {
+    if (!video_mixer->vao)
+      gl->GenVertexArrays (1, &video_mixer->vao);
+    gl->BindVertexArray (video_mixer->vao);
+  }
+
+  if (!_draw_background (video_mixer))
+    return;
+
+  gl->Enable (GL_BLEND);
+
+  if (!video_mixer->batch || !_draw_batched (video_mixer, out_width,
+          out_height))
+    _draw_pads (video_mixer, out_width, out_height);
 
   if (gl->GenVertexArrays)
     gl->BindVertexArray (0);
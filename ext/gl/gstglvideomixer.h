@@ -66,6 +66,17 @@ struct _GstGLVideoMixer
     GLuint vao;
     GLuint vbo_indices;
     GLuint checker_vbo;
+
+    /* batched compositing: all inputs copied into the layers of a
+     * texture array and drawn with a single instanced draw call */
+    gboolean batch;
+    gboolean batch_unsupported;
+    GstGLShader *batch_shader;
+    GLuint batch_texture;
+    guint batch_width, batch_height, batch_layers;
+    GLuint batch_fbo;
+    GLuint batch_vbo;
+    GLuint batch_instance_vbo;
 };
 
 struct _GstGLVideoMixerClass
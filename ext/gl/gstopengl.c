@@ -54,6 +54,7 @@
 
 #include "gstglfiltercube.h"
 #include "gstgleffects.h"
+#include "gstglfilterchain.h"
 #include "gstglcolorscale.h"
 #include "gstglvideomixer.h"
 #include "gstglfiltershader.h"
@@ -175,6 +176,11 @@ plugin_init (GstPlugin * plugin)
     return FALSE;
   };
 
+  if (!gst_element_register (plugin, "glfilterchain",
+          GST_RANK_NONE, GST_TYPE_GL_FILTER_CHAIN)) {
+    return FALSE;
+  }
+
   if (!gst_element_register (plugin, "glcolorscale",
           GST_RANK_NONE, GST_TYPE_GL_COLORSCALE)) {
     return FALSE;
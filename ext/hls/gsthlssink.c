@@ -28,6 +28,26 @@
  * gst-launch-1.0 videotestsrc is-live=true ! x264enc ! mpegtsmux ! hlssink max-files=5
  * ]|
  * </refsect2>
+ *
+ * When #GstHlsSink:part-duration is set, every segment is also written
+ * progressively as a sequence of partial segments of at most that duration,
+ * which start on MPEG-TS packet boundaries and are listed in the playlist as
+ * soon as they are complete. A part also ends early at a keyframe in its
+ * second half, so that the next one can be decoded on its own. Players that
+ * support low-latency HLS can start with the newest part instead of waiting
+ * for the whole segment. Parts are removed again once their segment is more
+ * than three segments old.
+ *
+ * The #GstHlsSink::new-part, #GstHlsSink::new-segment and
+ * #GstHlsSink::playlist-updated signals hand out the same data in memory,
+ * for applications that serve the stream themselves.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 videotestsrc is-live=true ! x264enc key-int-max=30 ! mpegtsmux ! hlssink target-duration=2 part-duration=500
+ * ]|
+ * </refsect2>
  */
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -39,6 +59,7 @@
 #include <gio/gio.h>
 #include <glib/gstdio.h>
 #include <memory.h>
+#include <errno.h>
 
 
 GST_DEBUG_CATEGORY_STATIC (gst_hls_sink_debug);
@@ -50,8 +71,11 @@ GST_DEBUG_CATEGORY_STATIC (gst_hls_sink_debug);
 #define DEFAULT_MAX_FILES 10
 #define DEFAULT_TARGET_DURATION 15
 #define DEFAULT_PLAYLIST_LENGTH 5
+#define DEFAULT_PART_DURATION 0
+#define DEFAULT_PART_LOCATION "segment%05d.part%d.ts"
 
 #define GST_M3U8_PLAYLIST_VERSION 3
+#define TS_PACKET_SIZE 188
 
 enum
 {
@@ -61,9 +85,21 @@ enum
   PROP_PLAYLIST_ROOT,
   PROP_MAX_FILES,
   PROP_TARGET_DURATION,
-  PROP_PLAYLIST_LENGTH
+  PROP_PLAYLIST_LENGTH,
+  PROP_PART_DURATION,
+  PROP_PART_LOCATION
+};
+
+enum
+{
+  SIGNAL_NEW_PART,
+  SIGNAL_NEW_SEGMENT,
+  SIGNAL_PLAYLIST_UPDATED,
+  LAST_SIGNAL
 };
 
+static guint gst_hls_sink_signals[LAST_SIGNAL] = { 0 };
+
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -82,6 +118,7 @@ static GstPadProbeReturn gst_hls_sink_ghost_event_probe (GstPad * pad,
 static GstPadProbeReturn gst_hls_sink_ghost_buffer_probe (GstPad * pad,
     GstPadProbeInfo * info, gpointer data);
 static void gst_hls_sink_reset (GstHlsSink * sink);
+static void gst_hls_sink_clear_parts (GstHlsSink * sink);
 static GstStateChangeReturn
 gst_hls_sink_change_state (GstElement * element, GstStateChange trans);
 static gboolean schedule_next_key_unit (GstHlsSink * sink);
@@ -104,8 +141,10 @@ gst_hls_sink_finalize (GObject * object)
   g_free (sink->location);
   g_free (sink->playlist_location);
   g_free (sink->playlist_root);
+  g_free (sink->part_location);
   if (sink->playlist)
     gst_m3u8_playlist_free (sink->playlist);
+  gst_hls_sink_clear_parts (sink);
 
   G_OBJECT_CLASS (parent_class)->finalize ((GObject *) sink);
 }
@@ -169,6 +208,57 @@ gst_hls_sink_class_init (GstHlsSinkClass * klass)
           "the playlist will be infinite.",
           0, G_MAXUINT, DEFAULT_PLAYLIST_LENGTH,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_PART_DURATION,
+      g_param_spec_uint ("part-duration", "Part duration",
+          "The target duration in milliseconds of the partial segments that "
+          "are written and listed while a segment is in progress "
+          "(0 - disabled)", 0, G_MAXUINT, DEFAULT_PART_DURATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_PART_LOCATION,
+      g_param_spec_string ("part-location", "Part Location",
+          "Location of the partial segments to write, formatted with the "
+          "segment and the part number", DEFAULT_PART_LOCATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstHlsSink::new-part:
+   * @sink: the #GstHlsSink
+   * @uri: the URI of the part as listed in the playlist
+   * @data: the contents of the part
+   *
+   * Emitted when a partial segment is complete, before the playlist that
+   * lists it is written. Only emitted when #GstHlsSink:part-duration is set.
+   */
+  gst_hls_sink_signals[SIGNAL_NEW_PART] =
+      g_signal_new ("new-part", G_TYPE_FROM_CLASS (klass), G_SIGNAL_RUN_LAST,
+      0, NULL, NULL, g_cclosure_marshal_generic, G_TYPE_NONE, 2,
+      G_TYPE_STRING, GST_TYPE_BUFFER);
+
+  /**
+   * GstHlsSink::new-segment:
+   * @sink: the #GstHlsSink
+   * @uri: the URI of the segment as listed in the playlist
+   * @data: the contents of the segment
+   *
+   * Emitted when a segment is complete, before the playlist that lists it is
+   * written. Segments are only collected while a handler is connected.
+   */
+  gst_hls_sink_signals[SIGNAL_NEW_SEGMENT] =
+      g_signal_new ("new-segment", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, 0, NULL, NULL, g_cclosure_marshal_generic,
+      G_TYPE_NONE, 2, G_TYPE_STRING, GST_TYPE_BUFFER);
+
+  /**
+   * GstHlsSink::playlist-updated:
+   * @sink: the #GstHlsSink
+   * @playlist: the contents of the playlist
+   *
+   * Emitted every time the playlist is written.
+   */
+  gst_hls_sink_signals[SIGNAL_PLAYLIST_UPDATED] =
+      g_signal_new ("playlist-updated", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, 0, NULL, NULL, g_cclosure_marshal_generic,
+      G_TYPE_NONE, 1, G_TYPE_STRING);
 }
 
 static void
@@ -190,6 +280,10 @@ gst_hls_sink_init (GstHlsSink * sink)
   sink->playlist_length = DEFAULT_PLAYLIST_LENGTH;
   sink->max_files = DEFAULT_MAX_FILES;
   sink->target_duration = DEFAULT_TARGET_DURATION;
+  sink->part_duration = DEFAULT_PART_DURATION;
+  sink->part_location = g_strdup (DEFAULT_PART_LOCATION);
+  g_queue_init (&sink->part_files);
+  g_queue_init (&sink->part_counts);
 
   /* haven't added a sink yet, make it is detected as a sink meanwhile */
   GST_OBJECT_FLAG_SET (sink, GST_ELEMENT_FLAG_SINK);
@@ -197,6 +291,32 @@ gst_hls_sink_init (GstHlsSink * sink)
   gst_hls_sink_reset (sink);
 }
 
+/* forgets about the parts, the files that are still around are kept */
+static void
+gst_hls_sink_clear_parts (GstHlsSink * sink)
+{
+  if (sink->part_file) {
+    fclose (sink->part_file);
+    sink->part_file = NULL;
+  }
+  g_free (sink->part_filename);
+  sink->part_filename = NULL;
+  g_queue_foreach (&sink->part_files, (GFunc) g_free, NULL);
+  g_queue_clear (&sink->part_files);
+  g_queue_clear (&sink->part_counts);
+
+  gst_buffer_replace (&sink->part_data, NULL);
+  gst_buffer_replace (&sink->segment_data, NULL);
+  gst_buffer_replace (&sink->finished_segment, NULL);
+
+  sink->segment_num = 0;
+  sink->part_index = 0;
+  sink->part_bytes = 0;
+  sink->segment_bytes = 0;
+  sink->part_start = GST_CLOCK_TIME_NONE;
+  sink->part_end = GST_CLOCK_TIME_NONE;
+}
+
 static void
 gst_hls_sink_reset (GstHlsSink * sink)
 {
@@ -213,6 +333,9 @@ gst_hls_sink_reset (GstHlsSink * sink)
   sink->playlist =
       gst_m3u8_playlist_new (GST_M3U8_PLAYLIST_VERSION, sink->playlist_length,
       FALSE);
+  sink->playlist->part_target = sink->part_duration * GST_MSECOND;
+
+  gst_hls_sink_clear_parts (sink);
 }
 
 static gboolean
@@ -267,8 +390,232 @@ gst_hls_sink_write_playlist (GstHlsSink * sink)
     g_error_free (error);
     error = NULL;
   }
+  g_signal_emit (sink, gst_hls_sink_signals[SIGNAL_PLAYLIST_UPDATED], 0,
+      playlist_content);
   g_free (playlist_content);
+}
 
+/* the URI of @filename in the playlist */
+static gchar *
+gst_hls_sink_entry_location (GstHlsSink * sink, const gchar * filename)
+{
+  gchar *name = g_path_get_basename (filename);
+  gchar *entry_location;
+
+  if (sink->playlist_root == NULL)
+    return name;
+
+  entry_location = g_build_filename (sink->playlist_root, name, NULL);
+  g_free (name);
+
+  return entry_location;
+}
+
+static gboolean
+gst_hls_sink_start_part (GstHlsSink * sink, GstBuffer * buffer)
+{
+  sink->part_filename = g_strdup_printf (sink->part_location,
+      sink->segment_num, sink->part_index);
+  sink->part_file = g_fopen (sink->part_filename, "wb");
+  if (sink->part_file == NULL) {
+    GST_ELEMENT_ERROR (sink, RESOURCE, OPEN_WRITE,
+        (("Failed to open part '%s'."), sink->part_filename),
+        ("%s", g_strerror (errno)));
+    g_free (sink->part_filename);
+    sink->part_filename = NULL;
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (sink, "starting part %s", sink->part_filename);
+  sink->part_bytes = 0;
+  sink->part_start = GST_CLOCK_TIME_NONE;
+  sink->part_end = GST_CLOCK_TIME_NONE;
+  sink->part_independent =
+      !GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+  sink->collect_part = g_signal_has_handler_pending (sink,
+      gst_hls_sink_signals[SIGNAL_NEW_PART], 0, FALSE);
+
+  return TRUE;
+}
+
+/* closes the part in progress and adds it to the playlist, ending it at
+ * @running_time if that is known */
+static void
+gst_hls_sink_end_part (GstHlsSink * sink, GstClockTime running_time)
+{
+  GstClockTime duration = 0;
+  gchar *entry_location;
+
+  if (sink->part_file == NULL)
+    return;
+
+  if (fclose (sink->part_file) != 0) {
+    GST_ELEMENT_ERROR (sink, RESOURCE, WRITE,
+        (("Failed to write part '%s'."), sink->part_filename),
+        ("%s", g_strerror (errno)));
+  }
+  sink->part_file = NULL;
+
+  if (!GST_CLOCK_TIME_IS_VALID (running_time))
+    running_time = sink->part_end;
+  if (GST_CLOCK_TIME_IS_VALID (running_time) &&
+      GST_CLOCK_TIME_IS_VALID (sink->part_start) &&
+      running_time > sink->part_start)
+    duration = running_time - sink->part_start;
+
+  /* a single buffer longer than the target, or one that does not end on a
+   * packet boundary, can still make a part too long. Advertise the longest
+   * part instead of a target that players would find violated. */
+  if (duration > sink->playlist->part_target) {
+    GST_WARNING_OBJECT (sink, "part of %" GST_TIME_FORMAT " is longer than "
+        "the part target, raising it", GST_TIME_ARGS (duration));
+    sink->playlist->part_target = duration;
+  }
+
+  entry_location = gst_hls_sink_entry_location (sink, sink->part_filename);
+  GST_DEBUG_OBJECT (sink, "part %s done, %" G_GUINT64_FORMAT " bytes, %"
+      GST_TIME_FORMAT, entry_location, sink->part_bytes,
+      GST_TIME_ARGS (duration));
+  gst_m3u8_playlist_add_part (sink->playlist, entry_location, duration,
+      sink->part_independent);
+
+  if (sink->part_data) {
+    g_signal_emit (sink, gst_hls_sink_signals[SIGNAL_NEW_PART], 0,
+        entry_location, sink->part_data);
+    gst_buffer_replace (&sink->part_data, NULL);
+  }
+  g_free (entry_location);
+
+  g_queue_push_tail (&sink->part_files, sink->part_filename);
+  sink->part_filename = NULL;
+  sink->part_index++;
+}
+
+static void
+gst_hls_sink_write_part (GstHlsSink * sink, GstBuffer * buffer)
+{
+  GstMapInfo map;
+  guint i;
+
+  for (i = 0; i < gst_buffer_n_memory (buffer); i++) {
+    GstMemory *mem = gst_buffer_peek_memory (buffer, i);
+
+    if (!gst_memory_map (mem, &map, GST_MAP_READ))
+      continue;
+    if (map.size > 0 && fwrite (map.data, map.size, 1, sink->part_file) != 1) {
+      GST_ELEMENT_ERROR (sink, RESOURCE, WRITE,
+          (("Failed to write part '%s'."), sink->part_filename),
+          ("%s", g_strerror (errno)));
+    }
+    gst_memory_unmap (mem, &map);
+  }
+  sink->part_bytes += gst_buffer_get_size (buffer);
+
+  if (sink->collect_part) {
+    sink->part_data = sink->part_data ?
+        gst_buffer_append (sink->part_data, gst_buffer_ref (buffer)) :
+        gst_buffer_ref (buffer);
+  }
+}
+
+/* passes @buffer on to the new-segment data and the part in progress */
+static void
+gst_hls_sink_handle_buffer (GstHlsSink * sink, GstBuffer * buffer)
+{
+  GstClockTime running_time = GST_CLOCK_TIME_NONE;
+
+  if (sink->segment_bytes == 0) {
+    sink->collect_segment = g_signal_has_handler_pending (sink,
+        gst_hls_sink_signals[SIGNAL_NEW_SEGMENT], 0, FALSE);
+  }
+  if (sink->collect_segment) {
+    sink->segment_data = sink->segment_data ?
+        gst_buffer_append (sink->segment_data, gst_buffer_ref (buffer)) :
+        gst_buffer_ref (buffer);
+  }
+  sink->segment_bytes += gst_buffer_get_size (buffer);
+
+  if (sink->part_duration == 0)
+    return;
+
+  if (GST_BUFFER_TIMESTAMP_IS_VALID (buffer) &&
+      sink->segment.format == GST_FORMAT_TIME) {
+    running_time = gst_segment_to_running_time (&sink->segment,
+        GST_FORMAT_TIME, GST_BUFFER_TIMESTAMP (buffer));
+  }
+
+  /* parts may not be longer than the part target, so a part ends before
+   * the buffer that would take it past the target. It also ends early at a
+   * keyframe in its second half, so that the next part is independent. Both
+   * only happen on packet boundaries. */
+  if (sink->part_file && GST_CLOCK_TIME_IS_VALID (running_time) &&
+      GST_CLOCK_TIME_IS_VALID (sink->part_start) &&
+      running_time > sink->part_start &&
+      sink->part_bytes % TS_PACKET_SIZE == 0) {
+    GstClockTime target = sink->part_duration * GST_MSECOND;
+    GstClockTime end = running_time;
+
+    if (GST_BUFFER_DURATION_IS_VALID (buffer))
+      end += GST_BUFFER_DURATION (buffer);
+
+    if (end > sink->part_start + target ||
+        (!GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT) &&
+            running_time >= sink->part_start + target / 2)) {
+      gst_hls_sink_end_part (sink, running_time);
+      gst_hls_sink_write_playlist (sink);
+    }
+  }
+
+  if (sink->part_file == NULL && !gst_hls_sink_start_part (sink, buffer))
+    return;
+
+  if (GST_CLOCK_TIME_IS_VALID (running_time)) {
+    if (!GST_CLOCK_TIME_IS_VALID (sink->part_start))
+      sink->part_start = running_time;
+    sink->part_end = running_time;
+    if (GST_BUFFER_DURATION_IS_VALID (buffer))
+      sink->part_end += GST_BUFFER_DURATION (buffer);
+  }
+
+  gst_hls_sink_write_part (sink, buffer);
+}
+
+/* called when multifilesink finishes a file, at @running_time if known */
+static void
+gst_hls_sink_end_segment (GstHlsSink * sink, GstClockTime running_time)
+{
+  if (sink->segment_bytes == 0)
+    return;
+
+  if (sink->part_file) {
+    gst_hls_sink_end_part (sink, running_time);
+    g_queue_push_tail (&sink->part_counts,
+        GUINT_TO_POINTER (sink->part_index));
+  }
+  sink->part_index = 0;
+  sink->segment_num++;
+
+  gst_buffer_replace (&sink->finished_segment, NULL);
+  sink->finished_segment = sink->segment_data;
+  sink->segment_data = NULL;
+  sink->segment_bytes = 0;
+}
+
+/* deletes the parts that are no longer in the playlist */
+static void
+gst_hls_sink_remove_old_parts (GstHlsSink * sink)
+{
+  while (sink->part_counts.length > GST_M3U8_PLAYLIST_PART_WINDOW) {
+    guint n_parts = GPOINTER_TO_UINT (g_queue_pop_head (&sink->part_counts));
+
+    while (n_parts--) {
+      gchar *filename = g_queue_pop_head (&sink->part_files);
+
+      GST_DEBUG_OBJECT (sink, "removing part %s", filename);
+      g_remove (filename);
+      g_free (filename);
+    }
+  }
 }
 
 static void
@@ -295,12 +642,12 @@ gst_hls_sink_handle_message (GstBin * bin, GstMessage * message)
       sink->last_running_time = running_time;
 
       GST_INFO_OBJECT (sink, "COUNT %d", sink->index);
-      if (sink->playlist_root == NULL)
-        entry_location = g_path_get_basename (filename);
-      else {
-        gchar *name = g_path_get_basename (filename);
-        entry_location = g_build_filename (sink->playlist_root, name, NULL);
-        g_free (name);
+      entry_location = gst_hls_sink_entry_location (sink, filename);
+
+      if (sink->finished_segment) {
+        g_signal_emit (sink, gst_hls_sink_signals[SIGNAL_NEW_SEGMENT], 0,
+            entry_location, sink->finished_segment);
+        gst_buffer_replace (&sink->finished_segment, NULL);
       }
 
       gst_m3u8_playlist_add_entry (sink->playlist, entry_location,
@@ -308,6 +655,7 @@ gst_hls_sink_handle_message (GstBin * bin, GstMessage * message)
       g_free (entry_location);
 
       gst_hls_sink_write_playlist (sink);
+      gst_hls_sink_remove_old_parts (sink);
 
       /* multifilesink is starting a new file. It means that upstream sent a key
        * unit and we can schedule the next key unit now.
@@ -407,6 +755,14 @@ gst_hls_sink_set_property (GObject * object, guint prop_id,
       sink->playlist_length = g_value_get_uint (value);
       sink->playlist->window_size = sink->playlist_length;
       break;
+    case PROP_PART_DURATION:
+      sink->part_duration = g_value_get_uint (value);
+      sink->playlist->part_target = sink->part_duration * GST_MSECOND;
+      break;
+    case PROP_PART_LOCATION:
+      g_free (sink->part_location);
+      sink->part_location = g_value_dup_string (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -438,6 +794,12 @@ gst_hls_sink_get_property (GObject * object, guint prop_id,
     case PROP_PLAYLIST_LENGTH:
       g_value_set_uint (value, sink->playlist_length);
       break;
+    case PROP_PART_DURATION:
+      g_value_set_uint (value, sink->part_duration);
+      break;
+    case PROP_PART_LOCATION:
+      g_value_set_string (value, sink->part_location);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -460,6 +822,9 @@ gst_hls_sink_ghost_event_probe (GstPad * pad, GstPadProbeInfo * info,
     case GST_EVENT_FLUSH_STOP:
       gst_segment_init (&sink->segment, GST_FORMAT_UNDEFINED);
       break;
+    case GST_EVENT_EOS:
+      gst_hls_sink_end_segment (sink, GST_CLOCK_TIME_NONE);
+      break;
     case GST_EVENT_CUSTOM_DOWNSTREAM:
     {
       GstClockTime timestamp;
@@ -475,6 +840,8 @@ gst_hls_sink_ghost_event_probe (GstPad * pad, GstPadProbeInfo * info,
           &timestamp, &stream_time, &running_time, &all_headers, &count);
       GST_INFO_OBJECT (sink, "setting index %d", count);
       sink->index = count;
+      /* multifilesink finishes its file on this event */
+      gst_hls_sink_end_segment (sink, running_time);
       break;
     }
     default:
@@ -537,6 +904,8 @@ gst_hls_sink_ghost_buffer_probe (GstPad * pad, GstPadProbeInfo * info,
   GstHlsSink *sink = GST_HLS_SINK_CAST (data);
   GstBuffer *buffer = gst_pad_probe_info_get_buffer (info);
 
+  gst_hls_sink_handle_buffer (sink, buffer);
+
   if (sink->target_duration == 0 || sink->waiting_fku)
     return GST_PAD_PROBE_OK;
 
@@ -552,7 +921,11 @@ gst_hls_sink_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
   GstFlowReturn ret;
   GstHlsSink *sink = GST_HLS_SINK_CAST (parent);
 
-  if (sink->target_duration == 0 || sink->waiting_fku)
+  /* the buffer probe needs to see every buffer to write parts or collect
+   * segments */
+  if ((sink->target_duration == 0 || sink->waiting_fku) &&
+      sink->part_duration == 0 && !g_signal_has_handler_pending (sink,
+          gst_hls_sink_signals[SIGNAL_NEW_SEGMENT], 0, FALSE))
     return gst_proxy_pad_chain_list_default (pad, parent, list);
 
   GST_DEBUG_OBJECT (pad, "chaining each group in list as a merged buffer");
@@ -563,7 +936,7 @@ gst_hls_sink_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
   for (i = 0; i < len; i++) {
     buffer = gst_buffer_list_get (list, i);
 
-    if (!sink->waiting_fku)
+    if (sink->target_duration != 0 && !sink->waiting_fku)
       gst_hls_sink_check_schedule_next_key_unit (sink, buffer);
 
     ret = gst_pad_chain (pad, gst_buffer_ref (buffer));
@@ -21,6 +21,7 @@
 
 #include "gstm3u8playlist.h"
 #include <gst/gst.h>
+#include <stdio.h>
 
 G_BEGIN_DECLS
 
@@ -56,6 +57,28 @@ struct _GstHlsSink
   GstSegment segment;
   gboolean waiting_fku;
   GstClockTime last_running_time;
+
+  /* low-latency parts */
+  guint part_duration;
+  gchar *part_location;
+  guint segment_num;
+  guint part_index;
+  FILE *part_file;
+  gchar *part_filename;
+  guint64 part_bytes;
+  GstClockTime part_start;
+  GstClockTime part_end;
+  gboolean part_independent;
+  GQueue part_files;
+  GQueue part_counts;
+
+  /* data handed to the new-part and new-segment signals */
+  guint64 segment_bytes;
+  gboolean collect_segment;
+  gboolean collect_part;
+  GstBuffer *segment_data;
+  GstBuffer *part_data;
+  GstBuffer *finished_segment;
 };
 
 struct _GstHlsSinkClass
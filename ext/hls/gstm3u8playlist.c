@@ -35,6 +35,11 @@
 #define M3U8_INT_INF_TAG "#EXTINF:%d,%s\n%s\n"
 #define M3U8_FLOAT_INF_TAG "#EXTINF:%s,%s\n%s\n"
 #define M3U8_ENDLIST_TAG "#EXT-X-ENDLIST"
+#define M3U8_PART_INF_TAG "#EXT-X-PART-INF:PART-TARGET=%s\n"
+#define M3U8_PART_TAG "#EXT-X-PART:DURATION=%s,URI=\"%s\"%s\n"
+
+/* the lowest version low latency clients accept parts with */
+#define M3U8_PARTS_MIN_VERSION 6
 
 enum
 {
@@ -65,6 +70,8 @@ gst_m3u8_entry_free (GstM3U8Entry * entry)
 
   g_free (entry->url);
   g_free (entry->title);
+  g_free (entry->str);
+  g_free (entry->parts);
   g_free (entry);
 }
 
@@ -99,6 +106,7 @@ gst_m3u8_playlist_new (guint version, guint window_size, gboolean allow_cache)
   playlist->type = GST_M3U8_PLAYLIST_TYPE_EVENT;
   playlist->end_list = FALSE;
   playlist->entries = g_queue_new ();
+  playlist->parts_str = g_string_new ("");
 
   return playlist;
 }
@@ -110,6 +118,7 @@ gst_m3u8_playlist_free (GstM3U8Playlist * playlist)
 
   g_queue_foreach (playlist->entries, (GFunc) gst_m3u8_entry_free, NULL);
   g_queue_free (playlist->entries);
+  g_string_free (playlist->parts_str, TRUE);
   g_free (playlist);
 }
 
@@ -128,6 +137,14 @@ gst_m3u8_playlist_add_entry (GstM3U8Playlist * playlist,
     return FALSE;
 
   entry = gst_m3u8_entry_new (url, title, duration, discontinuous);
+  /* entries don't change once added, so they are only rendered once */
+  entry->str = gst_m3u8_entry_render (entry, playlist->version);
+
+  /* the parts added since the last entry make up this one */
+  if (playlist->parts_str->len > 0) {
+    entry->parts = g_strdup (playlist->parts_str->str);
+    g_string_truncate (playlist->parts_str, 0);
+  }
 
   if (playlist->window_size > 0) {
     /* Delete old entries from the playlist */
@@ -142,9 +159,32 @@ gst_m3u8_playlist_add_entry (GstM3U8Playlist * playlist,
   playlist->sequence_number = index + 1;
   g_queue_push_tail (playlist->entries, entry);
 
+  /* only the last segments keep listing their parts */
+  if (playlist->entries->length > GST_M3U8_PLAYLIST_PART_WINDOW) {
+    GstM3U8Entry *old_entry = g_queue_peek_nth (playlist->entries,
+        playlist->entries->length - GST_M3U8_PLAYLIST_PART_WINDOW - 1);
+
+    g_free (old_entry->parts);
+    old_entry->parts = NULL;
+  }
+
   return TRUE;
 }
 
+void
+gst_m3u8_playlist_add_part (GstM3U8Playlist * playlist, const gchar * url,
+    gfloat duration, gboolean independent)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_return_if_fail (playlist != NULL);
+  g_return_if_fail (url != NULL);
+
+  g_string_append_printf (playlist->parts_str, M3U8_PART_TAG,
+      g_ascii_dtostr (buf, sizeof (buf), (duration / GST_SECOND)), url,
+      independent ? ",INDEPENDENT=YES" : "");
+}
+
 static guint
 gst_m3u8_playlist_target_duration (GstM3U8Playlist * playlist)
 {
@@ -164,27 +204,29 @@ gst_m3u8_playlist_target_duration (GstM3U8Playlist * playlist)
 static void
 render_entry (GstM3U8Entry * entry, GstM3U8Playlist * playlist)
 {
-  gchar *entry_str;
-
-  entry_str = gst_m3u8_entry_render (entry, playlist->version);
-  g_string_append_printf (playlist->playlist_str, "%s", entry_str);
-  g_free (entry_str);
+  if (entry->parts)
+    g_string_append (playlist->playlist_str, entry->parts);
+  g_string_append (playlist->playlist_str, entry->str);
 }
 
 gchar *
 gst_m3u8_playlist_render (GstM3U8Playlist * playlist)
 {
   gchar *pl;
+  guint version;
 
   g_return_val_if_fail (playlist != NULL, NULL);
 
+  version = playlist->version;
+  if (playlist->part_target > 0)
+    version = MAX (version, M3U8_PARTS_MIN_VERSION);
+
   playlist->playlist_str = g_string_new ("");
 
   /* #EXTM3U */
   g_string_append_printf (playlist->playlist_str, M3U8_HEADER_TAG);
   /* #EXT-X-VERSION */
-  g_string_append_printf (playlist->playlist_str, M3U8_VERSION_TAG,
-      playlist->version);
+  g_string_append_printf (playlist->playlist_str, M3U8_VERSION_TAG, version);
   /* #EXT-X-ALLOW_CACHE */
   g_string_append_printf (playlist->playlist_str, M3U8_ALLOW_CACHE_TAG,
       playlist->allow_cache ? "YES" : "NO");
@@ -194,10 +236,18 @@ gst_m3u8_playlist_render (GstM3U8Playlist * playlist)
   /* #EXT-X-TARGETDURATION */
   g_string_append_printf (playlist->playlist_str, M3U8_TARGETDURATION_TAG,
       gst_m3u8_playlist_target_duration (playlist));
+  /* #EXT-X-PART-INF */
+  if (playlist->part_target > 0) {
+    gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+    g_string_append_printf (playlist->playlist_str, M3U8_PART_INF_TAG,
+        g_ascii_dtostr (buf, sizeof (buf), playlist->part_target / GST_SECOND));
+  }
   g_string_append_printf (playlist->playlist_str, "\n");
 
-  /* Entries */
+  /* Entries, followed by the parts of the segment in progress */
   g_queue_foreach (playlist->entries, (GFunc) render_entry, playlist);
+  g_string_append (playlist->playlist_str, playlist->parts_str->str);
 
   if (playlist->end_list)
     g_string_append_printf (playlist->playlist_str, M3U8_ENDLIST_TAG);
@@ -214,6 +264,7 @@ gst_m3u8_playlist_clear (GstM3U8Playlist * playlist)
 
   g_queue_foreach (playlist->entries, (GFunc) gst_m3u8_entry_free, NULL);
   g_queue_clear (playlist->entries);
+  g_string_truncate (playlist->parts_str, 0);
 }
 
 guint
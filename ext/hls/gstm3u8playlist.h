@@ -30,6 +30,8 @@ G_BEGIN_DECLS
 typedef struct _GstM3U8Playlist GstM3U8Playlist;
 typedef struct _GstM3U8Entry GstM3U8Entry;
 
+/* Number of segments at the end of the playlist that keep their parts */
+#define GST_M3U8_PLAYLIST_PART_WINDOW 3
 
 struct _GstM3U8Entry
 {
@@ -37,6 +39,10 @@ struct _GstM3U8Entry
   gchar *title;
   gchar *url;
   gboolean discontinuous;
+
+  /*< Private >*/
+  gchar *str;
+  gchar *parts;
 };
 
 struct _GstM3U8Playlist
@@ -47,10 +53,12 @@ struct _GstM3U8Playlist
   gint type;
   gboolean end_list;
   guint sequence_number;
+  gfloat part_target;
 
   /*< Private >*/
   GQueue *entries;
   GString *playlist_str;
+  GString *parts_str;
 };
 
 
@@ -64,6 +72,10 @@ gboolean gst_m3u8_playlist_add_entry (GstM3U8Playlist * playlist,
 				     gfloat duration,
 				     guint index,
 				     gboolean discontinuous);
+void gst_m3u8_playlist_add_part (GstM3U8Playlist * playlist,
+                                 const gchar * url,
+                                 gfloat duration,
+                                 gboolean independent);
 gchar * gst_m3u8_playlist_render (GstM3U8Playlist * playlist); 
 void gst_m3u8_playlist_clear (GstM3U8Playlist * playlist); 
 guint gst_m3u8_playlist_n_entries (GstM3U8Playlist * playlist); 
@@ -0,0 +1,109 @@
+/* GStreamer
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:gstcontentkey
+ * @short_description: Identify upstream content for cached indexes
+ *
+ * Demuxers that save what they learned about a file, such as a seek index,
+ * need to know whether a later stream is the same file before reusing it.
+ * The size alone is not enough, as recordings of the same length and
+ * bitrate often have the same size.
+ *
+ * gst_content_key_pull() reads the head and the tail of the upstream data
+ * and returns a short key that changes with the content. Store it with the
+ * cached data and compare it to the key of the stream that is opened later.
+ *
+ * Since: 1.8
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstcontentkey.h"
+
+/* how much of the head and of the tail of the stream is hashed */
+#define CONTENT_KEY_BLOCK_SIZE (64 * 1024)
+
+static gboolean
+hash_range (GChecksum * checksum, GstPad * pad, guint64 offset, guint size)
+{
+  GstBuffer *buffer = NULL;
+  GstMapInfo map;
+
+  if (gst_pad_pull_range (pad, offset, size, &buffer) != GST_FLOW_OK)
+    return FALSE;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+    gst_buffer_unref (buffer);
+    return FALSE;
+  }
+  g_checksum_update (checksum, map.data, map.size);
+  gst_buffer_unmap (buffer, &map);
+  gst_buffer_unref (buffer);
+
+  return TRUE;
+}
+
+/**
+ * gst_content_key_pull:
+ * @pad: a #GstPad operating in pull mode
+ * @length: the size of the upstream data in bytes
+ * @key: (out caller-allocates) (array fixed-size=20): the key,
+ *   #GST_CONTENT_KEY_SIZE bytes
+ *
+ * Computes a key that identifies the @length bytes of data upstream of
+ * @pad: the SHA-1 of the length, the first 64 KiB and the last 64 KiB.
+ * Two streams with the same key can be assumed to be the same file.
+ *
+ * Returns: %TRUE if @key was filled in, %FALSE if the data could not be
+ *   pulled
+ *
+ * Since: 1.8
+ */
+gboolean
+gst_content_key_pull (GstPad * pad, guint64 length, guint8 * key)
+{
+  GChecksum *checksum;
+  guint8 length_le[8];
+  gsize digest_len = GST_CONTENT_KEY_SIZE;
+  gboolean res;
+
+  g_return_val_if_fail (GST_IS_PAD (pad), FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA1);
+  GST_WRITE_UINT64_LE (length_le, length);
+  g_checksum_update (checksum, length_le, sizeof (length_le));
+
+  res = length == 0 ||
+      hash_range (checksum, pad, 0, MIN (length, CONTENT_KEY_BLOCK_SIZE));
+  if (res && length > CONTENT_KEY_BLOCK_SIZE) {
+    guint64 tail = MAX (length - CONTENT_KEY_BLOCK_SIZE,
+        CONTENT_KEY_BLOCK_SIZE);
+
+    res = hash_range (checksum, pad, tail, length - tail);
+  }
+
+  if (res)
+    g_checksum_get_digest (checksum, key, &digest_len);
+  g_checksum_free (checksum);
+
+  return res;
+}
@@ -26,6 +26,29 @@
 
 #include "gsteglimagememory.h"
 
+#if GST_GL_HAVE_DMABUF
+#include <libdrm/drm_fourcc.h>
+
+#ifndef EGL_LINUX_DMA_BUF_EXT
+#define EGL_LINUX_DMA_BUF_EXT 0x3270
+#define EGL_LINUX_DRM_FOURCC_EXT 0x3271
+#define EGL_DMA_BUF_PLANE0_FD_EXT 0x3272
+#define EGL_DMA_BUF_PLANE0_OFFSET_EXT 0x3273
+#define EGL_DMA_BUF_PLANE0_PITCH_EXT 0x3274
+#endif
+
+#ifndef DRM_FORMAT_MOD_LINEAR
+#define DRM_FORMAT_MOD_LINEAR 0
+#endif
+
+typedef EGLImageKHR (*EGLCreateImageKHRFunc) (EGLDisplay dpy, EGLContext ctx,
+    EGLenum target, EGLClientBuffer buffer, const EGLint * attrib_list);
+typedef EGLBoolean (*EGLExportDMABUFImageQueryMESAFunc) (EGLDisplay dpy,
+    EGLImageKHR image, int *fourcc, int *num_planes, guint64 * modifiers);
+typedef EGLBoolean (*EGLExportDMABUFImageMESAFunc) (EGLDisplay dpy,
+    EGLImageKHR image, int *fds, EGLint * strides, EGLint * offsets);
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_EGL_IMAGE_MEMORY);
 #define GST_CAT_DEFAULT GST_CAT_EGL_IMAGE_MEMORY
 
@@ -564,3 +587,238 @@ mem_error:
     return FALSE;
   }
 }
+
+#if GST_GL_HAVE_DMABUF
+/* the plane layout GstGLMemory uses: one or two component textures for
+ * the YUV planes and RGBA textures holding the bytes in memory order,
+ * which the shaders then swizzle */
+static gint
+_drm_fourcc_from_info (GstVideoInfo * info, gint plane)
+{
+  switch (GST_VIDEO_INFO_FORMAT (info)) {
+    case GST_VIDEO_FORMAT_RGBA:
+    case GST_VIDEO_FORMAT_RGBx:
+    case GST_VIDEO_FORMAT_BGRA:
+    case GST_VIDEO_FORMAT_BGRx:
+    case GST_VIDEO_FORMAT_ARGB:
+    case GST_VIDEO_FORMAT_xRGB:
+    case GST_VIDEO_FORMAT_ABGR:
+    case GST_VIDEO_FORMAT_xBGR:
+    case GST_VIDEO_FORMAT_AYUV:
+      return DRM_FORMAT_ABGR8888;
+    case GST_VIDEO_FORMAT_RGB16:
+    case GST_VIDEO_FORMAT_BGR16:
+      return DRM_FORMAT_RGB565;
+    case GST_VIDEO_FORMAT_YUY2:
+    case GST_VIDEO_FORMAT_UYVY:
+    case GST_VIDEO_FORMAT_GRAY16_LE:
+    case GST_VIDEO_FORMAT_GRAY16_BE:
+      return DRM_FORMAT_GR88;
+    case GST_VIDEO_FORMAT_GRAY8:
+    case GST_VIDEO_FORMAT_I420:
+    case GST_VIDEO_FORMAT_YV12:
+    case GST_VIDEO_FORMAT_Y41B:
+    case GST_VIDEO_FORMAT_Y42B:
+    case GST_VIDEO_FORMAT_Y444:
+      return DRM_FORMAT_R8;
+    case GST_VIDEO_FORMAT_NV12:
+    case GST_VIDEO_FORMAT_NV21:
+      return plane == 0 ? DRM_FORMAT_R8 : DRM_FORMAT_GR88;
+    default:
+      return -1;
+  }
+}
+
+/**
+ * gst_egl_image_memory_from_dmabuf:
+ * @context: a #GstGLContext (must be an EGL context)
+ * @dmabuf: the dmabuf file descriptor
+ * @in_info: the #GstVideoInfo describing @dmabuf
+ * @plane: the plane of @in_info to import
+ * @offset: the byte offset of @plane inside @dmabuf
+ *
+ * Imports one plane of @dmabuf as an EGLImage through
+ * EGL_EXT_image_dma_buf_import without copying it.  The image has the
+ * layout #GstGLMemory uses for the same plane so it can be bound to the
+ * texture of such a memory.
+ *
+ * The dmabuf must stay valid as long as the returned memory is used.
+ *
+ * Returns: (transfer full): a #GstEGLImageMemory or %NULL
+ */
+GstMemory *
+gst_egl_image_memory_from_dmabuf (GstGLContext * context, gint dmabuf,
+    GstVideoInfo * in_info, gint plane, gsize offset)
+{
+  GstGLContextEGL *ctx_egl;
+  EGLCreateImageKHRFunc create_image;
+  EGLImageKHR img;
+  EGLint attribs[13];
+  gint fourcc, width, height, atti = 0;
+
+  g_return_val_if_fail (GST_GL_IS_CONTEXT_EGL (context), NULL);
+  g_return_val_if_fail (dmabuf >= 0, NULL);
+  g_return_val_if_fail (in_info != NULL, NULL);
+
+  ctx_egl = GST_GL_CONTEXT_EGL (context);
+
+  fourcc = _drm_fourcc_from_info (in_info, plane);
+  if (fourcc == -1)
+    return NULL;
+
+  /* the attributes of EGL_EXT_image_dma_buf_import are EGLint, while EGL 1.5
+   * core eglCreateImage () takes EGLAttrib, so always use the KHR entry
+   * point that the extension requires anyway */
+  create_image = gst_gl_context_get_proc_address (context, "eglCreateImageKHR");
+  if (!create_image)
+    return NULL;
+
+  if (GST_VIDEO_INFO_IS_YUV (in_info)) {
+    width = GST_VIDEO_INFO_COMP_WIDTH (in_info, plane);
+    height = GST_VIDEO_INFO_COMP_HEIGHT (in_info, plane);
+  } else {
+    width = GST_VIDEO_INFO_WIDTH (in_info);
+    height = GST_VIDEO_INFO_HEIGHT (in_info);
+  }
+
+  GST_CAT_DEBUG (GST_CAT_DEFAULT, "importing plane %i of dmabuf %i (%"
+      GST_FOURCC_FORMAT " %ix%i, offset %" G_GSIZE_FORMAT ", stride %i)",
+      plane, dmabuf, GST_FOURCC_ARGS (fourcc), width, height, offset,
+      GST_VIDEO_INFO_PLANE_STRIDE (in_info, plane));
+
+  attribs[atti++] = EGL_WIDTH;
+  attribs[atti++] = width;
+  attribs[atti++] = EGL_HEIGHT;
+  attribs[atti++] = height;
+  attribs[atti++] = EGL_LINUX_DRM_FOURCC_EXT;
+  attribs[atti++] = fourcc;
+  attribs[atti++] = EGL_DMA_BUF_PLANE0_FD_EXT;
+  attribs[atti++] = dmabuf;
+  attribs[atti++] = EGL_DMA_BUF_PLANE0_OFFSET_EXT;
+  attribs[atti++] = offset;
+  attribs[atti++] = EGL_DMA_BUF_PLANE0_PITCH_EXT;
+  attribs[atti++] = GST_VIDEO_INFO_PLANE_STRIDE (in_info, plane);
+  attribs[atti] = EGL_NONE;
+
+  img = create_image (ctx_egl->egl_display, EGL_NO_CONTEXT,
+      EGL_LINUX_DMA_BUF_EXT, NULL, attribs);
+  if (img == EGL_NO_IMAGE_KHR) {
+    GST_CAT_WARNING (GST_CAT_DEFAULT, "failed to import dmabuf %i: 0x%x",
+        dmabuf, eglGetError ());
+    return NULL;
+  }
+
+  return gst_egl_image_allocator_wrap (NULL, ctx_egl, img,
+      gst_gl_texture_type_from_format (context,
+          GST_VIDEO_INFO_FORMAT (in_info), plane),
+      GST_MEMORY_FLAG_NOT_MAPPABLE | GST_MEMORY_FLAG_NO_SHARE,
+      GST_VIDEO_INFO_PLANE_STRIDE (in_info, plane) * height, NULL, NULL);
+}
+
+/**
+ * gst_egl_image_memory_export_dmabuf:
+ * @gl_mem: a #GstGLMemory
+ * @fd: (out): the exported dmabuf file descriptor
+ * @stride: (out): the stride of the texture in @fd
+ * @offset: (out): the byte offset of the texture in @fd
+ *
+ * Exports the texture of @gl_mem as a dmabuf through
+ * EGL_MESA_image_dma_buf_export, sharing the texture storage.  Must be
+ * called from the GL thread of @gl_mem's context.  The caller owns @fd.
+ *
+ * Only linear single plane images with the layout #GstGLMemory uses for
+ * @gl_mem's plane are exported, as nothing else could be described with a
+ * #GstVideoMeta.
+ *
+ * Returns: whether the texture could be exported
+ */
+gboolean
+gst_egl_image_memory_export_dmabuf (GstGLMemory * gl_mem, gint * fd,
+    gint * stride, gsize * offset)
+{
+  GstGLContext *context;
+  GstGLContextEGL *ctx_egl;
+  EGLExportDMABUFImageQueryMESAFunc export_query;
+  EGLExportDMABUFImageMESAFunc export_image;
+  EGLImageKHR img;
+  EGLint egl_stride, egl_offset;
+  gint fourcc, n_planes, dmabuf = -1;
+  /* room for the most planes a DRM format can have */
+  guint64 modifiers[4];
+  gboolean ret = FALSE;
+
+  g_return_val_if_fail (gst_is_gl_memory ((GstMemory *) gl_mem), FALSE);
+  g_return_val_if_fail (fd != NULL, FALSE);
+
+  context = gl_mem->mem.context;
+  if (!GST_GL_IS_CONTEXT_EGL (context))
+    return FALSE;
+  ctx_egl = GST_GL_CONTEXT_EGL (context);
+
+  if (!gst_gl_context_check_feature (context, "EGL_KHR_gl_texture_2D_image")
+      || !gst_gl_context_check_feature (context,
+          "EGL_MESA_image_dma_buf_export"))
+    return FALSE;
+
+  export_query = gst_gl_context_get_proc_address (context,
+      "eglExportDMABUFImageQueryMESA");
+  export_image = gst_gl_context_get_proc_address (context,
+      "eglExportDMABUFImageMESA");
+  if (!export_query || !export_image)
+    return FALSE;
+
+  img = ctx_egl->eglCreateImage (ctx_egl->egl_display, ctx_egl->egl_context,
+      EGL_GL_TEXTURE_2D_KHR, (EGLClientBuffer) (guintptr) gl_mem->tex_id,
+      NULL);
+  if (img == EGL_NO_IMAGE_KHR) {
+    GST_CAT_WARNING (GST_CAT_DEFAULT, "failed to create an EGLImage for "
+        "texture %u: 0x%x", gl_mem->tex_id, eglGetError ());
+    return FALSE;
+  }
+
+  /* a texture only ever has a single plane, anything else is not
+   * something we know how to describe downstream */
+  if (!export_query (ctx_egl->egl_display, img, &fourcc, &n_planes, NULL)
+      || n_planes != 1)
+    goto done;
+
+  /* tiled or compressed images would be read as garbage by anyone only
+   * knowing the stride */
+  if (!export_query (ctx_egl->egl_display, img, &fourcc, &n_planes,
+          modifiers) || modifiers[0] != DRM_FORMAT_MOD_LINEAR) {
+    GST_CAT_INFO (GST_CAT_DEFAULT, "texture %u is not linear, not exporting "
+        "it", gl_mem->tex_id);
+    goto done;
+  }
+
+  if (fourcc != _drm_fourcc_from_info (&gl_mem->info, gl_mem->plane)) {
+    GST_CAT_INFO (GST_CAT_DEFAULT, "texture %u exports as %" GST_FOURCC_FORMAT
+        " instead of the layout of %s plane %u", gl_mem->tex_id,
+        GST_FOURCC_ARGS (fourcc),
+        gst_video_format_to_string (GST_VIDEO_INFO_FORMAT (&gl_mem->info)),
+        gl_mem->plane);
+    goto done;
+  }
+
+  if (!export_image (ctx_egl->egl_display, img, &dmabuf, &egl_stride,
+          &egl_offset) || dmabuf < 0)
+    goto done;
+
+  GST_CAT_DEBUG (GST_CAT_DEFAULT, "exported texture %u as dmabuf %i (%"
+      GST_FOURCC_FORMAT ", stride %i, offset %i)", gl_mem->tex_id, dmabuf,
+      GST_FOURCC_ARGS (fourcc), egl_stride, egl_offset);
+
+  *fd = dmabuf;
+  if (stride)
+    *stride = egl_stride;
+  if (offset)
+    *offset = egl_offset;
+  ret = TRUE;
+
+done:
+  /* the dmabuf keeps the storage alive on its own */
+  ctx_egl->eglDestroyImage (ctx_egl->egl_display, img);
+
+  return ret;
+}
+#endif /* GST_GL_HAVE_DMABUF */
@@ -480,6 +480,15 @@ gst_gl_context_egl_create_context (GstGLContext * context,
     egl->eglDestroyImage = NULL;
   }
 
+  if (gst_gl_check_extension ("EGL_KHR_swap_buffers_with_damage", egl_exts))
+    egl->eglSwapBuffersWithDamage = gst_gl_context_get_proc_address (context,
+        "eglSwapBuffersWithDamageKHR");
+  else if (gst_gl_check_extension ("EGL_EXT_swap_buffers_with_damage",
+          egl_exts))
+    egl->eglSwapBuffersWithDamage = gst_gl_context_get_proc_address (context,
+        "eglSwapBuffersWithDamageEXT");
+  egl->have_damage = FALSE;
+
   if (window)
     gst_object_unref (window);
 
@@ -585,7 +594,13 @@ gst_gl_context_egl_swap_buffers (GstGLContext * context)
 
   egl = GST_GL_CONTEXT_EGL (context);
 
-  eglSwapBuffers (egl->egl_display, egl->egl_surface);
+  if (egl->have_damage && egl->eglSwapBuffersWithDamage)
+    egl->eglSwapBuffersWithDamage (egl->egl_display, egl->egl_surface,
+        egl->damage_rect, 1);
+  else
+    eglSwapBuffers (egl->egl_display, egl->egl_surface);
+
+  egl->have_damage = FALSE;
 }
 
 static GstGLAPI
@@ -685,6 +700,15 @@ gst_gl_context_egl_check_feature (GstGLContext * context, const gchar * feature)
         context_egl->eglDestroyImage != NULL;
   }
 
+  /* the other EGLImage extensions are of no use without the base one */
+  if (g_strstr_len (feature, 4, "EGL_")) {
+    if (context_egl->eglCreateImage == NULL)
+      return FALSE;
+
+    return gst_gl_check_extension (feature,
+        eglQueryString (context_egl->egl_display, EGL_EXTENSIONS));
+  }
+
   return FALSE;
 }
 
@@ -693,3 +717,38 @@ gst_gl_context_egl_get_current_context (void)
 {
   return (guintptr) eglGetCurrentContext ();
 }
+
+/**
+ * gst_gl_context_egl_set_swap_damage:
+ * @context: a #GstGLContextEGL
+ * @x: the left edge of the damaged area
+ * @y: the bottom edge of the damaged area
+ * @width: the width of the damaged area
+ * @height: the height of the damaged area
+ *
+ * Limits the next buffer swap of @context to the given area of the surface,
+ * in window coordinates with the origin at the bottom left as for
+ * glViewport().  The rest of the surface keeps the contents of the previous
+ * frame.  The damage only applies to a single swap.
+ *
+ * Must be called in the GL thread.
+ *
+ * Returns: whether partial swaps are supported by the EGL implementation
+ */
+gboolean
+gst_gl_context_egl_set_swap_damage (GstGLContextEGL * context, gint x, gint y,
+    gint width, gint height)
+{
+  g_return_val_if_fail (GST_GL_IS_CONTEXT_EGL (context), FALSE);
+
+  if (!context->eglSwapBuffersWithDamage)
+    return FALSE;
+
+  context->damage_rect[0] = x;
+  context->damage_rect[1] = y;
+  context->damage_rect[2] = width;
+  context->damage_rect[3] = height;
+  context->have_damage = TRUE;
+
+  return TRUE;
+}
@@ -54,6 +54,13 @@ struct _GstGLContextEGL {
 
   /* Cached handle */
   EGLNativeWindowType window_handle;
+
+  EGLBoolean (*eglSwapBuffersWithDamage) (EGLDisplay dpy, EGLSurface surface,
+      EGLint *rects, EGLint n_rects);
+
+  /* damage for the next swap, x, y, width, height from the bottom left */
+  EGLint damage_rect[4];
+  gboolean have_damage;
 };
 
 struct _GstGLContextEGLClass {
@@ -63,6 +70,7 @@ struct _GstGLContextEGLClass {
 GstGLContextEGL *   gst_gl_context_egl_new                  (GstGLDisplay * display);
 guintptr            gst_gl_context_egl_get_current_context  (void);
 gpointer            gst_gl_context_egl_get_proc_address     (GstGLAPI gl_api, const gchar * name);
+gboolean            gst_gl_context_egl_set_swap_damage      (GstGLContextEGL * context, gint x, gint y, gint width, gint height);
 
 /* TODO:
  * add support for EGL_NO_CONTEXT
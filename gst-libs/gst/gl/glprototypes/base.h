@@ -185,9 +185,10 @@ GST_GL_EXT_FUNCTION (void, TexParameterf,
 GST_GL_EXT_END ()
 
 GST_GL_EXT_BEGIN (texture_3d,
-                  GST_GL_API_OPENGL | GST_GL_API_OPENGL3,
+                  GST_GL_API_OPENGL | GST_GL_API_OPENGL3 |
+                  GST_GL_API_GLES2,
                   1, 2,
-                  255, 255, /* not in either GLES */
+                  3, 0,
                   "OES\0",
                   "texture_3D\0")
 GST_GL_EXT_FUNCTION (void, TexImage3D,
@@ -204,6 +205,11 @@ GST_GL_EXT_FUNCTION (void, TexSubImage3D,
                       GLsizei height, GLsizei depth,
                       GLenum format,
                       GLenum type, const GLvoid *pixels))
+GST_GL_EXT_FUNCTION (void, CopyTexSubImage3D,
+                     (GLenum target, GLint level,
+                      GLint xoffset, GLint yoffset,
+                      GLint zoffset, GLint x, GLint y,
+                      GLsizei width, GLsizei height))
 GST_GL_EXT_END ()
 
 GST_GL_EXT_BEGIN (only_in_both_gles_and_gl_1_3,
@@ -46,3 +46,30 @@ GST_GL_EXT_FUNCTION (void, GetBufferSubData,
                       GLsizeiptr            size,
                       void *                data))
 GST_GL_EXT_END ()
+
+GST_GL_EXT_BEGIN (draw_instanced,
+                  GST_GL_API_OPENGL3 |
+                  GST_GL_API_GLES2,
+                  3, 1,
+                  3, 0,
+                  "ARB\0EXT\0",
+                  "draw_instanced\0")
+GST_GL_EXT_FUNCTION (void, DrawElementsInstanced,
+                     (GLenum                mode,
+                      GLsizei               count,
+                      GLenum                type,
+                      const GLvoid         *indices,
+                      GLsizei               primcount))
+GST_GL_EXT_END ()
+
+GST_GL_EXT_BEGIN (instanced_arrays,
+                  GST_GL_API_OPENGL3 |
+                  GST_GL_API_GLES2,
+                  3, 3,
+                  3, 0,
+                  "ARB\0EXT\0",
+                  "instanced_arrays\0")
+GST_GL_EXT_FUNCTION (void, VertexAttribDivisor,
+                     (GLuint                index,
+                      GLuint                divisor))
+GST_GL_EXT_END ()
@@ -39,6 +39,11 @@
  *
  * For handling stride scaling in the shader, see
  * gst_gl_color_convert_set_texture_scaling().
+ *
+ * All the #GstGLColorConvert objects of a #GstGLContext share their
+ * conversion programs, framebuffers, intermediate textures and output
+ * buffer pools.  gst_gl_color_convert_get_context_stats() retrieves how
+ * often these have been reused.
  */
 
 #define USING_OPENGL(context) (gst_gl_context_check_gl_version (context, GST_GL_API_OPENGL, 1, 0))
@@ -462,12 +467,61 @@ struct ConvertInfo
   gfloat chroma_sampling[2];
 };
 
+/* The resources the converters of a context share.  The converters keep
+ * the context alive, so the cache is refcounted by them instead of being
+ * owned by the context: it is freed with the last converter, while the
+ * GL objects in it can still be deleted. */
+typedef struct
+{
+  GLuint fbo;
+  GLuint depth_buffer;
+  guint width;
+  guint height;
+} ConvertFbo;
+
+typedef struct
+{
+  GstBufferPool *pool;
+  gchar *caps_str;
+  guint users;
+} ConvertPool;
+
+typedef struct
+{
+  guint refcount;
+  GstGLContext *context;
+
+  /* program key -> GstGLShader */
+  GHashTable *programs;
+  /* caps string -> ConvertPool */
+  GHashTable *pools;
+  /* most recently released first */
+  GQueue idle_fbos;
+  GQueue idle_textures;
+
+  guint program_hits, program_misses;
+  guint fbo_hits, fbo_misses, fbo_evictions;
+  guint texture_hits, texture_misses, texture_evictions;
+  guint pool_hits, pool_misses, pool_evictions;
+} ConvertCache;
+
+/* idle framebuffers and textures kept around for other converters */
+#define MAX_IDLE_FBOS 8
+#define MAX_IDLE_TEXTURES 8
+
+static GQuark convert_cache_quark;
+G_LOCK_DEFINE_STATIC (convert_cache);
+
 struct _GstGLColorConvertPrivate
 {
   gboolean result;
 
   struct ConvertInfo convert_info;
 
+  ConvertCache *cache;
+  ConvertFbo *fbo;
+  ConvertPool *pool;
+
   GstGLMemory *in_tex[GST_VIDEO_MAX_PLANES];
   GstGLMemory *out_tex[GST_VIDEO_MAX_PLANES];
 
@@ -498,6 +552,329 @@ gst_gl_color_convert_class_init (GstGLColorConvertClass * klass)
   g_type_class_add_private (klass, sizeof (GstGLColorConvertPrivate));
 
   G_OBJECT_CLASS (klass)->finalize = gst_gl_color_convert_finalize;
+
+  convert_cache_quark = g_quark_from_static_string ("GstGLColorConvertCache");
+}
+
+static ConvertCache *
+_convert_cache_ref (GstGLContext * context)
+{
+  ConvertCache *cache;
+
+  G_LOCK (convert_cache);
+  cache = g_object_get_qdata (G_OBJECT (context), convert_cache_quark);
+  if (!cache) {
+    cache = g_new0 (ConvertCache, 1);
+    cache->context = context;
+    cache->programs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+        (GDestroyNotify) gst_object_unref);
+    cache->pools = g_hash_table_new (g_str_hash, g_str_equal);
+    g_queue_init (&cache->idle_fbos);
+    g_queue_init (&cache->idle_textures);
+    g_object_set_qdata (G_OBJECT (context), convert_cache_quark, cache);
+  }
+  cache->refcount++;
+  G_UNLOCK (convert_cache);
+
+  return cache;
+}
+
+static void
+_free_fbo (ConvertCache * cache, ConvertFbo * fbo)
+{
+  gst_gl_context_del_fbo (cache->context, fbo->fbo, fbo->depth_buffer);
+  g_free (fbo);
+}
+
+static void
+_free_pool (ConvertPool * pool)
+{
+  gst_buffer_pool_set_active (pool->pool, FALSE);
+  gst_object_unref (pool->pool);
+  g_free (pool->caps_str);
+  g_free (pool);
+}
+
+static void
+_convert_cache_unref (ConvertCache * cache)
+{
+  ConvertFbo *fbo;
+  GstMemory *tex;
+
+  G_LOCK (convert_cache);
+  if (--cache->refcount > 0) {
+    G_UNLOCK (convert_cache);
+    return;
+  }
+  g_object_set_qdata (G_OBJECT (cache->context), convert_cache_quark, NULL);
+  G_UNLOCK (convert_cache);
+
+  GST_DEBUG ("freeing the conversion cache of context %" GST_PTR_FORMAT,
+      cache->context);
+
+  /* every converter released its pool before getting here */
+  g_assert (g_hash_table_size (cache->pools) == 0);
+  g_hash_table_unref (cache->pools);
+  g_hash_table_unref (cache->programs);
+
+  while ((fbo = g_queue_pop_head (&cache->idle_fbos)))
+    _free_fbo (cache, fbo);
+  while ((tex = g_queue_pop_head (&cache->idle_textures)))
+    gst_memory_unref (tex);
+
+  g_free (cache);
+}
+
+/* takes ownership of @frag_prog */
+static GstGLShader *
+_convert_cache_get_program (ConvertCache * cache, GstGLColorConvert * convert,
+    gchar * frag_prog)
+{
+  GstGLShader *shader;
+  gchar *colorimetry, *key;
+
+  /* the source covers what else the program depends on, like the input
+   * texture target */
+  colorimetry = gst_video_colorimetry_to_string (&convert->in_info.colorimetry);
+  key = g_strdup_printf ("%s:%s:%s\n%s",
+      gst_video_format_to_string (GST_VIDEO_INFO_FORMAT (&convert->in_info)),
+      gst_video_format_to_string (GST_VIDEO_INFO_FORMAT (&convert->out_info)),
+      GST_STR_NULL (colorimetry), frag_prog);
+  g_free (colorimetry);
+
+  G_LOCK (convert_cache);
+  shader = g_hash_table_lookup (cache->programs, key);
+  if (shader) {
+    cache->program_hits++;
+    gst_object_ref (shader);
+    G_UNLOCK (convert_cache);
+    g_free (frag_prog);
+    g_free (key);
+    return shader;
+  }
+  cache->program_misses++;
+  G_UNLOCK (convert_cache);
+
+  /* compiling in the gl thread, no other converter can race us here */
+  if (!gst_gl_context_gen_shader (cache->context, text_vertex_shader,
+          frag_prog, &shader)) {
+    g_free (frag_prog);
+    g_free (key);
+    return NULL;
+  }
+  g_free (frag_prog);
+
+  G_LOCK (convert_cache);
+  g_hash_table_insert (cache->programs, key, gst_object_ref (shader));
+  G_UNLOCK (convert_cache);
+
+  return shader;
+}
+
+static ConvertFbo *
+_convert_cache_acquire_fbo (ConvertCache * cache, guint width, guint height)
+{
+  ConvertFbo *fbo = NULL;
+  GList *l;
+
+  G_LOCK (convert_cache);
+  for (l = cache->idle_fbos.head; l; l = l->next) {
+    ConvertFbo *idle = l->data;
+
+    if (idle->width == width && idle->height == height) {
+      g_queue_delete_link (&cache->idle_fbos, l);
+      fbo = idle;
+      break;
+    }
+  }
+  if (fbo)
+    cache->fbo_hits++;
+  else
+    cache->fbo_misses++;
+  G_UNLOCK (convert_cache);
+
+  return fbo;
+}
+
+static void
+_convert_cache_release_fbo (ConvertCache * cache, ConvertFbo * fbo)
+{
+  ConvertFbo *evicted = NULL;
+
+  G_LOCK (convert_cache);
+  g_queue_push_head (&cache->idle_fbos, fbo);
+  if (g_queue_get_length (&cache->idle_fbos) > MAX_IDLE_FBOS) {
+    evicted = g_queue_pop_tail (&cache->idle_fbos);
+    cache->fbo_evictions++;
+  }
+  G_UNLOCK (convert_cache);
+
+  if (evicted)
+    _free_fbo (cache, evicted);
+}
+
+/* RGBA textures to render to when the output memory can not be */
+static GstGLMemory *
+_convert_cache_acquire_texture (ConvertCache * cache, guint width,
+    guint height)
+{
+  GstGLMemory *tex = NULL;
+  GstVideoInfo info;
+  GList *l;
+
+  G_LOCK (convert_cache);
+  for (l = cache->idle_textures.head; l; l = l->next) {
+    GstGLMemory *idle = l->data;
+
+    if (GST_VIDEO_INFO_WIDTH (&idle->info) == width
+        && GST_VIDEO_INFO_HEIGHT (&idle->info) == height) {
+      g_queue_delete_link (&cache->idle_textures, l);
+      tex = idle;
+      break;
+    }
+  }
+  if (tex)
+    cache->texture_hits++;
+  else
+    cache->texture_misses++;
+  G_UNLOCK (convert_cache);
+
+  if (!tex) {
+    gst_video_info_set_format (&info, GST_VIDEO_FORMAT_RGBA, width, height);
+    tex = (GstGLMemory *) gst_gl_memory_alloc (cache->context, NULL, &info, 0,
+        NULL);
+  }
+
+  return tex;
+}
+
+static void
+_convert_cache_release_texture (ConvertCache * cache, GstGLMemory * tex)
+{
+  GstMemory *evicted = NULL;
+
+  G_LOCK (convert_cache);
+  g_queue_push_head (&cache->idle_textures, tex);
+  if (g_queue_get_length (&cache->idle_textures) > MAX_IDLE_TEXTURES) {
+    evicted = g_queue_pop_tail (&cache->idle_textures);
+    cache->texture_evictions++;
+  }
+  G_UNLOCK (convert_cache);
+
+  if (evicted)
+    gst_memory_unref (evicted);
+}
+
+/* a pool of output buffers for every output format in use */
+static ConvertPool *
+_convert_cache_acquire_pool (ConvertCache * cache, GstVideoInfo * info)
+{
+  ConvertPool *pool;
+  GstStructure *config;
+  GstCaps *caps;
+  gchar *caps_str;
+
+  caps = gst_video_info_to_caps (info);
+  gst_caps_set_features (caps, 0,
+      gst_caps_features_from_string (GST_CAPS_FEATURE_MEMORY_GL_MEMORY));
+  caps_str = gst_caps_to_string (caps);
+
+  G_LOCK (convert_cache);
+  pool = g_hash_table_lookup (cache->pools, caps_str);
+  if (pool) {
+    cache->pool_hits++;
+    pool->users++;
+    G_UNLOCK (convert_cache);
+    g_free (caps_str);
+    gst_caps_unref (caps);
+    return pool;
+  }
+  cache->pool_misses++;
+
+  pool = g_new0 (ConvertPool, 1);
+  pool->pool = gst_gl_buffer_pool_new (cache->context);
+  pool->caps_str = caps_str;
+  pool->users = 1;
+
+  config = gst_buffer_pool_get_config (pool->pool);
+  gst_buffer_pool_config_set_params (config, caps, info->size, 0, 0);
+  gst_buffer_pool_config_add_option (config, GST_BUFFER_POOL_OPTION_VIDEO_META);
+  if (!gst_buffer_pool_set_config (pool->pool, config)
+      || !gst_buffer_pool_set_active (pool->pool, TRUE)) {
+    G_UNLOCK (convert_cache);
+    GST_WARNING ("failed to set up the output buffer pool for %s", caps_str);
+    gst_caps_unref (caps);
+    _free_pool (pool);
+    return NULL;
+  }
+  g_hash_table_insert (cache->pools, pool->caps_str, pool);
+  G_UNLOCK (convert_cache);
+
+  gst_caps_unref (caps);
+
+  return pool;
+}
+
+static void
+_convert_cache_release_pool (ConvertCache * cache, ConvertPool * pool)
+{
+  G_LOCK (convert_cache);
+  if (--pool->users > 0) {
+    G_UNLOCK (convert_cache);
+    return;
+  }
+  g_hash_table_remove (cache->pools, pool->caps_str);
+  cache->pool_evictions++;
+  G_UNLOCK (convert_cache);
+
+  _free_pool (pool);
+}
+
+/**
+ * gst_gl_color_convert_get_context_stats:
+ * @context: a #GstGLContext
+ *
+ * Retrieves how often the #GstGLColorConvert objects of @context reused
+ * each other's resources.  The returned structure contains the number of
+ * "programs" and "buffer-pools" currently shared, "framebuffers" and
+ * "textures" currently idle, and the "-hits", "-misses" and "-evictions"
+ * counters of each of "program", "framebuffer", "texture" and
+ * "buffer-pool" as #guint fields.
+ *
+ * Returns: (transfer full) (nullable): a new #GstStructure, or %NULL if
+ * there is no #GstGLColorConvert for @context
+ */
+GstStructure *
+gst_gl_color_convert_get_context_stats (GstGLContext * context)
+{
+  ConvertCache *cache;
+  GstStructure *stats = NULL;
+
+  g_return_val_if_fail (GST_GL_IS_CONTEXT (context), NULL);
+
+  G_LOCK (convert_cache);
+  cache = g_object_get_qdata (G_OBJECT (context), convert_cache_quark);
+  if (cache) {
+    stats = gst_structure_new ("GstGLColorConvertStats",
+        "programs", G_TYPE_UINT, g_hash_table_size (cache->programs),
+        "program-hits", G_TYPE_UINT, cache->program_hits,
+        "program-misses", G_TYPE_UINT, cache->program_misses,
+        "framebuffers", G_TYPE_UINT, g_queue_get_length (&cache->idle_fbos),
+        "framebuffer-hits", G_TYPE_UINT, cache->fbo_hits,
+        "framebuffer-misses", G_TYPE_UINT, cache->fbo_misses,
+        "framebuffer-evictions", G_TYPE_UINT, cache->fbo_evictions,
+        "textures", G_TYPE_UINT, g_queue_get_length (&cache->idle_textures),
+        "texture-hits", G_TYPE_UINT, cache->texture_hits,
+        "texture-misses", G_TYPE_UINT, cache->texture_misses,
+        "texture-evictions", G_TYPE_UINT, cache->texture_evictions,
+        "buffer-pools", G_TYPE_UINT, g_hash_table_size (cache->pools),
+        "buffer-pool-hits", G_TYPE_UINT, cache->pool_hits,
+        "buffer-pool-misses", G_TYPE_UINT, cache->pool_misses,
+        "buffer-pool-evictions", G_TYPE_UINT, cache->pool_evictions, NULL);
+  }
+  G_UNLOCK (convert_cache);
+
+  return stats;
 }
 
 static void
@@ -522,6 +899,7 @@ gst_gl_color_convert_new (GstGLContext * context)
   convert = g_object_new (GST_TYPE_GL_COLOR_CONVERT, NULL);
 
   convert->context = gst_object_ref (context);
+  convert->priv->cache = _convert_cache_ref (context);
 
   gst_video_info_set_format (&convert->in_info, GST_VIDEO_FORMAT_ENCODED, 0, 0);
   gst_video_info_set_format (&convert->out_info, GST_VIDEO_FORMAT_ENCODED, 0,
@@ -542,6 +920,11 @@ gst_gl_color_convert_finalize (GObject * object)
 
   gst_gl_color_convert_reset (convert);
 
+  if (convert->priv->cache) {
+    _convert_cache_unref (convert->priv->cache);
+    convert->priv->cache = NULL;
+  }
+
   if (convert->context) {
     gst_object_unref (convert->context);
     convert->context = NULL;
@@ -576,19 +959,26 @@ gst_gl_color_convert_reset (GstGLColorConvert * convert)
 {
   guint i;
 
-  if (convert->fbo || convert->depth_buffer) {
-    gst_gl_context_del_fbo (convert->context, convert->fbo,
-        convert->depth_buffer);
+  /* hand everything back to the other converters of the context */
+  if (convert->priv->fbo) {
+    _convert_cache_release_fbo (convert->priv->cache, convert->priv->fbo);
+    convert->priv->fbo = NULL;
     convert->fbo = 0;
     convert->depth_buffer = 0;
   }
 
   for (i = 0; i < convert->priv->convert_info.out_n_textures; i++) {
     if (convert->priv->out_tex[i])
-      gst_memory_unref ((GstMemory *) convert->priv->out_tex[i]);
+      _convert_cache_release_texture (convert->priv->cache,
+          convert->priv->out_tex[i]);
     convert->priv->out_tex[i] = NULL;
   }
 
+  if (convert->priv->pool) {
+    _convert_cache_release_pool (convert->priv->cache, convert->priv->pool);
+    convert->priv->pool = NULL;
+  }
+
   convert->priv->convert_info.chroma_sampling[0] = 1.0f;
   convert->priv->convert_info.chroma_sampling[1] = 1.0f;
 
@@ -1303,9 +1693,7 @@ static gboolean
 _init_convert (GstGLColorConvert * convert)
 {
   GstGLFuncs *gl;
-  gboolean res;
   struct ConvertInfo *info = &convert->priv->convert_info;
-  gint i;
 
   gl = convert->context->gl_vtable;
 
@@ -1373,11 +1761,11 @@ _init_convert (GstGLColorConvert * convert)
     goto incompatible_api;
   }
 
-  res =
-      gst_gl_context_gen_shader (convert->context, text_vertex_shader,
-      info->frag_prog, &convert->shader);
-  g_free (info->frag_prog);
-  if (!res)
+  /* the uniforms are set for every draw, the program is shared */
+  convert->shader = _convert_cache_get_program (convert->priv->cache, convert,
+      info->frag_prog);
+  info->frag_prog = NULL;
+  if (!convert->shader)
     goto error;
 
   convert->priv->attr_position =
@@ -1385,38 +1773,6 @@ _init_convert (GstGLColorConvert * convert)
   convert->priv->attr_texture =
       gst_gl_shader_get_attribute_location (convert->shader, "a_texcoord");
 
-  gst_gl_shader_use (convert->shader);
-
-  if (info->cms_offset && info->cms_coeff1
-      && info->cms_coeff2 && info->cms_coeff3) {
-    gst_gl_shader_set_uniform_3fv (convert->shader, "offset", 1,
-        info->cms_offset);
-    gst_gl_shader_set_uniform_3fv (convert->shader, "coeff1", 1,
-        info->cms_coeff1);
-    gst_gl_shader_set_uniform_3fv (convert->shader, "coeff2", 1,
-        info->cms_coeff2);
-    gst_gl_shader_set_uniform_3fv (convert->shader, "coeff3", 1,
-        info->cms_coeff3);
-  }
-
-  for (i = info->in_n_textures; i >= 0; i--) {
-    if (info->shader_tex_names[i])
-      gst_gl_shader_set_uniform_1i (convert->shader, info->shader_tex_names[i],
-          i);
-  }
-
-  gst_gl_shader_set_uniform_1f (convert->shader, "width",
-      GST_VIDEO_INFO_WIDTH (&convert->in_info));
-  gst_gl_shader_set_uniform_1f (convert->shader, "height",
-      GST_VIDEO_INFO_HEIGHT (&convert->in_info));
-
-  if (info->chroma_sampling[0] > 0.0f && info->chroma_sampling[1] > 0.0f) {
-    gst_gl_shader_set_uniform_2fv (convert->shader, "chroma_sampling", 1,
-        info->chroma_sampling);
-  }
-
-  gst_gl_context_clear_shader (convert->context);
-
   if (!_init_convert_fbo (convert)) {
     goto error;
   }
@@ -1497,6 +1853,14 @@ _init_convert_fbo (GstGLColorConvert * convert)
 
   GST_INFO ("Context, EXT_framebuffer_object supported: yes");
 
+  convert->priv->fbo = _convert_cache_acquire_fbo (convert->priv->cache,
+      out_width, out_height);
+  if (convert->priv->fbo) {
+    convert->fbo = convert->priv->fbo->fbo;
+    convert->depth_buffer = convert->priv->fbo->depth_buffer;
+    return TRUE;
+  }
+
   /* setup FBO */
   gl->GenFramebuffers (1, &convert->fbo);
   gl->BindFramebuffer (GL_FRAMEBUFFER, convert->fbo);
@@ -1544,6 +1908,10 @@ _init_convert_fbo (GstGLColorConvert * convert)
         "GL framebuffer status incomplete");
 
     gl->DeleteTextures (1, &fake_texture);
+    gst_gl_context_del_fbo (convert->context, convert->fbo,
+        convert->depth_buffer);
+    convert->fbo = 0;
+    convert->depth_buffer = 0;
 
     return FALSE;
   }
@@ -1553,9 +1921,28 @@ _init_convert_fbo (GstGLColorConvert * convert)
 
   gl->DeleteTextures (1, &fake_texture);
 
+  convert->priv->fbo = g_new0 (ConvertFbo, 1);
+  convert->priv->fbo->fbo = convert->fbo;
+  convert->priv->fbo->depth_buffer = convert->depth_buffer;
+  convert->priv->fbo->width = out_width;
+  convert->priv->fbo->height = out_height;
+
   return TRUE;
 }
 
+/* YV12 is the same as I420 except planes 1+2 swapped, so render the chroma
+ * planes straight into the swapped memories.  Output buffers come from the
+ * shared pool, which would discard them if their memories were replaced. */
+static guint
+_out_tex_memory_index (GstGLColorConvert * convert, guint tex)
+{
+  if (GST_VIDEO_INFO_FORMAT (&convert->out_info) == GST_VIDEO_FORMAT_YV12
+      && (tex == 1 || tex == 2))
+    return 3 - tex;
+
+  return tex;
+}
+
 static gboolean
 _do_convert_one_view (GstGLContext * context, GstGLColorConvert * convert,
     guint view_num)
@@ -1594,7 +1981,7 @@ _do_convert_one_view (GstGLContext * context, GstGLColorConvert * convert,
   for (j = 0; j < c_info->out_n_textures; j++) {
     GstGLMemory *out_tex =
         (GstGLMemory *) gst_buffer_peek_memory (convert->outbuf,
-        j + out_plane_offset);
+        _out_tex_memory_index (convert, j) + out_plane_offset);
     gint mem_width, mem_height;
 
     if (!gst_is_gl_memory ((GstMemory *) out_tex)) {
@@ -1612,15 +1999,10 @@ _do_convert_one_view (GstGLContext * context, GstGLColorConvert * convert,
       /* Luminance formats are not color renderable */
       /* renderering to a framebuffer only renders the intersection of all
        * the attachments i.e. the smallest attachment size */
-      GstVideoInfo temp_info;
-
-      gst_video_info_set_format (&temp_info, GST_VIDEO_FORMAT_RGBA, out_width,
-          out_height);
-
       if (!convert->priv->out_tex[j])
         convert->priv->out_tex[j] =
-            (GstGLMemory *) gst_gl_memory_alloc (context, NULL, &temp_info, 0,
-            NULL);
+            _convert_cache_acquire_texture (convert->priv->cache, out_width,
+            out_height);
     } else {
       convert->priv->out_tex[j] = out_tex;
     }
@@ -1648,7 +2030,7 @@ out:
   for (j--; j >= 0; j--) {
     GstGLMemory *out_tex =
         (GstGLMemory *) gst_buffer_peek_memory (convert->outbuf,
-        j + out_plane_offset);
+        _out_tex_memory_index (convert, j) + out_plane_offset);
     gint mem_width, mem_height;
 
     gst_memory_unmap ((GstMemory *) convert->priv->out_tex[j], &out_info[j]);
@@ -1685,17 +2067,6 @@ out:
     }
   }
 
-  /* YV12 the same as I420 except planes 1+2 swapped */
-  if (GST_VIDEO_INFO_FORMAT (&convert->out_info) == GST_VIDEO_FORMAT_YV12) {
-    GstMemory *mem1 =
-        gst_buffer_get_memory (convert->outbuf, 1 + out_plane_offset);
-    GstMemory *mem2 =
-        gst_buffer_get_memory (convert->outbuf, 2 + out_plane_offset);
-
-    gst_buffer_replace_memory (convert->outbuf, 1 + out_plane_offset, mem2);
-    gst_buffer_replace_memory (convert->outbuf, 2 + out_plane_offset, mem1);
-  }
-
   for (i--; i >= 0; i--) {
     gst_memory_unmap ((GstMemory *) convert->priv->in_tex[i], &in_info[i]);
   }
@@ -1719,9 +2090,13 @@ _do_convert (GstGLContext * context, GstGLColorConvert * convert)
     return;
   }
 
-  convert->outbuf = gst_buffer_new ();
-  if (!gst_gl_memory_setup_buffer (convert->context, NULL, &convert->out_info,
-          NULL, convert->outbuf)) {
+  if (!convert->priv->pool)
+    convert->priv->pool = _convert_cache_acquire_pool (convert->priv->cache,
+        &convert->out_info);
+  if (!convert->priv->pool
+      || gst_buffer_pool_acquire_buffer (convert->priv->pool->pool,
+          &convert->outbuf, NULL) != GST_FLOW_OK) {
+    convert->outbuf = NULL;
     convert->priv->result = FALSE;
     return;
   }
@@ -1742,8 +2117,11 @@ _do_convert (GstGLContext * context, GstGLColorConvert * convert)
   }
 
   if (convert->outbuf) {
-    GstGLSyncMeta *sync_meta =
-        gst_buffer_add_gl_sync_meta (convert->context, convert->outbuf);
+    GstGLSyncMeta *sync_meta = gst_buffer_get_gl_sync_meta (convert->outbuf);
+
+    if (!sync_meta)
+      sync_meta =
+          gst_buffer_add_gl_sync_meta (convert->context, convert->outbuf);
 
     if (sync_meta)
       gst_gl_sync_meta_set_sync_point (sync_meta, convert->context);
@@ -1804,6 +2182,34 @@ _do_convert_draw (GstGLContext * context, GstGLColorConvert * convert)
 
   gst_gl_shader_use (convert->shader);
 
+  if (c_info->cms_offset && c_info->cms_coeff1
+      && c_info->cms_coeff2 && c_info->cms_coeff3) {
+    gst_gl_shader_set_uniform_3fv (convert->shader, "offset", 1,
+        c_info->cms_offset);
+    gst_gl_shader_set_uniform_3fv (convert->shader, "coeff1", 1,
+        c_info->cms_coeff1);
+    gst_gl_shader_set_uniform_3fv (convert->shader, "coeff2", 1,
+        c_info->cms_coeff2);
+    gst_gl_shader_set_uniform_3fv (convert->shader, "coeff3", 1,
+        c_info->cms_coeff3);
+  }
+
+  for (i = c_info->in_n_textures; i >= 0; i--) {
+    if (c_info->shader_tex_names[i])
+      gst_gl_shader_set_uniform_1i (convert->shader,
+          c_info->shader_tex_names[i], i);
+  }
+
+  gst_gl_shader_set_uniform_1f (convert->shader, "width",
+      GST_VIDEO_INFO_WIDTH (&convert->in_info));
+  gst_gl_shader_set_uniform_1f (convert->shader, "height",
+      GST_VIDEO_INFO_HEIGHT (&convert->in_info));
+
+  if (c_info->chroma_sampling[0] > 0.0f && c_info->chroma_sampling[1] > 0.0f) {
+    gst_gl_shader_set_uniform_2fv (convert->shader, "chroma_sampling", 1,
+        c_info->chroma_sampling);
+  }
+
   if (gl->BindVertexArray)
     gl->BindVertexArray (convert->priv->vao);
   else
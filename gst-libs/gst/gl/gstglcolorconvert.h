@@ -115,6 +115,8 @@ gboolean    gst_gl_color_convert_set_caps    (GstGLColorConvert * convert,
 
 GstBuffer * gst_gl_color_convert_perform    (GstGLColorConvert * convert, GstBuffer * inbuf);
 
+GstStructure * gst_gl_color_convert_get_context_stats (GstGLContext * context);
+
 G_END_DECLS
 
 #endif /* __GST_GL_COLOR_CONVERT_H__ */
@@ -197,8 +197,29 @@ struct _GstGLContextPrivate
   gint gl_minor;
 
   gchar *gl_exts;
+
+  /* work queued with gst_gl_context_thread_add_async() */
+  GMutex queue_lock;
+  GCond queue_cond;
+  GQueue queue;
+  gboolean drain_pending;
+  guint64 queued_serial;
+  guint64 done_serial;
+
+  /* protected by queue_lock */
+  guint64 n_round_trips;
+  guint64 n_async;
+  guint64 n_batches;
 };
 
+typedef struct
+{
+  GstGLContextThreadFunc func;
+  gpointer data;
+  GDestroyNotify notify;
+  guint64 serial;
+} GstGLQueuedWork;
+
 typedef struct
 {
   GstGLContext parent;
@@ -259,6 +280,10 @@ gst_gl_context_init (GstGLContext * context)
   g_cond_init (&context->priv->destroy_cond);
   context->priv->created = FALSE;
 
+  g_mutex_init (&context->priv->queue_lock);
+  g_cond_init (&context->priv->queue_cond);
+  g_queue_init (&context->priv->queue);
+
   g_weak_ref_init (&context->priv->other_context_ref, NULL);
 }
 
@@ -618,6 +643,11 @@ static void
 gst_gl_context_finalize (GObject * object)
 {
   GstGLContext *context = GST_GL_CONTEXT (object);
+  GstGLQueuedWork *work;
+
+  /* run what is still queued while the gl thread is there to do so */
+  if (context->window && context->priv->alive)
+    gst_gl_context_thread_wait (context, context->priv->queued_serial);
 
   if (context->window) {
     gst_gl_window_set_resize_callback (context->window, NULL, NULL, NULL);
@@ -661,6 +691,16 @@ gst_gl_context_finalize (GObject * object)
   g_free (context->priv->gl_exts);
   g_weak_ref_clear (&context->priv->other_context_ref);
 
+  while ((work = g_queue_pop_head (&context->priv->queue))) {
+    GST_WARNING_OBJECT (context, "dropping queued function:%p data:%p",
+        work->func, work->data);
+    if (work->notify)
+      work->notify (work->data);
+    g_slice_free (GstGLQueuedWork, work);
+  }
+  g_mutex_clear (&context->priv->queue_lock);
+  g_cond_clear (&context->priv->queue_cond);
+
   GST_DEBUG_OBJECT (context, "End of finalize");
   G_OBJECT_CLASS (gst_gl_context_parent_class)->finalize (object);
 }
@@ -1592,9 +1632,40 @@ typedef struct
   gpointer data;
 } RunGenericData;
 
+/* Called in the gl thread */
+static void
+_gst_gl_context_drain_queue (GstGLContext * context)
+{
+  GstGLContextPrivate *priv = context->priv;
+  GstGLQueuedWork *work;
+
+  g_mutex_lock (&priv->queue_lock);
+  while ((work = g_queue_pop_head (&priv->queue))) {
+    g_mutex_unlock (&priv->queue_lock);
+
+    GST_TRACE_OBJECT (context, "running queued function:%p data:%p serial:%"
+        G_GUINT64_FORMAT, work->func, work->data, work->serial);
+
+    work->func (context, work->data);
+    if (work->notify)
+      work->notify (work->data);
+
+    g_mutex_lock (&priv->queue_lock);
+    /* a later item may already have been run by another drain */
+    priv->done_serial = MAX (priv->done_serial, work->serial);
+    g_cond_broadcast (&priv->queue_cond);
+    g_slice_free (GstGLQueuedWork, work);
+  }
+  priv->drain_pending = FALSE;
+  g_mutex_unlock (&priv->queue_lock);
+}
+
 static void
 _gst_gl_context_thread_run_generic (RunGenericData * data)
 {
+  /* keep the order with the work queued before */
+  _gst_gl_context_drain_queue (data->context);
+
   GST_TRACE_OBJECT (data->context, "running function:%p data:%p", data->func,
       data->data);
 
@@ -1633,6 +1704,12 @@ gst_gl_context_thread_add (GstGLContext * context,
   rdata.data = data;
   rdata.func = func;
 
+  if (context->priv->gl_thread != g_thread_self ()) {
+    g_mutex_lock (&context->priv->queue_lock);
+    context->priv->n_round_trips++;
+    g_mutex_unlock (&context->priv->queue_lock);
+  }
+
   window = gst_gl_context_get_window (context);
 
   gst_gl_window_send_message (window,
@@ -1641,6 +1718,142 @@ gst_gl_context_thread_add (GstGLContext * context,
   gst_object_unref (window);
 }
 
+/**
+ * gst_gl_context_thread_add_async:
+ * @context: a #GstGLContext
+ * @func: a #GstGLContextThreadFunc
+ * @data: (closure): user data to call @func with
+ * @notify: (allow-none): called with @data after @func has run
+ *
+ * Queues @func for execution in the OpenGL thread of @context with @data and
+ * returns without waiting for it.  Everything queued before the OpenGL
+ * thread picks the queue up runs in one go, in order, and before any
+ * function passed to gst_gl_context_thread_add() afterwards.
+ *
+ * Use gst_gl_context_thread_wait() with the returned serial to wait for @func
+ * only when its result is needed.
+ *
+ * MT-safe
+ *
+ * Returns: the serial of @func
+ */
+guint64
+gst_gl_context_thread_add_async (GstGLContext * context,
+    GstGLContextThreadFunc func, gpointer data, GDestroyNotify notify)
+{
+  GstGLContextPrivate *priv;
+  GstGLQueuedWork *work;
+  GstGLWindow *window;
+  gboolean post;
+  guint64 serial;
+
+  g_return_val_if_fail (GST_GL_IS_CONTEXT (context), 0);
+  g_return_val_if_fail (func != NULL, 0);
+
+  priv = context->priv;
+
+  if (GST_GL_IS_WRAPPED_CONTEXT (context)) {
+    g_return_val_if_fail (priv->active_thread == g_thread_self (), 0);
+    func (context, data);
+    if (notify)
+      notify (data);
+    return 0;
+  }
+
+  work = g_slice_new (GstGLQueuedWork);
+  work->func = func;
+  work->data = data;
+  work->notify = notify;
+
+  g_mutex_lock (&priv->queue_lock);
+  serial = work->serial = ++priv->queued_serial;
+  g_queue_push_tail (&priv->queue, work);
+  priv->n_async++;
+  /* one message for everything queued until the gl thread gets to it */
+  post = !priv->drain_pending;
+  if (post) {
+    priv->drain_pending = TRUE;
+    priv->n_batches++;
+  }
+  g_mutex_unlock (&priv->queue_lock);
+
+  GST_TRACE_OBJECT (context, "queued function:%p data:%p serial:%"
+      G_GUINT64_FORMAT, func, data, serial);
+
+  if (post) {
+    window = gst_gl_context_get_window (context);
+    gst_gl_window_send_message_async (window,
+        GST_GL_WINDOW_CB (_gst_gl_context_drain_queue), context, NULL);
+    gst_object_unref (window);
+  }
+
+  return serial;
+}
+
+/**
+ * gst_gl_context_thread_wait:
+ * @context: a #GstGLContext
+ * @serial: a serial returned by gst_gl_context_thread_add_async()
+ *
+ * Blocks until the function queued with @serial and everything queued
+ * before it have run.  Returns immediately if they already have, and does
+ * not send anything to the OpenGL thread otherwise.
+ *
+ * MT-safe
+ */
+void
+gst_gl_context_thread_wait (GstGLContext * context, guint64 serial)
+{
+  GstGLContextPrivate *priv;
+
+  g_return_if_fail (GST_GL_IS_CONTEXT (context));
+
+  priv = context->priv;
+
+  if (serial == 0)
+    return;
+
+  if (priv->gl_thread == g_thread_self ()) {
+    _gst_gl_context_drain_queue (context);
+    return;
+  }
+
+  g_mutex_lock (&priv->queue_lock);
+  while (priv->done_serial < serial)
+    g_cond_wait (&priv->queue_cond, &priv->queue_lock);
+  g_mutex_unlock (&priv->queue_lock);
+}
+
+/**
+ * gst_gl_context_get_thread_stats:
+ * @context: a #GstGLContext
+ *
+ * Retrieves how @context has been used from other threads.  The returned
+ * structure contains the #guint64 fields "round-trips", the number of
+ * gst_gl_context_thread_add() calls that waited for the OpenGL thread,
+ * "async", the number of functions queued with
+ * gst_gl_context_thread_add_async(), and "batches", the number of times
+ * the OpenGL thread was woken up to run them.
+ *
+ * Returns: (transfer full): a new #GstStructure
+ */
+GstStructure *
+gst_gl_context_get_thread_stats (GstGLContext * context)
+{
+  GstStructure *stats;
+
+  g_return_val_if_fail (GST_GL_IS_CONTEXT (context), NULL);
+
+  g_mutex_lock (&context->priv->queue_lock);
+  stats = gst_structure_new ("GstGLContextThreadStats",
+      "round-trips", G_TYPE_UINT64, context->priv->n_round_trips,
+      "async", G_TYPE_UINT64, context->priv->n_async,
+      "batches", G_TYPE_UINT64, context->priv->n_batches, NULL);
+  g_mutex_unlock (&context->priv->queue_lock);
+
+  return stats;
+}
+
 /**
  * gst_gl_context_get_gl_version:
  * @context: a #GstGLContext
@@ -154,6 +154,12 @@ gboolean gst_gl_context_fill_info (GstGLContext * context, GError ** error);
 void gst_gl_context_thread_add (GstGLContext * context,
     GstGLContextThreadFunc func, gpointer data);
 
+guint64 gst_gl_context_thread_add_async (GstGLContext * context,
+    GstGLContextThreadFunc func, gpointer data, GDestroyNotify notify);
+void gst_gl_context_thread_wait (GstGLContext * context, guint64 serial);
+
+GstStructure * gst_gl_context_get_thread_stats (GstGLContext * context);
+
 GST_DEBUG_CATEGORY_EXTERN (gst_gl_context_debug);
 
 G_END_DECLS
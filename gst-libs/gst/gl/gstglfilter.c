@@ -894,6 +894,18 @@ inbuf_error:
   return ret;
 }
 
+static guint64
+_get_round_trips (GstGLContext * context)
+{
+  GstStructure *stats = gst_gl_context_get_thread_stats (context);
+  guint64 round_trips = 0;
+
+  gst_structure_get_uint64 (stats, "round-trips", &round_trips);
+  gst_structure_free (stats);
+
+  return round_trips;
+}
+
 static GstFlowReturn
 gst_gl_filter_transform (GstBaseTransform * bt, GstBuffer * inbuf,
     GstBuffer * outbuf)
@@ -903,6 +915,8 @@ gst_gl_filter_transform (GstBaseTransform * bt, GstBuffer * inbuf,
   GstGLDisplay *display = GST_GL_BASE_FILTER (bt)->display;
   GstGLContext *context = GST_GL_BASE_FILTER (bt)->context;
   GstGLSyncMeta *out_sync_meta, *in_sync_meta;
+  gboolean log_round_trips;
+  guint64 round_trips = 0;
   gboolean ret;
 
   if (!display)
@@ -910,6 +924,11 @@ gst_gl_filter_transform (GstBaseTransform * bt, GstBuffer * inbuf,
 
   g_assert (filter_class->filter || filter_class->filter_texture);
 
+  log_round_trips =
+      gst_debug_category_get_threshold (GST_CAT_DEFAULT) >= GST_LEVEL_LOG;
+  if (log_round_trips)
+    round_trips = _get_round_trips (context);
+
   in_sync_meta = gst_buffer_get_gl_sync_meta (inbuf);
   if (in_sync_meta)
     gst_gl_sync_meta_wait (in_sync_meta, context);
@@ -923,6 +942,11 @@ gst_gl_filter_transform (GstBaseTransform * bt, GstBuffer * inbuf,
   if (out_sync_meta)
     gst_gl_sync_meta_set_sync_point (out_sync_meta, context);
 
+  /* includes the ones of the other users of the context */
+  if (log_round_trips)
+    GST_LOG_OBJECT (filter, "%" G_GUINT64_FORMAT " round trips to the gl "
+        "thread for this buffer", _get_round_trips (context) - round_trips);
+
   return ret ? GST_FLOW_OK : GST_FLOW_ERROR;
 }
 
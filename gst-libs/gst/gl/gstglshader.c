@@ -23,6 +23,10 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
+#include <glib/gstdio.h>
+
 #include "gl.h"
 #include "gstglshader.h"
 
@@ -60,6 +64,15 @@ static const gchar *simple_fragment_shader_str_gles2 =
 #ifndef GLhandleARB
 #define GLhandleARB GLuint
 #endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
 
 #define GST_GL_SHADER_GET_PRIVATE(o)					\
   (G_TYPE_INSTANCE_GET_PRIVATE((o), GST_GL_TYPE_SHADER, GstGLShaderPrivate))
@@ -115,8 +128,29 @@ struct _GstGLShaderPrivate
   GstGLAPI gl_api;
 
   GstGLShaderVTable vtable;
+
+  /* name -> location, valid for the current program_handle */
+  GHashTable *uniform_locations;
+  GHashTable *attribute_locations;
+
+  gchar *cache_key;
 };
 
+/* Linked programs are cached for the whole process, keyed by a checksum of
+ * their sources and of the GL implementation that built them, so that
+ * shaders with the same sources only need to be compiled once.  With
+ * GST_GL_SHADER_CACHE_DIR set, the binaries are also stored there for the
+ * next run. */
+typedef struct
+{
+  GLenum format;
+  GBytes *binary;
+} GstGLProgramBinary;
+
+G_LOCK_DEFINE_STATIC (program_cache);
+static GHashTable *program_cache;
+static gchar *program_cache_dir;
+
 GST_DEBUG_CATEGORY_STATIC (gst_gl_shader_debug);
 #define GST_CAT_DEFAULT gst_gl_shader_debug
 
@@ -160,6 +194,9 @@ gst_gl_shader_finalize (GObject * object)
 
   g_free (priv->vertex_src);
   g_free (priv->fragment_src);
+  g_free (priv->cache_key);
+  g_hash_table_unref (priv->uniform_locations);
+  g_hash_table_unref (priv->attribute_locations);
 
   gst_gl_context_thread_add (shader->context,
       (GstGLContextThreadFunc) _cleanup_shader, shader);
@@ -332,6 +369,11 @@ gst_gl_shader_init (GstGLShader * self)
   priv->compiled = FALSE;
   priv->active = FALSE;         /* unused at the moment */
 
+  priv->uniform_locations =
+      g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  priv->attribute_locations =
+      g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
   /* FIXME: add API to get/set this for each shader */
   priv->gl_api = GST_GL_API_ANY;
 }
@@ -479,6 +521,242 @@ _maybe_prepend_version (GstGLShader * shader, const gchar * shader_str,
   *n_vertex_sources = n;
 }
 
+static void
+_program_binary_free (GstGLProgramBinary * program)
+{
+  g_bytes_unref (program->binary);
+  g_slice_free (GstGLProgramBinary, program);
+}
+
+static gboolean
+_program_cache_init (GstGLContext * context)
+{
+  static volatile gsize _init = 0;
+  const GstGLFuncs *gl = context->gl_vtable;
+  GLint n_formats = 0;
+
+  if (g_once_init_enter (&_init)) {
+    const gchar *dir = g_getenv ("GST_GL_SHADER_CACHE_DIR");
+
+    program_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+        (GDestroyNotify) _program_binary_free);
+
+    if (dir && *dir) {
+      if (g_mkdir_with_parents (dir, 0700) == 0)
+        program_cache_dir = g_strdup (dir);
+      else
+        GST_WARNING ("could not create shader cache directory %s", dir);
+    }
+
+    g_once_init_leave (&_init, 1);
+  }
+
+  if (!gl->GetProgramBinary || !gl->ProgramBinary)
+    return FALSE;
+
+  gl->GetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats);
+
+  return n_formats > 0;
+}
+
+static gchar *
+_program_cache_key (GstGLShader * shader)
+{
+  GstGLShaderPrivate *priv = shader->priv;
+  const GstGLFuncs *gl = shader->context->gl_vtable;
+  GChecksum *checksum = g_checksum_new (G_CHECKSUM_SHA1);
+  GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+  gint major, minor;
+  gchar *key;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (names); i++) {
+    const gchar *str = (const gchar *) gl->GetString (names[i]);
+
+    if (str)
+      g_checksum_update (checksum, (const guchar *) str, strlen (str) + 1);
+  }
+
+  /* the context version decides the #version header we prepend */
+  gst_gl_context_get_gl_version (shader->context, &major, &minor);
+  g_checksum_update (checksum, (const guchar *) &major, sizeof (major));
+  g_checksum_update (checksum, (const guchar *) &minor, sizeof (minor));
+
+  g_checksum_update (checksum, (const guchar *) "v", 1);
+  if (priv->vertex_src)
+    g_checksum_update (checksum, (const guchar *) priv->vertex_src, -1);
+  g_checksum_update (checksum, (const guchar *) "f", 1);
+  if (priv->fragment_src)
+    g_checksum_update (checksum, (const guchar *) priv->fragment_src, -1);
+
+  key = g_strdup (g_checksum_get_string (checksum));
+  g_checksum_free (checksum);
+
+  return key;
+}
+
+static gchar *
+_program_cache_filename (const gchar * key)
+{
+  gchar *basename = g_strconcat (key, ".bin", NULL);
+  gchar *filename = g_build_filename (program_cache_dir, basename, NULL);
+
+  g_free (basename);
+
+  return filename;
+}
+
+/* called with the program_cache lock */
+static GstGLProgramBinary *
+_program_cache_lookup_unlocked (const gchar * key)
+{
+  GstGLProgramBinary *program;
+  gchar *filename, *contents;
+  gsize length;
+  guint32 format;
+
+  program = g_hash_table_lookup (program_cache, key);
+  if (program || !program_cache_dir)
+    return program;
+
+  filename = _program_cache_filename (key);
+  if (g_file_get_contents (filename, &contents, &length, NULL)) {
+    if (length > sizeof (format)) {
+      memcpy (&format, contents, sizeof (format));
+
+      program = g_slice_new (GstGLProgramBinary);
+      program->format = format;
+      program->binary = g_bytes_new (contents + sizeof (format),
+          length - sizeof (format));
+      g_hash_table_insert (program_cache, g_strdup (key), program);
+    }
+    g_free (contents);
+  }
+  g_free (filename);
+
+  return program;
+}
+
+static gboolean
+_load_program_binary (GstGLShader * shader)
+{
+  GstGLShaderPrivate *priv = shader->priv;
+  const GstGLFuncs *gl = shader->context->gl_vtable;
+  GstGLProgramBinary *program;
+  GLint status = GL_FALSE;
+  GBytes *binary = NULL;
+  GLenum format = 0;
+  gsize size;
+
+  G_LOCK (program_cache);
+  program = _program_cache_lookup_unlocked (priv->cache_key);
+  if (program) {
+    format = program->format;
+    binary = g_bytes_ref (program->binary);
+  }
+  G_UNLOCK (program_cache);
+
+  if (!binary)
+    return FALSE;
+
+  gl->ProgramBinary (priv->program_handle, format,
+      g_bytes_get_data (binary, &size), size);
+  g_bytes_unref (binary);
+
+  priv->vtable.GetProgramiv (priv->program_handle, GL_LINK_STATUS, &status);
+  if (status == GL_TRUE) {
+    GST_DEBUG_OBJECT (shader, "loaded program %u from cached binary %s",
+        priv->program_handle, priv->cache_key);
+    return TRUE;
+  }
+
+  /* the driver changed or the binary is corrupt, build it again */
+  GST_INFO_OBJECT (shader, "cached program binary %s rejected",
+      priv->cache_key);
+
+  G_LOCK (program_cache);
+  g_hash_table_remove (program_cache, priv->cache_key);
+  if (program_cache_dir) {
+    gchar *filename = _program_cache_filename (priv->cache_key);
+
+    g_unlink (filename);
+    g_free (filename);
+  }
+  G_UNLOCK (program_cache);
+
+  return FALSE;
+}
+
+static void
+_store_program_binary (GstGLShader * shader)
+{
+  GstGLShaderPrivate *priv = shader->priv;
+  const GstGLFuncs *gl = shader->context->gl_vtable;
+  GstGLProgramBinary *program;
+  GLint length = 0;
+  GLsizei written = 0;
+  GLenum format = 0;
+  guint8 *data;
+
+  priv->vtable.GetProgramiv (priv->program_handle, GL_PROGRAM_BINARY_LENGTH,
+      &length);
+  if (length <= 0)
+    return;
+
+  /* leave room for the format when writing to disk */
+  data = g_malloc (sizeof (guint32) + length);
+  gl->GetProgramBinary (priv->program_handle, length, &written, &format,
+      data + sizeof (guint32));
+  if (written <= 0) {
+    g_free (data);
+    return;
+  }
+
+  program = g_slice_new (GstGLProgramBinary);
+  program->format = format;
+  program->binary = g_bytes_new (data + sizeof (guint32), written);
+
+  G_LOCK (program_cache);
+  g_hash_table_insert (program_cache, g_strdup (priv->cache_key), program);
+  if (program_cache_dir) {
+    gchar *filename = _program_cache_filename (priv->cache_key);
+    guint32 format32 = format;
+
+    memcpy (data, &format32, sizeof (format32));
+    if (!g_file_set_contents (filename, (const gchar *) data,
+            sizeof (guint32) + written, NULL))
+      GST_WARNING_OBJECT (shader, "could not write %s", filename);
+    g_free (filename);
+  }
+  G_UNLOCK (program_cache);
+
+  g_free (data);
+
+  GST_DEBUG_OBJECT (shader, "cached binary %s of program %u (%i bytes)",
+      priv->cache_key, priv->program_handle, written);
+}
+
+static GLint
+_get_uniform_location (GstGLShader * shader, const gchar * name)
+{
+  GstGLShaderPrivate *priv = shader->priv;
+  const GstGLFuncs *gl = shader->context->gl_vtable;
+  gpointer value;
+  GLint location;
+
+  if (g_hash_table_lookup_extended (priv->uniform_locations, name, NULL,
+          &value))
+    return GPOINTER_TO_INT (value);
+
+  location = gl->GetUniformLocation (priv->program_handle, name);
+  g_hash_table_insert (priv->uniform_locations, g_strdup (name),
+      GINT_TO_POINTER (location));
+
+  GST_TRACE_OBJECT (shader, "uniform '%s' has location %i", name, location);
+
+  return location;
+}
+
 gboolean
 gst_gl_shader_compile (GstGLShader * shader, GError ** error)
 {
@@ -506,6 +784,28 @@ gst_gl_shader_compile (GstGLShader * shader, GError ** error)
 
   g_return_val_if_fail (priv->program_handle, FALSE);
 
+  g_hash_table_remove_all (priv->uniform_locations);
+  g_hash_table_remove_all (priv->attribute_locations);
+
+  g_free (priv->cache_key);
+  priv->cache_key = NULL;
+  if (_program_cache_init (shader->context)) {
+    priv->cache_key = _program_cache_key (shader);
+
+    priv->vertex_handle = 0;
+    priv->fragment_handle = 0;
+    if (_load_program_binary (shader)) {
+      priv->compiled = TRUE;
+      g_object_notify (G_OBJECT (shader), "compiled");
+
+      return priv->compiled;
+    }
+
+    if (gl->ProgramParameteri)
+      gl->ProgramParameteri (priv->program_handle,
+          GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+
   if (priv->vertex_src) {
     gint n_vertex_sources;
     const gchar **vertex_sources;
@@ -610,6 +910,9 @@ gst_gl_shader_compile (GstGLShader * shader, GError ** error)
   priv->compiled = TRUE;
   g_object_notify (G_OBJECT (shader), "compiled");
 
+  if (priv->cache_key)
+    _store_program_binary (shader);
+
   return priv->compiled;
 }
 
@@ -789,7 +1092,7 @@ gst_gl_shader_set_uniform_1f (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform1f (location, value);
 }
@@ -807,7 +1110,7 @@ gst_gl_shader_set_uniform_1fv (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform1fv (location, count, value);
 }
@@ -825,7 +1128,7 @@ gst_gl_shader_set_uniform_1i (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform1i (location, value);
 }
@@ -843,7 +1146,7 @@ gst_gl_shader_set_uniform_1iv (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform1iv (location, count, value);
 }
@@ -861,7 +1164,7 @@ gst_gl_shader_set_uniform_2f (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform2f (location, value0, value1);
 }
@@ -879,7 +1182,7 @@ gst_gl_shader_set_uniform_2fv (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform2fv (location, count, value);
 }
@@ -897,7 +1200,7 @@ gst_gl_shader_set_uniform_2i (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform2i (location, v0, v1);
 }
@@ -915,7 +1218,7 @@ gst_gl_shader_set_uniform_2iv (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform2iv (location, count, value);
 }
@@ -933,7 +1236,7 @@ gst_gl_shader_set_uniform_3f (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform3f (location, v0, v1, v2);
 }
@@ -951,7 +1254,7 @@ gst_gl_shader_set_uniform_3fv (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform3fv (location, count, value);
 }
@@ -969,7 +1272,7 @@ gst_gl_shader_set_uniform_3i (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform3i (location, v0, v1, v2);
 }
@@ -987,7 +1290,7 @@ gst_gl_shader_set_uniform_3iv (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform3iv (location, count, value);
 }
@@ -1005,7 +1308,7 @@ gst_gl_shader_set_uniform_4f (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform4f (location, v0, v1, v2, v3);
 }
@@ -1023,7 +1326,7 @@ gst_gl_shader_set_uniform_4fv (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform4fv (location, count, value);
 }
@@ -1041,7 +1344,7 @@ gst_gl_shader_set_uniform_4i (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform4i (location, v0, v1, v2, v3);
 }
@@ -1059,7 +1362,7 @@ gst_gl_shader_set_uniform_4iv (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->Uniform4iv (location, count, value);
 }
@@ -1077,7 +1380,7 @@ gst_gl_shader_set_uniform_matrix_2fv (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->UniformMatrix2fv (location, count, transpose, value);
 }
@@ -1095,7 +1398,7 @@ gst_gl_shader_set_uniform_matrix_3fv (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->UniformMatrix3fv (location, count, transpose, value);
 }
@@ -1113,7 +1416,7 @@ gst_gl_shader_set_uniform_matrix_4fv (GstGLShader * shader, const gchar * name,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->UniformMatrix4fv (location, count, transpose, value);
 }
@@ -1132,7 +1435,7 @@ gst_gl_shader_set_uniform_matrix_2x3fv (GstGLShader * shader,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->UniformMatrix2x3fv (location, count, transpose, value);
 }
@@ -1150,7 +1453,7 @@ gst_gl_shader_set_uniform_matrix_2x4fv (GstGLShader * shader,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->UniformMatrix2x4fv (location, count, transpose, value);
 }
@@ -1168,7 +1471,7 @@ gst_gl_shader_set_uniform_matrix_3x2fv (GstGLShader * shader,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->UniformMatrix3x2fv (location, count, transpose, value);
 }
@@ -1186,7 +1489,7 @@ gst_gl_shader_set_uniform_matrix_3x4fv (GstGLShader * shader,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->UniformMatrix3x4fv (location, count, transpose, value);
 }
@@ -1204,7 +1507,7 @@ gst_gl_shader_set_uniform_matrix_4x2fv (GstGLShader * shader,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->UniformMatrix4x2fv (location, count, transpose, value);
 }
@@ -1222,7 +1525,7 @@ gst_gl_shader_set_uniform_matrix_4x3fv (GstGLShader * shader,
   g_return_if_fail (priv->program_handle != 0);
   gl = shader->context->gl_vtable;
 
-  location = gl->GetUniformLocation (priv->program_handle, name);
+  location = _get_uniform_location (shader, name);
 
   gl->UniformMatrix4x3fv (location, count, transpose, value);
 }
@@ -1233,16 +1536,27 @@ gst_gl_shader_get_attribute_location (GstGLShader * shader, const gchar * name)
 {
   GstGLShaderPrivate *priv;
   GstGLFuncs *gl;
+  gpointer value;
+  GLint location;
 
   g_return_val_if_fail (shader != NULL, -1);
   priv = shader->priv;
   g_return_val_if_fail (priv->program_handle != 0, -1);
-  if (0 == priv->vertex_handle)
+  /* programs loaded from a binary have no shader objects */
+  if (!priv->vertex_src)
     return -1;
 
+  if (g_hash_table_lookup_extended (priv->attribute_locations, name, NULL,
+          &value))
+    return GPOINTER_TO_INT (value);
+
   gl = shader->context->gl_vtable;
 
-  return gl->GetAttribLocation (priv->program_handle, name);
+  location = gl->GetAttribLocation (priv->program_handle, name);
+  g_hash_table_insert (priv->attribute_locations, g_strdup (name),
+      GINT_TO_POINTER (location));
+
+  return location;
 }
 
 void
@@ -1258,6 +1572,7 @@ gst_gl_shader_bind_attribute_location (GstGLShader * shader, GLuint index,
   gl = shader->context->gl_vtable;
 
   gl->BindAttribLocation (priv->program_handle, index, name);
+  g_hash_table_remove (priv->attribute_locations, name);
 }
 
 GQuark
@@ -54,6 +54,7 @@ gst_buffer_add_gl_sync_meta (GstGLContext * context, GstBuffer * buffer)
 
   meta->context = gst_object_ref (context);
   meta->glsync = NULL;
+  meta->serial = 0;
 
   return meta;
 }
@@ -76,12 +77,28 @@ _set_sync_point (GstGLContext * context, GstGLSyncMeta * sync_meta)
   }
 }
 
+/**
+ * gst_gl_sync_meta_set_sync_point:
+ * @sync_meta: a #GstGLSyncMeta
+ * @context: a #GstGLContext
+ *
+ * Marks the point after the OpenGL commands issued in @context so far.
+ *
+ * When @context is the #GstGLContext of @sync_meta, this is queued with
+ * gst_gl_context_thread_add_async() instead of waiting for the OpenGL
+ * thread; gst_gl_sync_meta_wait() waits for it first.
+ */
 void
 gst_gl_sync_meta_set_sync_point (GstGLSyncMeta * sync_meta,
     GstGLContext * context)
 {
-  gst_gl_context_thread_add (context,
-      (GstGLContextThreadFunc) _set_sync_point, sync_meta);
+  if (context == sync_meta->context) {
+    sync_meta->serial = gst_gl_context_thread_add_async (context,
+        (GstGLContextThreadFunc) _set_sync_point, sync_meta, NULL);
+  } else {
+    gst_gl_context_thread_add (context,
+        (GstGLContextThreadFunc) _set_sync_point, sync_meta);
+  }
 }
 
 static void
@@ -100,9 +117,19 @@ _wait (GstGLContext * context, GstGLSyncMeta * sync_meta)
   }
 }
 
+/**
+ * gst_gl_sync_meta_wait:
+ * @sync_meta: a #GstGLSyncMeta
+ * @context: a #GstGLContext
+ *
+ * Makes @context wait for the sync point set on @sync_meta.
+ */
 void
 gst_gl_sync_meta_wait (GstGLSyncMeta * sync_meta, GstGLContext * context)
 {
+  if (sync_meta->serial)
+    gst_gl_context_thread_wait (sync_meta->context, sync_meta->serial);
+
   if (sync_meta->glsync) {
     gst_gl_context_thread_add (context,
         (GstGLContextThreadFunc) _wait, sync_meta);
@@ -157,6 +184,10 @@ _free_gl_sync_meta (GstGLContext * context, GstGLSyncMeta * sync_meta)
 static void
 _gst_gl_sync_meta_free (GstGLSyncMeta * sync_meta, GstBuffer * buffer)
 {
+  /* the queued sync point still refers to the meta */
+  if (sync_meta->serial)
+    gst_gl_context_thread_wait (sync_meta->context, sync_meta->serial);
+
   if (sync_meta->glsync) {
     gst_gl_context_thread_add (sync_meta->context,
         (GstGLContextThreadFunc) _free_gl_sync_meta, sync_meta);
@@ -178,6 +209,7 @@ _gst_gl_sync_meta_init (GstGLSyncMeta * sync_meta, gpointer params,
 
   sync_meta->context = NULL;
   sync_meta->glsync = NULL;
+  sync_meta->serial = 0;
 
   return TRUE;
 }
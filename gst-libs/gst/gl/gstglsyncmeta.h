@@ -38,6 +38,9 @@ struct _GstGLSyncMeta {
   GstGLContext *context;
 
   GLsync        glsync;
+
+  /* the queued gst_gl_sync_meta_set_sync_point() */
+  guint64       serial;
 };
 
 GType gst_gl_sync_meta_api_get_type (void);
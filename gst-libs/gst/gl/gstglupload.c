@@ -31,6 +31,10 @@
 #include "egl/gsteglimagememory.h"
 #endif
 
+#if GST_GL_HAVE_DMABUF
+#include <gst/allocators/gstdmabuf.h>
+#endif
+
 /**
  * SECTION:gstglupload
  * @short_description: an object that uploads to GL textures
@@ -486,6 +490,328 @@ static const UploadMethod _egl_image_upload = {
 };
 #endif
 
+#if GST_GL_HAVE_DMABUF
+struct DmabufUpload
+{
+  GstGLUpload *upload;
+
+  GstMemory *eglimage[GST_VIDEO_MAX_PLANES];
+  guint tex_id[GST_VIDEO_MAX_PLANES];
+  gboolean result;
+};
+
+/* The textures an imported dmabuf plane is bound to are kept on the
+ * dmabuf memory, so that the buffers of a recycling upstream pool are
+ * imported only once */
+typedef struct
+{
+  GstGLContext *context;
+  guint tex_id;
+
+  GstVideoFormat format;
+  gint width;
+  gint height;
+  gint stride;
+  gsize offset;
+} DmabufTexture;
+
+static GQuark
+_dmabuf_texture_quark (gint plane)
+{
+  static GQuark quark[GST_VIDEO_MAX_PLANES] = { 0, };
+  static const gchar *quark_str[GST_VIDEO_MAX_PLANES] = {
+    "GstGLDmabufTexture0", "GstGLDmabufTexture1", "GstGLDmabufTexture2",
+    "GstGLDmabufTexture3"
+  };
+
+  if (!quark[plane])
+    quark[plane] = g_quark_from_static_string (quark_str[plane]);
+
+  return quark[plane];
+}
+
+static void
+_dmabuf_texture_free (DmabufTexture * texture)
+{
+  gst_gl_context_del_texture (texture->context, &texture->tex_id);
+  gst_object_unref (texture->context);
+  g_slice_free (DmabufTexture, texture);
+}
+
+static guint
+_get_cached_texture (GstMemory * mem, GstGLContext * context,
+    GstVideoInfo * info, gint plane, gsize offset)
+{
+  DmabufTexture *texture;
+
+  texture = gst_mini_object_get_qdata (GST_MINI_OBJECT (mem),
+      _dmabuf_texture_quark (plane));
+
+  if (!texture || texture->context != context
+      || texture->format != GST_VIDEO_INFO_FORMAT (info)
+      || texture->width != GST_VIDEO_INFO_WIDTH (info)
+      || texture->height != GST_VIDEO_INFO_HEIGHT (info)
+      || texture->stride != GST_VIDEO_INFO_PLANE_STRIDE (info, plane)
+      || texture->offset != offset)
+    return 0;
+
+  return texture->tex_id;
+}
+
+static void
+_set_cached_texture (GstMemory * mem, GstGLContext * context,
+    GstVideoInfo * info, gint plane, gsize offset, guint tex_id)
+{
+  DmabufTexture *texture = g_slice_new (DmabufTexture);
+
+  texture->context = gst_object_ref (context);
+  texture->tex_id = tex_id;
+  texture->format = GST_VIDEO_INFO_FORMAT (info);
+  texture->width = GST_VIDEO_INFO_WIDTH (info);
+  texture->height = GST_VIDEO_INFO_HEIGHT (info);
+  texture->stride = GST_VIDEO_INFO_PLANE_STRIDE (info, plane);
+  texture->offset = offset;
+
+  /* replaces (and frees) a stale texture of a previous format */
+  gst_mini_object_set_qdata (GST_MINI_OBJECT (mem),
+      _dmabuf_texture_quark (plane), texture,
+      (GDestroyNotify) _dmabuf_texture_free);
+}
+
+static gpointer
+_dma_buf_upload_new (GstGLUpload * upload)
+{
+  struct DmabufUpload *dmabuf = g_new0 (struct DmabufUpload, 1);
+
+  dmabuf->upload = upload;
+
+  return dmabuf;
+}
+
+static GstCaps *
+_dma_buf_upload_transform_caps (GstGLContext * context,
+    GstPadDirection direction, GstCaps * caps)
+{
+  GstCaps *ret;
+
+  if (direction == GST_PAD_SINK) {
+    ret = _set_caps_features (caps, GST_CAPS_FEATURE_MEMORY_GL_MEMORY);
+  } else {
+    ret = _set_caps_features (caps, GST_CAPS_FEATURE_MEMORY_SYSTEM_MEMORY);
+  }
+
+  return ret;
+}
+
+static void
+_dma_buf_upload_bind_gl_thread (GstGLContext * context,
+    struct DmabufUpload *dmabuf)
+{
+  const GstGLFuncs *gl = context->gl_vtable;
+  guint i;
+
+  dmabuf->result = TRUE;
+
+  for (i = 0; i < GST_VIDEO_MAX_PLANES; i++) {
+    if (!dmabuf->eglimage[i])
+      continue;
+
+    gl->GenTextures (1, &dmabuf->tex_id[i]);
+    gl->BindTexture (GL_TEXTURE_2D, dmabuf->tex_id[i]);
+    gl->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    gl->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    gl->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl->TexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    gl->EGLImageTargetTexture2D (GL_TEXTURE_2D,
+        gst_egl_image_memory_get_image (dmabuf->eglimage[i]));
+
+    if (gl->GetError () != GL_NO_ERROR) {
+      GST_WARNING_OBJECT (dmabuf->upload, "failed to bind the EGLImage of "
+          "plane %u", i);
+      dmabuf->result = FALSE;
+    }
+  }
+
+  gl->BindTexture (GL_TEXTURE_2D, 0);
+}
+
+static gboolean
+_dma_buf_upload_accept (gpointer impl, GstBuffer * buffer, GstCaps * in_caps,
+    GstCaps * out_caps)
+{
+  struct DmabufUpload *dmabuf = impl;
+  GstGLContext *context = dmabuf->upload->context;
+  GstVideoInfo in_info = dmabuf->upload->priv->in_info;
+  guint n_planes = GST_VIDEO_INFO_N_PLANES (&in_info);
+  GstMemory *mems[GST_VIDEO_MAX_PLANES];
+  gsize offsets[GST_VIDEO_MAX_PLANES];
+  GstCapsFeatures *features;
+  GstVideoMeta *meta;
+  gboolean need_bind = FALSE;
+  guint i;
+
+  features = gst_caps_get_features (out_caps, 0);
+  if (!gst_caps_features_contains (features, GST_CAPS_FEATURE_MEMORY_GL_MEMORY))
+    return FALSE;
+
+  /* this eliminates most buffers that are not dmabufs early */
+  if (!gst_is_dmabuf_memory (gst_buffer_peek_memory (buffer, 0)))
+    return FALSE;
+
+  if (!GST_GL_IS_CONTEXT_EGL (context)
+      || !gst_gl_context_check_feature (context,
+          "EGL_EXT_image_dma_buf_import"))
+    return FALSE;
+
+  if (GST_VIDEO_INFO_MULTIVIEW_MODE (&in_info) ==
+      GST_VIDEO_MULTIVIEW_MODE_SEPARATED)
+    return FALSE;
+
+  /* dmabufs are rarely laid out with the default strides, which only
+   * concern this buffer and not the negotiated info */
+  meta = gst_buffer_get_video_meta (buffer);
+  if (meta) {
+    for (i = 0; i < meta->n_planes; i++) {
+      GST_VIDEO_INFO_PLANE_OFFSET (&in_info, i) = meta->offset[i];
+      GST_VIDEO_INFO_PLANE_STRIDE (&in_info, i) = meta->stride[i];
+    }
+  }
+
+  for (i = 0; i < n_planes; i++) {
+    guint idx, length;
+    gsize skip;
+
+    /* each plane has to live in a single dmabuf */
+    if (!gst_buffer_find_memory (buffer, GST_VIDEO_INFO_PLANE_OFFSET (&in_info,
+                i), gst_gl_get_plane_data_size (&in_info, NULL, i), &idx,
+            &length, &skip) || length != 1)
+      return FALSE;
+
+    mems[i] = gst_buffer_peek_memory (buffer, idx);
+    if (!gst_is_dmabuf_memory (mems[i]))
+      return FALSE;
+
+    /* two component planes are imported as RG images, which the shaders
+     * only read correctly from RG textures */
+    if (gst_gl_texture_type_from_format (context,
+            GST_VIDEO_INFO_FORMAT (&in_info),
+            i) == GST_VIDEO_GL_TEXTURE_TYPE_LUMINANCE_ALPHA)
+      return FALSE;
+
+    offsets[i] = mems[i]->offset + skip;
+  }
+
+  for (i = 0; i < n_planes; i++) {
+    dmabuf->tex_id[i] = _get_cached_texture (mems[i], context, &in_info, i,
+        offsets[i]);
+    if (dmabuf->tex_id[i])
+      continue;
+
+    dmabuf->eglimage[i] = gst_egl_image_memory_from_dmabuf (context,
+        gst_dmabuf_memory_get_fd (mems[i]), &in_info, i, offsets[i]);
+    if (!dmabuf->eglimage[i])
+      goto error;
+    need_bind = TRUE;
+  }
+
+  if (need_bind) {
+    gst_gl_context_thread_add (context,
+        (GstGLContextThreadFunc) _dma_buf_upload_bind_gl_thread, dmabuf);
+
+    for (i = 0; i < n_planes; i++) {
+      if (!dmabuf->eglimage[i])
+        continue;
+
+      /* the texture keeps the image storage alive on its own */
+      gst_memory_unref (dmabuf->eglimage[i]);
+      dmabuf->eglimage[i] = NULL;
+
+      if (dmabuf->result)
+        _set_cached_texture (mems[i], context, &in_info, i, offsets[i],
+            dmabuf->tex_id[i]);
+      else
+        gst_gl_context_del_texture (context, &dmabuf->tex_id[i]);
+    }
+
+    if (!dmabuf->result)
+      return FALSE;
+  }
+
+  return TRUE;
+
+error:
+  for (i = 0; i < n_planes; i++) {
+    if (dmabuf->eglimage[i]) {
+      gst_memory_unref (dmabuf->eglimage[i]);
+      dmabuf->eglimage[i] = NULL;
+    }
+  }
+
+  return FALSE;
+}
+
+static void
+_dma_buf_upload_propose_allocation (gpointer impl, GstQuery * decide_query,
+    GstQuery * query)
+{
+  /* nothing to do for now. */
+}
+
+static GstGLUploadReturn
+_dma_buf_upload_perform (gpointer impl, GstBuffer * buffer,
+    GstBuffer ** outbuf)
+{
+  struct DmabufUpload *dmabuf = impl;
+  GstVideoInfo *out_info = &dmabuf->upload->priv->out_info;
+  guint i, n_planes = GST_VIDEO_INFO_N_PLANES (out_info);
+
+  /* no copy is made, so every texture keeps the dmabuf it shows from
+   * being recycled upstream */
+  *outbuf = gst_buffer_new ();
+  for (i = 0; i < n_planes; i++) {
+    GstGLMemory *gl_mem;
+
+    gl_mem = gst_gl_memory_wrapped_texture (dmabuf->upload->context,
+        dmabuf->tex_id[i], GL_TEXTURE_2D, out_info, i, NULL,
+        gst_buffer_ref (buffer), (GDestroyNotify) gst_buffer_unref);
+    gst_buffer_append_memory (*outbuf, (GstMemory *) gl_mem);
+  }
+
+  gst_buffer_add_video_meta_full (*outbuf, 0, GST_VIDEO_INFO_FORMAT (out_info),
+      GST_VIDEO_INFO_WIDTH (out_info), GST_VIDEO_INFO_HEIGHT (out_info),
+      n_planes, out_info->offset, out_info->stride);
+
+  return GST_GL_UPLOAD_DONE;
+}
+
+static void
+_dma_buf_upload_release (gpointer impl, GstBuffer * buffer)
+{
+}
+
+static void
+_dma_buf_upload_free (gpointer impl)
+{
+  g_free (impl);
+}
+
+static GstStaticCaps _dma_buf_upload_caps =
+GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (GST_GL_MEMORY_VIDEO_FORMATS_STR));
+
+static const UploadMethod _dma_buf_upload = {
+  "Dmabuf",
+  0,
+  &_dma_buf_upload_caps,
+  &_dma_buf_upload_new,
+  &_dma_buf_upload_transform_caps,
+  &_dma_buf_upload_accept,
+  &_dma_buf_upload_propose_allocation,
+  &_dma_buf_upload_perform,
+  &_dma_buf_upload_release,
+  &_dma_buf_upload_free
+};
+#endif /* GST_GL_HAVE_DMABUF */
+
 struct GLUploadMeta
 {
   GstGLUpload *upload;
@@ -869,6 +1195,9 @@ static const UploadMethod _raw_data_upload = {
 static const UploadMethod *upload_methods[] = { &_gl_memory_upload,
 #if GST_GL_HAVE_PLATFORM_EGL
   &_egl_image_upload,
+#endif
+#if GST_GL_HAVE_DMABUF
+  &_dma_buf_upload,
 #endif
   &_upload_meta_upload, &_raw_data_upload
 };
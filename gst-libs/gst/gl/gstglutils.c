@@ -361,17 +361,26 @@ _del_fbo (GstGLContext * context, DelFBO * data)
   gst_gl_framebuffer_delete (data->frame, data->fbo, data->depth);
 }
 
+static void
+_free_del_fbo (DelFBO * data)
+{
+  gst_object_unref (data->frame);
+  g_slice_free (DelFBO, data);
+}
+
 /* Called by gltestsrc and glfilter */
 void
 gst_gl_context_del_fbo (GstGLContext * context, GLuint fbo, GLuint depth_buffer)
 {
-  GstGLFramebuffer *frame = gst_gl_framebuffer_new (context);
-
-  DelFBO data = { frame, fbo, depth_buffer };
+  DelFBO *data = g_slice_new (DelFBO);
 
-  gst_gl_context_thread_add (context, (GstGLContextThreadFunc) _del_fbo, &data);
+  data->frame = gst_gl_framebuffer_new (context);
+  data->fbo = fbo;
+  data->depth = depth_buffer;
 
-  gst_object_unref (frame);
+  /* nobody waits for the result */
+  gst_gl_context_thread_add_async (context,
+      (GstGLContextThreadFunc) _del_fbo, data, (GDestroyNotify) _free_del_fbo);
 }
 
 static void
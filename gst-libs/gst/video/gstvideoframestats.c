@@ -0,0 +1,322 @@
+/* GStreamer
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstvideoframestats
+ * @short_description: Shared luma statistics kernels and metadata
+ *
+ * A small set of block statistics kernels (SAD, SSD, comb detection and
+ * luma histogram) shared by the video analysis elements, together with
+ * #GstVideoFrameStatsMeta to pass the results downstream so that they
+ * are only computed once per frame in a pipeline.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gstvideoframestats.h"
+#include "bad-video-orc.h"
+
+GST_DEBUG_CATEGORY_STATIC (video_frame_stats_debug);
+#define GST_CAT_DEFAULT video_frame_stats_debug
+
+/* a comb run is counted once it got longer than this */
+#define COMB_RUN_THRESHOLD 100
+#define COMB_RUN_MAX 1000
+
+static gboolean
+gst_video_frame_stats_meta_init (GstVideoFrameStatsMeta * stats_meta,
+    gpointer params, GstBuffer * buffer)
+{
+  stats_meta->flags = GST_VIDEO_FRAME_STATS_NONE;
+  stats_meta->reference_pts = GST_CLOCK_TIME_NONE;
+  stats_meta->n_samples = 0;
+  stats_meta->sad = 0;
+  stats_meta->ssd = 0;
+  stats_meta->comb_score = 0;
+  memset (stats_meta->histogram, 0, sizeof (stats_meta->histogram));
+
+  return TRUE;
+}
+
+static gboolean
+gst_video_frame_stats_meta_transform (GstBuffer * dest, GstMeta * meta,
+    GstBuffer * buffer, GQuark type, gpointer data)
+{
+  GstVideoFrameStatsMeta *smeta, *dmeta;
+
+  smeta = (GstVideoFrameStatsMeta *) meta;
+
+  if (GST_META_TRANSFORM_IS_COPY (type)) {
+    GstMetaTransformCopy *copy = data;
+
+    /* the statistics only describe the complete frame */
+    if (!copy->region) {
+      dmeta = gst_buffer_get_video_frame_stats_meta (dest);
+      if (!dmeta)
+        dmeta = gst_buffer_add_video_frame_stats_meta (dest);
+      if (!dmeta)
+        return FALSE;
+
+      dmeta->flags = smeta->flags;
+      dmeta->reference_pts = smeta->reference_pts;
+      dmeta->n_samples = smeta->n_samples;
+      dmeta->sad = smeta->sad;
+      dmeta->ssd = smeta->ssd;
+      dmeta->comb_score = smeta->comb_score;
+      memcpy (dmeta->histogram, smeta->histogram, sizeof (dmeta->histogram));
+    }
+  } else {
+    /* scaled or otherwise modified frames have different statistics */
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+GType
+gst_video_frame_stats_meta_api_get_type (void)
+{
+  static volatile GType type;
+  /* the statistics depend on every pixel, so any element changing size,
+   * orientation or colorspace has to drop them */
+  static const gchar *tags[] = { GST_META_TAG_VIDEO_STR,
+    GST_META_TAG_VIDEO_ORIENTATION_STR, GST_META_TAG_VIDEO_SIZE_STR,
+    GST_META_TAG_VIDEO_COLORSPACE_STR, NULL
+  };
+
+  if (g_once_init_enter (&type)) {
+    GType _type =
+        gst_meta_api_type_register ("GstVideoFrameStatsMetaAPI", tags);
+    GST_DEBUG_CATEGORY_INIT (video_frame_stats_debug, "videoframestats", 0,
+        "Video frame statistics");
+
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+const GstMetaInfo *
+gst_video_frame_stats_meta_get_info (void)
+{
+  static const GstMetaInfo *video_frame_stats_meta_info = NULL;
+
+  if (g_once_init_enter (&video_frame_stats_meta_info)) {
+    const GstMetaInfo *meta =
+        gst_meta_register (GST_VIDEO_FRAME_STATS_META_API_TYPE,
+        "GstVideoFrameStatsMeta", sizeof (GstVideoFrameStatsMeta),
+        (GstMetaInitFunction) gst_video_frame_stats_meta_init,
+        (GstMetaFreeFunction) NULL,
+        (GstMetaTransformFunction) gst_video_frame_stats_meta_transform);
+    g_once_init_leave (&video_frame_stats_meta_info, meta);
+  }
+
+  return video_frame_stats_meta_info;
+}
+
+/**
+ * gst_buffer_add_video_frame_stats_meta:
+ * @buffer: a writable #GstBuffer
+ *
+ * Adds an empty #GstVideoFrameStatsMeta to @buffer. The caller fills in
+ * the statistics it computed and sets the matching @flags.
+ *
+ * Returns: (transfer none): the #GstVideoFrameStatsMeta on @buffer
+ *
+ * Since: 1.8
+ */
+GstVideoFrameStatsMeta *
+gst_buffer_add_video_frame_stats_meta (GstBuffer * buffer)
+{
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
+
+  return (GstVideoFrameStatsMeta *) gst_buffer_add_meta (buffer,
+      GST_VIDEO_FRAME_STATS_META_INFO, NULL);
+}
+
+/**
+ * gst_video_frame_stats_sad:
+ * @s1: first 8 bit plane
+ * @stride1: stride of @s1
+ * @s2: second 8 bit plane
+ * @stride2: stride of @s2
+ * @width: width in samples
+ * @height: number of lines
+ *
+ * Returns: the sum of absolute differences between @s1 and @s2
+ *
+ * Since: 1.8
+ */
+guint64
+gst_video_frame_stats_sad (const guint8 * s1, gint stride1,
+    const guint8 * s2, gint stride2, gint width, gint height)
+{
+  guint64 sum = 0;
+  guint32 line;
+  gint j;
+
+  for (j = 0; j < height; j++) {
+    video_frame_stats_orc_sad_u8 (&line, s1, s2, width);
+    sum += line;
+    s1 += stride1;
+    s2 += stride2;
+  }
+
+  return sum;
+}
+
+/**
+ * gst_video_frame_stats_ssd:
+ * @s1: first 8 bit plane
+ * @stride1: stride of @s1
+ * @s2: second 8 bit plane
+ * @stride2: stride of @s2
+ * @width: width in samples, at most 66051 so one line fits in 32 bits
+ * @height: number of lines
+ *
+ * Returns: the sum of squared differences between @s1 and @s2
+ *
+ * Since: 1.8
+ */
+guint64
+gst_video_frame_stats_ssd (const guint8 * s1, gint stride1,
+    const guint8 * s2, gint stride2, gint width, gint height)
+{
+  guint64 sum = 0;
+  guint32 line;
+  gint j;
+
+  for (j = 0; j < height; j++) {
+    video_frame_stats_orc_ssd_u8 (&line, s1, s2, width);
+    sum += line;
+    s1 += stride1;
+    s2 += stride2;
+  }
+
+  return sum;
+}
+
+/**
+ * gst_video_frame_stats_comb_mask:
+ * @mask: destination of @width bytes
+ * @above: the line above @line
+ * @line: the line to check
+ * @below: the line below @line
+ * @width: width in samples
+ * @threshold: how far outside the range of its neighbours a sample has
+ *     to be to count as combed
+ *
+ * Sets @mask to 0xff for every sample of @line that is more than
+ * @threshold below the minimum or above the maximum of the samples
+ * directly above and below it, and to 0 otherwise.
+ *
+ * Since: 1.8
+ */
+void
+gst_video_frame_stats_comb_mask (guint8 * mask, const guint8 * above,
+    const guint8 * line, const guint8 * below, gint width, gint threshold)
+{
+  video_frame_stats_orc_comb_mask_u8 (mask, above, line, below, threshold,
+      width);
+}
+
+/**
+ * gst_video_frame_stats_comb_runs:
+ * @runs: per column run lengths, @width entries, zeroed before the
+ *     first line of a frame
+ * @mask: a mask produced by gst_video_frame_stats_comb_mask()
+ * @width: width in samples
+ *
+ * Accumulates the combing runs of one more line into @runs and rewrites
+ * @mask so that only samples which are part of a long enough run stay
+ * set.
+ *
+ * Returns: the number of samples left set in @mask
+ *
+ * Since: 1.8
+ */
+guint
+gst_video_frame_stats_comb_runs (gint * runs, guint8 * mask, gint width)
+{
+  guint score = 0;
+  gint i;
+
+  for (i = 0; i < width; i++) {
+    if (mask[i]) {
+      if (i > 0)
+        runs[i] += runs[i - 1];
+      runs[i]++;
+      if (runs[i] > COMB_RUN_MAX)
+        runs[i] = COMB_RUN_MAX;
+    } else {
+      runs[i] = 0;
+    }
+    if (runs[i] > COMB_RUN_THRESHOLD) {
+      mask[i] = 0xff;
+      score++;
+    } else {
+      mask[i] = 0;
+    }
+  }
+
+  return score;
+}
+
+/**
+ * gst_video_frame_stats_histogram:
+ * @histogram: destination, %GST_VIDEO_FRAME_STATS_HISTOGRAM_BINS entries
+ * @src: 8 bit plane
+ * @stride: stride of @src
+ * @width: width in samples
+ * @height: number of lines
+ *
+ * Computes the histogram of @src into @histogram.
+ *
+ * Since: 1.8
+ */
+void
+gst_video_frame_stats_histogram (guint32 * histogram, const guint8 * src,
+    gint stride, gint width, gint height)
+{
+  /* four interleaved partial histograms, so that runs of equal samples
+   * don't serialise on the same counter */
+  guint32 partial[4][GST_VIDEO_FRAME_STATS_HISTOGRAM_BINS];
+  gint i, j;
+
+  memset (partial, 0, sizeof (partial));
+
+  for (j = 0; j < height; j++) {
+    for (i = 0; i + 3 < width; i += 4) {
+      partial[0][src[i]]++;
+      partial[1][src[i + 1]]++;
+      partial[2][src[i + 2]]++;
+      partial[3][src[i + 3]]++;
+    }
+    for (; i < width; i++)
+      partial[0][src[i]]++;
+    src += stride;
+  }
+
+  for (i = 0; i < GST_VIDEO_FRAME_STATS_HISTOGRAM_BINS; i++)
+    histogram[i] = partial[0][i] + partial[1][i] + partial[2][i] +
+        partial[3][i];
+}
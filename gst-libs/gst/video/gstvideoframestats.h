@@ -0,0 +1,135 @@
+/* GStreamer
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_VIDEO_FRAME_STATS_H__
+#define __GST_VIDEO_FRAME_STATS_H__
+
+#ifndef GST_USE_UNSTABLE_API
+#warning "The Video library from gst-plugins-bad is unstable API and may change in future."
+#warning "You can define GST_USE_UNSTABLE_API to avoid this warning."
+#endif
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GST_VIDEO_FRAME_STATS_HISTOGRAM_BINS:
+ *
+ * Number of bins of the luma histogram in #GstVideoFrameStatsMeta, one
+ * per 8 bit sample value.
+ *
+ * Since: 1.8
+ */
+#define GST_VIDEO_FRAME_STATS_HISTOGRAM_BINS 256
+
+/**
+ * GstVideoFrameStatsFlags:
+ * @GST_VIDEO_FRAME_STATS_NONE: no statistics are valid
+ * @GST_VIDEO_FRAME_STATS_SAD: @sad against the reference frame is valid
+ * @GST_VIDEO_FRAME_STATS_SSD: @ssd against the reference frame is valid
+ * @GST_VIDEO_FRAME_STATS_COMB: @comb_score is valid
+ * @GST_VIDEO_FRAME_STATS_HISTOGRAM: @histogram is valid
+ *
+ * Flags telling which fields of a #GstVideoFrameStatsMeta have been
+ * filled in.
+ *
+ * Since: 1.8
+ */
+typedef enum {
+  GST_VIDEO_FRAME_STATS_NONE      = 0,
+  GST_VIDEO_FRAME_STATS_SAD       = (1 << 0),
+  GST_VIDEO_FRAME_STATS_SSD       = (1 << 1),
+  GST_VIDEO_FRAME_STATS_COMB      = (1 << 2),
+  GST_VIDEO_FRAME_STATS_HISTOGRAM = (1 << 3)
+} GstVideoFrameStatsFlags;
+
+typedef struct _GstVideoFrameStatsMeta GstVideoFrameStatsMeta;
+
+GType gst_video_frame_stats_meta_api_get_type (void);
+#define GST_VIDEO_FRAME_STATS_META_API_TYPE (gst_video_frame_stats_meta_api_get_type())
+#define GST_VIDEO_FRAME_STATS_META_INFO (gst_video_frame_stats_meta_get_info())
+const GstMetaInfo * gst_video_frame_stats_meta_get_info (void);
+
+/**
+ * GstVideoFrameStatsMeta:
+ * @meta: parent #GstMeta
+ * @flags: which of the statistics below are valid
+ * @reference_pts: PTS of the frame @sad and @ssd were measured against
+ * @n_samples: number of luma samples @sad and @ssd were summed over
+ * @sad: sum of absolute luma differences against the reference frame
+ * @ssd: sum of squared luma differences against the reference frame
+ * @comb_score: number of luma samples inside a combing run
+ * @histogram: luma histogram of the frame
+ *
+ * Luma statistics of a video frame, as computed by one of the analysis
+ * elements (scenechange, ivtc, combdetect).  Elements further downstream
+ * that need the same statistics on the same pixels can pick them up
+ * from here instead of walking the frame again.
+ *
+ * @sad and @ssd describe the difference to another frame of the same
+ * stream; users must check that @reference_pts is the frame they would
+ * have compared against before reusing them.
+ *
+ * Since: 1.8
+ */
+struct _GstVideoFrameStatsMeta {
+  GstMeta meta;
+
+  GstVideoFrameStatsFlags flags;
+
+  GstClockTime reference_pts;
+  guint64 n_samples;
+  guint64 sad;
+  guint64 ssd;
+
+  guint comb_score;
+
+  guint32 histogram[GST_VIDEO_FRAME_STATS_HISTOGRAM_BINS];
+};
+
+#define gst_buffer_get_video_frame_stats_meta(b) ((GstVideoFrameStatsMeta*)gst_buffer_get_meta((b),GST_VIDEO_FRAME_STATS_META_API_TYPE))
+
+GstVideoFrameStatsMeta * gst_buffer_add_video_frame_stats_meta (GstBuffer * buffer);
+
+/* kernels */
+guint64 gst_video_frame_stats_sad (const guint8 * s1, gint stride1,
+                                   const guint8 * s2, gint stride2,
+                                   gint width, gint height);
+
+guint64 gst_video_frame_stats_ssd (const guint8 * s1, gint stride1,
+                                   const guint8 * s2, gint stride2,
+                                   gint width, gint height);
+
+void    gst_video_frame_stats_comb_mask (guint8 * mask, const guint8 * above,
+                                         const guint8 * line,
+                                         const guint8 * below,
+                                         gint width, gint threshold);
+
+guint   gst_video_frame_stats_comb_runs (gint * runs, guint8 * mask,
+                                         gint width);
+
+void    gst_video_frame_stats_histogram (guint32 * histogram,
+                                         const guint8 * src, gint stride,
+                                         gint width, gint height);
+
+G_END_DECLS
+
+#endif /* __GST_VIDEO_FRAME_STATS_H__ */
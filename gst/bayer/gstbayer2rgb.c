@@ -25,6 +25,23 @@
  * SECTION:element-bayer2rgb
  *
  * Decodes raw camera bayer (fourcc BA81) to RGB.
+ *
+ * Besides 8 bit bayer, 10, 12 and 16 bit samples stored in 16 bit little
+ * or big endian words are accepted (for example bggr12le); the output is
+ * always 8 bits per component.
+ *
+ * The default bilinear interpolation can be replaced by the gradient
+ * corrected interpolation of Malvar, He and Cutler with the method
+ * property, which gives sharper edges and less colour fringing for about
+ * twice the processing time.  With n-threads, the frame is split into
+ * horizontal bands that are demosaiced in parallel.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 v4l2src ! video/x-bayer,format=grbg12le ! bayer2rgb method=mhc n-threads=4 ! videoconvert ! autovideosink
+ * ]|
+ * </refsect2>
  */
 
 /*
@@ -106,6 +123,12 @@ typedef struct _GstBayer2RGBClass GstBayer2RGBClass;
 
 typedef void (*GstBayer2RGBProcessFunc) (GstBayer2RGB *, guint8 *, guint);
 
+typedef enum
+{
+  GST_BAYER2RGB_METHOD_BILINEAR,
+  GST_BAYER2RGB_METHOD_MHC
+} GstBayer2RGBMethod;
+
 struct _GstBayer2RGB
 {
   GstBaseTransform basetransform;
@@ -118,6 +141,17 @@ struct _GstBayer2RGB
   int g_off;                    /* offset for green */
   int b_off;                    /* offset for blue */
   int format;
+  int bpp;                      /* bits per sample, 8 to 16 */
+  gboolean big_endian;          /* byte order of samples wider than 8 bits */
+
+  GstBayer2RGBMethod method;
+  guint n_threads;
+
+  /* helper threads for the bands after the first one */
+  GThreadPool *pool;
+  GMutex jobs_lock;
+  GCond jobs_cond;
+  gint jobs_pending;
 };
 
 struct _GstBayer2RGBClass
@@ -125,17 +159,59 @@ struct _GstBayer2RGBClass
   GstBaseTransformClass parent;
 };
 
+/* a band of output rows, processed by one thread */
+typedef struct
+{
+  GstBayer2RGB *filter;
+  GstBayer2RGBMethod method;
+  guint8 *dest;
+  int dest_stride;
+  const guint8 *src;
+  int src_stride;
+  int first_row;
+  int last_row;
+} GstBayer2RGBJob;
+
 #define	SRC_CAPS                                 \
   GST_VIDEO_CAPS_MAKE ("{ RGBx, xRGB, BGRx, xBGR, RGBA, ARGB, BGRA, ABGR }")
 
-#define SINK_CAPS "video/x-bayer,format=(string){bggr,grbg,gbrg,rggb}," \
-  "width=(int)[1,MAX],height=(int)[1,MAX],framerate=(fraction)[0/1,MAX]"
+#define BAYER_FORMATS "{bggr,grbg,gbrg,rggb," \
+  "bggr10le,grbg10le,gbrg10le,rggb10le,bggr10be,grbg10be,gbrg10be,rggb10be," \
+  "bggr12le,grbg12le,gbrg12le,rggb12le,bggr12be,grbg12be,gbrg12be,rggb12be," \
+  "bggr16le,grbg16le,gbrg16le,rggb16le,bggr16be,grbg16be,gbrg16be,rggb16be}"
+
+#define SINK_CAPS "video/x-bayer,format=(string)" BAYER_FORMATS "," \
+  "width=(int)[2,MAX],height=(int)[1,MAX],framerate=(fraction)[0/1,MAX]"
+
+#define DEFAULT_METHOD GST_BAYER2RGB_METHOD_BILINEAR
+#define DEFAULT_N_THREADS 1
 
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_METHOD,
+  PROP_N_THREADS
 };
 
+#define GST_TYPE_BAYER2RGB_METHOD (gst_bayer2rgb_method_get_type())
+static GType
+gst_bayer2rgb_method_get_type (void)
+{
+  static GType method_type = 0;
+
+  static const GEnumValue method_types[] = {
+    {GST_BAYER2RGB_METHOD_BILINEAR, "Bilinear interpolation", "bilinear"},
+    {GST_BAYER2RGB_METHOD_MHC,
+        "Malvar-He-Cutler gradient corrected interpolation", "mhc"},
+    {0, NULL, NULL}
+  };
+
+  if (!method_type) {
+    method_type = g_enum_register_static ("GstBayer2RGBMethod", method_types);
+  }
+  return method_type;
+}
+
 GType gst_bayer2rgb_get_type (void);
 
 #define gst_bayer2rgb_parent_class parent_class
@@ -145,6 +221,7 @@ static void gst_bayer2rgb_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_bayer2rgb_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
+static void gst_bayer2rgb_finalize (GObject * object);
 
 static gboolean gst_bayer2rgb_set_caps (GstBaseTransform * filter,
     GstCaps * incaps, GstCaps * outcaps);
@@ -168,6 +245,16 @@ gst_bayer2rgb_class_init (GstBayer2RGBClass * klass)
 
   gobject_class->set_property = gst_bayer2rgb_set_property;
   gobject_class->get_property = gst_bayer2rgb_get_property;
+  gobject_class->finalize = gst_bayer2rgb_finalize;
+
+  g_object_class_install_property (gobject_class, PROP_METHOD,
+      g_param_spec_enum ("method", "Method", "Interpolation method",
+          GST_TYPE_BAYER2RGB_METHOD, DEFAULT_METHOD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of horizontal bands demosaiced in parallel", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_set_static_metadata (gstelement_class,
       "Bayer to RGB decoder for cameras", "Filter/Converter/Video",
@@ -199,15 +286,40 @@ gst_bayer2rgb_init (GstBayer2RGB * filter)
 {
   gst_bayer2rgb_reset (filter);
   gst_base_transform_set_in_place (GST_BASE_TRANSFORM (filter), TRUE);
+
+  filter->method = DEFAULT_METHOD;
+  filter->n_threads = DEFAULT_N_THREADS;
+  filter->pool = NULL;
+  g_mutex_init (&filter->jobs_lock);
+  g_cond_init (&filter->jobs_cond);
+}
+
+static void
+gst_bayer2rgb_finalize (GObject * object)
+{
+  GstBayer2RGB *filter = GST_BAYER2RGB (object);
+
+  if (filter->pool)
+    g_thread_pool_free (filter->pool, FALSE, TRUE);
+  g_mutex_clear (&filter->jobs_lock);
+  g_cond_clear (&filter->jobs_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
-/* No properties are implemented, so only a warning is produced */
 static void
 gst_bayer2rgb_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
 {
+  GstBayer2RGB *filter = GST_BAYER2RGB (object);
 
   switch (prop_id) {
+    case PROP_METHOD:
+      filter->method = g_value_get_enum (value);
+      break;
+    case PROP_N_THREADS:
+      filter->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -218,14 +330,62 @@ static void
 gst_bayer2rgb_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec)
 {
+  GstBayer2RGB *filter = GST_BAYER2RGB (object);
 
   switch (prop_id) {
+    case PROP_METHOD:
+      g_value_set_enum (value, filter->method);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, filter->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* parses bggr, grbg12le, rggb16be, ... */
+static gboolean
+gst_bayer2rgb_parse_format (const gchar * format, int *pattern, int *bpp,
+    gboolean * big_endian)
+{
+  if (format == NULL || strlen (format) < 4)
+    return FALSE;
+
+  if (g_str_has_prefix (format, "bggr")) {
+    *pattern = GST_BAYER_2_RGB_FORMAT_BGGR;
+  } else if (g_str_has_prefix (format, "gbrg")) {
+    *pattern = GST_BAYER_2_RGB_FORMAT_GBRG;
+  } else if (g_str_has_prefix (format, "grbg")) {
+    *pattern = GST_BAYER_2_RGB_FORMAT_GRBG;
+  } else if (g_str_has_prefix (format, "rggb")) {
+    *pattern = GST_BAYER_2_RGB_FORMAT_RGGB;
+  } else {
+    return FALSE;
+  }
+
+  format += 4;
+  if (*format == '\0') {
+    *bpp = 8;
+    *big_endian = FALSE;
+    return TRUE;
+  }
+
+  *bpp = atoi (format);
+  if (*bpp != 10 && *bpp != 12 && *bpp != 16)
+    return FALSE;
+
+  if (g_str_has_suffix (format, "le"))
+    *big_endian = FALSE;
+  else if (g_str_has_suffix (format, "be"))
+    *big_endian = TRUE;
+  else
+    return FALSE;
+
+  return TRUE;
+}
+
 static gboolean
 gst_bayer2rgb_set_caps (GstBaseTransform * base, GstCaps * incaps,
     GstCaps * outcaps)
@@ -244,17 +404,9 @@ gst_bayer2rgb_set_caps (GstBaseTransform * base, GstCaps * incaps,
   gst_structure_get_int (structure, "height", &bayer2rgb->height);
 
   format = gst_structure_get_string (structure, "format");
-  if (g_str_equal (format, "bggr")) {
-    bayer2rgb->format = GST_BAYER_2_RGB_FORMAT_BGGR;
-  } else if (g_str_equal (format, "gbrg")) {
-    bayer2rgb->format = GST_BAYER_2_RGB_FORMAT_GBRG;
-  } else if (g_str_equal (format, "grbg")) {
-    bayer2rgb->format = GST_BAYER_2_RGB_FORMAT_GRBG;
-  } else if (g_str_equal (format, "rggb")) {
-    bayer2rgb->format = GST_BAYER_2_RGB_FORMAT_RGGB;
-  } else {
+  if (!gst_bayer2rgb_parse_format (format, &bayer2rgb->format,
+          &bayer2rgb->bpp, &bayer2rgb->big_endian))
     return FALSE;
-  }
 
   /* To cater for different RGB formats, we need to set params for later */
   gst_video_info_from_caps (&info, outcaps);
@@ -275,6 +427,8 @@ gst_bayer2rgb_reset (GstBayer2RGB * filter)
   filter->r_off = 0;
   filter->g_off = 0;
   filter->b_off = 0;
+  filter->bpp = 8;
+  filter->big_endian = FALSE;
   gst_video_info_init (&filter->info);
 }
 
@@ -291,8 +445,8 @@ gst_bayer2rgb_transform_caps (GstBaseTransform * base,
   structure = gst_caps_get_structure (caps, 0);
 
   if (direction == GST_PAD_SRC) {
-    newcaps = gst_caps_from_string ("video/x-bayer,"
-        "format=(string){bggr,grbg,gbrg,rggb}");
+    newcaps =
+        gst_caps_from_string ("video/x-bayer,format=(string)" BAYER_FORMATS);
   } else {
     newcaps = gst_caps_new_empty_simple ("video/x-raw");
   }
@@ -328,6 +482,8 @@ gst_bayer2rgb_get_unit_size (GstBaseTransform * base, GstCaps * caps,
   int width;
   int height;
   const char *name;
+  int pattern, bpp;
+  gboolean big_endian;
 
   structure = gst_caps_get_structure (caps, 0);
 
@@ -336,7 +492,10 @@ gst_bayer2rgb_get_unit_size (GstBaseTransform * base, GstCaps * caps,
     name = gst_structure_get_name (structure);
     /* Our name must be either video/x-bayer video/x-raw */
     if (strcmp (name, "video/x-raw")) {
-      *size = GST_ROUND_UP_4 (width) * height;
+      if (!gst_bayer2rgb_parse_format (gst_structure_get_string (structure,
+                  "format"), &pattern, &bpp, &big_endian))
+        bpp = 8;
+      *size = GST_ROUND_UP_4 (width * ((bpp + 7) / 8)) * height;
       return TRUE;
     } else {
       /* For output, calculate according to format (always 32 bits) */
@@ -383,27 +542,78 @@ typedef void (*process_func) (guint8 * d0, const guint8 * s0, const guint8 * s1,
     const guint8 * s2, const guint8 * s3, const guint8 * s4, const guint8 * s5,
     int n);
 
+/* We exploit some symmetry in the functions here.  The base functions
+ * are all named for the BGGR arrangement.  For RGGB, we swap the
+ * red offset and blue offset in the output.  For GRBG, we swap the
+ * order of the merge functions (that is, the parity of the rows).  For
+ * GBRG, do both. */
 static void
-gst_bayer2rgb_process (GstBayer2RGB * bayer2rgb, uint8_t * dest,
-    int dest_stride, uint8_t * src, int src_stride)
+gst_bayer2rgb_get_offsets (GstBayer2RGB * bayer2rgb, int *r_off, int *g_off,
+    int *b_off)
 {
-  int j;
-  guint8 *tmp;
-  process_func merge[2] = { NULL, NULL };
-  int r_off, g_off, b_off;
-
-  /* We exploit some symmetry in the functions here.  The base functions
-   * are all named for the BGGR arrangement.  For RGGB, we swap the
-   * red offset and blue offset in the output.  For GRBG, we swap the
-   * order of the merge functions.  For GBRG, do both. */
-  r_off = bayer2rgb->r_off;
-  g_off = bayer2rgb->g_off;
-  b_off = bayer2rgb->b_off;
+  *r_off = bayer2rgb->r_off;
+  *g_off = bayer2rgb->g_off;
+  *b_off = bayer2rgb->b_off;
   if (bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_RGGB ||
       bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GBRG) {
-    r_off = bayer2rgb->b_off;
-    b_off = bayer2rgb->r_off;
+    *r_off = bayer2rgb->b_off;
+    *b_off = bayer2rgb->r_off;
   }
+}
+
+static gboolean
+gst_bayer2rgb_swap_rows (GstBayer2RGB * bayer2rgb)
+{
+  return bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GRBG ||
+      bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GBRG;
+}
+
+/* rows above and below the frame are mirrored, which keeps the colour of
+ * each sample */
+static int
+gst_bayer2rgb_mirror_row (GstBayer2RGB * bayer2rgb, int j)
+{
+  if (j < 0)
+    j = -j;
+  if (j >= bayer2rgb->height)
+    j = 2 * (bayer2rgb->height - 1) - j;
+
+  return CLAMP (j, 0, bayer2rgb->height - 1);
+}
+
+/* returns line of 8 bit samples, converting into tmp for wider samples */
+static const guint8 *
+gst_bayer2rgb_get_line8 (GstBayer2RGB * bayer2rgb, guint8 * tmp,
+    const guint8 * src)
+{
+  guint mask = (1 << bayer2rgb->bpp) - 1;
+  int shift = bayer2rgb->bpp - 8;
+  int i;
+
+  if (bayer2rgb->bpp == 8)
+    return src;
+
+  if (bayer2rgb->big_endian) {
+    for (i = 0; i < bayer2rgb->width; i++)
+      tmp[i] = (GST_READ_UINT16_BE (src + 2 * i) & mask) >> shift;
+  } else {
+    for (i = 0; i < bayer2rgb->width; i++)
+      tmp[i] = (GST_READ_UINT16_LE (src + 2 * i) & mask) >> shift;
+  }
+
+  return tmp;
+}
+
+static void
+gst_bayer2rgb_process_bilinear (GstBayer2RGBJob * job)
+{
+  GstBayer2RGB *bayer2rgb = job->filter;
+  int j, row;
+  guint8 *tmp, *line8;
+  process_func merge[2] = { NULL, NULL };
+  int r_off, g_off, b_off;
+
+  gst_bayer2rgb_get_offsets (bayer2rgb, &r_off, &g_off, &b_off);
 
   if (r_off == 2 && g_off == 1 && b_off == 0) {
     merge[0] = bayer_orc_merge_bg_bgra;
@@ -418,39 +628,308 @@ gst_bayer2rgb_process (GstBayer2RGB * bayer2rgb, uint8_t * dest,
     merge[0] = bayer_orc_merge_bg_rgba;
     merge[1] = bayer_orc_merge_gr_rgba;
   }
-  if (bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GRBG ||
-      bayer2rgb->format == GST_BAYER_2_RGB_FORMAT_GBRG) {
+  if (gst_bayer2rgb_swap_rows (bayer2rgb)) {
     process_func tmp = merge[0];
     merge[0] = merge[1];
     merge[1] = tmp;
   }
 
-  tmp = g_malloc (2 * 4 * bayer2rgb->width);
+  tmp = g_malloc (2 * 4 * bayer2rgb->width + bayer2rgb->width);
+  line8 = tmp + 2 * 4 * bayer2rgb->width;
 #define LINE(x) (tmp + ((x)&7) * bayer2rgb->width)
-
-  gst_bayer2rgb_split_and_upsample_horiz (LINE (3 * 2 + 0), LINE (3 * 2 + 1),
-      src + 1 * src_stride, bayer2rgb->width);
-  j = 0;
-  gst_bayer2rgb_split_and_upsample_horiz (LINE (j * 2 + 0), LINE (j * 2 + 1),
-      src + j * src_stride, bayer2rgb->width);
-
-  for (j = 0; j < bayer2rgb->height; j++) {
-    if (j < bayer2rgb->height - 1) {
-      gst_bayer2rgb_split_and_upsample_horiz (LINE ((j + 1) * 2 + 0),
-          LINE ((j + 1) * 2 + 1), src + (j + 1) * src_stride, bayer2rgb->width);
-    }
-
-    merge[j & 1] (dest + j * dest_stride,
+#define SRC_LINE(x) gst_bayer2rgb_get_line8 (bayer2rgb, line8, \
+    job->src + gst_bayer2rgb_mirror_row (bayer2rgb, x) * job->src_stride)
+
+  /* prime the ring with the row above the band and its first row */
+  row = job->first_row - 1;
+  gst_bayer2rgb_split_and_upsample_horiz (LINE (row * 2 + 0),
+      LINE (row * 2 + 1), SRC_LINE (row), bayer2rgb->width);
+  row = job->first_row;
+  gst_bayer2rgb_split_and_upsample_horiz (LINE (row * 2 + 0),
+      LINE (row * 2 + 1), SRC_LINE (row), bayer2rgb->width);
+
+  for (j = job->first_row; j < job->last_row; j++) {
+    gst_bayer2rgb_split_and_upsample_horiz (LINE ((j + 1) * 2 + 0),
+        LINE ((j + 1) * 2 + 1), SRC_LINE (j + 1), bayer2rgb->width);
+
+    merge[j & 1] (job->dest + j * job->dest_stride,
         LINE (j * 2 - 2), LINE (j * 2 - 1),
         LINE (j * 2 + 0), LINE (j * 2 + 1),
         LINE (j * 2 + 2), LINE (j * 2 + 3), bayer2rgb->width >> 1);
   }
+#undef SRC_LINE
+#undef LINE
 
   g_free (tmp);
 }
 
+/*
+ * Malvar-He-Cutler gradient corrected interpolation.
+ *
+ * H. S. Malvar, L. He and R. Cutler, "High-quality linear interpolation
+ * for demosaicing of Bayer-patterned color images", ICASSP 2004.
+ *
+ * The missing colours of a sample are the bilinear estimate corrected by
+ * the laplacian of the sample's own colour, which amounts to four 5x5
+ * filters:
+ *
+ *   cross: green at red and blue     horiz: red (blue) at green in a red
+ *                                           (blue) row
+ *       . . -2  . .                      . .  1  . .
+ *       . .  4  . .                      . -2 .  -2 .
+ *      -2 4  8  4 -2                    -2 8  10  8 -2
+ *       . .  4  . .                      . -2 .  -2 .
+ *       . . -2  . .                      . .  1  . .
+ *
+ *   vert: transposed horiz           diag: red at blue and blue at red
+ *                                        . .  -3 . .
+ *                                        . 4  .  4 .
+ *                                       -3 .  12 . -3
+ *                                        . 4  .  4 .
+ *                                        . .  -3 . .
+ *
+ * all divided by 16.  Each line is split into its even and odd samples,
+ * so the same colour is always at a fixed offset in the half lines and
+ * the filters become the plain vertical sums and element-wise orc
+ * kernels below.  The samples are scaled to 10 bits first, which is as
+ * much as the filters can take without overflowing 16 bit arithmetic.
+ */
 
+/* even or odd samples of the current line and the sums needed for them */
+typedef struct
+{
+  const gint16 *c;              /* the samples themselves */
+  const gint16 *v1;             /* same colour, lines above + below */
+  const gint16 *v2;             /* same colour, two lines above + below */
+  const gint16 *qw, *qe;        /* other colour, left and right */
+  const gint16 *dw, *de;        /* lines above + below of qw and qe */
+  const gint16 *pw, *pe;        /* same colour, two samples away */
+} GstBayer2RGBHalf;
+
+#define MHC_CENTER(d,h,n) bayer_orc_mhc_center (d, (h)->c, n)
+#define MHC_CROSS(d,h,n) bayer_orc_mhc_cross (d, (h)->c, (h)->v1, (h)->v2, \
+    (h)->qw, (h)->qe, (h)->pw, (h)->pe, n)
+#define MHC_HORIZ(d,h,n) bayer_orc_mhc_horiz (d, (h)->c, (h)->v2, \
+    (h)->qw, (h)->qe, (h)->dw, (h)->de, (h)->pw, (h)->pe, n)
+#define MHC_VERT(d,h,n) bayer_orc_mhc_vert (d, (h)->c, (h)->v1, (h)->v2, \
+    (h)->dw, (h)->de, (h)->pw, (h)->pe, n)
+#define MHC_DIAG(d,h,n) bayer_orc_mhc_diag (d, (h)->c, (h)->v2, \
+    (h)->dw, (h)->de, (h)->pw, (h)->pe, n)
+
+/* splits a line into its even and odd samples scaled to 10 bits, and
+ * mirrors one sample of each at both ends.  Lines of two samples have no
+ * second sample of a colour to mirror, the first one is repeated then */
+static void
+gst_bayer2rgb_mhc_load_line (GstBayer2RGB * bayer2rgb, gint16 * even,
+    gint16 * odd, const guint8 * src)
+{
+  int hw = bayer2rgb->width >> 1;
+  guint mask = (1 << bayer2rgb->bpp) - 1;
+  int shift = bayer2rgb->bpp - 10;
+  int i;
 
+  if (bayer2rgb->bpp == 8) {
+    for (i = 0; i < hw; i++) {
+      even[i] = src[2 * i] << 2;
+      odd[i] = src[2 * i + 1] << 2;
+    }
+  } else if (bayer2rgb->big_endian) {
+    for (i = 0; i < hw; i++) {
+      even[i] = (GST_READ_UINT16_BE (src + 4 * i) & mask) >> shift;
+      odd[i] = (GST_READ_UINT16_BE (src + 4 * i + 2) & mask) >> shift;
+    }
+  } else {
+    for (i = 0; i < hw; i++) {
+      even[i] = (GST_READ_UINT16_LE (src + 4 * i) & mask) >> shift;
+      odd[i] = (GST_READ_UINT16_LE (src + 4 * i + 2) & mask) >> shift;
+    }
+  }
+
+  even[-1] = even[MIN (1, hw - 1)];
+  odd[-1] = odd[0];
+  even[hw] = even[hw - 1];
+  odd[hw] = odd[MAX (hw - 2, 0)];
+}
+
+static void
+gst_bayer2rgb_process_mhc (GstBayer2RGBJob * job)
+{
+  GstBayer2RGB *bayer2rgb = job->filter;
+  const int width = bayer2rgb->width;
+  const int hw = width >> 1;
+  const int pad = hw + 2;
+  GstBayer2RGBHalf half[2];
+  gint16 *lines, *sums, *planes;
+  gint16 *v1[2], *v2[2], *r[2], *g[2], *b[2];
+  guint8 *rgb;
+  const guint8 *slot[4];
+  int r_off, g_off, b_off;
+  int h, j, row;
+
+  lines = g_new (gint16, 5 * 2 * pad);
+  sums = g_new (gint16, 4 * pad);
+  planes = g_new (gint16, 6 * hw);
+  rgb = g_malloc (4 * width);
+
+  for (h = 0; h < 2; h++) {
+    v1[h] = sums + (2 * h) * pad + 1;
+    v2[h] = sums + (2 * h + 1) * pad + 1;
+    r[h] = planes + (3 * h) * hw;
+    g[h] = planes + (3 * h + 1) * hw;
+    b[h] = planes + (3 * h + 2) * hw;
+  }
+
+  gst_bayer2rgb_get_offsets (bayer2rgb, &r_off, &g_off, &b_off);
+  slot[r_off] = rgb;
+  slot[g_off] = rgb + width;
+  slot[b_off] = rgb + 2 * width;
+  slot[6 - r_off - g_off - b_off] = rgb + 3 * width;
+  memset (rgb + 3 * width, 0xff, width);
+
+  /* ring of five lines, each split into its even and odd half */
+#define LINE(x,h) (lines + ((((x) + 5) % 5) * 2 + (h)) * pad + 1)
+#define LOAD_LINE(x) gst_bayer2rgb_mhc_load_line (bayer2rgb, LINE (x, 0), \
+    LINE (x, 1), \
+    job->src + gst_bayer2rgb_mirror_row (bayer2rgb, x) * job->src_stride)
+
+  for (row = job->first_row - 2; row < job->first_row + 2; row++)
+    LOAD_LINE (row);
+
+  for (j = job->first_row; j < job->last_row; j++) {
+    LOAD_LINE (j + 2);
+
+    for (h = 0; h < 2; h++) {
+      bayer_orc_mhc_vsum (v1[h] - 1, v2[h] - 1, LINE (j - 1, h) - 1,
+          LINE (j + 1, h) - 1, LINE (j - 2, h) - 1, LINE (j + 2, h) - 1,
+          hw + 2);
+    }
+
+    /* the left neighbour of even sample i is odd sample i - 1, the right
+     * neighbour of odd sample i is even sample i + 1 */
+    for (h = 0; h < 2; h++) {
+      const gint16 *own = LINE (j, h);
+      const gint16 *other = LINE (j, !h);
+
+      half[h].c = own;
+      half[h].v1 = v1[h];
+      half[h].v2 = v2[h];
+      half[h].qw = other - !h;
+      half[h].qe = other + h;
+      half[h].dw = v1[!h] - !h;
+      half[h].de = v1[!h] + h;
+      half[h].pw = own - 1;
+      half[h].pe = own + 1;
+    }
+
+    if (((j & 1) ^ gst_bayer2rgb_swap_rows (bayer2rgb)) == 0) {
+      /* B G row */
+      MHC_CENTER (b[0], &half[0], hw);
+      MHC_CROSS (g[0], &half[0], hw);
+      MHC_DIAG (r[0], &half[0], hw);
+      MHC_CENTER (g[1], &half[1], hw);
+      MHC_HORIZ (b[1], &half[1], hw);
+      MHC_VERT (r[1], &half[1], hw);
+    } else {
+      /* G R row */
+      MHC_CENTER (g[0], &half[0], hw);
+      MHC_HORIZ (r[0], &half[0], hw);
+      MHC_VERT (b[0], &half[0], hw);
+      MHC_CENTER (r[1], &half[1], hw);
+      MHC_CROSS (g[1], &half[1], hw);
+      MHC_DIAG (b[1], &half[1], hw);
+    }
+
+    bayer_orc_mhc_store (rgb, r[0], r[1], hw);
+    bayer_orc_mhc_store (rgb + width, g[0], g[1], hw);
+    bayer_orc_mhc_store (rgb + 2 * width, b[0], b[1], hw);
+    bayer_orc_mhc_pack (job->dest + j * job->dest_stride, slot[0], slot[1],
+        slot[2], slot[3], hw * 2);
+  }
+#undef LOAD_LINE
+#undef LINE
+
+  g_free (lines);
+  g_free (sums);
+  g_free (planes);
+  g_free (rgb);
+}
+
+static void
+gst_bayer2rgb_run_job (GstBayer2RGBJob * job)
+{
+  if (job->method == GST_BAYER2RGB_METHOD_MHC)
+    gst_bayer2rgb_process_mhc (job);
+  else
+    gst_bayer2rgb_process_bilinear (job);
+}
+
+static void
+gst_bayer2rgb_job_func (gpointer data, gpointer user_data)
+{
+  GstBayer2RGB *bayer2rgb = user_data;
+
+  gst_bayer2rgb_run_job (data);
+
+  g_mutex_lock (&bayer2rgb->jobs_lock);
+  if (--bayer2rgb->jobs_pending == 0)
+    g_cond_signal (&bayer2rgb->jobs_cond);
+  g_mutex_unlock (&bayer2rgb->jobs_lock);
+}
+
+/* splits the frame into n-threads bands of rows, one of which is
+ * processed on the streaming thread */
+static void
+gst_bayer2rgb_process (GstBayer2RGB * bayer2rgb, uint8_t * dest,
+    int dest_stride, const uint8_t * src, int src_stride)
+{
+  GstBayer2RGBJob *jobs;
+  GstBayer2RGBMethod method;
+  int i, n_jobs, rows_per_job;
+
+  method = bayer2rgb->method;
+  /* the bilinear line upsampler reads two samples beyond its ends, the
+   * mirroring of the MHC path copes with lines of only two samples */
+  if (bayer2rgb->width < 4)
+    method = GST_BAYER2RGB_METHOD_MHC;
+  n_jobs = CLAMP (bayer2rgb->n_threads, 1, bayer2rgb->height);
+  rows_per_job = (bayer2rgb->height + n_jobs - 1) / n_jobs;
+  n_jobs = (bayer2rgb->height + rows_per_job - 1) / rows_per_job;
+
+  jobs = g_newa (GstBayer2RGBJob, n_jobs);
+  for (i = 0; i < n_jobs; i++) {
+    jobs[i].filter = bayer2rgb;
+    jobs[i].method = method;
+    jobs[i].dest = dest;
+    jobs[i].dest_stride = dest_stride;
+    jobs[i].src = src;
+    jobs[i].src_stride = src_stride;
+    jobs[i].first_row = i * rows_per_job;
+    jobs[i].last_row = MIN (bayer2rgb->height, (i + 1) * rows_per_job);
+  }
+
+  if (n_jobs > 1) {
+    if (!bayer2rgb->pool) {
+      bayer2rgb->pool =
+          g_thread_pool_new (gst_bayer2rgb_job_func, bayer2rgb, n_jobs - 1,
+          FALSE, NULL);
+    } else if (g_thread_pool_get_max_threads (bayer2rgb->pool) < n_jobs - 1) {
+      g_thread_pool_set_max_threads (bayer2rgb->pool, n_jobs - 1, NULL);
+    }
+
+    bayer2rgb->jobs_pending = n_jobs - 1;
+    for (i = 1; i < n_jobs; i++)
+      g_thread_pool_push (bayer2rgb->pool, &jobs[i], NULL);
+  }
+
+  gst_bayer2rgb_run_job (&jobs[0]);
+
+  if (n_jobs > 1) {
+    g_mutex_lock (&bayer2rgb->jobs_lock);
+    while (bayer2rgb->jobs_pending > 0)
+      g_cond_wait (&bayer2rgb->jobs_cond, &bayer2rgb->jobs_lock);
+    g_mutex_unlock (&bayer2rgb->jobs_lock);
+  }
+}
 
 static GstFlowReturn
 gst_bayer2rgb_transform (GstBaseTransform * base, GstBuffer * inbuf,
@@ -473,7 +952,7 @@ gst_bayer2rgb_transform (GstBaseTransform * base, GstBuffer * inbuf,
 
   output = GST_VIDEO_FRAME_PLANE_DATA (&frame, 0);
   gst_bayer2rgb_process (filter, output, frame.info.stride[0],
-      map.data, filter->width);
+      map.data, filter->width * ((filter->bpp + 7) / 8));
 
   gst_video_frame_unmap (&frame);
   gst_buffer_unmap (inbuf, &map);
@@ -131,6 +131,35 @@ void bayer_orc_merge_gr_argb (guint8 * ORC_RESTRICT d1,
     const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
     const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4,
     const guint8 * ORC_RESTRICT s5, const guint8 * ORC_RESTRICT s6, int n);
+void bayer_orc_mhc_vsum (gint16 * ORC_RESTRICT d1, gint16 * ORC_RESTRICT d2,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2,
+    const gint16 * ORC_RESTRICT s3, const gint16 * ORC_RESTRICT s4, int n);
+void bayer_orc_mhc_center (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, int n);
+void bayer_orc_mhc_cross (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2,
+    const gint16 * ORC_RESTRICT s3, const gint16 * ORC_RESTRICT s4,
+    const gint16 * ORC_RESTRICT s5, const gint16 * ORC_RESTRICT s6,
+    const gint16 * ORC_RESTRICT s7, int n);
+void bayer_orc_mhc_horiz (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2,
+    const gint16 * ORC_RESTRICT s3, const gint16 * ORC_RESTRICT s4,
+    const gint16 * ORC_RESTRICT s5, const gint16 * ORC_RESTRICT s6,
+    const gint16 * ORC_RESTRICT s7, const gint16 * ORC_RESTRICT s8, int n);
+void bayer_orc_mhc_vert (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2,
+    const gint16 * ORC_RESTRICT s3, const gint16 * ORC_RESTRICT s4,
+    const gint16 * ORC_RESTRICT s5, const gint16 * ORC_RESTRICT s6,
+    const gint16 * ORC_RESTRICT s7, int n);
+void bayer_orc_mhc_diag (gint16 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2,
+    const gint16 * ORC_RESTRICT s3, const gint16 * ORC_RESTRICT s4,
+    const gint16 * ORC_RESTRICT s5, const gint16 * ORC_RESTRICT s6, int n);
+void bayer_orc_mhc_store (guint8 * ORC_RESTRICT d1,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2, int n);
+void bayer_orc_mhc_pack (guint8 * ORC_RESTRICT d1,
+    const guint8 * ORC_RESTRICT s1, const guint8 * ORC_RESTRICT s2,
+    const guint8 * ORC_RESTRICT s3, const guint8 * ORC_RESTRICT s4, int n);
 
 
 /* begin Orc C target preamble */
@@ -3609,3 +3638,1742 @@ bayer_orc_merge_gr_argb (guint8 * ORC_RESTRICT d1,
   func (ex);
 }
 #endif
+
+
+/* bayer_orc_mhc_vsum */
+#ifdef DISABLE_ORC
+void
+bayer_orc_mhc_vsum (gint16 * ORC_RESTRICT d1, gint16 * ORC_RESTRICT d2,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2,
+    const gint16 * ORC_RESTRICT s3, const gint16 * ORC_RESTRICT s4, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  orc_union16 *ORC_RESTRICT ptr1;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  orc_union16 var32;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union16 var37;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr1 = (orc_union16 *) d2;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+  ptr6 = (orc_union16 *) s3;
+  ptr7 = (orc_union16 *) s4;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var32 = ptr4[i];
+    /* 1: loadw */
+    var33 = ptr5[i];
+    /* 2: addw */
+    var34.i = var32.i + var33.i;
+    /* 3: storew */
+    ptr0[i] = var34;
+    /* 4: loadw */
+    var35 = ptr6[i];
+    /* 5: loadw */
+    var36 = ptr7[i];
+    /* 6: addw */
+    var37.i = var35.i + var36.i;
+    /* 7: storew */
+    ptr1[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_bayer_orc_mhc_vsum (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  orc_union16 *ORC_RESTRICT ptr1;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  orc_union16 var32;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union16 var37;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr1 = (orc_union16 *) ex->arrays[1];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+  ptr6 = (orc_union16 *) ex->arrays[6];
+  ptr7 = (orc_union16 *) ex->arrays[7];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var32 = ptr4[i];
+    /* 1: loadw */
+    var33 = ptr5[i];
+    /* 2: addw */
+    var34.i = var32.i + var33.i;
+    /* 3: storew */
+    ptr0[i] = var34;
+    /* 4: loadw */
+    var35 = ptr6[i];
+    /* 5: loadw */
+    var36 = ptr7[i];
+    /* 6: addw */
+    var37.i = var35.i + var36.i;
+    /* 7: storew */
+    ptr1[i] = var37;
+  }
+
+}
+
+void
+bayer_orc_mhc_vsum (gint16 * ORC_RESTRICT d1, gint16 * ORC_RESTRICT d2,
+    const gint16 * ORC_RESTRICT s1, const gint16 * ORC_RESTRICT s2,
+    const gint16 * ORC_RESTRICT s3, const gint16 * ORC_RESTRICT s4, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 18, 98, 97, 121, 101, 114, 95, 111, 114, 99, 95, 109, 104, 99,
+        95, 118, 115, 117, 109, 11, 2, 2, 11, 2, 2, 12, 2, 2, 12, 2,
+        2, 12, 2, 2, 12, 2, 2, 70, 0, 4, 5, 70, 1, 6, 7, 2,
+        0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_vsum);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "bayer_orc_mhc_vsum");
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_vsum);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_destination (p, 2, "d2");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_source (p, 2, "s3");
+      orc_program_add_source (p, 2, "s4");
+
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_D1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_D2, ORC_VAR_S3, ORC_VAR_S4,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_D2] = d2;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* bayer_orc_mhc_center */
+#ifdef DISABLE_ORC
+void
+bayer_orc_mhc_center (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  orc_union16 var32;
+  orc_union16 var33;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_union16 *) s1;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var32 = ptr4[i];
+    /* 1: shlw */
+    var33.i = ((orc_uint16) var32.i) << 4;
+    /* 2: storew */
+    ptr0[i] = var33;
+  }
+
+}
+
+#else
+static void
+_backup_bayer_orc_mhc_center (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  orc_union16 var32;
+  orc_union16 var33;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var32 = ptr4[i];
+    /* 1: shlw */
+    var33.i = ((orc_uint16) var32.i) << 4;
+    /* 2: storew */
+    ptr0[i] = var33;
+  }
+
+}
+
+void
+bayer_orc_mhc_center (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 20, 98, 97, 121, 101, 114, 95, 111, 114, 99, 95, 109, 104, 99,
+        95, 99, 101, 110, 116, 101, 114, 11, 2, 2, 12, 2, 2, 14, 2, 4,
+        0, 0, 0, 93, 0, 4, 16, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_center);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "bayer_orc_mhc_center");
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_center);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_constant (p, 2, 0x00000004, "c1");
+
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_D1, ORC_VAR_S1, ORC_VAR_C1,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* bayer_orc_mhc_cross */
+#ifdef DISABLE_ORC
+void
+bayer_orc_mhc_cross (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    const gint16 * ORC_RESTRICT s2, const gint16 * ORC_RESTRICT s3,
+    const gint16 * ORC_RESTRICT s4, const gint16 * ORC_RESTRICT s5,
+    const gint16 * ORC_RESTRICT s6, const gint16 * ORC_RESTRICT s7, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  const orc_union16 *ORC_RESTRICT ptr8;
+  const orc_union16 *ORC_RESTRICT ptr9;
+  const orc_union16 *ORC_RESTRICT ptr10;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+  ptr6 = (orc_union16 *) s3;
+  ptr7 = (orc_union16 *) s4;
+  ptr8 = (orc_union16 *) s5;
+  ptr9 = (orc_union16 *) s6;
+  ptr10 = (orc_union16 *) s7;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var34 = ptr7[i];
+    /* 1: loadw */
+    var35 = ptr8[i];
+    /* 2: addw */
+    var42.i = var34.i + var35.i;
+    /* 3: loadw */
+    var36 = ptr5[i];
+    /* 4: addw */
+    var43.i = var42.i + var36.i;
+    /* 5: shlw */
+    var44.i = ((orc_uint16) var43.i) << 2;
+    /* 6: loadw */
+    var37 = ptr4[i];
+    /* 7: shlw */
+    var45.i = ((orc_uint16) var37.i) << 3;
+    /* 8: addw */
+    var46.i = var44.i + var45.i;
+    /* 9: loadw */
+    var38 = ptr9[i];
+    /* 10: loadw */
+    var39 = ptr10[i];
+    /* 11: addw */
+    var47.i = var38.i + var39.i;
+    /* 12: loadw */
+    var40 = ptr6[i];
+    /* 13: addw */
+    var48.i = var47.i + var40.i;
+    /* 14: shlw */
+    var49.i = ((orc_uint16) var48.i) << 1;
+    /* 15: subw */
+    var41.i = var46.i - var49.i;
+    /* 16: storew */
+    ptr0[i] = var41;
+  }
+
+}
+
+#else
+static void
+_backup_bayer_orc_mhc_cross (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  const orc_union16 *ORC_RESTRICT ptr8;
+  const orc_union16 *ORC_RESTRICT ptr9;
+  const orc_union16 *ORC_RESTRICT ptr10;
+  orc_union16 var34;
+  orc_union16 var35;
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+  ptr6 = (orc_union16 *) ex->arrays[6];
+  ptr7 = (orc_union16 *) ex->arrays[7];
+  ptr8 = (orc_union16 *) ex->arrays[8];
+  ptr9 = (orc_union16 *) ex->arrays[9];
+  ptr10 = (orc_union16 *) ex->arrays[10];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var34 = ptr7[i];
+    /* 1: loadw */
+    var35 = ptr8[i];
+    /* 2: addw */
+    var42.i = var34.i + var35.i;
+    /* 3: loadw */
+    var36 = ptr5[i];
+    /* 4: addw */
+    var43.i = var42.i + var36.i;
+    /* 5: shlw */
+    var44.i = ((orc_uint16) var43.i) << 2;
+    /* 6: loadw */
+    var37 = ptr4[i];
+    /* 7: shlw */
+    var45.i = ((orc_uint16) var37.i) << 3;
+    /* 8: addw */
+    var46.i = var44.i + var45.i;
+    /* 9: loadw */
+    var38 = ptr9[i];
+    /* 10: loadw */
+    var39 = ptr10[i];
+    /* 11: addw */
+    var47.i = var38.i + var39.i;
+    /* 12: loadw */
+    var40 = ptr6[i];
+    /* 13: addw */
+    var48.i = var47.i + var40.i;
+    /* 14: shlw */
+    var49.i = ((orc_uint16) var48.i) << 1;
+    /* 15: subw */
+    var41.i = var46.i - var49.i;
+    /* 16: storew */
+    ptr0[i] = var41;
+  }
+
+}
+
+void
+bayer_orc_mhc_cross (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    const gint16 * ORC_RESTRICT s2, const gint16 * ORC_RESTRICT s3,
+    const gint16 * ORC_RESTRICT s4, const gint16 * ORC_RESTRICT s5,
+    const gint16 * ORC_RESTRICT s6, const gint16 * ORC_RESTRICT s7, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 19, 98, 97, 121, 101, 114, 95, 111, 114, 99, 95, 109, 104, 99,
+        95, 99, 114, 111, 115, 115, 11, 2, 2, 12, 2, 2, 12, 2, 2, 12,
+        2, 2, 12, 2, 2, 12, 2, 2, 12, 2, 2, 12, 2, 2, 14, 2,
+        2, 0, 0, 0, 14, 2, 3, 0, 0, 0, 14, 2, 1, 0, 0, 0,
+        20, 2, 20, 2, 70, 32, 7, 8, 70, 32, 32, 5, 93, 32, 32, 16,
+        93, 33, 4, 17, 70, 32, 32, 33, 70, 33, 9, 10, 70, 33, 33, 6,
+        93, 33, 33, 18, 98, 0, 32, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_cross);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "bayer_orc_mhc_cross");
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_cross);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_source (p, 2, "s3");
+      orc_program_add_source (p, 2, "s4");
+      orc_program_add_source (p, 2, "s5");
+      orc_program_add_source (p, 2, "s6");
+      orc_program_add_source (p, 2, "s7");
+      orc_program_add_constant (p, 2, 0x00000002, "c1");
+      orc_program_add_constant (p, 2, 0x00000003, "c2");
+      orc_program_add_constant (p, 2, 0x00000001, "c3");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_S4, ORC_VAR_S5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T2, ORC_VAR_S1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_S6, ORC_VAR_S7,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->arrays[ORC_VAR_S6] = (void *) s6;
+  ex->arrays[ORC_VAR_S7] = (void *) s7;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* bayer_orc_mhc_horiz */
+#ifdef DISABLE_ORC
+void
+bayer_orc_mhc_horiz (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    const gint16 * ORC_RESTRICT s2, const gint16 * ORC_RESTRICT s3,
+    const gint16 * ORC_RESTRICT s4, const gint16 * ORC_RESTRICT s5,
+    const gint16 * ORC_RESTRICT s6, const gint16 * ORC_RESTRICT s7,
+    const gint16 * ORC_RESTRICT s8, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  const orc_union16 *ORC_RESTRICT ptr8;
+  const orc_union16 *ORC_RESTRICT ptr9;
+  const orc_union16 *ORC_RESTRICT ptr10;
+  const orc_union16 *ORC_RESTRICT ptr11;
+  orc_union16 var34;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var35;
+#else
+  orc_union16 var35;
+#endif
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+  ptr6 = (orc_union16 *) s3;
+  ptr7 = (orc_union16 *) s4;
+  ptr8 = (orc_union16 *) s5;
+  ptr9 = (orc_union16 *) s6;
+  ptr10 = (orc_union16 *) s7;
+  ptr11 = (orc_union16 *) s8;
+
+  /* 1: loadpw */
+  var35.i = (int) 0x0000000a;   /* 10 or 4.94066e-323f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var34 = ptr4[i];
+    /* 2: mullw */
+    var44.i = (var34.i * var35.i) & 0xffff;
+    /* 3: loadw */
+    var36 = ptr6[i];
+    /* 4: loadw */
+    var37 = ptr7[i];
+    /* 5: addw */
+    var45.i = var36.i + var37.i;
+    /* 6: shlw */
+    var46.i = ((orc_uint16) var45.i) << 3;
+    /* 7: addw */
+    var47.i = var44.i + var46.i;
+    /* 8: loadw */
+    var38 = ptr5[i];
+    /* 9: addw */
+    var48.i = var47.i + var38.i;
+    /* 10: loadw */
+    var39 = ptr8[i];
+    /* 11: loadw */
+    var40 = ptr9[i];
+    /* 12: addw */
+    var49.i = var39.i + var40.i;
+    /* 13: loadw */
+    var41 = ptr10[i];
+    /* 14: addw */
+    var50.i = var49.i + var41.i;
+    /* 15: loadw */
+    var42 = ptr11[i];
+    /* 16: addw */
+    var51.i = var50.i + var42.i;
+    /* 17: shlw */
+    var52.i = ((orc_uint16) var51.i) << 1;
+    /* 18: subw */
+    var43.i = var48.i - var52.i;
+    /* 19: storew */
+    ptr0[i] = var43;
+  }
+
+}
+
+#else
+static void
+_backup_bayer_orc_mhc_horiz (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  const orc_union16 *ORC_RESTRICT ptr8;
+  const orc_union16 *ORC_RESTRICT ptr9;
+  const orc_union16 *ORC_RESTRICT ptr10;
+  const orc_union16 *ORC_RESTRICT ptr11;
+  orc_union16 var34;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var35;
+#else
+  orc_union16 var35;
+#endif
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+  ptr6 = (orc_union16 *) ex->arrays[6];
+  ptr7 = (orc_union16 *) ex->arrays[7];
+  ptr8 = (orc_union16 *) ex->arrays[8];
+  ptr9 = (orc_union16 *) ex->arrays[9];
+  ptr10 = (orc_union16 *) ex->arrays[10];
+  ptr11 = (orc_union16 *) ex->arrays[11];
+
+  /* 1: loadpw */
+  var35.i = (int) 0x0000000a;   /* 10 or 4.94066e-323f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var34 = ptr4[i];
+    /* 2: mullw */
+    var44.i = (var34.i * var35.i) & 0xffff;
+    /* 3: loadw */
+    var36 = ptr6[i];
+    /* 4: loadw */
+    var37 = ptr7[i];
+    /* 5: addw */
+    var45.i = var36.i + var37.i;
+    /* 6: shlw */
+    var46.i = ((orc_uint16) var45.i) << 3;
+    /* 7: addw */
+    var47.i = var44.i + var46.i;
+    /* 8: loadw */
+    var38 = ptr5[i];
+    /* 9: addw */
+    var48.i = var47.i + var38.i;
+    /* 10: loadw */
+    var39 = ptr8[i];
+    /* 11: loadw */
+    var40 = ptr9[i];
+    /* 12: addw */
+    var49.i = var39.i + var40.i;
+    /* 13: loadw */
+    var41 = ptr10[i];
+    /* 14: addw */
+    var50.i = var49.i + var41.i;
+    /* 15: loadw */
+    var42 = ptr11[i];
+    /* 16: addw */
+    var51.i = var50.i + var42.i;
+    /* 17: shlw */
+    var52.i = ((orc_uint16) var51.i) << 1;
+    /* 18: subw */
+    var43.i = var48.i - var52.i;
+    /* 19: storew */
+    ptr0[i] = var43;
+  }
+
+}
+
+void
+bayer_orc_mhc_horiz (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    const gint16 * ORC_RESTRICT s2, const gint16 * ORC_RESTRICT s3,
+    const gint16 * ORC_RESTRICT s4, const gint16 * ORC_RESTRICT s5,
+    const gint16 * ORC_RESTRICT s6, const gint16 * ORC_RESTRICT s7,
+    const gint16 * ORC_RESTRICT s8, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 19, 98, 97, 121, 101, 114, 95, 111, 114, 99, 95, 109, 104, 99,
+        95, 104, 111, 114, 105, 122, 11, 2, 2, 12, 2, 2, 12, 2, 2, 12,
+        2, 2, 12, 2, 2, 12, 2, 2, 12, 2, 2, 12, 2, 2, 12, 2,
+        2, 14, 2, 10, 0, 0, 0, 14, 2, 3, 0, 0, 0, 14, 2, 1,
+        0, 0, 0, 20, 2, 20, 2, 89, 32, 4, 16, 70, 33, 6, 7, 93,
+        33, 33, 17, 70, 32, 32, 33, 70, 32, 32, 5, 70, 33, 8, 9, 70,
+        33, 33, 10, 70, 33, 33, 11, 93, 33, 33, 18, 98, 0, 32, 33, 2,
+        0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_horiz);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "bayer_orc_mhc_horiz");
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_horiz);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_source (p, 2, "s3");
+      orc_program_add_source (p, 2, "s4");
+      orc_program_add_source (p, 2, "s5");
+      orc_program_add_source (p, 2, "s6");
+      orc_program_add_source (p, 2, "s7");
+      orc_program_add_source (p, 2, "s8");
+      orc_program_add_constant (p, 2, 0x0000000a, "c1");
+      orc_program_add_constant (p, 2, 0x00000003, "c2");
+      orc_program_add_constant (p, 2, 0x00000001, "c3");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_S3, ORC_VAR_S4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_S5, ORC_VAR_S6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_S7,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_S8,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->arrays[ORC_VAR_S6] = (void *) s6;
+  ex->arrays[ORC_VAR_S7] = (void *) s7;
+  ex->arrays[ORC_VAR_S8] = (void *) s8;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* bayer_orc_mhc_vert */
+#ifdef DISABLE_ORC
+void
+bayer_orc_mhc_vert (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    const gint16 * ORC_RESTRICT s2, const gint16 * ORC_RESTRICT s3,
+    const gint16 * ORC_RESTRICT s4, const gint16 * ORC_RESTRICT s5,
+    const gint16 * ORC_RESTRICT s6, const gint16 * ORC_RESTRICT s7, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  const orc_union16 *ORC_RESTRICT ptr8;
+  const orc_union16 *ORC_RESTRICT ptr9;
+  const orc_union16 *ORC_RESTRICT ptr10;
+  orc_union16 var34;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var35;
+#else
+  orc_union16 var35;
+#endif
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+  ptr6 = (orc_union16 *) s3;
+  ptr7 = (orc_union16 *) s4;
+  ptr8 = (orc_union16 *) s5;
+  ptr9 = (orc_union16 *) s6;
+  ptr10 = (orc_union16 *) s7;
+
+  /* 1: loadpw */
+  var35.i = (int) 0x0000000a;   /* 10 or 4.94066e-323f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var34 = ptr4[i];
+    /* 2: mullw */
+    var43.i = (var34.i * var35.i) & 0xffff;
+    /* 3: loadw */
+    var36 = ptr5[i];
+    /* 4: shlw */
+    var44.i = ((orc_uint16) var36.i) << 3;
+    /* 5: addw */
+    var45.i = var43.i + var44.i;
+    /* 6: loadw */
+    var37 = ptr9[i];
+    /* 7: addw */
+    var46.i = var45.i + var37.i;
+    /* 8: loadw */
+    var38 = ptr10[i];
+    /* 9: addw */
+    var47.i = var46.i + var38.i;
+    /* 10: loadw */
+    var39 = ptr7[i];
+    /* 11: loadw */
+    var40 = ptr8[i];
+    /* 12: addw */
+    var48.i = var39.i + var40.i;
+    /* 13: loadw */
+    var41 = ptr6[i];
+    /* 14: addw */
+    var49.i = var48.i + var41.i;
+    /* 15: shlw */
+    var50.i = ((orc_uint16) var49.i) << 1;
+    /* 16: subw */
+    var42.i = var47.i - var50.i;
+    /* 17: storew */
+    ptr0[i] = var42;
+  }
+
+}
+
+#else
+static void
+_backup_bayer_orc_mhc_vert (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  const orc_union16 *ORC_RESTRICT ptr8;
+  const orc_union16 *ORC_RESTRICT ptr9;
+  const orc_union16 *ORC_RESTRICT ptr10;
+  orc_union16 var34;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var35;
+#else
+  orc_union16 var35;
+#endif
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+  ptr6 = (orc_union16 *) ex->arrays[6];
+  ptr7 = (orc_union16 *) ex->arrays[7];
+  ptr8 = (orc_union16 *) ex->arrays[8];
+  ptr9 = (orc_union16 *) ex->arrays[9];
+  ptr10 = (orc_union16 *) ex->arrays[10];
+
+  /* 1: loadpw */
+  var35.i = (int) 0x0000000a;   /* 10 or 4.94066e-323f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var34 = ptr4[i];
+    /* 2: mullw */
+    var43.i = (var34.i * var35.i) & 0xffff;
+    /* 3: loadw */
+    var36 = ptr5[i];
+    /* 4: shlw */
+    var44.i = ((orc_uint16) var36.i) << 3;
+    /* 5: addw */
+    var45.i = var43.i + var44.i;
+    /* 6: loadw */
+    var37 = ptr9[i];
+    /* 7: addw */
+    var46.i = var45.i + var37.i;
+    /* 8: loadw */
+    var38 = ptr10[i];
+    /* 9: addw */
+    var47.i = var46.i + var38.i;
+    /* 10: loadw */
+    var39 = ptr7[i];
+    /* 11: loadw */
+    var40 = ptr8[i];
+    /* 12: addw */
+    var48.i = var39.i + var40.i;
+    /* 13: loadw */
+    var41 = ptr6[i];
+    /* 14: addw */
+    var49.i = var48.i + var41.i;
+    /* 15: shlw */
+    var50.i = ((orc_uint16) var49.i) << 1;
+    /* 16: subw */
+    var42.i = var47.i - var50.i;
+    /* 17: storew */
+    ptr0[i] = var42;
+  }
+
+}
+
+void
+bayer_orc_mhc_vert (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    const gint16 * ORC_RESTRICT s2, const gint16 * ORC_RESTRICT s3,
+    const gint16 * ORC_RESTRICT s4, const gint16 * ORC_RESTRICT s5,
+    const gint16 * ORC_RESTRICT s6, const gint16 * ORC_RESTRICT s7, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 18, 98, 97, 121, 101, 114, 95, 111, 114, 99, 95, 109, 104, 99,
+        95, 118, 101, 114, 116, 11, 2, 2, 12, 2, 2, 12, 2, 2, 12, 2,
+        2, 12, 2, 2, 12, 2, 2, 12, 2, 2, 12, 2, 2, 14, 2, 10,
+        0, 0, 0, 14, 2, 3, 0, 0, 0, 14, 2, 1, 0, 0, 0, 20,
+        2, 20, 2, 89, 32, 4, 16, 93, 33, 5, 17, 70, 32, 32, 33, 70,
+        32, 32, 9, 70, 32, 32, 10, 70, 33, 7, 8, 70, 33, 33, 6, 93,
+        33, 33, 18, 98, 0, 32, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_vert);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "bayer_orc_mhc_vert");
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_vert);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_source (p, 2, "s3");
+      orc_program_add_source (p, 2, "s4");
+      orc_program_add_source (p, 2, "s5");
+      orc_program_add_source (p, 2, "s6");
+      orc_program_add_source (p, 2, "s7");
+      orc_program_add_constant (p, 2, 0x0000000a, "c1");
+      orc_program_add_constant (p, 2, 0x00000003, "c2");
+      orc_program_add_constant (p, 2, 0x00000001, "c3");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_S6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_S7,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_S4, ORC_VAR_S5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->arrays[ORC_VAR_S6] = (void *) s6;
+  ex->arrays[ORC_VAR_S7] = (void *) s7;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* bayer_orc_mhc_diag */
+#ifdef DISABLE_ORC
+void
+bayer_orc_mhc_diag (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    const gint16 * ORC_RESTRICT s2, const gint16 * ORC_RESTRICT s3,
+    const gint16 * ORC_RESTRICT s4, const gint16 * ORC_RESTRICT s5,
+    const gint16 * ORC_RESTRICT s6, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  const orc_union16 *ORC_RESTRICT ptr8;
+  const orc_union16 *ORC_RESTRICT ptr9;
+  orc_union16 var34;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var35;
+#else
+  orc_union16 var35;
+#endif
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var41;
+#else
+  orc_union16 var41;
+#endif
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+  ptr6 = (orc_union16 *) s3;
+  ptr7 = (orc_union16 *) s4;
+  ptr8 = (orc_union16 *) s5;
+  ptr9 = (orc_union16 *) s6;
+
+  /* 1: loadpw */
+  var35.i = (int) 0x0000000c;   /* 12 or 5.92879e-323f */
+  /* 13: loadpw */
+  var41.i = (int) 0x00000003;   /* 3 or 1.4822e-323f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var34 = ptr4[i];
+    /* 2: mullw */
+    var43.i = (var34.i * var35.i) & 0xffff;
+    /* 3: loadw */
+    var36 = ptr6[i];
+    /* 4: loadw */
+    var37 = ptr7[i];
+    /* 5: addw */
+    var44.i = var36.i + var37.i;
+    /* 6: shlw */
+    var45.i = ((orc_uint16) var44.i) << 2;
+    /* 7: addw */
+    var46.i = var43.i + var45.i;
+    /* 8: loadw */
+    var38 = ptr8[i];
+    /* 9: loadw */
+    var39 = ptr9[i];
+    /* 10: addw */
+    var47.i = var38.i + var39.i;
+    /* 11: loadw */
+    var40 = ptr5[i];
+    /* 12: addw */
+    var48.i = var47.i + var40.i;
+    /* 14: mullw */
+    var49.i = (var48.i * var41.i) & 0xffff;
+    /* 15: subw */
+    var42.i = var46.i - var49.i;
+    /* 16: storew */
+    ptr0[i] = var42;
+  }
+
+}
+
+#else
+static void
+_backup_bayer_orc_mhc_diag (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  const orc_union16 *ORC_RESTRICT ptr6;
+  const orc_union16 *ORC_RESTRICT ptr7;
+  const orc_union16 *ORC_RESTRICT ptr8;
+  const orc_union16 *ORC_RESTRICT ptr9;
+  orc_union16 var34;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var35;
+#else
+  orc_union16 var35;
+#endif
+  orc_union16 var36;
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var41;
+#else
+  orc_union16 var41;
+#endif
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+  ptr6 = (orc_union16 *) ex->arrays[6];
+  ptr7 = (orc_union16 *) ex->arrays[7];
+  ptr8 = (orc_union16 *) ex->arrays[8];
+  ptr9 = (orc_union16 *) ex->arrays[9];
+
+  /* 1: loadpw */
+  var35.i = (int) 0x0000000c;   /* 12 or 5.92879e-323f */
+  /* 13: loadpw */
+  var41.i = (int) 0x00000003;   /* 3 or 1.4822e-323f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var34 = ptr4[i];
+    /* 2: mullw */
+    var43.i = (var34.i * var35.i) & 0xffff;
+    /* 3: loadw */
+    var36 = ptr6[i];
+    /* 4: loadw */
+    var37 = ptr7[i];
+    /* 5: addw */
+    var44.i = var36.i + var37.i;
+    /* 6: shlw */
+    var45.i = ((orc_uint16) var44.i) << 2;
+    /* 7: addw */
+    var46.i = var43.i + var45.i;
+    /* 8: loadw */
+    var38 = ptr8[i];
+    /* 9: loadw */
+    var39 = ptr9[i];
+    /* 10: addw */
+    var47.i = var38.i + var39.i;
+    /* 11: loadw */
+    var40 = ptr5[i];
+    /* 12: addw */
+    var48.i = var47.i + var40.i;
+    /* 14: mullw */
+    var49.i = (var48.i * var41.i) & 0xffff;
+    /* 15: subw */
+    var42.i = var46.i - var49.i;
+    /* 16: storew */
+    ptr0[i] = var42;
+  }
+
+}
+
+void
+bayer_orc_mhc_diag (gint16 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    const gint16 * ORC_RESTRICT s2, const gint16 * ORC_RESTRICT s3,
+    const gint16 * ORC_RESTRICT s4, const gint16 * ORC_RESTRICT s5,
+    const gint16 * ORC_RESTRICT s6, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 18, 98, 97, 121, 101, 114, 95, 111, 114, 99, 95, 109, 104, 99,
+        95, 100, 105, 97, 103, 11, 2, 2, 12, 2, 2, 12, 2, 2, 12, 2,
+        2, 12, 2, 2, 12, 2, 2, 12, 2, 2, 14, 2, 12, 0, 0, 0,
+        14, 2, 2, 0, 0, 0, 14, 2, 3, 0, 0, 0, 20, 2, 20, 2,
+        89, 32, 4, 16, 70, 33, 6, 7, 93, 33, 33, 17, 70, 32, 32, 33,
+        70, 33, 8, 9, 70, 33, 33, 5, 89, 33, 33, 18, 98, 0, 32, 33,
+        2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_diag);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "bayer_orc_mhc_diag");
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_diag);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_source (p, 2, "s3");
+      orc_program_add_source (p, 2, "s4");
+      orc_program_add_source (p, 2, "s5");
+      orc_program_add_source (p, 2, "s6");
+      orc_program_add_constant (p, 2, 0x0000000c, "c1");
+      orc_program_add_constant (p, 2, 0x00000002, "c2");
+      orc_program_add_constant (p, 2, 0x00000003, "c3");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_S3, ORC_VAR_S4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_S5, ORC_VAR_S6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->arrays[ORC_VAR_S6] = (void *) s6;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* bayer_orc_mhc_store */
+#ifdef DISABLE_ORC
+void
+bayer_orc_mhc_store (guint8 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    const gint16 * ORC_RESTRICT s2, int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  orc_union16 var35;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var36;
+#else
+  orc_union16 var36;
+#endif
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_int8 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_int8 var44;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_union16 *) s1;
+  ptr5 = (orc_union16 *) s2;
+
+  /* 1: loadpw */
+  var36.i = (int) 0x00000020;   /* 32 or 1.58101e-322f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var35 = ptr4[i];
+    /* 2: addw */
+    var39.i = var35.i + var36.i;
+    /* 3: shrsw */
+    var40.i = var39.i >> 6;
+    /* 4: convsuswb */
+    var41 = ORC_CLAMP_UB (var40.i);
+    /* 5: loadw */
+    var37 = ptr5[i];
+    /* 6: addw */
+    var42.i = var37.i + var36.i;
+    /* 7: shrsw */
+    var43.i = var42.i >> 6;
+    /* 8: convsuswb */
+    var44 = ORC_CLAMP_UB (var43.i);
+    /* 9: mergebw */
+    {
+      orc_union16 _dest;
+      _dest.x2[0] = var41;
+      _dest.x2[1] = var44;
+      var38.i = _dest.i;
+    }
+    /* 10: storew */
+    ptr0[i] = var38;
+  }
+
+}
+
+#else
+static void
+_backup_bayer_orc_mhc_store (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  const orc_union16 *ORC_RESTRICT ptr5;
+  orc_union16 var35;
+#if defined(__APPLE__) && __GNUC__ == 4 && __GNUC_MINOR__ == 2 && defined (__i386__)
+  volatile orc_union16 var36;
+#else
+  orc_union16 var36;
+#endif
+  orc_union16 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_int8 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_int8 var44;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+  ptr5 = (orc_union16 *) ex->arrays[5];
+
+  /* 1: loadpw */
+  var36.i = (int) 0x00000020;   /* 32 or 1.58101e-322f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var35 = ptr4[i];
+    /* 2: addw */
+    var39.i = var35.i + var36.i;
+    /* 3: shrsw */
+    var40.i = var39.i >> 6;
+    /* 4: convsuswb */
+    var41 = ORC_CLAMP_UB (var40.i);
+    /* 5: loadw */
+    var37 = ptr5[i];
+    /* 6: addw */
+    var42.i = var37.i + var36.i;
+    /* 7: shrsw */
+    var43.i = var42.i >> 6;
+    /* 8: convsuswb */
+    var44 = ORC_CLAMP_UB (var43.i);
+    /* 9: mergebw */
+    {
+      orc_union16 _dest;
+      _dest.x2[0] = var41;
+      _dest.x2[1] = var44;
+      var38.i = _dest.i;
+    }
+    /* 10: storew */
+    ptr0[i] = var38;
+  }
+
+}
+
+void
+bayer_orc_mhc_store (guint8 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    const gint16 * ORC_RESTRICT s2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 19, 98, 97, 121, 101, 114, 95, 111, 114, 99, 95, 109, 104, 99,
+        95, 115, 116, 111, 114, 101, 11, 2, 2, 12, 2, 2, 12, 2, 2, 14,
+        2, 32, 0, 0, 0, 14, 2, 6, 0, 0, 0, 20, 2, 20, 1, 20,
+        1, 70, 32, 4, 16, 94, 32, 32, 17, 160, 33, 32, 70, 32, 5, 16,
+        94, 32, 32, 17, 160, 34, 32, 196, 0, 33, 34, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_store);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "bayer_orc_mhc_store");
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_store);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_source (p, 2, "s2");
+      orc_program_add_constant (p, 2, 0x00000020, "c1");
+      orc_program_add_constant (p, 2, 0x00000006, "c2");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 1, "t2");
+      orc_program_add_temporary (p, 1, "t3");
+
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convsuswb", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_S2, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convsuswb", 0, ORC_VAR_T3, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "mergebw", 0, ORC_VAR_D1, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* bayer_orc_mhc_pack */
+#ifdef DISABLE_ORC
+void
+bayer_orc_mhc_pack (guint8 * ORC_RESTRICT d1, const guint8 * ORC_RESTRICT s1,
+    const guint8 * ORC_RESTRICT s2, const guint8 * ORC_RESTRICT s3,
+    const guint8 * ORC_RESTRICT s4, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_union32 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+  ptr7 = (orc_int8 *) s4;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr4[i];
+    /* 1: loadb */
+    var35 = ptr5[i];
+    /* 2: mergebw */
+    {
+      orc_union16 _dest;
+      _dest.x2[0] = var34;
+      _dest.x2[1] = var35;
+      var39.i = _dest.i;
+    }
+    /* 3: loadb */
+    var36 = ptr6[i];
+    /* 4: loadb */
+    var37 = ptr7[i];
+    /* 5: mergebw */
+    {
+      orc_union16 _dest;
+      _dest.x2[0] = var36;
+      _dest.x2[1] = var37;
+      var40.i = _dest.i;
+    }
+    /* 6: mergewl */
+    {
+      orc_union32 _dest;
+      _dest.x2[0] = var39.i;
+      _dest.x2[1] = var40.i;
+      var38.i = _dest.i;
+    }
+    /* 7: storel */
+    ptr0[i] = var38;
+  }
+
+}
+
+#else
+static void
+_backup_bayer_orc_mhc_pack (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_union32 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr4[i];
+    /* 1: loadb */
+    var35 = ptr5[i];
+    /* 2: mergebw */
+    {
+      orc_union16 _dest;
+      _dest.x2[0] = var34;
+      _dest.x2[1] = var35;
+      var39.i = _dest.i;
+    }
+    /* 3: loadb */
+    var36 = ptr6[i];
+    /* 4: loadb */
+    var37 = ptr7[i];
+    /* 5: mergebw */
+    {
+      orc_union16 _dest;
+      _dest.x2[0] = var36;
+      _dest.x2[1] = var37;
+      var40.i = _dest.i;
+    }
+    /* 6: mergewl */
+    {
+      orc_union32 _dest;
+      _dest.x2[0] = var39.i;
+      _dest.x2[1] = var40.i;
+      var38.i = _dest.i;
+    }
+    /* 7: storel */
+    ptr0[i] = var38;
+  }
+
+}
+
+void
+bayer_orc_mhc_pack (guint8 * ORC_RESTRICT d1, const guint8 * ORC_RESTRICT s1,
+    const guint8 * ORC_RESTRICT s2, const guint8 * ORC_RESTRICT s3,
+    const guint8 * ORC_RESTRICT s4, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+#if 1
+      static const orc_uint8 bc[] = {
+        1, 9, 18, 98, 97, 121, 101, 114, 95, 111, 114, 99, 95, 109, 104, 99,
+        95, 112, 97, 99, 107, 11, 4, 4, 12, 1, 1, 12, 1, 1, 12, 1,
+        1, 12, 1, 1, 20, 2, 20, 2, 196, 32, 4, 5, 196, 33, 6, 7,
+        195, 0, 32, 33, 2, 0,
+      };
+      p = orc_program_new_from_static_bytecode (bc);
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_pack);
+#else
+      p = orc_program_new ();
+      orc_program_set_name (p, "bayer_orc_mhc_pack");
+      orc_program_set_backup_function (p, _backup_bayer_orc_mhc_pack);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+
+      orc_program_append_2 (p, "mergebw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mergebw", 0, ORC_VAR_T2, ORC_VAR_S3, ORC_VAR_S4,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mergewl", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_T2,
+          ORC_VAR_D1);
+#endif
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
@@ -16,23 +16,100 @@
  * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
  * Boston, MA 02110-1301, USA.
  */
+/**
+ * SECTION:element-checksumsink
+ *
+ * Prints a checksum for every buffer it receives, which is handy to
+ * verify that a decoder produces bit-exact output.
+ *
+ * With #GstChecksumSink:plane-checksums enabled and raw video caps, only
+ * the visible bytes of every line are hashed and one checksum is
+ * produced per plane, so that pictures with different strides or
+ * padding still compare equal.
+ *
+ * Hashing happens on a worker thread which holds on to at most
+ * #GstChecksumSink:max-pending buffers.  If #GstChecksumSink:location is
+ * set, the checksums are written there as CSV with the columns
+ * frame,pts,plane,checksum instead of being printed; pts is in
+ * nanoseconds (-1 if unknown) and plane is -1 for whole buffer
+ * checksums.
+ *
+ * <refsect2>
+ * <title>Example launch line</title>
+ * |[
+ * gst-launch-1.0 filesrc location=in.mkv ! decodebin ! checksumsink hash=xxhash32 plane-checksums=true location=out.csv
+ * ]|
+ * </refsect2>
+ */
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#include <string.h>
+#include <errno.h>
+
 #include <gst/gst.h>
 #include <gst/base/gstbasesink.h>
 #include "gstchecksumsink.h"
 
+GST_DEBUG_CATEGORY_STATIC (gst_checksum_sink_debug);
+#define GST_CAT_DEFAULT gst_checksum_sink_debug
+
+static void gst_checksum_sink_set_property (GObject * object,
+    guint property_id, const GValue * value, GParamSpec * pspec);
+static void gst_checksum_sink_get_property (GObject * object,
+    guint property_id, GValue * value, GParamSpec * pspec);
 static void gst_checksum_sink_dispose (GObject * object);
 static void gst_checksum_sink_finalize (GObject * object);
 
 static gboolean gst_checksum_sink_start (GstBaseSink * sink);
 static gboolean gst_checksum_sink_stop (GstBaseSink * sink);
+static gboolean gst_checksum_sink_unlock (GstBaseSink * sink);
+static gboolean gst_checksum_sink_unlock_stop (GstBaseSink * sink);
+static gboolean gst_checksum_sink_set_caps (GstBaseSink * sink,
+    GstCaps * caps);
+static gboolean gst_checksum_sink_event (GstBaseSink * sink,
+    GstEvent * event);
 static GstFlowReturn
 gst_checksum_sink_render (GstBaseSink * sink, GstBuffer * buffer);
 
+enum
+{
+  PROP_0,
+  PROP_HASH,
+  PROP_PLANE_CHECKSUMS,
+  PROP_LOCATION,
+  PROP_MAX_PENDING
+};
+
+#define DEFAULT_HASH GST_CHECKSUM_SINK_HASH_SHA1
+#define DEFAULT_PLANE_CHECKSUMS FALSE
+#define DEFAULT_LOCATION NULL
+#define DEFAULT_MAX_PENDING 8
+
+#define GST_TYPE_CHECKSUM_SINK_HASH (gst_checksum_sink_hash_get_type ())
+static GType
+gst_checksum_sink_hash_get_type (void)
+{
+  static GType hash_type = 0;
+  static const GEnumValue hash_types[] = {
+    {GST_CHECKSUM_SINK_HASH_MD5, "MD5", "md5"},
+    {GST_CHECKSUM_SINK_HASH_SHA1, "SHA-1", "sha1"},
+    {GST_CHECKSUM_SINK_HASH_SHA256, "SHA-256", "sha256"},
+    {GST_CHECKSUM_SINK_HASH_CRC32C, "CRC-32C (fast, not cryptographic)",
+        "crc32c"},
+    {GST_CHECKSUM_SINK_HASH_XXHASH32, "xxHash32 (fast, not cryptographic)",
+        "xxhash32"},
+    {0, NULL, NULL}
+  };
+
+  if (!hash_type) {
+    hash_type = g_enum_register_static ("GstChecksumSinkHash", hash_types);
+  }
+  return hash_type;
+}
+
 static GstStaticPadTemplate gst_checksum_sink_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -48,7 +125,10 @@ GST_STATIC_PAD_TEMPLATE ("src",
 /* class initialization */
 
 #define gst_checksum_sink_parent_class parent_class
-G_DEFINE_TYPE (GstChecksumSink, gst_checksum_sink, GST_TYPE_BASE_SINK);
+G_DEFINE_TYPE_WITH_CODE (GstChecksumSink, gst_checksum_sink,
+    GST_TYPE_BASE_SINK,
+    GST_DEBUG_CATEGORY_INIT (gst_checksum_sink_debug, "checksumsink", 0,
+        "debug category for checksumsink element"));
 
 static void
 gst_checksum_sink_class_init (GstChecksumSinkClass * klass)
@@ -57,12 +137,38 @@ gst_checksum_sink_class_init (GstChecksumSinkClass * klass)
   GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
   GstBaseSinkClass *base_sink_class = GST_BASE_SINK_CLASS (klass);
 
+  gobject_class->set_property = gst_checksum_sink_set_property;
+  gobject_class->get_property = gst_checksum_sink_get_property;
   gobject_class->dispose = gst_checksum_sink_dispose;
   gobject_class->finalize = gst_checksum_sink_finalize;
   base_sink_class->start = GST_DEBUG_FUNCPTR (gst_checksum_sink_start);
   base_sink_class->stop = GST_DEBUG_FUNCPTR (gst_checksum_sink_stop);
+  base_sink_class->unlock = GST_DEBUG_FUNCPTR (gst_checksum_sink_unlock);
+  base_sink_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_checksum_sink_unlock_stop);
+  base_sink_class->set_caps = GST_DEBUG_FUNCPTR (gst_checksum_sink_set_caps);
+  base_sink_class->event = GST_DEBUG_FUNCPTR (gst_checksum_sink_event);
   base_sink_class->render = GST_DEBUG_FUNCPTR (gst_checksum_sink_render);
 
+  g_object_class_install_property (gobject_class, PROP_HASH,
+      g_param_spec_enum ("hash", "Hash", "Checksum algorithm to use",
+          GST_TYPE_CHECKSUM_SINK_HASH, DEFAULT_HASH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_PLANE_CHECKSUMS,
+      g_param_spec_boolean ("plane-checksums", "Plane checksums",
+          "For raw video, hash only the visible bytes of each plane and "
+          "output one checksum per plane", DEFAULT_PLANE_CHECKSUMS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_LOCATION,
+      g_param_spec_string ("location", "Location",
+          "CSV file to write the checksums to instead of printing them",
+          DEFAULT_LOCATION, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_MAX_PENDING,
+      g_param_spec_uint ("max-pending", "Max pending",
+          "Maximum number of buffers queued for the hashing thread "
+          "(0 = hash in the streaming thread)", 0, G_MAXUINT,
+          DEFAULT_MAX_PENDING, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&gst_checksum_sink_src_template));
   gst_element_class_add_pad_template (element_class,
@@ -77,6 +183,70 @@ static void
 gst_checksum_sink_init (GstChecksumSink * checksumsink)
 {
   gst_base_sink_set_sync (GST_BASE_SINK (checksumsink), FALSE);
+
+  checksumsink->hash = DEFAULT_HASH;
+  checksumsink->plane_checksums = DEFAULT_PLANE_CHECKSUMS;
+  checksumsink->location = g_strdup (DEFAULT_LOCATION);
+  checksumsink->max_pending = DEFAULT_MAX_PENDING;
+
+  g_mutex_init (&checksumsink->lock);
+  g_cond_init (&checksumsink->cond);
+  g_queue_init (&checksumsink->pending);
+}
+
+static void
+gst_checksum_sink_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (object);
+
+  GST_OBJECT_LOCK (checksumsink);
+  switch (property_id) {
+    case PROP_HASH:
+      checksumsink->hash = g_value_get_enum (value);
+      break;
+    case PROP_PLANE_CHECKSUMS:
+      checksumsink->plane_checksums = g_value_get_boolean (value);
+      break;
+    case PROP_LOCATION:
+      g_free (checksumsink->location);
+      checksumsink->location = g_value_dup_string (value);
+      break;
+    case PROP_MAX_PENDING:
+      checksumsink->max_pending = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (checksumsink);
+}
+
+static void
+gst_checksum_sink_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (object);
+
+  GST_OBJECT_LOCK (checksumsink);
+  switch (property_id) {
+    case PROP_HASH:
+      g_value_set_enum (value, checksumsink->hash);
+      break;
+    case PROP_PLANE_CHECKSUMS:
+      g_value_set_boolean (value, checksumsink->plane_checksums);
+      break;
+    case PROP_LOCATION:
+      g_value_set_string (value, checksumsink->location);
+      break;
+    case PROP_MAX_PENDING:
+      g_value_set_uint (value, checksumsink->max_pending);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (checksumsink);
 }
 
 void
@@ -88,34 +258,567 @@ gst_checksum_sink_dispose (GObject * object)
 void
 gst_checksum_sink_finalize (GObject * object)
 {
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (object);
+
+  g_free (checksumsink->location);
+  g_mutex_clear (&checksumsink->lock);
+  g_cond_clear (&checksumsink->cond);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+/* hashing */
+
+/* CRC-32C (Castagnoli), slicing-by-8 */
+static guint32 crc32c_table[8][256];
+
+static gpointer
+crc32c_init_table (gpointer data)
+{
+  guint32 crc;
+  gint i, j;
+
+  for (i = 0; i < 256; i++) {
+    crc = i;
+    for (j = 0; j < 8; j++)
+      crc = (crc >> 1) ^ ((crc & 1) ? 0x82f63b78 : 0);
+    crc32c_table[0][i] = crc;
+  }
+  for (i = 0; i < 256; i++) {
+    crc = crc32c_table[0][i];
+    for (j = 1; j < 8; j++) {
+      crc = crc32c_table[0][crc & 0xff] ^ (crc >> 8);
+      crc32c_table[j][i] = crc;
+    }
+  }
+
+  return NULL;
+}
+
+static guint32
+crc32c_update (guint32 crc, const guint8 * p, gsize len)
+{
+  while (len >= 8) {
+    guint32 lo = crc ^ GST_READ_UINT32_LE (p);
+    guint32 hi = GST_READ_UINT32_LE (p + 4);
+
+    crc = crc32c_table[7][lo & 0xff] ^ crc32c_table[6][(lo >> 8) & 0xff] ^
+        crc32c_table[5][(lo >> 16) & 0xff] ^ crc32c_table[4][lo >> 24] ^
+        crc32c_table[3][hi & 0xff] ^ crc32c_table[2][(hi >> 8) & 0xff] ^
+        crc32c_table[1][(hi >> 16) & 0xff] ^ crc32c_table[0][hi >> 24];
+    p += 8;
+    len -= 8;
+  }
+  while (len--)
+    crc = crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+
+  return crc;
+}
+
+/* xxHash32 with seed 0 */
+#define XXH_PRIME32_1 2654435761U
+#define XXH_PRIME32_2 2246822519U
+#define XXH_PRIME32_3 3266489917U
+#define XXH_PRIME32_4 668265263U
+#define XXH_PRIME32_5 374761393U
+#define XXH_ROTL32(x,r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+typedef struct
+{
+  guint32 v[4];
+  guint64 total_len;
+  guint8 mem[16];
+  guint mem_size;
+} Xxh32State;
+
+static inline guint32
+xxh32_round (guint32 acc, guint32 input)
+{
+  acc += input * XXH_PRIME32_2;
+  acc = XXH_ROTL32 (acc, 13);
+  return acc * XXH_PRIME32_1;
+}
+
+static void
+xxh32_reset (Xxh32State * state)
+{
+  state->v[0] = XXH_PRIME32_1 + XXH_PRIME32_2;
+  state->v[1] = XXH_PRIME32_2;
+  state->v[2] = 0;
+  state->v[3] = -XXH_PRIME32_1;
+  state->total_len = 0;
+  state->mem_size = 0;
+}
+
+static void
+xxh32_stripe (Xxh32State * state, const guint8 * p)
+{
+  state->v[0] = xxh32_round (state->v[0], GST_READ_UINT32_LE (p));
+  state->v[1] = xxh32_round (state->v[1], GST_READ_UINT32_LE (p + 4));
+  state->v[2] = xxh32_round (state->v[2], GST_READ_UINT32_LE (p + 8));
+  state->v[3] = xxh32_round (state->v[3], GST_READ_UINT32_LE (p + 12));
+}
+
+static void
+xxh32_update (Xxh32State * state, const guint8 * p, gsize len)
+{
+  const guint8 *end = p + len;
+
+  state->total_len += len;
+
+  if (state->mem_size + len < 16) {
+    memcpy (state->mem + state->mem_size, p, len);
+    state->mem_size += len;
+    return;
+  }
+
+  if (state->mem_size) {
+    guint fill = 16 - state->mem_size;
+
+    memcpy (state->mem + state->mem_size, p, fill);
+    xxh32_stripe (state, state->mem);
+    p += fill;
+    state->mem_size = 0;
+  }
+
+  while (p + 16 <= end) {
+    xxh32_stripe (state, p);
+    p += 16;
+  }
+
+  if (p < end) {
+    memcpy (state->mem, p, end - p);
+    state->mem_size = end - p;
+  }
+}
+
+static guint32
+xxh32_digest (Xxh32State * state)
+{
+  const guint8 *p = state->mem;
+  const guint8 *end = p + state->mem_size;
+  guint32 h;
+
+  if (state->total_len >= 16)
+    h = XXH_ROTL32 (state->v[0], 1) + XXH_ROTL32 (state->v[1], 7) +
+        XXH_ROTL32 (state->v[2], 12) + XXH_ROTL32 (state->v[3], 18);
+  else
+    h = XXH_PRIME32_5;
+
+  h += (guint32) state->total_len;
+
+  while (p + 4 <= end) {
+    h += GST_READ_UINT32_LE (p) * XXH_PRIME32_3;
+    h = XXH_ROTL32 (h, 17) * XXH_PRIME32_4;
+    p += 4;
+  }
+  while (p < end) {
+    h += (*p++) * XXH_PRIME32_5;
+    h = XXH_ROTL32 (h, 11) * XXH_PRIME32_1;
+  }
+
+  h ^= h >> 15;
+  h *= XXH_PRIME32_2;
+  h ^= h >> 13;
+  h *= XXH_PRIME32_3;
+  h ^= h >> 16;
+
+  return h;
+}
+
+typedef struct
+{
+  GstChecksumSinkHash type;
+  GChecksum *checksum;
+  guint32 crc;
+  Xxh32State xxh;
+} Hasher;
+
+static void
+hasher_init (Hasher * hasher, GstChecksumSinkHash type)
+{
+  static GOnce crc32c_once = G_ONCE_INIT;
+
+  hasher->type = type;
+  hasher->checksum = NULL;
+
+  switch (type) {
+    case GST_CHECKSUM_SINK_HASH_MD5:
+      hasher->checksum = g_checksum_new (G_CHECKSUM_MD5);
+      break;
+    case GST_CHECKSUM_SINK_HASH_SHA1:
+      hasher->checksum = g_checksum_new (G_CHECKSUM_SHA1);
+      break;
+    case GST_CHECKSUM_SINK_HASH_SHA256:
+      hasher->checksum = g_checksum_new (G_CHECKSUM_SHA256);
+      break;
+    case GST_CHECKSUM_SINK_HASH_CRC32C:
+      g_once (&crc32c_once, crc32c_init_table, NULL);
+      hasher->crc = 0xffffffff;
+      break;
+    case GST_CHECKSUM_SINK_HASH_XXHASH32:
+      xxh32_reset (&hasher->xxh);
+      break;
+  }
+}
+
+static void
+hasher_update (Hasher * hasher, const guint8 * data, gsize size)
+{
+  switch (hasher->type) {
+    case GST_CHECKSUM_SINK_HASH_CRC32C:
+      hasher->crc = crc32c_update (hasher->crc, data, size);
+      break;
+    case GST_CHECKSUM_SINK_HASH_XXHASH32:
+      xxh32_update (&hasher->xxh, data, size);
+      break;
+    default:
+      g_checksum_update (hasher->checksum, data, size);
+      break;
+  }
+}
+
+/* returns the hex string and frees the hasher's resources */
+static gchar *
+hasher_finish (Hasher * hasher)
+{
+  gchar *s;
+
+  switch (hasher->type) {
+    case GST_CHECKSUM_SINK_HASH_CRC32C:
+      s = g_strdup_printf ("%08x", hasher->crc ^ 0xffffffff);
+      break;
+    case GST_CHECKSUM_SINK_HASH_XXHASH32:
+      s = g_strdup_printf ("%08x", xxh32_digest (&hasher->xxh));
+      break;
+    default:
+      s = g_strdup (g_checksum_get_string (hasher->checksum));
+      g_checksum_free (hasher->checksum);
+      hasher->checksum = NULL;
+      break;
+  }
+
+  return s;
+}
+
+/* one queued buffer, with the settings that were current when it was
+ * rendered */
+typedef struct
+{
+  GstBuffer *buffer;
+  guint64 frame;
+  GstChecksumSinkHash hash;
+  gboolean use_planes;
+  GstVideoInfo vinfo;
+} ChecksumJob;
+
+static void
+gst_checksum_sink_output (GstChecksumSink * checksumsink, ChecksumJob * job,
+    gint plane, const gchar * s)
+{
+  GstClockTime pts = GST_BUFFER_PTS (job->buffer);
+
+  if (checksumsink->file) {
+    fprintf (checksumsink->file,
+        "%" G_GUINT64_FORMAT ",%" G_GINT64_FORMAT ",%d,%s\n", job->frame,
+        GST_CLOCK_TIME_IS_VALID (pts) ? (gint64) pts : (gint64) - 1, plane, s);
+  } else if (plane <= 0) {
+    g_print ("%" GST_TIME_FORMAT " %s", GST_TIME_ARGS (pts), s);
+  } else {
+    g_print (" %s", s);
+  }
+}
+
+static void
+gst_checksum_sink_process (GstChecksumSink * checksumsink, ChecksumJob * job)
+{
+  Hasher hasher;
+  gchar *s;
+
+  if (job->use_planes) {
+    GstVideoFrame frame;
+    guint i, j;
+
+    if (!gst_video_frame_map (&frame, &job->vinfo, job->buffer, GST_MAP_READ)) {
+      GST_WARNING_OBJECT (checksumsink, "could not map video frame %"
+          G_GUINT64_FORMAT, job->frame);
+      return;
+    }
+
+    for (i = 0; i < GST_VIDEO_FRAME_N_PLANES (&frame); i++) {
+      const guint8 *line = GST_VIDEO_FRAME_PLANE_DATA (&frame, i);
+      gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (&frame, i);
+      guint comp, width, height;
+
+      /* the plane size is that of the first component stored in it,
+       * times the pixel stride to get bytes for packed formats */
+      for (comp = 0; comp < GST_VIDEO_FRAME_N_COMPONENTS (&frame); comp++) {
+        if (GST_VIDEO_FRAME_COMP_PLANE (&frame, comp) == i)
+          break;
+      }
+      width = GST_VIDEO_FRAME_COMP_WIDTH (&frame, comp) *
+          GST_VIDEO_FRAME_COMP_PSTRIDE (&frame, comp);
+      height = GST_VIDEO_FRAME_COMP_HEIGHT (&frame, comp);
+      /* complex packings like v210 have no pixel stride, hash whole
+       * lines for those */
+      if (width == 0)
+        width = ABS (stride);
+
+      hasher_init (&hasher, job->hash);
+      for (j = 0; j < height; j++) {
+        hasher_update (&hasher, line, width);
+        line += stride;
+      }
+      s = hasher_finish (&hasher);
+      gst_checksum_sink_output (checksumsink, job, i, s);
+      g_free (s);
+    }
+
+    gst_video_frame_unmap (&frame);
+  } else {
+    GstMapInfo map;
+
+    if (!gst_buffer_map (job->buffer, &map, GST_MAP_READ)) {
+      GST_WARNING_OBJECT (checksumsink, "could not map buffer %"
+          G_GUINT64_FORMAT, job->frame);
+      return;
+    }
+    hasher_init (&hasher, job->hash);
+    hasher_update (&hasher, map.data, map.size);
+    gst_buffer_unmap (job->buffer, &map);
+
+    s = hasher_finish (&hasher);
+    gst_checksum_sink_output (checksumsink, job, -1, s);
+    g_free (s);
+  }
+
+  if (!checksumsink->file)
+    g_print ("\n");
+}
+
+static void
+checksum_job_free (ChecksumJob * job)
+{
+  gst_buffer_unref (job->buffer);
+  g_slice_free (ChecksumJob, job);
+}
+
+static gpointer
+gst_checksum_sink_thread (gpointer user_data)
+{
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (user_data);
+  ChecksumJob *job;
+
+  GST_DEBUG_OBJECT (checksumsink, "thread starting");
+
+  g_mutex_lock (&checksumsink->lock);
+  while (TRUE) {
+    while (g_queue_is_empty (&checksumsink->pending) &&
+        !checksumsink->stopping)
+      g_cond_wait (&checksumsink->cond, &checksumsink->lock);
+
+    /* pending buffers are still hashed when stopping */
+    job = g_queue_pop_head (&checksumsink->pending);
+    if (!job)
+      break;
+
+    checksumsink->busy = TRUE;
+    g_cond_broadcast (&checksumsink->cond);
+    g_mutex_unlock (&checksumsink->lock);
+
+    gst_checksum_sink_process (checksumsink, job);
+    checksum_job_free (job);
+
+    g_mutex_lock (&checksumsink->lock);
+    checksumsink->busy = FALSE;
+    g_cond_broadcast (&checksumsink->cond);
+  }
+  g_mutex_unlock (&checksumsink->lock);
+
+  GST_DEBUG_OBJECT (checksumsink, "thread exiting");
+
+  return NULL;
+}
+
+/* wait until the worker thread has hashed everything queued so far,
+ * returns FALSE if unlock() interrupted the wait */
+static gboolean
+gst_checksum_sink_drain (GstChecksumSink * checksumsink)
+{
+  gboolean flushing;
+
+  g_mutex_lock (&checksumsink->lock);
+  while ((!g_queue_is_empty (&checksumsink->pending) || checksumsink->busy)
+      && !checksumsink->flushing)
+    g_cond_wait (&checksumsink->cond, &checksumsink->lock);
+  flushing = checksumsink->flushing;
+  g_mutex_unlock (&checksumsink->lock);
+
+  if (checksumsink->file)
+    fflush (checksumsink->file);
+
+  return !flushing;
+}
+
 static gboolean
 gst_checksum_sink_start (GstBaseSink * sink)
 {
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (sink);
+  gchar *location;
+
+  GST_OBJECT_LOCK (checksumsink);
+  location = g_strdup (checksumsink->location);
+  GST_OBJECT_UNLOCK (checksumsink);
+
+  if (location && location[0] != '\0') {
+    checksumsink->file = fopen (location, "w");
+    if (!checksumsink->file) {
+      GST_ELEMENT_ERROR (checksumsink, RESOURCE, OPEN_WRITE,
+          ("Could not open file \"%s\" for writing.", location),
+          GST_ERROR_SYSTEM);
+      g_free (location);
+      return FALSE;
+    }
+    fprintf (checksumsink->file, "frame,pts,plane,checksum\n");
+  }
+  g_free (location);
+
+  checksumsink->n_frames = 0;
+  checksumsink->is_video = FALSE;
+  checksumsink->stopping = FALSE;
+  checksumsink->busy = FALSE;
+  checksumsink->flushing = FALSE;
+  checksumsink->thread = g_thread_new ("checksumsink",
+      gst_checksum_sink_thread, checksumsink);
+
   return TRUE;
 }
 
 static gboolean
 gst_checksum_sink_stop (GstBaseSink * sink)
 {
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (sink);
+
+  if (checksumsink->thread) {
+    g_mutex_lock (&checksumsink->lock);
+    checksumsink->stopping = TRUE;
+    g_cond_broadcast (&checksumsink->cond);
+    g_mutex_unlock (&checksumsink->lock);
+
+    g_thread_join (checksumsink->thread);
+    checksumsink->thread = NULL;
+  }
+
+  if (checksumsink->file) {
+    fclose (checksumsink->file);
+    checksumsink->file = NULL;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_checksum_sink_unlock (GstBaseSink * sink)
+{
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (sink);
+
+  g_mutex_lock (&checksumsink->lock);
+  checksumsink->flushing = TRUE;
+  g_cond_broadcast (&checksumsink->cond);
+  g_mutex_unlock (&checksumsink->lock);
+
   return TRUE;
 }
 
+static gboolean
+gst_checksum_sink_unlock_stop (GstBaseSink * sink)
+{
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (sink);
+
+  g_mutex_lock (&checksumsink->lock);
+  checksumsink->flushing = FALSE;
+  g_mutex_unlock (&checksumsink->lock);
+
+  return TRUE;
+}
+
+static gboolean
+gst_checksum_sink_set_caps (GstBaseSink * sink, GstCaps * caps)
+{
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (sink);
+  GstStructure *s = gst_caps_get_structure (caps, 0);
+
+  checksumsink->is_video = gst_structure_has_name (s, "video/x-raw") &&
+      gst_video_info_from_caps (&checksumsink->vinfo, caps);
+
+  GST_DEBUG_OBJECT (checksumsink, "caps %" GST_PTR_FORMAT ", raw video: %d",
+      caps, checksumsink->is_video);
+
+  return TRUE;
+}
+
+static gboolean
+gst_checksum_sink_event (GstBaseSink * sink, GstEvent * event)
+{
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (sink);
+
+  /* all checksums must be out before EOS is posted */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS)
+    gst_checksum_sink_drain (checksumsink);
+
+  return GST_BASE_SINK_CLASS (parent_class)->event (sink, event);
+}
+
 static GstFlowReturn
 gst_checksum_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 {
-  gchar *s;
-  GstMapInfo map;
+  GstChecksumSink *checksumsink = GST_CHECKSUM_SINK (sink);
+  ChecksumJob *job;
+  guint max_pending;
+
+  job = g_slice_new (ChecksumJob);
+  job->buffer = gst_buffer_ref (buffer);
+  job->frame = checksumsink->n_frames++;
+
+  GST_OBJECT_LOCK (checksumsink);
+  job->hash = checksumsink->hash;
+  job->use_planes = checksumsink->plane_checksums && checksumsink->is_video;
+  max_pending = checksumsink->max_pending;
+  GST_OBJECT_UNLOCK (checksumsink);
 
-  gst_buffer_map (buffer, &map, GST_MAP_READ);
-  s = g_compute_checksum_for_data (G_CHECKSUM_SHA1, map.data, map.size);
-  gst_buffer_unmap (buffer, &map);
-  g_print ("%" GST_TIME_FORMAT " %s\n",
-      GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (buffer)), s);
+  if (job->use_planes)
+    job->vinfo = checksumsink->vinfo;
 
-  g_free (s);
+  if (max_pending == 0) {
+    /* keep the order with anything still queued from before */
+    if (!gst_checksum_sink_drain (checksumsink))
+      goto flushing;
+    gst_checksum_sink_process (checksumsink, job);
+    checksum_job_free (job);
+    return GST_FLOW_OK;
+  }
+
+  g_mutex_lock (&checksumsink->lock);
+  while (g_queue_get_length (&checksumsink->pending) >= max_pending &&
+      !checksumsink->flushing)
+    g_cond_wait (&checksumsink->cond, &checksumsink->lock);
+  if (checksumsink->flushing) {
+    g_mutex_unlock (&checksumsink->lock);
+    goto flushing;
+  }
+  g_queue_push_tail (&checksumsink->pending, job);
+  g_cond_broadcast (&checksumsink->cond);
+  g_mutex_unlock (&checksumsink->lock);
 
   return GST_FLOW_OK;
+
+flushing:
+  {
+    GST_DEBUG_OBJECT (checksumsink, "flushing, dropping frame %"
+        G_GUINT64_FORMAT, job->frame);
+    /* the dropped buffer doesn't take a frame number */
+    checksumsink->n_frames--;
+    checksum_job_free (job);
+    return GST_FLOW_FLUSHING;
+  }
 }
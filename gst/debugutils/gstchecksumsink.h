@@ -20,8 +20,11 @@
 #ifndef _GST_CHECKSUM_SINK_H_
 #define _GST_CHECKSUM_SINK_H_
 
+#include <stdio.h>
+
 #include <gst/gst.h>
 #include <gst/base/gstbasesink.h>
+#include <gst/video/video.h>
 
 G_BEGIN_DECLS
 
@@ -34,10 +37,40 @@ G_BEGIN_DECLS
 typedef struct _GstChecksumSink GstChecksumSink;
 typedef struct _GstChecksumSinkClass GstChecksumSinkClass;
 
+typedef enum {
+  GST_CHECKSUM_SINK_HASH_MD5,
+  GST_CHECKSUM_SINK_HASH_SHA1,
+  GST_CHECKSUM_SINK_HASH_SHA256,
+  GST_CHECKSUM_SINK_HASH_CRC32C,
+  GST_CHECKSUM_SINK_HASH_XXHASH32
+} GstChecksumSinkHash;
+
 struct _GstChecksumSink
 {
   GstBaseSink base_checksumsink;
 
+  /* properties */
+  GstChecksumSinkHash hash;
+  gboolean plane_checksums;
+  gchar *location;
+  guint max_pending;
+
+  /* set from the caps, plane_checksums only applies to raw video */
+  gboolean is_video;
+  GstVideoInfo vinfo;
+
+  FILE *file;
+  guint64 n_frames;
+
+  /* worker thread, hashes the buffers queued in pending */
+  GThread *thread;
+  GMutex lock;
+  GCond cond;
+  GQueue pending;
+  gboolean busy;
+  gboolean stopping;
+  /* set by unlock() to release render() waiting for room in pending */
+  gboolean flushing;
 };
 
 struct _GstChecksumSinkClass
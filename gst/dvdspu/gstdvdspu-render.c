@@ -21,8 +21,6 @@
 #  include <config.h>
 #endif
 
-#include <string.h>
-
 #include <gst/gst.h>
 
 #include "gstdvdspu.h"
@@ -30,70 +28,18 @@
 GST_DEBUG_CATEGORY_EXTERN (dvdspu_debug);
 #define GST_CAT_DEFAULT dvdspu_debug
 
+/* Write @len pixels of @colour into an AYUV overlay canvas at @out. The
+ * palettes are pre-multiplied, the overlay rectangles are not, so @colour
+ * must not be fully transparent */
 void
-gstspu_clear_comp_buffers (SpuState * state)
+gstspu_draw_run (guint8 * out, gint len, const SpuColour * colour)
 {
-  /* The area to clear is the line inside the disp_rect, each entry 4 bytes,
-   * of the sub-sampled UV planes. */
-  gint16 left = state->comp_left / 2;
-  gint16 right = state->comp_right / 2;
-  gint16 uv_width = sizeof (guint32) * (right - left + 1);
-
-  memset (state->comp_bufs[0] + left, 0, uv_width);
-  memset (state->comp_bufs[1] + left, 0, uv_width);
-  memset (state->comp_bufs[2] + left, 0, uv_width);
-}
-
-void
-gstspu_blend_comp_buffers (SpuState * state, guint8 * planes[3])
-{
-  gint16 uv_end;
-  gint16 left, x;
-  guint8 *out_U;
-  guint8 *out_V;
-  guint32 *in_U;
-  guint32 *in_V;
-  guint32 *in_A;
-  gint16 comp_last_x = state->comp_right;
-
-  if (comp_last_x < state->comp_left)
-    return;                     /* Didn't draw in the comp buffers, nothing to do... */
-
-#if 0
-  GST_LOG ("Blending comp buffers from x=%d to x=%d",
-      state->comp_left, state->comp_right);
-#endif
-
-  /* Set up the output pointers */
-  out_U = planes[1];            /* U plane */
-  out_V = planes[2];            /* V plane */
-
-  /* Input starts at the first pixel of the compositing buffer */
-  in_U = state->comp_bufs[0];   /* U comp buffer */
-  in_V = state->comp_bufs[1];   /* V comp buffer */
-  in_A = state->comp_bufs[2];   /* A comp buffer */
-
-  /* Calculate how many pixels to blend based on the maximum X value that was 
-   * drawn in the render_line function, divided by 2 (rounding up) to account 
-   * for UV sub-sampling */
-  uv_end = (comp_last_x + 1) / 2;
-  left = state->comp_left / 2;
-
-  out_U += left * GST_VIDEO_INFO_COMP_PSTRIDE (&state->info, 1);
-  out_V += left * GST_VIDEO_INFO_COMP_PSTRIDE (&state->info, 2);
-  for (x = left; x < uv_end; x++) {
-    guint32 tmp;
-    /* Each entry in the compositing buffer is 4 summed pixels, so the
-     * inverse alpha is (4 * 0xff) - in_A[x] */
-    guint16 inv_A = (4 * 0xff) - in_A[x];
-
-    tmp = in_U[x] + inv_A * *out_U;
-    *out_U = (guint8) (tmp / (4 * 0xff));
+  guint32 ayuv;
+  gint i;
 
-    tmp = in_V[x] + inv_A * *out_V;
-    *out_V = (guint8) (tmp / (4 * 0xff));
+  ayuv = (colour->A << 24) | ((colour->Y / colour->A) << 16) |
+      ((colour->U / colour->A) << 8) | (colour->V / colour->A);
 
-    out_U += GST_VIDEO_INFO_COMP_PSTRIDE (&state->info, 1);
-    out_V += GST_VIDEO_INFO_COMP_PSTRIDE (&state->info, 2);
-  }
+  for (i = 0; i < len; i++, out += 4)
+    GST_WRITE_UINT32_BE (out, ayuv);
 }
@@ -20,6 +20,10 @@
  * SECTION:element-dvdspu
  *
  * DVD sub picture overlay element.
+ *
+ * Each display set is rendered once and reused until the sub-picture state
+ * changes. When downstream supports it, it is attached to the video buffers
+ * as a #GstVideoOverlayCompositionMeta, otherwise it is blended onto them.
  * 
  * <refsect2>
  * <title>Example launch line</title>
@@ -65,6 +69,9 @@ static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("video/x-raw, " "format = (string) { I420, NV12, YV12 }, "
+        "width = (int) [ 16, 4096 ], " "height = (int) [ 16, 4096 ]; "
+        "video/x-raw(" GST_CAPS_FEATURE_META_GST_VIDEO_OVERLAY_COMPOSITION "), "
+        "format = (string) { I420, NV12, YV12 }, "
         "width = (int) [ 16, 4096 ], " "height = (int) [ 16, 4096 ]")
     );
 
@@ -91,6 +98,7 @@ static gboolean gst_dvd_spu_src_query (GstPad * pad, GstObject * parent,
 static GstCaps *gst_dvd_spu_video_proxy_getcaps (GstPad * pad,
     GstCaps * filter);
 static gboolean gst_dvd_spu_video_set_caps (GstPad * pad, GstCaps * caps);
+static gboolean gst_dvd_spu_negotiate (GstDVDSpu * dvdspu, GstCaps * caps);
 static GstFlowReturn gst_dvd_spu_video_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buf);
 static gboolean gst_dvd_spu_video_event (GstPad * pad, GstObject * parent,
@@ -111,6 +119,7 @@ static void gst_dvd_spu_flush_spu_info (GstDVDSpu * dvdspu,
     gboolean process_events);
 static void gst_dvd_spu_advance_spu (GstDVDSpu * dvdspu, GstClockTime new_ts);
 static void gstspu_render (GstDVDSpu * dvdspu, GstBuffer * buf);
+static void gst_dvd_spu_reset_composition (GstDVDSpu * dvdspu);
 static GstFlowReturn
 dvdspu_handle_vid_buffer (GstDVDSpu * dvdspu, GstBuffer * buf);
 static void gst_dvd_spu_handle_dvd_event (GstDVDSpu * dvdspu, GstEvent * event);
@@ -207,14 +216,7 @@ static void
 gst_dvd_spu_finalize (GObject * object)
 {
   GstDVDSpu *dvdspu = GST_DVD_SPU (object);
-  gint i;
 
-  for (i = 0; i < 3; i++) {
-    if (dvdspu->spu_state.comp_bufs[i] != NULL) {
-      g_free (dvdspu->spu_state.comp_bufs[i]);
-      dvdspu->spu_state.comp_bufs[i] = NULL;
-    }
-  }
   g_queue_free (dvdspu->pending_spus);
   g_mutex_clear (&dvdspu->spu_lock);
 
@@ -260,6 +262,8 @@ gst_dvd_spu_flush_spu_info (GstDVDSpu * dvdspu, gboolean keep_events)
   state->flags &= ~(SPU_STATE_FLAGS_MASK);
   state->next_ts = GST_CLOCK_TIME_NONE;
 
+  gst_dvd_spu_reset_composition (dvdspu);
+
   switch (dvdspu->spu_input_type) {
     case SPU_INPUT_TYPE_VOBSUB:
       gstspu_vobsub_flush (dvdspu);
@@ -320,7 +324,6 @@ gst_dvd_spu_video_set_caps (GstPad * pad, GstCaps * caps)
   GstDVDSpu *dvdspu = GST_DVD_SPU (gst_pad_get_parent (pad));
   gboolean res = FALSE;
   GstVideoInfo info;
-  gint i;
   SpuState *state;
 
   if (!gst_video_info_from_caps (&info, caps))
@@ -331,10 +334,8 @@ gst_dvd_spu_video_set_caps (GstPad * pad, GstCaps * caps)
   state = &dvdspu->spu_state;
 
   state->info = info;
-  for (i = 0; i < 3; i++) {
-    state->comp_bufs[i] = g_realloc (state->comp_bufs[i],
-        sizeof (guint32) * info.width);
-  }
+  /* The display set is placed and clipped for the video size */
+  gst_dvd_spu_reset_composition (dvdspu);
   DVD_SPU_UNLOCK (dvdspu);
 
   res = TRUE;
@@ -343,6 +344,80 @@ done:
   return res;
 }
 
+/* Output the video caps with the overlay composition meta if downstream
+ * can take it, so it can composite the overlay itself */
+static gboolean
+gst_dvd_spu_negotiate (GstDVDSpu * dvdspu, GstCaps * caps)
+{
+  GstCaps *overlay_caps, *peercaps;
+  GstCapsFeatures *f;
+  gboolean caps_has_meta;
+  gboolean attach = FALSE;
+  gboolean ret;
+
+  GST_DEBUG_OBJECT (dvdspu, "performing negotiation");
+
+  if (!caps) {
+    caps = gst_pad_get_current_caps (dvdspu->videosinkpad);
+  } else {
+    gst_caps_ref (caps);
+  }
+
+  if (!caps || gst_caps_is_empty (caps))
+    goto no_format;
+
+  overlay_caps = gst_caps_copy (caps);
+  f = gst_caps_get_features (overlay_caps, 0);
+  gst_caps_features_add (f,
+      GST_CAPS_FEATURE_META_GST_VIDEO_OVERLAY_COMPOSITION);
+
+  peercaps = gst_pad_peer_query_caps (dvdspu->srcpad, NULL);
+  caps_has_meta = gst_caps_can_intersect (peercaps, overlay_caps);
+  gst_caps_unref (peercaps);
+
+  GST_DEBUG_OBJECT (dvdspu, "Downstream accepts the overlay meta: %d",
+      caps_has_meta);
+  if (caps_has_meta) {
+    gst_caps_unref (caps);
+    caps = overlay_caps;
+  } else {
+    gst_caps_unref (overlay_caps);
+  }
+
+  GST_DEBUG_OBJECT (dvdspu, "Using caps %" GST_PTR_FORMAT, caps);
+  ret = gst_pad_set_caps (dvdspu->srcpad, caps);
+
+  if (ret && caps_has_meta) {
+    GstQuery *query;
+
+    /* find supported meta */
+    query = gst_query_new_allocation (caps, FALSE);
+
+    if (!gst_pad_peer_query (dvdspu->srcpad, query)) {
+      /* no problem, we use the query defaults */
+      GST_DEBUG_OBJECT (dvdspu, "ALLOCATION query failed");
+    }
+
+    attach = gst_query_find_allocation_meta (query,
+        GST_VIDEO_OVERLAY_COMPOSITION_META_API_TYPE, NULL);
+    gst_query_unref (query);
+  }
+  gst_caps_unref (caps);
+
+  DVD_SPU_LOCK (dvdspu);
+  dvdspu->attach_compo_to_buffer = attach;
+  DVD_SPU_UNLOCK (dvdspu);
+
+  return ret;
+
+no_format:
+  {
+    if (caps)
+      gst_caps_unref (caps);
+    return FALSE;
+  }
+}
+
 static GstCaps *
 gst_dvd_spu_video_proxy_getcaps (GstPad * pad, GstCaps * filter)
 {
@@ -358,7 +433,8 @@ gst_dvd_spu_video_proxy_getcaps (GstPad * pad, GstCaps * filter)
   if (caps) {
     GstCaps *temp, *templ;
 
-    templ = gst_pad_get_pad_template_caps (otherpad);
+    /* Only the srcpad can add the overlay composition meta */
+    templ = gst_pad_get_pad_template_caps (pad);
     temp = gst_caps_intersect (caps, templ);
     gst_caps_unref (templ);
     gst_caps_unref (caps);
@@ -407,9 +483,8 @@ gst_dvd_spu_video_event (GstPad * pad, GstObject * parent, GstEvent * event)
       gst_event_parse_caps (event, &caps);
       res = gst_dvd_spu_video_set_caps (pad, caps);
       if (res)
-        res = gst_pad_push_event (dvdspu->srcpad, event);
-      else
-        gst_event_unref (event);
+        res = gst_dvd_spu_negotiate (dvdspu, caps);
+      gst_event_unref (event);
       break;
     }
     case GST_EVENT_CUSTOM_DOWNSTREAM:
@@ -558,6 +633,9 @@ gst_dvd_spu_video_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   GST_LOG_OBJECT (dvdspu, "video buffer %p with TS %" GST_TIME_FORMAT,
       buf, GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (buf)));
 
+  if (gst_pad_check_reconfigure (dvdspu->srcpad))
+    gst_dvd_spu_negotiate (dvdspu, NULL);
+
   ret = dvdspu_handle_vid_buffer (dvdspu, buf);
 
   return ret;
@@ -660,24 +738,102 @@ no_ref_frame:
 }
 
 
-static void
-gstspu_render (GstDVDSpu * dvdspu, GstBuffer * buf)
+/* With SPU LOCK. Renders the current display set into a transparent AYUV
+ * canvas covering just the part of the video it draws on */
+static GstVideoOverlayComposition *
+gstspu_render_composition (GstDVDSpu * dvdspu)
 {
+  GstVideoOverlayComposition *composition;
+  GstVideoOverlayRectangle *rectangle;
+  GstVideoFormat format = GST_VIDEO_OVERLAY_COMPOSITION_FORMAT_YUV;
+  GstVideoInfo info;
   GstVideoFrame frame;
+  GstBuffer *canvas;
+  SpuRect rect;
+  gint width, height;
 
-  gst_video_frame_map (&frame, &dvdspu->spu_state.info, buf, GST_MAP_READWRITE);
+  switch (dvdspu->spu_input_type) {
+    case SPU_INPUT_TYPE_VOBSUB:
+      if (!gstspu_vobsub_get_render_rect (dvdspu, &rect))
+        return NULL;
+      break;
+    case SPU_INPUT_TYPE_PGS:
+      if (!gstspu_pgs_get_render_rect (dvdspu, &rect))
+        return NULL;
+      break;
+    default:
+      return NULL;
+  }
+
+  width = rect.right - rect.left + 1;
+  height = rect.bottom - rect.top + 1;
+
+  gst_video_info_set_format (&info, format, width, height);
+  canvas = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  gst_buffer_memset (canvas, 0, 0, GST_VIDEO_INFO_SIZE (&info));
+  gst_buffer_add_video_meta (canvas, GST_VIDEO_FRAME_FLAG_NONE, format,
+      width, height);
+
+  if (!gst_video_frame_map (&frame, &info, canvas, GST_MAP_WRITE)) {
+    gst_buffer_unref (canvas);
+    return NULL;
+  }
 
   switch (dvdspu->spu_input_type) {
     case SPU_INPUT_TYPE_VOBSUB:
-      gstspu_vobsub_render (dvdspu, &frame);
+      gstspu_vobsub_render (dvdspu, &frame, &rect);
       break;
     case SPU_INPUT_TYPE_PGS:
-      gstspu_pgs_render (dvdspu, &frame);
+      gstspu_pgs_render (dvdspu, &frame, &rect);
       break;
     default:
       break;
   }
   gst_video_frame_unmap (&frame);
+
+  GST_DEBUG_OBJECT (dvdspu, "Rendered %dx%d overlay at %d,%d", width, height,
+      rect.left, rect.top);
+
+  rectangle = gst_video_overlay_rectangle_new_raw (canvas, rect.left,
+      rect.top, width, height, GST_VIDEO_OVERLAY_FORMAT_FLAG_NONE);
+  composition = gst_video_overlay_composition_new (rectangle);
+  gst_video_overlay_rectangle_unref (rectangle);
+  gst_buffer_unref (canvas);
+
+  return composition;
+}
+
+/* With SPU LOCK. Drops the rendered display set, to be rendered again from
+ * the current SPU state for the next frame */
+static void
+gst_dvd_spu_reset_composition (GstDVDSpu * dvdspu)
+{
+  if (dvdspu->composition) {
+    gst_video_overlay_composition_unref (dvdspu->composition);
+    dvdspu->composition = NULL;
+  }
+}
+
+static void
+gstspu_render (GstDVDSpu * dvdspu, GstBuffer * buf)
+{
+  GstVideoFrame frame;
+
+  if (dvdspu->composition == NULL)
+    dvdspu->composition = gstspu_render_composition (dvdspu);
+
+  if (dvdspu->composition == NULL)
+    return;                     /* Nothing to draw */
+
+  if (dvdspu->attach_compo_to_buffer) {
+    GST_LOG_OBJECT (dvdspu, "Attaching overlay image to video buffer");
+    gst_buffer_add_video_overlay_composition_meta (buf, dvdspu->composition);
+  } else if (gst_video_frame_map (&frame, &dvdspu->spu_state.info, buf,
+          GST_MAP_READWRITE)) {
+    GST_LOG_OBJECT (dvdspu, "Blending overlay image to video buffer");
+    gst_video_overlay_composition_blend (dvdspu->composition, &frame);
+    gst_video_frame_unmap (&frame);
+  }
 }
 
 /* With SPU LOCK */
@@ -746,6 +902,9 @@ gst_dvd_spu_handle_dvd_event (GstDVDSpu * dvdspu, GstEvent * event)
       break;
   }
 
+  if (hl_change)
+    gst_dvd_spu_reset_composition (dvdspu);
+
   if (hl_change && (dvdspu->spu_state.flags & SPU_STATE_STILL_FRAME)) {
     gst_dvd_spu_redraw_still (dvdspu, FALSE);
   }
@@ -782,6 +941,10 @@ gst_dvd_spu_advance_spu (GstDVDSpu * dvdspu, GstClockTime new_ts)
         "Advancing SPU from TS %" GST_TIME_FORMAT " to %" GST_TIME_FORMAT,
         GST_TIME_ARGS (state->next_ts), GST_TIME_ARGS (new_ts));
 
+    /* A due event changes what is displayed */
+    if (state->next_ts != GST_CLOCK_TIME_NONE)
+      gst_dvd_spu_reset_composition (dvdspu);
+
     if (!gstspu_execute_event (dvdspu)) {
       /* No current command buffer, try and get one */
       SpuPacket *packet = (SpuPacket *) g_queue_pop_head (dvdspu->pending_spus);
@@ -789,6 +952,8 @@ gst_dvd_spu_advance_spu (GstDVDSpu * dvdspu, GstClockTime new_ts)
       if (packet == NULL)
         return;                 /* No SPU packets available */
 
+      gst_dvd_spu_reset_composition (dvdspu);
+
       GST_LOG_OBJECT (dvdspu,
           "Popped new SPU packet with TS %" GST_TIME_FORMAT
           ". Video position=%" GST_TIME_FORMAT " (%" GST_TIME_FORMAT
@@ -48,8 +48,7 @@ struct SpuColour {
   guint8 A;
 };
 
-void gstspu_clear_comp_buffers (SpuState * state);
-void gstspu_blend_comp_buffers (SpuState * state, guint8 * planes[3]);
+void gstspu_draw_run (guint8 * out, gint len, const SpuColour * colour);
 
 
 G_END_DECLS
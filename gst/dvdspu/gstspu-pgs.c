@@ -169,59 +169,67 @@ dump_rle_data (GstDVDSpu * dvdspu, guint8 * data, guint32 len)
   PGS_DUMP ("\n");
 }
 
+/* The area of the video covered by a complete object */
+static gboolean
+pgs_composition_object_get_rect (PgsCompositionObject * obj, SpuState * state,
+    SpuRect * rect)
+{
+  guint16 obj_w, obj_h;
+
+  if (G_UNLIKELY (obj->rle_data == NULL || obj->rle_data_size < 4
+          || obj->rle_data_used != obj->rle_data_size))
+    return FALSE;
+
+  obj_w = GST_READ_UINT16_BE (obj->rle_data);
+  obj_h = GST_READ_UINT16_BE (obj->rle_data + 2);
+
+  if (obj_w == 0 || obj_h == 0 || obj->x >= state->info.width
+      || obj->y >= state->info.height)
+    return FALSE;
+
+  rect->left = obj->x;
+  rect->top = obj->y;
+  rect->right = MIN (obj->x + obj_w, state->info.width) - 1;
+  rect->bottom = MIN (obj->y + obj_h, state->info.height) - 1;
+
+  return TRUE;
+}
+
+/* Draws an object into the AYUV canvas covering @canvas_rect */
 static void
 pgs_composition_object_render (PgsCompositionObject * obj, SpuState * state,
-    GstVideoFrame * frame)
+    GstVideoFrame * frame, const SpuRect * canvas_rect)
 {
   SpuColour *colour;
-  guint8 *planes[3];            /* YUV frame pointers */
-  gint strides[3];
+  SpuRect rect;
+  guint8 *line;
+  gint stride;
   guint8 *data, *end;
-  guint16 obj_w;
-  guint16 obj_h G_GNUC_UNUSED;
-  guint x, y, i, min_x, max_x;
+  guint x, y, min_x, max_x, end_x;
 
-  if (G_UNLIKELY (obj->rle_data == NULL || obj->rle_data_size == 0
-          || obj->rle_data_used != obj->rle_data_size))
+  if (!pgs_composition_object_get_rect (obj, state, &rect))
     return;
 
-  data = obj->rle_data;
-  end = data + obj->rle_data_used;
-
-  if (data + 4 > end)
-    return;
+  data = obj->rle_data + 4;
+  end = obj->rle_data + obj->rle_data_used;
 
   /* FIXME: Calculate and use the cropping window for the output, as the
    * intersection of the crop rectangle for this object (if any) and the
    * window specified by the object's window_id */
 
-  /* Store the start of each plane */
-  planes[0] = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
-  planes[1] = GST_VIDEO_FRAME_COMP_DATA (frame, 1);
-  planes[2] = GST_VIDEO_FRAME_COMP_DATA (frame, 2);
-
-  strides[0] = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
-  strides[1] = GST_VIDEO_FRAME_COMP_STRIDE (frame, 1);
-  strides[2] = GST_VIDEO_FRAME_COMP_STRIDE (frame, 2);
-
-  y = MIN (obj->y, state->info.height);
-
-  planes[0] += strides[0] * y;
-  planes[1] += strides[1] * (y / 2);
-  planes[2] += strides[2] * (y / 2);
-
-  /* RLE data: */
-  obj_w = GST_READ_UINT16_BE (data);
-  obj_h = GST_READ_UINT16_BE (data + 2);
-  data += 4;
-
-  min_x = MIN (obj->x, strides[0]);
-  max_x = MIN (obj->x + obj_w, strides[0]);
+  stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+  line = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 0) +
+      (rect.top - canvas_rect->top) * stride +
+      4 * (rect.left - canvas_rect->left);
 
-  state->comp_left = x = min_x;
-  state->comp_right = max_x;
+  /* Runs are decoded over the whole object width, but only drawn up to the
+   * right edge of the video */
+  min_x = rect.left;
+  max_x = rect.right + 1;
+  end_x = obj->x + GST_READ_UINT16_BE (obj->rle_data);
 
-  gstspu_clear_comp_buffers (state);
+  x = min_x;
+  y = rect.top;
 
   while (data < end) {
     guint8 pal_id;
@@ -265,42 +273,20 @@ pgs_composition_object_render (PgsCompositionObject * obj, SpuState * state,
     }
 
     colour = &state->pgs.palette[pal_id];
-    if (colour->A) {
-      guint32 inv_A = 0xff - colour->A;
-      if (G_UNLIKELY (x + run_len > max_x))
-        run_len = (max_x - x);
-
-      for (i = 0; i < run_len; i++) {
-        planes[0][x] = (inv_A * planes[0][x] + colour->Y) / 0xff;
-
-        state->comp_bufs[0][x / 2] += colour->U;
-        state->comp_bufs[1][x / 2] += colour->V;
-        state->comp_bufs[2][x / 2] += colour->A;
-        x++;
-      }
-    } else {
-      x += run_len;
-    }
+    if (colour->A && x < max_x)
+      gstspu_draw_run (line + 4 * (x - min_x), MIN (run_len, max_x - x),
+          colour);
+    x += run_len;
 
-    if (!run_len || x > max_x) {
+    if (!run_len || x > end_x) {
       x = min_x;
-      planes[0] += strides[0];
-
-      if (y % 2) {
-        gstspu_blend_comp_buffers (state, planes);
-        gstspu_clear_comp_buffers (state);
+      line += stride;
 
-        planes[1] += strides[1];
-        planes[2] += strides[2];
-      }
       y++;
-      if (y >= state->info.height)
+      if (y > rect.bottom)
         return;                 /* Hit the bottom */
     }
   }
-
-  if (y % 2)
-    gstspu_blend_comp_buffers (state, planes);
 }
 
 static void
@@ -760,8 +746,44 @@ gstspu_pgs_execute_event (GstDVDSpu * dvdspu)
   return FALSE;
 }
 
+/* Returns the area of the video covered by the objects of the current
+ * presentation segment */
+gboolean
+gstspu_pgs_get_render_rect (GstDVDSpu * dvdspu, SpuRect * rect)
+{
+  SpuState *state = &dvdspu->spu_state;
+  PgsPresentationSegment *ps = &state->pgs.pres_seg;
+  gboolean have_rect = FALSE;
+  guint i;
+
+  if (ps->objects == NULL)
+    return FALSE;
+
+  for (i = 0; i < ps->objects->len; i++) {
+    PgsCompositionObject *cur =
+        &g_array_index (ps->objects, PgsCompositionObject, i);
+    SpuRect obj_rect;
+
+    if (!pgs_composition_object_get_rect (cur, state, &obj_rect))
+      continue;
+
+    if (have_rect) {
+      rect->left = MIN (rect->left, obj_rect.left);
+      rect->top = MIN (rect->top, obj_rect.top);
+      rect->right = MAX (rect->right, obj_rect.right);
+      rect->bottom = MAX (rect->bottom, obj_rect.bottom);
+    } else {
+      *rect = obj_rect;
+      have_rect = TRUE;
+    }
+  }
+
+  return have_rect;
+}
+
 void
-gstspu_pgs_render (GstDVDSpu * dvdspu, GstVideoFrame * frame)
+gstspu_pgs_render (GstDVDSpu * dvdspu, GstVideoFrame * frame,
+    const SpuRect * rect)
 {
   SpuState *state = &dvdspu->spu_state;
   PgsPresentationSegment *ps = &state->pgs.pres_seg;
@@ -773,7 +795,7 @@ gstspu_pgs_render (GstDVDSpu * dvdspu, GstVideoFrame * frame)
   for (i = 0; i < ps->objects->len; i++) {
     PgsCompositionObject *cur =
         &g_array_index (ps->objects, PgsCompositionObject, i);
-    pgs_composition_object_render (cur, state, frame);
+    pgs_composition_object_render (cur, state, frame, rect);
   }
 }
 
@@ -99,7 +99,8 @@ struct SpuPgsState {
 
 void gstspu_pgs_handle_new_buf (GstDVDSpu * dvdspu, GstClockTime event_ts, GstBuffer *buf);
 gboolean gstspu_pgs_execute_event (GstDVDSpu *dvdspu);
-void gstspu_pgs_render (GstDVDSpu *dvdspu, GstVideoFrame *frame);
+gboolean gstspu_pgs_get_render_rect (GstDVDSpu *dvdspu, SpuRect *rect);
+void gstspu_pgs_render (GstDVDSpu *dvdspu, GstVideoFrame *frame, const SpuRect *rect);
 gboolean gstspu_pgs_handle_dvd_event (GstDVDSpu *dvdspu, GstEvent *event);
 void gstspu_pgs_flush (GstDVDSpu *dvdspu);
 
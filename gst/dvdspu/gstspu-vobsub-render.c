@@ -168,7 +168,7 @@ gstspu_vobsub_get_rle_code (SpuState * state, guint16 * rle_offset)
   return code;
 }
 
-static inline gboolean
+static inline void
 gstspu_vobsub_draw_rle_run (SpuState * state, gint16 x, gint16 end,
     SpuColour * colour)
 {
@@ -177,24 +177,13 @@ gstspu_vobsub_draw_rle_run (SpuState * state, gint16 x, gint16 end,
       state->vobsub.cur_Y, x, end, colour->Y, colour->U, colour->V, colour->A);
 #endif
 
-  if (colour->A != 0) {
-    guint32 inv_A = 0xff - colour->A;
-
-    /* FIXME: This could be more efficient */
-    while (x < end) {
-      state->vobsub.out_Y[x] =
-          (inv_A * state->vobsub.out_Y[x] + colour->Y) / 0xff;
-      state->vobsub.out_U[x / 2] += colour->U;
-      state->vobsub.out_V[x / 2] += colour->V;
-      state->vobsub.out_A[x / 2] += colour->A;
-      x++;
-    }
-    /* Update the compositing buffer so we know how much to blend later */
-    *(state->vobsub.comp_last_x_ptr) = end - 1; /* end is the start of the *next* run */
+  if (state->vobsub.out == NULL || colour->A == 0)
+    return;
 
-    return TRUE;
-  }
-  return FALSE;
+  x = MAX (x, state->vobsub.clip_rect.left);
+  if (x < end)
+    gstspu_draw_run (state->vobsub.out + 4 * (x - state->vobsub.out_left),
+        end - x, colour);
 }
 
 static inline gint16
@@ -207,17 +196,15 @@ rle_end_x (guint16 rle_code, gint16 x, gint16 end)
     return MIN (end, x + (rle_code >> 2));
 }
 
-static gboolean gstspu_vobsub_render_line_with_chgcol (SpuState * state,
-    guint8 * planes[3], guint16 * rle_offset);
+static void gstspu_vobsub_render_line_with_chgcol (SpuState * state,
+    guint16 * rle_offset);
 static gboolean gstspu_vobsub_update_chgcol (SpuState * state);
 
-static gboolean
-gstspu_vobsub_render_line (SpuState * state, guint8 * planes[3],
-    guint16 * rle_offset)
+static void
+gstspu_vobsub_render_line (SpuState * state, guint16 * rle_offset)
 {
   gint16 x, next_x, end, rle_code, next_draw_x;
   SpuColour *colour;
-  gboolean visible = FALSE;
 
   /* Check for special case of chg_col info to use (either highlight or
    * ChgCol command */
@@ -226,19 +213,14 @@ gstspu_vobsub_render_line (SpuState * state, guint8 * planes[3],
       /* Check the top & bottom, because we might not be within the region yet */
       if (state->vobsub.cur_Y >= state->vobsub.cur_chg_col->top &&
           state->vobsub.cur_Y <= state->vobsub.cur_chg_col->bottom) {
-        return gstspu_vobsub_render_line_with_chgcol (state, planes,
-            rle_offset);
+        gstspu_vobsub_render_line_with_chgcol (state, rle_offset);
+        return;
       }
     }
   }
 
   /* No special case. Render as normal */
 
-  /* Set up our output pointers */
-  state->vobsub.out_Y = planes[0];
-  state->vobsub.out_U = state->comp_bufs[0];
-  state->vobsub.out_V = state->comp_bufs[1];
-  state->vobsub.out_A = state->comp_bufs[2];
   /* We always need to start our RLE decoding byte_aligned */
   *rle_offset = GST_ROUND_UP_2 (*rle_offset);
 
@@ -252,13 +234,9 @@ gstspu_vobsub_render_line (SpuState * state, guint8 * planes[3],
     if (next_draw_x > state->vobsub.clip_rect.right)
       next_draw_x = state->vobsub.clip_rect.right;      /* ensure no overflow */
     /* Now draw the run between [x,next_x) */
-    if (state->vobsub.cur_Y >= state->vobsub.clip_rect.top &&
-        state->vobsub.cur_Y <= state->vobsub.clip_rect.bottom)
-      visible |= gstspu_vobsub_draw_rle_run (state, x, next_draw_x, colour);
+    gstspu_vobsub_draw_rle_run (state, x, next_draw_x, colour);
     x = next_x;
   }
-
-  return visible;
 }
 
 static gboolean
@@ -288,9 +266,8 @@ gstspu_vobsub_update_chgcol (SpuState * state)
   return FALSE;
 }
 
-static gboolean
-gstspu_vobsub_render_line_with_chgcol (SpuState * state, guint8 * planes[3],
-    guint16 * rle_offset)
+static void
+gstspu_vobsub_render_line_with_chgcol (SpuState * state, guint16 * rle_offset)
 {
   SpuVobsubLineCtrlI *chg_col = state->vobsub.cur_chg_col;
 
@@ -300,15 +277,9 @@ gstspu_vobsub_render_line_with_chgcol (SpuState * state, guint8 * planes[3],
   SpuVobsubPixCtrlI *next_pix_ctrl;
   SpuVobsubPixCtrlI *end_pix_ctrl;
   SpuVobsubPixCtrlI dummy_pix_ctrl;
-  gboolean visible = FALSE;
   gint16 cur_reg_end;
   gint i;
 
-  state->vobsub.out_Y = planes[0];
-  state->vobsub.out_U = state->comp_bufs[0];
-  state->vobsub.out_V = state->comp_bufs[1];
-  state->vobsub.out_A = state->comp_bufs[2];
-
   /* We always need to start our RLE decoding byte_aligned */
   *rle_offset = GST_ROUND_UP_2 (*rle_offset);
 
@@ -349,7 +320,7 @@ gstspu_vobsub_render_line_with_chgcol (SpuState * state, guint8 * planes[3],
 
       if (G_LIKELY (x < run_end)) {
         colour = &cur_pix_ctrl->pal_cache[rle_code & 3];
-        visible |= gstspu_vobsub_draw_rle_run (state, x, run_draw_end, colour);
+        gstspu_vobsub_draw_rle_run (state, x, run_draw_end, colour);
         x = run_end;
       }
 
@@ -365,87 +336,50 @@ gstspu_vobsub_render_line_with_chgcol (SpuState * state, guint8 * planes[3],
       }
     }
   }
-
-  return visible;
 }
 
-static void
-gstspu_vobsub_blend_comp_buffers (SpuState * state, guint8 * planes[3])
+static inline void
+gstspu_vobsub_mark_pixel (GstVideoFrame * frame, gint16 x, gint16 y)
 {
-  state->comp_left = state->vobsub.disp_rect.left;
-  state->comp_right =
-      MAX (state->vobsub.comp_last_x[0], state->vobsub.comp_last_x[1]);
-
-  state->comp_left = MAX (state->comp_left, state->vobsub.clip_rect.left);
-  state->comp_right = MIN (state->comp_right, state->vobsub.clip_rect.right);
-
-  gstspu_blend_comp_buffers (state, planes);
-}
-
-static void
-gstspu_vobsub_clear_comp_buffers (SpuState * state)
-{
-  state->comp_left = state->vobsub.clip_rect.left;
-  state->comp_right = state->vobsub.clip_rect.right;
-
-  gstspu_clear_comp_buffers (state);
+  if (x < 0 || y < 0 || x >= GST_VIDEO_FRAME_WIDTH (frame) ||
+      y >= GST_VIDEO_FRAME_HEIGHT (frame))
+    return;
 
-  state->vobsub.comp_last_x[0] = -1;
-  state->vobsub.comp_last_x[1] = -1;
+  /* Half transparent black, to darken the video below */
+  GST_WRITE_UINT32_BE ((guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 0) +
+      y * GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0) + 4 * x, 0x80108080);
 }
 
+/* The canvas covers the whole video when this is called */
 static void
 gstspu_vobsub_draw_highlight (SpuState * state,
     GstVideoFrame * frame, SpuRect * rect)
 {
-  guint8 *cur;
   gint16 pos;
-  gint ystride;
-
-  ystride = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
 
-  cur = GST_VIDEO_FRAME_COMP_DATA (frame, 0) + ystride * rect->top;
-  for (pos = rect->left + 1; pos < rect->right; pos++)
-    cur[pos] = (cur[pos] / 2) + 0x8;
-  cur = GST_VIDEO_FRAME_COMP_DATA (frame, 0) + ystride * rect->bottom;
-  for (pos = rect->left + 1; pos < rect->right; pos++)
-    cur[pos] = (cur[pos] / 2) + 0x8;
-  cur = GST_VIDEO_FRAME_COMP_DATA (frame, 0) + ystride * rect->top;
+  for (pos = rect->left + 1; pos < rect->right; pos++) {
+    gstspu_vobsub_mark_pixel (frame, pos, rect->top);
+    gstspu_vobsub_mark_pixel (frame, pos, rect->bottom);
+  }
   for (pos = rect->top; pos <= rect->bottom; pos++) {
-    cur[rect->left] = (cur[rect->left] / 2) + 0x8;
-    cur[rect->right] = (cur[rect->right] / 2) + 0x8;
-    cur += ystride;
+    gstspu_vobsub_mark_pixel (frame, rect->left, pos);
+    gstspu_vobsub_mark_pixel (frame, rect->right, pos);
   }
 }
 
-void
-gstspu_vobsub_render (GstDVDSpu * dvdspu, GstVideoFrame * frame)
+/* Works out where the current display set lands on the video and returns
+ * the area of the video the overlay canvas must cover */
+gboolean
+gstspu_vobsub_get_render_rect (GstDVDSpu * dvdspu, SpuRect * rect)
 {
   SpuState *state = &dvdspu->spu_state;
-  guint8 *planes[3];            /* YUV frame pointers */
-  gint y, last_y;
   gint width, height;
-  gint strides[3];
 
-  /* Set up our initial state */
   if (G_UNLIKELY (state->vobsub.pix_buf == NULL))
-    return;
-
-  if (!gst_buffer_map (state->vobsub.pix_buf, &state->vobsub.pix_buf_map,
-          GST_MAP_READ))
-    return;
-
-  /* Store the start of each plane */
-  planes[0] = GST_VIDEO_FRAME_COMP_DATA (frame, 0);
-  planes[1] = GST_VIDEO_FRAME_COMP_DATA (frame, 1);
-  planes[2] = GST_VIDEO_FRAME_COMP_DATA (frame, 2);
-
-  strides[0] = GST_VIDEO_FRAME_COMP_STRIDE (frame, 0);
-  strides[1] = GST_VIDEO_FRAME_COMP_STRIDE (frame, 1);
-  strides[2] = GST_VIDEO_FRAME_COMP_STRIDE (frame, 2);
+    return FALSE;
 
-  width = GST_VIDEO_FRAME_WIDTH (frame);
-  height = GST_VIDEO_FRAME_HEIGHT (frame);
+  width = GST_VIDEO_INFO_WIDTH (&state->info);
+  height = GST_VIDEO_INFO_HEIGHT (&state->info);
 
   GST_DEBUG_OBJECT (dvdspu,
       "Rendering SPU. disp_rect %d,%d to %d,%d. hl_rect %d,%d to %d,%d",
@@ -456,25 +390,6 @@ gstspu_vobsub_render (GstDVDSpu * dvdspu, GstVideoFrame * frame)
 
   GST_DEBUG_OBJECT (dvdspu, "video size %d,%d", width, height);
 
-  /* When reading RLE data, we track the offset in nibbles... */
-  state->vobsub.cur_offsets[0] = state->vobsub.pix_data[0] * 2;
-  state->vobsub.cur_offsets[1] = state->vobsub.pix_data[1] * 2;
-  state->vobsub.max_offset = state->vobsub.pix_buf_map.size * 2;
-
-  /* Update all the palette caches */
-  gstspu_vobsub_update_palettes (dvdspu, state);
-
-  /* Set up HL or Change Color & Contrast rect tracking */
-  if (state->vobsub.hl_rect.top != -1) {
-    state->vobsub.cur_chg_col = &state->vobsub.hl_ctrl_i;
-    state->vobsub.cur_chg_col_end = state->vobsub.cur_chg_col + 1;
-  } else if (state->vobsub.n_line_ctrl_i > 0) {
-    state->vobsub.cur_chg_col = state->vobsub.line_ctrl_i;
-    state->vobsub.cur_chg_col_end =
-        state->vobsub.cur_chg_col + state->vobsub.n_line_ctrl_i;
-  } else
-    state->vobsub.cur_chg_col = NULL;
-
   state->vobsub.clip_rect.left = state->vobsub.disp_rect.left;
   state->vobsub.clip_rect.right = state->vobsub.disp_rect.right;
 
@@ -543,72 +458,81 @@ gstspu_vobsub_render (GstDVDSpu * dvdspu, GstVideoFrame * frame)
         state->vobsub.clip_rect.bottom);
   }
 
-  /* We start rendering from the first line of the display rect */
-  y = state->vobsub.disp_rect.top;
-  /* start_y is always an even number and we render lines in pairs from there,
-   * accumulating 2 lines of chroma then blending it. We might need to render a
-   * single line at the end if the display rect ends on an even line too. */
-  last_y = (state->vobsub.disp_rect.bottom - 1) & ~(0x01);
-
-  /* Update our plane references to the first line of the disp_rect */
-  planes[0] += strides[0] * y;
-  planes[1] += strides[1] * (y / 2);
-  planes[2] += strides[2] * (y / 2);
-
-  for (state->vobsub.cur_Y = y; state->vobsub.cur_Y <= last_y;
-      state->vobsub.cur_Y++) {
-    gboolean clip, visible = FALSE;
-
-    clip = (state->vobsub.cur_Y < state->vobsub.clip_rect.top
-        || state->vobsub.cur_Y > state->vobsub.clip_rect.bottom);
-
-    /* Reset the compositing buffer */
-    gstspu_vobsub_clear_comp_buffers (state);
-    /* Render even line */
-    state->vobsub.comp_last_x_ptr = state->vobsub.comp_last_x;
-    gstspu_vobsub_render_line (state, planes, &state->vobsub.cur_offsets[0]);
-
-    /* Advance the luminance output pointer */
-    planes[0] += strides[0];
-
-    state->vobsub.cur_Y++;
-
-    /* Render odd line */
-    state->vobsub.comp_last_x_ptr = state->vobsub.comp_last_x + 1;
-    visible |=
-        gstspu_vobsub_render_line (state, planes,
-        &state->vobsub.cur_offsets[1]);
-
-    if (visible && !clip) {
-      /* Blend the accumulated UV compositing buffers onto the output */
-      gstspu_vobsub_blend_comp_buffers (state, planes);
-    }
+  /* a display rect wider than the video still starts left of it */
+  if (state->vobsub.clip_rect.left < 0)
+    state->vobsub.clip_rect.left = 0;
+
+  if (state->vobsub.clip_rect.top < 0 ||
+      state->vobsub.clip_rect.left > state->vobsub.clip_rect.right ||
+      state->vobsub.clip_rect.top > state->vobsub.clip_rect.bottom)
+    return FALSE;
 
-    /* Update all the output pointers */
-    planes[0] += strides[0];
-    planes[1] += strides[1];
-    planes[2] += strides[2];
+  if ((dvdspu_debug_flags & (GST_DVD_SPU_DEBUG_RENDER_RECTANGLE |
+              GST_DVD_SPU_DEBUG_HIGHLIGHT_RECTANGLE)) != 0) {
+    /* the debug rectangles can be anywhere on the video */
+    rect->left = rect->top = 0;
+    rect->right = width - 1;
+    rect->bottom = height - 1;
+  } else {
+    *rect = state->vobsub.clip_rect;
   }
 
-  if (state->vobsub.cur_Y == state->vobsub.disp_rect.bottom) {
-    gboolean clip, visible = FALSE;
+  return TRUE;
+}
 
-    clip = (state->vobsub.cur_Y < state->vobsub.clip_rect.top
-        || state->vobsub.cur_Y > state->vobsub.clip_rect.bottom);
+/* Renders the display set into an AYUV canvas covering @rect, as returned by
+ * gstspu_vobsub_get_render_rect() */
+void
+gstspu_vobsub_render (GstDVDSpu * dvdspu, GstVideoFrame * frame,
+    const SpuRect * rect)
+{
+  SpuState *state = &dvdspu->spu_state;
+  guint8 *data;
+  gint stride;
+  gint16 last_y;
 
-    g_assert ((state->vobsub.disp_rect.bottom & 0x01) == 0);
+  if (!gst_buffer_map (state->vobsub.pix_buf, &state->vobsub.pix_buf_map,
+          GST_MAP_READ))
+    return;
 
-    if (!clip) {
-      /* Render a remaining lone last even line. y already has the correct value
-       * after the above loop exited. */
-      gstspu_vobsub_clear_comp_buffers (state);
-      state->vobsub.comp_last_x_ptr = state->vobsub.comp_last_x;
-      visible |=
-          gstspu_vobsub_render_line (state, planes,
-          &state->vobsub.cur_offsets[0]);
-      if (visible)
-        gstspu_vobsub_blend_comp_buffers (state, planes);
-    }
+  data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
+  stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+
+  /* When reading RLE data, we track the offset in nibbles... */
+  state->vobsub.cur_offsets[0] = state->vobsub.pix_data[0] * 2;
+  state->vobsub.cur_offsets[1] = state->vobsub.pix_data[1] * 2;
+  state->vobsub.max_offset = state->vobsub.pix_buf_map.size * 2;
+
+  /* Update all the palette caches */
+  gstspu_vobsub_update_palettes (dvdspu, state);
+
+  /* Set up HL or Change Color & Contrast rect tracking */
+  if (state->vobsub.hl_rect.top != -1) {
+    state->vobsub.cur_chg_col = &state->vobsub.hl_ctrl_i;
+    state->vobsub.cur_chg_col_end = state->vobsub.cur_chg_col + 1;
+  } else if (state->vobsub.n_line_ctrl_i > 0) {
+    state->vobsub.cur_chg_col = state->vobsub.line_ctrl_i;
+    state->vobsub.cur_chg_col_end =
+        state->vobsub.cur_chg_col + state->vobsub.n_line_ctrl_i;
+  } else
+    state->vobsub.cur_chg_col = NULL;
+
+  state->vobsub.out_left = rect->left;
+
+  /* We render from the first line of the display rect. The lines of the top
+   * and bottom fields alternate, each field with its own RLE offset, so the
+   * lines above the clip rect are still decoded, just not drawn */
+  last_y = MIN (state->vobsub.disp_rect.bottom, state->vobsub.clip_rect.bottom);
+  for (state->vobsub.cur_Y = state->vobsub.disp_rect.top;
+      state->vobsub.cur_Y <= last_y; state->vobsub.cur_Y++) {
+    gint field = (state->vobsub.cur_Y - state->vobsub.disp_rect.top) & 1;
+
+    if (state->vobsub.cur_Y >= state->vobsub.clip_rect.top)
+      state->vobsub.out = data + (state->vobsub.cur_Y - rect->top) * stride;
+    else
+      state->vobsub.out = NULL;
+
+    gstspu_vobsub_render_line (state, &state->vobsub.cur_offsets[field]);
   }
 
   /* for debugging purposes, draw a faint rectangle at the edges of the disp_rect */
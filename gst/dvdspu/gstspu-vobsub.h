@@ -81,9 +81,6 @@ struct SpuVobsubState {
                                    * need recalculating */
 
   /* Rendering state vars below */
-  gint16 comp_last_x[2]; /* Maximum X values we rendered into the comp buffer (odd & even) */
-  gint16 *comp_last_x_ptr; /* Ptr to the current comp_last_x value to be updated by the render */
-
   /* Current Y Position */
   gint16 cur_Y;
 
@@ -95,16 +92,16 @@ struct SpuVobsubState {
   SpuVobsubLineCtrlI *cur_chg_col;
   SpuVobsubLineCtrlI *cur_chg_col_end;
 
-  /* Output position tracking */
-  guint8  *out_Y;
-  guint32 *out_U;
-  guint32 *out_V;
-  guint32 *out_A;
+  /* Output position tracking: the canvas line for cur_Y, or NULL if the
+   * line is clipped, and the X position of its first pixel */
+  guint8 *out;
+  gint16 out_left;
 };
 
 void gstspu_vobsub_handle_new_buf (GstDVDSpu * dvdspu, GstClockTime event_ts, GstBuffer *buf);
 gboolean gstspu_vobsub_execute_event (GstDVDSpu *dvdspu);
-void gstspu_vobsub_render (GstDVDSpu *dvdspu, GstVideoFrame *frame);
+gboolean gstspu_vobsub_get_render_rect (GstDVDSpu *dvdspu, SpuRect *rect);
+void gstspu_vobsub_render (GstDVDSpu *dvdspu, GstVideoFrame *frame, const SpuRect *rect);
 gboolean gstspu_vobsub_handle_dvd_event (GstDVDSpu *dvdspu, GstEvent *event);
 void gstspu_vobsub_flush (GstDVDSpu *dvdspu);
 
@@ -82,6 +82,8 @@ GST_DEBUG_CATEGORY_STATIC (gst_field_analysis_debug);
 #define DEFAULT_BLOCK_HEIGHT 16
 #define DEFAULT_BLOCK_THRESH 80
 #define DEFAULT_IGNORED_LINES 2
+#define DEFAULT_ROW_DECIMATION 1
+#define DEFAULT_N_THREADS 1
 
 enum
 {
@@ -96,7 +98,9 @@ enum
   PROP_BLOCK_WIDTH,
   PROP_BLOCK_HEIGHT,
   PROP_BLOCK_THRESH,
-  PROP_IGNORED_LINES
+  PROP_IGNORED_LINES,
+  PROP_ROW_DECIMATION,
+  PROP_N_THREADS
 };
 
 static GstStaticPadTemplate sink_factory =
@@ -274,6 +278,16 @@ gst_field_analysis_class_init (GstFieldAnalysisClass * klass)
           "Ignore this many lines from the top and bottom for windowed comb detection",
           2, G_MAXUINT64, DEFAULT_IGNORED_LINES,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_ROW_DECIMATION,
+      g_param_spec_uint ("row-decimation", "Row decimation",
+          "Compute field and frame metrics on every nth field line first and "
+          "only refine scores close to the thresholds at full resolution "
+          "(1 = analyse every line)", 1, 16, DEFAULT_ROW_DECIMATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads used for windowed comb detection", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_field_analysis_change_state);
@@ -300,11 +314,14 @@ static gfloat same_parity_3_tap (GstFieldAnalysis * filter,
 static gfloat opposite_parity_5_tap (GstFieldAnalysis * filter,
     FieldAnalysisFields (*history)[2]);
 static guint64 block_score_for_row_32detect (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1);
+    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1,
+    guint8 * comb_mask, guint * block_scores);
 static guint64 block_score_for_row_iscombed (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1);
+    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1,
+    guint8 * comb_mask, guint * block_scores);
 static guint64 block_score_for_row_5_tap (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1);
+    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1,
+    guint8 * comb_mask, guint * block_scores);
 static gfloat opposite_parity_windowed_comb (GstFieldAnalysis * filter,
     FieldAnalysisFields (*history)[2]);
 
@@ -329,8 +346,10 @@ gst_field_analysis_reset (GstFieldAnalysis * filter)
   gst_video_info_init (&filter->vinfo);
   g_free (filter->comb_mask);
   filter->comb_mask = NULL;
+  filter->comb_mask_size = 0;
   g_free (filter->block_scores);
   filter->block_scores = NULL;
+  filter->block_scores_size = 0;
 }
 
 static void
@@ -360,6 +379,12 @@ gst_field_analysis_init (GstFieldAnalysis * filter)
   filter->block_height = DEFAULT_BLOCK_HEIGHT;
   filter->block_thresh = DEFAULT_BLOCK_THRESH;
   filter->ignored_lines = DEFAULT_IGNORED_LINES;
+  filter->row_decimation = DEFAULT_ROW_DECIMATION;
+  filter->row_step = 1;
+  filter->n_threads = DEFAULT_N_THREADS;
+  filter->pool = NULL;
+  g_mutex_init (&filter->jobs_lock);
+  g_cond_init (&filter->jobs_cond);
 }
 
 static void
@@ -424,19 +449,10 @@ gst_field_analysis_set_property (GObject * object, guint prop_id,
       filter->spatial_thresh = g_value_get_int64 (value);
       break;
     case PROP_BLOCK_WIDTH:
+      /* block score space is resized on demand for the next frame */
+      GST_OBJECT_LOCK (filter);
       filter->block_width = g_value_get_uint64 (value);
-      if (GST_VIDEO_FRAME_WIDTH (&filter->frames[0].frame)) {
-        const gint frame_width =
-            GST_VIDEO_FRAME_WIDTH (&filter->frames[0].frame);
-        if (filter->block_scores) {
-          gsize nbytes = (frame_width / filter->block_width) * sizeof (guint);
-          filter->block_scores = g_realloc (filter->block_scores, nbytes);
-          memset (filter->block_scores, 0, nbytes);
-        } else {
-          filter->block_scores =
-              g_malloc0 ((frame_width / filter->block_width) * sizeof (guint));
-        }
-      }
+      GST_OBJECT_UNLOCK (filter);
       break;
     case PROP_BLOCK_HEIGHT:
       filter->block_height = g_value_get_uint64 (value);
@@ -447,6 +463,12 @@ gst_field_analysis_set_property (GObject * object, guint prop_id,
     case PROP_IGNORED_LINES:
       filter->ignored_lines = g_value_get_uint64 (value);
       break;
+    case PROP_ROW_DECIMATION:
+      filter->row_decimation = g_value_get_uint (value);
+      break;
+    case PROP_N_THREADS:
+      filter->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -521,6 +543,12 @@ gst_field_analysis_get_property (GObject * object, guint prop_id,
     case PROP_IGNORED_LINES:
       g_value_set_uint64 (value, filter->ignored_lines);
       break;
+    case PROP_ROW_DECIMATION:
+      g_value_set_uint (value, filter->row_decimation);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, filter->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -530,7 +558,6 @@ gst_field_analysis_get_property (GObject * object, guint prop_id,
 static void
 gst_field_analysis_update_format (GstFieldAnalysis * filter, GstCaps * caps)
 {
-  gint width;
   GQueue *outbufs;
   GstVideoInfo vinfo;
 
@@ -566,23 +593,9 @@ gst_field_analysis_update_format (GstFieldAnalysis * filter, GstCaps * caps)
   GST_OBJECT_LOCK (filter);
   filter->flushing = FALSE;
 
+  /* comb mask and block score space is allocated on demand by the windowed
+   * comb detection for the new width */
   filter->vinfo = vinfo;
-  width = GST_VIDEO_INFO_WIDTH (&filter->vinfo);
-
-  /* update allocations for metric scores */
-  if (filter->comb_mask) {
-    filter->comb_mask = g_realloc (filter->comb_mask, width);
-  } else {
-    filter->comb_mask = g_malloc (width);
-  }
-  if (filter->block_scores) {
-    gsize nbytes = (width / filter->block_width) * sizeof (guint);
-    filter->block_scores = g_realloc (filter->block_scores, nbytes);
-    memset (filter->block_scores, 0, nbytes);
-  } else {
-    filter->block_scores =
-        g_malloc0 ((width / filter->block_width) * sizeof (guint));
-  }
 
   GST_OBJECT_UNLOCK (filter);
   return;
@@ -807,7 +820,7 @@ gst_field_analysis_sink_event (GstPad * pad, GstObject * parent,
 static gfloat
 same_parity_sad (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
 {
-  gint j;
+  gint j, nlines;
   gfloat sum;
   guint8 *f1j, *f2j;
 
@@ -818,6 +831,7 @@ same_parity_sad (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
   const gint stride1x2 =
       GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
   const guint32 noise_floor = filter->noise_floor;
+  const gint row_step = filter->row_step;
 
   f1j =
       GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
@@ -833,14 +847,19 @@ same_parity_sad (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
       0);
 
   sum = 0.0f;
-  for (j = 0; j < (height >> 1); j++) {
+  nlines = 0;
+  for (j = 0; j < (height >> 1); j += row_step) {
     guint32 tempsum = 0;
     fieldanalysis_orc_same_parity_sad_planar_yuv (&tempsum, f1j, f2j,
         noise_floor, width);
     sum += tempsum;
-    f1j += stride0x2;
-    f2j += stride1x2;
+    nlines++;
+    f1j += stride0x2 * row_step;
+    f2j += stride1x2 * row_step;
   }
+  /* scale up a decimated result */
+  if (row_step > 1)
+    sum *= (gfloat) (height >> 1) / nlines;
 
   return sum / (0.5f * width * height);
 }
@@ -848,7 +867,7 @@ same_parity_sad (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
 static gfloat
 same_parity_ssd (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
 {
-  gint j;
+  gint j, nlines;
   gfloat sum;
   guint8 *f1j, *f2j;
 
@@ -860,6 +879,7 @@ same_parity_ssd (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
       GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
   /* noise floor needs to be squared for SSD */
   const guint32 noise_floor = filter->noise_floor * filter->noise_floor;
+  const gint row_step = filter->row_step;
 
   f1j =
       GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
@@ -875,14 +895,19 @@ same_parity_ssd (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
       0);
 
   sum = 0.0f;
-  for (j = 0; j < (height >> 1); j++) {
+  nlines = 0;
+  for (j = 0; j < (height >> 1); j += row_step) {
     guint32 tempsum = 0;
     fieldanalysis_orc_same_parity_ssd_planar_yuv (&tempsum, f1j, f2j,
         noise_floor, width);
     sum += tempsum;
-    f1j += stride0x2;
-    f2j += stride1x2;
+    nlines++;
+    f1j += stride0x2 * row_step;
+    f2j += stride1x2 * row_step;
   }
+  /* scale up a decimated result */
+  if (row_step > 1)
+    sum *= (gfloat) (height >> 1) / nlines;
 
   return sum / (0.5f * width * height); /* field is half height */
 }
@@ -892,7 +917,7 @@ same_parity_ssd (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
 static gfloat
 same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
 {
-  gint i, j;
+  gint i, j, nlines;
   gfloat sum;
   guint8 *f1j, *f2j;
 
@@ -905,6 +930,7 @@ same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
   const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
   /* noise floor needs to be *6 for [1,4,1] */
   const guint32 noise_floor = filter->noise_floor * 6;
+  const gint row_step = filter->row_step;
 
   f1j = GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame, 0) +
       GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame, 0) +
@@ -918,7 +944,8 @@ same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
       0);
 
   sum = 0.0f;
-  for (j = 0; j < (height >> 1); j++) {
+  nlines = 0;
+  for (j = 0; j < (height >> 1); j += row_step) {
     guint32 tempsum = 0;
     guint32 diff;
 
@@ -940,9 +967,13 @@ same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields (*history)[2])
     if (diff > noise_floor)
       sum += diff;
 
-    f1j += stride0x2;
-    f2j += stride1x2;
+    nlines++;
+    f1j += stride0x2 * row_step;
+    f2j += stride1x2 * row_step;
   }
+  /* scale up a decimated result */
+  if (row_step > 1)
+    sum *= (gfloat) (height >> 1) / nlines;
 
   return sum / ((6.0f / 2.0f) * width * height);        /* 1 + 4 + 1 = 6; field is half height */
 }
@@ -954,9 +985,11 @@ static gfloat
 opposite_parity_5_tap (GstFieldAnalysis * filter,
     FieldAnalysisFields (*history)[2])
 {
-  gint j;
+  gint j, nlines;
   gfloat sum;
+  guint8 *base_fj, *base_fjp1;
   guint8 *fjm2, *fjm1, *fj, *fjp1, *fjp2;
+  gint stride_j_x2, stride_jp1_x2;
   guint32 tempsum;
 
   const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
@@ -967,6 +1000,8 @@ opposite_parity_5_tap (GstFieldAnalysis * filter,
       GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0) << 1;
   /* noise floor needs to be *6 for [1,-3,4,-3,1] */
   const guint32 noise_floor = filter->noise_floor * 6;
+  const gint row_step = filter->row_step;
+  const gint last = (height >> 1) - 1;
 
   sum = 0.0f;
 
@@ -978,73 +1013,124 @@ opposite_parity_5_tap (GstFieldAnalysis * filter,
    * fj with j == 1 is the 0th line of the bottom field or the 1st field of
    *   the frame*/
 
-  /* unroll first line as it is a special case */
   if ((*history)[0].parity == TOP_FIELD) {
-    fj = GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
+    base_fj = GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
         0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame, 0);
-    fjp1 =
+    base_fjp1 =
         GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
         0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame,
         0) + GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[1].frame, 0);
-    fjp2 = fj + stride0x2;
+    stride_j_x2 = stride0x2;
+    stride_jp1_x2 = stride1x2;
   } else {
-    fj = GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
+    base_fj = GST_VIDEO_FRAME_COMP_DATA (&(*history)[1].frame,
         0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[1].frame, 0);
-    fjp1 =
+    base_fjp1 =
         GST_VIDEO_FRAME_COMP_DATA (&(*history)[0].frame,
         0) + GST_VIDEO_FRAME_COMP_OFFSET (&(*history)[0].frame,
         0) + GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0);
-    fjp2 = fj + stride1x2;
+    stride_j_x2 = stride1x2;
+    stride_jp1_x2 = stride0x2;
   }
 
+  /* unroll first line as it is a special case */
+  fj = base_fj;
+  fjp1 = base_fjp1;
+  fjp2 = fj + stride_j_x2;
+
   tempsum = 0;
   fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum, fjp2, fjp1, fj,
       fjp1, fjp2, noise_floor, width);
   sum += tempsum;
+  nlines = 1;
 
-  for (j = 1; j < (height >> 1) - 1; j++) {
-    /* shift everything down a line in the field of interest (means += stridex2) */
-    fjm2 = fj;
-    fjm1 = fjp1;
-    fj = fjp2;
-    if ((*history)[0].parity == TOP_FIELD) {
-      fjp1 += stride1x2;
-      fjp2 += stride0x2;
-    } else {
-      fjp1 += stride0x2;
-      fjp2 += stride1x2;
-    }
+  /* the line pointers are derived from j so that every row_step-th line can
+   * be evaluated when decimating */
+  for (j = row_step; j < last; j += row_step) {
+    fj = base_fj + j * stride_j_x2;
+    fjp1 = base_fjp1 + j * stride_jp1_x2;
+    fjm2 = fj - stride_j_x2;
+    fjm1 = fjp1 - stride_jp1_x2;
+    fjp2 = fj + stride_j_x2;
 
     tempsum = 0;
     fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum, fjm2, fjm1,
         fj, fjp1, fjp2, noise_floor, width);
     sum += tempsum;
+    nlines++;
   }
 
   /* unroll the last line as it is a special case */
-  /* shift everything down a line in the field of interest (means += stridex2) */
-  fjm2 = fj;
-  fjm1 = fjp1;
-  fj = fjp2;
+  fj = base_fj + last * stride_j_x2;
+  fjm2 = fj - stride_j_x2;
+  fjm1 = base_fjp1 + (last - 1) * stride_jp1_x2;
 
   tempsum = 0;
   fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum, fjm2, fjm1, fj,
       fjm1, fjm2, noise_floor, width);
   sum += tempsum;
+  nlines++;
+
+  /* scale up a decimated result */
+  if (row_step > 1)
+    sum *= (gfloat) (height >> 1) / nlines;
 
   return sum / ((6.0f / 2.0f) * width * height);        /* 1 + 4 + 1 == 3 + 3 == 6; field is half height */
 }
 
+/* a sample contributes to the score of its block if it and its left and right
+ * neighbours are combed. the left and right edges only need two combed
+ * samples */
+static inline void
+block_scores_from_comb_mask (const guint8 * comb_mask, guint * block_scores,
+    gint width, guint64 block_width)
+{
+  gint i;
+
+  if (width < 3)
+    return;
+
+  /* left edge */
+  if (comb_mask[0] && comb_mask[1])
+    block_scores[0]++;
+
+  for (i = 2; i < width - 1; i++) {
+    if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
+      block_scores[(i - 1) / block_width]++;
+  }
+
+  /* right edge */
+  if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
+    block_scores[(i - 1) / block_width]++;
+  if (comb_mask[i - 1] && comb_mask[i])
+    block_scores[i / block_width]++;
+}
+
+static inline guint64
+block_score_max (const guint * block_scores, gint width, guint64 block_width)
+{
+  guint64 i, block_score = 0;
+
+  for (i = 0; i < width / block_width; i++) {
+    if (block_scores[i] > block_score)
+      block_score = block_scores[i];
+  }
+
+  return block_score;
+}
+
+/* the orc comb mask kernels work on 16-bit intermediates, differences can never
+ * exceed 255 so clamping the threshold does not change the result */
+#define CLAMPED_SPATIAL_THRESH(t) ((gint) MIN ((t), 255))
+
 /* this metric was sourced from HandBrake but originally from transcode
  * the return value is the highest block score for the row of blocks */
 static inline guint64
 block_score_for_row_32detect (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1)
+    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1,
+    guint8 * comb_mask, guint * block_scores)
 {
   guint64 i, j;
-  guint8 *comb_mask = filter->comb_mask;
-  guint *block_scores = filter->block_scores;
-  guint64 block_score;
   guint8 *fjm2, *fjm1, *fj, *fjp1;
   const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
   const gint stridex2 =
@@ -1056,53 +1142,37 @@ block_score_for_row_32detect (GstFieldAnalysis * filter,
       GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) -
       (GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) % block_width);
 
+  memset (block_scores, 0, (width / block_width) * sizeof (guint));
+
   fjm2 = base_fj - stridex2;
   fjm1 = base_fjp1 - stridex2;
   fj = base_fj;
   fjp1 = base_fjp1;
 
   for (j = 0; j < block_height; j++) {
-    /* we have to work one result ahead of ourselves which results in some small
-     * peculiarities below */
-    gint diff1, diff2;
-
-    diff1 = fj[0] - fjm1[0];
-    diff2 = fj[0] - fjp1[0];
-    /* change in the same direction */
-    if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-        || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-      comb_mask[0] = abs (fj[0] - fjm2[0]) < 10 && abs (fj[0] - fjm1[0]) > 15;
+    if (incr == 1) {
+      fieldanalysis_orc_comb_mask_32detect_planar_yuv (comb_mask, fjm2, fjm1,
+          fj, fjp1, CLAMPED_SPATIAL_THRESH (spatial_thresh), width);
     } else {
-      comb_mask[0] = FALSE;
+      for (i = 0; i < width; i++) {
+        const guint64 idx = i * incr;
+        gint diff1, diff2;
+
+        diff1 = fj[idx] - fjm1[idx];
+        diff2 = fj[idx] - fjp1[idx];
+        /* change in the same direction */
+        if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
+            || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
+          comb_mask[i] = abs (fj[idx] - fjm2[idx]) < 10
+              && abs (fj[idx] - fjm1[idx]) > 15;
+        } else {
+          comb_mask[i] = FALSE;
+        }
+      }
     }
 
-    for (i = 1; i < width; i++) {
-      const guint64 idx = i * incr;
-      const guint64 res_idx = (i - 1) / block_width;
+    block_scores_from_comb_mask (comb_mask, block_scores, width, block_width);
 
-      diff1 = fj[idx] - fjm1[idx];
-      diff2 = fj[idx] - fjp1[idx];
-      if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-          || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-        comb_mask[i] = abs (fj[idx] - fjm2[idx]) < 10
-            && abs (fj[idx] - fjm1[idx]) > 15;
-      } else {
-        comb_mask[i] = FALSE;
-      }
-
-      if (i == 1 && comb_mask[i - 1] && comb_mask[i]) {
-        /* left edge */
-        block_scores[res_idx]++;
-      } else if (i == width - 1) {
-        /* right edge */
-        if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
-          block_scores[res_idx]++;
-        if (comb_mask[i - 1] && comb_mask[i])
-          block_scores[i / block_width]++;
-      } else if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i]) {
-        block_scores[res_idx]++;
-      }
-    }
     /* advance down a line */
     fjm2 = fjm1;
     fjm1 = fj;
@@ -1110,15 +1180,7 @@ block_score_for_row_32detect (GstFieldAnalysis * filter,
     fjp1 = fjm1 + stridex2;
   }
 
-  block_score = 0;
-  for (i = 0; i < width / block_width; i++) {
-    if (block_scores[i] > block_score)
-      block_score = block_scores[i];
-  }
-
-  g_free (block_scores);
-  g_free (comb_mask);
-  return block_score;
+  return block_score_max (block_scores, width, block_width);
 }
 
 /* this metric was sourced from HandBrake but originally from
@@ -1126,12 +1188,10 @@ block_score_for_row_32detect (GstFieldAnalysis * filter,
  * the return value is the highest block score for the row of blocks */
 static inline guint64
 block_score_for_row_iscombed (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1)
+    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1,
+    guint8 * comb_mask, guint * block_scores)
 {
   guint64 i, j;
-  guint8 *comb_mask = filter->comb_mask;
-  guint *block_scores = filter->block_scores;
-  guint64 block_score;
   guint8 *fjm1, *fj, *fjp1;
   const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
   const gint stridex2 =
@@ -1144,69 +1204,46 @@ block_score_for_row_iscombed (GstFieldAnalysis * filter,
       GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) -
       (GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) % block_width);
 
+  memset (block_scores, 0, (width / block_width) * sizeof (guint));
+
   fjm1 = base_fjp1 - stridex2;
   fj = base_fj;
   fjp1 = base_fjp1;
 
   for (j = 0; j < block_height; j++) {
-    /* we have to work one result ahead of ourselves which results in some small
-     * peculiarities below */
-    gint diff1, diff2;
-
-    diff1 = fj[0] - fjm1[0];
-    diff2 = fj[0] - fjp1[0];
-    /* change in the same direction */
-    if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-        || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-      comb_mask[0] =
-          (fjm1[0] - fj[0]) * (fjp1[0] - fj[0]) > spatial_thresh_squared;
+    if (incr == 1) {
+      const gint thresh = CLAMPED_SPATIAL_THRESH (spatial_thresh);
+
+      fieldanalysis_orc_comb_mask_iscombed_planar_yuv (comb_mask, fjm1, fj,
+          fjp1, thresh, thresh * thresh, width);
     } else {
-      comb_mask[0] = FALSE;
+      for (i = 0; i < width; i++) {
+        const guint64 idx = i * incr;
+        gint diff1, diff2;
+
+        diff1 = fj[idx] - fjm1[idx];
+        diff2 = fj[idx] - fjp1[idx];
+        /* change in the same direction */
+        if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
+            || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
+          comb_mask[i] =
+              (fjm1[idx] - fj[idx]) * (fjp1[idx] - fj[idx]) >
+              spatial_thresh_squared;
+        } else {
+          comb_mask[i] = FALSE;
+        }
+      }
     }
 
-    for (i = 1; i < width; i++) {
-      const guint64 idx = i * incr;
-      const guint64 res_idx = (i - 1) / block_width;
-
-      diff1 = fj[idx] - fjm1[idx];
-      diff2 = fj[idx] - fjp1[idx];
-      if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-          || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-        comb_mask[i] =
-            (fjm1[idx] - fj[idx]) * (fjp1[idx] - fj[idx]) >
-            spatial_thresh_squared;
-      } else {
-        comb_mask[i] = FALSE;
-      }
+    block_scores_from_comb_mask (comb_mask, block_scores, width, block_width);
 
-      if (i == 1 && comb_mask[i - 1] && comb_mask[i]) {
-        /* left edge */
-        block_scores[res_idx]++;
-      } else if (i == width - 1) {
-        /* right edge */
-        if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
-          block_scores[res_idx]++;
-        if (comb_mask[i - 1] && comb_mask[i])
-          block_scores[i / block_width]++;
-      } else if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i]) {
-        block_scores[res_idx]++;
-      }
-    }
     /* advance down a line */
     fjm1 = fj;
     fj = fjp1;
     fjp1 = fjm1 + stridex2;
   }
 
-  block_score = 0;
-  for (i = 0; i < width / block_width; i++) {
-    if (block_scores[i] > block_score)
-      block_score = block_scores[i];
-  }
-
-  g_free (block_scores);
-  g_free (comb_mask);
-  return block_score;
+  return block_score_max (block_scores, width, block_width);
 }
 
 /* this metric was sourced from HandBrake but originally from
@@ -1214,12 +1251,10 @@ block_score_for_row_iscombed (GstFieldAnalysis * filter,
  * the return value is the highest block score for the row of blocks */
 static inline guint64
 block_score_for_row_5_tap (GstFieldAnalysis * filter,
-    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1)
+    FieldAnalysisFields (*history)[2], guint8 * base_fj, guint8 * base_fjp1,
+    guint8 * comb_mask, guint * block_scores)
 {
   guint64 i, j;
-  guint8 *comb_mask = filter->comb_mask;
-  guint *block_scores = filter->block_scores;
-  guint64 block_score;
   guint8 *fjm2, *fjm1, *fj, *fjp1, *fjp2;
   const gint incr = GST_VIDEO_FRAME_COMP_PSTRIDE (&(*history)[0].frame, 0);
   const gint stridex2 =
@@ -1232,6 +1267,7 @@ block_score_for_row_5_tap (GstFieldAnalysis * filter,
       GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) -
       (GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame) % block_width);
 
+  memset (block_scores, 0, (width / block_width) * sizeof (guint));
 
   fjm2 = base_fj - stridex2;
   fjm1 = base_fjp1 - stridex2;
@@ -1240,67 +1276,49 @@ block_score_for_row_5_tap (GstFieldAnalysis * filter,
   fjp2 = fj + stridex2;
 
   for (j = 0; j < block_height; j++) {
-    /* we have to work one result ahead of ourselves which results in some small
-     * peculiarities below */
-    gint diff1, diff2;
-
-    diff1 = fj[0] - fjm1[0];
-    diff2 = fj[0] - fjp1[0];
-    /* change in the same direction */
-    if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-        || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-      comb_mask[0] =
-          abs (fjm2[0] + (fj[0] << 2) + fjp2[0] - 3 * (fjm1[0] + fjp1[0])) >
-          spatial_threshx6;
-
-      /* motion detection that needs previous and next frames
-         this isn't really necessary, but acts as an optimisation if the
-         additional delay isn't a problem
-         if (motion_detection) {
-         if (abs(fpj[idx] - fj[idx]               ) > motion_thresh &&
-         abs(           fjm1[idx] - fnjm1[idx]) > motion_thresh &&
-         abs(           fjp1[idx] - fnjp1[idx]) > motion_thresh)
-         motion++;
-         if (abs(             fj[idx]   - fnj[idx]) > motion_thresh &&
-         abs(fpjm1[idx] - fjm1[idx]           ) > motion_thresh &&
-         abs(fpjp1[idx] - fjp1[idx]           ) > motion_thresh)
-         motion++;
-         } else {
-         motion = 1;
-         }
-       */
+    if (incr == 1) {
+      const gint thresh = CLAMPED_SPATIAL_THRESH (spatial_thresh);
+
+      fieldanalysis_orc_comb_mask_5_tap_planar_yuv (comb_mask, fjm2, fjm1, fj,
+          fjp1, fjp2, thresh, 6 * thresh, width);
     } else {
-      comb_mask[0] = FALSE;
+      for (i = 0; i < width; i++) {
+        const guint64 idx = i * incr;
+        gint diff1, diff2;
+
+        diff1 = fj[idx] - fjm1[idx];
+        diff2 = fj[idx] - fjp1[idx];
+        /* change in the same direction */
+        if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
+            || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
+          comb_mask[i] =
+              abs (fjm2[idx] + (fj[idx] << 2) + fjp2[idx] - 3 * (fjm1[idx] +
+                  fjp1[idx])) > spatial_threshx6;
+
+          /* motion detection that needs previous and next frames
+             this isn't really necessary, but acts as an optimisation if the
+             additional delay isn't a problem
+             if (motion_detection) {
+             if (abs(fpj[idx] - fj[idx]               ) > motion_thresh &&
+             abs(           fjm1[idx] - fnjm1[idx]) > motion_thresh &&
+             abs(           fjp1[idx] - fnjp1[idx]) > motion_thresh)
+             motion++;
+             if (abs(             fj[idx]   - fnj[idx]) > motion_thresh &&
+             abs(fpjm1[idx] - fjm1[idx]           ) > motion_thresh &&
+             abs(fpjp1[idx] - fjp1[idx]           ) > motion_thresh)
+             motion++;
+             } else {
+             motion = 1;
+             }
+           */
+        } else {
+          comb_mask[i] = FALSE;
+        }
+      }
     }
 
-    for (i = 1; i < width; i++) {
-      const guint64 idx = i * incr;
-      const guint64 res_idx = (i - 1) / block_width;
-
-      diff1 = fj[idx] - fjm1[idx];
-      diff2 = fj[idx] - fjp1[idx];
-      if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-          || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-        comb_mask[i] =
-            abs (fjm2[idx] + (fj[idx] << 2) + fjp2[idx] - 3 * (fjm1[idx] +
-                fjp1[idx])) > spatial_threshx6;
-      } else {
-        comb_mask[i] = FALSE;
-      }
+    block_scores_from_comb_mask (comb_mask, block_scores, width, block_width);
 
-      if (i == 1 && comb_mask[i - 1] && comb_mask[i]) {
-        /* left edge */
-        block_scores[res_idx]++;
-      } else if (i == width - 1) {
-        /* right edge */
-        if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
-          block_scores[res_idx]++;
-        if (comb_mask[i - 1] && comb_mask[i])
-          block_scores[i / block_width]++;
-      } else if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i]) {
-        block_scores[res_idx]++;
-      }
-    }
     /* advance down a line */
     fjm2 = fjm1;
     fjm1 = fj;
@@ -1309,15 +1327,86 @@ block_score_for_row_5_tap (GstFieldAnalysis * filter,
     fjp2 = fj + stridex2;
   }
 
-  block_score = 0;
-  for (i = 0; i < width / block_width; i++) {
-    if (block_scores[i] > block_score)
-      block_score = block_scores[i];
+  return block_score_max (block_scores, width, block_width);
+}
+
+/* a comb job evaluates a contiguous range of rows of blocks using its own
+ * comb mask and block score scratch space */
+typedef struct
+{
+  GstFieldAnalysis *filter;
+  FieldAnalysisFields (*history)[2];
+  guint8 *base_fj, *base_fjp1;
+  guint8 *comb_mask;
+  guint *block_scores;
+  gint first_row, last_row;
+  gboolean slightly_combed;
+} FieldAnalysisCombJob;
+
+static void
+gst_field_analysis_run_comb_job (FieldAnalysisCombJob * job)
+{
+  GstFieldAnalysis *filter = job->filter;
+  const gint stride =
+      GST_VIDEO_FRAME_COMP_STRIDE (&(*job->history)[0].frame, 0);
+  const guint64 block_thresh = filter->block_thresh;
+  gint row;
+
+  for (row = job->first_row; row < job->last_row; row++) {
+    guint64 line_offset =
+        (filter->ignored_lines + row * filter->block_height) * stride;
+    guint block_score;
+
+    /* another job already found the frame to be combed */
+    if (g_atomic_int_get (&filter->combed))
+      return;
+
+    block_score =
+        filter->block_score_for_row (filter, job->history,
+        job->base_fj + line_offset, job->base_fjp1 + line_offset,
+        job->comb_mask, job->block_scores);
+
+    if (block_score > (block_thresh >> 1)
+        && block_score <= block_thresh) {
+      /* blend if nothing more combed comes along */
+      job->slightly_combed = TRUE;
+    } else if (block_score > block_thresh) {
+      g_atomic_int_set (&filter->combed, TRUE);
+      return;
+    }
   }
+}
 
-  g_free (block_scores);
-  g_free (comb_mask);
-  return block_score;
+static void
+gst_field_analysis_comb_job_func (gpointer data, gpointer user_data)
+{
+  GstFieldAnalysis *filter = user_data;
+
+  gst_field_analysis_run_comb_job (data);
+
+  g_mutex_lock (&filter->jobs_lock);
+  if (--filter->jobs_pending == 0)
+    g_cond_signal (&filter->jobs_cond);
+  g_mutex_unlock (&filter->jobs_lock);
+}
+
+/* make sure there is comb mask and block score space for n_jobs jobs */
+static void
+gst_field_analysis_ensure_scratch (GstFieldAnalysis * filter, guint n_jobs,
+    gint width)
+{
+  gsize mask_size = n_jobs * width;
+  gsize scores_size = n_jobs * (width / filter->block_width);
+
+  if (mask_size > filter->comb_mask_size) {
+    filter->comb_mask = g_realloc (filter->comb_mask, mask_size);
+    filter->comb_mask_size = mask_size;
+  }
+  if (scores_size > filter->block_scores_size) {
+    filter->block_scores =
+        g_realloc (filter->block_scores, scores_size * sizeof (guint));
+    filter->block_scores_size = scores_size;
+  }
 }
 
 /* a pass is made over the field using one of three comb-detection metrics
@@ -1327,18 +1416,20 @@ block_score_for_row_5_tap (GstFieldAnalysis * filter,
    score is between half the threshold and the threshold, the block is
    slightly combed. if when analysis is complete, slight combing is detected
    that is returned. if any results are observed that are above the threshold,
-   the function returns immediately */
+   the function returns immediately. the rows of blocks are split between
+   n-threads jobs, one of which runs on the streaming thread */
 /* 0th field's parity defines operation */
 static gfloat
 opposite_parity_windowed_comb (GstFieldAnalysis * filter,
     FieldAnalysisFields (*history)[2])
 {
-  gint j;
+  gint i, n_rows, n_jobs, rows_per_job;
   gboolean slightly_combed;
+  FieldAnalysisCombJob *jobs;
 
+  const gint width = GST_VIDEO_FRAME_WIDTH (&(*history)[0].frame);
   const gint height = GST_VIDEO_FRAME_HEIGHT (&(*history)[0].frame);
-  const gint stride = GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0);
-  const guint64 block_thresh = filter->block_thresh;
+  const gsize n_blocks = width / filter->block_width;
   const guint64 block_height = filter->block_height;
   guint8 *base_fj, *base_fjp1;
 
@@ -1360,32 +1451,101 @@ opposite_parity_windowed_comb (GstFieldAnalysis * filter,
         0) + GST_VIDEO_FRAME_COMP_STRIDE (&(*history)[0].frame, 0);
   }
 
-  /* we operate on a row of blocks of height block_height through each iteration */
-  slightly_combed = FALSE;
-  for (j = 0; j <= height - filter->ignored_lines - block_height;
-      j += block_height) {
-    guint64 line_offset = (filter->ignored_lines + j) * stride;
-    guint block_score =
-        filter->block_score_for_row (filter, history, base_fj + line_offset,
-        base_fjp1 + line_offset);
+  /* we operate on a row of blocks of height block_height through each
+   * iteration */
+  if (block_height == 0 || height < filter->ignored_lines + block_height)
+    return 0.0f;
+  n_rows = (height - filter->ignored_lines - block_height) / block_height + 1;
+
+  n_jobs = CLAMP (filter->n_threads, 1, n_rows);
+  rows_per_job = (n_rows + n_jobs - 1) / n_jobs;
+  n_jobs = (n_rows + rows_per_job - 1) / rows_per_job;
+
+  gst_field_analysis_ensure_scratch (filter, n_jobs, width);
+
+  jobs = g_newa (FieldAnalysisCombJob, n_jobs);
+  for (i = 0; i < n_jobs; i++) {
+    jobs[i].filter = filter;
+    jobs[i].history = history;
+    jobs[i].base_fj = base_fj;
+    jobs[i].base_fjp1 = base_fjp1;
+    jobs[i].comb_mask = filter->comb_mask + i * width;
+    jobs[i].block_scores = filter->block_scores + i * n_blocks;
+    jobs[i].first_row = i * rows_per_job;
+    jobs[i].last_row = MIN (n_rows, (i + 1) * rows_per_job);
+    jobs[i].slightly_combed = FALSE;
+  }
 
-    if (block_score > (block_thresh >> 1)
-        && block_score <= block_thresh) {
-      /* blend if nothing more combed comes along */
-      slightly_combed = TRUE;
-    } else if (block_score > block_thresh) {
-      if (GST_VIDEO_INFO_INTERLACE_MODE (&(*history)[0].frame.info) ==
-          GST_VIDEO_INTERLACE_MODE_INTERLEAVED) {
-        return 1.0f;            /* blend */
-      } else {
-        return 2.0f;            /* deinterlace */
-      }
+  g_atomic_int_set (&filter->combed, FALSE);
+
+  if (n_jobs > 1) {
+    if (!filter->pool) {
+      filter->pool =
+          g_thread_pool_new (gst_field_analysis_comb_job_func, filter,
+          n_jobs - 1, FALSE, NULL);
+    } else if (g_thread_pool_get_max_threads (filter->pool) < n_jobs - 1) {
+      g_thread_pool_set_max_threads (filter->pool, n_jobs - 1, NULL);
+    }
+
+    filter->jobs_pending = n_jobs - 1;
+    for (i = 1; i < n_jobs; i++)
+      g_thread_pool_push (filter->pool, &jobs[i], NULL);
+  }
+
+  gst_field_analysis_run_comb_job (&jobs[0]);
+
+  if (n_jobs > 1) {
+    g_mutex_lock (&filter->jobs_lock);
+    while (filter->jobs_pending > 0)
+      g_cond_wait (&filter->jobs_cond, &filter->jobs_lock);
+    g_mutex_unlock (&filter->jobs_lock);
+  }
+
+  if (g_atomic_int_get (&filter->combed)) {
+    if (GST_VIDEO_INFO_INTERLACE_MODE (&(*history)[0].frame.info) ==
+        GST_VIDEO_INTERLACE_MODE_INTERLEAVED) {
+      return 1.0f;              /* blend */
+    } else {
+      return 2.0f;              /* deinterlace */
     }
   }
 
+  slightly_combed = FALSE;
+  for (i = 0; i < n_jobs; i++)
+    slightly_combed |= jobs[i].slightly_combed;
+
   return (gfloat) slightly_combed;      /* TRUE means blend, else don't */
 }
 
+/* when row decimation is enabled, a metric is first computed on every
+ * row_decimation-th field line. only if the result is close enough to the
+ * decision threshold to be ambiguous is it recomputed at full resolution */
+#define FIELD_ANALYSIS_AMBIGUITY_FACTOR 2.0f
+
+static gfloat
+gst_field_analysis_decimated_score (GstFieldAnalysis * filter,
+    gfloat (*metric) (GstFieldAnalysis *, FieldAnalysisFields (*)[2]),
+    FieldAnalysisFields (*history)[2], gfloat thresh)
+{
+  gfloat score;
+
+  /* windowed comb detection gives a decision, not a score to refine */
+  if (filter->row_decimation > 1 && metric != &opposite_parity_windowed_comb) {
+    filter->row_step = filter->row_decimation;
+    score = metric (filter, history);
+    filter->row_step = 1;
+
+    if (score < thresh / FIELD_ANALYSIS_AMBIGUITY_FACTOR
+        || score > thresh * FIELD_ANALYSIS_AMBIGUITY_FACTOR)
+      return score;
+
+    GST_LOG_OBJECT (filter, "Decimated score %f ambiguous for threshold %f, "
+        "refining", score, thresh);
+  }
+
+  return metric (filter, history);
+}
+
 /* this is where the magic happens
  *
  * the buffer incoming to the chain function (buf_to_queue) is added to the
@@ -1443,7 +1603,9 @@ gst_field_analysis_process_buffer (GstFieldAnalysis * filter,
     history[1].parity = BOTTOM_FIELD;
     /* compare the fields within the buffer, if the buffer exhibits combing it
      * could be interlaced or a mixed telecine frame */
-    res0->f = filter->same_frame (filter, &history);
+    res0->f =
+        gst_field_analysis_decimated_score (filter, filter->same_frame,
+        &history, filter->frame_thresh);
     res0->t = res0->b = res0->t_b = res0->b_t = G_MAXINT64;
     if (filter->nframes == 1)
       GST_DEBUG_OBJECT (filter, "Scores: f %f, t , b , t_b , b_t ", res0->f);
@@ -1466,19 +1628,27 @@ gst_field_analysis_process_buffer (GstFieldAnalysis * filter,
     /* compare the top and bottom fields to the previous frame */
     history[0].parity = TOP_FIELD;
     history[1].parity = TOP_FIELD;
-    res0->t = filter->same_field (filter, &history);
+    res0->t =
+        gst_field_analysis_decimated_score (filter, filter->same_field,
+        &history, filter->field_thresh);
     history[0].parity = BOTTOM_FIELD;
     history[1].parity = BOTTOM_FIELD;
-    res0->b = filter->same_field (filter, &history);
+    res0->b =
+        gst_field_analysis_decimated_score (filter, filter->same_field,
+        &history, filter->field_thresh);
 
     /* compare the top field from this frame to the bottom of the previous for
      * for combing (and vice versa) */
     history[0].parity = TOP_FIELD;
     history[1].parity = BOTTOM_FIELD;
-    res0->t_b = filter->same_frame (filter, &history);
+    res0->t_b =
+        gst_field_analysis_decimated_score (filter, filter->same_frame,
+        &history, filter->frame_thresh);
     history[0].parity = BOTTOM_FIELD;
     history[1].parity = TOP_FIELD;
-    res0->b_t = filter->same_frame (filter, &history);
+    res0->b_t =
+        gst_field_analysis_decimated_score (filter, filter->same_frame,
+        &history, filter->frame_thresh);
 
     GST_DEBUG_OBJECT (filter,
         "Scores: f %f, t %f, b %f, t_b %f, b_t %f", res0->f,
@@ -1834,6 +2004,11 @@ gst_field_analysis_finalize (GObject * object)
 
   gst_field_analysis_reset (filter);
 
+  if (filter->pool)
+    g_thread_pool_free (filter->pool, FALSE, TRUE);
+  g_mutex_clear (&filter->jobs_lock);
+  g_cond_clear (&filter->jobs_cond);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -119,13 +119,23 @@ struct _GstFieldAnalysis
   GstVideoInfo vinfo;
   gfloat (*same_field) (GstFieldAnalysis *, FieldAnalysisFields (*)[2]);
   gfloat (*same_frame) (GstFieldAnalysis *, FieldAnalysisFields (*)[2]);
-  guint64 (*block_score_for_row) (GstFieldAnalysis *, FieldAnalysisFields (*)[2], guint8 *, guint8 *);
+  guint64 (*block_score_for_row) (GstFieldAnalysis *, FieldAnalysisFields (*)[2], guint8 *, guint8 *, guint8 *, guint *);
   gboolean is_telecine;
   gboolean first_buffer; /* indicates the first buffer for which a buffer will be output
                           * after a discont or flushing seek */
-  guint8 *comb_mask;
-  guint *block_scores;
+  guint8 *comb_mask;     /* one line of comb mask per comb job */
+  gsize comb_mask_size;
+  guint *block_scores;   /* one row of block scores per comb job */
+  gsize block_scores_size;
   gboolean flushing;     /* indicates whether we are flushing or not */
+  guint row_step;        /* field line step used by the metrics */
+
+  /* row-parallel windowed comb detection */
+  GThreadPool *pool;
+  GMutex jobs_lock;
+  GCond jobs_cond;
+  gint jobs_pending;
+  gint combed;           /* set atomically when a job finds a combed block */
 
   /* properties */
   guint32 noise_floor; /* threshold for the result of a metric to be valid */
@@ -135,6 +145,8 @@ struct _GstFieldAnalysis
   guint64 block_width, block_height; /* width/height of window used for comb clusted detection */
   guint64 block_thresh;
   guint64 ignored_lines;
+  guint row_decimation; /* analyse every nth field line before refining */
+  guint n_threads; /* number of threads used for windowed comb detection */
 };
 
 struct _GstFieldAnalysisClass
@@ -23,6 +23,8 @@
 
 #include "gstgeometrictransform.h"
 #include "geometricmath.h"
+#include "gstgeometrictransformorc.h"
+#include <math.h>
 #include <string.h>
 
 GST_DEBUG_CATEGORY_STATIC (geometric_transform_debug);
@@ -49,7 +51,10 @@ static GstVideoFilterClass *parent_class = NULL;
 enum
 {
   PROP_0,
-  PROP_OFF_EDGE_PIXELS
+  PROP_OFF_EDGE_PIXELS,
+  PROP_INTERPOLATION,
+  PROP_N_THREADS,
+  PROP_ASYNC_REMAP
 };
 
 #define GST_GT_OFF_EDGES_PIXELS_METHOD_TYPE ( \
@@ -74,17 +79,407 @@ gst_geometric_transform_off_edges_pixels_method_get_type (void)
   return method_type;
 }
 
+#define GST_GT_INTERPOLATION_TYPE (gst_geometric_transform_interpolation_get_type())
+static GType
+gst_geometric_transform_interpolation_get_type (void)
+{
+  static GType interpolation_type = 0;
+
+  static const GEnumValue interpolation_types[] = {
+    {GST_GT_INTERPOLATION_NEAREST, "Nearest neighbour", "nearest"},
+    {GST_GT_INTERPOLATION_BILINEAR, "Bilinear", "bilinear"},
+    {0, NULL, NULL}
+  };
+
+  if (!interpolation_type) {
+    interpolation_type =
+        g_enum_register_static ("GstGeometricTransformInterpolation",
+        interpolation_types);
+  }
+  return interpolation_type;
+}
+
 #define DEFAULT_OFF_EDGE_PIXELS GST_GT_OFF_EDGES_PIXELS_IGNORE
+#define DEFAULT_INTERPOLATION GST_GT_INTERPOLATION_NEAREST
+#define DEFAULT_N_THREADS 1
+#define DEFAULT_ASYNC_REMAP FALSE
+
+typedef struct _GstGeometricTransformSettings GstGeometricTransformSettings;
+typedef struct _GstGeometricTransformJob GstGeometricTransformJob;
+typedef void (*GstGeometricTransformJobFunc) (GstGeometricTransformJob * job);
+
+/* what sampling a frame reads from the element, copied under the object
+ * lock so that the frame can be sampled without holding it */
+struct _GstGeometricTransformSettings
+{
+  gint width, height;
+  GstVideoFormat format;
+  gint pixel_stride;
+  gint row_stride;
+  gint interpolation;
+  guint n_threads;
+};
+
+/* a band of rows, processed by one thread */
+struct _GstGeometricTransformJob
+{
+  GstGeometricTransform *gt;
+  const GstGeometricTransformSettings *settings;
+  GstGeometricTransformJobFunc func;
+  GstGeometricTransformMapEntry *map;
+  const guint8 *in_data;
+  guint8 *out_data;
+  gint first_row;
+  gint last_row;
+  gboolean ret;
+};
+
+/* must be called with the object lock */
+static void
+gst_geometric_transform_get_settings (GstGeometricTransform * gt,
+    GstGeometricTransformSettings * settings)
+{
+  settings->width = gt->width;
+  settings->height = gt->height;
+  settings->format = gt->format;
+  settings->pixel_stride = gt->pixel_stride;
+  settings->row_stride = gt->row_stride;
+  settings->interpolation = gt->interpolation;
+  settings->n_threads = gt->n_threads;
+}
+
+/* must be called with the object lock */
+static void
+gst_geometric_transform_make_entry (GstGeometricTransform * gt,
+    gdouble in_x, gdouble in_y, GstGeometricTransformMapEntry * entry)
+{
+  gint x0, y0;
+  gdouble fx = 0.0, fy = 0.0;
+
+  /* operate on out of edge pixels */
+  switch (gt->off_edge_pixels) {
+    case GST_GT_OFF_EDGES_PIXELS_CLAMP:
+      in_x = CLAMP (in_x, 0, gt->width - 1);
+      in_y = CLAMP (in_y, 0, gt->height - 1);
+      break;
+
+    case GST_GT_OFF_EDGES_PIXELS_WRAP:
+      in_x = mod_float (in_x, gt->width);
+      in_y = mod_float (in_y, gt->height);
+      if (in_x < 0)
+        in_x += gt->width;
+      if (in_y < 0)
+        in_y += gt->height;
+      break;
+
+    default:
+      break;
+  }
+
+  if (gt->interpolation == GST_GT_INTERPOLATION_BILINEAR) {
+    x0 = (gint) floor (in_x);
+    y0 = (gint) floor (in_y);
+    fx = in_x - x0;
+    fy = in_y - y0;
+    /* like with truncation, positions less than a pixel before the first
+     * column or row still map onto it */
+    if (x0 == -1) {
+      x0 = 0;
+      fx = 0.0;
+    }
+    if (y0 == -1) {
+      y0 = 0;
+      fy = 0.0;
+    }
+  } else {
+    x0 = (gint) in_x;
+    y0 = (gint) in_y;
+  }
+
+  /* only set the values if the values are valid */
+  if (x0 < 0 || x0 >= gt->width || y0 < 0 || y0 >= gt->height) {
+    entry->offset = -1;
+    entry->fx = entry->fy = 0;
+    return;
+  }
+
+  /* the last column and row have no neighbours to blend with */
+  if (x0 + 1 >= gt->width)
+    fx = 0.0;
+  if (y0 + 1 >= gt->height)
+    fy = 0.0;
+
+  entry->offset = y0 * gt->row_stride + x0 * gt->pixel_stride;
+  entry->fx = (guint8) (fx * (1 << GST_GT_WEIGHT_BITS));
+  entry->fy = (guint8) (fy * (1 << GST_GT_WEIGHT_BITS));
+}
 
 /* must be called with the object lock */
 static gboolean
-gst_geometric_transform_generate_map (GstGeometricTransform * gt)
+gst_geometric_transform_map_row (GstGeometricTransform * gt,
+    GstGeometricTransformMapEntry * entries, gint y)
 {
-  gint x, y;
+  GstGeometricTransformClass *klass = GST_GEOMETRIC_TRANSFORM_GET_CLASS (gt);
   gdouble in_x, in_y;
+  gint x;
+
+  for (x = 0; x < gt->width; x++) {
+    if (!klass->map_func (gt, x, y, &in_x, &in_y)) {
+      GST_WARNING_OBJECT (gt, "Failed to do mapping for %d %d", x, y);
+      return FALSE;
+    }
+    gst_geometric_transform_make_entry (gt, in_x, in_y, &entries[x]);
+  }
+
+  return TRUE;
+}
+
+static inline guint
+gst_geometric_transform_read_gray16 (const guint8 * p, gboolean big_endian)
+{
+  return big_endian ? GST_READ_UINT16_BE (p) : GST_READ_UINT16_LE (p);
+}
+
+static void
+gst_geometric_transform_sample_row_gray16 (const GstGeometricTransformSettings
+    * s, const GstGeometricTransformMapEntry * entries, const guint8 * in_data,
+    guint8 * out)
+{
+  const gboolean big_endian = s->format == GST_VIDEO_FORMAT_GRAY16_BE;
+  const gint one = 1 << GST_GT_WEIGHT_BITS;
+  gint x;
+
+  for (x = 0; x < s->width; x++) {
+    const GstGeometricTransformMapEntry *e = &entries[x];
+    const guint8 *p;
+    gint dx, dy, tl, tr, bl, br, top, bottom;
+    guint v;
+
+    if (e->offset < 0)
+      continue;
+
+    p = in_data + e->offset;
+    dx = e->fx ? 2 : 0;
+    dy = e->fy ? s->row_stride : 0;
+    tl = gst_geometric_transform_read_gray16 (p, big_endian);
+    tr = gst_geometric_transform_read_gray16 (p + dx, big_endian);
+    bl = gst_geometric_transform_read_gray16 (p + dy, big_endian);
+    br = gst_geometric_transform_read_gray16 (p + dx + dy, big_endian);
+
+    top = tl * one + (tr - tl) * e->fx;
+    bottom = bl * one + (br - bl) * e->fx;
+    v = (top * one + (bottom - top) * e->fy) >> (2 * GST_GT_WEIGHT_BITS);
+
+    if (big_endian)
+      GST_WRITE_UINT16_BE (out + 2 * x, v);
+    else
+      GST_WRITE_UINT16_LE (out + 2 * x, v);
+  }
+}
+
+/* scratch must hold 6 rows of pixels for bilinear interpolation of 8 bit
+ * formats */
+static void
+gst_geometric_transform_sample_row (const GstGeometricTransformSettings * s,
+    const GstGeometricTransformMapEntry * entries, const guint8 * in_data,
+    guint8 * out, guint8 * scratch)
+{
+  const gint ps = s->pixel_stride;
+  const gint n = s->width * ps;
+  guint8 *tl, *tr, *bl, *br, *wx, *wy;
+  gint x;
+
+  if (s->interpolation == GST_GT_INTERPOLATION_NEAREST) {
+    for (x = 0; x < s->width; x++) {
+      if (entries[x].offset >= 0)
+        memcpy (out + x * ps, in_data + entries[x].offset, ps);
+    }
+    return;
+  }
+
+  if (s->format == GST_VIDEO_FORMAT_GRAY16_LE ||
+      s->format == GST_VIDEO_FORMAT_GRAY16_BE) {
+    gst_geometric_transform_sample_row_gray16 (s, entries, in_data, out);
+    return;
+  }
+
+  /* gather the four neighbours and the weights of every byte of the row,
+   * then blend the whole row with one orc call */
+  tl = scratch;
+  tr = tl + n;
+  bl = tr + n;
+  br = bl + n;
+  wx = br + n;
+  wy = wx + n;
+
+  for (x = 0; x < s->width; x++) {
+    const GstGeometricTransformMapEntry *e = &entries[x];
+    const gint o = x * ps;
+
+    if (e->offset >= 0) {
+      const guint8 *p = in_data + e->offset;
+      const gint dx = e->fx ? ps : 0;
+      const gint dy = e->fy ? s->row_stride : 0;
+
+      memcpy (tl + o, p, ps);
+      memcpy (tr + o, p + dx, ps);
+      memcpy (bl + o, p + dy, ps);
+      memcpy (br + o, p + dx + dy, ps);
+      memset (wx + o, e->fx, ps);
+      memset (wy + o, e->fy, ps);
+    } else {
+      /* keep the background the output was cleared to */
+      memcpy (tl + o, out + o, ps);
+      memcpy (tr + o, out + o, ps);
+      memcpy (bl + o, out + o, ps);
+      memcpy (br + o, out + o, ps);
+      memset (wx + o, 0, ps);
+      memset (wy + o, 0, ps);
+    }
+  }
+
+  geometric_transform_orc_blend_bilinear_u8 (out, tl, tr, bl, br, wx, wy, n);
+}
+
+static void
+gst_geometric_transform_generate_job (GstGeometricTransformJob * job)
+{
+  GstGeometricTransform *gt = job->gt;
+  const gint width = job->settings->width;
+  gint y;
+
+  for (y = job->first_row; y < job->last_row; y++) {
+    if (!gst_geometric_transform_map_row (gt, job->map + y * width, y)) {
+      job->ret = FALSE;
+      return;
+    }
+  }
+}
+
+/* samples the output rows of the band, using the precalculated map if
+ * there is one and calling the map function otherwise.  Only the map
+ * function needs the object lock */
+static void
+gst_geometric_transform_sample_job (GstGeometricTransformJob * job)
+{
+  GstGeometricTransform *gt = job->gt;
+  const GstGeometricTransformSettings *s = job->settings;
+  GstGeometricTransformMapEntry *row_map = NULL;
+  guint8 *scratch = NULL;
+  gint y;
+
+  if (job->map == NULL)
+    row_map = g_new (GstGeometricTransformMapEntry, s->width);
+  if (s->interpolation == GST_GT_INTERPOLATION_BILINEAR)
+    scratch = g_malloc (6 * s->width * s->pixel_stride);
+
+  for (y = job->first_row; y < job->last_row; y++) {
+    const GstGeometricTransformMapEntry *entries;
+
+    if (job->map) {
+      entries = job->map + y * s->width;
+    } else {
+      if (!gst_geometric_transform_map_row (gt, row_map, y)) {
+        job->ret = FALSE;
+        break;
+      }
+      entries = row_map;
+    }
+
+    gst_geometric_transform_sample_row (s, entries, job->in_data,
+        job->out_data + y * s->row_stride, scratch);
+  }
+
+  g_free (row_map);
+  g_free (scratch);
+}
+
+static void
+gst_geometric_transform_job_func (gpointer data, gpointer user_data)
+{
+  GstGeometricTransformJob *job = data;
+  GstGeometricTransform *gt = user_data;
+
+  job->func (job);
+
+  g_mutex_lock (&gt->jobs_lock);
+  if (--gt->jobs_pending == 0)
+    g_cond_signal (&gt->jobs_cond);
+  g_mutex_unlock (&gt->jobs_lock);
+}
+
+/* splits the rows of settings into n-threads bands, one of which is
+ * processed on the calling thread.  The map function is called from all of
+ * them, so it must not depend on being called in order.
+ *
+ * only called from the streaming thread, and with the object lock whenever
+ * the jobs call the map function */
+static gboolean
+gst_geometric_transform_run_jobs (GstGeometricTransform * gt,
+    const GstGeometricTransformSettings * settings,
+    GstGeometricTransformJobFunc func, GstGeometricTransformMapEntry * map,
+    const guint8 * in_data, guint8 * out_data)
+{
+  GstGeometricTransformJob *jobs;
+  gint i, n_jobs, rows_per_job;
   gboolean ret = TRUE;
+
+  if (settings->height <= 0)
+    return TRUE;
+
+  n_jobs = CLAMP (settings->n_threads, 1, settings->height);
+  rows_per_job = (settings->height + n_jobs - 1) / n_jobs;
+  n_jobs = (settings->height + rows_per_job - 1) / rows_per_job;
+
+  jobs = g_newa (GstGeometricTransformJob, n_jobs);
+  for (i = 0; i < n_jobs; i++) {
+    jobs[i].gt = gt;
+    jobs[i].settings = settings;
+    jobs[i].func = func;
+    jobs[i].map = map;
+    jobs[i].in_data = in_data;
+    jobs[i].out_data = out_data;
+    jobs[i].first_row = i * rows_per_job;
+    jobs[i].last_row = MIN (settings->height, (i + 1) * rows_per_job);
+    jobs[i].ret = TRUE;
+  }
+
+  if (n_jobs > 1) {
+    if (!gt->pool) {
+      gt->pool =
+          g_thread_pool_new (gst_geometric_transform_job_func, gt,
+          n_jobs - 1, FALSE, NULL);
+    } else if (g_thread_pool_get_max_threads (gt->pool) < n_jobs - 1) {
+      g_thread_pool_set_max_threads (gt->pool, n_jobs - 1, NULL);
+    }
+
+    gt->jobs_pending = n_jobs - 1;
+    for (i = 1; i < n_jobs; i++)
+      g_thread_pool_push (gt->pool, &jobs[i], NULL);
+  }
+
+  func (&jobs[0]);
+
+  if (n_jobs > 1) {
+    g_mutex_lock (&gt->jobs_lock);
+    while (gt->jobs_pending > 0)
+      g_cond_wait (&gt->jobs_cond, &gt->jobs_lock);
+    g_mutex_unlock (&gt->jobs_lock);
+  }
+
+  for (i = 0; i < n_jobs; i++)
+    ret &= jobs[i].ret;
+
+  return ret;
+}
+
+/* must be called with the object lock */
+static gboolean
+gst_geometric_transform_generate_map (GstGeometricTransform * gt)
+{
   GstGeometricTransformClass *klass;
-  gdouble *ptr;
+  GstGeometricTransformSettings settings;
+  GstGeometricTransformMapEntry *map;
 
   GST_INFO_OBJECT (gt, "Generating new transform map");
 
@@ -92,39 +487,98 @@ gst_geometric_transform_generate_map (GstGeometricTransform * gt)
   g_free (gt->map);
   gt->map = NULL;
 
+  gst_geometric_transform_get_settings (gt, &settings);
+
   klass = GST_GEOMETRIC_TRANSFORM_GET_CLASS (gt);
 
   /* subclass must have defined the map_func */
   g_return_val_if_fail (klass->map_func, FALSE);
 
-  /*
-   * (x,y) pairs of the inverse mapping
-   */
-  gt->map = g_malloc0 (sizeof (gdouble) * gt->width * gt->height * 2);
-  ptr = gt->map;
-
-  for (y = 0; y < gt->height; y++) {
-    for (x = 0; x < gt->width; x++) {
-      if (!klass->map_func (gt, x, y, &in_x, &in_y)) {
-        /* child should have warned */
-        ret = FALSE;
-        goto end;
+  map = g_new (GstGeometricTransformMapEntry, gt->width * gt->height);
+
+  if (!gst_geometric_transform_run_jobs (gt, &settings,
+          gst_geometric_transform_generate_job, map, NULL, NULL)) {
+    GST_WARNING_OBJECT (gt, "Generating transform map failed");
+    g_free (map);
+    return FALSE;
+  }
+
+  gt->map = map;
+  gt->needs_remap = FALSE;
+  return TRUE;
+}
+
+/* Regenerates the map one row at a time while the streaming thread keeps
+ * using the old one, so that animated properties don't stall the stream.
+ * The object lock is released between the rows, and generation starts
+ * over when the mapping changes again before it is complete.  needs_remap
+ * is only cleared once a new map is in place; if generating it fails the
+ * old map is dropped, so that the streaming thread regenerates it itself
+ * and reports the error.  A map the streaming thread is still sampling
+ * with is left for it to free. */
+static gpointer
+gst_geometric_transform_remap_thread (gpointer data)
+{
+  GstGeometricTransform *gt = data;
+  GstGeometricTransformClass *klass = GST_GEOMETRIC_TRANSFORM_GET_CLASS (gt);
+  GstGeometricTransformMapEntry *map;
+  gint y, width, height;
+  gboolean failed;
+  guint cookie;
+
+  GST_OBJECT_LOCK (gt);
+  while (!gt->remap_stopping) {
+    if (!gt->needs_remap || gt->map == NULL) {
+      g_cond_wait (&gt->remap_cond, GST_OBJECT_GET_LOCK (gt));
+      continue;
+    }
+
+    GST_DEBUG_OBJECT (gt, "Generating new transform map in the background");
+
+    cookie = gt->remap_cookie;
+    failed = FALSE;
+
+    if (klass->prepare_func && !klass->prepare_func (gt)) {
+      failed = TRUE;
+    } else {
+      width = gt->width;
+      height = gt->height;
+      map = g_new (GstGeometricTransformMapEntry, width * height);
+
+      for (y = 0; y < height; y++) {
+        if (!gst_geometric_transform_map_row (gt, map + y * width, y)) {
+          failed = TRUE;
+          break;
+        }
+
+        GST_OBJECT_UNLOCK (gt);
+        GST_OBJECT_LOCK (gt);
+
+        if (gt->remap_cookie != cookie || gt->remap_stopping ||
+            gt->map == NULL || gt->width != width || gt->height != height)
+          break;
       }
 
-      ptr[0] = in_x;
-      ptr[1] = in_y;
-      ptr += 2;
+      if (y == height) {
+        if (gt->map != gt->sampling_map)
+          g_free (gt->map);
+        gt->map = map;
+        gt->needs_remap = FALSE;
+        continue;
+      }
+      g_free (map);
+    }
+
+    if (failed) {
+      GST_WARNING_OBJECT (gt, "Generating transform map failed");
+      if (gt->map != gt->sampling_map)
+        g_free (gt->map);
+      gt->map = NULL;
     }
   }
+  GST_OBJECT_UNLOCK (gt);
 
-end:
-  if (!ret) {
-    GST_WARNING_OBJECT (gt, "Generating transform map failed");
-    g_free (gt->map);
-    gt->map = NULL;
-  } else
-    gt->needs_remap = FALSE;
-  return ret;
+  return NULL;
 }
 
 static gboolean
@@ -135,23 +589,29 @@ gst_geometric_transform_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
   gboolean ret = TRUE;
   gint old_width;
   gint old_height;
+  gint old_row_stride;
+  GstVideoFormat old_format;
   GstGeometricTransformClass *klass;
 
   gt = GST_GEOMETRIC_TRANSFORM_CAST (vfilter);
   klass = GST_GEOMETRIC_TRANSFORM_GET_CLASS (gt);
 
+  GST_OBJECT_LOCK (gt);
   old_width = gt->width;
   old_height = gt->height;
+  old_row_stride = gt->row_stride;
+  old_format = gt->format;
 
   gt->width = in_info->width;
   gt->height = in_info->height;
+  gt->format = GST_VIDEO_INFO_FORMAT (in_info);
   gt->row_stride = in_info->stride[0];
   gt->pixel_stride = GST_VIDEO_INFO_COMP_PSTRIDE (in_info, 0);
 
-  /* regenerate the map */
-  GST_OBJECT_LOCK (gt);
+  /* regenerate the map, it holds byte offsets for the current layout */
   if (gt->map == NULL || old_width == 0 || old_height == 0
-      || gt->width != old_width || gt->height != old_height) {
+      || gt->width != old_width || gt->height != old_height
+      || gt->row_stride != old_row_stride || gt->format != old_format) {
     if (klass->prepare_func)
       if (!klass->prepare_func (gt)) {
         GST_OBJECT_UNLOCK (gt);
@@ -164,48 +624,6 @@ gst_geometric_transform_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
   return ret;
 }
 
-static void
-gst_geometric_transform_do_map (GstGeometricTransform * gt, guint8 * in_data,
-    guint8 * out_data, gint x, gint y, gdouble in_x, gdouble in_y)
-{
-  gint in_offset;
-  gint out_offset;
-
-  out_offset = y * gt->row_stride + x * gt->pixel_stride;
-
-  /* operate on out of edge pixels */
-  switch (gt->off_edge_pixels) {
-    case GST_GT_OFF_EDGES_PIXELS_CLAMP:
-      in_x = CLAMP (in_x, 0, gt->width - 1);
-      in_y = CLAMP (in_y, 0, gt->height - 1);
-      break;
-
-    case GST_GT_OFF_EDGES_PIXELS_WRAP:
-      in_x = mod_float (in_x, gt->width);
-      in_y = mod_float (in_y, gt->height);
-      if (in_x < 0)
-        in_x += gt->width;
-      if (in_y < 0)
-        in_y += gt->height;
-      break;
-
-    default:
-      break;
-  }
-
-  {
-    gint trunc_x = (gint) in_x;
-    gint trunc_y = (gint) in_y;
-    /* only set the values if the values are valid */
-    if (trunc_x >= 0 && trunc_x < gt->width && trunc_y >= 0 &&
-        trunc_y < gt->height) {
-      in_offset = trunc_y * gt->row_stride + trunc_x * gt->pixel_stride;
-
-      memcpy (out_data + out_offset, in_data + in_offset, gt->pixel_stride);
-    }
-  }
-}
-
 static void
 gst_geometric_transform_before_transform (GstBaseTransform * trans,
     GstBuffer * outbuf)
@@ -229,9 +647,10 @@ gst_geometric_transform_transform_frame (GstVideoFilter * vfilter,
 {
   GstGeometricTransform *gt;
   GstGeometricTransformClass *klass;
-  gint x, y, i;
+  GstGeometricTransformSettings settings;
+  GstGeometricTransformMapEntry *map;
+  gint i;
   GstFlowReturn ret = GST_FLOW_OK;
-  gdouble *ptr;
   guint8 *in_data;
   guint8 *out_data;
 
@@ -253,39 +672,47 @@ gst_geometric_transform_transform_frame (GstVideoFilter * vfilter,
 
   GST_OBJECT_LOCK (gt);
   if (gt->precalc_map) {
-    if (gt->needs_remap) {
+    if (gt->needs_remap && gt->async_remap && gt->map != NULL) {
+      /* keep using the current map until the new one is ready */
+      if (!gt->remap_thread) {
+        gt->remap_stopping = FALSE;
+        gt->remap_thread = g_thread_new ("geometrictransform-remap",
+            gst_geometric_transform_remap_thread, gt);
+      }
+      g_cond_signal (&gt->remap_cond);
+    } else if (gt->needs_remap) {
       if (klass->prepare_func)
         if (!klass->prepare_func (gt)) {
-          ret = FALSE;
+          ret = GST_FLOW_ERROR;
           goto end;
         }
       gst_geometric_transform_generate_map (gt);
     }
-    g_return_val_if_fail (gt->map, GST_FLOW_ERROR);
-    ptr = gt->map;
-    for (y = 0; y < gt->height; y++) {
-      for (x = 0; x < gt->width; x++) {
-        /* do the mapping */
-        gst_geometric_transform_do_map (gt, in_data, out_data, x, y, ptr[0],
-            ptr[1]);
-        ptr += 2;
-      }
+    if (gt->map == NULL) {
+      GST_WARNING_OBJECT (gt, "No transform map");
+      ret = GST_FLOW_ERROR;
+      goto end;
     }
+
+    /* sample without the lock, the remap thread leaves the map alone until
+     * we are done with it */
+    gst_geometric_transform_get_settings (gt, &settings);
+    map = gt->sampling_map = gt->map;
+    GST_OBJECT_UNLOCK (gt);
+
+    gst_geometric_transform_run_jobs (gt, &settings,
+        gst_geometric_transform_sample_job, map, in_data, out_data);
+
+    GST_OBJECT_LOCK (gt);
+    if (gt->map != map)
+      g_free (map);
+    gt->sampling_map = NULL;
   } else {
-    for (y = 0; y < gt->height; y++) {
-      for (x = 0; x < gt->width; x++) {
-        gdouble in_x, in_y;
-
-        if (klass->map_func (gt, x, y, &in_x, &in_y)) {
-          gst_geometric_transform_do_map (gt, in_data, out_data, x, y, in_x,
-              in_y);
-        } else {
-          GST_WARNING_OBJECT (gt, "Failed to do mapping for %d %d", x, y);
-          ret = GST_FLOW_ERROR;
-          goto end;
-        }
-      }
-    }
+    /* the map function is called while sampling */
+    gst_geometric_transform_get_settings (gt, &settings);
+    if (!gst_geometric_transform_run_jobs (gt, &settings,
+            gst_geometric_transform_sample_job, NULL, in_data, out_data))
+      ret = GST_FLOW_ERROR;
   }
 end:
   GST_OBJECT_UNLOCK (gt);
@@ -304,6 +731,23 @@ gst_geometric_transform_set_property (GObject * object, guint prop_id,
     case PROP_OFF_EDGE_PIXELS:
       GST_OBJECT_LOCK (gt);
       gt->off_edge_pixels = g_value_get_enum (value);
+      gst_geometric_transform_set_need_remap (gt);
+      GST_OBJECT_UNLOCK (gt);
+      break;
+    case PROP_INTERPOLATION:
+      GST_OBJECT_LOCK (gt);
+      gt->interpolation = g_value_get_enum (value);
+      gst_geometric_transform_set_need_remap (gt);
+      GST_OBJECT_UNLOCK (gt);
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (gt);
+      gt->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (gt);
+      break;
+    case PROP_ASYNC_REMAP:
+      GST_OBJECT_LOCK (gt);
+      gt->async_remap = g_value_get_boolean (value);
       GST_OBJECT_UNLOCK (gt);
       break;
     default:
@@ -324,17 +768,50 @@ gst_geometric_transform_get_property (GObject * object, guint prop_id,
     case PROP_OFF_EDGE_PIXELS:
       g_value_set_enum (value, gt->off_edge_pixels);
       break;
+    case PROP_INTERPOLATION:
+      g_value_set_enum (value, gt->interpolation);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, gt->n_threads);
+      break;
+    case PROP_ASYNC_REMAP:
+      g_value_set_boolean (value, gt->async_remap);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static void
+gst_geometric_transform_finalize (GObject * object)
+{
+  GstGeometricTransform *gt = GST_GEOMETRIC_TRANSFORM_CAST (object);
+
+  if (gt->pool)
+    g_thread_pool_free (gt->pool, FALSE, TRUE);
+  g_mutex_clear (&gt->jobs_lock);
+  g_cond_clear (&gt->jobs_cond);
+  g_cond_clear (&gt->remap_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
 
 static gboolean
 gst_geometric_transform_stop (GstBaseTransform * trans)
 {
   GstGeometricTransform *gt = GST_GEOMETRIC_TRANSFORM_CAST (trans);
+  GThread *remap_thread;
+
+  GST_OBJECT_LOCK (gt);
+  remap_thread = gt->remap_thread;
+  gt->remap_thread = NULL;
+  gt->remap_stopping = TRUE;
+  g_cond_signal (&gt->remap_cond);
+  GST_OBJECT_UNLOCK (gt);
+
+  if (remap_thread)
+    g_thread_join (remap_thread);
 
   GST_INFO_OBJECT (gt, "Deleting transform map");
 
@@ -373,6 +850,7 @@ gst_geometric_transform_class_init (gpointer klass, gpointer class_data)
 
   obj_class->set_property = gst_geometric_transform_set_property;
   obj_class->get_property = gst_geometric_transform_get_property;
+  obj_class->finalize = gst_geometric_transform_finalize;
 
   trans_class->stop = GST_DEBUG_FUNCPTR (gst_geometric_transform_stop);
   trans_class->before_transform =
@@ -388,6 +866,24 @@ gst_geometric_transform_class_init (gpointer klass, gpointer class_data)
           "What to do with off edge pixels",
           GST_GT_OFF_EDGES_PIXELS_METHOD_TYPE, DEFAULT_OFF_EDGE_PIXELS,
           GST_PARAM_CONTROLLABLE | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (obj_class, PROP_INTERPOLATION,
+      g_param_spec_enum ("interpolation", "Interpolation",
+          "How to sample the input between pixels",
+          GST_GT_INTERPOLATION_TYPE, DEFAULT_INTERPOLATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (obj_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads sampling and generating the map in bands of rows",
+          1, 64, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (obj_class, PROP_ASYNC_REMAP,
+      g_param_spec_boolean ("async-remap", "Asynchronous remap",
+          "Keep using the previous map while a new one is generated in the "
+          "background after a property change",
+          DEFAULT_ASYNC_REMAP, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -396,8 +892,15 @@ gst_geometric_transform_init (GTypeInstance * instance, gpointer g_class)
   GstGeometricTransform *gt = GST_GEOMETRIC_TRANSFORM_CAST (instance);
 
   gt->off_edge_pixels = DEFAULT_OFF_EDGE_PIXELS;
+  gt->interpolation = DEFAULT_INTERPOLATION;
+  gt->n_threads = DEFAULT_N_THREADS;
+  gt->async_remap = DEFAULT_ASYNC_REMAP;
   gt->precalc_map = TRUE;
   gt->needs_remap = TRUE;
+
+  g_mutex_init (&gt->jobs_lock);
+  g_cond_init (&gt->jobs_cond);
+  g_cond_init (&gt->remap_cond);
 }
 
 GType
@@ -435,4 +938,6 @@ void
 gst_geometric_transform_set_need_remap (GstGeometricTransform * gt)
 {
   gt->needs_remap = TRUE;
+  gt->remap_cookie++;
+  g_cond_signal (&gt->remap_cond);
 }
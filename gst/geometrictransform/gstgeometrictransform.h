@@ -46,6 +46,15 @@ enum
   GST_GT_OFF_EDGES_PIXELS_WRAP
 };
 
+enum
+{
+  GST_GT_INTERPOLATION_NEAREST = 0,
+  GST_GT_INTERPOLATION_BILINEAR
+};
+
+/* number of fractional bits of the bilinear weights */
+#define GST_GT_WEIGHT_BITS 7
+
 typedef struct _GstGeometricTransform GstGeometricTransform;
 typedef struct _GstGeometricTransformClass GstGeometricTransformClass;
 
@@ -77,6 +86,22 @@ typedef gboolean (*GstGeometricTransformMapFunc) (GstGeometricTransform * gt,
 typedef gboolean (*GstGeometricTransformPrepareFunc) (
     GstGeometricTransform * gt);
 
+/**
+ * GstGeometricTransformMapEntry:
+ * @offset: byte offset of the (top left) input pixel, -1 if the output
+ *   pixel is left untouched
+ * @fx: weight of the pixel right of @offset, in 1/128
+ * @fy: weight of the pixel below @offset, in 1/128
+ *
+ * Fixed point inverse mapping of one output pixel, precalculated for the
+ * current frame layout, off edge pixels and interpolation settings.
+ */
+typedef struct {
+  gint32 offset;
+  guint8 fx;
+  guint8 fy;
+} GstGeometricTransformMapEntry;
+
 /**
  * GstGeometricTransform:
  *
@@ -99,8 +124,27 @@ struct _GstGeometricTransform {
 
   /* properties */
   gint off_edge_pixels;
-
-  gdouble *map;
+  gint interpolation;
+  guint n_threads;
+  gboolean async_remap;
+
+  GstGeometricTransformMapEntry *map;
+  /* the map the streaming thread is sampling with, without the object
+   * lock.  If it is replaced meanwhile, the streaming thread frees it */
+  GstGeometricTransformMapEntry *sampling_map;
+
+  /* helper threads for the bands after the first one */
+  GThreadPool *pool;
+  GMutex jobs_lock;
+  GCond jobs_cond;
+  gint jobs_pending;
+
+  /* regenerates the map in the background with async_remap, protected
+   * by the object lock.  remap_cookie changes with every remap request */
+  GThread *remap_thread;
+  GCond remap_cond;
+  gboolean remap_stopping;
+  guint remap_cookie;
 };
 
 struct _GstGeometricTransformClass {
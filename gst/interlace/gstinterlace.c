@@ -49,6 +49,11 @@
  * This pipeline converts a 24 frames per second progressive film stream into a
  * 30000/1001 2:3:2:3... pattern telecined stream suitable for displaying film
  * content on NTSC.
+ *
+ * Frames that mix fields of two input frames are woven into buffers from
+ * the downstream pool, or into the earlier input frame itself when nothing
+ * else holds a reference to it. With n-threads the fields are copied in
+ * parallel bands of lines.
  * </refsect2>
  */
 
@@ -104,6 +109,15 @@ struct _GstInterlace
   GstClockTime timebase;
   int fields_since_timebase;
   guint pattern_offset;         /* initial offset into the pattern */
+
+  guint n_threads;
+  GstBufferPool *pool;
+
+  /* helper threads for the bands after the first one */
+  GThreadPool *thread_pool;
+  GMutex jobs_lock;
+  GCond jobs_cond;
+  gint jobs_pending;
 };
 
 struct _GstInterlaceClass
@@ -117,9 +131,12 @@ enum
   PROP_TOP_FIELD_FIRST,
   PROP_PATTERN,
   PROP_PATTERN_OFFSET,
-  PROP_ALLOW_RFF
+  PROP_ALLOW_RFF,
+  PROP_N_THREADS
 };
 
+#define DEFAULT_N_THREADS 1
+
 typedef enum
 {
   GST_INTERLACE_PATTERN_1_1,
@@ -167,12 +184,15 @@ gst_interlace_pattern_get_type (void)
   return interlace_pattern_type;
 }
 
+#define INTERLACE_FORMATS \
+    "{AYUV,YUY2,UYVY,I420,YV12,Y42B,Y444,NV12,NV21,v210,I420_10LE," \
+    "I420_10BE,I422_10LE,I422_10BE,Y444_10LE,Y444_10BE}"
+
 static GstStaticPadTemplate gst_interlace_src_template =
 GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE
-        ("{AYUV,YUY2,UYVY,I420,YV12,Y42B,Y444,NV12,NV21}")
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (INTERLACE_FORMATS)
         ",interlace-mode={interleaved,mixed}")
     );
 
@@ -180,8 +200,7 @@ static GstStaticPadTemplate gst_interlace_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE
-        ("{AYUV,YUY2,UYVY,I420,YV12,Y42B,Y444,NV12,NV21}")
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE (INTERLACE_FORMATS)
         ",interlace-mode=progressive")
     );
 
@@ -242,6 +261,11 @@ gst_interlace_class_init (GstInterlaceClass * klass)
           "Allow generation of buffers with RFF flag set, i.e., duration of 3 fields",
           FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (object_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of bands of lines copied in parallel", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (element_class,
       "Interlace filter", "Filter/Video",
       "Creates an interlaced video from progressive frames",
@@ -258,9 +282,26 @@ gst_interlace_class_init (GstInterlaceClass * klass)
 static void
 gst_interlace_finalize (GObject * obj)
 {
+  GstInterlace *interlace = GST_INTERLACE (obj);
+
+  if (interlace->thread_pool)
+    g_thread_pool_free (interlace->thread_pool, FALSE, TRUE);
+  g_mutex_clear (&interlace->jobs_lock);
+  g_cond_clear (&interlace->jobs_cond);
+
   G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
 
+static void
+gst_interlace_release_pool (GstInterlace * interlace)
+{
+  if (interlace->pool) {
+    gst_buffer_pool_set_active (interlace->pool, FALSE);
+    gst_object_unref (interlace->pool);
+    interlace->pool = NULL;
+  }
+}
+
 static void
 gst_interlace_reset (GstInterlace * interlace)
 {
@@ -293,6 +334,11 @@ gst_interlace_init (GstInterlace * interlace)
   interlace->allow_rff = FALSE;
   interlace->pattern = GST_INTERLACE_PATTERN_2_3;
   interlace->pattern_offset = 0;
+  interlace->n_threads = DEFAULT_N_THREADS;
+  interlace->pool = NULL;
+  interlace->thread_pool = NULL;
+  g_mutex_init (&interlace->jobs_lock);
+  g_cond_init (&interlace->jobs_cond);
   gst_interlace_reset (interlace);
 }
 
@@ -366,6 +412,60 @@ gst_interlace_decorate_buffer (GstInterlace * interlace, GstBuffer * buf,
   }
 }
 
+/* Sets up the pool that mixed frames are woven into */
+static void
+gst_interlace_decide_allocation (GstInterlace * interlace, GstCaps * caps)
+{
+  GstBufferPool *pool = NULL;
+  GstAllocator *allocator = NULL;
+  GstAllocationParams params;
+  GstStructure *config;
+  GstQuery *query;
+  guint size, min, max;
+
+  gst_interlace_release_pool (interlace);
+
+  query = gst_query_new_allocation (caps, TRUE);
+  if (!gst_pad_peer_query (interlace->srcpad, query))
+    GST_DEBUG_OBJECT (interlace, "allocation query failed");
+
+  if (gst_query_get_n_allocation_params (query) > 0) {
+    gst_query_parse_nth_allocation_param (query, 0, &allocator, &params);
+  } else {
+    gst_allocation_params_init (&params);
+  }
+
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+    size = MAX (size, interlace->info.size);
+  } else {
+    size = interlace->info.size;
+    min = max = 0;
+  }
+
+  if (pool == NULL)
+    pool = gst_video_buffer_pool_new ();
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, size, min, max);
+  gst_buffer_pool_config_set_allocator (config, allocator, &params);
+  if (gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL))
+    gst_buffer_pool_config_add_option (config,
+        GST_BUFFER_POOL_OPTION_VIDEO_META);
+
+  if (gst_buffer_pool_set_config (pool, config)
+      && gst_buffer_pool_set_active (pool, TRUE)) {
+    interlace->pool = pool;
+  } else {
+    GST_WARNING_OBJECT (interlace, "failed to set up pool, allocating");
+    gst_object_unref (pool);
+  }
+
+  if (allocator)
+    gst_object_unref (allocator);
+  gst_query_unref (query);
+}
+
 static gboolean
 gst_interlace_setcaps (GstInterlace * interlace, GstCaps * caps)
 {
@@ -395,11 +495,13 @@ gst_interlace_setcaps (GstInterlace * interlace, GstCaps * caps)
   gst_caps_set_simple (othercaps, "framerate", GST_TYPE_FRACTION,
       interlace->src_fps_n, interlace->src_fps_d, NULL);
 
+  interlace->info = info;
+
   ret = gst_pad_set_caps (interlace->srcpad, othercaps);
+  if (ret)
+    gst_interlace_decide_allocation (interlace, othercaps);
   gst_caps_unref (othercaps);
 
-  interlace->info = info;
-
   return ret;
 
 caps_error:
@@ -603,64 +705,179 @@ gst_interlace_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
   return ret;
 }
 
+typedef struct
+{
+  GstVideoFrame *dest;
+  GstVideoFrame *src;
+  gint field_index;
+  gint job, n_jobs;
+} GstInterlaceJob;
+
+/* copies this job's share of the lines of one field in every plane */
 static void
-copy_field (GstInterlace * interlace, GstBuffer * dest, GstBuffer * src,
-    int field_index)
+gst_interlace_run_job (GstInterlaceJob * job)
 {
-  GstVideoInfo *info = &interlace->info;
   gint i, j, n_planes;
-  guint8 *d, *s;
-  GstVideoFrame dframe, sframe;
-
-  if (!gst_video_frame_map (&dframe, info, dest, GST_MAP_WRITE))
-    goto dest_map_failed;
-
-  if (!gst_video_frame_map (&sframe, info, src, GST_MAP_READ))
-    goto src_map_failed;
 
-  n_planes = GST_VIDEO_FRAME_N_PLANES (&dframe);
+  n_planes = GST_VIDEO_FRAME_N_PLANES (job->dest);
 
   for (i = 0; i < n_planes; i++) {
-    gint cheight, cwidth;
+    gint cheight, cwidth, n_lines, first, last;
     gint ss, ds;
+    guint8 *d, *s;
 
-    d = GST_VIDEO_FRAME_PLANE_DATA (&dframe, i);
-    s = GST_VIDEO_FRAME_PLANE_DATA (&sframe, i);
+    ds = GST_VIDEO_FRAME_PLANE_STRIDE (job->dest, i);
+    ss = GST_VIDEO_FRAME_PLANE_STRIDE (job->src, i);
 
-    ds = GST_VIDEO_FRAME_PLANE_STRIDE (&dframe, i);
-    ss = GST_VIDEO_FRAME_PLANE_STRIDE (&sframe, i);
+    cheight = GST_VIDEO_FRAME_COMP_HEIGHT (job->dest, i);
+    cwidth = MIN (ABS (ss), ABS (ds));
 
-    d += field_index * ds;
-    s += field_index * ss;
+    n_lines = (cheight - job->field_index + 1) / 2;
+    first = n_lines * job->job / job->n_jobs;
+    last = n_lines * (job->job + 1) / job->n_jobs;
 
-    cheight = GST_VIDEO_FRAME_COMP_HEIGHT (&dframe, i);
-    cwidth = MIN (ABS (ss), ABS (ds));
+    d = GST_VIDEO_FRAME_PLANE_DATA (job->dest, i);
+    s = GST_VIDEO_FRAME_PLANE_DATA (job->src, i);
+    d += (job->field_index + 2 * first) * ds;
+    s += (job->field_index + 2 * first) * ss;
 
-    for (j = field_index; j < cheight; j += 2) {
+    for (j = first; j < last; j++) {
       memcpy (d, s, cwidth);
       d += ds * 2;
       s += ss * 2;
     }
   }
+}
 
-  gst_video_frame_unmap (&dframe);
+static void
+gst_interlace_job_func (gpointer data, gpointer user_data)
+{
+  GstInterlace *interlace = user_data;
+
+  gst_interlace_run_job (data);
+
+  g_mutex_lock (&interlace->jobs_lock);
+  if (--interlace->jobs_pending == 0)
+    g_cond_signal (&interlace->jobs_cond);
+  g_mutex_unlock (&interlace->jobs_lock);
+}
+
+/* splits the field into n-threads bands of lines, one of which is copied
+ * on the streaming thread */
+static void
+copy_field (GstInterlace * interlace, GstVideoFrame * dest,
+    GstVideoFrame * src, int field_index)
+{
+  GstInterlaceJob *jobs;
+  gint i, n_jobs;
+
+  n_jobs = CLAMP (interlace->n_threads, 1,
+      MAX (GST_VIDEO_FRAME_HEIGHT (dest) / 2, 1));
+
+  jobs = g_newa (GstInterlaceJob, n_jobs);
+  for (i = 0; i < n_jobs; i++) {
+    jobs[i].dest = dest;
+    jobs[i].src = src;
+    jobs[i].field_index = field_index;
+    jobs[i].job = i;
+    jobs[i].n_jobs = n_jobs;
+  }
+
+  if (n_jobs > 1) {
+    if (!interlace->thread_pool) {
+      interlace->thread_pool =
+          g_thread_pool_new (gst_interlace_job_func, interlace, n_jobs - 1,
+          FALSE, NULL);
+    } else if (g_thread_pool_get_max_threads (interlace->thread_pool) <
+        n_jobs - 1) {
+      g_thread_pool_set_max_threads (interlace->thread_pool, n_jobs - 1,
+          NULL);
+    }
+
+    interlace->jobs_pending = n_jobs - 1;
+    for (i = 1; i < n_jobs; i++)
+      g_thread_pool_push (interlace->thread_pool, &jobs[i], NULL);
+  }
+
+  gst_interlace_run_job (&jobs[0]);
+
+  if (n_jobs > 1) {
+    g_mutex_lock (&interlace->jobs_lock);
+    while (interlace->jobs_pending > 0)
+      g_cond_wait (&interlace->jobs_cond, &interlace->jobs_lock);
+    g_mutex_unlock (&interlace->jobs_lock);
+  }
+}
+
+/* Makes a frame of field_index from the stored frame and the other field
+ * from @buffer. The stored frame isn't needed after this, so when nobody
+ * else holds it the field of @buffer is written into it and nothing else
+ * is copied */
+static GstFlowReturn
+gst_interlace_weave (GstInterlace * interlace, GstBuffer * buffer,
+    GstBuffer ** outbuf)
+{
+  GstVideoInfo *info = &interlace->info;
+  GstVideoFrame dframe, sframe;
+  GstBuffer *output_buffer;
+  GstFlowReturn ret;
+  gboolean in_place;
+
+  in_place = gst_buffer_is_writable (interlace->stored_frame)
+      && gst_buffer_is_all_memory_writable (interlace->stored_frame);
+
+  if (in_place) {
+    output_buffer = interlace->stored_frame;
+    interlace->stored_frame = NULL;
+  } else if (interlace->pool) {
+    ret = gst_buffer_pool_acquire_buffer (interlace->pool, &output_buffer,
+        NULL);
+    if (ret != GST_FLOW_OK)
+      return ret;
+  } else {
+    output_buffer = gst_buffer_new_and_alloc (info->size);
+  }
+
+  if (!gst_video_frame_map (&dframe, info, output_buffer, GST_MAP_WRITE))
+    goto dest_map_failed;
+
+  if (!in_place) {
+    /* take the first field from the stored frame */
+    if (!gst_video_frame_map (&sframe, info, interlace->stored_frame,
+            GST_MAP_READ))
+      goto src_map_failed;
+    copy_field (interlace, &dframe, &sframe, interlace->field_index);
+    gst_video_frame_unmap (&sframe);
+  }
+
+  /* take the second field from the incoming buffer */
+  if (!gst_video_frame_map (&sframe, info, buffer, GST_MAP_READ))
+    goto src_map_failed;
+  copy_field (interlace, &dframe, &sframe, interlace->field_index ^ 1);
   gst_video_frame_unmap (&sframe);
-  return;
+
+  gst_video_frame_unmap (&dframe);
+
+  *outbuf = output_buffer;
+  return GST_FLOW_OK;
 
 dest_map_failed:
   {
-    GST_ERROR_OBJECT (interlace, "failed to map dest");
-    return;
+    GST_ELEMENT_ERROR (interlace, RESOURCE, WRITE, (NULL),
+        ("failed to map dest"));
+    gst_buffer_unref (output_buffer);
+    return GST_FLOW_ERROR;
   }
 src_map_failed:
   {
-    GST_ERROR_OBJECT (interlace, "failed to map src");
+    GST_ELEMENT_ERROR (interlace, RESOURCE, READ, (NULL),
+        ("failed to map src"));
     gst_video_frame_unmap (&dframe);
-    return;
+    gst_buffer_unref (output_buffer);
+    return GST_FLOW_ERROR;
   }
 }
 
-
 static GstFlowReturn
 gst_interlace_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
@@ -734,13 +951,10 @@ gst_interlace_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     if (interlace->stored_fields > 0) {
       GST_DEBUG ("1 field from stored, 1 from current");
 
-      output_buffer = gst_buffer_new_and_alloc (gst_buffer_get_size (buffer));
-      /* take the first field from the stored frame */
-      copy_field (interlace, output_buffer, interlace->stored_frame,
-          interlace->field_index);
+      ret = gst_interlace_weave (interlace, buffer, &output_buffer);
+      if (ret != GST_FLOW_OK)
+        break;
       interlace->stored_fields--;
-      /* take the second field from the incoming buffer */
-      copy_field (interlace, output_buffer, buffer, interlace->field_index ^ 1);
       current_fields--;
       n_output_fields = 2;
       interlaced = TRUE;
@@ -820,6 +1034,9 @@ gst_interlace_set_property (GObject * object,
     case PROP_ALLOW_RFF:
       interlace->allow_rff = g_value_get_boolean (value);
       break;
+    case PROP_N_THREADS:
+      interlace->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -845,6 +1062,9 @@ gst_interlace_get_property (GObject * object,
     case PROP_ALLOW_RFF:
       g_value_set_boolean (value, interlace->allow_rff);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, interlace->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -854,7 +1074,8 @@ gst_interlace_get_property (GObject * object,
 static GstStateChangeReturn
 gst_interlace_change_state (GstElement * element, GstStateChange transition)
 {
-  //GstInterlace *interlace = GST_INTERLACE (element);
+  GstInterlace *interlace = GST_INTERLACE (element);
+  GstStateChangeReturn ret;
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
@@ -864,7 +1085,17 @@ gst_interlace_change_state (GstElement * element, GstStateChange transition)
       break;
   }
 
-  return GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_interlace_release_pool (interlace);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
 }
 
 static gboolean
@@ -39,6 +39,7 @@
 #include <gst/gst.h>
 #include <gst/video/video.h>
 #include <gst/video/gstvideofilter.h>
+#include <gst/video/gstvideoframestats.h>
 #include "gstcombdetect.h"
 
 #include <string.h>
@@ -191,6 +192,7 @@ static GstFlowReturn
 gst_comb_detect_transform_frame (GstVideoFilter * filter,
     GstVideoFrame * inframe, GstVideoFrame * outframe)
 {
+  GstCombDetect *combdetect = GST_COMB_DETECT (filter);
   static int z;
   int k;
   int height;
@@ -213,11 +215,23 @@ gst_comb_detect_transform_frame (GstVideoFilter * filter,
   {
     int j;
     int thisline[MAX_WIDTH];
+    guint8 mask[MAX_WIDTH];
+    GstVideoFrameStatsMeta *meta;
+    gboolean combed = TRUE;
     int score = 0;
 
     height = GST_VIDEO_FRAME_COMP_HEIGHT (outframe, 0);
     width = GST_VIDEO_FRAME_COMP_WIDTH (outframe, 0);
 
+    /* upstream (e.g. ivtc) already measured this frame with the same
+     * detector, nothing to mark if it found no combing */
+    meta = gst_buffer_get_video_frame_stats_meta (inframe->buffer);
+    if (meta && (meta->flags & GST_VIDEO_FRAME_STATS_COMB) &&
+        meta->comb_score == 0) {
+      GST_LOG_OBJECT (combdetect, "frame not combed according to meta");
+      combed = FALSE;
+    }
+
     memset (thisline, 0, sizeof (thisline));
 
     k = 0;
@@ -229,27 +243,20 @@ gst_comb_detect_transform_frame (GstVideoFilter * filter,
         for (i = 0; i < width; i++) {
           dest[i] = src[i] / 2;
         }
+      } else if (!combed) {
+        memcpy (GET_LINE (outframe, 0, j), GET_LINE (inframe, 0, j), width);
       } else {
         guint8 *dest = GET_LINE (outframe, 0, j);
         guint8 *src1 = GET_LINE (inframe, 0, j - 1);
         guint8 *src2 = GET_LINE (inframe, 0, j);
         guint8 *src3 = GET_LINE (inframe, 0, j + 1);
 
+        gst_video_frame_stats_comb_mask (mask, src1, src2, src3, width, 5);
+        score += gst_video_frame_stats_comb_runs (thisline, mask, width);
+
         for (i = 0; i < width; i++) {
-          if (src2[i] < MIN (src1[i], src3[i]) - 5 ||
-              src2[i] > MAX (src1[i], src3[i]) + 5) {
-            if (i > 0) {
-              thisline[i] += thisline[i - 1];
-            }
-            thisline[i]++;
-            if (thisline[i] > 1000)
-              thisline[i] = 1000;
-          } else {
-            thisline[i] = 0;
-          }
-          if (thisline[i] > 100) {
+          if (mask[i]) {
             dest[i] = ((i + j + z) & 0x4) ? 235 : 16;
-            score++;
           } else {
             dest[i] = src2[i];
           }
@@ -46,6 +46,7 @@
 #include <gst/gst.h>
 #include <gst/base/gstbasetransform.h>
 #include <gst/video/video.h>
+#include <gst/video/gstvideoframestats.h>
 #include "gstivtc.h"
 #include <string.h>
 #include <math.h>
@@ -566,6 +567,8 @@ gst_ivtc_construct_frame (GstIvtc * ivtc, GstBuffer * outbuf)
   int anchor_index;
   int prev_score, next_score;
   GstVideoFrame dest_frame;
+  GstVideoFrameStatsMeta *meta;
+  int comb_score = -1;
   int n_retire;
   gboolean forward_ok;
 
@@ -586,12 +589,14 @@ gst_ivtc_construct_frame (GstIvtc * ivtc, GstBuffer * outbuf)
   if (prev_score < THRESHOLD) {
     if (forward_ok && next_score < prev_score) {
       reconstruct (ivtc, &dest_frame, anchor_index, anchor_index + 1);
+      comb_score = next_score;
       n_retire = anchor_index + 2;
     } else {
       if (prev_score >= THRESHOLD / 2) {
         GST_INFO ("borderline prev (%d, %d)", prev_score, next_score);
       }
       reconstruct (ivtc, &dest_frame, anchor_index, anchor_index - 1);
+      comb_score = prev_score;
       n_retire = anchor_index + 1;
     }
   } else if (next_score < THRESHOLD) {
@@ -599,6 +604,7 @@ gst_ivtc_construct_frame (GstIvtc * ivtc, GstBuffer * outbuf)
       GST_INFO ("borderline prev (%d, %d)", prev_score, next_score);
     }
     reconstruct (ivtc, &dest_frame, anchor_index, anchor_index + 1);
+    comb_score = next_score;
     if (forward_ok) {
       n_retire = anchor_index + 2;
     } else {
@@ -617,6 +623,17 @@ gst_ivtc_construct_frame (GstIvtc * ivtc, GstBuffer * outbuf)
 
   gst_video_frame_unmap (&dest_frame);
 
+  /* a woven frame has exactly the comb score of its field pair, pass it
+   * on so that analysers downstream don't have to measure it again */
+  meta = gst_buffer_get_video_frame_stats_meta (outbuf);
+  if (!meta)
+    meta = gst_buffer_add_video_frame_stats_meta (outbuf);
+  meta->flags = GST_VIDEO_FRAME_STATS_NONE;
+  if (comb_score >= 0) {
+    meta->flags |= GST_VIDEO_FRAME_STATS_COMB;
+    meta->comb_score = comb_score;
+  }
+
   GST_BUFFER_PTS (outbuf) = ivtc->current_ts;
   GST_BUFFER_DTS (outbuf) = ivtc->current_ts;
   /* FIXME this is not how to produce durations */
@@ -634,6 +651,7 @@ get_comb_score (GstVideoFrame * top, GstVideoFrame * bottom)
 {
   int j;
   int thisline[MAX_WIDTH];
+  guint8 mask[MAX_WIDTH];
   int score = 0;
   int height;
   int width;
@@ -651,24 +669,9 @@ get_comb_score (GstVideoFrame * top, GstVideoFrame * bottom)
     guint8 *src1 = GET_LINE_IL (top, bottom, 0, j - 1);
     guint8 *src2 = GET_LINE_IL (top, bottom, 0, j);
     guint8 *src3 = GET_LINE_IL (top, bottom, 0, j + 1);
-    int i;
 
-    for (i = 0; i < width; i++) {
-      if (src2[i] < MIN (src1[i], src3[i]) - 5 ||
-          src2[i] > MAX (src1[i], src3[i]) + 5) {
-        if (i > 0) {
-          thisline[i] += thisline[i - 1];
-        }
-        thisline[i]++;
-        if (thisline[i] > 1000)
-          thisline[i] = 1000;
-      } else {
-        thisline[i] = 0;
-      }
-      if (thisline[i] > 100) {
-        score++;
-      }
-    }
+    gst_video_frame_stats_comb_mask (mask, src1, src2, src3, width, 5);
+    score += gst_video_frame_stats_comb_runs (thisline, mask, width);
   }
 
   GST_DEBUG ("score %d", score);
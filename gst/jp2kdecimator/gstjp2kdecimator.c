@@ -31,6 +31,13 @@
  * ]|
  * This pipelines encodes a test image to JPEG2000, only keeps 3 decomposition levels
  * decodes the decimated image again and shows it on the screen.
+ * |[
+ * gst-launch-1.0 filesrc location=movie.mj2 ! qtdemux ! \
+ *   jp2kdecimator max-decomposition-levels=3 n-threads=4 ! fakesink
+ * ]|
+ * With n-threads the frames are decimated in parallel on a thread pool and
+ * still pushed in their original order, at the cost of up to n-threads
+ * frames of delay.
  * </refsect2>
  */
 
@@ -61,19 +68,38 @@ enum
 {
   PROP_0,
   PROP_MAX_LAYERS,
-  PROP_MAX_DECOMPOSITION_LEVELS
+  PROP_MAX_DECOMPOSITION_LEVELS,
+  PROP_N_THREADS
 };
 
 #define DEFAULT_MAX_LAYERS (0)
 #define DEFAULT_MAX_DECOMPOSITION_LEVELS (-1)
+#define DEFAULT_N_THREADS (1)
+
+typedef struct
+{
+  GstBuffer *inbuf;
+  GstBuffer *outbuf;
+  /* the settings at the time the frame arrived */
+  gint max_layers;
+  gint max_decomposition_levels;
+  GstFlowReturn ret;
+  gboolean done;
+} GstJP2kDecimatorJob;
 
 static void gst_jp2k_decimator_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec);
 static void gst_jp2k_decimator_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec);
+static void gst_jp2k_decimator_finalize (GObject * object);
+
+static GstStateChangeReturn gst_jp2k_decimator_change_state (GstElement *
+    element, GstStateChange transition);
 
 static GstFlowReturn gst_jp2k_decimator_sink_chain (GstPad * pad,
     GstObject * parent, GstBuffer * inbuf);
+static gboolean gst_jp2k_decimator_sink_event (GstPad * pad,
+    GstObject * parent, GstEvent * event);
 
 GST_DEBUG_CATEGORY (gst_jp2k_decimator_debug);
 #define GST_CAT_DEFAULT gst_jp2k_decimator_debug
@@ -99,6 +125,10 @@ gst_jp2k_decimator_class_init (GstJP2kDecimatorClass * klass)
 
   gobject_class->set_property = gst_jp2k_decimator_set_property;
   gobject_class->get_property = gst_jp2k_decimator_get_property;
+  gobject_class->finalize = gst_jp2k_decimator_finalize;
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_jp2k_decimator_change_state);
 
   g_object_class_install_property (gobject_class, PROP_MAX_LAYERS,
       g_param_spec_int ("max-layers", "Maximum Number of Layers",
@@ -111,6 +141,11 @@ gst_jp2k_decimator_class_init (GstJP2kDecimatorClass * klass)
           "Maximum number of decomposition levels to keep (-1 == all)", -1, 32,
           DEFAULT_MAX_DECOMPOSITION_LEVELS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of frames decimated in parallel", 1, 64,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -118,6 +153,12 @@ gst_jp2k_decimator_init (GstJP2kDecimator * self)
 {
   self->max_layers = DEFAULT_MAX_LAYERS;
   self->max_decomposition_levels = DEFAULT_MAX_DECOMPOSITION_LEVELS;
+  self->n_threads = DEFAULT_N_THREADS;
+
+  self->pool = NULL;
+  g_mutex_init (&self->jobs_lock);
+  g_cond_init (&self->jobs_cond);
+  g_queue_init (&self->jobs);
 
   self->sinkpad = gst_pad_new_from_static_template (&sink_pad_template, "sink");
   GST_PAD_SET_PROXY_CAPS (self->sinkpad);
@@ -125,6 +166,8 @@ gst_jp2k_decimator_init (GstJP2kDecimator * self)
 
   gst_pad_set_chain_function (self->sinkpad,
       GST_DEBUG_FUNCPTR (gst_jp2k_decimator_sink_chain));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_jp2k_decimator_sink_event));
   gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
 
   self->srcpad = gst_pad_new_from_static_template (&src_pad_template, "src");
@@ -132,12 +175,26 @@ gst_jp2k_decimator_init (GstJP2kDecimator * self)
   gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
 }
 
+static void
+gst_jp2k_decimator_finalize (GObject * object)
+{
+  GstJP2kDecimator *self = GST_JP2K_DECIMATOR (object);
+
+  if (self->pool)
+    g_thread_pool_free (self->pool, FALSE, TRUE);
+  g_mutex_clear (&self->jobs_lock);
+  g_cond_clear (&self->jobs_cond);
+
+  G_OBJECT_CLASS (gst_jp2k_decimator_parent_class)->finalize (object);
+}
+
 static void
 gst_jp2k_decimator_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec)
 {
   GstJP2kDecimator *self = GST_JP2K_DECIMATOR (object);
 
+  GST_OBJECT_LOCK (self);
   switch (prop_id) {
     case PROP_MAX_LAYERS:
       self->max_layers = g_value_get_int (value);
@@ -145,10 +202,14 @@ gst_jp2k_decimator_set_property (GObject * object,
     case PROP_MAX_DECOMPOSITION_LEVELS:
       self->max_decomposition_levels = g_value_get_int (value);
       break;
+    case PROP_N_THREADS:
+      self->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
+  GST_OBJECT_UNLOCK (self);
 }
 
 static void
@@ -157,6 +218,7 @@ gst_jp2k_decimator_get_property (GObject * object,
 {
   GstJP2kDecimator *self = GST_JP2K_DECIMATOR (object);
 
+  GST_OBJECT_LOCK (self);
   switch (prop_id) {
     case PROP_MAX_LAYERS:
       g_value_set_int (value, self->max_layers);
@@ -164,15 +226,19 @@ gst_jp2k_decimator_get_property (GObject * object,
     case PROP_MAX_DECOMPOSITION_LEVELS:
       g_value_set_int (value, self->max_decomposition_levels);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, self->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
+  GST_OBJECT_UNLOCK (self);
 }
 
 static GstFlowReturn
 gst_jp2k_decimator_decimate_jpc (GstJP2kDecimator * self, GstBuffer * inbuf,
-    GstBuffer ** outbuf_)
+    gint max_layers, gint max_decomposition_levels, GstBuffer ** outbuf_)
 {
   GstBuffer *outbuf = NULL;
   GstFlowReturn ret = GST_FLOW_OK;
@@ -194,6 +260,8 @@ gst_jp2k_decimator_decimate_jpc (GstJP2kDecimator * self, GstBuffer * inbuf,
 
   /* main header */
   memset (&main_header, 0, sizeof (MainHeader));
+  main_header.max_layers = max_layers;
+  main_header.max_decomposition_levels = max_decomposition_levels;
   ret = parse_main_header (self, &reader, &main_header);
   if (ret != GST_FLOW_OK)
     goto done;
@@ -226,6 +294,82 @@ done:
   return ret;
 }
 
+static void
+gst_jp2k_decimator_job_func (gpointer data, gpointer user_data)
+{
+  GstJP2kDecimator *self = user_data;
+  GstJP2kDecimatorJob *job = data;
+
+  job->ret = gst_jp2k_decimator_decimate_jpc (self, job->inbuf,
+      job->max_layers, job->max_decomposition_levels, &job->outbuf);
+  job->inbuf = NULL;
+
+  g_mutex_lock (&self->jobs_lock);
+  job->done = TRUE;
+  g_cond_broadcast (&self->jobs_cond);
+  g_mutex_unlock (&self->jobs_lock);
+}
+
+/* Pushes the decimated frames in input order, until at most @max_pending
+ * frames are still being decimated */
+static GstFlowReturn
+gst_jp2k_decimator_push_jobs (GstJP2kDecimator * self, guint max_pending)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstJP2kDecimatorJob *job;
+
+  g_mutex_lock (&self->jobs_lock);
+  while ((job = g_queue_peek_head (&self->jobs))) {
+    if (!job->done) {
+      if (g_queue_get_length (&self->jobs) <= max_pending)
+        break;
+      g_cond_wait (&self->jobs_cond, &self->jobs_lock);
+      continue;
+    }
+
+    g_queue_pop_head (&self->jobs);
+    g_mutex_unlock (&self->jobs_lock);
+
+    if (job->ret != GST_FLOW_OK) {
+      if (ret == GST_FLOW_OK)
+        ret = job->ret;
+    } else if (ret == GST_FLOW_OK) {
+      ret = gst_pad_push (self->srcpad, job->outbuf);
+      job->outbuf = NULL;
+    }
+
+    if (job->outbuf)
+      gst_buffer_unref (job->outbuf);
+    g_slice_free (GstJP2kDecimatorJob, job);
+
+    g_mutex_lock (&self->jobs_lock);
+  }
+  g_mutex_unlock (&self->jobs_lock);
+
+  return ret;
+}
+
+/* Waits for the frames being decimated and drops them */
+static void
+gst_jp2k_decimator_drop_jobs (GstJP2kDecimator * self)
+{
+  GstJP2kDecimatorJob *job;
+
+  g_mutex_lock (&self->jobs_lock);
+  while ((job = g_queue_peek_head (&self->jobs))) {
+    if (!job->done) {
+      g_cond_wait (&self->jobs_cond, &self->jobs_lock);
+      continue;
+    }
+
+    g_queue_pop_head (&self->jobs);
+    if (job->outbuf)
+      gst_buffer_unref (job->outbuf);
+    g_slice_free (GstJP2kDecimatorJob, job);
+  }
+  g_mutex_unlock (&self->jobs_lock);
+}
+
 static GstFlowReturn
 gst_jp2k_decimator_sink_chain (GstPad * pad, GstObject * parent,
     GstBuffer * inbuf)
@@ -233,24 +377,103 @@ gst_jp2k_decimator_sink_chain (GstPad * pad, GstObject * parent,
   GstJP2kDecimator *self = GST_JP2K_DECIMATOR (parent);
   GstFlowReturn ret;
   GstBuffer *outbuf = NULL;
+  GstJP2kDecimatorJob *job;
+  gint max_layers, max_decomposition_levels;
+  guint n_threads;
 
   GST_LOG_OBJECT (pad,
       "Handling inbuf with timestamp %" GST_TIME_FORMAT " and duration %"
       GST_TIME_FORMAT, GST_TIME_ARGS (GST_BUFFER_PTS (inbuf)),
       GST_TIME_ARGS (GST_BUFFER_DURATION (inbuf)));
 
-  if (self->max_layers == 0 && self->max_decomposition_levels == -1) {
-    outbuf = inbuf;
-    inbuf = NULL;
-    ret = GST_FLOW_OK;
-  } else {
-    ret = gst_jp2k_decimator_decimate_jpc (self, inbuf, &outbuf);
-  }
+  /* one frame is always decimated with one set of settings */
+  GST_OBJECT_LOCK (self);
+  max_layers = self->max_layers;
+  max_decomposition_levels = self->max_decomposition_levels;
+  n_threads = self->n_threads;
+  GST_OBJECT_UNLOCK (self);
+
+  if ((max_layers == 0 && max_decomposition_levels == -1) || n_threads <= 1) {
+    /* frames that are still being decimated go first */
+    ret = gst_jp2k_decimator_push_jobs (self, 0);
+    if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+      gst_buffer_unref (inbuf);
+      return ret;
+    }
+
+    if (max_layers == 0 && max_decomposition_levels == -1) {
+      outbuf = inbuf;
+      inbuf = NULL;
+      ret = GST_FLOW_OK;
+    } else {
+      ret = gst_jp2k_decimator_decimate_jpc (self, inbuf, max_layers,
+          max_decomposition_levels, &outbuf);
+    }
+
+    if (G_UNLIKELY (ret != GST_FLOW_OK))
+      return ret;
+
+    ret = gst_pad_push (self->srcpad, outbuf);
 
-  if (G_UNLIKELY (ret != GST_FLOW_OK))
     return ret;
+  }
+
+  if (!self->pool) {
+    self->pool =
+        g_thread_pool_new (gst_jp2k_decimator_job_func, self, n_threads,
+        FALSE, NULL);
+  } else if (g_thread_pool_get_max_threads (self->pool) < n_threads) {
+    g_thread_pool_set_max_threads (self->pool, n_threads, NULL);
+  }
+
+  job = g_slice_new0 (GstJP2kDecimatorJob);
+  job->inbuf = inbuf;
+  job->max_layers = max_layers;
+  job->max_decomposition_levels = max_decomposition_levels;
+
+  g_mutex_lock (&self->jobs_lock);
+  g_queue_push_tail (&self->jobs, job);
+  g_mutex_unlock (&self->jobs_lock);
+
+  g_thread_pool_push (self->pool, job, NULL);
+
+  /* keep up to n-threads frames in flight */
+  return gst_jp2k_decimator_push_jobs (self, n_threads);
+}
+
+static gboolean
+gst_jp2k_decimator_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstJP2kDecimator *self = GST_JP2K_DECIMATOR (parent);
+
+  /* serialized events must follow the frames that came before them */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP)
+    gst_jp2k_decimator_drop_jobs (self);
+  else if (GST_EVENT_IS_SERIALIZED (event))
+    gst_jp2k_decimator_push_jobs (self, 0);
+
+  return gst_pad_event_default (pad, parent, event);
+}
 
-  ret = gst_pad_push (self->srcpad, outbuf);
+static GstStateChangeReturn
+gst_jp2k_decimator_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstJP2kDecimator *self = GST_JP2K_DECIMATOR (element);
+  GstStateChangeReturn ret;
+
+  ret =
+      GST_ELEMENT_CLASS (gst_jp2k_decimator_parent_class)->change_state
+      (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_jp2k_decimator_drop_jobs (self);
+      break;
+    default:
+      break;
+  }
 
   return ret;
 }
@@ -43,6 +43,13 @@ struct _GstJP2kDecimator
 
   gint max_layers;
   gint max_decomposition_levels;
+  guint n_threads;
+
+  /* frames being decimated on the pool, in input order */
+  GThreadPool *pool;
+  GMutex jobs_lock;
+  GCond jobs_cond;
+  GQueue jobs;
 };
 
 struct _GstJP2kDecimatorClass
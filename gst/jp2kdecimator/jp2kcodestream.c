@@ -838,6 +838,14 @@ write_plt (GstJP2kDecimator * self, GstByteWriter * writer,
   return GST_FLOW_OK;
 }
 
+static gboolean
+packet_is_dropped (const MainHeader * header, const PacketIterator * it)
+{
+  return (header->max_layers != 0 && it->cur_layer >= header->max_layers) ||
+      (header->max_decomposition_levels != -1
+      && it->cur_resolution > header->max_decomposition_levels);
+}
+
 static GstFlowReturn
 parse_packet (GstJP2kDecimator * self, GstByteReader * reader,
     const MainHeader * header, Tile * tile, const PacketIterator * it)
@@ -882,6 +890,25 @@ parse_packet (GstJP2kDecimator * self, GstByteReader * reader,
 
     p = g_slice_new0 (Packet);
 
+    /* The packet is replaced by an empty one when writing, so only look at
+     * its SOP and skip the body */
+    if (packet_is_dropped (header, it)) {
+      const guint8 *sop_data;
+
+      if (sop && length > 6 && gst_byte_reader_peek_data (reader, 6, &sop_data)
+          && GST_READ_UINT16_BE (sop_data) == MARKER_SOP) {
+        p->sop = TRUE;
+        p->seqno = GST_READ_UINT16_BE (sop_data + 4);
+      }
+      p->data = NULL;
+      p->length = 1;
+      p->eph = eph;
+      gst_byte_reader_skip_unchecked (reader, length);
+
+      tile->packets = g_list_prepend (tile->packets, p);
+      goto done;
+    }
+
     /* If there is a SOP keep the seqno */
     if (sop && length > 6) {
       if (!gst_byte_reader_peek_uint16_be (reader, &marker)) {
@@ -1789,9 +1816,7 @@ decimate_main_header (GstJP2kDecimator * self, MainHeader * header)
 
       p = l->data;
 
-      if ((self->max_layers != 0 && it.cur_layer >= self->max_layers) ||
-          (self->max_decomposition_levels != -1
-              && it.cur_resolution > self->max_decomposition_levels)) {
+      if (packet_is_dropped (header, &it)) {
         p->data = NULL;
         p->length = 1;
       }
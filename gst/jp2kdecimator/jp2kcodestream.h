@@ -148,6 +148,10 @@ typedef struct
 
   guint n_tiles_x, n_tiles_y, n_tiles;  /* calculated */
   Tile *tiles;
+
+  /* Decimation settings for this frame, packets they drop are not parsed */
+  gint max_layers;
+  gint max_decomposition_levels;
 } MainHeader;
 
 typedef struct _PacketIterator PacketIterator;
@@ -90,7 +90,7 @@ enum
 enum
 {
   PROP_0,
-  /* FILL ME */
+  PROP_INDEX_LOCATION
 };
 
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
@@ -138,6 +138,10 @@ static void gst_ps_demux_class_init (GstPsDemuxClass * klass);
 static void gst_ps_demux_init (GstPsDemux * demux);
 static void gst_ps_demux_finalize (GstPsDemux * demux);
 static void gst_ps_demux_reset (GstPsDemux * demux);
+static void gst_ps_demux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_ps_demux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static gboolean gst_ps_demux_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
@@ -244,6 +248,14 @@ gst_ps_demux_class_init (GstPsDemuxClass * klass)
   gstelement_class = (GstElementClass *) klass;
 
   gobject_class->finalize = (GObjectFinalizeFunc) gst_ps_demux_finalize;
+  gobject_class->set_property = gst_ps_demux_set_property;
+  gobject_class->get_property = gst_ps_demux_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_INDEX_LOCATION,
+      g_param_spec_string ("index-location", "Index location",
+          "File to load the seek index from when opening the stream and to "
+          "save it to when closing it, in pull mode", NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state = gst_ps_demux_change_state;
 }
@@ -274,6 +286,7 @@ gst_ps_demux_init (GstPsDemux * demux)
   demux->adapter = gst_adapter_new ();
   demux->rev_adapter = gst_adapter_new ();
   demux->flowcombiner = gst_flow_combiner_new ();
+  demux->scr_index = g_array_new (FALSE, FALSE, sizeof (GstPsDemuxScrEntry));
 
   gst_ps_demux_reset (demux);
 }
@@ -288,10 +301,49 @@ gst_ps_demux_finalize (GstPsDemux * demux)
   gst_flow_combiner_free (demux->flowcombiner);
   g_object_unref (demux->adapter);
   g_object_unref (demux->rev_adapter);
+  g_array_free (demux->scr_index, TRUE);
+  g_free (demux->index_location);
 
   G_OBJECT_CLASS (parent_class)->finalize (G_OBJECT (demux));
 }
 
+static void
+gst_ps_demux_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstPsDemux *demux = GST_PS_DEMUX (object);
+
+  switch (prop_id) {
+    case PROP_INDEX_LOCATION:
+      GST_OBJECT_LOCK (demux);
+      g_free (demux->index_location);
+      demux->index_location = g_value_dup_string (value);
+      GST_OBJECT_UNLOCK (demux);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_ps_demux_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstPsDemux *demux = GST_PS_DEMUX (object);
+
+  switch (prop_id) {
+    case PROP_INDEX_LOCATION:
+      GST_OBJECT_LOCK (demux);
+      g_value_set_string (value, demux->index_location);
+      GST_OBJECT_UNLOCK (demux);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 gst_ps_demux_reset (GstPsDemux * demux)
 {
@@ -336,6 +388,9 @@ gst_ps_demux_reset (GstPsDemux * demux)
   demux->next_dts = G_MAXUINT64;
   demux->need_no_more_pads = TRUE;
   demux->adjust_segment = TRUE;
+  g_array_set_size (demux->scr_index, 0);
+  demux->scan_start_position = 0;
+  demux->have_index_key = FALSE;
   gst_ps_demux_reset_psm (demux);
   gst_segment_init (&demux->sink_segment, GST_FORMAT_UNDEFINED);
   gst_segment_init (&demux->src_segment, GST_FORMAT_TIME);
@@ -1115,6 +1170,96 @@ not_supported:
   }
 }
 
+/* Minimum SCR distance of the packs indexed while streaming */
+#define SCR_INDEX_INTERVAL          (CLOCK_FREQ / 2)
+
+/* Returns the last entry at or before @offset, or -1 */
+static gint
+gst_ps_demux_scr_index_find (GstPsDemux * demux, guint64 offset)
+{
+  gint lo = 0, hi = (gint) demux->scr_index->len - 1, found = -1;
+
+  while (lo <= hi) {
+    gint mid = lo + (hi - lo) / 2;
+
+    if (g_array_index (demux->scr_index, GstPsDemuxScrEntry,
+            mid).offset <= offset) {
+      found = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+
+  return found;
+}
+
+/* Records the SCR of the pack at @offset. Packs that would break the
+ * ordering, e.g. after an SCR discontinuity, are not indexed. With @sparse
+ * packs close to an indexed one are skipped too */
+static void
+gst_ps_demux_scr_index_add (GstPsDemux * demux, guint64 scr, guint64 offset,
+    gboolean sparse)
+{
+  GstPsDemuxScrEntry entry, *prev = NULL, *next = NULL;
+  gint i;
+
+  i = gst_ps_demux_scr_index_find (demux, offset);
+  if (i >= 0)
+    prev = &g_array_index (demux->scr_index, GstPsDemuxScrEntry, i);
+  if (i + 1 < (gint) demux->scr_index->len)
+    next = &g_array_index (demux->scr_index, GstPsDemuxScrEntry, i + 1);
+
+  if (prev && prev->offset == offset)
+    return;
+  if ((prev && prev->scr > scr) || (next && next->scr < scr))
+    return;
+  if (sparse && ((prev && scr - prev->scr < SCR_INDEX_INTERVAL) ||
+          (next && next->scr - scr < SCR_INDEX_INTERVAL)))
+    return;
+
+  entry.scr = scr;
+  entry.offset = offset;
+  g_array_insert_val (demux->scr_index, i + 1, entry);
+}
+
+/* Narrows the range [min_scr, max_scr] down to the closest indexed packs
+ * around @scr */
+static void
+gst_ps_demux_scr_index_bracket (GstPsDemux * demux, guint64 scr,
+    guint64 * min_scr, guint64 * min_scr_offset, guint64 * max_scr,
+    guint64 * max_scr_offset)
+{
+  GstPsDemuxScrEntry *e;
+  gint lo = 0, hi = (gint) demux->scr_index->len - 1, found = -1;
+
+  while (lo <= hi) {
+    gint mid = lo + (hi - lo) / 2;
+
+    if (g_array_index (demux->scr_index, GstPsDemuxScrEntry, mid).scr <= scr) {
+      found = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+
+  if (found >= 0) {
+    e = &g_array_index (demux->scr_index, GstPsDemuxScrEntry, found);
+    if (e->scr >= *min_scr && e->offset >= *min_scr_offset) {
+      *min_scr = e->scr;
+      *min_scr_offset = e->offset;
+    }
+  }
+  if (found + 1 < (gint) demux->scr_index->len) {
+    e = &g_array_index (demux->scr_index, GstPsDemuxScrEntry, found + 1);
+    if (e->scr <= *max_scr && e->offset <= *max_scr_offset) {
+      *max_scr = e->scr;
+      *max_scr_offset = e->offset;
+    }
+  }
+}
+
 #define MAX_RECURSION_COUNT 100
 
 /* Binary search for requested SCR */
@@ -1127,19 +1272,28 @@ find_offset (GstPsDemux * demux, guint64 scr,
   guint64 scr_rate_d = max_scr - min_scr;
   guint64 fscr = scr;
   guint64 offset;
+  gboolean found;
 
   if (recursion_count > MAX_RECURSION_COUNT) {
     return -1;
   }
 
+  /* nothing to interpolate between */
+  if (scr_rate_d == 0)
+    return min_scr_offset;
+
   offset = min_scr_offset +
       MIN (gst_util_uint64_scale (scr - min_scr, scr_rate_n,
           scr_rate_d), demux->sink_segment.stop);
 
-  if (!gst_ps_demux_scan_forward_ts (demux, &offset, SCAN_SCR, &fscr, 0)) {
-    gst_ps_demux_scan_backward_ts (demux, &offset, SCAN_SCR, &fscr, 0);
+  found = gst_ps_demux_scan_forward_ts (demux, &offset, SCAN_SCR, &fscr, 0);
+  if (!found) {
+    found = gst_ps_demux_scan_backward_ts (demux, &offset, SCAN_SCR, &fscr, 0);
   }
 
+  if (found)
+    gst_ps_demux_scr_index_add (demux, fscr, offset, FALSE);
+
   if (fscr == scr || fscr == min_scr || fscr == max_scr) {
     return offset;
   }
@@ -1159,6 +1313,7 @@ gst_ps_demux_do_seek (GstPsDemux * demux, GstSegment * seeksegment)
   gboolean found;
   guint64 fscr, offset;
   guint64 scr = GSTTIME_TO_MPEGTIME (seeksegment->position + demux->base_time);
+  guint64 min_scr, min_scr_offset, max_scr, max_scr_offset;
 
   /* In some clips the PTS values are completely unaligned with SCR values.
    * To improve the seek in that situation we apply a factor considering the
@@ -1173,9 +1328,21 @@ gst_ps_demux_do_seek (GstPsDemux * demux, GstSegment * seeksegment)
   GST_INFO_OBJECT (demux, "sink segment configured %" GST_SEGMENT_FORMAT
       ", trying to go at SCR: %" G_GUINT64_FORMAT, &demux->sink_segment, scr);
 
+  /* start from the closest packs we already know */
+  min_scr = demux->first_scr;
+  min_scr_offset = demux->first_scr_offset;
+  max_scr = demux->last_scr;
+  max_scr_offset = demux->last_scr_offset;
+  gst_ps_demux_scr_index_bracket (demux, scr, &min_scr, &min_scr_offset,
+      &max_scr, &max_scr_offset);
+
+  GST_DEBUG_OBJECT (demux, "searching between SCR %" G_GUINT64_FORMAT
+      " at %" G_GUINT64_FORMAT " and SCR %" G_GUINT64_FORMAT " at %"
+      G_GUINT64_FORMAT, min_scr, min_scr_offset, max_scr, max_scr_offset);
+
   offset =
-      find_offset (demux, scr, demux->first_scr, demux->first_scr_offset,
-      demux->last_scr, demux->last_scr_offset, 0);
+      find_offset (demux, scr, min_scr, min_scr_offset, max_scr,
+      max_scr_offset, 0);
 
   if (offset == (guint64) - 1) {
     return FALSE;
@@ -1195,6 +1362,9 @@ gst_ps_demux_do_seek (GstPsDemux * demux, GstSegment * seeksegment)
     found = gst_ps_demux_scan_backward_ts (demux, &offset, SCAN_SCR, &fscr, 0);
   }
 
+  if (found)
+    gst_ps_demux_scr_index_add (demux, fscr, offset, FALSE);
+
   GST_INFO_OBJECT (demux, "doing seek at offset %" G_GUINT64_FORMAT
       " SCR: %" G_GUINT64_FORMAT " %" GST_TIME_FORMAT,
       offset, fscr, GST_TIME_ARGS (MPEGTIME_TO_GSTTIME (fscr)));
@@ -1719,6 +1889,11 @@ gst_ps_demux_parse_pack_start (GstPsDemux * demux)
   /* scr adjusted is the new scr found + the colected adjustment */
   scr_adjusted = scr + demux->scr_adjust;
 
+  /* remember where we saw this SCR, later seeks can start from here */
+  if (demux->random_access && demux->sink_segment.rate >= 0 &&
+      demux->adapter_offset != G_MAXUINT64)
+    gst_ps_demux_scr_index_add (demux, scr, demux->adapter_offset, TRUE);
+
   GST_LOG_OBJECT (demux,
       "SCR: %" G_GINT64_FORMAT " (%" G_GINT64_FORMAT "), mux_rate %"
       G_GINT64_FORMAT ", GStreamer Time:%" GST_TIME_FORMAT,
@@ -2707,6 +2882,216 @@ gst_ps_demux_scan_backward_ts (GstPsDemux * demux, guint64 * pos,
   return found;
 }
 
+/* Index file layout, all numbers little endian 64 bit:
+ *   "GstPsIdx" ! version ! file length ! start position !
+ *   first SCR ! first SCR offset ! last SCR ! last SCR offset !
+ *   first PTS ! last PTS ! n entries ! key (24 bytes) ! n * (SCR ! offset)
+ * where the key is the content key of the stream, zero padded
+ */
+#define INDEX_FILE_MAGIC            "GstPsIdx"
+#define INDEX_FILE_VERSION          3
+#define INDEX_FILE_KEY_SIZE         24
+#define INDEX_FILE_HEADER_SIZE      (8 + 10 * 8 + INDEX_FILE_KEY_SIZE)
+
+static gchar *
+gst_ps_demux_get_index_location (GstPsDemux * demux)
+{
+  gchar *location;
+
+  GST_OBJECT_LOCK (demux);
+  location = g_strdup (demux->index_location);
+  GST_OBJECT_UNLOCK (demux);
+
+  return location;
+}
+
+/* Identifies the content of the stream, so that an index file is only used
+ * for the file it was made from and not for any file of the same size */
+static gboolean
+gst_ps_demux_update_index_key (GstPsDemux * demux, guint64 length)
+{
+  gchar *location;
+
+  /* only needed to load or save an index */
+  location = gst_ps_demux_get_index_location (demux);
+  if (location == NULL)
+    return FALSE;
+  g_free (location);
+
+  return gst_content_key_pull (demux->sinkpad, length, demux->index_key);
+}
+
+/* Checks that there is a pack with @scr at @offset */
+static gboolean
+gst_ps_demux_check_scr (GstPsDemux * demux, guint64 offset, guint64 scr)
+{
+  guint64 pos = offset, fscr;
+
+  return gst_ps_demux_scan_forward_ts (demux, &pos, SCAN_SCR, &fscr, 1) &&
+      pos == offset && fscr == scr;
+}
+
+/* Restores the stream boundaries and the SCR index saved for this stream of
+ * @length bytes, so that we don't need to scan for them */
+static gboolean
+gst_ps_demux_load_index (GstPsDemux * demux, guint64 length)
+{
+  gchar *location, *contents = NULL;
+  gsize size;
+  const guint8 *data;
+  guint64 n_entries, i;
+  guint64 first_scr, first_scr_offset, last_scr, last_scr_offset;
+  GstPsDemuxScrEntry entry, *prev = NULL;
+  GArray *entries = NULL;
+  GError *err = NULL;
+  gboolean res = FALSE;
+
+  location = gst_ps_demux_get_index_location (demux);
+  if (location == NULL)
+    return FALSE;
+
+  if (!g_file_get_contents (location, &contents, &size, &err)) {
+    GST_DEBUG_OBJECT (demux, "could not read index file: %s", err->message);
+    g_error_free (err);
+    goto done;
+  }
+
+  data = (const guint8 *) contents;
+  if (size < INDEX_FILE_HEADER_SIZE || memcmp (data, INDEX_FILE_MAGIC, 8) ||
+      GST_READ_UINT64_LE (data + 8) != INDEX_FILE_VERSION) {
+    GST_WARNING_OBJECT (demux, "%s is not a valid index file", location);
+    goto done;
+  }
+  if (GST_READ_UINT64_LE (data + 16) != length ||
+      memcmp (data + 88, demux->index_key, sizeof (demux->index_key))) {
+    GST_INFO_OBJECT (demux, "index file %s was made for another file",
+        location);
+    goto done;
+  }
+  n_entries = GST_READ_UINT64_LE (data + 80);
+  if (n_entries > (size - INDEX_FILE_HEADER_SIZE) / 16) {
+    GST_WARNING_OBJECT (demux, "index file %s is truncated", location);
+    goto done;
+  }
+
+  first_scr = GST_READ_UINT64_LE (data + 32);
+  first_scr_offset = GST_READ_UINT64_LE (data + 40);
+  last_scr = GST_READ_UINT64_LE (data + 48);
+  last_scr_offset = GST_READ_UINT64_LE (data + 56);
+  if (first_scr > last_scr || first_scr_offset > last_scr_offset ||
+      last_scr_offset >= length || GST_READ_UINT64_LE (data + 24) >= length)
+    goto invalid;
+
+  /* entries are sorted by offset and SCR and lie between the boundaries */
+  entries = g_array_sized_new (FALSE, FALSE, sizeof (GstPsDemuxScrEntry),
+      n_entries);
+  data += INDEX_FILE_HEADER_SIZE;
+  for (i = 0; i < n_entries; i++) {
+    entry.scr = GST_READ_UINT64_LE (data);
+    entry.offset = GST_READ_UINT64_LE (data + 8);
+    if (entry.offset >= length || entry.scr < first_scr || entry.scr > last_scr
+        || (prev && (entry.offset <= prev->offset || entry.scr < prev->scr)))
+      goto invalid;
+    g_array_append_val (entries, entry);
+    prev = &g_array_index (entries, GstPsDemuxScrEntry, entries->len - 1);
+    data += 16;
+  }
+
+  /* and the stream still has the packs the index points to */
+  if (!gst_ps_demux_check_scr (demux, first_scr_offset, first_scr) ||
+      !gst_ps_demux_check_scr (demux, last_scr_offset, last_scr))
+    goto invalid;
+  if (entries->len > 0) {
+    prev = &g_array_index (entries, GstPsDemuxScrEntry, entries->len / 2);
+    if (!gst_ps_demux_check_scr (demux, prev->offset, prev->scr))
+      goto invalid;
+  }
+
+  data = (const guint8 *) contents;
+  demux->scan_start_position = GST_READ_UINT64_LE (data + 24);
+  demux->sink_segment.position = demux->scan_start_position;
+  demux->first_scr = first_scr;
+  demux->first_scr_offset = first_scr_offset;
+  demux->last_scr = last_scr;
+  demux->last_scr_offset = last_scr_offset;
+  demux->first_pts = GST_READ_UINT64_LE (data + 64);
+  demux->last_pts = GST_READ_UINT64_LE (data + 72);
+
+  g_array_free (demux->scr_index, TRUE);
+  demux->scr_index = entries;
+  entries = NULL;
+
+  GST_INFO_OBJECT (demux, "loaded %u index entries from %s",
+      demux->scr_index->len, location);
+  res = TRUE;
+
+done:
+  if (entries)
+    g_array_free (entries, TRUE);
+  g_free (contents);
+  g_free (location);
+
+  return res;
+
+invalid:
+  GST_WARNING_OBJECT (demux, "index file %s does not match the stream",
+      location);
+  goto done;
+}
+
+static void
+gst_ps_demux_save_index (GstPsDemux * demux)
+{
+  gchar *location;
+  GByteArray *bytes;
+  guint8 header[INDEX_FILE_HEADER_SIZE], entry[16];
+  GError *err = NULL;
+  guint i;
+
+  location = gst_ps_demux_get_index_location (demux);
+  if (location == NULL)
+    return;
+
+  memcpy (header, INDEX_FILE_MAGIC, 8);
+  GST_WRITE_UINT64_LE (header + 8, INDEX_FILE_VERSION);
+  GST_WRITE_UINT64_LE (header + 16, demux->sink_segment.stop);
+  GST_WRITE_UINT64_LE (header + 24, demux->scan_start_position);
+  GST_WRITE_UINT64_LE (header + 32, demux->first_scr);
+  GST_WRITE_UINT64_LE (header + 40, demux->first_scr_offset);
+  GST_WRITE_UINT64_LE (header + 48, demux->last_scr);
+  GST_WRITE_UINT64_LE (header + 56, demux->last_scr_offset);
+  GST_WRITE_UINT64_LE (header + 64, demux->first_pts);
+  GST_WRITE_UINT64_LE (header + 72, demux->last_pts);
+  GST_WRITE_UINT64_LE (header + 80, demux->scr_index->len);
+  memset (header + 88, 0, INDEX_FILE_KEY_SIZE);
+  memcpy (header + 88, demux->index_key, sizeof (demux->index_key));
+
+  bytes = g_byte_array_sized_new (sizeof (header) +
+      demux->scr_index->len * sizeof (entry));
+  g_byte_array_append (bytes, header, sizeof (header));
+  for (i = 0; i < demux->scr_index->len; i++) {
+    GstPsDemuxScrEntry *e =
+        &g_array_index (demux->scr_index, GstPsDemuxScrEntry, i);
+
+    GST_WRITE_UINT64_LE (entry, e->scr);
+    GST_WRITE_UINT64_LE (entry + 8, e->offset);
+    g_byte_array_append (bytes, entry, sizeof (entry));
+  }
+
+  if (!g_file_set_contents (location, (const gchar *) bytes->data, bytes->len,
+          &err)) {
+    GST_WARNING_OBJECT (demux, "could not write index file: %s",
+        err->message);
+    g_error_free (err);
+  } else {
+    GST_INFO_OBJECT (demux, "saved %u index entries to %s",
+        demux->scr_index->len, location);
+  }
+
+  g_byte_array_free (bytes, TRUE);
+  g_free (location);
+}
+
 static inline gboolean
 gst_ps_sink_get_duration (GstPsDemux * demux)
 {
@@ -2738,6 +3123,10 @@ gst_ps_sink_get_duration (GstPsDemux * demux)
   gst_segment_set_duration (&demux->sink_segment, format, length);
   gst_segment_set_position (&demux->sink_segment, format, 0);
 
+  demux->have_index_key = gst_ps_demux_update_index_key (demux, length);
+  if (demux->have_index_key && gst_ps_demux_load_index (demux, length))
+    goto have_boundaries;
+
   /* Scan for notorious SCR and PTS to calculate the duration */
   /* scan for first SCR in the stream */
   offset = demux->sink_segment.start;
@@ -2795,6 +3184,9 @@ gst_ps_sink_get_duration (GstPsDemux * demux)
       }
     }
   }
+  demux->scan_start_position = demux->sink_segment.position;
+
+have_boundaries:
   /* Set the base_time and avg rate */
   demux->base_time = MPEGTIME_TO_GSTTIME (demux->first_scr);
   demux->scr_rate_n = demux->last_scr_offset - demux->first_scr_offset;
@@ -3242,6 +3634,9 @@ gst_ps_demux_change_state (GstElement * element, GstStateChange transition)
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+      if (demux->random_access && demux->have_index_key &&
+          demux->first_scr != G_MAXUINT64 && demux->sink_segment.stop != -1)
+        gst_ps_demux_save_index (demux);
       gst_ps_demux_reset (demux);
       break;
     case GST_STATE_CHANGE_READY_TO_NULL:
@@ -48,6 +48,7 @@
 #include <gst/gst.h>
 #include <gst/base/gstadapter.h>
 #include <gst/base/gstflowcombiner.h>
+#include <gst/base/gstcontentkey.h>
 
 #include "gstpesfilter.h"
 
@@ -84,6 +85,13 @@ typedef enum
   STATE_PS_DEMUX_NEED_MORE_DATA,
 } GstPsDemuxState;
 
+/* A pack with a known SCR, for seeking */
+typedef struct
+{
+  guint64 scr;
+  guint64 offset;
+} GstPsDemuxScrEntry;
+
 /* Information associated with a single FluPS stream. */
 struct _GstPsStream
 {
@@ -156,6 +164,17 @@ struct _GstPsDemux
 
   /* Indicates an MPEG-2 stream */
   gboolean is_mpeg2_pack;
+
+  /* SCR to offset index built in pull mode, sorted by offset */
+  GArray *scr_index;
+  /* where demuxing starts after the duration scan */
+  guint64 scan_start_position;
+  /* identifies the stream in the index file */
+  guint8 index_key[GST_CONTENT_KEY_SIZE];
+  gboolean have_index_key;
+
+  /* properties */
+  gchar *index_location;
 };
 
 struct _GstPsDemuxClass
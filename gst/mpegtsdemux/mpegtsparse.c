@@ -40,6 +40,9 @@
 #define TABLE_ID_UNSET 0xFF
 #define RUNNING_STATUS_RUNNING 4
 
+/* Number of packets collected for a program pad before pushing them */
+#define MAX_BATCH_PACKETS 128
+
 GST_DEBUG_CATEGORY_STATIC (mpegts_parse_debug);
 #define GST_CAT_DEFAULT mpegts_parse_debug
 
@@ -59,13 +62,27 @@ struct _MpegTSParsePad
   gint program_number;
   MpegTSParseProgram *program;
 
-  /* set to FALSE before a push and TRUE after */
-  gboolean pushed;
-
-  /* the return of the latest push */
-  GstFlowReturn flow_return;
+  /* packets waiting to be pushed, protected by the OBJECT_LOCK */
+  GstBuffer *batch;
+  GstMapInfo batch_map;
+  gsize batch_size;
+
+  /* PAT listing only our program, and the PAT and PMT PID it was made
+   * from */
+  guint8 pat_packet[MPEGTS_NORMAL_PACKETSIZE];
+  gboolean have_pat;
+  guint32 pat_crc;
+  guint16 pat_pmt_pid;
+  guint8 pat_cc;
 };
 
+/* A batch taken from a pad, to be pushed without the OBJECT_LOCK */
+typedef struct
+{
+  GstPad *pad;
+  GstBuffer *buffer;
+} MpegTSParseBatch;
+
 static GstStaticPadTemplate src_template =
 GST_STATIC_PAD_TEMPLATE ("src", GST_PAD_SRC,
     GST_PAD_ALWAYS,
@@ -96,6 +113,10 @@ static void
 mpegts_parse_program_started (MpegTSBase * base, MpegTSBaseProgram * program);
 static void
 mpegts_parse_program_stopped (MpegTSBase * base, MpegTSBaseProgram * program);
+static void mpegts_parse_stream_added (MpegTSBase * base,
+    MpegTSBaseStream * stream, MpegTSBaseProgram * program);
+static void mpegts_parse_stream_removed (MpegTSBase * base,
+    MpegTSBaseStream * stream);
 
 static GstFlowReturn
 mpegts_parse_push (MpegTSBase * base, MpegTSPacketizerPacket * packet,
@@ -123,6 +144,9 @@ static GstFlowReturn mpegts_parse_input_done (MpegTSBase * base,
     GstBuffer * buffer);
 static GstFlowReturn
 drain_pending_buffers (MpegTSParse2 * parse, gboolean drain_all);
+static GstFlowReturn mpegts_parse_push_batches (MpegTSParse2 * parse);
+static void mpegts_parse_drop_batches (MpegTSParse2 * parse);
+static void mpegts_parse_finalize (GObject * object);
 
 static void
 mpegts_parse_class_init (MpegTSParse2Class * klass)
@@ -133,6 +157,7 @@ mpegts_parse_class_init (MpegTSParse2Class * klass)
 
   gobject_class->set_property = mpegts_parse_set_property;
   gobject_class->get_property = mpegts_parse_get_property;
+  gobject_class->finalize = mpegts_parse_finalize;
 
   g_object_class_install_property (gobject_class, PROP_SET_TIMESTAMPS,
       g_param_spec_boolean ("set-timestamps",
@@ -170,6 +195,8 @@ mpegts_parse_class_init (MpegTSParse2Class * klass)
   ts_class->push_event = GST_DEBUG_FUNCPTR (push_event);
   ts_class->program_started = GST_DEBUG_FUNCPTR (mpegts_parse_program_started);
   ts_class->program_stopped = GST_DEBUG_FUNCPTR (mpegts_parse_program_stopped);
+  ts_class->stream_added = GST_DEBUG_FUNCPTR (mpegts_parse_stream_added);
+  ts_class->stream_removed = GST_DEBUG_FUNCPTR (mpegts_parse_stream_removed);
   ts_class->reset = GST_DEBUG_FUNCPTR (mpegts_parse_reset);
   ts_class->input_done = GST_DEBUG_FUNCPTR (mpegts_parse_input_done);
   ts_class->inspect_packet = GST_DEBUG_FUNCPTR (mpegts_parse_inspect_packet);
@@ -195,6 +222,84 @@ mpegts_parse_init (MpegTSParse2 * parse)
 
   parse->have_group_id = FALSE;
   parse->group_id = G_MAXUINT;
+
+  parse->pid_pads = g_new0 (GSList *, 0x2000);
+  parse->dispatch_dirty = TRUE;
+}
+
+static void
+mpegts_parse_clear_dispatch (MpegTSParse2 * parse)
+{
+  gint i;
+
+  for (i = 0; i < 0x2000; i++) {
+    if (parse->pid_pads[i]) {
+      g_slist_free (parse->pid_pads[i]);
+      parse->pid_pads[i] = NULL;
+    }
+  }
+  g_slist_free (parse->unfiltered_pads);
+  parse->unfiltered_pads = NULL;
+}
+
+static void
+mpegts_parse_finalize (GObject * object)
+{
+  MpegTSParse2 *parse = GST_MPEGTS_PARSE (object);
+
+  mpegts_parse_clear_dispatch (parse);
+  g_free (parse->pid_pads);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+/* Sorts the program pads by the PIDs they want, so that a packet doesn't
+ * need to be matched against every pad. Call with the OBJECT_LOCK */
+static void
+mpegts_parse_update_dispatch (MpegTSParse2 * parse)
+{
+  GList *tmp, *s;
+
+  mpegts_parse_clear_dispatch (parse);
+
+  for (tmp = parse->srcpads; tmp; tmp = tmp->next) {
+    MpegTSParsePad *tspad = gst_pad_get_element_private ((GstPad *) tmp->data);
+    MpegTSBaseProgram *bp = (MpegTSBaseProgram *) tspad->program;
+
+    if (tspad->program_number == -1) {
+      parse->unfiltered_pads = g_slist_prepend (parse->unfiltered_pads, tspad);
+      continue;
+    }
+
+    /* there's a program filter on the pad but the PMT for the program has
+     * not been parsed yet, the pad gets nothing until we get a PMT */
+    if (bp == NULL)
+      continue;
+
+    /* our own PAT and the PMT of the program */
+    parse->pid_pads[0x00] = g_slist_prepend (parse->pid_pads[0x00], tspad);
+    if (bp->pmt_pid != 0x00)
+      parse->pid_pads[bp->pmt_pid] =
+          g_slist_prepend (parse->pid_pads[bp->pmt_pid], tspad);
+
+    for (s = bp->stream_list; s; s = s->next) {
+      MpegTSBaseStream *stream = s->data;
+      GSList **pads = &parse->pid_pads[stream->pid];
+
+      if (*pads == NULL || (*pads)->data != tspad)
+        *pads = g_slist_prepend (*pads, tspad);
+    }
+  }
+
+  parse->dispatch_dirty = FALSE;
+}
+
+static void
+mpegts_parse_invalidate_dispatch (MpegTSParse2 * parse)
+{
+  GST_OBJECT_LOCK (parse);
+  parse->dispatch_dirty = TRUE;
+  GST_OBJECT_UNLOCK (parse);
 }
 
 static void
@@ -232,6 +337,10 @@ mpegts_parse_reset (MpegTSBase * base)
   g_list_free_full (parse->pending_buffers, (GDestroyNotify) gst_buffer_unref);
   parse->pending_buffers = NULL;
 
+  mpegts_parse_drop_batches (parse);
+  parse->have_pat = FALSE;
+  parse->pat_remaining = 0;
+
   parse->current_pcr = GST_CLOCK_TIME_NONE;
   parse->previous_pcr = GST_CLOCK_TIME_NONE;
   parse->base_pcr = GST_CLOCK_TIME_NONE;
@@ -362,6 +471,12 @@ push_event (MpegTSBase * base, GstEvent * event)
   if (G_UNLIKELY (GST_EVENT_TYPE (event) == GST_EVENT_EOS))
     drain_pending_buffers (parse, TRUE);
 
+  /* the program pads get their packets before any later event */
+  if (G_UNLIKELY (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP))
+    mpegts_parse_drop_batches (parse);
+  else if (GST_EVENT_IS_SERIALIZED (event))
+    mpegts_parse_push_batches (parse);
+
   if (G_UNLIKELY (GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT))
     parse->ts_offset = 0;
 
@@ -393,8 +508,6 @@ mpegts_parse_create_tspad (MpegTSParse2 * parse, const gchar * pad_name)
   tspad->pad = pad;
   tspad->program_number = -1;
   tspad->program = NULL;
-  tspad->pushed = FALSE;
-  tspad->flow_return = GST_FLOW_NOT_LINKED;
   gst_pad_set_element_private (pad, tspad);
 
   return tspad;
@@ -403,6 +516,11 @@ mpegts_parse_create_tspad (MpegTSParse2 * parse, const gchar * pad_name)
 static void
 mpegts_parse_destroy_tspad (MpegTSParse2 * parse, MpegTSParsePad * tspad)
 {
+  if (tspad->batch) {
+    gst_buffer_unmap (tspad->batch, &tspad->batch_map);
+    gst_buffer_unref (tspad->batch);
+  }
+
   /* free the wrapper */
   g_free (tspad);
 }
@@ -417,16 +535,22 @@ mpegts_parse_pad_removed (GstElement * element, GstPad * pad)
   if (gst_pad_get_direction (pad) == GST_PAD_SINK)
     return;
 
+  GST_OBJECT_LOCK (parse);
   tspad = (MpegTSParsePad *) gst_pad_get_element_private (pad);
   if (tspad) {
+    if (tspad->program)
+      tspad->program->tspad = NULL;
     mpegts_parse_destroy_tspad (parse, tspad);
+    gst_pad_set_element_private (pad, NULL);
 
     parse->srcpads = g_list_remove_all (parse->srcpads, pad);
+    parse->dispatch_dirty = TRUE;
   }
   if (parse->srcpads == NULL) {
     base->push_data = FALSE;
     base->push_section = FALSE;
   }
+  GST_OBJECT_UNLOCK (parse);
 
   if (GST_ELEMENT_CLASS (parent_class)->pad_removed)
     GST_ELEMENT_CLASS (parent_class)->pad_removed (element, pad);
@@ -468,9 +592,12 @@ mpegts_parse_request_new_pad (GstElement * element, GstPadTemplate * template,
   }
 
   pad = tspad->pad;
+  GST_OBJECT_LOCK (parse);
   parse->srcpads = g_list_append (parse->srcpads, pad);
+  parse->dispatch_dirty = TRUE;
   base->push_data = TRUE;
   base->push_section = TRUE;
+  GST_OBJECT_UNLOCK (parse);
 
   gst_pad_set_active (pad, TRUE);
 
@@ -509,11 +636,146 @@ mpegts_parse_release_pad (GstElement * element, GstPad * pad)
   gst_element_remove_pad (element, pad);
 }
 
-static GstFlowReturn
+/* Adds a packet to the batch of @tspad. A full batch is moved to @full to
+ * be pushed once the OBJECT_LOCK is released */
+static void
+mpegts_parse_tspad_append (MpegTSParsePad * tspad, const guint8 * data,
+    GList ** full)
+{
+  if (G_UNLIKELY (tspad->batch == NULL)) {
+    tspad->batch = gst_buffer_new_allocate (NULL,
+        MAX_BATCH_PACKETS * MPEGTS_NORMAL_PACKETSIZE, NULL);
+    gst_buffer_map (tspad->batch, &tspad->batch_map, GST_MAP_WRITE);
+    tspad->batch_size = 0;
+  }
+
+  memcpy (tspad->batch_map.data + tspad->batch_size, data,
+      MPEGTS_NORMAL_PACKETSIZE);
+  tspad->batch_size += MPEGTS_NORMAL_PACKETSIZE;
+
+  if (G_UNLIKELY (tspad->batch_size == tspad->batch_map.size)) {
+    MpegTSParseBatch *batch = g_slice_new (MpegTSParseBatch);
+
+    gst_buffer_unmap (tspad->batch, &tspad->batch_map);
+    batch->pad = gst_object_ref (tspad->pad);
+    batch->buffer = tspad->batch;
+    tspad->batch = NULL;
+    *full = g_list_append (*full, batch);
+  }
+}
+
+/* Builds the PAT we output instead of the latest one, listing only the
+ * program of @tspad. It is only rebuilt when the PAT or the program
+ * changes */
+static gboolean
+mpegts_parse_tspad_update_pat (MpegTSParse2 * parse, MpegTSParsePad * tspad)
+{
+  MpegTSBaseProgram *bp = (MpegTSBaseProgram *) tspad->program;
+  GstMpegtsPatProgram *program;
+  GstMpegtsSection *pat;
+  GPtrArray *programs;
+  guint8 *data;
+  gsize size;
+
+  if (tspad->have_pat && tspad->pat_crc == parse->pat_crc &&
+      tspad->pat_pmt_pid == bp->pmt_pid)
+    return TRUE;
+
+  programs = gst_mpegts_pat_new ();
+  program = gst_mpegts_pat_program_new ();
+  program->program_number = tspad->program_number;
+  program->network_or_program_map_PID = bp->pmt_pid;
+  g_ptr_array_add (programs, program);
+
+  pat = gst_mpegts_section_from_pat (programs, parse->pat_ts_id);
+  pat->version_number = parse->pat_version;
+  data = gst_mpegts_section_packetize (pat, &size);
+  if (data == NULL || size > MPEGTS_NORMAL_PACKETSIZE - 5) {
+    gst_mpegts_section_unref (pat);
+    return FALSE;
+  }
+
+  /* PUSI on PID 0, payload only, and a zero pointer_field */
+  tspad->pat_packet[0] = 0x47;
+  tspad->pat_packet[1] = 0x40;
+  tspad->pat_packet[2] = 0x00;
+  tspad->pat_packet[3] = 0x10;
+  tspad->pat_packet[4] = 0x00;
+  memcpy (tspad->pat_packet + 5, data, size);
+  memset (tspad->pat_packet + 5 + size, 0xff,
+      MPEGTS_NORMAL_PACKETSIZE - 5 - size);
+  gst_mpegts_section_unref (pat);
+
+  tspad->have_pat = TRUE;
+  tspad->pat_crc = parse->pat_crc;
+  tspad->pat_pmt_pid = bp->pmt_pid;
+
+  return TRUE;
+}
+
+/* Returns TRUE if a PAT section ends in @packet, so that a PAT spanning
+ * several packets is only replaced by ours once, on its last packet */
+static gboolean
+mpegts_parse_pat_section_ends (MpegTSParse2 * parse,
+    MpegTSPacketizerPacket * packet)
+{
+  const guint8 *data = packet->payload;
+  gboolean ends = FALSE;
+  guint avail, pointer, section_length;
+
+  if (data == NULL || data >= packet->data_end)
+    return FALSE;
+  avail = packet->data_end - data;
+
+  if (!packet->payload_unit_start_indicator) {
+    if (parse->pat_remaining == 0)
+      return FALSE;
+    if (parse->pat_remaining <= avail) {
+      parse->pat_remaining = 0;
+      return TRUE;
+    }
+    parse->pat_remaining -= avail;
+    return FALSE;
+  }
+
+  /* the pointer_field skips the end of the previous section */
+  pointer = data[0];
+  if (parse->pat_remaining > 0 && parse->pat_remaining <= pointer)
+    ends = TRUE;
+  parse->pat_remaining = 0;
+
+  if (1 + pointer + 3 > avail)
+    return ends;
+  data += 1 + pointer;
+  avail -= 1 + pointer;
+
+  section_length = 3 + (GST_READ_UINT16_BE (data + 1) & 0x0fff);
+  if (section_length <= avail)
+    return TRUE;
+
+  parse->pat_remaining = section_length - avail;
+  return ends;
+}
+
+/* Pushes our PAT in place of the one ending in the current packet */
+static gboolean
+mpegts_parse_tspad_push_pat (MpegTSParse2 * parse, MpegTSParsePad * tspad,
+    GList ** full)
+{
+  if (!parse->have_pat || !mpegts_parse_tspad_update_pat (parse, tspad))
+    return FALSE;
+
+  tspad->pat_packet[3] = 0x10 | (tspad->pat_cc++ & 0x0f);
+  mpegts_parse_tspad_append (tspad, tspad->pat_packet, full);
+
+  return TRUE;
+}
+
+static void
 mpegts_parse_tspad_push_section (MpegTSParse2 * parse, MpegTSParsePad * tspad,
-    GstMpegtsSection * section, MpegTSPacketizerPacket * packet)
+    GstMpegtsSection * section, MpegTSPacketizerPacket * packet,
+    GList ** full)
 {
-  GstFlowReturn ret = GST_FLOW_OK;
   gboolean to_push = TRUE;
 
   if (tspad->program_number != -1) {
@@ -524,6 +786,10 @@ mpegts_parse_tspad_push_section (MpegTSParse2 * parse, MpegTSParsePad * tspad,
         /* PMT */
         if (section->subtable_extension != tspad->program_number)
           to_push = FALSE;
+      } else if (section->table_id == 0x00 && packet->pid == 0x00) {
+        /* PAT, replaced by one with only our program */
+        if (mpegts_parse_tspad_push_pat (parse, tspad, full))
+          to_push = FALSE;
       }
     } else {
       /* there's a program filter on the pad but the PMT for the program has not
@@ -536,55 +802,95 @@ mpegts_parse_tspad_push_section (MpegTSParse2 * parse, MpegTSParsePad * tspad,
       "pushing section: %d program number: %d table_id: %d", to_push,
       tspad->program_number, section->table_id);
 
-  if (to_push) {
-    GstBuffer *buf =
-        gst_buffer_new_and_alloc (packet->data_end - packet->data_start);
-    gst_buffer_fill (buf, 0, packet->data_start,
-        packet->data_end - packet->data_start);
-    ret = gst_pad_push (tspad->pad, buf);
-  }
-
-  return ret;
+  if (to_push)
+    mpegts_parse_tspad_append (tspad, packet->data_start, full);
 }
 
 static GstFlowReturn
-mpegts_parse_tspad_push (MpegTSParse2 * parse, MpegTSParsePad * tspad,
-    MpegTSPacketizerPacket * packet)
+mpegts_parse_push_batch_list (MpegTSParse2 * parse, GList * batches)
 {
-  GstFlowReturn ret = GST_FLOW_OK;
-  MpegTSBaseStream **pad_pids = NULL;
+  GstFlowReturn ret, flow_return;
+  GList *tmp;
 
-  if (tspad->program_number != -1) {
-    if (tspad->program) {
-      MpegTSBaseProgram *bp = (MpegTSBaseProgram *) tspad->program;
-      pad_pids = bp->streams;
+  ret = batches ? GST_FLOW_NOT_LINKED : GST_FLOW_OK;
+
+  for (tmp = batches; tmp; tmp = tmp->next) {
+    MpegTSParseBatch *batch = tmp->data;
+
+    GST_LOG_OBJECT (batch->pad, "pushing %" G_GSIZE_FORMAT " packets",
+        gst_buffer_get_size (batch->buffer) / MPEGTS_NORMAL_PACKETSIZE);
+
+    /* once a pad failed we only release the other batches */
+    if (ret == GST_FLOW_OK || ret == GST_FLOW_NOT_LINKED) {
+      flow_return = gst_pad_push (batch->pad, batch->buffer);
+
+      if (G_UNLIKELY (flow_return != GST_FLOW_OK
+              && flow_return != GST_FLOW_NOT_LINKED)) {
+        /* return the error upstream */
+        ret = flow_return;
+      } else if (ret == GST_FLOW_NOT_LINKED) {
+        ret = flow_return;
+      }
     } else {
-      /* there's a program filter on the pad but the PMT for the program has not
-       * been parsed yet, ignore the pad until we get a PMT */
-      goto out;
+      gst_buffer_unref (batch->buffer);
     }
-  }
 
-  if (pad_pids == NULL || pad_pids[packet->pid]) {
-    GstBuffer *buf =
-        gst_buffer_new_and_alloc (packet->data_end - packet->data_start);
-    gst_buffer_fill (buf, 0, packet->data_start,
-        packet->data_end - packet->data_start);
-    /* push if there's no filter or if the pid is in the filter */
-    ret = gst_pad_push (tspad->pad, buf);
+    gst_object_unref (batch->pad);
+    g_slice_free (MpegTSParseBatch, batch);
   }
+  g_list_free (batches);
 
-out:
   return ret;
 }
 
+static GList *
+mpegts_parse_take_batches (MpegTSParse2 * parse)
+{
+  GList *tmp, *batches = NULL;
+
+  GST_OBJECT_LOCK (parse);
+  for (tmp = parse->srcpads; tmp; tmp = tmp->next) {
+    MpegTSParsePad *tspad = gst_pad_get_element_private ((GstPad *) tmp->data);
+    MpegTSParseBatch *batch;
+
+    if (tspad->batch == NULL)
+      continue;
+
+    gst_buffer_unmap (tspad->batch, &tspad->batch_map);
+    gst_buffer_resize (tspad->batch, 0, tspad->batch_size);
+
+    batch = g_slice_new (MpegTSParseBatch);
+    batch->pad = gst_object_ref (tspad->pad);
+    batch->buffer = tspad->batch;
+    tspad->batch = NULL;
+    batches = g_list_prepend (batches, batch);
+  }
+  GST_OBJECT_UNLOCK (parse);
+
+  return g_list_reverse (batches);
+}
+
+/* Pushes what the program pads collected so far */
+static GstFlowReturn
+mpegts_parse_push_batches (MpegTSParse2 * parse)
+{
+  return mpegts_parse_push_batch_list (parse,
+      mpegts_parse_take_batches (parse));
+}
+
 static void
-pad_clear_for_push (GstPad * pad, MpegTSParse2 * parse)
+mpegts_parse_drop_batches (MpegTSParse2 * parse)
 {
-  MpegTSParsePad *tspad = (MpegTSParsePad *) gst_pad_get_element_private (pad);
+  GList *tmp, *batches = mpegts_parse_take_batches (parse);
+
+  for (tmp = batches; tmp; tmp = tmp->next) {
+    MpegTSParseBatch *batch = tmp->data;
 
-  tspad->flow_return = GST_FLOW_NOT_LINKED;
-  tspad->pushed = FALSE;
+    gst_buffer_unref (batch->buffer);
+    gst_object_unref (batch->pad);
+    g_slice_free (MpegTSParseBatch, batch);
+  }
+  g_list_free (batches);
 }
 
 static GstFlowReturn
@@ -592,80 +898,50 @@ mpegts_parse_push (MpegTSBase * base, MpegTSPacketizerPacket * packet,
     GstMpegtsSection * section)
 {
   MpegTSParse2 *parse = (MpegTSParse2 *) base;
-  guint32 pads_cookie;
-  gboolean done = FALSE;
-  GstPad *pad = NULL;
-  MpegTSParsePad *tspad;
-  GstFlowReturn ret;
-  GList *srcpads;
+  GList *full = NULL;
+  GSList *tmp;
+  gboolean pat_ends = FALSE;
 
   GST_OBJECT_LOCK (parse);
-  srcpads = parse->srcpads;
-
-  /* clear tspad->pushed on pads */
-  g_list_foreach (srcpads, (GFunc) pad_clear_for_push, parse);
-  if (srcpads)
-    ret = GST_FLOW_NOT_LINKED;
-  else
-    ret = GST_FLOW_OK;
-
-  /* Get cookie and source pads list */
-  pads_cookie = GST_ELEMENT_CAST (parse)->pads_cookie;
-  if (G_LIKELY (srcpads)) {
-    pad = GST_PAD_CAST (srcpads->data);
-    g_object_ref (pad);
-  }
-  GST_OBJECT_UNLOCK (parse);
-
-  while (pad && !done) {
-    tspad = gst_pad_get_element_private (pad);
+  if (G_UNLIKELY (parse->dispatch_dirty))
+    mpegts_parse_update_dispatch (parse);
 
-    if (G_LIKELY (!tspad->pushed)) {
-      if (section) {
-        tspad->flow_return =
-            mpegts_parse_tspad_push_section (parse, tspad, section, packet);
-      } else {
-        tspad->flow_return = mpegts_parse_tspad_push (parse, tspad, packet);
-      }
-      tspad->pushed = TRUE;
+  if (packet->pid == 0x00)
+    pat_ends = mpegts_parse_pat_section_ends (parse, packet);
 
-      if (G_UNLIKELY (tspad->flow_return != GST_FLOW_OK
-              && tspad->flow_return != GST_FLOW_NOT_LINKED)) {
-        /* return the error upstream */
-        ret = tspad->flow_return;
-        done = TRUE;
-      }
+  if (section) {
+    GList *l;
 
+    if (section->table_id == 0x00 && packet->pid == 0x00) {
+      parse->have_pat = TRUE;
+      parse->pat_crc = section->crc;
+      parse->pat_ts_id = section->subtable_extension;
+      parse->pat_version = section->version_number;
     }
 
-    if (ret == GST_FLOW_NOT_LINKED)
-      ret = tspad->flow_return;
-
-    g_object_unref (pad);
-
-    if (G_UNLIKELY (!done)) {
-      GST_OBJECT_LOCK (parse);
-      if (G_UNLIKELY (pads_cookie != GST_ELEMENT_CAST (parse)->pads_cookie)) {
-        /* resync */
-        GST_DEBUG ("resync");
-        pads_cookie = GST_ELEMENT_CAST (parse)->pads_cookie;
-        srcpads = parse->srcpads;
-      } else {
-        GST_DEBUG ("getting next pad");
-        /* Get next pad */
-        srcpads = g_list_next (srcpads);
-      }
-
-      if (srcpads) {
-        pad = GST_PAD_CAST (srcpads->data);
-        g_object_ref (pad);
-      } else
-        done = TRUE;
-      GST_OBJECT_UNLOCK (parse);
+    for (l = parse->srcpads; l; l = l->next)
+      mpegts_parse_tspad_push_section (parse,
+          gst_pad_get_element_private ((GstPad *) l->data), section, packet,
+          &full);
+  } else {
+    /* push if there's no filter or if the pid is in the filter. Sections we
+     * already saw and the first packets of new ones end up here too, PATs
+     * are replaced by ours on their last packet */
+    for (tmp = parse->pid_pads[packet->pid]; tmp; tmp = tmp->next) {
+      if (packet->pid != 0x00)
+        mpegts_parse_tspad_append (tmp->data, packet->data_start, &full);
+      else if (pat_ends)
+        mpegts_parse_tspad_push_pat (parse, tmp->data, &full);
     }
+    for (tmp = parse->unfiltered_pads; tmp; tmp = tmp->next)
+      mpegts_parse_tspad_append (tmp->data, packet->data_start, &full);
   }
+  GST_OBJECT_UNLOCK (parse);
 
-  return ret;
+  if (G_UNLIKELY (full))
+    return mpegts_parse_push_batch_list (parse, full);
+
+  return GST_FLOW_OK;
 }
 
 static void
@@ -844,6 +1120,13 @@ mpegts_parse_input_done (MpegTSBase * base, GstBuffer * buffer)
 
   GST_LOG_OBJECT (parse, "Received buffer %" GST_PTR_FORMAT, buffer);
 
+  /* the program pads get everything we found in this buffer at once */
+  ret = mpegts_parse_push_batches (parse);
+  if (ret != GST_FLOW_OK) {
+    gst_buffer_unref (buffer);
+    return ret;
+  }
+
   if (parse->current_pcr != GST_CLOCK_TIME_NONE) {
     GST_DEBUG_OBJECT (parse,
         "InputTS %" GST_TIME_FORMAT " PCR %" GST_TIME_FORMAT,
@@ -907,6 +1190,8 @@ mpegts_parse_program_started (MpegTSBase * base, MpegTSBaseProgram * program)
     tspad->program = parseprogram;
     parseprogram->tspad = tspad;
   }
+
+  mpegts_parse_invalidate_dispatch (parse);
 }
 
 static void
@@ -921,14 +1206,30 @@ mpegts_parse_program_stopped (MpegTSBase * base, MpegTSBaseProgram * program)
 
   if (tspad) {
     tspad->program = NULL;
+    tspad->have_pat = FALSE;
     parseprogram->tspad = NULL;
   }
 
+  mpegts_parse_invalidate_dispatch (parse);
+
   parse->pcr_pid = -1;
   parse->ts_offset += parse->current_pcr - parse->base_pcr;
   parse->base_pcr = GST_CLOCK_TIME_NONE;
 }
 
+static void
+mpegts_parse_stream_added (MpegTSBase * base, MpegTSBaseStream * stream,
+    MpegTSBaseProgram * program)
+{
+  mpegts_parse_invalidate_dispatch (GST_MPEGTS_PARSE (base));
+}
+
+static void
+mpegts_parse_stream_removed (MpegTSBase * base, MpegTSBaseStream * stream)
+{
+  mpegts_parse_invalidate_dispatch (GST_MPEGTS_PARSE (base));
+}
+
 static gboolean
 mpegts_parse_src_pad_query (GstPad * pad, GstObject * parent, GstQuery * query)
 {
@@ -63,6 +63,20 @@ struct _MpegTSParse2 {
 
   GList *srcpads;
 
+  /* Program pads each PID goes to, and the pads without a program filter.
+   * Rebuilt with the OBJECT_LOCK when dispatch_dirty is set */
+  GSList **pid_pads;
+  GSList *unfiltered_pads;
+  gboolean dispatch_dirty;
+
+  /* Latest PAT, the program pads get one listing only their program */
+  gboolean have_pat;
+  guint32 pat_crc;
+  guint16 pat_ts_id;
+  guint8 pat_version;
+  /* bytes of the PAT section in progress still to come on PID 0 */
+  guint pat_remaining;
+
   /* state */
   gboolean first;
   gboolean set_timestamps;
@@ -47,6 +47,7 @@
 #include <gst/codecparsers/gsth264parser.h>
 #include <gst/codecparsers/gstmpegvideoparser.h>
 #include <gst/base/gstbytewriter.h>
+#include <gst/base/gstbitreader.h>
 
 /*
  * tsdemux
@@ -193,6 +194,11 @@ struct _TSDemuxStream
 
   GstClockTime seeked_pts, seeked_dts;
 
+  /* Offset of the packet starting the current PES, and whether its
+   * random_access_indicator was set */
+  guint64 pes_offset;
+  gboolean random_access;
+
   GstTsDemuxKeyFrameScanFunction scan_function;
   TSDemuxH264ParsingInfos h264infos;
 };
@@ -265,6 +271,7 @@ enum
   PROP_0,
   PROP_PROGRAM_NUMBER,
   PROP_EMIT_STATS,
+  PROP_INDEX_LOCATION,
   /* FILL ME */
 };
 
@@ -292,6 +299,10 @@ static void gst_ts_demux_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_ts_demux_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
+static GstStateChangeReturn gst_ts_demux_change_state (GstElement * element,
+    GstStateChange transition);
+static void gst_ts_demux_load_index (GstTSDemux * demux);
+static void gst_ts_demux_save_index (GstTSDemux * demux);
 static void gst_ts_demux_flush_streams (GstTSDemux * tsdemux, gboolean hard);
 static GstFlowReturn
 gst_ts_demux_push_pending_data (GstTSDemux * demux, TSDemuxStream * stream);
@@ -328,6 +339,17 @@ gst_ts_demux_dispose (GObject * object)
   GST_CALL_PARENT (G_OBJECT_CLASS, dispose, (object));
 }
 
+static void
+gst_ts_demux_finalize (GObject * object)
+{
+  GstTSDemux *demux = GST_TS_DEMUX_CAST (object);
+
+  g_array_free (demux->index, TRUE);
+  g_free (demux->index_location);
+
+  GST_CALL_PARENT (G_OBJECT_CLASS, finalize, (object));
+}
+
 static void
 gst_ts_demux_class_init (GstTSDemuxClass * klass)
 {
@@ -339,6 +361,7 @@ gst_ts_demux_class_init (GstTSDemuxClass * klass)
   gobject_class->set_property = gst_ts_demux_set_property;
   gobject_class->get_property = gst_ts_demux_get_property;
   gobject_class->dispose = gst_ts_demux_dispose;
+  gobject_class->finalize = gst_ts_demux_finalize;
 
   g_object_class_install_property (gobject_class, PROP_PROGRAM_NUMBER,
       g_param_spec_int ("program-number", "Program number",
@@ -350,7 +373,14 @@ gst_ts_demux_class_init (GstTSDemuxClass * klass)
           "Emit messages for every pcr/opcr/pts/dts", FALSE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_INDEX_LOCATION,
+      g_param_spec_string ("index-location", "Index location",
+          "File to load the keyframe index from when opening the stream and "
+          "to save it to when closing it", NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   element_class = GST_ELEMENT_CLASS (klass);
+  element_class->change_state = GST_DEBUG_FUNCPTR (gst_ts_demux_change_state);
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&video_template));
   gst_element_class_add_pad_template (element_class,
@@ -401,6 +431,14 @@ gst_ts_demux_reset (MpegTSBase * base)
   demux->group_id = G_MAXUINT;
 
   demux->last_seek_offset = -1;
+
+  /* also called from the base class init, before we made the index */
+  if (demux->index)
+    g_array_set_size (demux->index, 0);
+  demux->index_pid = -1;
+  demux->index_loaded = FALSE;
+  demux->have_index_key = FALSE;
+  demux->index_last_offset = -1;
 }
 
 static void
@@ -414,6 +452,7 @@ gst_ts_demux_init (GstTSDemux * demux)
   base->push_section = FALSE;
 
   demux->flowcombiner = gst_flow_combiner_new ();
+  demux->index = g_array_new (FALSE, FALSE, sizeof (TSDemuxIndexEntry));
   demux->requested_program_number = -1;
   demux->program_number = -1;
   gst_ts_demux_reset (base);
@@ -435,6 +474,12 @@ gst_ts_demux_set_property (GObject * object, guint prop_id,
     case PROP_EMIT_STATS:
       demux->emit_statistics = g_value_get_boolean (value);
       break;
+    case PROP_INDEX_LOCATION:
+      GST_OBJECT_LOCK (demux);
+      g_free (demux->index_location);
+      demux->index_location = g_value_dup_string (value);
+      GST_OBJECT_UNLOCK (demux);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
   }
@@ -453,6 +498,11 @@ gst_ts_demux_get_property (GObject * object, guint prop_id,
     case PROP_EMIT_STATS:
       g_value_set_boolean (value, demux->emit_statistics);
       break;
+    case PROP_INDEX_LOCATION:
+      GST_OBJECT_LOCK (demux);
+      g_value_set_string (value, demux->index_location);
+      GST_OBJECT_UNLOCK (demux);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
   }
@@ -784,6 +834,161 @@ gst_ts_demux_adjust_seek_offset_for_keyframe (TSDemuxStream * stream,
   return TRUE;
 }
 
+static gboolean
+read_golomb (GstBitReader * br, guint32 * value)
+{
+  guint leading_zeros = 0;
+  guint32 suffix = 0;
+  guint8 bit;
+
+  do {
+    if (!gst_bit_reader_get_bits_uint8 (br, &bit, 1))
+      return FALSE;
+  } while (!bit && ++leading_zeros < 32);
+
+  if (!bit)
+    return FALSE;
+  if (leading_zeros > 0 &&
+      !gst_bit_reader_get_bits_uint32 (br, &suffix, leading_zeros))
+    return FALSE;
+
+  *value = (1 << leading_zeros) - 1 + suffix;
+  return TRUE;
+}
+
+/* Checks whether the PES payload in @data starts a keyframe of the indexed
+ * stream. Only the headers up to the first picture are looked at */
+static gboolean
+gst_ts_demux_is_keyframe (TSDemuxStream * stream, const guint8 * data,
+    gsize size)
+{
+  MpegTSBaseStream *bs = (MpegTSBaseStream *) stream;
+  GstBitReader br;
+  guint32 first_mb, slice_type;
+  gsize i;
+
+  if (stream->random_access)
+    return TRUE;
+
+  for (i = 0; i + 5 < size; i++) {
+    if (data[i] != 0x00 || data[i + 1] != 0x00 || data[i + 2] != 0x01)
+      continue;
+
+    if (bs->stream_type == GST_MPEGTS_STREAM_TYPE_VIDEO_H264) {
+      switch (data[i + 3] & 0x1f) {
+        case GST_H264_NAL_SLICE_IDR:
+          return TRUE;
+        case GST_H264_NAL_SLICE:
+          /* I slices of open GOPs are keyframes too */
+          gst_bit_reader_init (&br, data + i + 4, size - i - 4);
+          if (!read_golomb (&br, &first_mb) || !read_golomb (&br, &slice_type))
+            return FALSE;
+          return first_mb == 0 && (slice_type % 5 == GST_H264_I_SLICE ||
+              slice_type % 5 == GST_H264_SI_SLICE);
+        case GST_H264_NAL_SLICE_DPA:
+        case GST_H264_NAL_SLICE_DPB:
+        case GST_H264_NAL_SLICE_DPC:
+          return FALSE;
+        default:
+          break;
+      }
+    } else if (data[i + 3] == 0x00) {
+      /* MPEG-1/2 picture header, picture_coding_type 1 is I */
+      return ((data[i + 5] >> 3) & 0x7) == 1;
+    }
+  }
+
+  return FALSE;
+}
+
+/* Returns the last index entry at or before @offset, or -1 */
+static gint
+gst_ts_demux_index_find (GstTSDemux * demux, guint64 offset)
+{
+  gint lo = 0, hi = (gint) demux->index->len - 1, found = -1;
+
+  while (lo <= hi) {
+    gint mid = lo + (hi - lo) / 2;
+
+    if (g_array_index (demux->index, TSDemuxIndexEntry, mid).offset <= offset) {
+      found = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+
+  return found;
+}
+
+/* Records a keyframe with PTS @ts starting at @offset. Keyframes that would
+ * break the ordering, e.g. after a PCR discontinuity, are not indexed */
+static void
+gst_ts_demux_index_add (GstTSDemux * demux, GstClockTime ts, guint64 offset)
+{
+  TSDemuxIndexEntry entry, *prev = NULL, *next = NULL;
+  gint i;
+
+  i = gst_ts_demux_index_find (demux, offset);
+  if (i >= 0)
+    prev = &g_array_index (demux->index, TSDemuxIndexEntry, i);
+  if (i + 1 < (gint) demux->index->len)
+    next = &g_array_index (demux->index, TSDemuxIndexEntry, i + 1);
+
+  if (prev == NULL || prev->offset != offset) {
+    if ((prev && prev->ts >= ts) || (next && next->ts <= ts)) {
+      GST_DEBUG_OBJECT (demux, "keyframe %" GST_TIME_FORMAT " at %"
+          G_GUINT64_FORMAT " out of order, not indexing it",
+          GST_TIME_ARGS (ts), offset);
+      demux->index_last_offset = -1;
+      return;
+    }
+
+    entry.ts = ts;
+    entry.offset = offset;
+    entry.contiguous = FALSE;
+    g_array_insert_val (demux->index, ++i, entry);
+
+    GST_LOG_OBJECT (demux, "indexed keyframe %" GST_TIME_FORMAT " at %"
+        G_GUINT64_FORMAT, GST_TIME_ARGS (ts), offset);
+  }
+
+  /* we went from the previous keyframe to this one without a jump, so
+   * there is no other keyframe in between */
+  if (i > 0) {
+    prev = &g_array_index (demux->index, TSDemuxIndexEntry, i - 1);
+    if (prev->offset == demux->index_last_offset)
+      prev->contiguous = TRUE;
+  }
+  demux->index_last_offset = offset;
+}
+
+/* Returns the last keyframe at or before @ts, or -1 if the index doesn't
+ * cover @ts */
+static gint
+gst_ts_demux_index_lookup (GstTSDemux * demux, GstClockTime ts)
+{
+  gint lo = 0, hi = (gint) demux->index->len - 1, found = -1;
+
+  while (lo <= hi) {
+    gint mid = lo + (hi - lo) / 2;
+
+    if (g_array_index (demux->index, TSDemuxIndexEntry, mid).ts <= ts) {
+      found = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+
+  /* only trust the entry if we know the next keyframe is after @ts */
+  if (found < 0 || found + 1 >= (gint) demux->index->len ||
+      !g_array_index (demux->index, TSDemuxIndexEntry, found).contiguous)
+    return -1;
+
+  return found;
+}
+
 static GstFlowReturn
 gst_ts_demux_do_seek (MpegTSBase * base, GstEvent * event)
 {
@@ -819,9 +1024,34 @@ gst_ts_demux_do_seek (MpegTSBase * base, GstEvent * event)
   GST_DEBUG_OBJECT (demux, "configuring seek");
 
   if (start_type != GST_SEEK_TYPE_NONE) {
-    start_offset =
-        mpegts_packetizer_ts_to_offset (base->packetizer, MAX (0,
-            start - SEEK_TIMESTAMP_OFFSET), demux->program->pcr_pid);
+    gint i = gst_ts_demux_index_lookup (demux, start);
+
+    if (i >= 0) {
+      /* we know where the keyframe is, no need to search for it */
+      TSDemuxIndexEntry *entry =
+          &g_array_index (demux->index, TSDemuxIndexEntry, i);
+
+      if ((flags & GST_SEEK_FLAG_KEY_UNIT) && entry->ts != start) {
+        TSDemuxIndexEntry *next = entry + 1;
+
+        if ((flags & GST_SEEK_FLAG_SNAP_NEAREST) ==
+            GST_SEEK_FLAG_SNAP_NEAREST) {
+          if (next->ts - start < start - entry->ts)
+            entry = next;
+        } else if (flags & GST_SEEK_FLAG_SNAP_AFTER) {
+          entry = next;
+        }
+        start = entry->ts;
+      }
+      start_offset = entry->offset;
+
+      GST_DEBUG_OBJECT (demux, "using indexed keyframe %" GST_TIME_FORMAT
+          " at %" G_GUINT64_FORMAT, GST_TIME_ARGS (entry->ts), start_offset);
+    } else {
+      start_offset =
+          mpegts_packetizer_ts_to_offset (base->packetizer, MAX (0,
+              start - SEEK_TIMESTAMP_OFFSET), demux->program->pcr_pid);
+    }
 
     if (G_UNLIKELY (start_offset == -1)) {
       GST_WARNING ("Couldn't convert start position to an offset");
@@ -846,6 +1076,7 @@ gst_ts_demux_do_seek (MpegTSBase * base, GstEvent * event)
   /* record offset and rate */
   base->seek_offset = start_offset;
   demux->last_seek_offset = base->seek_offset;
+  demux->index_last_offset = -1;
   demux->rate = rate;
   res = GST_FLOW_OK;
 
@@ -1433,6 +1664,16 @@ gst_ts_demux_stream_added (MpegTSBase * base, MpegTSBaseStream * bstream,
       stream->scan_function = NULL;
     }
 
+    /* index the keyframes of the first video stream we can parse */
+    if (demux->index_pid == -1 &&
+        (bstream->stream_type == GST_MPEGTS_STREAM_TYPE_VIDEO_H264 ||
+            bstream->stream_type == GST_MPEGTS_STREAM_TYPE_VIDEO_MPEG1 ||
+            bstream->stream_type == GST_MPEGTS_STREAM_TYPE_VIDEO_MPEG2)) {
+      GST_DEBUG_OBJECT (demux, "indexing keyframes of pid 0x%04x",
+          bstream->pid);
+      demux->index_pid = bstream->pid;
+    }
+
     stream->active = FALSE;
 
     stream->need_newsegment = TRUE;
@@ -1600,6 +1841,11 @@ gst_ts_demux_program_started (MpegTSBase * base, MpegTSBaseProgram * program)
     demux->program_number = program->program_number;
     demux->program = program;
 
+    if (!demux->index_loaded) {
+      gst_ts_demux_load_index (demux);
+      demux->index_loaded = TRUE;
+    }
+
     /* If this is not the initial program, we need to calculate
      * a new segment */
     if (demux->segment_event) {
@@ -1944,6 +2190,10 @@ gst_ts_demux_queue_data (GstTSDemux * demux, TSDemuxStream * stream,
     {
       GST_LOG ("HEADER: Parsing PES header");
 
+      stream->pes_offset = packet->offset;
+      stream->random_access =
+          (packet->afc_flags & MPEGTS_AFC_RANDOM_ACCES_FLAGS) != 0;
+
       /* parse the header */
       gst_ts_demux_parse_pes_header (demux, stream, data, size, packet->offset);
       break;
@@ -2136,9 +2386,7 @@ static GstFlowReturn
 gst_ts_demux_push_pending_data (GstTSDemux * demux, TSDemuxStream * stream)
 {
   GstFlowReturn res = GST_FLOW_OK;
-#ifndef GST_DISABLE_GST_DEBUG
   MpegTSBaseStream *bs = (MpegTSBaseStream *) stream;
-#endif
   GstBuffer *buffer = NULL;
 
   GST_DEBUG_OBJECT (stream->pad,
@@ -2183,6 +2431,7 @@ gst_ts_demux_push_pending_data (GstTSDemux * demux, TSDemuxStream * stream)
       if (demux->last_seek_offset < 200 * base->packetsize)
         base->seek_offset = 0;
       demux->last_seek_offset = base->seek_offset;
+      demux->index_last_offset = -1;
       mpegts_packetizer_flush (base->packetizer, FALSE);
       base->mode = BASE_MODE_SEEKING;
 
@@ -2206,6 +2455,15 @@ gst_ts_demux_push_pending_data (GstTSDemux * demux, TSDemuxStream * stream)
     }
   }
 
+  if (bs->pid == demux->index_pid && GST_CLOCK_TIME_IS_VALID (stream->pts)) {
+    GstMapInfo map;
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    if (gst_ts_demux_is_keyframe (stream, map.data, map.size))
+      gst_ts_demux_index_add (demux, stream->pts, stream->pes_offset);
+    gst_buffer_unmap (buffer, &map);
+  }
+
   if (G_UNLIKELY (stream->need_newsegment))
     calculate_and_push_newsegment (demux, stream);
 
@@ -2402,6 +2660,190 @@ gst_ts_demux_push (MpegTSBase * base, MpegTSPacketizerPacket * packet,
   return res;
 }
 
+/* Index file layout, all numbers little endian 64 bit:
+ *   "GstTsIdx" ! version ! file length ! pid ! n entries ! key (24 bytes) !
+ *   n * (PTS ! offset ! contiguous)
+ * where the key is the content key of the stream, zero padded
+ */
+#define INDEX_FILE_MAGIC            "GstTsIdx"
+#define INDEX_FILE_VERSION          2
+#define INDEX_FILE_KEY_SIZE         24
+#define INDEX_FILE_HEADER_SIZE      (8 + 4 * 8 + INDEX_FILE_KEY_SIZE)
+#define INDEX_FILE_ENTRY_SIZE       (3 * 8)
+
+static gchar *
+gst_ts_demux_get_index_location (GstTSDemux * demux)
+{
+  gchar *location;
+
+  GST_OBJECT_LOCK (demux);
+  location = g_strdup (demux->index_location);
+  GST_OBJECT_UNLOCK (demux);
+
+  return location;
+}
+
+/* Restores the keyframes saved for the upstream file, if it didn't change
+ * since. The file is identified by its content key, so only in pull mode */
+static void
+gst_ts_demux_load_index (GstTSDemux * demux)
+{
+  MpegTSBase *base = (MpegTSBase *) demux;
+  gchar *location, *contents = NULL;
+  gsize size;
+  const guint8 *data;
+  guint64 n_entries, i;
+  gint64 length;
+  TSDemuxIndexEntry entry, *prev = NULL;
+  GArray *entries = NULL;
+  GError *err = NULL;
+
+  location = gst_ts_demux_get_index_location (demux);
+  if (location == NULL)
+    return;
+
+  if (demux->index_pid == -1 || base->mode == BASE_MODE_PUSHING ||
+      !gst_pad_peer_query_duration (base->sinkpad, GST_FORMAT_BYTES, &length)) {
+    GST_DEBUG_OBJECT (demux, "nothing to index, push mode or unknown "
+        "upstream size");
+    goto done;
+  }
+
+  demux->index_length = length;
+  demux->have_index_key =
+      gst_content_key_pull (base->sinkpad, length, demux->index_key);
+  if (!demux->have_index_key) {
+    GST_DEBUG_OBJECT (demux, "could not identify the stream");
+    goto done;
+  }
+
+  if (!g_file_get_contents (location, &contents, &size, &err)) {
+    GST_DEBUG_OBJECT (demux, "could not read index file: %s", err->message);
+    g_error_free (err);
+    goto done;
+  }
+
+  data = (const guint8 *) contents;
+  if (size < INDEX_FILE_HEADER_SIZE || memcmp (data, INDEX_FILE_MAGIC, 8) ||
+      GST_READ_UINT64_LE (data + 8) != INDEX_FILE_VERSION) {
+    GST_WARNING_OBJECT (demux, "%s is not a valid index file", location);
+    goto done;
+  }
+  if (GST_READ_UINT64_LE (data + 16) != length ||
+      GST_READ_UINT64_LE (data + 24) != demux->index_pid ||
+      memcmp (data + 40, demux->index_key, sizeof (demux->index_key))) {
+    GST_INFO_OBJECT (demux, "index file %s was made for another stream",
+        location);
+    goto done;
+  }
+  n_entries = GST_READ_UINT64_LE (data + 32);
+  if (n_entries > (size - INDEX_FILE_HEADER_SIZE) / INDEX_FILE_ENTRY_SIZE) {
+    GST_WARNING_OBJECT (demux, "index file %s is truncated", location);
+    goto done;
+  }
+
+  /* entries are sorted by offset and PTS and lie inside the stream */
+  entries = g_array_sized_new (FALSE, FALSE, sizeof (TSDemuxIndexEntry),
+      n_entries);
+  data += INDEX_FILE_HEADER_SIZE;
+  for (i = 0; i < n_entries; i++) {
+    entry.ts = GST_READ_UINT64_LE (data);
+    entry.offset = GST_READ_UINT64_LE (data + 8);
+    entry.contiguous = GST_READ_UINT64_LE (data + 16) != 0;
+    if (entry.offset >= length || (prev && (entry.offset <= prev->offset ||
+                entry.ts < prev->ts))) {
+      GST_WARNING_OBJECT (demux, "index file %s does not match the stream",
+          location);
+      goto done;
+    }
+    g_array_append_val (entries, entry);
+    prev = &g_array_index (entries, TSDemuxIndexEntry, entries->len - 1);
+    data += INDEX_FILE_ENTRY_SIZE;
+  }
+
+  g_array_free (demux->index, TRUE);
+  demux->index = entries;
+  entries = NULL;
+  demux->index_last_offset = -1;
+
+  GST_INFO_OBJECT (demux, "loaded %u index entries from %s",
+      demux->index->len, location);
+
+done:
+  if (entries)
+    g_array_free (entries, TRUE);
+  g_free (contents);
+  g_free (location);
+}
+
+static void
+gst_ts_demux_save_index (GstTSDemux * demux)
+{
+  gchar *location;
+  GByteArray *bytes;
+  guint8 header[INDEX_FILE_HEADER_SIZE], entry[INDEX_FILE_ENTRY_SIZE];
+  GError *err = NULL;
+  guint i;
+
+  /* the key was made when loading the index */
+  if (demux->index->len == 0 || !demux->have_index_key)
+    return;
+
+  location = gst_ts_demux_get_index_location (demux);
+  if (location == NULL)
+    return;
+
+  memcpy (header, INDEX_FILE_MAGIC, 8);
+  GST_WRITE_UINT64_LE (header + 8, INDEX_FILE_VERSION);
+  GST_WRITE_UINT64_LE (header + 16, demux->index_length);
+  GST_WRITE_UINT64_LE (header + 24, demux->index_pid);
+  GST_WRITE_UINT64_LE (header + 32, demux->index->len);
+  memset (header + 40, 0, INDEX_FILE_KEY_SIZE);
+  memcpy (header + 40, demux->index_key, sizeof (demux->index_key));
+
+  bytes = g_byte_array_sized_new (sizeof (header) +
+      demux->index->len * sizeof (entry));
+  g_byte_array_append (bytes, header, sizeof (header));
+  for (i = 0; i < demux->index->len; i++) {
+    TSDemuxIndexEntry *e = &g_array_index (demux->index, TSDemuxIndexEntry, i);
+
+    GST_WRITE_UINT64_LE (entry, e->ts);
+    GST_WRITE_UINT64_LE (entry + 8, e->offset);
+    GST_WRITE_UINT64_LE (entry + 16, e->contiguous);
+    g_byte_array_append (bytes, entry, sizeof (entry));
+  }
+
+  if (!g_file_set_contents (location, (const gchar *) bytes->data, bytes->len,
+          &err)) {
+    GST_WARNING_OBJECT (demux, "could not write index file: %s",
+        err->message);
+    g_error_free (err);
+  } else {
+    GST_INFO_OBJECT (demux, "saved %u index entries to %s",
+        demux->index->len, location);
+  }
+
+  g_byte_array_free (bytes, TRUE);
+  g_free (location);
+}
+
+static GstStateChangeReturn
+gst_ts_demux_change_state (GstElement * element, GstStateChange transition)
+{
+  GstTSDemux *demux = GST_TS_DEMUX_CAST (element);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* before the base class resets the index */
+      gst_ts_demux_save_index (demux);
+      break;
+    default:
+      break;
+  }
+
+  return GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+}
+
 gboolean
 gst_ts_demux_plugin_init (GstPlugin * plugin)
 {
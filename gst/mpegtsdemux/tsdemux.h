@@ -30,6 +30,7 @@
 #include <gst/gst.h>
 #include <gst/base/gstbytereader.h>
 #include <gst/base/gstflowcombiner.h>
+#include <gst/base/gstcontentkey.h>
 #include "mpegtsbase.h"
 #include "mpegtspacketizer.h"
 
@@ -49,6 +50,15 @@ G_BEGIN_DECLS
 #define GST_TS_DEMUX_CAST(obj) ((GstTSDemux*) obj)
 typedef struct _GstTSDemux GstTSDemux;
 typedef struct _GstTSDemuxClass GstTSDemuxClass;
+typedef struct _TSDemuxIndexEntry TSDemuxIndexEntry;
+
+/* A keyframe of the indexed video stream */
+struct _TSDemuxIndexEntry
+{
+  GstClockTime ts;		/* PTS, on the PCR timeline of the packetizer */
+  guint64 offset;		/* offset of the packet starting the PES */
+  gboolean contiguous;		/* TRUE if the next entry is the next keyframe */
+};
 
 struct _GstTSDemux
 {
@@ -62,6 +72,7 @@ struct _GstTSDemux
   gint requested_program_number; /* Required program number (ignore:-1) */
   guint program_number;
   gboolean emit_statistics;
+  gchar *index_location;
 
   /*< private >*/
   MpegTSBaseProgram *program;	/* Current program */
@@ -84,6 +95,18 @@ struct _GstTSDemux
 
   /* Used when seeking for a keyframe to go backward in the stream */
   guint64 last_seek_offset;
+
+  /* Keyframes of the first video stream seen while playing, sorted by
+   * offset and PTS */
+  GArray *index;
+  gint index_pid;
+  gboolean index_loaded;
+  /* identify the stream in the index file, only known in pull mode */
+  guint64 index_length;
+  guint8 index_key[GST_CONTENT_KEY_SIZE];
+  gboolean have_index_key;
+  /* offset of the last keyframe added while playing without a jump, or -1 */
+  guint64 index_last_offset;
 };
 
 struct _GstTSDemuxClass
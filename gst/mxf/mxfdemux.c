@@ -113,9 +113,13 @@ enum
   PROP_0,
   PROP_PACKAGE,
   PROP_MAX_DRIFT,
-  PROP_STRUCTURE
+  PROP_STRUCTURE,
+  PROP_READ_AHEAD_SIZE,
+  PROP_STATS
 };
 
+#define DEFAULT_READ_AHEAD_SIZE (256 * 1024)
+
 static gboolean gst_mxf_demux_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 static gboolean gst_mxf_demux_src_event (GstPad * pad, GstObject * parent,
@@ -170,6 +174,8 @@ gst_mxf_demux_reset_mxf_state (GstMXFDemux * demux)
 
     if (t->offsets)
       g_array_free (t->offsets, TRUE);
+    if (t->known_positions)
+      g_array_free (t->known_positions, TRUE);
 
     g_free (t->mapping_data);
 
@@ -236,6 +242,8 @@ gst_mxf_demux_reset_metadata (GstMXFDemux * demux)
 static void
 gst_mxf_demux_reset (GstMXFDemux * demux)
 {
+  guint i;
+
   GST_DEBUG_OBJECT (demux, "cleaning up MXF demuxer");
 
   demux->flushing = FALSE;
@@ -258,6 +266,18 @@ gst_mxf_demux_reset (GstMXFDemux * demux)
 
   gst_adapter_clear (demux->adapter);
 
+  if (demux->cache) {
+    GST_DEBUG_OBJECT (demux, "Read-ahead cache: %" G_GUINT64_FORMAT " hits, %"
+        G_GUINT64_FORMAT " misses", demux->cache_hits, demux->cache_misses);
+    gst_buffer_unref (demux->cache);
+    demux->cache = NULL;
+  }
+  demux->cache_offset = 0;
+  GST_OBJECT_LOCK (demux);
+  demux->cache_hits = 0;
+  demux->cache_misses = 0;
+  GST_OBJECT_UNLOCK (demux);
+
   gst_mxf_demux_remove_pads (demux);
 
   if (demux->random_index_pack) {
@@ -279,6 +299,14 @@ gst_mxf_demux_reset (GstMXFDemux * demux)
 
   demux->index_table_segments_collected = FALSE;
 
+  for (i = 0; i < demux->index_tables->len; i++) {
+    GstMXFDemuxIndexTable *t =
+        &g_array_index (demux->index_tables, GstMXFDemuxIndexTable, i);
+    g_array_free (t->offsets, TRUE);
+    g_array_free (t->known_positions, TRUE);
+  }
+  g_array_set_size (demux->index_tables, 0);
+
   gst_mxf_demux_reset_mxf_state (demux);
   gst_mxf_demux_reset_metadata (demux);
 
@@ -314,6 +342,67 @@ gst_mxf_demux_pull_range (GstMXFDemux * demux, guint64 offset,
   return ret;
 }
 
+/* Like gst_mxf_demux_pull_range() but serves small ranges from a block of
+ * read-ahead-size bytes, so that the key, length and payload of a KLV
+ * packet usually take a single upstream pull. The returned buffers share
+ * the memory of the block. Ranges of at least the block size are pulled
+ * directly. */
+static GstFlowReturn
+gst_mxf_demux_pull_range_cached (GstMXFDemux * demux, guint64 offset,
+    guint size, GstBuffer ** buffer)
+{
+  GstFlowReturn ret;
+  GstBuffer *block = NULL;
+  guint64 block_offset;
+  guint block_size;
+
+  if (demux->cache && offset >= demux->cache_offset &&
+      offset + size <=
+      demux->cache_offset + gst_buffer_get_size (demux->cache)) {
+    GST_OBJECT_LOCK (demux);
+    demux->cache_hits++;
+    GST_OBJECT_UNLOCK (demux);
+    goto hit;
+  }
+
+  GST_OBJECT_LOCK (demux);
+  demux->cache_misses++;
+  GST_OBJECT_UNLOCK (demux);
+
+  if (size >= demux->read_ahead_size)
+    return gst_mxf_demux_pull_range (demux, offset, size, buffer);
+
+  /* Start the block at a page boundary, it's cheaper for most sources */
+  block_offset = offset - offset % MIN (demux->read_ahead_size, 4096);
+  block_size = MAX (demux->read_ahead_size, offset + size - block_offset);
+
+  ret = gst_pad_pull_range (demux->sinkpad, block_offset, block_size, &block);
+  if (ret != GST_FLOW_OK || gst_buffer_get_size (block) < offset + size -
+      block_offset) {
+    /* Short read at the end of the file, let the plain pull produce the
+     * usual EOS handling */
+    if (block)
+      gst_buffer_unref (block);
+    return gst_mxf_demux_pull_range (demux, offset, size, buffer);
+  }
+
+  GST_LOG_OBJECT (demux, "Cached %" G_GSIZE_FORMAT " bytes at offset %"
+      G_GUINT64_FORMAT, gst_buffer_get_size (block), block_offset);
+
+  if (demux->cache)
+    gst_buffer_unref (demux->cache);
+  demux->cache = block;
+  demux->cache_offset = block_offset;
+
+hit:
+  *buffer = gst_buffer_copy_region (demux->cache, GST_BUFFER_COPY_MEMORY,
+      offset - demux->cache_offset, size);
+  GST_BUFFER_OFFSET (*buffer) = offset;
+  GST_BUFFER_OFFSET_END (*buffer) = offset + size;
+
+  return GST_FLOW_OK;
+}
+
 static gboolean
 gst_mxf_demux_push_src_event (GstMXFDemux * demux, GstEvent * event)
 {
@@ -1592,6 +1681,243 @@ gst_mxf_demux_pad_set_component (GstMXFDemux * demux, GstMXFDemuxPad * pad,
   return ret;
 }
 
+/* Sets entry @position of @offsets, growing it as needed, and records
+ * newly known entries in @known_positions */
+static void
+gst_mxf_demux_index_set (GArray * offsets, GArray * known_positions,
+    guint position, guint64 offset, gboolean keyframe)
+{
+  GstMXFDemuxIndex *idx;
+
+  if (offsets->len <= position)
+    g_array_set_size (offsets, position + 1);
+  idx = &g_array_index (offsets, GstMXFDemuxIndex, position);
+
+  if (idx->offset == 0 && offset != 0) {
+    guint lo = 0, hi = known_positions->len;
+
+    /* Entries are mostly learnt in order, so usually this appends */
+    if (hi > 0 && g_array_index (known_positions, guint, hi - 1) > position) {
+      while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+
+        if (g_array_index (known_positions, guint, mid) < position)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+    } else {
+      lo = hi;
+    }
+    g_array_insert_val (known_positions, lo, position);
+  }
+
+  idx->offset = offset;
+  idx->keyframe = keyframe;
+}
+
+/* Returns the last known entry of @offsets that starts at or before
+ * @offset, or -1. Known offsets grow with the position, so this is a
+ * binary search over @known_positions */
+static gint64
+gst_mxf_demux_index_find_offset (GArray * offsets, GArray * known_positions,
+    guint64 offset)
+{
+  guint lo = 0, hi = known_positions->len;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+    guint position = g_array_index (known_positions, guint, mid);
+
+    if (g_array_index (offsets, GstMXFDemuxIndex, position).offset <= offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo == 0)
+    return -1;
+
+  return g_array_index (known_positions, guint, lo - 1);
+}
+
+static GstMXFDemuxIndexTable *
+gst_mxf_demux_get_index_table (GstMXFDemux * demux, guint32 body_sid)
+{
+  guint i;
+
+  for (i = 0; i < demux->index_tables->len; i++) {
+    GstMXFDemuxIndexTable *t =
+        &g_array_index (demux->index_tables, GstMXFDemuxIndexTable, i);
+
+    if (t->body_sid == body_sid)
+      return t;
+  }
+
+  return NULL;
+}
+
+/* Only usable if the track counts edit units of the index, i.e. one
+ * essence element per content package */
+static GstMXFDemuxIndexTable *
+gst_mxf_demux_get_index_table_for_track (GstMXFDemux * demux,
+    GstMXFDemuxEssenceTrack * etrack)
+{
+  GstMXFDemuxIndexTable *table;
+
+  table = gst_mxf_demux_get_index_table (demux, etrack->body_sid);
+  if (!table || !etrack->source_track)
+    return NULL;
+
+  if (table->edit_rate.n * etrack->source_track->edit_rate.d !=
+      etrack->source_track->edit_rate.n * table->edit_rate.d)
+    return NULL;
+
+  return table;
+}
+
+static gint
+compare_partitions_by_body_offset (gconstpointer a, gconstpointer b)
+{
+  const GstMXFDemuxPartition *pa = *(const GstMXFDemuxPartition **) a;
+  const GstMXFDemuxPartition *pb = *(const GstMXFDemuxPartition **) b;
+
+  if (pa->partition.body_offset < pb->partition.body_offset)
+    return -1;
+  else if (pa->partition.body_offset > pb->partition.body_offset)
+    return 1;
+  return 0;
+}
+
+/* Merges the entries of @segment into the index table of its body.
+ * Stream offsets are translated to file offsets through the partitions
+ * whose essence container start is known, the others stay unknown until
+ * the essence is walked */
+static void
+gst_mxf_demux_merge_index_table_segment (GstMXFDemux * demux,
+    MXFIndexTableSegment * segment)
+{
+  GstMXFDemuxIndexTable *table;
+  GPtrArray *partitions;
+  GList *l;
+  gboolean have_random_access = FALSE;
+  guint64 n_entries;
+  guint i, p = 0;
+
+  if (segment->index_start_position < 0 || segment->body_sid == 0)
+    return;
+
+  if (segment->n_index_entries > 0)
+    n_entries = segment->n_index_entries;
+  else if (segment->edit_unit_byte_count > 0)
+    n_entries = segment->index_duration;
+  else
+    return;
+
+  /* Don't trust absurd durations of constant bitrate segments */
+  if (n_entries == 0 || segment->index_start_position + n_entries > G_MAXINT)
+    return;
+
+  partitions = g_ptr_array_new ();
+  for (l = demux->partitions; l; l = l->next) {
+    GstMXFDemuxPartition *tmp = l->data;
+
+    if (tmp->partition.body_sid == segment->body_sid &&
+        tmp->essence_container_offset != 0)
+      g_ptr_array_add (partitions, tmp);
+  }
+  g_ptr_array_sort (partitions, compare_partitions_by_body_offset);
+
+  if (partitions->len == 0) {
+    g_ptr_array_free (partitions, TRUE);
+    return;
+  }
+
+  table = gst_mxf_demux_get_index_table (demux, segment->body_sid);
+  if (!table) {
+    GstMXFDemuxIndexTable tmp;
+
+    tmp.body_sid = segment->body_sid;
+    tmp.edit_rate = segment->index_edit_rate;
+    tmp.offsets = g_array_new (FALSE, TRUE, sizeof (GstMXFDemuxIndex));
+    tmp.known_positions = g_array_new (FALSE, FALSE, sizeof (guint));
+    g_array_append_val (demux->index_tables, tmp);
+    table = &g_array_index (demux->index_tables, GstMXFDemuxIndexTable,
+        demux->index_tables->len - 1);
+  }
+
+  if (table->offsets->len < segment->index_start_position + n_entries)
+    g_array_set_size (table->offsets,
+        segment->index_start_position + n_entries);
+
+  /* Intra-only essence often doesn't flag random access points at all */
+  for (i = 0; i < segment->n_index_entries; i++) {
+    if (segment->index_entries[i].flags & 0x80) {
+      have_random_access = TRUE;
+      break;
+    }
+  }
+
+  for (i = 0; i < n_entries; i++) {
+    GstMXFDemuxPartition *part;
+    guint64 stream_offset;
+    gboolean keyframe;
+
+    if (segment->n_index_entries > 0) {
+      stream_offset = segment->index_entries[i].stream_offset;
+      keyframe = !have_random_access
+          || (segment->index_entries[i].flags & 0x80);
+    } else {
+      stream_offset = (segment->index_start_position + i) *
+          segment->edit_unit_byte_count;
+      keyframe = TRUE;
+    }
+
+    /* Entries are sorted, so only ever move on to later partitions */
+    while (p + 1 < partitions->len &&
+        ((GstMXFDemuxPartition *) g_ptr_array_index (partitions,
+                p + 1))->partition.body_offset <= stream_offset)
+      p++;
+    part = g_ptr_array_index (partitions, p);
+    if (part->partition.body_offset > stream_offset)
+      continue;
+
+    gst_mxf_demux_index_set (table->offsets, table->known_positions,
+        segment->index_start_position + i, part->partition.this_partition +
+        part->essence_container_offset + stream_offset -
+        part->partition.body_offset, keyframe);
+  }
+
+  GST_DEBUG_OBJECT (demux, "Merged index table segment for body %u, edit "
+      "units %" G_GINT64_FORMAT " to %" G_GINT64_FORMAT, segment->body_sid,
+      segment->index_start_position,
+      segment->index_start_position + n_entries);
+
+  g_ptr_array_free (partitions, TRUE);
+}
+
+/* Fills a gap of the index table with the first essence element seen for
+ * an edit unit, so that seeking there again doesn't need another walk */
+static void
+gst_mxf_demux_update_index_table (GstMXFDemux * demux,
+    GstMXFDemuxEssenceTrack * etrack, guint64 offset, gboolean keyframe)
+{
+  GstMXFDemuxIndexTable *table;
+  GstMXFDemuxIndex *idx;
+
+  table = gst_mxf_demux_get_index_table_for_track (demux, etrack);
+  if (!table || etrack->position < 0 || etrack->position >= table->offsets->len)
+    return;
+
+  idx = &g_array_index (table->offsets, GstMXFDemuxIndex, etrack->position);
+  if (idx->offset == 0 || offset < idx->offset) {
+    gst_mxf_demux_index_set (table->offsets, table->known_positions,
+        etrack->position, offset, keyframe);
+  } else if (!keyframe) {
+    idx->keyframe = FALSE;
+  }
+}
+
 static GstFlowReturn
 gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
     const MXFUL * key, GstBuffer * buffer, gboolean peek)
@@ -1654,18 +1980,30 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
   }
 
   if (etrack->position == -1) {
+    guint64 offset = demux->offset - demux->run_in;
+    GstMXFDemuxIndexTable *table;
+    gint64 pos;
+
     GST_DEBUG_OBJECT (demux,
         "Unknown essence track position, looking into index");
     if (etrack->offsets) {
-      for (i = 0; i < etrack->offsets->len; i++) {
-        GstMXFDemuxIndex *idx =
-            &g_array_index (etrack->offsets, GstMXFDemuxIndex, i);
+      pos = gst_mxf_demux_index_find_offset (etrack->offsets,
+          etrack->known_positions, offset);
+      if (pos != -1
+          && g_array_index (etrack->offsets, GstMXFDemuxIndex,
+              pos).offset == offset)
+        etrack->position = pos;
+    }
 
-        if (idx->offset != 0 && idx->offset == demux->offset - demux->run_in) {
-          etrack->position = i;
-          break;
-        }
-      }
+    /* Otherwise find the content package this element is part of */
+    table = gst_mxf_demux_get_index_table_for_track (demux, etrack);
+    if (etrack->position == -1 && table) {
+      pos = gst_mxf_demux_index_find_offset (table->offsets,
+          table->known_positions, offset);
+      if (pos != -1 && pos + 1 < table->offsets->len
+          && g_array_index (table->offsets, GstMXFDemuxIndex,
+              pos + 1).offset != 0)
+        etrack->position = pos;
     }
 
     if (etrack->position == -1) {
@@ -1713,26 +2051,16 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
   if (outbuf)
     keyframe = !GST_BUFFER_FLAG_IS_SET (outbuf, GST_BUFFER_FLAG_DELTA_UNIT);
 
-  if (!etrack->offsets)
+  if (!etrack->offsets) {
     etrack->offsets = g_array_new (FALSE, TRUE, sizeof (GstMXFDemuxIndex));
+    etrack->known_positions = g_array_new (FALSE, FALSE, sizeof (guint));
+  }
 
-  {
-    if (etrack->offsets->len > etrack->position) {
-      GstMXFDemuxIndex *index =
-          &g_array_index (etrack->offsets, GstMXFDemuxIndex, etrack->position);
+  gst_mxf_demux_index_set (etrack->offsets, etrack->known_positions,
+      etrack->position, demux->offset - demux->run_in, keyframe);
 
-      index->offset = demux->offset - demux->run_in;
-      index->keyframe = keyframe;
-    } else {
-      GstMXFDemuxIndex index;
-
-      index.offset = demux->offset - demux->run_in;
-      index.keyframe = keyframe;
-      if (etrack->offsets->len < etrack->position)
-        g_array_set_size (etrack->offsets, etrack->position);
-      g_array_insert_val (etrack->offsets, etrack->position, index);
-    }
-  }
+  gst_mxf_demux_update_index_table (demux, etrack,
+      demux->offset - demux->run_in, keyframe);
 
   if (peek)
     goto out;
@@ -1895,9 +2223,13 @@ out:
   return ret;
 }
 
+/* Reads the index table segments following the partition pack of @p and,
+ * for partitions without header metadata, remembers where the essence
+ * starts so that the index entries can be mapped to file offsets */
 static void
-read_partition_header (GstMXFDemux * demux, guint64 offset)
+read_partition_header (GstMXFDemux * demux, GstMXFDemuxPartition * p)
 {
+  guint64 offset = p->partition.this_partition + demux->run_in;
   GstBuffer *buf;
   MXFUL key;
   guint read;
@@ -1911,21 +2243,41 @@ read_partition_header (GstMXFDemux * demux, guint64 offset)
     gst_buffer_unref (buf);
     return;
   }
+  gst_buffer_unref (buf);
 
-  do {
+  while (TRUE) {
+    GstMapInfo map;
+
+    /* Only look at the key first, the next packet might be a large
+     * essence element */
+    if (gst_mxf_demux_pull_range_cached (demux, offset, 16, &buf)
+        != GST_FLOW_OK)
+      return;
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    memcpy (&key, map.data, 16);
+    gst_buffer_unmap (buf, &map);
     gst_buffer_unref (buf);
+
+    if (!mxf_is_fill (&key) && !mxf_is_index_table_segment (&key))
+      break;
+
     if (gst_mxf_demux_pull_klv_packet (demux, offset, &key, &buf, &read)
         != GST_FLOW_OK)
       return;
     offset += read;
-  }
-  while (mxf_is_fill (&key));
 
-  if (mxf_is_index_table_segment (&key)) {
-    gst_mxf_demux_handle_index_table_segment (demux, &key, buf, offset);
+    if (mxf_is_index_table_segment (&key))
+      gst_mxf_demux_handle_index_table_segment (demux, &key, buf, offset);
+    gst_buffer_unref (buf);
   }
 
-  gst_buffer_unref (buf);
+  if (p->essence_container_offset == 0 && p->partition.body_sid != 0 &&
+      p->partition.header_byte_count == 0 &&
+      (mxf_is_generic_container_system_item (&key) ||
+          mxf_is_generic_container_essence_element (&key) ||
+          mxf_is_avid_essence_container_essence_element (&key)))
+    p->essence_container_offset =
+        offset - demux->run_in - p->partition.this_partition;
 }
 
 static GstFlowReturn
@@ -2051,6 +2403,8 @@ gst_mxf_demux_handle_index_table_segment (GstMXFDemux * demux,
   if (l == NULL) {
     demux->pending_index_table_segments =
         g_list_prepend (demux->pending_index_table_segments, segment);
+    if (demux->index_table_segments_collected)
+      gst_mxf_demux_merge_index_table_segment (demux, segment);
   } else {
     mxf_index_table_segment_reset (segment);
     g_free (segment);
@@ -2077,7 +2431,8 @@ gst_mxf_demux_pull_klv_packet (GstMXFDemux * demux, guint64 offset, MXFUL * key,
 
   /* Pull 16 byte key and first byte of BER encoded length */
   if ((ret =
-          gst_mxf_demux_pull_range (demux, offset, 17, &buffer)) != GST_FLOW_OK)
+          gst_mxf_demux_pull_range_cached (demux, offset, 17,
+              &buffer)) != GST_FLOW_OK)
     goto beach;
 
   gst_buffer_map (buffer, &map, GST_MAP_READ);
@@ -2108,7 +2463,7 @@ gst_mxf_demux_pull_klv_packet (GstMXFDemux * demux, guint64 offset, MXFUL * key,
     }
 
     /* Now pull the length of the packet */
-    if ((ret = gst_mxf_demux_pull_range (demux, offset + 17, slen,
+    if ((ret = gst_mxf_demux_pull_range_cached (demux, offset + 17, slen,
                 &buffer)) != GST_FLOW_OK)
       goto beach;
 
@@ -2140,8 +2495,8 @@ gst_mxf_demux_pull_klv_packet (GstMXFDemux * demux, guint64 offset, MXFUL * key,
       "%" G_GUINT64_FORMAT, mxf_ul_to_string (key, str), length);
 
   /* Pull the complete KLV packet */
-  if ((ret = gst_mxf_demux_pull_range (demux, offset + data_offset, length,
-              &buffer)) != GST_FLOW_OK)
+  if ((ret = gst_mxf_demux_pull_range_cached (demux, offset + data_offset,
+              length, &buffer)) != GST_FLOW_OK)
     goto beach;
 
   *outbuf = buffer;
@@ -2555,6 +2910,7 @@ gst_mxf_demux_find_essence_element (GstMXFDemux * demux,
   GstFlowReturn ret = GST_FLOW_OK;
   guint64 old_offset = demux->offset;
   GstMXFDemuxPartition *old_partition = demux->current_partition;
+  GstMXFDemuxIndexTable *table;
   gint i;
 
   GST_DEBUG_OBJECT (demux, "Trying to find essence element %" G_GINT64_FORMAT
@@ -2603,6 +2959,28 @@ from_index:
     }
   }
 
+  /* Then the content package from the index table segments */
+  table = gst_mxf_demux_get_index_table_for_track (demux, etrack);
+  if (table && table->offsets->len > *position) {
+    gint64 current_position = *position;
+
+    while (current_position >= 0) {
+      GstMXFDemuxIndex *idx = &g_array_index (table->offsets,
+          GstMXFDemuxIndex, current_position);
+
+      if (idx->offset == 0)
+        break;
+
+      if (!keyframe || idx->keyframe) {
+        GST_DEBUG_OBJECT (demux, "Found in index table at offset %"
+            G_GUINT64_FORMAT, idx->offset);
+        *position = current_position;
+        return idx->offset;
+      }
+      current_position--;
+    }
+  }
+
   GST_DEBUG_OBJECT (demux, "Not found in index");
   if (!demux->random_access) {
     guint64 new_offset = -1;
@@ -2642,9 +3020,28 @@ from_index:
       }
     }
 
-    offset =
-        get_offset_from_index_table_segments (demux, *position,
-        &index_start_position);
+    /* Walk from the closest known content package before the position,
+     * filling the index on the way */
+    offset = 0;
+    if (table) {
+      gint64 p = MIN (*position, (gint64) table->offsets->len - 1);
+
+      for (; p >= 0; p--) {
+        GstMXFDemuxIndex *idx =
+            &g_array_index (table->offsets, GstMXFDemuxIndex, p);
+
+        if (idx->offset != 0) {
+          offset = idx->offset + demux->run_in;
+          index_start_position = p;
+          break;
+        }
+      }
+    }
+
+    if (offset == 0)
+      offset =
+          get_offset_from_index_table_segments (demux, *position,
+          &index_start_position);
 
     demux->offset = offset;
 
@@ -2882,7 +3279,7 @@ gst_mxf_demux_loop (GstPad * pad)
       GstBuffer *buffer = NULL;
 
       if ((flow =
-              gst_mxf_demux_pull_range (demux, demux->offset, 16,
+              gst_mxf_demux_pull_range_cached (demux, demux->offset, 16,
                   &buffer)) != GST_FLOW_OK)
         break;
 
@@ -3426,9 +3823,12 @@ collect_index_table_segments (GstMXFDemux * demux)
     }
 
     if (p) {
-      read_partition_header (demux, p->partition.this_partition);
+      read_partition_header (demux, p);
     }
   }
+
+  for (l = demux->pending_index_table_segments; l; l = l->next)
+    gst_mxf_demux_merge_index_table_segment (demux, l->data);
 }
 
 static gboolean
@@ -4159,6 +4559,9 @@ gst_mxf_demux_set_property (GObject * object, guint prop_id,
     case PROP_MAX_DRIFT:
       demux->max_drift = g_value_get_uint64 (value);
       break;
+    case PROP_READ_AHEAD_SIZE:
+      demux->read_ahead_size = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -4195,6 +4598,22 @@ gst_mxf_demux_get_property (GObject * object, guint prop_id,
       g_rw_lock_reader_unlock (&demux->metadata_lock);
       break;
     }
+    case PROP_READ_AHEAD_SIZE:
+      g_value_set_uint (value, demux->read_ahead_size);
+      break;
+    case PROP_STATS:{
+      GstStructure *s;
+
+      GST_OBJECT_LOCK (demux);
+      s = gst_structure_new ("application/x-mxf-demux-stats",
+          "read-ahead-hits", G_TYPE_UINT64, demux->cache_hits,
+          "read-ahead-misses", G_TYPE_UINT64, demux->cache_misses, NULL);
+      GST_OBJECT_UNLOCK (demux);
+
+      gst_value_set_structure (value, s);
+      gst_structure_free (s);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -4232,6 +4651,8 @@ gst_mxf_demux_finalize (GObject * object)
   demux->src = NULL;
   g_array_free (demux->essence_tracks, TRUE);
   demux->essence_tracks = NULL;
+  g_array_free (demux->index_tables, TRUE);
+  demux->index_tables = NULL;
 
   g_hash_table_destroy (demux->metadata);
 
@@ -4270,6 +4691,18 @@ gst_mxf_demux_class_init (GstMXFDemuxClass * klass)
           "Structural metadata of the MXF file",
           GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_READ_AHEAD_SIZE,
+      g_param_spec_uint ("read-ahead-size", "Read-ahead size",
+          "Size in bytes of the blocks read ahead in pull mode, smaller KLV "
+          "packets are served from them (0 = disabled)",
+          0, 64 * 1024 * 1024, DEFAULT_READ_AHEAD_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Read-ahead cache hits and misses since the last reset",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_mxf_demux_change_state);
   gstelement_class->query = GST_DEBUG_FUNCPTR (gst_mxf_demux_query);
@@ -4301,6 +4734,7 @@ gst_mxf_demux_init (GstMXFDemux * demux)
   gst_element_add_pad (GST_ELEMENT (demux), demux->sinkpad);
 
   demux->max_drift = 500 * GST_MSECOND;
+  demux->read_ahead_size = DEFAULT_READ_AHEAD_SIZE;
 
   demux->adapter = gst_adapter_new ();
   demux->flowcombiner = gst_flow_combiner_new ();
@@ -4309,6 +4743,8 @@ gst_mxf_demux_init (GstMXFDemux * demux)
   demux->src = g_ptr_array_new ();
   demux->essence_tracks =
       g_array_new (FALSE, FALSE, sizeof (GstMXFDemuxEssenceTrack));
+  demux->index_tables =
+      g_array_new (FALSE, FALSE, sizeof (GstMXFDemuxIndexTable));
 
   gst_segment_init (&demux->segment, GST_FORMAT_TIME);
 
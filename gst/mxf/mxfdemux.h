@@ -62,6 +62,19 @@ typedef struct
   gboolean keyframe;
 } GstMXFDemuxIndex;
 
+/* Edit unit to file offset table of one essence container, merged from
+ * all its index table segments. Unknown entries have offset 0 */
+typedef struct
+{
+  guint32 body_sid;
+  MXFFraction edit_rate;
+
+  /* GstMXFDemuxIndex of the content package of each edit unit */
+  GArray *offsets;
+  /* edit units whose offset is known, ascending */
+  GArray *known_positions;
+} GstMXFDemuxIndexTable;
+
 typedef struct
 {
   guint32 body_sid;
@@ -74,6 +87,7 @@ typedef struct
   gint64 duration;
 
   GArray *offsets;
+  GArray *known_positions;
 
   MXFMetadataSourcePackage *source_package;
   MXFMetadataTimelineTrack *source_track;
@@ -156,6 +170,7 @@ struct _GstMXFDemux
   GList *pending_index_table_segments;
 
   gboolean index_table_segments_collected;
+  GArray *index_tables;
 
   GArray *random_index_pack;
 
@@ -174,9 +189,17 @@ struct _GstMXFDemux
 
   GstTagList *tags;
 
+  /* Read-ahead cache for pull mode, a block of the file starting at
+   * cache_offset. Hits and misses are protected by the object lock */
+  GstBuffer *cache;
+  guint64 cache_offset;
+  guint64 cache_hits;
+  guint64 cache_misses;
+
   /* Properties */
   gchar *requested_package_string;
   GstClockTime max_drift;
+  guint read_ahead_size;
 };
 
 struct _GstMXFDemuxClass
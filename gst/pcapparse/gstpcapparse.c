@@ -25,6 +25,11 @@
  * #GstPcapParse:src-port and #GstPcapParse:dst-port to restrict which packets
  * should be included.
  *
+ * With #GstPcapParse:split-flows every UDP or TCP flow gets its own
+ * sometimes source pad, named after the protocol, addresses and ports of the
+ * flow, which is added when the first packet of the flow is found. Both pcap
+ * and pcapng files are understood.
+ *
  * <refsect2>
  * <title>Example pipelines</title>
  * |[
@@ -32,6 +37,12 @@
  * ! ffdec_h264 ! fakesink
  * ]| Read from a pcap dump file using filesrc, extract the raw UDP packets,
  * depayload and decode them.
+ * |[
+ * gst-launch-1.0 filesrc location=cameras.pcapng ! pcapparse split-flows=true
+ *     caps="application/x-rtp,media=video,clock-rate=90000,encoding-name=H264"
+ *     name=p p.src_udp_10.0.0.1_5000_10.0.0.2_5000 ! rtph264depay ! fakesink
+ *     p.src_udp_10.0.0.3_5000_10.0.0.2_5002 ! rtph264depay ! fakesink
+ * ]| Read two RTP flows from a pcapng file in a single pass.
  * </refsect2>
  */
 
@@ -63,7 +74,8 @@ enum
   PROP_SRC_PORT,
   PROP_DST_PORT,
   PROP_CAPS,
-  PROP_TS_OFFSET
+  PROP_TS_OFFSET,
+  PROP_SPLIT_FLOWS
 };
 
 GST_DEBUG_CATEGORY_STATIC (gst_pcap_parse_debug);
@@ -79,6 +91,12 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS_ANY);
 
+static GstStaticPadTemplate flow_src_template =
+GST_STATIC_PAD_TEMPLATE ("src_%s",
+    GST_PAD_SRC,
+    GST_PAD_SOMETIMES,
+    GST_STATIC_CAPS_ANY);
+
 static void gst_pcap_parse_finalize (GObject * object);
 static void gst_pcap_parse_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
@@ -88,6 +106,7 @@ static GstStateChangeReturn
 gst_pcap_parse_change_state (GstElement * element, GstStateChange transition);
 
 static void gst_pcap_parse_reset (GstPcapParse * self);
+static void gst_pcap_parse_remove_flows (GstPcapParse * self);
 
 static GstFlowReturn gst_pcap_parse_chain (GstPad * pad,
     GstObject * parent, GstBuffer * buffer);
@@ -138,10 +157,17 @@ gst_pcap_parse_class_init (GstPcapParseClass * klass)
           "Relative timestamp offset (ns) to apply (-1 = use absolute packet time)",
           -1, G_MAXINT64, -1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_SPLIT_FLOWS,
+      g_param_spec_boolean ("split-flows", "Split flows",
+          "Push every UDP or TCP flow on its own source pad", FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&sink_template));
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&src_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&flow_src_template));
 
   element_class->change_state = gst_pcap_parse_change_state;
 
@@ -153,6 +179,33 @@ gst_pcap_parse_class_init (GstPcapParseClass * klass)
   GST_DEBUG_CATEGORY_INIT (gst_pcap_parse_debug, "pcapparse", 0, "pcap parser");
 }
 
+static guint
+gst_pcap_parse_flow_key_hash (gconstpointer v)
+{
+  const GstPcapParseFlowKey *key = v;
+
+  return key->src_ip ^ (key->dst_ip * 31) ^
+      ((key->src_port << 16) | key->dst_port) ^ key->protocol;
+}
+
+static gboolean
+gst_pcap_parse_flow_key_equal (gconstpointer v1, gconstpointer v2)
+{
+  const GstPcapParseFlowKey *k1 = v1, *k2 = v2;
+
+  return k1->src_ip == k2->src_ip && k1->dst_ip == k2->dst_ip &&
+      k1->src_port == k2->src_port && k1->dst_port == k2->dst_port &&
+      k1->protocol == k2->protocol;
+}
+
+static void
+gst_pcap_parse_flow_free (GstPcapParseFlow * flow)
+{
+  if (flow->pending)
+    gst_buffer_list_unref (flow->pending);
+  g_slice_free (GstPcapParseFlow, flow);
+}
+
 static void
 gst_pcap_parse_init (GstPcapParse * self)
 {
@@ -175,6 +228,13 @@ gst_pcap_parse_init (GstPcapParse * self)
   self->offset = -1;
 
   self->adapter = gst_adapter_new ();
+  self->interfaces =
+      g_array_new (FALSE, FALSE, sizeof (GstPcapParseInterface));
+  self->flows = g_hash_table_new_full (gst_pcap_parse_flow_key_hash,
+      gst_pcap_parse_flow_key_equal, NULL,
+      (GDestroyNotify) gst_pcap_parse_flow_free);
+  self->flowcombiner = gst_flow_combiner_new ();
+  self->group_id = G_MAXUINT;
 
   gst_pcap_parse_reset (self);
 }
@@ -187,6 +247,9 @@ gst_pcap_parse_finalize (GObject * object)
   g_object_unref (self->adapter);
   if (self->caps)
     gst_caps_unref (self->caps);
+  g_array_free (self->interfaces, TRUE);
+  g_hash_table_destroy (self->flows);
+  gst_flow_combiner_free (self->flowcombiner);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -246,6 +309,10 @@ gst_pcap_parse_get_property (GObject * object, guint prop_id,
       g_value_set_int64 (value, self->offset);
       break;
 
+    case PROP_SPLIT_FLOWS:
+      g_value_set_boolean (value, self->split_flows);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -300,6 +367,10 @@ gst_pcap_parse_set_property (GObject * object, guint prop_id,
       self->offset = g_value_get_int64 (value);
       break;
 
+    case PROP_SPLIT_FLOWS:
+      self->split_flows = g_value_get_boolean (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -315,6 +386,9 @@ gst_pcap_parse_reset (GstPcapParse * self)
   self->cur_ts = GST_CLOCK_TIME_NONE;
   self->base_ts = GST_CLOCK_TIME_NONE;
   self->newsegment_sent = FALSE;
+  self->pcapng = FALSE;
+  self->skip = 0;
+  g_array_set_size (self->interfaces, 0);
 
   gst_adapter_clear (self->adapter);
 }
@@ -335,6 +409,22 @@ gst_pcap_parse_read_uint32 (GstPcapParse * self, const guint8 * p)
   }
 }
 
+static guint16
+gst_pcap_parse_read_uint16 (GstPcapParse * self, const guint8 * p)
+{
+  guint16 val = *((guint16 *) p);
+
+  if (self->swap_endian) {
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+    return GUINT16_FROM_BE (val);
+#else
+    return GUINT16_FROM_LE (val);
+#endif
+  } else {
+    return val;
+  }
+}
+
 #define ETH_HEADER_LEN    14
 #define SLL_HEADER_LEN    16
 #define IP_HEADER_MIN_LEN 20
@@ -347,7 +437,8 @@ gst_pcap_parse_read_uint32 (GstPcapParse * self, const guint8 * p)
 static gboolean
 gst_pcap_parse_scan_frame (GstPcapParse * self,
     const guint8 * buf,
-    gint buf_size, const guint8 ** payload, gint * payload_size)
+    gint buf_size, const guint8 ** payload, gint * payload_size,
+    GstPcapParseFlowKey * key)
 {
   const guint8 *buf_ip = 0;
   const guint8 *buf_proto;
@@ -447,9 +538,337 @@ gst_pcap_parse_scan_frame (GstPcapParse * self,
   if (self->dst_port >= 0 && dst_port != self->dst_port)
     return FALSE;
 
+  key->src_ip = ip_src_addr;
+  key->dst_ip = ip_dst_addr;
+  key->src_port = src_port;
+  key->dst_port = dst_port;
+  key->protocol = ip_protocol;
+
+  return TRUE;
+}
+
+/* the link layers gst_pcap_parse_scan_frame() knows */
+static gboolean
+gst_pcap_parse_linktype_supported (guint32 linktype)
+{
+  return linktype == LINKTYPE_ETHER || linktype == LINKTYPE_SLL ||
+      linktype == LINKTYPE_RAW;
+}
+
+#define PCAPNG_SHB        0x0a0d0d0a
+#define PCAPNG_IDB        0x00000001
+#define PCAPNG_SPB        0x00000003
+#define PCAPNG_EPB        0x00000006
+
+#define PCAPNG_OPT_END          0
+#define PCAPNG_OPT_IF_TSRESOL   9
+
+static gboolean
+gst_pcap_parse_read_interface (GstPcapParse * self, const guint8 * data,
+    guint32 block_len)
+{
+  GstPcapParseInterface iface;
+  guint32 pos;
+
+  if (block_len < 20)
+    return FALSE;
+
+  iface.linktype = gst_pcap_parse_read_uint16 (self, data + 8);
+  iface.snaplen = gst_pcap_parse_read_uint32 (self, data + 12);
+  iface.ts_rate = G_GUINT64_CONSTANT (1000000);
+
+  /* options, the only one we care about is the timestamp resolution */
+  pos = 16;
+  while (pos + 4 <= block_len - 4) {
+    guint16 code = gst_pcap_parse_read_uint16 (self, data + pos);
+    guint16 len = gst_pcap_parse_read_uint16 (self, data + pos + 2);
+
+    if (code == PCAPNG_OPT_END || pos + 4 + len > block_len - 4)
+      break;
+
+    if (code == PCAPNG_OPT_IF_TSRESOL && len >= 1) {
+      guint8 resol = data[pos + 4];
+
+      if (resol & 0x80) {
+        if ((resol & 0x7f) < 64)
+          iface.ts_rate = G_GUINT64_CONSTANT (1) << (resol & 0x7f);
+      } else if (resol <= 19) {
+        guint i;
+
+        iface.ts_rate = 1;
+        for (i = 0; i < resol; i++)
+          iface.ts_rate *= 10;
+      }
+    }
+    pos += 4 + GST_ROUND_UP_4 (len);
+  }
+
+  GST_DEBUG_OBJECT (self, "interface %u, linktype %u, %" G_GUINT64_FORMAT
+      " units per second", self->interfaces->len, iface.linktype,
+      iface.ts_rate);
+  g_array_append_val (self->interfaces, iface);
+
   return TRUE;
 }
 
+/* Reads the pcapng block at the start of the adapter. Of packet blocks only
+ * the header is consumed, the packet itself is then handled like a pcap
+ * record. Sets @more when more data is needed */
+static GstFlowReturn
+gst_pcap_parse_read_block (GstPcapParse * self, gint avail, gboolean * more)
+{
+  const guint8 *data;
+  guint32 block_type, block_len;
+  GstPcapParseInterface *iface = NULL;
+
+  *more = TRUE;
+  if (avail < 12)
+    return GST_FLOW_OK;
+
+  data = gst_adapter_map (self->adapter, 12);
+  /* the section header type reads the same in both byte orders, its byte
+   * order magic gives the byte order of the section */
+  block_type = gst_pcap_parse_read_uint32 (self, data);
+  if (block_type == PCAPNG_SHB) {
+    guint32 magic = *((guint32 *) (data + 8));
+
+    if (magic == 0x1a2b3c4d) {
+      self->swap_endian = FALSE;
+    } else if (magic == 0x4d3c2b1a) {
+      self->swap_endian = TRUE;
+    } else {
+      gst_adapter_unmap (self->adapter);
+      goto invalid;
+    }
+  }
+  block_len = gst_pcap_parse_read_uint32 (self, data + 4);
+  gst_adapter_unmap (self->adapter);
+
+  if (block_len < 12 || block_len % 4 != 0)
+    goto invalid;
+
+  switch (block_type) {
+    case PCAPNG_EPB:{
+      guint32 if_id, caplen;
+      guint64 ts;
+
+      if (block_len < 32)
+        goto invalid;
+      if (avail < 28)
+        return GST_FLOW_OK;
+
+      data = gst_adapter_map (self->adapter, 28);
+      if_id = gst_pcap_parse_read_uint32 (self, data + 8);
+      ts = ((guint64) gst_pcap_parse_read_uint32 (self, data + 12) << 32) |
+          gst_pcap_parse_read_uint32 (self, data + 16);
+      caplen = gst_pcap_parse_read_uint32 (self, data + 20);
+      gst_adapter_unmap (self->adapter);
+
+      if (caplen > block_len - 32)
+        goto invalid;
+
+      if (if_id < self->interfaces->len)
+        iface = &g_array_index (self->interfaces, GstPcapParseInterface, if_id);
+      if (iface) {
+        self->linktype = iface->linktype;
+        self->cur_ts = gst_util_uint64_scale (ts, GST_SECOND, iface->ts_rate);
+      } else {
+        GST_WARNING_OBJECT (self, "packet of unknown interface %u", if_id);
+        self->linktype = 0;
+        self->cur_ts = GST_CLOCK_TIME_NONE;
+      }
+
+      gst_adapter_flush (self->adapter, 28);
+      self->cur_packet_size = caplen;
+      self->skip = block_len - 28 - caplen;
+      break;
+    }
+    case PCAPNG_SPB:{
+      guint32 caplen;
+
+      if (block_len < 16)
+        goto invalid;
+
+      data = gst_adapter_map (self->adapter, 12);
+      caplen = gst_pcap_parse_read_uint32 (self, data + 8);
+      gst_adapter_unmap (self->adapter);
+
+      /* simple packets carry no timestamp and belong to the first
+       * interface */
+      if (self->interfaces->len > 0)
+        iface = &g_array_index (self->interfaces, GstPcapParseInterface, 0);
+      caplen = MIN (caplen, block_len - 16);
+      if (iface && iface->snaplen > 0)
+        caplen = MIN (caplen, iface->snaplen);
+      self->linktype = iface ? iface->linktype : 0;
+      self->cur_ts = GST_CLOCK_TIME_NONE;
+
+      gst_adapter_flush (self->adapter, 12);
+      self->cur_packet_size = caplen;
+      self->skip = block_len - 12 - caplen;
+      break;
+    }
+    default:
+      if (avail < block_len)
+        return GST_FLOW_OK;
+
+      data = gst_adapter_map (self->adapter, block_len);
+      if (block_type == PCAPNG_SHB) {
+        guint16 major_version;
+
+        if (block_len < 28) {
+          gst_adapter_unmap (self->adapter);
+          goto invalid;
+        }
+        major_version = gst_pcap_parse_read_uint16 (self, data + 12);
+        if (major_version != 1) {
+          gst_adapter_unmap (self->adapter);
+          GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+              ("File is not a pcapng major version 1, but %u",
+                  major_version));
+          return GST_FLOW_ERROR;
+        }
+        /* interfaces are numbered per section */
+        g_array_set_size (self->interfaces, 0);
+      } else if (block_type == PCAPNG_IDB) {
+        guint16 linktype = gst_pcap_parse_read_uint16 (self, data + 8);
+
+        if (!gst_pcap_parse_linktype_supported (linktype)) {
+          gst_adapter_unmap (self->adapter);
+          GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+              ("Only dumps of type Ethernet, raw IP or Linux Cooked (SLL) "
+                  "understood; type %d unknown", linktype));
+          return GST_FLOW_ERROR;
+        }
+        if (!gst_pcap_parse_read_interface (self, data, block_len)) {
+          gst_adapter_unmap (self->adapter);
+          goto invalid;
+        }
+      } else {
+        GST_LOG_OBJECT (self, "skipping block type 0x%08x", block_type);
+      }
+      gst_adapter_unmap (self->adapter);
+      gst_adapter_flush (self->adapter, block_len);
+      break;
+  }
+
+  *more = FALSE;
+
+  return GST_FLOW_OK;
+
+invalid:
+  {
+    GST_ELEMENT_ERROR (self, STREAM, DEMUX, (NULL),
+        ("Invalid pcapng block"));
+    return GST_FLOW_ERROR;
+  }
+}
+
+static void
+gst_pcap_parse_remove_flows (GstPcapParse * self)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, self->flows);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    GstPcapParseFlow *flow = value;
+
+    gst_flow_combiner_remove_pad (self->flowcombiner, flow->pad);
+    gst_element_remove_pad (GST_ELEMENT_CAST (self), flow->pad);
+  }
+  g_hash_table_remove_all (self->flows);
+  self->group_id = G_MAXUINT;
+}
+
+/* Returns the flow of @key, adding a source pad for it if it is new */
+static GstPcapParseFlow *
+gst_pcap_parse_get_flow (GstPcapParse * self, const GstPcapParseFlowKey * key)
+{
+  GstPcapParseFlow *flow;
+  GstEvent *event;
+  gchar *src, *dst, *name, *stream_id;
+
+  flow = g_hash_table_lookup (self->flows, key);
+  if (flow)
+    return flow;
+
+  flow = g_slice_new0 (GstPcapParseFlow);
+  flow->key = *key;
+  flow->need_segment = TRUE;
+
+  src = g_strdup (get_ip_address_as_string (key->src_ip));
+  dst = g_strdup (get_ip_address_as_string (key->dst_ip));
+  name = g_strdup_printf ("src_%s_%s_%u_%s_%u",
+      key->protocol == IP_PROTO_UDP ? "udp" : "tcp", src, key->src_port, dst,
+      key->dst_port);
+  g_free (src);
+  g_free (dst);
+
+  GST_DEBUG_OBJECT (self, "new flow %s", name);
+
+  flow->pad = gst_pad_new_from_static_template (&flow_src_template, name);
+  gst_pad_use_fixed_caps (flow->pad);
+  gst_pad_set_active (flow->pad, TRUE);
+
+  if (self->group_id == G_MAXUINT)
+    self->group_id = gst_util_group_id_next ();
+  stream_id = gst_pad_create_stream_id (flow->pad, GST_ELEMENT_CAST (self),
+      name + 4);
+  event = gst_event_new_stream_start (stream_id);
+  gst_event_set_group_id (event, self->group_id);
+  gst_pad_push_event (flow->pad, event);
+  g_free (stream_id);
+  g_free (name);
+
+  if (self->caps)
+    gst_pad_set_caps (flow->pad, self->caps);
+
+  g_hash_table_insert (self->flows, &flow->key, flow);
+  gst_flow_combiner_add_pad (self->flowcombiner, flow->pad);
+  gst_element_add_pad (GST_ELEMENT_CAST (self), flow->pad);
+
+  return flow;
+}
+
+static GstFlowReturn
+gst_pcap_parse_push_flows (GstPcapParse * self)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, self->flows);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    GstPcapParseFlow *flow = value;
+    GstBufferList *list = flow->pending;
+
+    if (list == NULL)
+      continue;
+    flow->pending = NULL;
+
+    if (ret != GST_FLOW_OK) {
+      gst_buffer_list_unref (list);
+      continue;
+    }
+
+    if (flow->need_segment) {
+      GstSegment segment;
+
+      gst_segment_init (&segment, GST_FORMAT_TIME);
+      if (GST_CLOCK_TIME_IS_VALID (self->base_ts))
+        segment.start = self->base_ts;
+      gst_pad_push_event (flow->pad, gst_event_new_segment (&segment));
+      flow->need_segment = FALSE;
+    }
+
+    ret = gst_flow_combiner_update_pad_flow (self->flowcombiner, flow->pad,
+        gst_pad_push_list (flow->pad, list));
+  }
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
@@ -465,6 +884,17 @@ gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
     avail = gst_adapter_available (self->adapter);
 
+    /* the rest of a pcapng block after its packet */
+    if (self->skip > 0 && self->cur_packet_size < 0) {
+      guint64 flush = MIN (self->skip, avail);
+
+      gst_adapter_flush (self->adapter, flush);
+      self->skip -= flush;
+      if (self->skip > 0)
+        break;
+      continue;
+    }
+
     if (self->initialized) {
       if (self->cur_packet_size >= 0) {
         if (avail < self->cur_packet_size)
@@ -473,6 +903,7 @@ gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
         if (self->cur_packet_size > 0) {
           const guint8 *payload_data;
           gint payload_size;
+          GstPcapParseFlowKey key;
 
           data = gst_adapter_map (self->adapter, self->cur_packet_size);
 
@@ -480,7 +911,7 @@ gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
               self->cur_packet_size);
 
           if (gst_pcap_parse_scan_frame (self, data, self->cur_packet_size,
-                  &payload_data, &payload_size)) {
+                  &payload_data, &payload_size, &key)) {
             GstBuffer *out_buf;
             guintptr offset = payload_data - data;
 
@@ -508,10 +939,17 @@ gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
             }
             GST_BUFFER_TIMESTAMP (out_buf) = self->cur_ts;
 
+            if (self->split_flows) {
+              GstPcapParseFlow *flow = gst_pcap_parse_get_flow (self, &key);
 
-            if (list == NULL)
-              list = gst_buffer_list_new ();
-            gst_buffer_list_add (list, out_buf);
+              if (flow->pending == NULL)
+                flow->pending = gst_buffer_list_new ();
+              gst_buffer_list_add (flow->pending, out_buf);
+            } else {
+              if (list == NULL)
+                list = gst_buffer_list_new ();
+              gst_buffer_list_add (list, out_buf);
+            }
           } else {
             gst_adapter_unmap (self->adapter);
             gst_adapter_flush (self->adapter, self->cur_packet_size);
@@ -519,6 +957,14 @@ gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
         }
 
         self->cur_packet_size = -1;
+      } else if (self->pcapng) {
+        gboolean more;
+
+        ret = gst_pcap_parse_read_block (self, avail, &more);
+        if (ret != GST_FLOW_OK)
+          goto out;
+        if (more)
+          break;
       } else {
         guint32 ts_sec;
         guint32 ts_usec;
@@ -551,6 +997,15 @@ gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       data = gst_adapter_map (self->adapter, 24);
 
       magic = *((guint32 *) data);
+      if (magic == PCAPNG_SHB) {
+        /* the section header is parsed as the first block */
+        gst_adapter_unmap (self->adapter);
+        GST_DEBUG_OBJECT (self, "pcapng file");
+        self->pcapng = TRUE;
+        self->initialized = TRUE;
+        continue;
+      }
+
       major_version = *((guint16 *) (data + 4));
       linktype = gst_pcap_parse_read_uint32 (self, data + 20);
       gst_adapter_unmap (self->adapter);
@@ -574,8 +1029,7 @@ gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
         goto out;
       }
 
-      if (linktype != LINKTYPE_ETHER && linktype != LINKTYPE_SLL &&
-          linktype != LINKTYPE_RAW) {
+      if (!gst_pcap_parse_linktype_supported (linktype)) {
         GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
             ("Only dumps of type Ethernet, raw IP or Linux Cooked (SLL) "
                 "understood; type %d unknown", linktype));
@@ -607,10 +1061,27 @@ gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     list = NULL;
   }
 
+  if (self->split_flows)
+    ret = gst_pcap_parse_push_flows (self);
+
 out:
 
   if (list)
     gst_buffer_list_unref (list);
+  if (ret != GST_FLOW_OK && self->split_flows) {
+    GHashTableIter iter;
+    gpointer value;
+
+    g_hash_table_iter_init (&iter, self->flows);
+    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+      GstPcapParseFlow *flow = value;
+
+      if (flow->pending) {
+        gst_buffer_list_unref (flow->pending);
+        flow->pending = NULL;
+      }
+    }
+  }
 
   return ret;
 }
@@ -626,12 +1097,32 @@ gst_pcap_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       /* Drop it, we'll replace it with our own */
       gst_event_unref (event);
       break;
-    case GST_EVENT_FLUSH_STOP:
+    case GST_EVENT_STREAM_START:
+    case GST_EVENT_CAPS:
+      /* every flow has its own */
+      if (self->split_flows) {
+        gst_event_unref (event);
+        break;
+      }
+      ret = gst_pad_push_event (self->src_pad, event);
+      break;
+    case GST_EVENT_FLUSH_STOP:{
+      GHashTableIter iter;
+      gpointer value;
+
       gst_pcap_parse_reset (self);
+      g_hash_table_iter_init (&iter, self->flows);
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        ((GstPcapParseFlow *) value)->need_segment = TRUE;
+      gst_flow_combiner_reset (self->flowcombiner);
+    }
       /* Push event down the pipeline so that other elements stop flushing */
       /* fall through */
     default:
-      ret = gst_pad_push_event (self->src_pad, event);
+      if (self->split_flows)
+        ret = gst_pad_event_default (pad, parent, event);
+      else
+        ret = gst_pad_push_event (self->src_pad, event);
       break;
   }
 
@@ -649,6 +1140,7 @@ gst_pcap_parse_change_state (GstElement * element, GstStateChange transition)
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       gst_pcap_parse_reset (self);
+      gst_pcap_parse_remove_flows (self);
       break;
     default:
       break;
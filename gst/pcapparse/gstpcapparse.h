@@ -22,6 +22,7 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstadapter.h>
+#include <gst/base/gstflowcombiner.h>
 
 G_BEGIN_DECLS
 
@@ -52,6 +53,33 @@ typedef enum
   LINKTYPE_SLL = 113
 } GstPcapParseLinktype;
 
+/* pcapng interface, from an Interface Description Block */
+typedef struct
+{
+  guint32 linktype;
+  guint32 snaplen;
+  /* timestamp units per second */
+  guint64 ts_rate;
+} GstPcapParseInterface;
+
+typedef struct
+{
+  guint32 src_ip;
+  guint32 dst_ip;
+  guint16 src_port;
+  guint16 dst_port;
+  guint8 protocol;
+} GstPcapParseFlowKey;
+
+/* a flow with its own source pad when splitting flows */
+typedef struct
+{
+  GstPcapParseFlowKey key;
+  GstPad *pad;
+  GstBufferList *pending;
+  gboolean need_segment;
+} GstPcapParseFlow;
+
 /**
  * GstPcapParse:
  *
@@ -73,6 +101,7 @@ struct _GstPcapParse
   gint32 dst_port;
   GstCaps *caps;
   gint64 offset;
+  gboolean split_flows;
 
   /* state */
   GstAdapter * adapter;
@@ -84,6 +113,17 @@ struct _GstPcapParse
   GstPcapParseLinktype linktype;
 
   gboolean newsegment_sent;
+
+  /* pcapng */
+  gboolean pcapng;
+  GArray *interfaces;
+  /* bytes left to skip after the current packet */
+  guint64 skip;
+
+  /* GstPcapParseFlowKey -> GstPcapParseFlow */
+  GHashTable *flows;
+  GstFlowCombiner *flowcombiner;
+  guint32 group_id;
 };
 
 struct _GstPcapParseClass
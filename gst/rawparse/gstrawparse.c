@@ -36,6 +36,10 @@
 #include "gstrawparse.h"
 
 static void gst_raw_parse_dispose (GObject * object);
+static void gst_raw_parse_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_raw_parse_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static gboolean gst_raw_parse_sink_activate (GstPad * sinkpad,
     GstObject * parent);
@@ -68,6 +72,14 @@ GST_STATIC_PAD_TEMPLATE ("sink",
 GST_DEBUG_CATEGORY_STATIC (gst_raw_parse_debug);
 #define GST_CAT_DEFAULT gst_raw_parse_debug
 
+#define DEFAULT_BLOCK_SIZE (4 * 1024 * 1024)
+
+enum
+{
+  PROP_0,
+  PROP_BLOCK_SIZE
+};
+
 static void gst_raw_parse_class_init (GstRawParseClass * klass);
 static void gst_raw_parse_init (GstRawParse * clip, GstRawParseClass * g_class);
 
@@ -102,6 +114,14 @@ gst_raw_parse_class_init (GstRawParseClass * klass)
   parent_class = g_type_class_peek_parent (klass);
 
   gobject_class->dispose = gst_raw_parse_dispose;
+  gobject_class->set_property = gst_raw_parse_set_property;
+  gobject_class->get_property = gst_raw_parse_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_BLOCK_SIZE,
+      g_param_spec_uint ("block-size", "Block size",
+          "Number of bytes to read at once in pull mode, rounded down to "
+          "whole frames (0 = one frame at a time)", 0, G_MAXUINT,
+          DEFAULT_BLOCK_SIZE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_raw_parse_change_state);
@@ -152,6 +172,7 @@ gst_raw_parse_init (GstRawParse * rp, GstRawParseClass * g_class)
   rp->fps_n = 1;
   rp->fps_d = 0;
   rp->framesize = 1;
+  rp->block_size = DEFAULT_BLOCK_SIZE;
 
   gst_raw_parse_reset (rp);
 }
@@ -169,6 +190,42 @@ gst_raw_parse_dispose (GObject * object)
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
+static void
+gst_raw_parse_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRawParse *rp = GST_RAW_PARSE (object);
+
+  switch (prop_id) {
+    case PROP_BLOCK_SIZE:
+      GST_OBJECT_LOCK (rp);
+      rp->block_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (rp);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_raw_parse_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstRawParse *rp = GST_RAW_PARSE (object);
+
+  switch (prop_id) {
+    case PROP_BLOCK_SIZE:
+      GST_OBJECT_LOCK (rp);
+      g_value_set_uint (value, rp->block_size);
+      GST_OBJECT_UNLOCK (rp);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 void
 gst_raw_parse_class_set_src_pad_template (GstRawParseClass * klass,
     const GstCaps * allowed_caps)
@@ -199,6 +256,7 @@ gst_raw_parse_reset (GstRawParse * rp)
   rp->n_frames = 0;
   rp->discont = TRUE;
   rp->negotiated = FALSE;
+  rp->zero_copy = FALSE;
 
   gst_segment_init (&rp->segment, GST_FORMAT_TIME);
   gst_adapter_clear (rp->adapter);
@@ -222,6 +280,20 @@ gst_raw_parse_set_src_caps (GstRawParse * rp)
   }
 
   rp->negotiated = gst_pad_set_caps (rp->srcpad, caps);
+
+  /* frames spanning several input buffers are only pushed without merging
+   * them when the subclass knows downstream can handle that */
+  rp->zero_copy = FALSE;
+  if (rp->negotiated && rp_class->decide_allocation) {
+    GstQuery *query = gst_query_new_allocation (caps, FALSE);
+
+    if (!gst_pad_peer_query (rp->srcpad, query))
+      GST_DEBUG_OBJECT (rp, "allocation query failed");
+    rp->zero_copy = rp_class->decide_allocation (rp, query);
+    gst_query_unref (query);
+  }
+  GST_DEBUG_OBJECT (rp, "zero copy %d", rp->zero_copy);
+
   gst_caps_unref (caps);
 
   return rp->negotiated;
@@ -232,11 +304,19 @@ gst_raw_parse_push_buffer (GstRawParse * rp, GstBuffer * buffer)
 {
   GstFlowReturn ret;
   gint nframes;
+  gsize size;
   GstRawParseClass *rpclass;
 
   rpclass = GST_RAW_PARSE_GET_CLASS (rp);
 
-  nframes = gst_buffer_get_size (buffer) / rp->framesize;
+  size = gst_buffer_get_size (buffer);
+  nframes = size / rp->framesize;
+
+  if (rpclass->process) {
+    buffer = rpclass->process (rp, buffer);
+    if (buffer == NULL)
+      return GST_FLOW_ERROR;
+  }
 
   if (rp->segment.rate < 0) {
     rp->n_frames -= nframes;
@@ -267,7 +347,7 @@ gst_raw_parse_push_buffer (GstRawParse * rp, GstBuffer * buffer)
   }
 
   if (rp->segment.rate >= 0) {
-    rp->offset += gst_buffer_get_size (buffer);
+    rp->offset += size;
     rp->n_frames += nframes;
   }
 
@@ -315,7 +395,12 @@ gst_raw_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   }
 
   while (buffersize > 0 && gst_adapter_available (rp->adapter) >= buffersize) {
-    buffer = gst_adapter_take_buffer (rp->adapter, buffersize);
+    /* take_buffer_fast() keeps the memories of the input buffers instead of
+     * copying frames that span them into a new one */
+    if (rp->zero_copy)
+      buffer = gst_adapter_take_buffer_fast (rp->adapter, buffersize);
+    else
+      buffer = gst_adapter_take_buffer (rp->adapter, buffersize);
 
     ret = gst_raw_parse_push_buffer (rp, buffer);
     if (ret != GST_FLOW_OK)
@@ -342,6 +427,8 @@ gst_raw_parse_loop (GstElement * element)
   GstFlowReturn ret;
   GstBuffer *buffer;
   gint size;
+  guint block_size;
+  gsize bufsize, pos;
 
   if (G_UNLIKELY (rp->push_stream_start)) {
     gchar *stream_id;
@@ -368,8 +455,16 @@ gst_raw_parse_loop (GstElement * element)
     rp->start_segment = NULL;
   }
 
+  GST_OBJECT_LOCK (rp);
+  block_size = rp->block_size;
+  GST_OBJECT_UNLOCK (rp);
+
+  /* pull as many whole frames as fit in a block, the frames are split off
+   * as sub-buffers below unless the subclass takes several at once */
   if (rp_class->multiple_frames_per_buffer && rp->framesize < 4096)
     size = 4096 - (4096 % rp->framesize);
+  else if (block_size > rp->framesize && block_size <= G_MAXINT)
+    size = block_size - (block_size % rp->framesize);
   else
     size = rp->framesize;
 
@@ -394,7 +489,7 @@ gst_raw_parse_loop (GstElement * element)
       ret = GST_FLOW_EOS;
       goto pause;
     } else if (rp->offset < size) {
-      size -= rp->offset;
+      size = rp->offset;
     }
     rp->offset -= size;
   }
@@ -425,7 +520,29 @@ gst_raw_parse_loop (GstElement * element)
     }
   }
 
-  ret = gst_raw_parse_push_buffer (rp, buffer);
+  bufsize = gst_buffer_get_size (buffer);
+  if (rp_class->multiple_frames_per_buffer || bufsize <= rp->framesize) {
+    ret = gst_raw_parse_push_buffer (rp, buffer);
+  } else if (rp->segment.rate >= 0) {
+    for (pos = 0; pos < bufsize; pos += rp->framesize) {
+      ret = gst_raw_parse_push_buffer (rp,
+          gst_buffer_copy_region (buffer, GST_BUFFER_COPY_MEMORY, pos,
+              rp->framesize));
+      if (ret != GST_FLOW_OK)
+        break;
+    }
+    gst_buffer_unref (buffer);
+  } else {
+    /* backwards, the last frame of the block comes first */
+    for (pos = bufsize; pos > 0; pos -= rp->framesize) {
+      ret = gst_raw_parse_push_buffer (rp,
+          gst_buffer_copy_region (buffer, GST_BUFFER_COPY_MEMORY,
+              pos - rp->framesize, rp->framesize));
+      if (ret != GST_FLOW_OK)
+        break;
+    }
+    gst_buffer_unref (buffer);
+  }
   if (ret != GST_FLOW_OK)
     goto pause;
 
@@ -70,6 +70,11 @@ struct _GstRawParse
 
   gboolean negotiated;
   gboolean push_stream_start;
+
+  /* bytes to pull at once in pull mode */
+  guint block_size;
+  /* downstream handles frames made of several memories */
+  gboolean zero_copy;
 };
 
 struct _GstRawParseClass
@@ -78,6 +83,8 @@ struct _GstRawParseClass
 
   GstCaps * (*get_caps) (GstRawParse *rp);
   void (*set_buffer_flags) (GstRawParse *rp, GstBuffer *buffer);
+  gboolean (*decide_allocation) (GstRawParse *rp, GstQuery *query);
+  GstBuffer * (*process) (GstRawParse *rp, GstBuffer *buffer);
 
   gboolean multiple_frames_per_buffer;
 };
@@ -25,12 +25,19 @@
  * Converts a byte stream into video frames.
  */
 
+/* FIXME 0.11: suppress warnings for deprecated API such as g_value_array stuff
+ * for now with newer GLib versions (>= 2.31.0) */
+#define GLIB_DISABLE_DEPRECATION_WARNINGS
+
 #ifdef HAVE_CONFIG_H
 #  include "config.h"
 #endif
 
+#include <string.h>
+
 #include "gstvideoparse.h"
 
+static void gst_video_parse_finalize (GObject * object);
 static void gst_video_parse_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_video_parse_get_property (GObject * object, guint prop_id,
@@ -39,6 +46,10 @@ static void gst_video_parse_get_property (GObject * object, guint prop_id,
 static GstCaps *gst_video_parse_get_caps (GstRawParse * rp);
 static void gst_video_parse_set_buffer_flags (GstRawParse * rp,
     GstBuffer * buffer);
+static gboolean gst_video_parse_decide_allocation (GstRawParse * rp,
+    GstQuery * query);
+static GstBuffer *gst_video_parse_process (GstRawParse * rp,
+    GstBuffer * buffer);
 
 static void gst_video_parse_update_frame_size (GstVideoParse * vp);
 
@@ -54,7 +65,10 @@ enum
   PROP_PAR,
   PROP_FRAMERATE,
   PROP_INTERLACED,
-  PROP_TOP_FIELD_FIRST
+  PROP_TOP_FIELD_FIRST,
+  PROP_PLANE_STRIDES,
+  PROP_PLANE_OFFSETS,
+  PROP_FRAME_SIZE
 };
 
 #define gst_video_parse_parent_class parent_class
@@ -68,11 +82,14 @@ gst_video_parse_class_init (GstVideoParseClass * klass)
   GstRawParseClass *rp_class = GST_RAW_PARSE_CLASS (klass);
   GstCaps *caps;
 
+  gobject_class->finalize = gst_video_parse_finalize;
   gobject_class->set_property = gst_video_parse_set_property;
   gobject_class->get_property = gst_video_parse_get_property;
 
   rp_class->get_caps = gst_video_parse_get_caps;
   rp_class->set_buffer_flags = gst_video_parse_set_buffer_flags;
+  rp_class->decide_allocation = gst_video_parse_decide_allocation;
+  rp_class->process = gst_video_parse_process;
 
   g_object_class_install_property (gobject_class, PROP_FORMAT,
       g_param_spec_enum ("format", "Format", "Format of images in raw stream",
@@ -100,6 +117,27 @@ gst_video_parse_class_init (GstVideoParseClass * klass)
       g_param_spec_boolean ("top-field-first", "Top field first",
           "True if top field is earlier than bottom field", TRUE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_PLANE_STRIDES,
+      g_param_spec_value_array ("plane-strides", "Plane strides",
+          "Stride of each plane in bytes, if different from the default "
+          "layout of the format",
+          g_param_spec_int ("plane-stride", "Plane stride",
+              "Stride of the n-th plane in bytes", 1, G_MAXINT, 1,
+              G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS),
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_PLANE_OFFSETS,
+      g_param_spec_value_array ("plane-offsets", "Plane offsets",
+          "Offset of each plane in the frame in bytes, if different from "
+          "the default layout of the format",
+          g_param_spec_int ("plane-offset", "Plane offset",
+              "Offset of the n-th plane in bytes", 0, G_MAXINT, 0,
+              G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS),
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_FRAME_SIZE,
+      g_param_spec_uint ("frame-size", "Frame size",
+          "Size of a frame in the stream including any padding after the "
+          "last plane (0 = size of the planes)", 0, G_MAXINT, 0,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_set_static_metadata (gstelement_class, "Video Parse",
       "Filter/Video",
@@ -130,6 +168,19 @@ gst_video_parse_init (GstVideoParse * vp)
   gst_raw_parse_set_fps (GST_RAW_PARSE (vp), 25, 1);
 }
 
+static void
+gst_video_parse_finalize (GObject * object)
+{
+  GstVideoParse *vp = GST_VIDEO_PARSE (object);
+
+  if (vp->plane_strides)
+    g_value_array_free (vp->plane_strides);
+  if (vp->plane_offsets)
+    g_value_array_free (vp->plane_offsets);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_video_parse_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -163,6 +214,19 @@ gst_video_parse_set_property (GObject * object, guint prop_id,
     case PROP_TOP_FIELD_FIRST:
       vp->top_field_first = g_value_get_boolean (value);
       break;
+    case PROP_PLANE_STRIDES:
+      if (vp->plane_strides)
+        g_value_array_free (vp->plane_strides);
+      vp->plane_strides = g_value_dup_boxed (value);
+      break;
+    case PROP_PLANE_OFFSETS:
+      if (vp->plane_offsets)
+        g_value_array_free (vp->plane_offsets);
+      vp->plane_offsets = g_value_dup_boxed (value);
+      break;
+    case PROP_FRAME_SIZE:
+      vp->frame_size = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -203,21 +267,85 @@ gst_video_parse_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_TOP_FIELD_FIRST:
       g_value_set_boolean (value, vp->top_field_first);
       break;
+    case PROP_PLANE_STRIDES:
+      g_value_set_boxed (value, vp->plane_strides);
+      break;
+    case PROP_PLANE_OFFSETS:
+      g_value_set_boxed (value, vp->plane_offsets);
+      break;
+    case PROP_FRAME_SIZE:
+      g_value_set_uint (value, vp->frame_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* Returns the number of lines of @plane */
+static gint
+gst_video_parse_plane_height (GstVideoInfo * info, gint plane)
+{
+  gint i;
+
+  for (i = 0; i < GST_VIDEO_INFO_N_COMPONENTS (info); i++) {
+    if (GST_VIDEO_FORMAT_INFO_PLANE (info->finfo, i) == plane)
+      return GST_VIDEO_INFO_COMP_HEIGHT (info, i);
+  }
+
+  return 0;
+}
+
 void
 gst_video_parse_update_frame_size (GstVideoParse * vp)
 {
   gint framesize;
-  GstVideoInfo info;
+  GstVideoInfo info, default_info;
+  guint i, n_planes;
+
+  gst_video_info_init (&default_info);
+  gst_video_info_set_format (&default_info, vp->format, vp->width,
+      vp->height);
+  info = default_info;
+  n_planes = GST_VIDEO_INFO_N_PLANES (&info);
+
+  /* custom strides and offsets only apply if they match the format, without
+   * offsets the planes follow each other */
+  if (vp->plane_strides && vp->plane_strides->n_values == n_planes) {
+    for (i = 0; i < n_planes; i++) {
+      info.stride[i] =
+          g_value_get_int (g_value_array_get_nth (vp->plane_strides, i));
+      if (i > 0)
+        info.offset[i] = info.offset[i - 1] + info.stride[i - 1] *
+            gst_video_parse_plane_height (&info, i - 1);
+    }
+  } else if (vp->plane_strides) {
+    GST_DEBUG_OBJECT (vp, "ignoring %u plane strides for %u planes",
+        vp->plane_strides->n_values, n_planes);
+  }
+  if (vp->plane_offsets && vp->plane_offsets->n_values == n_planes) {
+    for (i = 0; i < n_planes; i++)
+      info.offset[i] =
+          g_value_get_int (g_value_array_get_nth (vp->plane_offsets, i));
+  } else if (vp->plane_offsets) {
+    GST_DEBUG_OBJECT (vp, "ignoring %u plane offsets for %u planes",
+        vp->plane_offsets->n_values, n_planes);
+  }
 
-  gst_video_info_init (&info);
-  gst_video_info_set_format (&info, vp->format, vp->width, vp->height);
-  framesize = GST_VIDEO_INFO_SIZE (&info);
+  framesize = 0;
+  for (i = 0; i < n_planes; i++) {
+    gint end = info.offset[i] + info.stride[i] *
+        gst_video_parse_plane_height (&info, i);
+
+    framesize = MAX (framesize, end);
+  }
+  framesize = MAX (framesize, (gint) vp->frame_size);
+  info.size = framesize;
+
+  vp->info = info;
+  vp->default_layout = info.size == default_info.size &&
+      memcmp (info.offset, default_info.offset, sizeof (info.offset)) == 0 &&
+      memcmp (info.stride, default_info.stride, sizeof (info.stride)) == 0;
 
   gst_raw_parse_set_framesize (GST_RAW_PARSE (vp), framesize);
 }
@@ -260,3 +388,63 @@ gst_video_parse_set_buffer_flags (GstRawParse * rp, GstBuffer * buffer)
     }
   }
 }
+
+static gboolean
+gst_video_parse_decide_allocation (GstRawParse * rp, GstQuery * query)
+{
+  GstVideoParse *vp = GST_VIDEO_PARSE (rp);
+
+  /* with the video meta downstream maps the planes through the meta, so
+   * the frames can keep their layout and be made of several memories */
+  vp->use_video_meta =
+      gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+
+  return vp->use_video_meta;
+}
+
+static GstBuffer *
+gst_video_parse_process (GstRawParse * rp, GstBuffer * buffer)
+{
+  GstVideoParse *vp = GST_VIDEO_PARSE (rp);
+  GstVideoInfo info;
+  GstVideoFrame in_frame, out_frame;
+  GstBuffer *outbuf;
+
+  if (vp->use_video_meta) {
+    gst_buffer_add_video_meta_full (buffer, GST_VIDEO_FRAME_FLAG_NONE,
+        vp->format, vp->width, vp->height, GST_VIDEO_INFO_N_PLANES (&vp->info),
+        vp->info.offset, vp->info.stride);
+    return buffer;
+  }
+
+  if (vp->default_layout)
+    return buffer;
+
+  /* downstream expects the default layout */
+  gst_video_info_init (&info);
+  gst_video_info_set_format (&info, vp->format, vp->width, vp->height);
+  outbuf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+
+  if (!gst_video_frame_map (&in_frame, &vp->info, buffer, GST_MAP_READ))
+    goto map_failed;
+  if (!gst_video_frame_map (&out_frame, &info, outbuf, GST_MAP_WRITE)) {
+    gst_video_frame_unmap (&in_frame);
+    goto map_failed;
+  }
+  gst_video_frame_copy (&out_frame, &in_frame);
+  gst_video_frame_unmap (&out_frame);
+  gst_video_frame_unmap (&in_frame);
+
+  gst_buffer_unref (buffer);
+
+  return outbuf;
+
+map_failed:
+  {
+    GST_ELEMENT_ERROR (vp, STREAM, FAILED, (NULL),
+        ("Failed to map video frame"));
+    gst_buffer_unref (outbuf);
+    gst_buffer_unref (buffer);
+    return NULL;
+  }
+}
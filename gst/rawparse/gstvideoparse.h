@@ -55,6 +55,16 @@ struct _GstVideoParse
   gint par_n, par_d;
   gboolean interlaced;
   gboolean top_field_first;
+  GValueArray *plane_strides;
+  GValueArray *plane_offsets;
+  guint frame_size;
+
+  /* layout of the frames in the stream */
+  GstVideoInfo info;
+  gboolean default_layout;
+
+  /* downstream handles GstVideoMeta */
+  gboolean use_video_meta;
 };
 
 struct _GstVideoParseClass
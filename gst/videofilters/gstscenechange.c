@@ -80,6 +80,7 @@
 #include <gst/gst.h>
 #include <gst/video/video.h>
 #include <gst/video/gstvideofilter.h>
+#include <gst/video/gstvideoframestats.h>
 #include <string.h>
 #include "gstscenechange.h"
 
@@ -143,25 +144,39 @@ gst_scene_change_init (GstSceneChange * scenechange)
 static double
 get_frame_score (GstVideoFrame * f1, GstVideoFrame * f2)
 {
-  int i;
-  int j;
-  int score = 0;
+  GstVideoFrameStatsMeta *meta;
+  GstClockTime reference_pts;
+  guint64 score;
+  guint64 n_samples;
   int width, height;
-  guint8 *s1;
-  guint8 *s2;
 
-  width = f1->info.width;
-  height = f1->info.height;
+  width = GST_VIDEO_FRAME_COMP_WIDTH (f2, 0);
+  height = GST_VIDEO_FRAME_COMP_HEIGHT (f2, 0);
+  n_samples = (guint64) width *height;
+  reference_pts = GST_BUFFER_PTS (f1->buffer);
 
-  for (j = 0; j < height; j++) {
-    s1 = (guint8 *) f1->data[0] + f1->info.stride[0] * j;
-    s2 = (guint8 *) f2->data[0] + f2->info.stride[0] * j;
-    for (i = 0; i < width; i++) {
-      score += ABS (s1[i] - s2[i]);
-    }
+  /* reuse the difference if something upstream compared the same pair */
+  meta = gst_buffer_get_video_frame_stats_meta (f2->buffer);
+  if (meta && (meta->flags & GST_VIDEO_FRAME_STATS_SAD) &&
+      meta->reference_pts == reference_pts && meta->n_samples == n_samples) {
+    return ((double) meta->sad) / n_samples;
+  }
+
+  score = gst_video_frame_stats_sad (GST_VIDEO_FRAME_COMP_DATA (f1, 0),
+      GST_VIDEO_FRAME_COMP_STRIDE (f1, 0), GST_VIDEO_FRAME_COMP_DATA (f2, 0),
+      GST_VIDEO_FRAME_COMP_STRIDE (f2, 0), width, height);
+
+  if (gst_buffer_is_writable (f2->buffer)) {
+    if (!meta)
+      meta = gst_buffer_add_video_frame_stats_meta (f2->buffer);
+    meta->flags |= GST_VIDEO_FRAME_STATS_SAD;
+    meta->flags &= ~GST_VIDEO_FRAME_STATS_SSD;
+    meta->reference_pts = reference_pts;
+    meta->n_samples = n_samples;
+    meta->sad = score;
   }
 
-  return ((double) score) / (width * height);
+  return ((double) score) / n_samples;
 }
 
 static GstFlowReturn
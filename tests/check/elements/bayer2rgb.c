@@ -0,0 +1,323 @@
+/* GStreamer
+ *
+ * unit test for bayer2rgb
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+
+#define WIDTH 66
+#define HEIGHT 38
+
+static const gchar *methods[] = { "bilinear", "mhc" };
+
+/* 8 bit samples, or the same values shifted up to bpp bits when bpp > 8 */
+static GstBuffer *
+make_bayer (const guint8 * samples, gint width, gint height, gint bpp,
+    gboolean big_endian)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  gint i;
+
+  if (bpp == 8) {
+    buf = gst_buffer_new_allocate (NULL, width * height, NULL);
+    gst_buffer_fill (buf, 0, samples, width * height);
+    return buf;
+  }
+
+  buf = gst_buffer_new_allocate (NULL, width * height * 2, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  for (i = 0; i < width * height; i++) {
+    guint16 v = samples[i] << (bpp - 8);
+
+    if (big_endian)
+      GST_WRITE_UINT16_BE (map.data + 2 * i, v);
+    else
+      GST_WRITE_UINT16_LE (map.data + 2 * i, v);
+  }
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static guint8 *
+make_samples (guint32 seed, gint width, gint height)
+{
+  GRand *rand = g_rand_new_with_seed (seed);
+  guint8 *samples = g_malloc (width * height);
+  gint i;
+
+  for (i = 0; i < width * height; i++)
+    samples[i] = g_rand_int_range (rand, 0, 256);
+  g_rand_free (rand);
+
+  return samples;
+}
+
+/* converts one frame and returns the RGBx output */
+static GstBuffer *
+convert (const gchar * format, const gchar * method, guint n_threads,
+    GstBuffer * in, gint width, gint height)
+{
+  GstHarness *h = gst_harness_new ("bayer2rgb");
+  gchar *incaps, *outcaps;
+  GstBuffer *out;
+
+  g_object_set (h->element, "n-threads", n_threads, NULL);
+  gst_util_set_object_arg (G_OBJECT (h->element), "method", method);
+
+  incaps = g_strdup_printf ("video/x-bayer,format=%s,width=%d,height=%d,"
+      "framerate=30/1", format, width, height);
+  outcaps = g_strdup_printf ("video/x-raw,format=RGBx,width=%d,height=%d,"
+      "framerate=30/1", width, height);
+  gst_harness_set_caps_str (h, incaps, outcaps);
+  g_free (incaps);
+  g_free (outcaps);
+
+  fail_unless_equals_int (gst_harness_push (h, in), GST_FLOW_OK);
+  out = gst_harness_pull (h);
+  fail_unless (out != NULL);
+  fail_unless_equals_int (gst_buffer_get_size (out), width * height * 4);
+
+  gst_harness_teardown (h);
+
+  return out;
+}
+
+static void
+assert_buffers_equal (GstBuffer * a, GstBuffer * b)
+{
+  GstMapInfo map_a, map_b;
+
+  gst_buffer_map (a, &map_a, GST_MAP_READ);
+  gst_buffer_map (b, &map_b, GST_MAP_READ);
+  fail_unless_equals_int (map_a.size, map_b.size);
+  fail_unless (memcmp (map_a.data, map_b.data, map_a.size) == 0);
+  gst_buffer_unmap (a, &map_a);
+  gst_buffer_unmap (b, &map_b);
+}
+
+GST_START_TEST (test_flat)
+{
+  static const gchar *formats[] = { "bggr", "gbrg", "grbg", "rggb" };
+  guint8 samples[WIDTH * HEIGHT];
+  GstBuffer *out;
+  GstMapInfo map;
+  gint f, m, i;
+
+  /* a grey frame stays grey with every pattern and method */
+  memset (samples, 100, sizeof (samples));
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+    for (m = 0; m < G_N_ELEMENTS (methods); m++) {
+      out = convert (formats[f], methods[m], 1,
+          make_bayer (samples, WIDTH, HEIGHT, 8, FALSE), WIDTH, HEIGHT);
+
+      gst_buffer_map (out, &map, GST_MAP_READ);
+      for (i = 0; i < WIDTH * HEIGHT; i++) {
+        fail_unless_equals_int (map.data[4 * i + 0], 100);
+        fail_unless_equals_int (map.data[4 * i + 1], 100);
+        fail_unless_equals_int (map.data[4 * i + 2], 100);
+      }
+      gst_buffer_unmap (out, &map);
+      gst_buffer_unref (out);
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_narrow)
+{
+  static const gint sizes[][2] = { {2, 2}, {4, 2}, {2, 4}, {2, 7} };
+  static const gchar *formats[] = { "bggr", "gbrg", "grbg", "rggb" };
+  guint8 samples[2 * 7];
+  GstBuffer *out;
+  GstMapInfo map;
+  gint s, f, m, i;
+
+  /* frames too small to mirror a second sample of each colour at the
+   * edges, which must not make the filters read outside of the lines */
+  memset (samples, 100, sizeof (samples));
+
+  for (s = 0; s < G_N_ELEMENTS (sizes); s++) {
+    gint width = sizes[s][0], height = sizes[s][1];
+
+    for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+      for (m = 0; m < G_N_ELEMENTS (methods); m++) {
+        out = convert (formats[f], methods[m], 2,
+            make_bayer (samples, width, height, 8, FALSE), width, height);
+
+        gst_buffer_map (out, &map, GST_MAP_READ);
+        for (i = 0; i < width * height; i++) {
+          fail_unless_equals_int (map.data[4 * i + 0], 100);
+          fail_unless_equals_int (map.data[4 * i + 1], 100);
+          fail_unless_equals_int (map.data[4 * i + 2], 100);
+        }
+        gst_buffer_unmap (out, &map);
+        gst_buffer_unref (out);
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_threads)
+{
+  guint8 *samples = make_samples (1, WIDTH, HEIGHT);
+  GstBuffer *ref, *out;
+  guint n_threads;
+  gint m;
+
+  /* the bands must join up without seams */
+  for (m = 0; m < G_N_ELEMENTS (methods); m++) {
+    ref = convert ("grbg", methods[m], 1,
+        make_bayer (samples, WIDTH, HEIGHT, 8, FALSE), WIDTH, HEIGHT);
+
+    for (n_threads = 2; n_threads <= 7; n_threads++) {
+      out = convert ("grbg", methods[m], n_threads,
+          make_bayer (samples, WIDTH, HEIGHT, 8, FALSE), WIDTH, HEIGHT);
+      assert_buffers_equal (ref, out);
+      gst_buffer_unref (out);
+    }
+    gst_buffer_unref (ref);
+  }
+
+  g_free (samples);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_high_bit_depth)
+{
+  static const struct
+  {
+    const gchar *format;
+    gint bpp;
+    gboolean big_endian;
+  } formats[] = {
+    {
+    "rggb10le", 10, FALSE}, {
+    "rggb10be", 10, TRUE}, {
+    "rggb12le", 12, FALSE}, {
+    "rggb12be", 12, TRUE}, {
+    "rggb16le", 16, FALSE}, {
+    "rggb16be", 16, TRUE}
+  };
+  guint8 *samples = make_samples (2, WIDTH, HEIGHT);
+  GstBuffer *ref, *out;
+  gint f, m;
+
+  /* the output is 8 bit, so the same samples in any depth give the same
+   * frame */
+  for (m = 0; m < G_N_ELEMENTS (methods); m++) {
+    ref = convert ("rggb", methods[m], 1,
+        make_bayer (samples, WIDTH, HEIGHT, 8, FALSE), WIDTH, HEIGHT);
+
+    for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+      out = convert (formats[f].format, methods[m], 2,
+          make_bayer (samples, WIDTH, HEIGHT, formats[f].bpp,
+              formats[f].big_endian), WIDTH, HEIGHT);
+      assert_buffers_equal (ref, out);
+      gst_buffer_unref (out);
+    }
+    gst_buffer_unref (ref);
+  }
+
+  g_free (samples);
+}
+
+GST_END_TEST;
+
+#define BENCH_WIDTH 1920
+#define BENCH_HEIGHT 1080
+#define BENCH_FRAMES 10
+
+GST_START_TEST (test_benchmark)
+{
+  static const gchar *formats[] = { "bggr", "bggr12le" };
+  static const guint threads[] = { 1, 4 };
+  guint8 *samples = make_samples (3, BENCH_WIDTH, BENCH_HEIGHT);
+  gint f, m, t, n;
+
+  for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+    for (m = 0; m < G_N_ELEMENTS (methods); m++) {
+      for (t = 0; t < G_N_ELEMENTS (threads); t++) {
+        GstHarness *h = gst_harness_new ("bayer2rgb");
+        gchar *incaps;
+        gint64 start, elapsed;
+
+        g_object_set (h->element, "n-threads", threads[t], NULL);
+        gst_util_set_object_arg (G_OBJECT (h->element), "method", methods[m]);
+        incaps = g_strdup_printf ("video/x-bayer,format=%s,width=%d,"
+            "height=%d,framerate=30/1", formats[f], BENCH_WIDTH,
+            BENCH_HEIGHT);
+        gst_harness_set_caps_str (h, incaps, "video/x-raw,format=RGBx");
+        g_free (incaps);
+
+        start = g_get_monotonic_time ();
+        for (n = 0; n < BENCH_FRAMES; n++) {
+          GstBuffer *in = make_bayer (samples, BENCH_WIDTH, BENCH_HEIGHT,
+              f == 0 ? 8 : 12, FALSE);
+
+          fail_unless_equals_int (gst_harness_push (h, in), GST_FLOW_OK);
+          gst_buffer_unref (gst_harness_pull (h));
+        }
+        elapsed = MAX (g_get_monotonic_time () - start, 1);
+
+        GST_INFO ("%s %s, %u threads: %.1f MP/s", formats[f], methods[m],
+            threads[t], (gdouble) BENCH_FRAMES * BENCH_WIDTH * BENCH_HEIGHT /
+            elapsed);
+
+        gst_harness_teardown (h);
+      }
+    }
+  }
+
+  g_free (samples);
+}
+
+GST_END_TEST;
+
+static Suite *
+bayer2rgb_suite (void)
+{
+  Suite *s = suite_create ("bayer2rgb");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_flat);
+  tcase_add_test (tc_chain, test_narrow);
+  tcase_add_test (tc_chain, test_threads);
+  tcase_add_test (tc_chain, test_high_bit_depth);
+  tcase_add_test (tc_chain, test_benchmark);
+
+  return s;
+}
+
+GST_CHECK_MAIN (bayer2rgb);
@@ -0,0 +1,309 @@
+/* GStreamer
+ *
+ * unit test for checksumsink
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_UNIX
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define CSV_HEADER "frame,pts,plane,checksum\n"
+
+static const gchar spam[] = "Nobody inspects the spammish repetition";
+
+static GstBuffer *
+make_buffer (const guint8 * data, gsize size, GstClockTime pts)
+{
+  GstBuffer *buf;
+
+  if (size == 0) {
+    buf = gst_buffer_new ();
+  } else {
+    buf = gst_buffer_new_allocate (NULL, size, NULL);
+    gst_buffer_fill (buf, 0, data, size);
+  }
+  GST_BUFFER_PTS (buf) = pts;
+
+  return buf;
+}
+
+/* pushes @bufs through a checksumsink writing to a temporary CSV file and
+ * returns the contents of that file */
+static gchar *
+run_checksumsink (const gchar * hash, gboolean plane_checksums,
+    const gchar * caps, GstBuffer ** bufs, guint n_bufs)
+{
+  GstHarness *h;
+  gchar *location, *contents;
+  gint fd;
+  guint i;
+
+  fd = g_file_open_tmp ("checksumsink-XXXXXX.csv", &location, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+
+  h = gst_harness_new ("checksumsink");
+  gst_util_set_object_arg (G_OBJECT (h->element), "hash", hash);
+  g_object_set (h->element, "plane-checksums", plane_checksums,
+      "location", location, NULL);
+  gst_harness_set_src_caps_str (h, caps);
+
+  for (i = 0; i < n_bufs; i++)
+    fail_unless_equals_int (gst_harness_push (h, bufs[i]), GST_FLOW_OK);
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+
+  /* stopping joins the hashing thread and closes the file */
+  gst_harness_teardown (h);
+
+  fail_unless (g_file_get_contents (location, &contents, NULL, NULL));
+  g_unlink (location);
+  g_free (location);
+
+  return contents;
+}
+
+/* CRC-32C test vectors from RFC 3720, appendix B.4, and the common
+ * "123456789" check value */
+GST_START_TEST (test_crc32c_vectors)
+{
+  GstBuffer *bufs[6];
+  guint8 data[32];
+  gchar *csv;
+  gint i;
+
+  bufs[0] = make_buffer (NULL, 0, GST_CLOCK_TIME_NONE);
+  bufs[1] = make_buffer ((const guint8 *) "123456789", 9, 0);
+  memset (data, 0x00, sizeof (data));
+  bufs[2] = make_buffer (data, sizeof (data), GST_SECOND);
+  memset (data, 0xff, sizeof (data));
+  bufs[3] = make_buffer (data, sizeof (data), 2 * GST_SECOND);
+  for (i = 0; i < 32; i++)
+    data[i] = i;
+  bufs[4] = make_buffer (data, sizeof (data), 3 * GST_SECOND);
+  for (i = 0; i < 32; i++)
+    data[i] = 31 - i;
+  bufs[5] = make_buffer (data, sizeof (data), 4 * GST_SECOND);
+
+  csv = run_checksumsink ("crc32c", FALSE, "application/octet-stream", bufs,
+      G_N_ELEMENTS (bufs));
+  fail_unless_equals_string (csv, CSV_HEADER
+      "0,-1,-1,00000000\n"
+      "1,0,-1,e3069283\n"
+      "2,1000000000,-1,8a9136aa\n"
+      "3,2000000000,-1,62a8ab43\n"
+      "4,3000000000,-1,46dd794e\n" "5,4000000000,-1,113fdb5c\n");
+  g_free (csv);
+}
+
+GST_END_TEST;
+
+/* xxHash32 with seed 0, published values of the reference implementation */
+GST_START_TEST (test_xxhash32_vectors)
+{
+  GstBuffer *bufs[4];
+  gchar *csv;
+
+  bufs[0] = make_buffer (NULL, 0, 0);
+  bufs[1] = make_buffer ((const guint8 *) "abc", 3, 1);
+  /* longer than one 16 byte stripe, with a tail of 7 bytes */
+  bufs[2] = make_buffer ((const guint8 *) spam, strlen (spam), 2);
+  bufs[3] = make_buffer ((const guint8 *) "123456789", 9, 3);
+
+  csv = run_checksumsink ("xxhash32", FALSE, "application/octet-stream", bufs,
+      G_N_ELEMENTS (bufs));
+  fail_unless_equals_string (csv, CSV_HEADER
+      "0,0,-1,02cc5d05\n"
+      "1,1,-1,32d153ff\n" "2,2,-1,e2293b2f\n" "3,3,-1,937bad67\n");
+  g_free (csv);
+}
+
+GST_END_TEST;
+
+/* a GRAY8 frame of @width x @height whose visible bytes are @data, in lines
+ * of @stride bytes padded with garbage */
+static GstBuffer *
+make_padded_frame (const gchar * data, gint width, gint height, gint stride)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, stride * height, NULL);
+  gsize offset[GST_VIDEO_MAX_PLANES] = { 0, };
+  gint strides[GST_VIDEO_MAX_PLANES] = { stride, };
+  GstMapInfo map;
+  gint y;
+
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_WRITE));
+  memset (map.data, 0xaa, map.size);
+  for (y = 0; y < height; y++)
+    memcpy (map.data + y * stride, data + y * width, width);
+  gst_buffer_unmap (buf, &map);
+
+  gst_buffer_add_video_meta_full (buf, GST_VIDEO_FRAME_FLAG_NONE,
+      GST_VIDEO_FORMAT_GRAY8, width, height, 1, offset, strides);
+  GST_BUFFER_PTS (buf) = 0;
+
+  return buf;
+}
+
+GST_START_TEST (test_plane_checksums_padded)
+{
+  GstBuffer *buf;
+  gchar *csv;
+
+  /* the 39 bytes of spam as three lines of 13, each padded to 32 bytes,
+   * so every line ends in the middle of a stripe */
+  buf = make_padded_frame (spam, 13, 3, 32);
+  csv = run_checksumsink ("xxhash32", TRUE,
+      "video/x-raw,format=GRAY8,width=13,height=3,framerate=25/1", &buf, 1);
+  fail_unless_equals_string (csv, CSV_HEADER "0,0,0,e2293b2f\n");
+  g_free (csv);
+
+  buf = make_padded_frame ("123456789", 3, 3, 8);
+  csv = run_checksumsink ("crc32c", TRUE,
+      "video/x-raw,format=GRAY8,width=3,height=3,framerate=25/1", &buf, 1);
+  fail_unless_equals_string (csv, CSV_HEADER "0,0,0,e3069283\n");
+  g_free (csv);
+
+  /* without plane-checksums the padding is hashed too */
+  buf = make_padded_frame ("123456789", 3, 3, 8);
+  csv = run_checksumsink ("crc32c", FALSE,
+      "video/x-raw,format=GRAY8,width=3,height=3,framerate=25/1", &buf, 1);
+  fail_unless (g_str_has_prefix (csv, CSV_HEADER "0,0,-1,"));
+  fail_if (g_str_has_suffix (csv, ",e3069283\n"));
+  g_free (csv);
+}
+
+GST_END_TEST;
+
+#ifdef G_OS_UNIX
+typedef struct
+{
+  GstHarness *h;
+  volatile gint pushed;
+  GstFlowReturn ret;
+} StallData;
+
+static gpointer
+push_until_error (gpointer user_data)
+{
+  StallData *data = user_data;
+
+  do {
+    data->ret = gst_harness_push (data->h, make_buffer ((const guint8 *) spam,
+            sizeof (spam), g_atomic_int_get (&data->pushed) * GST_SECOND));
+    g_atomic_int_inc (&data->pushed);
+  } while (data->ret == GST_FLOW_OK);
+
+  return NULL;
+}
+
+static gpointer
+read_until_eof (gpointer user_data)
+{
+  gint fd = GPOINTER_TO_INT (user_data);
+  gchar buf[4096];
+
+  while (read (fd, buf, sizeof (buf)) > 0);
+
+  return NULL;
+}
+
+/* a flush must release render() waiting for room in the queue while the
+ * hashing thread is stuck writing to a full pipe */
+GST_START_TEST (test_flush_unblocks_render)
+{
+  StallData data = { NULL, 0, GST_FLOW_OK };
+  GThread *pusher, *reader;
+  gchar *location;
+  gint fd, pushed;
+
+  location = g_build_filename (g_get_tmp_dir (), "checksumsink-fifo-XXXXXX",
+      NULL);
+  fd = g_mkstemp (location);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  g_unlink (location);
+  fail_unless (mkfifo (location, 0600) == 0);
+
+  /* open the reading end so that opening the writing end doesn't block,
+   * but don't read until the sink is stuck */
+  fd = open (location, O_RDONLY | O_NONBLOCK);
+  fail_unless (fd >= 0);
+
+  data.h = gst_harness_new ("checksumsink");
+  g_object_set (data.h->element, "location", location, "max-pending", 1,
+      NULL);
+  gst_harness_set_src_caps_str (data.h, "application/octet-stream");
+
+  pusher = g_thread_new ("push", push_until_error, &data);
+
+  /* wait until the pipe is full and pushing stalls */
+  do {
+    pushed = g_atomic_int_get (&data.pushed);
+    g_usleep (G_USEC_PER_SEC / 5);
+  } while (pushed == 0 || pushed != g_atomic_int_get (&data.pushed));
+
+  fail_unless (gst_harness_push_event (data.h, gst_event_new_flush_start ()));
+  g_thread_join (pusher);
+  fail_unless_equals_int (data.ret, GST_FLOW_FLUSHING);
+
+  /* let the hashing thread finish so that stopping can join it */
+  fail_unless (fcntl (fd, F_SETFL, 0) == 0);
+  reader = g_thread_new ("read", read_until_eof, GINT_TO_POINTER (fd));
+  gst_harness_teardown (data.h);
+  g_thread_join (reader);
+
+  close (fd);
+  g_unlink (location);
+  g_free (location);
+}
+
+GST_END_TEST;
+#endif
+
+static Suite *
+checksumsink_suite (void)
+{
+  Suite *s = suite_create ("checksumsink");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_crc32c_vectors);
+  tcase_add_test (tc_chain, test_xxhash32_vectors);
+  tcase_add_test (tc_chain, test_plane_checksums_padded);
+#ifdef G_OS_UNIX
+  tcase_add_test (tc_chain, test_flush_unblocks_render);
+#endif
+
+  return s;
+}
+
+GST_CHECK_MAIN (checksumsink);
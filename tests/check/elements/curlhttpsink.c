@@ -2,8 +2,12 @@
  * Unittest for curlhttpsink
  */
 
+#include <string.h>
+
 #include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
 #include <glib/gstdio.h>
+#include <gio/gio.h>
 #include <curl/curl.h>
 
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
@@ -120,6 +124,251 @@ GST_START_TEST (test_properties)
 }
 GST_END_TEST;
 
+/* A local HTTP server that takes a single chunked upload */
+typedef struct
+{
+  GSocketListener *listener;
+  GThread *thread;
+  guint16 port;
+  GByteArray *body;
+} TestServer;
+
+static gchar *
+server_read_line (GDataInputStream * in)
+{
+  return g_data_input_stream_read_line (in, NULL, NULL, NULL);
+}
+
+static gpointer
+server_thread_func (TestServer * server)
+{
+  GSocketConnection *conn;
+  GDataInputStream *in;
+  GOutputStream *out;
+  gboolean expect_continue = FALSE;
+  const gchar *response = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+  gchar *line;
+
+  conn = g_socket_listener_accept (server->listener, NULL, NULL, NULL);
+  if (conn == NULL)
+    return NULL;
+
+  in = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM
+          (conn)));
+  g_data_input_stream_set_newline_type (in, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+  out = g_io_stream_get_output_stream (G_IO_STREAM (conn));
+
+  /* request line and headers */
+  while ((line = server_read_line (in)) && *line) {
+    if (g_ascii_strcasecmp (line, "Expect: 100-continue") == 0)
+      expect_continue = TRUE;
+    g_free (line);
+  }
+  g_free (line);
+
+  if (expect_continue)
+    g_output_stream_write_all (out, "HTTP/1.1 100 Continue\r\n\r\n",
+        strlen ("HTTP/1.1 100 Continue\r\n\r\n"), NULL, NULL, NULL);
+
+  /* chunked body, up to the last chunk and the empty trailer */
+  while ((line = server_read_line (in))) {
+    guint64 size = g_ascii_strtoull (line, NULL, 16);
+    guint offset = server->body->len;
+
+    g_free (line);
+    if (size == 0)
+      break;
+
+    g_byte_array_set_size (server->body, offset + size);
+    if (!g_input_stream_read_all (G_INPUT_STREAM (in),
+            server->body->data + offset, size, NULL, NULL, NULL))
+      break;
+    g_free (server_read_line (in));
+  }
+  g_free (server_read_line (in));
+
+  g_output_stream_write_all (out, response, strlen (response), NULL, NULL,
+      NULL);
+
+  g_object_unref (in);
+  g_object_unref (conn);
+
+  return NULL;
+}
+
+static TestServer *
+test_server_new (void)
+{
+  TestServer *server = g_new0 (TestServer, 1);
+
+  server->listener = g_socket_listener_new ();
+  server->port = g_socket_listener_add_any_inet_port (server->listener, NULL,
+      NULL);
+  fail_unless (server->port != 0);
+  server->body = g_byte_array_new ();
+  server->thread = g_thread_new ("http-server",
+      (GThreadFunc) server_thread_func, server);
+
+  return server;
+}
+
+/* waits for the upload to complete */
+static void
+test_server_join (TestServer * server)
+{
+  if (server->thread) {
+    g_thread_join (server->thread);
+    server->thread = NULL;
+  }
+}
+
+static void
+test_server_free (TestServer * server)
+{
+  test_server_join (server);
+  g_object_unref (server->listener);
+  g_byte_array_unref (server->body);
+  g_free (server);
+}
+
+static GstHarness *
+setup_upload (TestServer * server, guint max_queue_bytes)
+{
+  GstHarness *h = gst_harness_new ("curlhttpsink");
+  gchar *location;
+
+  location = g_strdup_printf ("http://127.0.0.1:%u/upload", server->port);
+  g_object_set (h->element, "location", location, "content-type",
+      "application/octet-stream", "max-queue-bytes", max_queue_bytes, NULL);
+  g_free (location);
+  gst_harness_set_src_caps_str (h, "application/octet-stream");
+
+  return h;
+}
+
+#define BUFFER_SIZE 4096
+#define N_BUFFERS 64
+
+GST_START_TEST (test_upload)
+{
+  TestServer *server = test_server_new ();
+  GstHarness *h;
+  guint max_queue_bytes;
+  gint i, j;
+
+  /* room for a few buffers, so render has to wait for the transfer */
+  h = setup_upload (server, 3 * BUFFER_SIZE);
+  g_object_get (h->element, "max-queue-bytes", &max_queue_bytes, NULL);
+  fail_unless_equals_int (max_queue_bytes, 3 * BUFFER_SIZE);
+
+  for (i = 0; i < N_BUFFERS; i++) {
+    GstBuffer *buf = gst_buffer_new_allocate (NULL, BUFFER_SIZE, NULL);
+
+    gst_buffer_memset (buf, 0, i, BUFFER_SIZE);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+
+  /* EOS only returns once everything queued has been sent */
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  gst_harness_teardown (h);
+
+  test_server_join (server);
+  fail_unless_equals_int (server->body->len, N_BUFFERS * BUFFER_SIZE);
+  for (i = 0; i < N_BUFFERS; i++) {
+    for (j = 0; j < BUFFER_SIZE; j++)
+      fail_unless_equals_int (server->body->data[i * BUFFER_SIZE + j], i);
+  }
+
+  test_server_free (server);
+}
+
+GST_END_TEST;
+
+/* uploads buffers of many sizes, each filled with its index, and checks
+ * that the server got all of them in order */
+static void
+check_upload_sizes (guint max_queue_bytes)
+{
+  TestServer *server = test_server_new ();
+  GstHarness *h = setup_upload (server, max_queue_bytes);
+  gsize sizes[N_BUFFERS], total = 0, offset = 0;
+  gint i;
+  gsize j;
+
+  for (i = 0; i < N_BUFFERS; i++) {
+    GstBuffer *buf;
+
+    sizes[i] = 1 + (i * 997) % (2 * BUFFER_SIZE);
+    buf = gst_buffer_new_allocate (NULL, sizes[i], NULL);
+    gst_buffer_memset (buf, 0, i, sizes[i]);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+    total += sizes[i];
+  }
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  gst_harness_teardown (h);
+
+  test_server_join (server);
+  fail_unless_equals_int (server->body->len, total);
+  for (i = 0; i < N_BUFFERS; i++) {
+    for (j = 0; j < sizes[i]; j++)
+      fail_unless_equals_int (server->body->data[offset + j], i);
+    offset += sizes[i];
+  }
+
+  test_server_free (server);
+}
+
+GST_START_TEST (test_upload_queue_sizes)
+{
+  /* a single byte already fills the queue, so render waits for every
+   * buffer to be sent like it did before there was a queue */
+  check_upload_sizes (1);
+  /* a queue larger than the whole upload */
+  check_upload_sizes (256 * 1024);
+}
+
+GST_END_TEST;
+
+#define BENCHMARK_BUFFERS 2000
+
+static gdouble
+run_upload_benchmark (guint max_queue_bytes)
+{
+  TestServer *server = test_server_new ();
+  GstHarness *h = setup_upload (server, max_queue_bytes);
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, BUFFER_SIZE, NULL);
+  gint64 start, elapsed;
+  gint i;
+
+  gst_buffer_memset (buf, 0, 0xaa, BUFFER_SIZE);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < BENCHMARK_BUFFERS; i++)
+    fail_unless_equals_int (gst_harness_push (h, gst_buffer_ref (buf)),
+        GST_FLOW_OK);
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  elapsed = MAX (g_get_monotonic_time () - start, 1);
+
+  gst_buffer_unref (buf);
+  gst_harness_teardown (h);
+  test_server_join (server);
+  test_server_free (server);
+
+  return (gdouble) BENCHMARK_BUFFERS * BUFFER_SIZE * 8 / elapsed;
+}
+
+/* only reports the throughput of uploading in lock-step and through the
+ * queue */
+GST_START_TEST (test_benchmark)
+{
+  g_print ("curlhttpsink, lock-step: %.1f Mbit/s\n",
+      run_upload_benchmark (1));
+  g_print ("curlhttpsink, queued: %.1f Mbit/s\n",
+      run_upload_benchmark (256 * 1024));
+}
+
+GST_END_TEST;
+
 static Suite *
 curlsink_suite (void)
 {
@@ -129,6 +378,17 @@ curlsink_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_set_timeout (tc_chain, 20);
   tcase_add_test (tc_chain, test_properties);
+  tcase_add_test (tc_chain, test_upload);
+  tcase_add_test (tc_chain, test_upload_queue_sizes);
+
+  /* timings only, not part of make check */
+  if (g_getenv ("GST_CHECK_BENCHMARKS")) {
+    TCase *tc_benchmark = tcase_create ("benchmark");
+
+    suite_add_tcase (s, tc_benchmark);
+    tcase_set_timeout (tc_benchmark, 0);
+    tcase_add_test (tc_benchmark, test_benchmark);
+  }
 
   return s;
 }
@@ -0,0 +1,271 @@
+/* GStreamer
+ *
+ * unit test for dvdspu
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define VIDEO_CAPS "video/x-raw,format=I420,width=64,height=48,framerate=25/1"
+#define DISP_LEFT 16
+#define DISP_TOP 8
+#define DISP_RIGHT 31
+#define DISP_BOTTOM 15
+#define N_LINES (DISP_BOTTOM - DISP_TOP + 1)
+
+/* 100 ticks of the 90kHz / 1024 SPU clock, about 1.14 seconds */
+#define STOP_DELAY 100
+
+/* A VobSub packet that fills the display area with the first opaque colour
+ * of the default palette, white, and switches it off after STOP_DELAY */
+static GstBuffer *
+make_spu_packet (void)
+{
+  guint8 data[4 + 2 * N_LINES + 24 + 6];
+  guint8 *pos = data;
+  guint16 dcsq1 = 4 + 2 * N_LINES, dcsq2 = dcsq1 + 24;
+  gint i;
+
+  GST_WRITE_UINT16_BE (pos, sizeof (data));
+  GST_WRITE_UINT16_BE (pos + 2, dcsq1);
+  pos += 4;
+
+  /* Every line is a single run of colour 1 up to the end of the line */
+  for (i = 0; i < N_LINES; i++, pos += 2) {
+    pos[0] = 0x00;
+    pos[1] = 0x01;
+  }
+
+  GST_WRITE_UINT16_BE (pos, 0);
+  GST_WRITE_UINT16_BE (pos + 2, dcsq2);
+  pos += 4;
+  /* SET_COLOR and SET_ALPHA: colour 1 is opaque, the others transparent */
+  *pos++ = 0x03;
+  *pos++ = 0x00;
+  *pos++ = 0x00;
+  *pos++ = 0x04;
+  *pos++ = 0x00;
+  *pos++ = 0xf0;
+  /* SET_DAREA */
+  *pos++ = 0x05;
+  *pos++ = DISP_LEFT >> 4;
+  *pos++ = ((DISP_LEFT & 0x0f) << 4) | (DISP_RIGHT >> 8);
+  *pos++ = DISP_RIGHT & 0xff;
+  *pos++ = DISP_TOP >> 4;
+  *pos++ = ((DISP_TOP & 0x0f) << 4) | (DISP_BOTTOM >> 8);
+  *pos++ = DISP_BOTTOM & 0xff;
+  /* SET_DSPXA: the top field starts with the first line, the bottom field
+   * with the second */
+  *pos++ = 0x06;
+  GST_WRITE_UINT16_BE (pos, 4);
+  GST_WRITE_UINT16_BE (pos + 2, 6);
+  pos += 4;
+  /* STA_DSP, CMD_END */
+  *pos++ = 0x01;
+  *pos++ = 0xff;
+
+  GST_WRITE_UINT16_BE (pos, STOP_DELAY);
+  GST_WRITE_UINT16_BE (pos + 2, dcsq2);
+  pos += 4;
+  /* STP_DSP, CMD_END */
+  *pos++ = 0x02;
+  *pos++ = 0xff;
+
+  fail_unless_equals_int (pos - data, sizeof (data));
+
+  return gst_buffer_new_wrapped (g_memdup (data, sizeof (data)),
+      sizeof (data));
+}
+
+static GstHarness *
+setup_dvdspu (gboolean overlay_meta, GstHarness ** subpic)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("dvdspu", "video", "src");
+  GstBuffer *buf;
+
+  if (overlay_meta)
+    gst_harness_add_propose_allocation_meta (h,
+        GST_VIDEO_OVERLAY_COMPOSITION_META_API_TYPE, NULL);
+  gst_harness_set_src_caps_str (h, VIDEO_CAPS);
+
+  *subpic = gst_harness_new_with_element (h->element, "subpicture", NULL);
+  gst_harness_set_src_caps_str (*subpic, "subpicture/x-dvd");
+
+  buf = make_spu_packet ();
+  GST_BUFFER_PTS (buf) = 0;
+  fail_unless_equals_int (gst_harness_push (*subpic, buf), GST_FLOW_OK);
+
+  return h;
+}
+
+/* Pushes a dark grey frame and returns what comes out */
+static GstBuffer *
+push_frame (GstHarness * h, GstVideoInfo * info, GstClockTime pts)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, info->size, NULL);
+  GstVideoFrame frame;
+  gint i;
+
+  fail_unless (gst_video_frame_map (&frame, info, buf, GST_MAP_WRITE));
+  for (i = 0; i < 3; i++)
+    memset (GST_VIDEO_FRAME_COMP_DATA (&frame, i), i == 0 ? 16 : 128,
+        GST_VIDEO_FRAME_COMP_STRIDE (&frame, i) *
+        GST_VIDEO_FRAME_COMP_HEIGHT (&frame, i));
+  gst_video_frame_unmap (&frame);
+
+  GST_BUFFER_PTS (buf) = pts;
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+
+  return gst_harness_pull (h);
+}
+
+/* Checks the luma is white over the display area and untouched around it.
+ * The last column of the display area is never drawn */
+static void
+check_luma (GstVideoInfo * info, GstBuffer * buf, gboolean overlay)
+{
+  GstVideoFrame frame;
+  guint8 *line;
+  gint x, y;
+
+  fail_unless (gst_video_frame_map (&frame, info, buf, GST_MAP_READ));
+  for (y = 0; y < GST_VIDEO_FRAME_HEIGHT (&frame); y++) {
+    line = (guint8 *) GST_VIDEO_FRAME_COMP_DATA (&frame, 0) +
+        y * GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+
+    for (x = 0; x < GST_VIDEO_FRAME_WIDTH (&frame); x++) {
+      gboolean inside = y >= DISP_TOP && y <= DISP_BOTTOM &&
+          x >= DISP_LEFT && x < DISP_RIGHT;
+
+      if (x == DISP_RIGHT && y >= DISP_TOP && y <= DISP_BOTTOM)
+        continue;
+      fail_unless_equals_int (line[x], overlay && inside ? 240 : 16);
+    }
+  }
+  gst_video_frame_unmap (&frame);
+}
+
+GST_START_TEST (test_blend)
+{
+  GstHarness *h, *subpic;
+  GstVideoInfo info;
+  GstCaps *caps;
+  GstBuffer *out;
+
+  caps = gst_caps_from_string (VIDEO_CAPS);
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_caps_unref (caps);
+
+  h = setup_dvdspu (FALSE, &subpic);
+
+  out = push_frame (h, &info, 0);
+  fail_unless (gst_buffer_get_video_overlay_composition_meta (out) == NULL);
+  check_luma (&info, out, TRUE);
+  gst_buffer_unref (out);
+
+  out = push_frame (h, &info, 40 * GST_MSECOND);
+  check_luma (&info, out, TRUE);
+  gst_buffer_unref (out);
+
+  /* past the STP_DSP command */
+  out = push_frame (h, &info, 2 * GST_SECOND);
+  check_luma (&info, out, FALSE);
+  gst_buffer_unref (out);
+
+  gst_harness_teardown (subpic);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_overlay_meta)
+{
+  GstVideoOverlayCompositionMeta *meta;
+  GstVideoOverlayComposition *comp;
+  GstVideoOverlayRectangle *rect;
+  GstHarness *h, *subpic;
+  GstVideoInfo info;
+  GstCaps *caps;
+  GstBuffer *out;
+  gint rx, ry;
+  guint rw, rh;
+
+  caps = gst_caps_from_string (VIDEO_CAPS);
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_caps_unref (caps);
+
+  h = setup_dvdspu (TRUE, &subpic);
+
+  /* the frame is left alone and carries the overlay instead */
+  out = push_frame (h, &info, 0);
+  check_luma (&info, out, FALSE);
+  meta = gst_buffer_get_video_overlay_composition_meta (out);
+  fail_unless (meta != NULL);
+  comp = gst_video_overlay_composition_ref (meta->overlay);
+  gst_buffer_unref (out);
+
+  fail_unless_equals_int (gst_video_overlay_composition_n_rectangles (comp), 1);
+  rect = gst_video_overlay_composition_get_rectangle (comp, 0);
+  fail_unless (gst_video_overlay_rectangle_get_render_rectangle (rect, &rx, &ry,
+          &rw, &rh));
+  fail_unless_equals_int (rx, DISP_LEFT);
+  fail_unless_equals_int (ry, DISP_TOP);
+  fail_unless_equals_int (rw, DISP_RIGHT - DISP_LEFT + 1);
+  fail_unless_equals_int (rh, N_LINES);
+
+  /* the display set is only rendered once */
+  out = push_frame (h, &info, 40 * GST_MSECOND);
+  meta = gst_buffer_get_video_overlay_composition_meta (out);
+  fail_unless (meta != NULL);
+  fail_unless (meta->overlay == comp);
+  gst_buffer_unref (out);
+  gst_video_overlay_composition_unref (comp);
+
+  out = push_frame (h, &info, 2 * GST_SECOND);
+  fail_unless (gst_buffer_get_video_overlay_composition_meta (out) == NULL);
+  gst_buffer_unref (out);
+
+  gst_harness_teardown (subpic);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static Suite *
+dvdspu_suite (void)
+{
+  Suite *s = suite_create ("dvdspu");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_blend);
+  tcase_add_test (tc_chain, test_overlay_meta);
+
+  return s;
+}
+
+GST_CHECK_MAIN (dvdspu);
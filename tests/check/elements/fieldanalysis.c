@@ -0,0 +1,212 @@
+/* GStreamer
+ *
+ * unit test for fieldanalysis
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define CAPS "video/x-raw,format=I420,width=320,height=240," \
+    "framerate=25/1,interlace-mode=progressive"
+
+#define N_FRAMES 12
+#define BAR_WIDTH 32
+
+#define FLAG_MASK (GST_VIDEO_BUFFER_FLAG_INTERLACED | \
+    GST_VIDEO_BUFFER_FLAG_TFF | GST_VIDEO_BUFFER_FLAG_RFF | \
+    GST_VIDEO_BUFFER_FLAG_ONEFIELD)
+
+/* position of the moving bar at field time @t */
+static gint
+bar_pos (gint t)
+{
+  return 16 + (12 * t) % 256;
+}
+
+/* a grey frame with a white vertical bar, which is at the position of field
+ * time @top on the even lines and @bottom on the odd ones */
+static GstBuffer *
+make_frame (GstVideoInfo * info, gint top, gint bottom)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, info->size, NULL);
+  GstVideoFrame frame;
+  gint i, y;
+
+  fail_unless (gst_video_frame_map (&frame, info, buf, GST_MAP_WRITE));
+  for (i = 1; i < GST_VIDEO_FRAME_N_PLANES (&frame); i++) {
+    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (&frame, i); y++)
+      memset ((guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&frame, i) +
+          y * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, i), 128,
+          GST_VIDEO_FRAME_COMP_WIDTH (&frame, i));
+  }
+  for (y = 0; y < GST_VIDEO_FRAME_HEIGHT (&frame); y++) {
+    guint8 *line = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&frame, 0) +
+        y * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0);
+
+    memset (line, 16, GST_VIDEO_FRAME_WIDTH (&frame));
+    memset (line + bar_pos ((y & 1) ? bottom : top), 235, BAR_WIDTH);
+  }
+  gst_video_frame_unmap (&frame);
+
+  return buf;
+}
+
+/* runs N_FRAMES frames of a moving bar through fieldanalysis configured by
+ * @props and returns the video flags of every output buffer */
+static GArray *
+analyse (const gchar * props, gboolean interlaced)
+{
+  GstHarness *h;
+  GstVideoInfo info;
+  GstCaps *caps;
+  GArray *flags;
+  gchar *launch;
+  gint i;
+
+  caps = gst_caps_from_string (CAPS);
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_caps_unref (caps);
+
+  launch = g_strdup_printf ("fieldanalysis %s", props);
+  h = gst_harness_new_parse (launch);
+  g_free (launch);
+  gst_harness_set_src_caps_str (h, CAPS);
+
+  for (i = 0; i < N_FRAMES; i++) {
+    GstBuffer *buf;
+
+    /* interlaced frames sample their two fields at different times */
+    if (interlaced)
+      buf = make_frame (&info, 2 * i, 2 * i + 1);
+    else
+      buf = make_frame (&info, 2 * i, 2 * i);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  fail_unless_equals_int (gst_harness_buffers_received (h), N_FRAMES);
+
+  flags = g_array_new (FALSE, FALSE, sizeof (guint));
+  for (i = 0; i < N_FRAMES; i++) {
+    GstBuffer *buf = gst_harness_pull (h);
+    guint f = GST_BUFFER_FLAGS (buf) & FLAG_MASK;
+
+    g_array_append_val (flags, f);
+    gst_buffer_unref (buf);
+  }
+  gst_harness_teardown (h);
+
+  return flags;
+}
+
+static void
+check_same_flags (GArray * a, GArray * b)
+{
+  guint i;
+
+  fail_unless_equals_int (a->len, b->len);
+  for (i = 0; i < a->len; i++)
+    fail_unless_equals_int (g_array_index (a, guint, i),
+        g_array_index (b, guint, i));
+}
+
+static void
+check_interlaced (GArray * flags, gboolean interlaced)
+{
+  guint i;
+
+  /* the first frame has no predecessor to be compared with */
+  for (i = 1; i < flags->len; i++)
+    fail_unless_equals_int (! !(g_array_index (flags, guint,
+                i) & GST_VIDEO_BUFFER_FLAG_INTERLACED), interlaced);
+}
+
+GST_START_TEST (test_row_decimation)
+{
+  gboolean interlaced;
+  GArray *ref, *flags;
+  guint row_decimation;
+
+  for (interlaced = FALSE; interlaced <= TRUE; interlaced++) {
+    ref = analyse ("row-decimation=1", interlaced);
+    check_interlaced (ref, interlaced);
+
+    /* the decimated scores are far from the thresholds for this content,
+     * so they have to lead to the same decisions */
+    for (row_decimation = 2; row_decimation <= 4; row_decimation *= 2) {
+      gchar *props = g_strdup_printf ("row-decimation=%u", row_decimation);
+
+      flags = analyse (props, interlaced);
+      check_same_flags (ref, flags);
+      g_array_unref (flags);
+      g_free (props);
+    }
+    g_array_unref (ref);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_windowed_comb_threads)
+{
+  gboolean interlaced;
+  GArray *ref, *flags;
+  guint n_threads;
+
+  for (interlaced = FALSE; interlaced <= TRUE; interlaced++) {
+    ref = analyse ("frame-metric=windowed-comb n-threads=1", interlaced);
+    check_interlaced (ref, interlaced);
+
+    /* 240 lines give 14 rows of blocks, 5 does not divide them evenly */
+    for (n_threads = 2; n_threads <= 5; n_threads++) {
+      gchar *props = g_strdup_printf ("frame-metric=windowed-comb "
+          "n-threads=%u row-decimation=2", n_threads);
+
+      flags = analyse (props, interlaced);
+      check_same_flags (ref, flags);
+      g_array_unref (flags);
+      g_free (props);
+    }
+    g_array_unref (ref);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+fieldanalysis_suite (void)
+{
+  Suite *s = suite_create ("fieldanalysis");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_row_decimation);
+  tcase_add_test (tc_chain, test_windowed_comb_threads);
+
+  return s;
+}
+
+GST_CHECK_MAIN (fieldanalysis);
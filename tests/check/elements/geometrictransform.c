@@ -0,0 +1,167 @@
+/* GStreamer
+ *
+ * unit test for the geometrictransform elements
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+
+#define WIDTH 64
+#define HEIGHT 48
+#define CAPS "video/x-raw,format=GRAY8,width=64,height=48,framerate=25/1"
+
+/* a diagonal gradient, so that moving any pixel changes the picture */
+static GstBuffer *
+make_frame (void)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, WIDTH * HEIGHT, NULL);
+  GstMapInfo map;
+  gint x, y;
+
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_WRITE));
+  for (y = 0; y < HEIGHT; y++)
+    for (x = 0; x < WIDTH; x++)
+      map.data[y * WIDTH + x] = 3 * x + 5 * y;
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static GstBuffer *
+transform (GstHarness * h)
+{
+  GstBuffer *out;
+
+  fail_unless_equals_int (gst_harness_push (h, make_frame ()), GST_FLOW_OK);
+  out = gst_harness_pull (h);
+  fail_unless (out != NULL);
+
+  return out;
+}
+
+static gboolean
+buffers_equal (GstBuffer * a, GstBuffer * b)
+{
+  GstMapInfo map_a, map_b;
+  gboolean ret;
+
+  fail_unless (gst_buffer_map (a, &map_a, GST_MAP_READ));
+  fail_unless (gst_buffer_map (b, &map_b, GST_MAP_READ));
+  ret = map_a.size == map_b.size
+      && memcmp (map_a.data, map_b.data, map_a.size) == 0;
+  gst_buffer_unmap (a, &map_a);
+  gst_buffer_unmap (b, &map_b);
+
+  return ret;
+}
+
+/* the output of a pinch element that had @intensity from the start */
+static GstBuffer *
+reference (gdouble intensity)
+{
+  GstHarness *h = gst_harness_new ("pinch");
+  GstBuffer *out;
+
+  g_object_set (h->element, "intensity", intensity, NULL);
+  gst_harness_set_src_caps_str (h, CAPS);
+  out = transform (h);
+  gst_harness_teardown (h);
+
+  return out;
+}
+
+static void
+check_property_change (gboolean async_remap)
+{
+  GstHarness *h = gst_harness_new ("pinch");
+  GstBuffer *before, *after, *expected;
+  gint i;
+
+  g_object_set (h->element, "intensity", 0.0, "async-remap", async_remap,
+      NULL);
+  gst_harness_set_src_caps_str (h, CAPS);
+
+  before = transform (h);
+  expected = reference (0.0);
+  fail_unless (buffers_equal (before, expected));
+  gst_buffer_unref (expected);
+
+  g_object_set (h->element, "intensity", 0.8, NULL);
+  expected = reference (0.8);
+  fail_if (buffers_equal (before, expected));
+
+  /* with async-remap the previous map stays in use until the new one has
+   * been generated in the background */
+  for (i = 0; i < 100; i++) {
+    after = transform (h);
+    if (!buffers_equal (after, before))
+      break;
+    fail_unless (async_remap);
+    gst_buffer_unref (after);
+    g_usleep (G_USEC_PER_SEC / 100);
+  }
+  fail_if (i == 100, "output did not change after the property change");
+  fail_unless (buffers_equal (after, expected));
+
+  /* and it must not go back to the old map */
+  gst_buffer_unref (after);
+  after = transform (h);
+  fail_unless (buffers_equal (after, expected));
+
+  gst_buffer_unref (before);
+  gst_buffer_unref (after);
+  gst_buffer_unref (expected);
+  gst_harness_teardown (h);
+}
+
+GST_START_TEST (test_property_change)
+{
+  check_property_change (FALSE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_property_change_async)
+{
+  check_property_change (TRUE);
+}
+
+GST_END_TEST;
+
+static Suite *
+geometrictransform_suite (void)
+{
+  Suite *s = suite_create ("geometrictransform");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_property_change);
+  tcase_add_test (tc_chain, test_property_change_async);
+
+  return s;
+}
+
+GST_CHECK_MAIN (geometrictransform);
@@ -0,0 +1,123 @@
+/* GStreamer
+ *
+ * unit test for gldownload
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define CAPS "video/x-raw,format=RGBA,width=64,height=48,framerate=25/1"
+#define FRAME_DURATION (GST_SECOND / 25)
+#define LATENCY 2
+#define N_FRAMES 6
+
+static GstBuffer *
+make_frame (GstVideoInfo * info, guint8 value, GstClockTime pts)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, info->size, NULL);
+
+  gst_buffer_memset (buf, 0, value, info->size);
+  GST_BUFFER_PTS (buf) = pts;
+  GST_BUFFER_DURATION (buf) = FRAME_DURATION;
+
+  return buf;
+}
+
+static void
+check_frame (GstVideoInfo * info, GstBuffer * buf, guint8 value)
+{
+  GstVideoFrame frame;
+  gint x, y;
+
+  fail_unless (gst_video_frame_map (&frame, info, buf, GST_MAP_READ));
+  for (y = 0; y < GST_VIDEO_FRAME_HEIGHT (&frame); y++) {
+    guint8 *line = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&frame, 0) +
+        y * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0);
+
+    for (x = 0; x < GST_VIDEO_FRAME_WIDTH (&frame) * 4; x++)
+      fail_unless_equals_int (line[x], value);
+  }
+  gst_video_frame_unmap (&frame);
+}
+
+GST_START_TEST (test_latency)
+{
+  GstVideoInfo info;
+  GstHarness *h;
+  GstBuffer *out;
+  GstCaps *caps;
+  gint i;
+
+  caps = gst_caps_from_string (CAPS);
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_caps_unref (caps);
+
+  h = gst_harness_new_parse ("glupload ! gldownload latency=" G_STRINGIFY
+      (LATENCY));
+  gst_harness_set_src_caps_str (h, CAPS);
+  /* ask for system memory, GL memory would just pass through */
+  gst_harness_set_sink_caps_str (h, CAPS);
+
+  /* every frame comes out LATENCY frames after it went in */
+  for (i = 0; i < N_FRAMES; i++) {
+    fail_unless_equals_int (gst_harness_push (h, make_frame (&info, 10 * i,
+                i * FRAME_DURATION)), GST_FLOW_OK);
+    fail_unless_equals_int (gst_harness_buffers_received (h),
+        MAX (i + 1 - LATENCY, 0));
+  }
+
+  gst_harness_set_upstream_latency (h, 0);
+  fail_unless_equals_uint64 (gst_harness_query_latency (h),
+      LATENCY * FRAME_DURATION);
+
+  /* and the remaining ones on EOS */
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  fail_unless_equals_int (gst_harness_buffers_received (h), N_FRAMES);
+
+  for (i = 0; i < N_FRAMES; i++) {
+    out = gst_harness_pull (h);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (out), i * FRAME_DURATION);
+    check_frame (&info, out, 10 * i);
+    gst_buffer_unref (out);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static Suite *
+gldownload_suite (void)
+{
+  Suite *s = suite_create ("gldownload");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_latency);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gldownload);
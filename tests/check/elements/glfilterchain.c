@@ -0,0 +1,245 @@
+/* GStreamer
+ *
+ * unit test for glfilterchain
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define CAPS "video/x-raw,format=RGBA,width=320,height=240,framerate=25/1"
+#define FRAME_DURATION (GST_SECOND / 25)
+#define N_FRAMES 10
+#define N_BENCHMARK_FRAMES 100
+
+/* *INDENT-OFF* */
+static const gchar *unfused =
+    "glupload ! gleffects effect=mirror ! gleffects effect=squeeze ! "
+    "gleffects effect=twirl ! gleffects effect=sin ! gldownload";
+static const gchar *fused =
+    "glupload ! glfilterchain effects=mirror,squeeze,twirl,sin ! gldownload";
+/* *INDENT-ON* */
+
+static GstBuffer *
+make_frame (GstVideoInfo * info, GstClockTime pts)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, info->size, NULL);
+  GstVideoFrame frame;
+  gint x, y;
+
+  /* a smooth gradient, so that resampling it more than once does not
+   * change it much */
+  fail_unless (gst_video_frame_map (&frame, info, buf, GST_MAP_WRITE));
+  for (y = 0; y < GST_VIDEO_FRAME_HEIGHT (&frame); y++) {
+    guint8 *line = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&frame, 0) +
+        y * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0);
+
+    for (x = 0; x < GST_VIDEO_FRAME_WIDTH (&frame); x++) {
+      line[4 * x + 0] = x * 255 / GST_VIDEO_FRAME_WIDTH (&frame);
+      line[4 * x + 1] = y * 255 / GST_VIDEO_FRAME_HEIGHT (&frame);
+      line[4 * x + 2] = 128;
+      line[4 * x + 3] = 255;
+    }
+  }
+  gst_video_frame_unmap (&frame);
+
+  GST_BUFFER_PTS (buf) = pts;
+  GST_BUFFER_DURATION (buf) = FRAME_DURATION;
+
+  return buf;
+}
+
+static GstHarness *
+setup_harness (const gchar * launch)
+{
+  GstHarness *h = gst_harness_new_parse (launch);
+
+  gst_harness_set_src_caps_str (h, CAPS);
+  gst_harness_set_sink_caps_str (h, CAPS);
+
+  return h;
+}
+
+static GstBuffer *
+process_frame (GstHarness * h, GstVideoInfo * info, GstClockTime pts)
+{
+  fail_unless_equals_int (gst_harness_push (h, make_frame (info, pts)),
+      GST_FLOW_OK);
+
+  return gst_harness_pull (h);
+}
+
+/* sum of the absolute differences of the bytes of @a and @b */
+static guint64
+buffers_diff (GstBuffer * a, GstBuffer * b)
+{
+  GstMapInfo map_a, map_b;
+  guint64 diff = 0;
+  gsize i;
+
+  fail_unless (gst_buffer_map (a, &map_a, GST_MAP_READ));
+  fail_unless (gst_buffer_map (b, &map_b, GST_MAP_READ));
+  fail_unless_equals_int (map_a.size, map_b.size);
+  for (i = 0; i < map_a.size; i++)
+    diff += ABS ((gint) map_a.data[i] - (gint) map_b.data[i]);
+  gst_buffer_unmap (a, &map_a);
+  gst_buffer_unmap (b, &map_b);
+
+  return diff;
+}
+
+GST_START_TEST (test_equivalence)
+{
+  GstVideoInfo info;
+  GstHarness *h1, *h2;
+  GstBuffer *out1, *out2;
+  GstCaps *caps;
+  guint64 diff;
+
+  caps = gst_caps_from_string (CAPS);
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_caps_unref (caps);
+
+  h1 = setup_harness (unfused);
+  h2 = setup_harness (fused);
+
+  out1 = process_frame (h1, &info, 0);
+  out2 = process_frame (h2, &info, 0);
+  diff = buffers_diff (out1, out2);
+
+  /* the unfused chain rounds to 8 bits and filters between the passes,
+   * so only expect the results to be close */
+  GST_INFO ("mean absolute difference %f", (gdouble) diff / info.size);
+  fail_unless (diff <= 2 * info.size);
+
+  gst_buffer_unref (out1);
+  gst_buffer_unref (out2);
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_stream)
+{
+  GstVideoInfo info;
+  GstHarness *h1, *h2;
+  GstBuffer *first, *out1, *out2;
+  GstCaps *caps;
+  gint i;
+
+  caps = gst_caps_from_string (CAPS);
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_caps_unref (caps);
+
+  h1 = setup_harness (unfused);
+  h2 = setup_harness (fused);
+
+  /* the shader is only generated for the first frame and the output
+   * textures are recycled, the same input must still give the same output
+   * and every frame keeps its timestamp */
+  first = process_frame (h2, &info, 0);
+  for (i = 1; i < N_FRAMES; i++) {
+    out2 = process_frame (h2, &info, i * FRAME_DURATION);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (out2), i * FRAME_DURATION);
+    fail_unless_equals_uint64 (buffers_diff (first, out2), 0);
+
+    out1 = process_frame (h1, &info, i * FRAME_DURATION);
+    fail_unless (buffers_diff (out1, out2) <= 2 * info.size);
+
+    gst_buffer_unref (out1);
+    gst_buffer_unref (out2);
+  }
+
+  gst_buffer_unref (first);
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h2);
+}
+
+GST_END_TEST;
+
+static gint64
+time_chain (const gchar * launch, GstVideoInfo * info)
+{
+  GstHarness *h = setup_harness (launch);
+  gint64 start;
+  gint i;
+
+  /* the first frame compiles the shaders */
+  gst_buffer_unref (process_frame (h, info, 0));
+
+  start = g_get_monotonic_time ();
+  for (i = 1; i <= N_BENCHMARK_FRAMES; i++)
+    gst_buffer_unref (process_frame (h, info, i * FRAME_DURATION));
+  start = g_get_monotonic_time () - start;
+
+  gst_harness_teardown (h);
+
+  return start;
+}
+
+/* only reports the frame times, e.g. with LIBGL_ALWAYS_SOFTWARE=1 */
+GST_START_TEST (test_benchmark)
+{
+  GstVideoInfo info;
+  GstCaps *caps;
+  gint64 unfused_time, fused_time;
+
+  caps = gst_caps_from_string (CAPS);
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_caps_unref (caps);
+
+  unfused_time = time_chain (unfused, &info);
+  fused_time = time_chain (fused, &info);
+
+  g_print ("glfilterchain, %d frames: unfused %" G_GINT64_FORMAT
+      " us/frame, fused %" G_GINT64_FORMAT " us/frame\n", N_BENCHMARK_FRAMES,
+      unfused_time / N_BENCHMARK_FRAMES, fused_time / N_BENCHMARK_FRAMES);
+}
+
+GST_END_TEST;
+
+static Suite *
+glfilterchain_suite (void)
+{
+  Suite *s = suite_create ("glfilterchain");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_equivalence);
+  tcase_add_test (tc_chain, test_stream);
+
+  /* timings only, not part of make check */
+  if (g_getenv ("GST_CHECK_BENCHMARKS")) {
+    TCase *tc_benchmark = tcase_create ("benchmark");
+
+    suite_add_tcase (s, tc_benchmark);
+    tcase_set_timeout (tc_benchmark, 0);
+    tcase_add_test (tc_benchmark, test_benchmark);
+  }
+
+  return s;
+}
+
+GST_CHECK_MAIN (glfilterchain);
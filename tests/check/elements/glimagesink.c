@@ -218,6 +218,120 @@ GST_START_TEST (test_query_drain)
 
 GST_END_TEST;
 
+/* Verify that repeated frames are not drawn again while the window
+ * has not changed. */
+GST_START_TEST (test_skip_unchanged)
+{
+  GstBuffer *buf = NULL, *dup = NULL;
+  GstBufferPool *pool = NULL;
+  GstCaps *caps = NULL;
+  GstQuery *query = NULL;
+  guint64 drawn = 0, skipped = 0;
+  const gint n_repeats = 10;
+  gint i;
+
+#ifdef __APPLE__
+  loop = g_main_loop_new (NULL, FALSE);
+#endif
+
+  g_object_set (sinkelement, "sync", FALSE, NULL);
+
+  ASSERT_SET_STATE (sinkelement, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  /* Use the gl pool so that the repeated frames share their textures */
+  caps = gst_pad_get_current_caps (srcpad);
+  query = gst_query_new_allocation (caps, TRUE);
+  DO_CALL (do_peer_query_func, query);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_query_get_n_allocation_pools (query) == 1);
+  gst_query_parse_nth_allocation_pool (query, 0, &pool, NULL, NULL, NULL);
+  fail_unless (pool != NULL);
+  gst_query_unref (query);
+
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf,
+          NULL) == GST_FLOW_OK);
+  GST_BUFFER_PTS (buf) = 0;
+  GST_BUFFER_DURATION (buf) = GST_SECOND / 30;
+
+  DO_CALL (do_push_func, gst_buffer_ref (buf));
+
+  /* the duplicates videorate would produce */
+  for (i = 1; i <= n_repeats; i++) {
+    dup = gst_buffer_copy (buf);
+    GST_BUFFER_FLAG_SET (dup, GST_BUFFER_FLAG_GAP);
+    GST_BUFFER_PTS (dup) = i * GST_BUFFER_DURATION (buf);
+    DO_CALL (do_push_func, dup);
+  }
+
+  g_object_get (sinkelement, "frames-drawn", &drawn, "frames-skipped",
+      &skipped, NULL);
+  GST_INFO ("drawn %" G_GUINT64_FORMAT " skipped %" G_GUINT64_FORMAT, drawn,
+      skipped);
+
+  /* the window may still be resized while it is shown, forcing redraws */
+  fail_unless (drawn >= 1);
+  fail_unless (skipped >= 1);
+  fail_unless (drawn < n_repeats);
+
+  cleanup_glimagesink ();
+
+  gst_buffer_unref (buf);
+  fail_unless (gst_buffer_pool_set_active (pool, FALSE));
+  gst_object_unref (pool);
+
+  if (loop)
+    g_main_loop_unref (loop);
+}
+
+GST_END_TEST;
+
+static gpointer
+push_thread_func (GstBuffer * buf)
+{
+  return GINT_TO_POINTER (gst_pad_push (srcpad, buf));
+}
+
+/* Verify that a flush does not have to wait for the next refresh when
+ * redraws are throttled. */
+GST_START_TEST (test_throttle_flush)
+{
+  GstBuffer *buf;
+  GThread *thread;
+  GstFlowReturn ret;
+  gint64 start;
+
+  /* one redraw every 30 seconds, much longer than the test timeout */
+  g_object_set (sinkelement, "sync", FALSE, NULL);
+  gst_util_set_object_arg (G_OBJECT (sinkelement), "refresh-rate", "1/30");
+
+  ASSERT_SET_STATE (sinkelement, GST_STATE_PLAYING, GST_STATE_CHANGE_ASYNC);
+
+  buf = gst_buffer_new_allocate (NULL, 320 * 240 * 4, NULL);
+  gst_buffer_memset (buf, 0, 0x00, 320 * 240 * 4);
+  GST_BUFFER_PTS (buf) = 0;
+  fail_unless_equals_int (gst_pad_push (srcpad, buf), GST_FLOW_OK);
+
+  /* the second frame waits for the refresh period to end */
+  buf = gst_buffer_new_allocate (NULL, 320 * 240 * 4, NULL);
+  gst_buffer_memset (buf, 0, 0xff, 320 * 240 * 4);
+  GST_BUFFER_PTS (buf) = GST_SECOND / 30;
+  start = g_get_monotonic_time ();
+  thread = g_thread_new ("push", (GThreadFunc) push_thread_func, buf);
+  g_usleep (G_USEC_PER_SEC / 10);
+
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_flush_start ()));
+  ret = GPOINTER_TO_INT (g_thread_join (thread));
+  fail_unless_equals_int (ret, GST_FLOW_FLUSHING);
+  fail_unless (g_get_monotonic_time () - start < 2 * G_USEC_PER_SEC);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_flush_stop (TRUE)));
+
+  cleanup_glimagesink ();
+}
+
+GST_END_TEST;
+
 static Suite *
 glimagesink_suite (void)
 {
@@ -228,6 +342,8 @@ glimagesink_suite (void)
 
   tcase_add_checked_fixture (tc, setup_glimagesink, NULL);
   tcase_add_test (tc, test_query_drain);
+  tcase_add_test (tc, test_skip_unchanged);
+  tcase_add_test (tc, test_throttle_flush);
   suite_add_tcase (s, tc);
 
   return s;
@@ -0,0 +1,231 @@
+/* GStreamer
+ *
+ * unit test for glvideomixer
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/video/video.h>
+
+#define IN_WIDTH 128
+#define IN_HEIGHT 96
+#define OUT_WIDTH 640
+#define OUT_HEIGHT 480
+#define N_BENCHMARK_FRAMES 100
+
+static const gchar *patterns[] = {
+  "smpte", "red", "green", "blue", "white", "checkers-1", "checkers-2",
+  "checkers-4", "checkers-8", "circular"
+};
+
+static GstElement *
+setup_pipeline (gboolean batch, guint n_inputs, guint n_frames)
+{
+  GstElement *pipeline, *mixer;
+  GString *launch;
+  guint i;
+
+  launch = g_string_new (NULL);
+  g_string_append_printf (launch, "glvideomixer name=m background=black "
+      "batch=%s ! video/x-raw(memory:GLMemory),width=%u,height=%u ! "
+      "gldownload ! video/x-raw,format=RGBA ! "
+      "fakesink name=s sync=false enable-last-sample=true",
+      batch ? "true" : "false", OUT_WIDTH, OUT_HEIGHT);
+  for (i = 0; i < n_inputs; i++)
+    g_string_append_printf (launch, " gltestsrc num-buffers=%u pattern=%s ! "
+        "video/x-raw(memory:GLMemory),format=RGBA,width=%u,height=%u,"
+        "framerate=25/1 ! m.", n_frames,
+        patterns[i % G_N_ELEMENTS (patterns)], IN_WIDTH, IN_HEIGHT);
+
+  pipeline = gst_parse_launch (launch->str, NULL);
+  fail_unless (pipeline != NULL);
+  g_string_free (launch, TRUE);
+
+  /* a slightly overlapping grid, with every other input translucent and
+   * the first one scaled up */
+  mixer = gst_bin_get_by_name (GST_BIN (pipeline), "m");
+  for (i = 0; i < n_inputs; i++) {
+    gchar *name = g_strdup_printf ("sink_%u", i);
+    GstPad *pad = gst_element_get_static_pad (mixer, name);
+
+    fail_unless (pad != NULL);
+    g_object_set (pad, "xpos", (gint) (i % 5) * (IN_WIDTH - 16),
+        "ypos", (gint) (i / 5) * (IN_HEIGHT - 16),
+        "alpha", i % 2 ? 0.5 : 1.0, NULL);
+    if (i == 0)
+      g_object_set (pad, "width", 2 * IN_WIDTH, "height", 2 * IN_HEIGHT, NULL);
+
+    gst_object_unref (pad);
+    g_free (name);
+  }
+  gst_object_unref (mixer);
+
+  return pipeline;
+}
+
+static void
+run_pipeline (GstElement * pipeline)
+{
+  GstBus *bus = gst_element_get_bus (pipeline);
+  GstMessage *msg;
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+}
+
+static GstSample *
+mix_last_frame (gboolean batch, guint n_inputs)
+{
+  GstElement *pipeline, *sink;
+  GstSample *sample = NULL;
+
+  pipeline = setup_pipeline (batch, n_inputs, 1);
+  run_pipeline (pipeline);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "s");
+  g_object_get (sink, "last-sample", &sample, NULL);
+  fail_unless (sample != NULL);
+  gst_object_unref (sink);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return sample;
+}
+
+/* checks that batching @n_inputs gives the same picture as drawing them one
+ * by one */
+static void
+check_batch_equivalence (guint n_inputs)
+{
+  GstSample *per_pad, *batched;
+  GstMapInfo map1, map2;
+  guint64 diff = 0;
+  gsize i;
+
+  per_pad = mix_last_frame (FALSE, n_inputs);
+  batched = mix_last_frame (TRUE, n_inputs);
+
+  fail_unless (gst_buffer_map (gst_sample_get_buffer (per_pad), &map1,
+          GST_MAP_READ));
+  fail_unless (gst_buffer_map (gst_sample_get_buffer (batched), &map2,
+          GST_MAP_READ));
+  fail_unless_equals_int (map1.size, map2.size);
+  for (i = 0; i < map1.size; i++)
+    diff += ABS ((gint) map1.data[i] - (gint) map2.data[i]);
+  gst_buffer_unmap (gst_sample_get_buffer (per_pad), &map1);
+  gst_buffer_unmap (gst_sample_get_buffer (batched), &map2);
+
+  /* both sample the same texels, only allow for rounding differences */
+  GST_INFO ("%u inputs, mean absolute difference %f", n_inputs,
+      (gdouble) diff / map1.size);
+  fail_unless (diff <= map1.size);
+
+  gst_sample_unref (per_pad);
+  gst_sample_unref (batched);
+}
+
+GST_START_TEST (test_batch_equivalence)
+{
+  check_batch_equivalence (12);
+}
+
+GST_END_TEST;
+
+/* the smallest batch, one opaque scaled input below a translucent one */
+GST_START_TEST (test_batch_two_inputs)
+{
+  check_batch_equivalence (2);
+}
+
+GST_END_TEST;
+
+static gint64
+time_mixer (gboolean batch, guint n_inputs)
+{
+  GstElement *pipeline = setup_pipeline (batch, n_inputs, N_BENCHMARK_FRAMES);
+  gint64 start;
+
+  start = g_get_monotonic_time ();
+  run_pipeline (pipeline);
+  start = g_get_monotonic_time () - start;
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return start;
+}
+
+/* only reports the frame times, which include the copy of every input into
+ * the texture array when batching */
+GST_START_TEST (test_benchmark)
+{
+  static const guint inputs[] = { 2, 5, 12, 25 };
+  gint64 per_pad_time, batched_time;
+  guint i, n_inputs;
+
+  for (i = 0; i < G_N_ELEMENTS (inputs); i++) {
+    n_inputs = inputs[i];
+    per_pad_time = time_mixer (FALSE, n_inputs);
+    batched_time = time_mixer (TRUE, n_inputs);
+
+    g_print ("glvideomixer, %u inputs, %d frames: per-pad %" G_GINT64_FORMAT
+        " us/frame, batched %" G_GINT64_FORMAT " us/frame\n", n_inputs,
+        N_BENCHMARK_FRAMES, per_pad_time / N_BENCHMARK_FRAMES,
+        batched_time / N_BENCHMARK_FRAMES);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+glvideomixer_suite (void)
+{
+  Suite *s = suite_create ("glvideomixer");
+  TCase *tc_chain = tcase_create ("general");
+
+  tcase_set_timeout (tc_chain, 60);
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_batch_equivalence);
+  tcase_add_test (tc_chain, test_batch_two_inputs);
+
+  /* timings only, not part of make check */
+  if (g_getenv ("GST_CHECK_BENCHMARKS")) {
+    TCase *tc_benchmark = tcase_create ("benchmark");
+
+    suite_add_tcase (s, tc_benchmark);
+    tcase_set_timeout (tc_benchmark, 0);
+    tcase_add_test (tc_benchmark, test_benchmark);
+  }
+
+  return s;
+}
+
+GST_CHECK_MAIN (glvideomixer);
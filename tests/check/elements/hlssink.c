@@ -0,0 +1,321 @@
+/* GStreamer
+ *
+ * unit test for hlssink
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib/gstdio.h>
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define PACKET_SIZE 188
+#define BUFFER_SIZE (7 * PACKET_SIZE)
+#define BUFFER_DURATION (100 * GST_MSECOND)
+/* a keyframe every 2 seconds, and a segment for each of them */
+#define GOP_LENGTH 20
+#define N_BUFFERS (3 * GOP_LENGTH)
+
+typedef struct
+{
+  guint n_parts;
+  gsize part_bytes;
+  guint n_segments;
+  gsize segment_bytes;
+  gchar *playlist;
+} SignalData;
+
+static void
+new_part_cb (GstElement * sink, const gchar * uri, GstBuffer * data,
+    SignalData * sd)
+{
+  gchar *expected = g_strdup_printf ("segment%05d.part%d.ts",
+      sd->n_parts / 4, sd->n_parts % 4);
+
+  fail_unless_equals_string (uri, expected);
+  g_free (expected);
+
+  sd->n_parts++;
+  sd->part_bytes += gst_buffer_get_size (data);
+}
+
+static void
+new_segment_cb (GstElement * sink, const gchar * uri, GstBuffer * data,
+    SignalData * sd)
+{
+  sd->n_segments++;
+  sd->segment_bytes += gst_buffer_get_size (data);
+}
+
+static void
+playlist_updated_cb (GstElement * sink, const gchar * playlist,
+    SignalData * sd)
+{
+  g_free (sd->playlist);
+  sd->playlist = g_strdup (playlist);
+}
+
+static guint
+count_matches (const gchar * playlist, const gchar * str)
+{
+  guint n = 0;
+
+  while ((playlist = strstr (playlist, str))) {
+    playlist += strlen (str);
+    n++;
+  }
+
+  return n;
+}
+
+static void
+remove_dir (const gchar * path)
+{
+  GDir *dir = g_dir_open (path, 0, NULL);
+  const gchar *name;
+
+  while ((name = g_dir_read_name (dir))) {
+    gchar *filename = g_build_filename (path, name, NULL);
+
+    g_remove (filename);
+    g_free (filename);
+  }
+  g_dir_close (dir);
+  g_rmdir (path);
+}
+
+/* checks that no part in @playlist is longer than its part target and
+ * returns the number of parts */
+static guint
+check_part_durations (const gchar * playlist)
+{
+  const gchar *p;
+  gdouble target;
+  guint n = 0;
+
+  p = strstr (playlist, "#EXT-X-PART-INF:PART-TARGET=");
+  fail_unless (p != NULL);
+  target = g_ascii_strtod (p + strlen ("#EXT-X-PART-INF:PART-TARGET="), NULL);
+
+  for (p = playlist; (p = strstr (p, "#EXT-X-PART:DURATION=")); n++) {
+    gdouble duration;
+
+    p += strlen ("#EXT-X-PART:DURATION=");
+    duration = g_ascii_strtod (p, NULL);
+    fail_unless (duration > 0 && duration <= target,
+        "part of %f s with a part target of %f s", duration, target);
+  }
+
+  return n;
+}
+
+GST_START_TEST (test_parts)
+{
+  GstElementFactory *factory;
+  SignalData sd = { 0, };
+  GstHarness *h;
+  GStatBuf st;
+  gchar *dir, *location, *part_location, *playlist_location, *filename;
+  const gchar *part, *segment;
+  gint i;
+
+  factory = gst_element_factory_find ("multifilesink");
+  if (factory == NULL) {
+    GST_INFO ("multifilesink not available, skipping");
+    return;
+  }
+  gst_object_unref (factory);
+
+  dir = g_dir_make_tmp ("hlssink-XXXXXX", NULL);
+  fail_unless (dir != NULL);
+  location = g_build_filename (dir, "segment%05d.ts", NULL);
+  part_location = g_build_filename (dir, "segment%05d.part%d.ts", NULL);
+  playlist_location = g_build_filename (dir, "playlist.m3u8", NULL);
+
+  h = gst_harness_new ("hlssink");
+  g_object_set (h->element, "location", location, "part-location",
+      part_location, "playlist-location", playlist_location,
+      "target-duration", 0, "part-duration", 500, "max-files", 0, NULL);
+  g_signal_connect (h->element, "new-part", G_CALLBACK (new_part_cb), &sd);
+  g_signal_connect (h->element, "new-segment", G_CALLBACK (new_segment_cb),
+      &sd);
+  g_signal_connect (h->element, "playlist-updated",
+      G_CALLBACK (playlist_updated_cb), &sd);
+  gst_harness_set_src_caps_str (h,
+      "video/mpegts,systemstream=true,packetsize=188");
+
+  for (i = 0; i < N_BUFFERS; i++) {
+    GstBuffer *buf = gst_buffer_new_allocate (NULL, BUFFER_SIZE, NULL);
+    GstClockTime ts = i * BUFFER_DURATION;
+
+    if (i % GOP_LENGTH == 0 && i > 0) {
+      fail_unless (gst_harness_push_event (h,
+              gst_video_event_new_downstream_force_key_unit (ts, ts, ts, TRUE,
+                  i / GOP_LENGTH)));
+    }
+
+    gst_buffer_memset (buf, 0, i, BUFFER_SIZE);
+    GST_BUFFER_PTS (buf) = ts;
+    GST_BUFFER_DURATION (buf) = BUFFER_DURATION;
+    if (i % GOP_LENGTH != 0)
+      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+
+  /* two complete segments of four 500 ms parts each, and three parts of
+   * the segment in progress */
+  fail_unless_equals_int (sd.n_parts, 11);
+  fail_unless_equals_int (sd.part_bytes, 11 * 5 * BUFFER_SIZE);
+  fail_unless_equals_int (sd.n_segments, 2);
+  fail_unless_equals_int (sd.segment_bytes, 2 * GOP_LENGTH * BUFFER_SIZE);
+
+  fail_unless (sd.playlist != NULL);
+  GST_DEBUG ("playlist:\n%s", sd.playlist);
+  /* parts need a newer protocol version than plain segments */
+  fail_unless_equals_int (count_matches (sd.playlist, "#EXT-X-VERSION:6\n"),
+      1);
+  fail_unless_equals_int (count_matches (sd.playlist,
+          "#EXT-X-PART-INF:PART-TARGET=0.5\n"), 1);
+  fail_unless_equals_int (count_matches (sd.playlist, "#EXT-X-PART:"), 11);
+  fail_unless_equals_int (check_part_durations (sd.playlist), 11);
+  fail_unless_equals_int (count_matches (sd.playlist, "#EXTINF:"), 2);
+  /* only the parts that start with a keyframe are independent */
+  fail_unless_equals_int (count_matches (sd.playlist, "INDEPENDENT=YES"), 3);
+  fail_unless_equals_int (count_matches (sd.playlist,
+          "#EXT-X-PART:DURATION=0.5,URI=\"segment00000.part0.ts\","
+          "INDEPENDENT=YES\n"), 1);
+  fail_unless_equals_int (count_matches (sd.playlist,
+          "#EXT-X-PART:DURATION=0.5,URI=\"segment00000.part1.ts\"\n"), 1);
+
+  /* the parts of a segment come before it */
+  part = strstr (sd.playlist, "segment00001.part3.ts");
+  segment = strstr (sd.playlist, "\nsegment00001.ts");
+  fail_unless (part != NULL && segment != NULL && part < segment);
+  fail_unless (strstr (sd.playlist, "segment00002.part2.ts") > segment);
+
+  /* the parts are on disk as well */
+  filename = g_strdup_printf (part_location, 2, 2);
+  fail_unless (g_stat (filename, &st) == 0);
+  fail_unless_equals_int (st.st_size, 5 * BUFFER_SIZE);
+  g_free (filename);
+
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  gst_harness_teardown (h);
+
+  g_free (sd.playlist);
+  g_free (location);
+  g_free (part_location);
+  g_free (playlist_location);
+  remove_dir (dir);
+  g_free (dir);
+}
+
+GST_END_TEST;
+
+/* 150 ms buffers do not divide the 500 ms part target, and every eighth one
+ * is a keyframe */
+GST_START_TEST (test_part_target)
+{
+  GstElementFactory *factory;
+  SignalData sd = { 0, };
+  GstHarness *h;
+  gchar *dir, *location, *part_location, *playlist_location;
+  gint i;
+
+  factory = gst_element_factory_find ("multifilesink");
+  if (factory == NULL) {
+    GST_INFO ("multifilesink not available, skipping");
+    return;
+  }
+  gst_object_unref (factory);
+
+  dir = g_dir_make_tmp ("hlssink-XXXXXX", NULL);
+  fail_unless (dir != NULL);
+  location = g_build_filename (dir, "segment%05d.ts", NULL);
+  part_location = g_build_filename (dir, "segment%05d.part%d.ts", NULL);
+  playlist_location = g_build_filename (dir, "playlist.m3u8", NULL);
+
+  h = gst_harness_new ("hlssink");
+  g_object_set (h->element, "location", location, "part-location",
+      part_location, "playlist-location", playlist_location,
+      "target-duration", 0, "part-duration", 500, "max-files", 0, NULL);
+  g_signal_connect (h->element, "playlist-updated",
+      G_CALLBACK (playlist_updated_cb), &sd);
+  gst_harness_set_src_caps_str (h,
+      "video/mpegts,systemstream=true,packetsize=188");
+
+  for (i = 0; i < 24; i++) {
+    GstBuffer *buf = gst_buffer_new_allocate (NULL, BUFFER_SIZE, NULL);
+
+    gst_buffer_memset (buf, 0, i, BUFFER_SIZE);
+    GST_BUFFER_PTS (buf) = i * 150 * GST_MSECOND;
+    GST_BUFFER_DURATION (buf) = 150 * GST_MSECOND;
+    if (i % 8 != 0)
+      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+
+  fail_unless (sd.playlist != NULL);
+  GST_DEBUG ("playlist:\n%s", sd.playlist);
+  fail_unless_equals_int (count_matches (sd.playlist,
+          "#EXT-X-PART-INF:PART-TARGET=0.5\n"), 1);
+
+  /* three buffers fit in a part, and a part in front of a keyframe ends
+   * after two so that every keyframe starts a part: 3 + 3 + 2 buffers per
+   * keyframe interval, with the last one still in progress */
+  fail_unless_equals_int (check_part_durations (sd.playlist), 8);
+  fail_unless_equals_int (count_matches (sd.playlist, "INDEPENDENT=YES"), 3);
+  fail_unless_equals_int (count_matches (sd.playlist,
+          "URI=\"segment00000.part3.ts\",INDEPENDENT=YES\n"), 1);
+  fail_unless_equals_int (count_matches (sd.playlist,
+          "URI=\"segment00000.part6.ts\",INDEPENDENT=YES\n"), 1);
+
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  gst_harness_teardown (h);
+
+  g_free (sd.playlist);
+  g_free (location);
+  g_free (part_location);
+  g_free (playlist_location);
+  remove_dir (dir);
+  g_free (dir);
+}
+
+GST_END_TEST;
+
+static Suite *
+hlssink_suite (void)
+{
+  Suite *s = suite_create ("hlssink");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_parts);
+  tcase_add_test (tc_chain, test_part_target);
+
+  return s;
+}
+
+GST_CHECK_MAIN (hlssink);
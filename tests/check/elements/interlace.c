@@ -0,0 +1,145 @@
+/* GStreamer
+ *
+ * unit test for interlace
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define CAPS "video/x-raw,format=I420_10LE,width=64,height=36," \
+    "framerate=24000/1001,interlace-mode=progressive"
+
+/* a frame with every sample of every line set to @value */
+static GstBuffer *
+make_frame (GstVideoInfo * info, guint16 value)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, info->size, NULL);
+  GstVideoFrame frame;
+  gint i, x, y;
+
+  fail_unless (gst_video_frame_map (&frame, info, buf, GST_MAP_WRITE));
+  for (i = 0; i < GST_VIDEO_FRAME_N_PLANES (&frame); i++) {
+    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (&frame, i); y++) {
+      guint8 *line = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&frame, i) +
+          y * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, i);
+
+      for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (&frame, i); x++)
+        GST_WRITE_UINT16_LE (line + 2 * x, value);
+    }
+  }
+  gst_video_frame_unmap (&frame);
+
+  return buf;
+}
+
+/* checks that the even lines of every plane are @even and the odd ones
+ * @odd */
+static void
+check_fields (GstVideoInfo * info, GstBuffer * buf, guint16 even, guint16 odd)
+{
+  GstVideoFrame frame;
+  gint i, x, y;
+
+  fail_unless (gst_video_frame_map (&frame, info, buf, GST_MAP_READ));
+  for (i = 0; i < GST_VIDEO_FRAME_N_PLANES (&frame); i++) {
+    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (&frame, i); y++) {
+      guint8 *line = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&frame, i) +
+          y * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, i);
+
+      for (x = 0; x < GST_VIDEO_FRAME_COMP_WIDTH (&frame, i); x++)
+        fail_unless_equals_int (GST_READ_UINT16_LE (line + 2 * x),
+            (y & 1) ? odd : even);
+    }
+  }
+  gst_video_frame_unmap (&frame);
+}
+
+GST_START_TEST (test_telecine_10bit)
+{
+  GstVideoInfo info;
+  GstBuffer *out;
+  GstCaps *caps;
+  guint n_threads;
+  gint i;
+
+  caps = gst_caps_from_string (CAPS);
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_caps_unref (caps);
+
+  for (n_threads = 1; n_threads <= 3; n_threads++) {
+    GstHarness *h = gst_harness_new ("interlace");
+
+    g_object_set (h->element, "top-field-first", TRUE, "n-threads",
+        n_threads, NULL);
+    gst_harness_set_src_caps_str (h, CAPS);
+
+    /* 2:3 turns frames A B C D into AA BB BC CD DD */
+    for (i = 0; i < 4; i++)
+      fail_unless_equals_int (gst_harness_push (h, make_frame (&info,
+                  100 * (i + 1))), GST_FLOW_OK);
+    fail_unless_equals_int (gst_harness_buffers_received (h), 5);
+
+    out = gst_harness_pull (h);
+    check_fields (&info, out, 100, 100);
+    gst_buffer_unref (out);
+
+    out = gst_harness_pull (h);
+    check_fields (&info, out, 200, 200);
+    gst_buffer_unref (out);
+
+    /* B was pushed as BB, so its remaining field is copied to a new
+     * buffer */
+    out = gst_harness_pull (h);
+    check_fields (&info, out, 200, 300);
+    gst_buffer_unref (out);
+
+    /* nothing else holds C, so D's field is written into it */
+    out = gst_harness_pull (h);
+    check_fields (&info, out, 300, 400);
+    gst_buffer_unref (out);
+
+    out = gst_harness_pull (h);
+    check_fields (&info, out, 400, 400);
+    gst_buffer_unref (out);
+
+    gst_harness_teardown (h);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+interlace_suite (void)
+{
+  Suite *s = suite_create ("interlace");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_telecine_10bit);
+
+  return s;
+}
+
+GST_CHECK_MAIN (interlace);
@@ -0,0 +1,317 @@
+/* GStreamer
+ *
+ * unit test for jp2kdecimator
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/base/gstbytewriter.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+
+typedef struct
+{
+  guint width, height;
+  guint n_components;
+  guint n_layers;
+  guint n_decompositions;
+  guint packet_size;
+  gboolean sop;
+} CodestreamInfo;
+
+static void
+put_plt_length (GstByteWriter * writer, guint32 len)
+{
+  gint shift;
+
+  for (shift = 28; shift > 0; shift -= 7) {
+    if (len >= (1U << shift))
+      gst_byte_writer_put_uint8 (writer, 0x80 | ((len >> shift) & 0x7f));
+  }
+  gst_byte_writer_put_uint8 (writer, len & 0x7f);
+}
+
+/* A single tile LRCP codestream with a PLT and packets filled with @fill.
+ * With @max_layers and @max_decomposition_levels the packets they remove
+ * are written like jp2kdecimator writes them */
+static GstBuffer *
+make_codestream (const CodestreamInfo * info, guint8 fill, gint max_layers,
+    gint max_decomposition_levels)
+{
+  GstByteWriter writer, tile;
+  guint n_resolutions = info->n_decompositions + 1;
+  guint n_packets = info->n_layers * n_resolutions * info->n_components;
+  guint32 *lengths = g_new (guint32, n_packets);
+  guint8 *body = g_malloc (info->packet_size);
+  guint plt_start, plt_end;
+  guint i;
+
+  memset (body, fill, info->packet_size);
+
+  for (i = 0; i < n_packets; i++) {
+    guint layer = i / (n_resolutions * info->n_components);
+    guint resolution = (i / info->n_components) % n_resolutions;
+    gboolean drop = (max_layers != 0 && layer >= max_layers) ||
+        (max_decomposition_levels != -1
+        && resolution > max_decomposition_levels);
+
+    lengths[i] = (drop ? 1 : info->packet_size) + (info->sop ? 6 : 0);
+  }
+
+  /* the tile part after the SOT marker segment */
+  gst_byte_writer_init (&tile);
+  gst_byte_writer_put_uint16_be (&tile, 0xff58);
+  plt_start = gst_byte_writer_get_pos (&tile);
+  gst_byte_writer_put_uint16_be (&tile, 0);
+  gst_byte_writer_put_uint8 (&tile, 0);
+  for (i = 0; i < n_packets; i++)
+    put_plt_length (&tile, lengths[i]);
+  plt_end = gst_byte_writer_get_pos (&tile);
+  gst_byte_writer_set_pos (&tile, plt_start);
+  gst_byte_writer_put_uint16_be (&tile, plt_end - plt_start);
+  gst_byte_writer_set_pos (&tile, plt_end);
+
+  gst_byte_writer_put_uint16_be (&tile, 0xff93);
+  for (i = 0; i < n_packets; i++) {
+    if (info->sop) {
+      gst_byte_writer_put_uint16_be (&tile, 0xff91);
+      gst_byte_writer_put_uint16_be (&tile, 4);
+      gst_byte_writer_put_uint16_be (&tile, i);
+    }
+    if (lengths[i] == 1 + (info->sop ? 6 : 0))
+      gst_byte_writer_put_uint8 (&tile, 0x00);
+    else
+      gst_byte_writer_put_data (&tile, body, info->packet_size);
+  }
+
+  gst_byte_writer_init (&writer);
+
+  /* SOC, SIZ */
+  gst_byte_writer_put_uint16_be (&writer, 0xff4f);
+  gst_byte_writer_put_uint16_be (&writer, 0xff51);
+  gst_byte_writer_put_uint16_be (&writer, 38 + 3 * info->n_components);
+  gst_byte_writer_put_uint16_be (&writer, 0);
+  gst_byte_writer_put_uint32_be (&writer, info->width);
+  gst_byte_writer_put_uint32_be (&writer, info->height);
+  gst_byte_writer_put_uint32_be (&writer, 0);
+  gst_byte_writer_put_uint32_be (&writer, 0);
+  gst_byte_writer_put_uint32_be (&writer, info->width);
+  gst_byte_writer_put_uint32_be (&writer, info->height);
+  gst_byte_writer_put_uint32_be (&writer, 0);
+  gst_byte_writer_put_uint32_be (&writer, 0);
+  gst_byte_writer_put_uint16_be (&writer, info->n_components);
+  for (i = 0; i < info->n_components; i++) {
+    gst_byte_writer_put_uint8 (&writer, 7);
+    gst_byte_writer_put_uint8 (&writer, 1);
+    gst_byte_writer_put_uint8 (&writer, 1);
+  }
+
+  /* COD, LRCP with default precincts and 64x64 code blocks */
+  gst_byte_writer_put_uint16_be (&writer, 0xff52);
+  gst_byte_writer_put_uint16_be (&writer, 12);
+  gst_byte_writer_put_uint8 (&writer, info->sop ? 0x02 : 0x00);
+  gst_byte_writer_put_uint8 (&writer, 0);
+  gst_byte_writer_put_uint16_be (&writer, info->n_layers);
+  gst_byte_writer_put_uint8 (&writer, 0);
+  gst_byte_writer_put_uint8 (&writer, info->n_decompositions);
+  gst_byte_writer_put_uint8 (&writer, 4);
+  gst_byte_writer_put_uint8 (&writer, 4);
+  gst_byte_writer_put_uint8 (&writer, 0);
+  gst_byte_writer_put_uint8 (&writer, 1);
+
+  /* QCD without quantization */
+  gst_byte_writer_put_uint16_be (&writer, 0xff5c);
+  gst_byte_writer_put_uint16_be (&writer, 3 + 3 * info->n_decompositions + 1);
+  gst_byte_writer_put_uint8 (&writer, 0x40);
+  for (i = 0; i < 3 * info->n_decompositions + 1; i++)
+    gst_byte_writer_put_uint8 (&writer, 0x48);
+
+  /* SOT and the tile part */
+  gst_byte_writer_put_uint16_be (&writer, 0xff90);
+  gst_byte_writer_put_uint16_be (&writer, 10);
+  gst_byte_writer_put_uint16_be (&writer, 0);
+  gst_byte_writer_put_uint32_be (&writer,
+      12 + gst_byte_writer_get_size (&tile));
+  gst_byte_writer_put_uint8 (&writer, 0);
+  gst_byte_writer_put_uint8 (&writer, 1);
+  gst_byte_writer_put_data (&writer, tile.parent.data,
+      gst_byte_writer_get_size (&tile));
+  gst_byte_writer_reset (&tile);
+
+  /* EOC */
+  gst_byte_writer_put_uint16_be (&writer, 0xffd9);
+
+  g_free (lengths);
+  g_free (body);
+
+  return gst_byte_writer_reset_and_get_buffer (&writer);
+}
+
+static void
+assert_buffers_equal (GstBuffer * a, GstBuffer * b)
+{
+  GstMapInfo map_a, map_b;
+
+  gst_buffer_map (a, &map_a, GST_MAP_READ);
+  gst_buffer_map (b, &map_b, GST_MAP_READ);
+  fail_unless_equals_int (map_a.size, map_b.size);
+  fail_unless (memcmp (map_a.data, map_b.data, map_a.size) == 0);
+  gst_buffer_unmap (a, &map_a);
+  gst_buffer_unmap (b, &map_b);
+}
+
+static GstHarness *
+setup_jp2kdecimator (gint max_layers, gint max_decomposition_levels,
+    guint n_threads)
+{
+  GstHarness *h = gst_harness_new ("jp2kdecimator");
+
+  g_object_set (h->element, "max-layers", max_layers,
+      "max-decomposition-levels", max_decomposition_levels, "n-threads",
+      n_threads, NULL);
+  gst_harness_set_src_caps_str (h, "image/x-jpc");
+
+  return h;
+}
+
+static const CodestreamInfo small = { 64, 48, 3, 4, 3, 100, FALSE };
+static const CodestreamInfo small_sop = { 64, 48, 3, 4, 3, 100, TRUE };
+
+GST_START_TEST (test_decimate)
+{
+  static const struct
+  {
+    gint max_layers;
+    gint max_decomposition_levels;
+  } settings[] = { {0, -1}, {2, -1}, {0, 1}, {1, 0}, {4, 3} };
+  const CodestreamInfo *infos[] = { &small, &small_sop };
+  GstHarness *h;
+  GstBuffer *out, *expected;
+  gint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (infos); i++) {
+    for (j = 0; j < G_N_ELEMENTS (settings); j++) {
+      h = setup_jp2kdecimator (settings[j].max_layers,
+          settings[j].max_decomposition_levels, 1);
+
+      fail_unless_equals_int (gst_harness_push (h,
+              make_codestream (infos[i], 0x11, 0, -1)), GST_FLOW_OK);
+      out = gst_harness_pull (h);
+      expected = make_codestream (infos[i], 0x11, settings[j].max_layers,
+          settings[j].max_decomposition_levels);
+      assert_buffers_equal (out, expected);
+      gst_buffer_unref (expected);
+      gst_buffer_unref (out);
+
+      gst_harness_teardown (h);
+    }
+  }
+}
+
+GST_END_TEST;
+
+#define N_FRAMES 20
+
+GST_START_TEST (test_threads)
+{
+  GstHarness *h = setup_jp2kdecimator (2, 1, 4);
+  GstBuffer *in, *out, *expected;
+  gint i;
+
+  for (i = 0; i < N_FRAMES; i++) {
+    in = make_codestream (&small_sop, i, 0, -1);
+    GST_BUFFER_PTS (in) = i * GST_SECOND;
+    fail_unless_equals_int (gst_harness_push (h, in), GST_FLOW_OK);
+  }
+
+  /* EOS pushes the frames still being decimated */
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  fail_unless_equals_int (gst_harness_buffers_received (h), N_FRAMES);
+
+  for (i = 0; i < N_FRAMES; i++) {
+    out = gst_harness_pull (h);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (out), i * GST_SECOND);
+    expected = make_codestream (&small_sop, i, 2, 1);
+    assert_buffers_equal (out, expected);
+    gst_buffer_unref (expected);
+    gst_buffer_unref (out);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+#define BENCH_FRAMES 30
+
+GST_START_TEST (test_benchmark)
+{
+  /* a 4K frame with 8 layers and 5 decomposition levels, about 1 MB */
+  static const CodestreamInfo info = { 4096, 2160, 3, 8, 5, 8000, TRUE };
+  static const guint threads[] = { 1, 4 };
+  GstBuffer *frame = make_codestream (&info, 0x22, 0, -1);
+  gint t, n;
+
+  for (t = 0; t < G_N_ELEMENTS (threads); t++) {
+    GstHarness *h = setup_jp2kdecimator (4, 3, threads[t]);
+    gint64 start, elapsed;
+    GstBuffer *out;
+
+    start = g_get_monotonic_time ();
+    for (n = 0; n < BENCH_FRAMES; n++) {
+      fail_unless_equals_int (gst_harness_push (h, gst_buffer_ref (frame)),
+          GST_FLOW_OK);
+      while ((out = gst_harness_try_pull (h)))
+        gst_buffer_unref (out);
+    }
+    fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+    elapsed = MAX (g_get_monotonic_time () - start, 1);
+
+    fail_unless_equals_int (gst_harness_buffers_received (h), BENCH_FRAMES);
+    GST_INFO ("%u threads: %.1f frames/s", threads[t],
+        (gdouble) BENCH_FRAMES * G_USEC_PER_SEC / elapsed);
+
+    gst_harness_teardown (h);
+  }
+
+  gst_buffer_unref (frame);
+}
+
+GST_END_TEST;
+
+static Suite *
+jp2kdecimator_suite (void)
+{
+  Suite *s = suite_create ("jp2kdecimator");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_decimate);
+  tcase_add_test (tc_chain, test_threads);
+  tcase_add_test (tc_chain, test_benchmark);
+
+  return s;
+}
+
+GST_CHECK_MAIN (jp2kdecimator);
@@ -0,0 +1,358 @@
+/* GStreamer
+ *
+ * unit test for mpegpsdemux
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+
+/* every pack holds one video PES packet whose PTS is the SCR of the pack */
+#define N_PACKS 250
+#define PACK_SIZE 2048
+#define PACK_HEADER_SIZE 14
+#define PES_HEADER_SIZE 14
+#define SWITCH_PACK 100
+
+/* 40 ms and 80 ms in 90 kHz ticks */
+#define STEP_40MS 3600
+#define STEP_80MS 7200
+
+#define TICKS_TO_TIME(t) gst_util_uint64_scale ((t), GST_SECOND, 90000)
+
+static void
+write_pack_header (guint8 * data, guint64 scr, guint mux_rate)
+{
+  GST_WRITE_UINT32_BE (data, 0x000001ba);
+  /* '01' ! scr:3 ! 1 ! scr:15 ! 1 ! scr:15 ! 1 ! scr_ext:9 ! 1 */
+  data[4] = 0x44 | ((scr >> 27) & 0x38) | ((scr >> 28) & 0x03);
+  data[5] = (scr >> 20) & 0xff;
+  data[6] = ((scr >> 12) & 0xf8) | 0x04 | ((scr >> 13) & 0x03);
+  data[7] = (scr >> 5) & 0xff;
+  data[8] = ((scr << 3) & 0xf8) | 0x04;
+  data[9] = 0x01;
+  /* mux_rate:22 ! '11' ! reserved:5 ! stuffing_length:3 */
+  data[10] = (mux_rate >> 14) & 0xff;
+  data[11] = (mux_rate >> 6) & 0xff;
+  data[12] = ((mux_rate << 2) & 0xfc) | 0x03;
+  data[13] = 0xf8;
+}
+
+static void
+write_pes_header (guint8 * data, guint64 pts, guint length)
+{
+  GST_WRITE_UINT32_BE (data, 0x000001e0);
+  GST_WRITE_UINT16_BE (data + 4, length - 6);
+  data[6] = 0x80;
+  data[7] = 0x80;
+  data[8] = 5;
+  data[9] = 0x21 | ((pts >> 29) & 0x0e);
+  data[10] = (pts >> 22) & 0xff;
+  data[11] = ((pts >> 14) & 0xfe) | 0x01;
+  data[12] = (pts >> 7) & 0xff;
+  data[13] = ((pts << 1) & 0xfe) | 0x01;
+}
+
+/* SCR of pack @i, the packs are @step ticks apart up to SWITCH_PACK and
+ * @step_after ticks apart from there on */
+static guint64
+pack_scr (guint i, guint step, guint step_after)
+{
+  if (i <= SWITCH_PACK)
+    return (guint64) i * step;
+  return (guint64) SWITCH_PACK * step +
+      (guint64) (i - SWITCH_PACK) * step_after;
+}
+
+static GstClockTime
+stream_duration (guint step, guint step_after)
+{
+  return TICKS_TO_TIME (pack_scr (N_PACKS - 1, step, step_after));
+}
+
+/* writes a program stream to a temporary file and returns its name, all
+ * streams have the same size */
+static gchar *
+make_ps_file (guint step, guint step_after, guint8 fill)
+{
+  guint8 *data = g_malloc (N_PACKS * PACK_SIZE);
+  gchar *location;
+  guint i;
+  gint fd;
+
+  for (i = 0; i < N_PACKS; i++) {
+    guint8 *pack = data + i * PACK_SIZE;
+    guint64 scr = pack_scr (i, step, step_after);
+    guint step_i = i < SWITCH_PACK ? step : step_after;
+
+    write_pack_header (pack, scr, PACK_SIZE * 90000 / step_i / 50);
+    write_pes_header (pack + PACK_HEADER_SIZE, scr,
+        PACK_SIZE - PACK_HEADER_SIZE);
+    memset (pack + PACK_HEADER_SIZE + PES_HEADER_SIZE, fill,
+        PACK_SIZE - PACK_HEADER_SIZE - PES_HEADER_SIZE);
+  }
+
+  fd = g_file_open_tmp ("mpegpsdemux-XXXXXX.mpg", &location, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  fail_unless (g_file_set_contents (location, (const gchar *) data,
+          N_PACKS * PACK_SIZE, NULL));
+  g_free (data);
+
+  return location;
+}
+
+static GMutex probe_lock;
+static gboolean seeking = FALSE;
+static gboolean flushed = FALSE;
+static GstClockTime first_pts = GST_CLOCK_TIME_NONE;
+
+/* records the timestamp of the first buffer after a flushing seek */
+static GstPadProbeReturn
+demux_src_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  g_mutex_lock (&probe_lock);
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+
+    if (seeking && flushed && first_pts == GST_CLOCK_TIME_NONE)
+      first_pts = GST_BUFFER_PTS (buffer);
+  } else if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) ==
+      GST_EVENT_FLUSH_STOP) {
+    flushed = TRUE;
+  }
+  g_mutex_unlock (&probe_lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+pad_added (GstElement * demux, GstPad * pad, GstElement * pipeline)
+{
+  GstElement *sink = gst_element_factory_make ("fakesink", NULL);
+  GstPad *sinkpad;
+
+  g_object_set (sink, "sync", FALSE, NULL);
+  gst_bin_add (GST_BIN (pipeline), sink);
+  gst_element_sync_state_with_parent (sink);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  fail_unless_equals_int (gst_pad_link (pad, sinkpad), GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_EVENT_FLUSH, demux_src_probe, NULL, NULL);
+}
+
+/* prerolls mpegpsdemux on @location, in pull mode or behind a queue */
+static GstElement *
+start_pipeline (const gchar * location, gboolean pull,
+    const gchar * index_location)
+{
+  GstElement *pipeline, *src, *demux;
+
+  pipeline = gst_parse_launch (pull ? "filesrc name=src ! mpegpsdemux name=d"
+      : "filesrc name=src ! queue ! mpegpsdemux name=d", NULL);
+  fail_unless (pipeline != NULL);
+
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  g_object_set (src, "location", location, NULL);
+  gst_object_unref (src);
+
+  demux = gst_bin_get_by_name (GST_BIN (pipeline), "d");
+  if (index_location)
+    g_object_set (demux, "index-location", index_location, NULL);
+  g_signal_connect (demux, "pad-added", G_CALLBACK (pad_added), pipeline);
+  gst_object_unref (demux);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PAUSED) != GST_STATE_CHANGE_FAILURE);
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE), GST_STATE_CHANGE_SUCCESS);
+
+  return pipeline;
+}
+
+static void
+stop_pipeline (GstElement * pipeline)
+{
+  /* going to READY saves the index */
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+static void
+check_seek (GstElement * pipeline, GstClockTime position,
+    GstClockTime tolerance)
+{
+  GstClockTime pts;
+
+  g_mutex_lock (&probe_lock);
+  seeking = TRUE;
+  flushed = FALSE;
+  first_pts = GST_CLOCK_TIME_NONE;
+  g_mutex_unlock (&probe_lock);
+
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH, position));
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE), GST_STATE_CHANGE_SUCCESS);
+
+  g_mutex_lock (&probe_lock);
+  seeking = FALSE;
+  pts = first_pts;
+  g_mutex_unlock (&probe_lock);
+
+  GST_INFO ("seek to %" GST_TIME_FORMAT " started at %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (position), GST_TIME_ARGS (pts));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (pts));
+  fail_unless (pts + tolerance >= position && pts <= position + tolerance);
+}
+
+static void
+check_duration (GstElement * pipeline, GstClockTime expected)
+{
+  gint64 duration;
+
+  fail_unless (gst_element_query_duration (pipeline, GST_FORMAT_TIME,
+          &duration));
+  fail_unless_equals_uint64 (duration, expected);
+}
+
+GST_START_TEST (test_seek_pull)
+{
+  gchar *location = make_ps_file (STEP_40MS, STEP_40MS, 0);
+  GstElement *pipeline = start_pipeline (location, TRUE, NULL);
+
+  check_duration (pipeline, stream_duration (STEP_40MS, STEP_40MS));
+
+  /* the bisection lands on the pack of the position, repeated and backward
+   * seeks start from the packs it indexed */
+  check_seek (pipeline, 5 * GST_SECOND, 40 * GST_MSECOND);
+  check_seek (pipeline, 5 * GST_SECOND, 40 * GST_MSECOND);
+  check_seek (pipeline, 2 * GST_SECOND, 40 * GST_MSECOND);
+  check_seek (pipeline, 8 * GST_SECOND, 40 * GST_MSECOND);
+
+  stop_pipeline (pipeline);
+  g_unlink (location);
+  g_free (location);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_seek_push)
+{
+  gchar *location = make_ps_file (STEP_40MS, STEP_40MS, 0);
+  GstElement *pipeline = start_pipeline (location, FALSE, NULL);
+
+  /* upstream seeks to a byte offset interpolated from the SCR rate and the
+   * demuxer resyncs on the next pack */
+  check_seek (pipeline, 5 * GST_SECOND, 200 * GST_MSECOND);
+  check_seek (pipeline, 2 * GST_SECOND, 200 * GST_MSECOND);
+
+  stop_pipeline (pipeline);
+  g_unlink (location);
+  g_free (location);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_index_file)
+{
+  gchar *a, *b, *c, *index, *contents;
+  GstElement *pipeline;
+  gsize size;
+  gint fd;
+
+  /* b only differs in the payload, c only after the first block */
+  a = make_ps_file (STEP_40MS, STEP_40MS, 0);
+  b = make_ps_file (STEP_40MS, STEP_40MS, 0x55);
+  c = make_ps_file (STEP_40MS, STEP_80MS, 0);
+
+  fd = g_file_open_tmp ("mpegpsdemux-XXXXXX.idx", &index, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  g_unlink (index);
+
+  /* the index is written when closing */
+  pipeline = start_pipeline (a, TRUE, index);
+  check_duration (pipeline, stream_duration (STEP_40MS, STEP_40MS));
+  check_seek (pipeline, 5 * GST_SECOND, 40 * GST_MSECOND);
+  stop_pipeline (pipeline);
+  fail_unless (g_file_get_contents (index, &contents, &size, NULL));
+  /* a header of 112 bytes and some entries */
+  fail_unless (size > 112);
+
+  /* claim a last PTS 30 seconds in to see when the index file is used */
+  GST_WRITE_UINT64_LE (contents + 72, GST_READ_UINT64_LE (contents + 64) +
+      30 * 90000);
+  fail_unless (g_file_set_contents (index, contents, size, NULL));
+
+  pipeline = start_pipeline (a, TRUE, index);
+  check_duration (pipeline, 30 * GST_SECOND);
+  check_seek (pipeline, 5 * GST_SECOND, 40 * GST_MSECOND);
+  stop_pipeline (pipeline);
+
+  /* a file of the same size with different content */
+  fail_unless (g_file_set_contents (index, contents, size, NULL));
+  pipeline = start_pipeline (b, TRUE, index);
+  check_duration (pipeline, stream_duration (STEP_40MS, STEP_40MS));
+  stop_pipeline (pipeline);
+
+  /* the same start, but the indexed packs have other SCRs */
+  fail_unless (g_file_set_contents (index, contents, size, NULL));
+  pipeline = start_pipeline (c, TRUE, index);
+  check_duration (pipeline, stream_duration (STEP_40MS, STEP_80MS));
+  check_seek (pipeline, 10 * GST_SECOND, 80 * GST_MSECOND);
+  stop_pipeline (pipeline);
+
+  g_free (contents);
+  g_unlink (index);
+  g_unlink (a);
+  g_unlink (b);
+  g_unlink (c);
+  g_free (index);
+  g_free (a);
+  g_free (b);
+  g_free (c);
+}
+
+GST_END_TEST;
+
+static Suite *
+mpegpsdemux_suite (void)
+{
+  Suite *s = suite_create ("mpegpsdemux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_seek_pull);
+  tcase_add_test (tc_chain, test_seek_push);
+  tcase_add_test (tc_chain, test_index_file);
+
+  return s;
+}
+
+GST_CHECK_MAIN (mpegpsdemux);
@@ -130,15 +130,28 @@ _create_src_pad_push (void)
   return mysrcpad;
 }
 
+static guint n_getrange = 0;
+static gboolean src_short_reads = FALSE;
+static const guint8 *src_data = mxf_file;
+static gsize src_size = sizeof (mxf_file);
+
 static GstFlowReturn
 _src_getrange (GstPad * pad, GstObject * parent, guint64 offset, guint length,
     GstBuffer ** buffer)
 {
-  if (offset + length > sizeof (mxf_file))
+  n_getrange++;
+
+  if (src_short_reads) {
+    /* short reads at the end, like filesrc */
+    if (offset >= src_size)
+      return GST_FLOW_EOS;
+    length = MIN (length, src_size - offset);
+  } else if (offset + length > src_size) {
     return GST_FLOW_EOS;
+  }
 
   *buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
-      (guint8 *) (mxf_file + offset), length, 0, length, NULL, NULL);
+      (guint8 *) (src_data + offset), length, 0, length, NULL, NULL);
 
   return GST_FLOW_OK;
 }
@@ -156,7 +169,7 @@ _src_query (GstPad * pad, GstObject * parent, GstQuery * query)
       if (fmt != GST_FORMAT_BYTES)
         break;
 
-      gst_query_set_duration (query, fmt, sizeof (mxf_file));
+      gst_query_set_duration (query, fmt, src_size);
       res = TRUE;
       break;
     }
@@ -232,6 +245,90 @@ GST_START_TEST (test_pull)
 
 GST_END_TEST;
 
+/* returns the read-ahead cache hits */
+static guint64
+run_pull (guint read_ahead_size)
+{
+  GstStateChangeReturn sret;
+  GstElement *mxfdemux;
+  GstPad *sinkpad;
+  GstStructure *stats;
+  guint64 hits = 0;
+
+  have_eos = FALSE;
+  have_data = FALSE;
+  n_getrange = 0;
+  loop = g_main_loop_new (NULL, FALSE);
+
+  mxfdemux = gst_element_factory_make ("mxfdemux", NULL);
+  fail_unless (mxfdemux != NULL);
+  g_object_set (mxfdemux, "read-ahead-size", read_ahead_size, NULL);
+  g_signal_connect (mxfdemux, "pad-added", G_CALLBACK (_pad_added), NULL);
+  sinkpad = gst_element_get_static_pad (mxfdemux, "sink");
+  fail_unless (sinkpad != NULL);
+
+  mysinkpad = _create_sink_pad ();
+  fail_unless (mysinkpad != NULL);
+  mysrcpad = _create_src_pad_pull ();
+  fail_unless (mysrcpad != NULL);
+
+  fail_unless (gst_pad_link (mysrcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+
+  gst_pad_set_active (mysinkpad, TRUE);
+  gst_pad_set_active (mysrcpad, TRUE);
+
+  GST_INFO ("Setting to PLAYING");
+  sret = gst_element_set_state (mxfdemux, GST_STATE_PLAYING);
+  fail_unless_equals_int (sret, GST_STATE_CHANGE_SUCCESS);
+
+  g_main_loop_run (loop);
+  fail_unless (have_eos == TRUE);
+  fail_unless (have_data == TRUE);
+
+  g_object_get (mxfdemux, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "read-ahead-hits", &hits));
+  gst_structure_free (stats);
+
+  gst_element_set_state (mxfdemux, GST_STATE_NULL);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_pad_set_active (mysrcpad, FALSE);
+
+  gst_object_unref (mxfdemux);
+  gst_object_unref (mysinkpad);
+  gst_object_unref (mysrcpad);
+  g_main_loop_unref (loop);
+  loop = NULL;
+
+  return hits;
+}
+
+
+GST_START_TEST (test_pull_read_ahead)
+{
+  guint uncached;
+  guint64 hits;
+
+  /* a block reaching past the end of the file is a short read */
+  src_short_reads = TRUE;
+
+  run_pull (0);
+  uncached = n_getrange;
+
+  /* the whole file fits into one block */
+  hits = run_pull (64 * 1024);
+  fail_unless (hits > 0);
+  fail_unless (n_getrange < uncached);
+
+  /* blocks smaller than most packets */
+  run_pull (32);
+  fail_unless (n_getrange <= uncached);
+
+  src_short_reads = FALSE;
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_push)
 {
   GstElement *mxfdemux;
@@ -287,6 +384,280 @@ GST_START_TEST (test_push)
 
 GST_END_TEST;
 
+/* mxf_file with N_EDIT_UNITS essence elements instead of one, indexed by
+ * two segments in the footer partition that only flag the first edit unit
+ * of each segment as random access point */
+#define N_EDIT_UNITS 6
+#define INDEX_SPLIT 3
+#define EDIT_UNIT_DURATION (200 * GST_MSECOND)
+#define ESSENCE_OFFSET 0x4e1b
+#define ELEMENT_SIZE 36
+#define FOOTER_OFFSET 0x4e3f
+#define FOOTER_PACK_SIZE 140
+#define RIP_OFFSET 0x4f2f
+
+static const guint8 index_segment_key[] = {
+  0x06, 0x0e, 0x2b, 0x34, 0x02, 0x53, 0x01, 0x01,
+  0x0d, 0x01, 0x02, 0x01, 0x01, 0x10, 0x01, 0x00
+};
+
+static void
+append_local_tag (GByteArray * set, guint16 tag, const guint8 * data,
+    guint16 size)
+{
+  guint8 header[4];
+
+  GST_WRITE_UINT16_BE (header, tag);
+  GST_WRITE_UINT16_BE (header + 2, size);
+  g_byte_array_append (set, header, 4);
+  g_byte_array_append (set, data, size);
+}
+
+static void
+append_index_segment (GByteArray * file, guint start, guint duration)
+{
+  GByteArray *set = g_byte_array_new ();
+  guint8 entries[8 + N_EDIT_UNITS * 11];
+  guint8 b[16];
+  guint i;
+
+  memset (b, 0, sizeof (b));
+  b[15] = start + 1;
+  append_local_tag (set, 0x3c0a, b, 16);
+  GST_WRITE_UINT32_BE (b, 5);
+  GST_WRITE_UINT32_BE (b + 4, 1);
+  append_local_tag (set, 0x3f0b, b, 8);
+  GST_WRITE_UINT64_BE (b, start);
+  append_local_tag (set, 0x3f0c, b, 8);
+  GST_WRITE_UINT64_BE (b, duration);
+  append_local_tag (set, 0x3f0d, b, 8);
+  /* variable edit unit size, index SID 0x81 for body SID 1 */
+  GST_WRITE_UINT32_BE (b, 0);
+  append_local_tag (set, 0x3f05, b, 4);
+  GST_WRITE_UINT32_BE (b, 0x81);
+  append_local_tag (set, 0x3f06, b, 4);
+  GST_WRITE_UINT32_BE (b, 1);
+  append_local_tag (set, 0x3f07, b, 4);
+  b[0] = 0;
+  append_local_tag (set, 0x3f08, b, 1);
+
+  GST_WRITE_UINT32_BE (entries, duration);
+  GST_WRITE_UINT32_BE (entries + 4, 11);
+  for (i = 0; i < duration; i++) {
+    guint8 *e = entries + 8 + i * 11;
+
+    /* temporal offset, key frame offset, flags and stream offset */
+    e[0] = 0;
+    e[1] = 0;
+    e[2] = i == 0 ? 0x80 : 0x00;
+    GST_WRITE_UINT64_BE (e + 3, (guint64) (start + i) * ELEMENT_SIZE);
+  }
+  append_local_tag (set, 0x3f0a, entries, 8 + duration * 11);
+
+  g_byte_array_append (file, index_segment_key, sizeof (index_segment_key));
+  b[0] = 0x83;
+  GST_WRITE_UINT24_BE (b + 1, set->len);
+  g_byte_array_append (file, b, 4);
+  g_byte_array_append (file, set->data, set->len);
+  g_byte_array_free (set, TRUE);
+}
+
+static guint8 *
+make_indexed_file (gsize * size)
+{
+  GByteArray *file = g_byte_array_new ();
+  guint64 footer = ESSENCE_OFFSET + N_EDIT_UNITS * ELEMENT_SIZE;
+  guint64 index_byte_count;
+  guint8 *rip;
+  guint i, j;
+
+  g_byte_array_append (file, mxf_file, ESSENCE_OFFSET);
+
+  /* the tracks and the descriptor are one edit unit long */
+  for (i = 0x8c; i + 12 <= ESSENCE_OFFSET; i++) {
+    guint16 tag = GST_READ_UINT16_BE (file->data + i);
+
+    if ((tag == 0x0202 || tag == 0x3002)
+        && GST_READ_UINT16_BE (file->data + i + 2) == 8
+        && GST_READ_UINT64_BE (file->data + i + 4) == 1)
+      GST_WRITE_UINT64_BE (file->data + i + 4, N_EDIT_UNITS);
+  }
+
+  for (i = 0; i < N_EDIT_UNITS; i++) {
+    guint8 data[ELEMENT_SIZE - 20];
+
+    for (j = 0; j < sizeof (data); j++)
+      data[j] = i * sizeof (data) + j;
+    g_byte_array_append (file, mxf_file + ESSENCE_OFFSET, 20);
+    g_byte_array_append (file, data, sizeof (data));
+  }
+
+  g_byte_array_append (file, mxf_file + FOOTER_OFFSET, FOOTER_PACK_SIZE);
+  append_index_segment (file, 0, INDEX_SPLIT);
+  append_index_segment (file, INDEX_SPLIT, N_EDIT_UNITS - INDEX_SPLIT);
+  index_byte_count = file->len - footer - FOOTER_PACK_SIZE;
+  g_byte_array_append (file, mxf_file + RIP_OFFSET,
+      sizeof (mxf_file) - RIP_OFFSET);
+
+  /* move the footer partition in the partition packs and the RIP */
+  GST_WRITE_UINT64_BE (file->data + 20 + 24, footer);
+  GST_WRITE_UINT64_BE (file->data + footer + 20 + 8, footer);
+  GST_WRITE_UINT64_BE (file->data + footer + 20 + 24, footer);
+  GST_WRITE_UINT64_BE (file->data + footer + 20 + 40, index_byte_count);
+  rip = file->data + footer + FOOTER_PACK_SIZE + index_byte_count;
+  GST_WRITE_UINT64_BE (rip + 20 + 12 + 4, footer);
+
+  *size = file->len;
+  return g_byte_array_free (file, FALSE);
+}
+
+static GMutex seek_lock;
+static GCond seek_cond;
+static GstBuffer *seek_buffer = NULL;
+static gboolean seek_flushing = FALSE;
+static gboolean seek_done = FALSE;
+
+/* Hands every buffer to the test and blocks until the test took it, so that
+ * the seeks happen at a known position */
+static GstFlowReturn
+_seek_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  g_mutex_lock (&seek_lock);
+  if (seek_done) {
+    gst_buffer_unref (buffer);
+  } else {
+    seek_buffer = buffer;
+    g_cond_broadcast (&seek_cond);
+    while (seek_buffer && !seek_flushing && !seek_done)
+      g_cond_wait (&seek_cond, &seek_lock);
+    if (seek_buffer) {
+      gst_buffer_unref (seek_buffer);
+      seek_buffer = NULL;
+    }
+    if (seek_flushing)
+      ret = GST_FLOW_FLUSHING;
+  }
+  g_mutex_unlock (&seek_lock);
+
+  return ret;
+}
+
+static gboolean
+_seek_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  g_mutex_lock (&seek_lock);
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_START) {
+    seek_flushing = TRUE;
+    g_cond_broadcast (&seek_cond);
+  } else if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+    seek_flushing = FALSE;
+  }
+  g_mutex_unlock (&seek_lock);
+
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static void
+check_seek_buffer (guint edit_unit)
+{
+  gint64 end_time = g_get_monotonic_time () + 10 * G_TIME_SPAN_SECOND;
+  guint8 data[ELEMENT_SIZE - 20];
+  GstBuffer *buffer;
+  guint i;
+
+  g_mutex_lock (&seek_lock);
+  while (!seek_buffer
+      && g_cond_wait_until (&seek_cond, &seek_lock, end_time));
+  buffer = seek_buffer;
+  seek_buffer = NULL;
+  g_cond_broadcast (&seek_cond);
+  g_mutex_unlock (&seek_lock);
+
+  fail_unless (buffer != NULL);
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = edit_unit * sizeof (data) + i;
+  fail_unless_equals_int (gst_buffer_get_size (buffer), sizeof (data));
+  fail_unless (gst_buffer_memcmp (buffer, 0, data, sizeof (data)) == 0);
+  fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buffer),
+      edit_unit * EDIT_UNIT_DURATION);
+
+  gst_buffer_unref (buffer);
+}
+
+GST_START_TEST (test_pull_seek_index)
+{
+  GstStateChangeReturn sret;
+  GstElement *mxfdemux;
+  GstPad *sinkpad;
+  guint8 *file;
+  gsize size;
+
+  file = make_indexed_file (&size);
+  src_data = file;
+  src_size = size;
+  seek_flushing = FALSE;
+  seek_done = FALSE;
+
+  mxfdemux = gst_element_factory_make ("mxfdemux", NULL);
+  fail_unless (mxfdemux != NULL);
+  g_signal_connect (mxfdemux, "pad-added", G_CALLBACK (_pad_added), NULL);
+  sinkpad = gst_element_get_static_pad (mxfdemux, "sink");
+  fail_unless (sinkpad != NULL);
+
+  mysinkpad = gst_pad_new_from_static_template (&mysinktemplate, "sink");
+  gst_pad_set_chain_function (mysinkpad, _seek_sink_chain);
+  gst_pad_set_event_function (mysinkpad, _seek_sink_event);
+  mysrcpad = _create_src_pad_pull ();
+  fail_unless (mysrcpad != NULL);
+
+  fail_unless (gst_pad_link (mysrcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+
+  gst_pad_set_active (mysinkpad, TRUE);
+  gst_pad_set_active (mysrcpad, TRUE);
+
+  sret = gst_element_set_state (mxfdemux, GST_STATE_PLAYING);
+  fail_unless_equals_int (sret, GST_STATE_CHANGE_SUCCESS);
+
+  check_seek_buffer (0);
+
+  /* the index table segments are merged on the first seek, edit unit 4 is
+   * in the second segment and not a random access point */
+  fail_unless (gst_element_seek_simple (mxfdemux, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT,
+          4 * EDIT_UNIT_DURATION));
+  check_seek_buffer (INDEX_SPLIT);
+
+  /* edit unit 2 was never walked, only the table knows where it starts */
+  fail_unless (gst_element_seek_simple (mxfdemux, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT,
+          2 * EDIT_UNIT_DURATION));
+  check_seek_buffer (0);
+
+  g_mutex_lock (&seek_lock);
+  seek_done = TRUE;
+  g_cond_broadcast (&seek_cond);
+  g_mutex_unlock (&seek_lock);
+
+  gst_element_set_state (mxfdemux, GST_STATE_NULL);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_pad_set_active (mysrcpad, FALSE);
+
+  gst_object_unref (mxfdemux);
+  gst_object_unref (mysinkpad);
+  gst_object_unref (mysrcpad);
+
+  src_data = mxf_file;
+  src_size = sizeof (mxf_file);
+  g_free (file);
+}
+
+GST_END_TEST;
+
 static Suite *
 mxfdemux_suite (void)
 {
@@ -301,7 +672,9 @@ mxfdemux_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_set_timeout (tc_chain, 180);
   tcase_add_test (tc_chain, test_pull);
+  tcase_add_test (tc_chain, test_pull_read_ahead);
   tcase_add_test (tc_chain, test_push);
+  tcase_add_test (tc_chain, test_pull_seek_index);
 
   return s;
 }
@@ -1,5 +1,7 @@
 #include "parser.h"
 #include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <string.h>
 
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
@@ -69,6 +71,277 @@ GST_START_TEST (test_parse_frames_with_eth_padding)
 }
 GST_END_TEST;
 
+#define PAYLOAD_SIZE 12
+
+static const struct
+{
+  guint8 src_ip[4];
+  guint16 src_port;
+  guint8 dst_ip[4];
+  guint16 dst_port;
+} flows[] = {
+  { {10, 0, 0, 1}, 5000, {10, 0, 0, 2}, 6000 },
+  { {10, 0, 0, 3}, 5000, {10, 0, 0, 2}, 6002 }
+};
+
+/* packets of flow 0, 1, 0, the first payload byte is the flow */
+static const guint packet_flows[] = { 0, 1, 0 };
+
+static GstStaticPadTemplate sinktemplate_any = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* an Ethernet frame with an UDP packet of flow @f */
+static void
+append_frame (GByteArray * data, guint f, guint n)
+{
+  guint8 frame[14 + 20 + 8 + PAYLOAD_SIZE] = { 0, };
+  guint8 *ip = frame + 14, *udp = ip + 20;
+
+  GST_WRITE_UINT16_BE (frame + 12, 0x0800);
+  ip[0] = 0x45;
+  GST_WRITE_UINT16_BE (ip + 2, 20 + 8 + PAYLOAD_SIZE);
+  ip[8] = 64;
+  ip[9] = 17;
+  memcpy (ip + 12, flows[f].src_ip, 4);
+  memcpy (ip + 16, flows[f].dst_ip, 4);
+  GST_WRITE_UINT16_BE (udp, flows[f].src_port);
+  GST_WRITE_UINT16_BE (udp + 2, flows[f].dst_port);
+  GST_WRITE_UINT16_BE (udp + 4, 8 + PAYLOAD_SIZE);
+  memset (udp + 8, n, PAYLOAD_SIZE);
+  udp[8] = f;
+
+  g_byte_array_append (data, frame, sizeof (frame));
+}
+
+static GByteArray *
+make_pcap (void)
+{
+  GByteArray *data = g_byte_array_new ();
+  guint8 record[16];
+  guint i;
+
+  g_byte_array_append (data, pcap_header, sizeof (pcap_header));
+  for (i = 0; i < G_N_ELEMENTS (packet_flows); i++) {
+    GST_WRITE_UINT32_LE (record, 1 + i);
+    GST_WRITE_UINT32_LE (record + 4, 0);
+    GST_WRITE_UINT32_LE (record + 8, 14 + 20 + 8 + PAYLOAD_SIZE);
+    GST_WRITE_UINT32_LE (record + 12, 14 + 20 + 8 + PAYLOAD_SIZE);
+    g_byte_array_append (data, record, sizeof (record));
+    append_frame (data, packet_flows[i], i);
+  }
+
+  return data;
+}
+
+/* a comment option, padded to 8 bytes, and the end of options */
+static const guint8 epb_options[] = {
+  0x01, 0x00, 0x03, 0x00, 'g', 's', 't', 0x00,
+  0x00, 0x00, 0x00, 0x00
+};
+
+static GByteArray *
+make_pcapng (guint16 linktype)
+{
+  GByteArray *data = g_byte_array_new ();
+  guint8 block[32];
+  guint frame_size = 14 + 20 + 8 + PAYLOAD_SIZE;
+  guint padded_size = GST_ROUND_UP_4 (frame_size);
+  guint i;
+
+  /* section header */
+  GST_WRITE_UINT32_LE (block, 0x0a0d0d0a);
+  GST_WRITE_UINT32_LE (block + 4, 28);
+  GST_WRITE_UINT32_LE (block + 8, 0x1a2b3c4d);
+  GST_WRITE_UINT16_LE (block + 12, 1);
+  GST_WRITE_UINT16_LE (block + 14, 0);
+  GST_WRITE_UINT64_LE (block + 16, G_MAXUINT64);
+  GST_WRITE_UINT32_LE (block + 24, 28);
+  g_byte_array_append (data, block, 28);
+
+  /* interface with millisecond timestamps */
+  GST_WRITE_UINT32_LE (block, 0x00000001);
+  GST_WRITE_UINT32_LE (block + 4, 28);
+  GST_WRITE_UINT16_LE (block + 8, linktype);
+  GST_WRITE_UINT16_LE (block + 10, 0);
+  GST_WRITE_UINT32_LE (block + 12, 0);
+  GST_WRITE_UINT16_LE (block + 16, 9);
+  GST_WRITE_UINT16_LE (block + 18, 1);
+  GST_WRITE_UINT32_LE (block + 20, 3);
+  GST_WRITE_UINT32_LE (block + 24, 28);
+  g_byte_array_append (data, block, 28);
+
+  /* enhanced packet blocks with padded frames and options, the block
+   * trailer must not be taken for packet data */
+  for (i = 0; i < G_N_ELEMENTS (packet_flows); i++) {
+    guint block_len = 32 + padded_size + sizeof (epb_options);
+
+    GST_WRITE_UINT32_LE (block, 0x00000006);
+    GST_WRITE_UINT32_LE (block + 4, block_len);
+    GST_WRITE_UINT32_LE (block + 8, 0);
+    GST_WRITE_UINT32_LE (block + 12, 0);
+    GST_WRITE_UINT32_LE (block + 16, 1000 * (1 + i));
+    GST_WRITE_UINT32_LE (block + 20, frame_size);
+    GST_WRITE_UINT32_LE (block + 24, frame_size);
+    g_byte_array_append (data, block, 28);
+    append_frame (data, packet_flows[i], i);
+    memset (block, 0, 4);
+    g_byte_array_append (data, block, padded_size - frame_size);
+    g_byte_array_append (data, epb_options, sizeof (epb_options));
+    GST_WRITE_UINT32_LE (block, block_len);
+    g_byte_array_append (data, block, 4);
+  }
+
+  return data;
+}
+
+static void
+pad_added_cb (GstElement * element, GstPad * pad, gpointer user_data)
+{
+  GstPad *sinkpad;
+
+  sinkpad = gst_check_setup_sink_pad_by_name (element, &sinktemplate_any,
+      GST_PAD_NAME (pad));
+  gst_pad_set_active (sinkpad, TRUE);
+}
+
+static void
+run_pcapparse (GByteArray * data, gboolean split_flows)
+{
+  GstElement *element;
+  GstPad *srcpad, *sinkpad = NULL;
+  GstCaps *caps;
+  GstBuffer *buf;
+
+  element = gst_check_setup_element ("pcapparse");
+  g_object_set (element, "split-flows", split_flows, NULL);
+  if (split_flows)
+    g_signal_connect (element, "pad-added", G_CALLBACK (pad_added_cb), NULL);
+  else
+    sinkpad = gst_check_setup_sink_pad (element, &sinktemplate_any);
+  srcpad = gst_check_setup_src_pad (element, &srctemplate);
+  gst_pad_set_active (srcpad, TRUE);
+  if (sinkpad)
+    gst_pad_set_active (sinkpad, TRUE);
+  fail_unless_equals_int (gst_element_set_state (element, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_SUCCESS);
+
+  caps = gst_caps_from_string ("raw/x-pcap");
+  gst_check_setup_events (srcpad, element, caps, GST_FORMAT_BYTES);
+  gst_caps_unref (caps);
+
+  buf = gst_buffer_new_allocate (NULL, data->len, NULL);
+  gst_buffer_fill (buf, 0, data->data, data->len);
+  fail_unless_equals_int (gst_pad_push (srcpad, buf), GST_FLOW_OK);
+
+  if (split_flows) {
+    gchar *name;
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (flows); i++) {
+      GstPad *pad;
+
+      name = g_strdup_printf ("src_udp_%u.%u.%u.%u_%u_%u.%u.%u.%u_%u",
+          flows[i].src_ip[0], flows[i].src_ip[1], flows[i].src_ip[2],
+          flows[i].src_ip[3], flows[i].src_port, flows[i].dst_ip[0],
+          flows[i].dst_ip[1], flows[i].dst_ip[2], flows[i].dst_ip[3],
+          flows[i].dst_port);
+      pad = gst_element_get_static_pad (element, name);
+      fail_unless (pad != NULL, "no pad %s", name);
+      gst_object_unref (pad);
+      gst_check_teardown_sink_pad_by_name (element, name);
+      g_free (name);
+    }
+  } else {
+    gst_check_teardown_sink_pad (element);
+  }
+
+  gst_element_set_state (element, GST_STATE_NULL);
+  gst_check_teardown_src_pad (element);
+  gst_check_teardown_element (element);
+}
+
+static void
+check_buffers (gboolean sorted_by_flow)
+{
+  GList *l;
+  guint i, n[G_N_ELEMENTS (flows)] = { 0, };
+
+  fail_unless_equals_int (g_list_length (buffers),
+      G_N_ELEMENTS (packet_flows));
+
+  for (l = buffers, i = 0; l; l = l->next, i++) {
+    GstBuffer *buf = l->data;
+    GstMapInfo map;
+
+    fail_unless_equals_int (gst_buffer_get_size (buf), PAYLOAD_SIZE);
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    if (!sorted_by_flow) {
+      fail_unless_equals_int (map.data[0], packet_flows[i]);
+      fail_unless_equals_int (map.data[PAYLOAD_SIZE - 1], i);
+    }
+    fail_unless (map.data[0] < G_N_ELEMENTS (flows));
+    n[map.data[0]]++;
+    gst_buffer_unmap (buf, &map);
+  }
+  fail_unless_equals_int (n[0], 2);
+  fail_unless_equals_int (n[1], 1);
+
+  gst_check_drop_buffers ();
+}
+
+GST_START_TEST (test_split_flows)
+{
+  GByteArray *data = make_pcap ();
+
+  run_pcapparse (data, TRUE);
+  /* the buffers of each flow are pushed as one list per input buffer */
+  check_buffers (TRUE);
+
+  g_byte_array_free (data, TRUE);
+}
+GST_END_TEST;
+
+GST_START_TEST (test_pcapng)
+{
+  GByteArray *data = make_pcapng (1);
+  GList *l;
+  guint i;
+
+  run_pcapparse (data, FALSE);
+
+  /* millisecond timestamps */
+  for (l = buffers, i = 0; l; l = l->next, i++)
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (l->data),
+        (1 + i) * GST_SECOND);
+  check_buffers (FALSE);
+
+  run_pcapparse (data, TRUE);
+  check_buffers (TRUE);
+
+  g_byte_array_free (data, TRUE);
+}
+GST_END_TEST;
+
+GST_START_TEST (test_pcapng_unsupported_linktype)
+{
+  /* IEEE 802.11 */
+  GByteArray *data = make_pcapng (105);
+  GstHarness *h = gst_harness_new ("pcapparse");
+  GstBuffer *buf;
+
+  gst_harness_set_src_caps_str (h, "raw/x-pcap");
+  buf = gst_buffer_new_allocate (NULL, data->len, NULL);
+  gst_buffer_fill (buf, 0, data->data, data->len);
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_ERROR);
+  fail_unless_equals_int (gst_harness_buffers_received (h), 0);
+
+  gst_harness_teardown (h);
+  g_byte_array_free (data, TRUE);
+}
+GST_END_TEST;
+
 static Suite *
 pcapparse_suite (void)
 {
@@ -86,6 +359,9 @@ pcapparse_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_parse_frames_with_eth_padding);
+  tcase_add_test (tc_chain, test_split_flows);
+  tcase_add_test (tc_chain, test_pcapng);
+  tcase_add_test (tc_chain, test_pcapng_unsupported_linktype);
 
   return s;
 }
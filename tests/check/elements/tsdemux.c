@@ -0,0 +1,410 @@
+/* GStreamer
+ *
+ * unit test for tsdemux
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+
+#define TS_PACKET_SIZE 188
+#define PMT_PID 0x1000
+#define VIDEO_PID 0x0100
+
+/* one MPEG-2 video frame per packet, 5 frames per second with an I frame
+ * every two seconds */
+#define N_FRAMES 150
+#define GOP_SIZE 10
+#define N_KEYFRAMES (N_FRAMES / GOP_SIZE)
+
+/* in 90 kHz ticks */
+#define PCR_START 90000
+#define FRAME_TICKS 18000
+#define PTS_DELAY 9000
+
+#define PES_HEADER_SIZE 14
+#define PICTURE_HEADER_SIZE 8
+#define PAYLOAD_SIZE (PES_HEADER_SIZE + PICTURE_HEADER_SIZE + 10)
+
+/* the index file header is 64 bytes, the entry count is at offset 32 */
+#define INDEX_HEADER_SIZE 64
+
+static guint32
+crc32_mpeg (const guint8 * data, gsize size)
+{
+  guint32 crc = 0xffffffff;
+  gsize i;
+  gint j;
+
+  for (i = 0; i < size; i++) {
+    crc ^= (guint32) data[i] << 24;
+    for (j = 0; j < 8; j++)
+      crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04c11db7 : crc << 1;
+  }
+
+  return crc;
+}
+
+static void
+write_ts_header (guint8 * data, guint16 pid, gboolean start, guint8 afc,
+    guint8 * cc)
+{
+  data[0] = 0x47;
+  data[1] = (start ? 0x40 : 0x00) | ((pid >> 8) & 0x1f);
+  data[2] = pid & 0xff;
+  data[3] = (afc << 4) | (*cc & 0x0f);
+  *cc = (*cc + 1) & 0x0f;
+}
+
+/* writes a packet carrying the section of @size bytes in @section, followed
+ * by its CRC */
+static void
+write_section_packet (guint8 * data, guint16 pid, guint8 * section,
+    gsize size, guint8 * cc)
+{
+  guint32 crc = crc32_mpeg (section, size);
+
+  memset (data, 0xff, TS_PACKET_SIZE);
+  write_ts_header (data, pid, TRUE, 0x1, cc);
+  data[4] = 0;
+  memcpy (data + 5, section, size);
+  GST_WRITE_UINT32_BE (data + 5 + size, crc);
+}
+
+static void
+write_pat (guint8 * data, guint8 * cc)
+{
+  guint8 section[] = {
+    0x00, 0xb0, 13, 0x00, 0x01, 0xc1, 0x00, 0x00,
+    0x00, 0x01, 0xe0 | (PMT_PID >> 8), PMT_PID & 0xff
+  };
+
+  write_section_packet (data, 0, section, sizeof (section), cc);
+}
+
+static void
+write_pmt (guint8 * data, guint8 * cc)
+{
+  guint8 section[] = {
+    0x02, 0xb0, 18, 0x00, 0x01, 0xc1, 0x00, 0x00,
+    0xe0 | (VIDEO_PID >> 8), VIDEO_PID & 0xff, 0xf0, 0x00,
+    /* MPEG-2 video */
+    0x02, 0xe0 | (VIDEO_PID >> 8), VIDEO_PID & 0xff, 0xf0, 0x00
+  };
+
+  write_section_packet (data, PMT_PID, section, sizeof (section), cc);
+}
+
+static void
+write_pts (guint8 * data, guint64 pts)
+{
+  data[0] = 0x21 | ((pts >> 29) & 0x0e);
+  data[1] = (pts >> 22) & 0xff;
+  data[2] = ((pts >> 14) & 0xfe) | 0x01;
+  data[3] = (pts >> 7) & 0xff;
+  data[4] = ((pts << 1) & 0xfe) | 0x01;
+}
+
+/* a packet with a PCR, holding the whole PES packet of frame @i, which is
+ * frame @n of its GOP. Nothing but the picture header tells whether the
+ * frame is a keyframe */
+static void
+write_frame (guint8 * data, guint i, guint n, guint8 * cc)
+{
+  guint64 pcr = PCR_START + (guint64) i * FRAME_TICKS;
+  guint8 *af = data + 4, *pes = data + TS_PACKET_SIZE - PAYLOAD_SIZE;
+  guint8 *pic = pes + PES_HEADER_SIZE;
+  guint8 coding_type = n ? 2 : 1;
+
+  memset (data, 0xff, TS_PACKET_SIZE);
+  write_ts_header (data, VIDEO_PID, TRUE, 0x3, cc);
+
+  /* adaptation field with only a PCR, stuffed up to the PES packet */
+  af[0] = TS_PACKET_SIZE - 5 - PAYLOAD_SIZE;
+  af[1] = 0x10;
+  af[2] = (pcr >> 25) & 0xff;
+  af[3] = (pcr >> 17) & 0xff;
+  af[4] = (pcr >> 9) & 0xff;
+  af[5] = (pcr >> 1) & 0xff;
+  af[6] = ((pcr << 7) & 0x80) | 0x7e;
+  af[7] = 0x00;
+
+  GST_WRITE_UINT32_BE (pes, 0x000001e0);
+  GST_WRITE_UINT16_BE (pes + 4, PAYLOAD_SIZE - 6);
+  pes[6] = 0x84;
+  pes[7] = 0x80;
+  pes[8] = 5;
+  write_pts (pes + 9, pcr + PTS_DELAY);
+
+  /* temporal_reference ! picture_coding_type ! vbv_delay */
+  GST_WRITE_UINT32_BE (pic, 0x00000100);
+  pic[4] = n >> 2;
+  pic[5] = ((n & 0x3) << 6) | (coding_type << 3) | 0x07;
+  pic[6] = 0xff;
+  pic[7] = 0xf8;
+  memset (pic + PICTURE_HEADER_SIZE, 0x00,
+      PAYLOAD_SIZE - PES_HEADER_SIZE - PICTURE_HEADER_SIZE);
+}
+
+/* writes the transport stream, with the I frames @key_offset frames into
+ * each GOP, to a temporary file and returns its name */
+static gchar *
+make_ts_file (guint key_offset)
+{
+  GByteArray *ts = g_byte_array_new ();
+  guint8 packet[TS_PACKET_SIZE];
+  guint8 pat_cc = 0, pmt_cc = 0, video_cc = 0;
+  gchar *location;
+  guint i;
+  gint fd;
+
+  for (i = 0; i < N_FRAMES; i++) {
+    if (i % GOP_SIZE == 0) {
+      write_pat (packet, &pat_cc);
+      g_byte_array_append (ts, packet, TS_PACKET_SIZE);
+      write_pmt (packet, &pmt_cc);
+      g_byte_array_append (ts, packet, TS_PACKET_SIZE);
+    }
+    write_frame (packet, i, (i + GOP_SIZE - key_offset) % GOP_SIZE,
+        &video_cc);
+    g_byte_array_append (ts, packet, TS_PACKET_SIZE);
+  }
+
+  fd = g_file_open_tmp ("tsdemux-XXXXXX.ts", &location, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  fail_unless (g_file_set_contents (location, (const gchar *) ts->data,
+          ts->len, NULL));
+  g_byte_array_free (ts, TRUE);
+
+  return location;
+}
+
+static GMutex probe_lock;
+static GArray *timestamps = NULL;
+static gboolean seeking = FALSE;
+static gboolean flushed = FALSE;
+static GstClockTime first_pts = GST_CLOCK_TIME_NONE;
+
+/* records the timestamps of all buffers, and of the first buffer after a
+ * flushing seek */
+static GstPadProbeReturn
+demux_src_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  g_mutex_lock (&probe_lock);
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    GstClockTime pts = GST_BUFFER_PTS (GST_PAD_PROBE_INFO_BUFFER (info));
+
+    if (timestamps)
+      g_array_append_val (timestamps, pts);
+    if (seeking && flushed && first_pts == GST_CLOCK_TIME_NONE)
+      first_pts = pts;
+  } else if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) ==
+      GST_EVENT_FLUSH_STOP) {
+    flushed = TRUE;
+  }
+  g_mutex_unlock (&probe_lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+pad_added (GstElement * demux, GstPad * pad, GstElement * pipeline)
+{
+  GstElement *sink = gst_element_factory_make ("fakesink", NULL);
+  GstPad *sinkpad;
+
+  g_object_set (sink, "sync", FALSE, NULL);
+  gst_bin_add (GST_BIN (pipeline), sink);
+  gst_element_sync_state_with_parent (sink);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  fail_unless_equals_int (gst_pad_link (pad, sinkpad), GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_EVENT_FLUSH, demux_src_probe, NULL, NULL);
+}
+
+/* prerolls tsdemux on @location in pull mode */
+static GstElement *
+start_pipeline (const gchar * location, const gchar * index_location)
+{
+  GstElement *pipeline, *src, *demux;
+
+  pipeline = gst_parse_launch ("filesrc name=src ! tsdemux name=d", NULL);
+  fail_unless (pipeline != NULL);
+
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  g_object_set (src, "location", location, NULL);
+  gst_object_unref (src);
+
+  demux = gst_bin_get_by_name (GST_BIN (pipeline), "d");
+  g_object_set (demux, "index-location", index_location, NULL);
+  g_signal_connect (demux, "pad-added", G_CALLBACK (pad_added), pipeline);
+  gst_object_unref (demux);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PAUSED) != GST_STATE_CHANGE_FAILURE);
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE), GST_STATE_CHANGE_SUCCESS);
+
+  return pipeline;
+}
+
+static void
+stop_pipeline (GstElement * pipeline)
+{
+  /* going to READY saves the index */
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+static void
+play_to_eos (GstElement * pipeline)
+{
+  GstBus *bus = gst_element_get_bus (pipeline);
+  GstMessage *msg;
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+}
+
+/* returns the timestamp of the first buffer after a key unit seek to
+ * @position */
+static GstClockTime
+key_unit_seek (GstElement * pipeline, GstClockTime position,
+    GstSeekFlags snap)
+{
+  GstClockTime pts;
+
+  g_mutex_lock (&probe_lock);
+  seeking = TRUE;
+  flushed = FALSE;
+  first_pts = GST_CLOCK_TIME_NONE;
+  g_mutex_unlock (&probe_lock);
+
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT | snap, position));
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE), GST_STATE_CHANGE_SUCCESS);
+
+  g_mutex_lock (&probe_lock);
+  seeking = FALSE;
+  pts = first_pts;
+  g_mutex_unlock (&probe_lock);
+
+  GST_INFO ("seek to %" GST_TIME_FORMAT " started at %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (position), GST_TIME_ARGS (pts));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (pts));
+
+  return pts;
+}
+
+GST_START_TEST (test_index_seek)
+{
+  GstClockTime keyframes[N_KEYFRAMES];
+  gchar *location, *other, *index, *contents;
+  GstElement *pipeline;
+  gsize size;
+  guint i;
+  gint fd;
+
+  location = make_ts_file (0);
+  fd = g_file_open_tmp ("tsdemux-XXXXXX.idx", &index, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  g_unlink (index);
+
+  /* playing the whole stream indexes all I frames */
+  timestamps = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  pipeline = start_pipeline (location, index);
+  play_to_eos (pipeline);
+  stop_pipeline (pipeline);
+
+  g_mutex_lock (&probe_lock);
+  fail_unless_equals_int (timestamps->len, N_FRAMES);
+  for (i = 0; i < N_KEYFRAMES; i++)
+    keyframes[i] = g_array_index (timestamps, GstClockTime, i * GOP_SIZE);
+  g_array_free (timestamps, TRUE);
+  timestamps = NULL;
+  g_mutex_unlock (&probe_lock);
+
+  fail_unless (g_file_get_contents (index, &contents, &size, NULL));
+  fail_unless (size > INDEX_HEADER_SIZE);
+  fail_unless (memcmp (contents, "GstTsIdx", 8) == 0);
+  fail_unless_equals_uint64 (GST_READ_UINT64_LE (contents + 32),
+      N_KEYFRAMES);
+  g_free (contents);
+
+  /* with the index loaded, key unit seeks start right at the I frames
+   * around the position. Without it they would start SEEK_TIMESTAMP_OFFSET
+   * before the position, in the middle of the previous GOP */
+  pipeline = start_pipeline (location, index);
+  fail_unless_equals_uint64 (key_unit_seek (pipeline,
+          keyframes[7] + GST_SECOND, GST_SEEK_FLAG_SNAP_BEFORE), keyframes[7]);
+  fail_unless_equals_uint64 (key_unit_seek (pipeline,
+          keyframes[7] + GST_SECOND, GST_SEEK_FLAG_SNAP_AFTER), keyframes[8]);
+  fail_unless_equals_uint64 (key_unit_seek (pipeline,
+          keyframes[3] + 600 * GST_MSECOND, GST_SEEK_FLAG_SNAP_NEAREST),
+      keyframes[3]);
+  stop_pipeline (pipeline);
+
+  /* a recording of the same size and pid, but with the I frames elsewhere,
+   * must not use that index, or the seek would start at a P frame */
+  other = make_ts_file (GOP_SIZE / 2);
+  pipeline = start_pipeline (other, index);
+  fail_if (key_unit_seek (pipeline, keyframes[7] + GST_SECOND,
+          GST_SEEK_FLAG_SNAP_BEFORE) == keyframes[7]);
+  stop_pipeline (pipeline);
+
+  g_unlink (index);
+  g_unlink (location);
+  g_unlink (other);
+  g_free (index);
+  g_free (location);
+  g_free (other);
+}
+
+GST_END_TEST;
+
+static Suite *
+tsdemux_suite (void)
+{
+  Suite *s = suite_create ("tsdemux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_index_seek);
+
+  return s;
+}
+
+GST_CHECK_MAIN (tsdemux);
@@ -0,0 +1,433 @@
+/* GStreamer
+ *
+ * unit test for tsparse
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/mpegts/mpegts.h>
+
+#define PACKET_SIZE 188
+#define PMT_PID(program) (0x100 + (program))
+#define ES_PID(program) (0x200 + (program))
+
+static void
+write_header (guint8 * packet, guint16 pid, gboolean pusi, guint8 cc)
+{
+  packet[0] = 0x47;
+  packet[1] = (pusi ? 0x40 : 0x00) | (pid >> 8);
+  packet[2] = pid & 0xff;
+  packet[3] = 0x10 | (cc & 0x0f);
+}
+
+static void
+write_section (guint8 * packet, guint16 pid, GstMpegtsSection * section)
+{
+  guint8 *data;
+  gsize size;
+
+  data = gst_mpegts_section_packetize (section, &size);
+  fail_unless (data != NULL);
+  fail_unless (size <= PACKET_SIZE - 5);
+
+  write_header (packet, pid, TRUE, 0);
+  packet[4] = 0x00;
+  memcpy (packet + 5, data, size);
+  memset (packet + 5 + size, 0xff, PACKET_SIZE - 5 - size);
+  gst_mpegts_section_unref (section);
+}
+
+/* writes @section over as many packets as it needs, returns their number */
+static guint
+write_long_section (guint8 * packets, guint16 pid, GstMpegtsSection * section,
+    guint8 * cc)
+{
+  guint8 *data;
+  gsize size, offset = 0;
+  guint n;
+
+  data = gst_mpegts_section_packetize (section, &size);
+  fail_unless (data != NULL);
+
+  for (n = 0; offset < size; n++) {
+    guint8 *packet = packets + n * PACKET_SIZE;
+    gsize header = n == 0 ? 5 : 4;
+    gsize len = MIN (size - offset, PACKET_SIZE - header);
+
+    write_header (packet, pid, n == 0, (*cc)++);
+    packet[4] = 0x00;
+    memcpy (packet + header, data + offset, len);
+    memset (packet + header + len, 0xff, PACKET_SIZE - header - len);
+    offset += len;
+  }
+  gst_mpegts_section_unref (section);
+
+  return n;
+}
+
+static GstMpegtsSection *
+make_pat (guint n_programs, guint8 version)
+{
+  GstMpegtsSection *section;
+  GPtrArray *programs;
+  guint p;
+
+  programs = gst_mpegts_pat_new ();
+  for (p = 1; p <= n_programs; p++) {
+    GstMpegtsPatProgram *program = gst_mpegts_pat_program_new ();
+
+    program->program_number = p;
+    program->network_or_program_map_PID = PMT_PID (p);
+    g_ptr_array_add (programs, program);
+  }
+  section = gst_mpegts_section_from_pat (programs, 1);
+  section->version_number = version;
+
+  return section;
+}
+
+static void
+write_pat (guint8 * packet, guint n_programs)
+{
+  write_section (packet, 0x00, make_pat (n_programs, 0));
+}
+
+static void
+write_pmt (guint8 * packet, guint program)
+{
+  GstMpegtsPMT *pmt = gst_mpegts_pmt_new ();
+  GstMpegtsPMTStream *stream = gst_mpegts_pmt_stream_new ();
+
+  pmt->program_number = program;
+  pmt->pcr_pid = ES_PID (program);
+  stream->stream_type = GST_MPEGTS_STREAM_TYPE_VIDEO_H264;
+  stream->pid = ES_PID (program);
+  g_ptr_array_add (pmt->streams, stream);
+  write_section (packet, PMT_PID (program),
+      gst_mpegts_section_from_pmt (pmt, PMT_PID (program)));
+}
+
+/* A PAT, one PMT for each of @n_programs programs and the PAT again, like
+ * it is repeated in a real stream. Program p has a single H.264 stream */
+static GstBuffer *
+make_tables (guint n_programs)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  guint p;
+
+  buf = gst_buffer_new_allocate (NULL, (2 + n_programs) * PACKET_SIZE, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+
+  write_pat (map.data, n_programs);
+
+  for (p = 1; p <= n_programs; p++)
+    write_pmt (map.data + p * PACKET_SIZE, p);
+  write_pat (map.data + (1 + n_programs) * PACKET_SIZE, n_programs);
+
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+/* @n_rounds packets of every program, interleaved and filled with the
+ * program number */
+static GstBuffer *
+make_payload (guint n_programs, guint n_rounds, guint8 * cc)
+{
+  GstBuffer *buf;
+  GstMapInfo map;
+  guint8 *packet;
+  guint i, p;
+
+  buf = gst_buffer_new_allocate (NULL, n_rounds * n_programs * PACKET_SIZE,
+      NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+
+  packet = map.data;
+  for (i = 0; i < n_rounds; i++) {
+    for (p = 1; p <= n_programs; p++) {
+      write_header (packet, ES_PID (p), FALSE, cc[p]++);
+      memset (packet + 4, p, PACKET_SIZE - 4);
+      packet += PACKET_SIZE;
+    }
+  }
+
+  gst_buffer_unmap (buf, &map);
+
+  return buf;
+}
+
+static GstHarness **
+setup_tsparse (guint n_programs)
+{
+  GstHarness **h = g_new0 (GstHarness *, n_programs + 2);
+  gchar *name;
+  guint p;
+
+  h[0] = gst_harness_new_with_padnames ("tsparse", "sink", "src");
+  gst_harness_set_src_caps_str (h[0], "video/mpegts,systemstream=true");
+
+  for (p = 1; p <= n_programs; p++) {
+    name = g_strdup_printf ("program_%u", p);
+    h[p] = gst_harness_new_with_element (h[0]->element, NULL, name);
+    g_free (name);
+  }
+
+  return h;
+}
+
+static void
+teardown_tsparse (GstHarness ** h)
+{
+  guint i;
+
+  for (i = 0; h[i]; i++)
+    gst_harness_teardown (h[i]);
+  g_free (h);
+}
+
+static guint
+pull_all_packets (GstHarness * h, guint8 ** packets)
+{
+  GByteArray *bytes = g_byte_array_new ();
+  GstBuffer *buf;
+  GstMapInfo map;
+  guint n_packets;
+
+  while ((buf = gst_harness_try_pull (h))) {
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    fail_unless (map.size % PACKET_SIZE == 0);
+    g_byte_array_append (bytes, map.data, map.size);
+    gst_buffer_unmap (buf, &map);
+    gst_buffer_unref (buf);
+  }
+
+  n_packets = bytes->len / PACKET_SIZE;
+  *packets = (guint8 *) g_byte_array_free (bytes, FALSE);
+
+  return n_packets;
+}
+
+#define N_PROGRAMS 3
+#define N_ROUNDS 300
+
+GST_START_TEST (test_program_pads)
+{
+  GstHarness **h = setup_tsparse (N_PROGRAMS);
+  guint8 cc[N_PROGRAMS + 1] = { 0, };
+  guint8 *packets, *packet;
+  guint p, i, n_buffers, n_packets;
+  guint16 pid;
+
+  fail_unless_equals_int (gst_harness_push (h[0], make_tables (N_PROGRAMS)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h[0], make_payload (N_PROGRAMS,
+              N_ROUNDS, cc)), GST_FLOW_OK);
+
+  /* the always pad gets everything */
+  fail_unless_equals_int (gst_harness_buffers_received (h[0]), 2);
+
+  for (p = 1; p <= N_PROGRAMS; p++) {
+    n_buffers = gst_harness_buffers_received (h[p]);
+    n_packets = pull_all_packets (h[p], &packets);
+
+    /* our PMT, our PAT and our stream, in a few buffers */
+    fail_unless_equals_int (n_packets, 2 + N_ROUNDS);
+    fail_unless (n_buffers < n_packets);
+
+    packet = packets;
+    fail_unless_equals_int (((packet[1] & 0x1f) << 8) | packet[2], PMT_PID (p));
+
+    /* the repeated PAT only lists our program */
+    packet += PACKET_SIZE;
+    fail_unless_equals_int (packet[0], 0x47);
+    fail_unless_equals_int (((packet[1] & 0x1f) << 8) | packet[2], 0x00);
+    fail_unless_equals_int (packet[5], 0x00);
+    fail_unless_equals_int (((packet[6] & 0x0f) << 8) | packet[7], 13);
+    fail_unless_equals_int (GST_READ_UINT16_BE (packet + 13), p);
+    fail_unless_equals_int (GST_READ_UINT16_BE (packet + 15) & 0x1fff,
+        PMT_PID (p));
+
+    for (i = 0; i < N_ROUNDS; i++) {
+      packet += PACKET_SIZE;
+      pid = ((packet[1] & 0x1f) << 8) | packet[2];
+      fail_unless_equals_int (pid, ES_PID (p));
+      fail_unless_equals_int (packet[4], p);
+    }
+
+    g_free (packets);
+  }
+
+  teardown_tsparse (h);
+}
+
+GST_END_TEST;
+
+/* enough programs for the PAT to need two packets */
+#define LONG_PAT_PROGRAMS 50
+
+static guint16
+packet_pid (const guint8 * packet)
+{
+  return ((packet[1] & 0x1f) << 8) | packet[2];
+}
+
+GST_START_TEST (test_multi_packet_pat)
+{
+  GstHarness **h = setup_tsparse (1);
+  guint8 pat[2 * PACKET_SIZE];
+  guint8 pat_cc = 0, es_cc = 0;
+  guint8 *packets, *packet;
+  GstBuffer *buf;
+  GstMapInfo map;
+  guint i, n_packets;
+  static const guint16 expected[] = {
+    PMT_PID (1), ES_PID (1), 0x00, ES_PID (1), 0x00, ES_PID (1)
+  };
+
+  buf = gst_buffer_new_allocate (NULL, 10 * PACKET_SIZE, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  packet = map.data;
+
+  fail_unless_equals_int (write_long_section (packet, 0x00,
+          make_pat (LONG_PAT_PROGRAMS, 0), &pat_cc), 2);
+  packet += 2 * PACKET_SIZE;
+  write_pmt (packet, 1);
+  packet += PACKET_SIZE;
+
+  /* a new PAT version, with a packet of our program in the middle */
+  fail_unless_equals_int (write_long_section (pat, 0x00,
+          make_pat (LONG_PAT_PROGRAMS, 1), &pat_cc), 2);
+  memcpy (packet, pat, PACKET_SIZE);
+  packet += PACKET_SIZE;
+  write_header (packet, ES_PID (1), FALSE, es_cc++);
+  memset (packet + 4, 1, PACKET_SIZE - 4);
+  packet += PACKET_SIZE;
+  memcpy (packet, pat + PACKET_SIZE, PACKET_SIZE);
+  packet += PACKET_SIZE;
+  write_header (packet, ES_PID (1), FALSE, es_cc++);
+  memset (packet + 4, 1, PACKET_SIZE - 4);
+  packet += PACKET_SIZE;
+
+  /* and that PAT repeated */
+  fail_unless_equals_int (write_long_section (packet, 0x00,
+          make_pat (LONG_PAT_PROGRAMS, 1), &pat_cc), 2);
+  packet += 2 * PACKET_SIZE;
+  write_header (packet, ES_PID (1), FALSE, es_cc++);
+  memset (packet + 4, 1, PACKET_SIZE - 4);
+
+  gst_buffer_unmap (buf, &map);
+  fail_unless_equals_int (gst_harness_push (h[0], buf), GST_FLOW_OK);
+
+  /* every PAT is replaced once, by a single packet after its last one */
+  n_packets = pull_all_packets (h[1], &packets);
+  fail_unless_equals_int (n_packets, G_N_ELEMENTS (expected));
+  for (i = 0; i < n_packets; i++) {
+    packet = packets + i * PACKET_SIZE;
+    fail_unless_equals_int (packet_pid (packet), expected[i]);
+    if (expected[i] != 0x00)
+      continue;
+
+    fail_unless_equals_int (packet[1] & 0x40, 0x40);
+    fail_unless_equals_int ((packet[10] >> 1) & 0x1f, 1);
+    fail_unless_equals_int (((packet[6] & 0x0f) << 8) | packet[7], 13);
+    fail_unless_equals_int (GST_READ_UINT16_BE (packet + 13), 1);
+  }
+  g_free (packets);
+
+  teardown_tsparse (h);
+}
+
+GST_END_TEST;
+
+#define BENCH_PROGRAMS 30
+#define BENCH_ROUNDS 12
+#define BENCH_BUFFERS 500
+
+GST_START_TEST (test_benchmark)
+{
+  GstHarness **h = setup_tsparse (BENCH_PROGRAMS);
+  guint8 cc[BENCH_PROGRAMS + 1] = { 0, };
+  GstBuffer *payload;
+  gint64 start, elapsed;
+  gsize size;
+  guint i, p;
+
+  fail_unless_equals_int (gst_harness_push (h[0],
+          make_tables (BENCH_PROGRAMS)), GST_FLOW_OK);
+
+  /* buffers of 360 packets, like a 64 kB read */
+  payload = make_payload (BENCH_PROGRAMS, BENCH_ROUNDS, cc);
+  size = gst_buffer_get_size (payload);
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < BENCH_BUFFERS; i++) {
+    fail_unless_equals_int (gst_harness_push (h[0], gst_buffer_ref (payload)),
+        GST_FLOW_OK);
+    for (p = 0; p <= BENCH_PROGRAMS; p++) {
+      GstBuffer *buf;
+
+      while ((buf = gst_harness_try_pull (h[p])))
+        gst_buffer_unref (buf);
+    }
+  }
+  elapsed = MAX (g_get_monotonic_time () - start, 1);
+
+  g_print ("tsparse, %u program pads: %.1f Mbit/s\n", BENCH_PROGRAMS,
+      (gdouble) BENCH_BUFFERS * size * 8 / elapsed);
+
+  gst_buffer_unref (payload);
+  teardown_tsparse (h);
+}
+
+GST_END_TEST;
+
+static Suite *
+tsparse_suite (void)
+{
+  Suite *s = suite_create ("tsparse");
+  TCase *tc_chain = tcase_create ("general");
+
+  gst_mpegts_initialize ();
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_program_pads);
+  tcase_add_test (tc_chain, test_multi_packet_pat);
+
+  /* timings only, not part of make check */
+  if (g_getenv ("GST_CHECK_BENCHMARKS")) {
+    TCase *tc_benchmark = tcase_create ("benchmark");
+
+    suite_add_tcase (s, tc_benchmark);
+    tcase_set_timeout (tc_benchmark, 0);
+    tcase_add_test (tc_benchmark, test_benchmark);
+  }
+
+  return s;
+}
+
+GST_CHECK_MAIN (tsparse);
@@ -0,0 +1,447 @@
+/* GStreamer
+ *
+ * unit test for videoparse
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define WIDTH 4
+#define HEIGHT 4
+#define FRAME_SIZE (WIDTH * HEIGHT)
+#define N_FRAMES 3
+#define CHUNK_SIZE 10
+
+static GstHarness *
+setup_videoparse (gboolean video_meta)
+{
+  GstHarness *h = gst_harness_new ("videoparse");
+
+  g_object_set (h->element, "format", GST_VIDEO_FORMAT_GRAY8, "width", WIDTH,
+      "height", HEIGHT, NULL);
+  if (video_meta)
+    gst_harness_add_propose_allocation_meta (h, GST_VIDEO_META_API_TYPE, NULL);
+  gst_harness_set_src_caps_str (h, "application/octet-stream");
+
+  return h;
+}
+
+/* pushes N_FRAMES frames of ascending bytes in chunks that don't line up
+ * with the frames */
+static void
+push_chunks (GstHarness * h, gint frame_size)
+{
+  guint8 data[N_FRAMES * 2 * WIDTH * (HEIGHT + 1)];
+  gint i, total = N_FRAMES * frame_size;
+
+  fail_unless (total <= sizeof (data));
+  for (i = 0; i < total; i++)
+    data[i] = i;
+
+  for (i = 0; i < total; i += CHUNK_SIZE) {
+    gint size = MIN (CHUNK_SIZE, total - i);
+    GstBuffer *buf = gst_buffer_new_allocate (NULL, size, NULL);
+
+    gst_buffer_fill (buf, 0, data + i, size);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+}
+
+static void
+check_frame (GstBuffer * buf, gint first, gint stride)
+{
+  GstMapInfo map;
+  gint x, y;
+
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++)
+      fail_unless_equals_int (map.data[y * stride + x],
+          (guint8) (first + y * stride + x));
+  }
+  gst_buffer_unmap (buf, &map);
+}
+
+GST_START_TEST (test_push_copy)
+{
+  GstHarness *h = setup_videoparse (FALSE);
+  GstBuffer *buf;
+  gint i;
+
+  push_chunks (h, FRAME_SIZE);
+
+  fail_unless_equals_int (gst_harness_buffers_received (h), N_FRAMES);
+  for (i = 0; i < N_FRAMES; i++) {
+    buf = gst_harness_pull (h);
+    fail_unless_equals_int (gst_buffer_get_size (buf), FRAME_SIZE);
+    fail_unless_equals_int (gst_buffer_n_memory (buf), 1);
+    fail_unless (gst_buffer_get_video_meta (buf) == NULL);
+    check_frame (buf, i * FRAME_SIZE, WIDTH);
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_push_zero_copy)
+{
+  GstHarness *h = setup_videoparse (TRUE);
+  GstVideoMeta *meta;
+  GstBuffer *buf;
+  gint i;
+
+  push_chunks (h, FRAME_SIZE);
+
+  fail_unless_equals_int (gst_harness_buffers_received (h), N_FRAMES);
+  for (i = 0; i < N_FRAMES; i++) {
+    buf = gst_harness_pull (h);
+    fail_unless_equals_int (gst_buffer_get_size (buf), FRAME_SIZE);
+    /* every frame spans two or three of the pushed chunks */
+    fail_unless (gst_buffer_n_memory (buf) > 1);
+    meta = gst_buffer_get_video_meta (buf);
+    fail_unless (meta != NULL);
+    fail_unless_equals_int (meta->stride[0], WIDTH);
+    check_frame (buf, i * FRAME_SIZE, WIDTH);
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static void
+set_padded_layout (GstHarness * h)
+{
+  GValueArray *strides;
+  GValue v = G_VALUE_INIT;
+
+  G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+  strides = g_value_array_new (1);
+  g_value_init (&v, G_TYPE_INT);
+  g_value_set_int (&v, 2 * WIDTH);
+  g_value_array_append (strides, &v);
+  g_value_unset (&v);
+
+  /* lines twice as wide as the image and a spare line after the frame */
+  g_object_set (h->element, "plane-strides", strides, "frame-size",
+      2 * WIDTH * (HEIGHT + 1), NULL);
+  g_value_array_free (strides);
+  G_GNUC_END_IGNORE_DEPRECATIONS;
+}
+
+GST_START_TEST (test_padded_layout)
+{
+  GstHarness *h;
+  GstVideoMeta *meta;
+  GstBuffer *buf;
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  gint i, x, y;
+
+  /* without the meta downstream gets the default layout */
+  h = setup_videoparse (FALSE);
+  set_padded_layout (h);
+  push_chunks (h, 2 * WIDTH * (HEIGHT + 1));
+
+  fail_unless_equals_int (gst_harness_buffers_received (h), N_FRAMES);
+  for (i = 0; i < N_FRAMES; i++) {
+    GstMapInfo map;
+
+    buf = gst_harness_pull (h);
+    fail_unless_equals_int (gst_buffer_get_size (buf), FRAME_SIZE);
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    for (y = 0; y < HEIGHT; y++) {
+      for (x = 0; x < WIDTH; x++)
+        fail_unless_equals_int (map.data[y * WIDTH + x],
+            (guint8) (i * 2 * WIDTH * (HEIGHT + 1) + y * 2 * WIDTH + x));
+    }
+    gst_buffer_unmap (buf, &map);
+    gst_buffer_unref (buf);
+  }
+  gst_harness_teardown (h);
+
+  /* with the meta the frames keep their layout */
+  h = setup_videoparse (TRUE);
+  set_padded_layout (h);
+  push_chunks (h, 2 * WIDTH * (HEIGHT + 1));
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_GRAY8, WIDTH, HEIGHT);
+  fail_unless_equals_int (gst_harness_buffers_received (h), N_FRAMES);
+  for (i = 0; i < N_FRAMES; i++) {
+    buf = gst_harness_pull (h);
+    fail_unless_equals_int (gst_buffer_get_size (buf),
+        2 * WIDTH * (HEIGHT + 1));
+    meta = gst_buffer_get_video_meta (buf);
+    fail_unless (meta != NULL);
+    fail_unless_equals_int (meta->stride[0], 2 * WIDTH);
+
+    fail_unless (gst_video_frame_map (&frame, &info, buf, GST_MAP_READ));
+    fail_unless_equals_int (GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0),
+        2 * WIDTH);
+    gst_video_frame_unmap (&frame);
+    check_frame (buf, i * 2 * WIDTH * (HEIGHT + 1), 2 * WIDTH);
+    gst_buffer_unref (buf);
+  }
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* pull mode: N_PULL_FRAMES frames read in blocks of PULL_BLOCK_FRAMES,
+ * the last block is shorter */
+#define N_PULL_FRAMES 10
+#define PULL_BLOCK_FRAMES 4
+#define FRAME_DURATION (GST_SECOND / 25)
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+static guint8 pull_data[N_PULL_FRAMES * FRAME_SIZE];
+static guint n_getrange;
+
+static GMutex pull_lock;
+static GCond pull_cond;
+static GList *pull_buffers;
+static gboolean pull_eos;
+
+static GstFlowReturn
+pull_src_getrange (GstPad * pad, GstObject * parent, guint64 offset,
+    guint length, GstBuffer ** buffer)
+{
+  if (offset + length > sizeof (pull_data))
+    return GST_FLOW_EOS;
+
+  g_mutex_lock (&pull_lock);
+  n_getrange++;
+  g_mutex_unlock (&pull_lock);
+
+  *buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      pull_data + offset, length, 0, length, NULL, NULL);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+pull_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_DURATION:{
+      GstFormat fmt;
+
+      gst_query_parse_duration (query, &fmt, NULL);
+      if (fmt != GST_FORMAT_BYTES)
+        return FALSE;
+      gst_query_set_duration (query, fmt, sizeof (pull_data));
+      return TRUE;
+    }
+    case GST_QUERY_SCHEDULING:
+      gst_query_set_scheduling (query, GST_SCHEDULING_FLAG_SEEKABLE, 1, -1, 0);
+      gst_query_add_scheduling_mode (query, GST_PAD_MODE_PULL);
+      return TRUE;
+    default:
+      return gst_pad_query_default (pad, parent, query);
+  }
+}
+
+static GstFlowReturn
+pull_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  g_mutex_lock (&pull_lock);
+  pull_buffers = g_list_append (pull_buffers, buffer);
+  g_mutex_unlock (&pull_lock);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+pull_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  g_mutex_lock (&pull_lock);
+  if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+    g_list_free_full (pull_buffers, (GDestroyNotify) gst_buffer_unref);
+    pull_buffers = NULL;
+    pull_eos = FALSE;
+    n_getrange = 0;
+  } else if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
+    pull_eos = TRUE;
+    g_cond_broadcast (&pull_cond);
+  }
+  g_mutex_unlock (&pull_lock);
+
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+/* starts videoparse in pull mode, it plays forwards right away */
+static GstElement *
+setup_videoparse_pull (GstPad ** srcpad, GstPad ** sinkpad)
+{
+  GstElement *videoparse;
+  GstPad *pad;
+  gint i;
+
+  for (i = 0; i < sizeof (pull_data); i++)
+    pull_data[i] = i;
+  pull_buffers = NULL;
+  pull_eos = FALSE;
+  n_getrange = 0;
+
+  videoparse = gst_element_factory_make ("videoparse", NULL);
+  fail_unless (videoparse != NULL);
+  g_object_set (videoparse, "format", GST_VIDEO_FORMAT_GRAY8, "width", WIDTH,
+      "height", HEIGHT, "block-size", PULL_BLOCK_FRAMES * FRAME_SIZE + 5,
+      NULL);
+
+  *srcpad = gst_pad_new_from_static_template (&srctemplate, "src");
+  gst_pad_set_getrange_function (*srcpad, pull_src_getrange);
+  gst_pad_set_query_function (*srcpad, pull_src_query);
+  *sinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_chain_function (*sinkpad, pull_sink_chain);
+  gst_pad_set_event_function (*sinkpad, pull_sink_event);
+
+  pad = gst_element_get_static_pad (videoparse, "sink");
+  fail_unless (gst_pad_link (*srcpad, pad) == GST_PAD_LINK_OK);
+  gst_object_unref (pad);
+  pad = gst_element_get_static_pad (videoparse, "src");
+  fail_unless (gst_pad_link (pad, *sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (pad);
+
+  gst_pad_set_active (*sinkpad, TRUE);
+  gst_pad_set_active (*srcpad, TRUE);
+  fail_unless_equals_int (gst_element_set_state (videoparse,
+          GST_STATE_PAUSED), GST_STATE_CHANGE_SUCCESS);
+
+  return videoparse;
+}
+
+static void
+teardown_videoparse_pull (GstElement * videoparse, GstPad * srcpad,
+    GstPad * sinkpad)
+{
+  gst_element_set_state (videoparse, GST_STATE_NULL);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_object_unref (videoparse);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+
+  g_list_free_full (pull_buffers, (GDestroyNotify) gst_buffer_unref);
+  pull_buffers = NULL;
+}
+
+static void
+wait_for_pull_eos (void)
+{
+  gint64 end_time = g_get_monotonic_time () + 10 * G_TIME_SPAN_SECOND;
+
+  g_mutex_lock (&pull_lock);
+  while (!pull_eos && g_cond_wait_until (&pull_cond, &pull_lock, end_time));
+  fail_unless (pull_eos);
+  g_mutex_unlock (&pull_lock);
+}
+
+/* checks that the frames in pull_buffers are @first, @first + @step, ... */
+static void
+check_pull_frames (gint first, gint step)
+{
+  GList *l;
+  gint i = first;
+
+  fail_unless_equals_int (g_list_length (pull_buffers), N_PULL_FRAMES);
+  for (l = pull_buffers; l; l = l->next, i += step) {
+    GstBuffer *buf = l->data;
+
+    fail_unless_equals_int (gst_buffer_get_size (buf), FRAME_SIZE);
+    check_frame (buf, i * FRAME_SIZE, WIDTH);
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buf),
+        i * FRAME_DURATION);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), i);
+  }
+}
+
+GST_START_TEST (test_pull_blocks)
+{
+  GstElement *videoparse;
+  GstPad *srcpad, *sinkpad;
+
+  videoparse = setup_videoparse_pull (&srcpad, &sinkpad);
+  wait_for_pull_eos ();
+
+  /* blocks of 4, 4 and 2 frames, split into single frames */
+  fail_unless_equals_int (n_getrange, 3);
+  check_pull_frames (0, 1);
+
+  teardown_videoparse_pull (videoparse, srcpad, sinkpad);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pull_reverse)
+{
+  GstElement *videoparse;
+  GstPad *srcpad, *sinkpad;
+
+  videoparse = setup_videoparse_pull (&srcpad, &sinkpad);
+  wait_for_pull_eos ();
+
+  fail_unless (gst_element_send_event (videoparse,
+          gst_event_new_seek (-1.0, GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH,
+              GST_SEEK_TYPE_SET, 0, GST_SEEK_TYPE_SET,
+              N_PULL_FRAMES * FRAME_DURATION)));
+  wait_for_pull_eos ();
+
+  /* blocks of 4 and 4 frames from the end, then the 2 left at the start,
+   * each pushed last frame first */
+  fail_unless_equals_int (n_getrange, 3);
+  check_pull_frames (N_PULL_FRAMES - 1, -1);
+
+  teardown_videoparse_pull (videoparse, srcpad, sinkpad);
+}
+
+GST_END_TEST;
+
+static Suite *
+videoparse_suite (void)
+{
+  Suite *s = suite_create ("videoparse");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_push_copy);
+  tcase_add_test (tc_chain, test_push_zero_copy);
+  tcase_add_test (tc_chain, test_padded_layout);
+  tcase_add_test (tc_chain, test_pull_blocks);
+  tcase_add_test (tc_chain, test_pull_reverse);
+
+  return s;
+}
+
+GST_CHECK_MAIN (videoparse);
@@ -27,6 +27,7 @@
 #include <gst/gl/gl.h>
 
 #include <stdio.h>
+#include <string.h>
 
 static GstGLDisplay *display;
 static GstGLContext *context;
@@ -229,6 +230,293 @@ GST_START_TEST (test_reorder_buffer)
 
 GST_END_TEST;
 
+static GstCaps *
+_gl_caps (GstVideoFormat v_format)
+{
+  GstVideoInfo info;
+  GstCaps *caps;
+
+  gst_video_info_set_format (&info, v_format, 16, 16);
+  caps = gst_video_info_to_caps (&info);
+  gst_caps_set_features (caps, 0,
+      gst_caps_features_from_string (GST_CAPS_FEATURE_MEMORY_GL_MEMORY));
+
+  return caps;
+}
+
+static guint
+_get_stat (const gchar * name)
+{
+  GstStructure *stats = gst_gl_color_convert_get_context_stats (context);
+  guint val = 0;
+
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_get_uint (stats, name, &val));
+  gst_structure_free (stats);
+
+  return val;
+}
+
+GST_START_TEST (test_shared_resources)
+{
+  GstGLColorConvert *convert2;
+  GstCaps *in_caps, *out_caps, *other_caps;
+  GstVideoInfo in_info;
+  GstBuffer *inbuf, *outbuf;
+
+  in_caps = _gl_caps (GST_VIDEO_FORMAT_RGBA);
+  out_caps = _gl_caps (GST_VIDEO_FORMAT_BGRA);
+  other_caps = _gl_caps (GST_VIDEO_FORMAT_ARGB);
+
+  fail_unless (gst_video_info_from_caps (&in_info, in_caps));
+  inbuf = gst_buffer_new ();
+  fail_unless (gst_gl_memory_setup_buffer (context, NULL, &in_info, NULL,
+          inbuf));
+
+  convert2 = gst_gl_color_convert_new (context);
+
+  /* the second converter for the same conversion reuses the program and
+   * the output buffer pool of the first */
+  fail_unless (gst_gl_color_convert_set_caps (convert, in_caps, out_caps));
+  fail_unless (gst_gl_color_convert_set_caps (convert2, in_caps, out_caps));
+  outbuf = gst_gl_color_convert_perform (convert, inbuf);
+  fail_unless (outbuf != NULL);
+  gst_buffer_unref (outbuf);
+  outbuf = gst_gl_color_convert_perform (convert2, inbuf);
+  fail_unless (outbuf != NULL);
+  gst_buffer_unref (outbuf);
+
+  fail_unless_equals_int (_get_stat ("programs"), 1);
+  fail_unless_equals_int (_get_stat ("program-misses"), 1);
+  fail_unless_equals_int (_get_stat ("program-hits"), 1);
+  fail_unless_equals_int (_get_stat ("buffer-pools"), 1);
+  fail_unless_equals_int (_get_stat ("buffer-pool-hits"), 1);
+  fail_unless_equals_int (_get_stat ("framebuffer-misses"), 2);
+
+  /* a caps change hands the framebuffer back for the next conversion of
+   * the same size */
+  fail_unless (gst_gl_color_convert_set_caps (convert, in_caps, other_caps));
+  fail_unless_equals_int (_get_stat ("framebuffers"), 1);
+  outbuf = gst_gl_color_convert_perform (convert, inbuf);
+  fail_unless (outbuf != NULL);
+  gst_buffer_unref (outbuf);
+
+  fail_unless_equals_int (_get_stat ("programs"), 2);
+  fail_unless_equals_int (_get_stat ("framebuffer-hits"), 1);
+  fail_unless_equals_int (_get_stat ("buffer-pools"), 2);
+
+  /* the pool goes away with its last user */
+  gst_object_unref (convert2);
+  fail_unless_equals_int (_get_stat ("buffer-pools"), 1);
+  fail_unless_equals_int (_get_stat ("buffer-pool-evictions"), 1);
+
+  gst_buffer_unref (inbuf);
+  gst_caps_unref (in_caps);
+  gst_caps_unref (out_caps);
+  gst_caps_unref (other_caps);
+}
+
+GST_END_TEST;
+
+/* an RGBA buffer of @width x @height wrapping a different colour for every
+ * pixel */
+static GstBuffer *
+_make_rgba_buffer (gint width, gint height, guint8 * data, gint * ref_count)
+{
+  GstGLMemory *mem[GST_VIDEO_MAX_PLANES] = { 0 };
+  gpointer planes[GST_VIDEO_MAX_PLANES] = { data, };
+  GstVideoInfo info;
+  GstBuffer *buf;
+  gint i;
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_RGBA, width, height);
+  for (i = 0; i < width * height; i++) {
+    data[4 * i + 0] = i;
+    data[4 * i + 1] = 2 * i + 1;
+    data[4 * i + 2] = 255 - 3 * i;
+    data[4 * i + 3] = 0xff;
+  }
+
+  *ref_count += 1;
+  buf = gst_buffer_new ();
+  fail_unless (gst_gl_memory_setup_wrapped (context, &info, NULL, planes, mem,
+          ref_count, _frame_unref));
+  gst_buffer_append_memory (buf, (GstMemory *) mem[0]);
+
+  return buf;
+}
+
+/* converts @inbuf to BGRA and checks every pixel of the result */
+static void
+_check_bgra_conversion (GstGLColorConvert * conv, GstBuffer * inbuf,
+    gint width, gint height, const guint8 * data)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstBuffer *outbuf;
+  gint x, y;
+
+  outbuf = gst_gl_color_convert_perform (conv, inbuf);
+  fail_unless (outbuf != NULL);
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_BGRA, width, height);
+  fail_unless (gst_video_frame_map (&frame, &info, outbuf, GST_MAP_READ));
+  for (y = 0; y < height; y++) {
+    const guint8 *line = (const guint8 *) GST_VIDEO_FRAME_PLANE_DATA (&frame,
+        0) + y * GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0);
+
+    for (x = 0; x < width; x++) {
+      const guint8 *in = data + 4 * (y * width + x);
+
+      fail_unless_equals_int (line[4 * x + 0], in[2]);
+      fail_unless_equals_int (line[4 * x + 1], in[1]);
+      fail_unless_equals_int (line[4 * x + 2], in[0]);
+      fail_unless_equals_int (line[4 * x + 3], in[3]);
+    }
+  }
+  gst_video_frame_unmap (&frame);
+  gst_buffer_unref (outbuf);
+}
+
+static void
+_set_rgba_to_bgra_caps (GstGLColorConvert * conv, gint width, gint height)
+{
+  GstVideoInfo info;
+  GstCaps *in_caps, *out_caps;
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_RGBA, width, height);
+  in_caps = gst_video_info_to_caps (&info);
+  gst_caps_set_features (in_caps, 0,
+      gst_caps_features_from_string (GST_CAPS_FEATURE_MEMORY_GL_MEMORY));
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_BGRA, width, height);
+  out_caps = gst_video_info_to_caps (&info);
+  gst_caps_set_features (out_caps, 0,
+      gst_caps_features_from_string (GST_CAPS_FEATURE_MEMORY_GL_MEMORY));
+
+  fail_unless (gst_gl_color_convert_set_caps (conv, in_caps, out_caps));
+
+  gst_caps_unref (in_caps);
+  gst_caps_unref (out_caps);
+}
+
+GST_START_TEST (test_shared_program_output)
+{
+  GstGLColorConvert *convert2;
+  GstBuffer *inbuf1, *inbuf2;
+  guint8 data1[4 * 4 * 4], data2[8 * 2 * 4];
+  gint ref_count = 0, i;
+
+  inbuf1 = _make_rgba_buffer (4, 4, data1, &ref_count);
+  inbuf2 = _make_rgba_buffer (8, 2, data2, &ref_count);
+
+  /* both converters use the same program with their own sizes, whose
+   * uniforms have to be set again for every draw */
+  convert2 = gst_gl_color_convert_new (context);
+  _set_rgba_to_bgra_caps (convert, 4, 4);
+  _set_rgba_to_bgra_caps (convert2, 8, 2);
+
+  for (i = 0; i < 3; i++) {
+    _check_bgra_conversion (convert, inbuf1, 4, 4, data1);
+    _check_bgra_conversion (convert2, inbuf2, 8, 2, data2);
+  }
+
+  fail_unless_equals_int (_get_stat ("programs"), 1);
+  fail_unless_equals_int (_get_stat ("program-hits"), 1);
+
+  gst_object_unref (convert2);
+  gst_buffer_unref (inbuf1);
+  gst_buffer_unref (inbuf2);
+  fail_unless_equals_int (ref_count, 0);
+}
+
+GST_END_TEST;
+
+static void
+_buffer_finalized (gpointer user_data, GstMiniObject * obj)
+{
+  *(gboolean *) user_data = TRUE;
+}
+
+/* compares the Y, U and V components of two frames of any layout */
+static void
+_check_yuv_components (GstVideoFrame * a, GstVideoFrame * b)
+{
+  gint c, y;
+
+  for (c = 0; c < 3; c++) {
+    gint width = GST_VIDEO_FRAME_COMP_WIDTH (a, c);
+    gint height = GST_VIDEO_FRAME_COMP_HEIGHT (a, c);
+
+    for (y = 0; y < height; y++) {
+      const guint8 *la = (const guint8 *) GST_VIDEO_FRAME_COMP_DATA (a, c)
+          + y * GST_VIDEO_FRAME_COMP_STRIDE (a, c);
+      const guint8 *lb = (const guint8 *) GST_VIDEO_FRAME_COMP_DATA (b, c)
+          + y * GST_VIDEO_FRAME_COMP_STRIDE (b, c);
+
+      fail_unless (memcmp (la, lb, width) == 0);
+    }
+  }
+}
+
+GST_START_TEST (test_yv12_pool_buffers)
+{
+  GstGLColorConvert *convert2;
+  GstCaps *in_caps, *yv12_caps, *i420_caps;
+  GstVideoInfo yv12_info, i420_info;
+  GstVideoFrame yv12_frame, i420_frame;
+  GstBuffer *inbuf, *yv12, *i420, *outbuf;
+  guint8 data[16 * 16 * 4];
+  gint ref_count = 0;
+  gboolean finalized = FALSE;
+
+  in_caps = _gl_caps (GST_VIDEO_FORMAT_RGBA);
+  yv12_caps = _gl_caps (GST_VIDEO_FORMAT_YV12);
+  i420_caps = _gl_caps (GST_VIDEO_FORMAT_I420);
+  fail_unless (gst_video_info_from_caps (&yv12_info, yv12_caps));
+  fail_unless (gst_video_info_from_caps (&i420_info, i420_caps));
+  inbuf = _make_rgba_buffer (16, 16, data, &ref_count);
+
+  convert2 = gst_gl_color_convert_new (context);
+  fail_unless (gst_gl_color_convert_set_caps (convert, in_caps, yv12_caps));
+  fail_unless (gst_gl_color_convert_set_caps (convert2, in_caps, i420_caps));
+
+  /* YV12 carries the same components as I420, with the chroma planes
+   * swapped */
+  yv12 = gst_gl_color_convert_perform (convert, inbuf);
+  fail_unless (yv12 != NULL);
+  i420 = gst_gl_color_convert_perform (convert2, inbuf);
+  fail_unless (i420 != NULL);
+  fail_unless (gst_video_frame_map (&yv12_frame, &yv12_info, yv12,
+          GST_MAP_READ));
+  fail_unless (gst_video_frame_map (&i420_frame, &i420_info, i420,
+          GST_MAP_READ));
+  _check_yuv_components (&yv12_frame, &i420_frame);
+  gst_video_frame_unmap (&yv12_frame);
+  gst_video_frame_unmap (&i420_frame);
+  gst_buffer_unref (i420);
+
+  /* the YV12 output goes back to the pool untouched and is handed out
+   * again for the next frame */
+  gst_mini_object_weak_ref (GST_MINI_OBJECT (yv12), _buffer_finalized,
+      &finalized);
+  gst_buffer_unref (yv12);
+  fail_if (finalized);
+  outbuf = gst_gl_color_convert_perform (convert, inbuf);
+  fail_unless (outbuf == yv12);
+  gst_mini_object_weak_unref (GST_MINI_OBJECT (outbuf), _buffer_finalized,
+      &finalized);
+  gst_buffer_unref (outbuf);
+
+  gst_object_unref (convert2);
+  gst_buffer_unref (inbuf);
+  gst_caps_unref (in_caps);
+  gst_caps_unref (yv12_caps);
+  gst_caps_unref (i420_caps);
+  fail_unless_equals_int (ref_count, 0);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_gl_color_convert_suite (void)
 {
@@ -238,6 +526,9 @@ gst_gl_color_convert_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_checked_fixture (tc_chain, setup, teardown);
   tcase_add_test (tc_chain, test_reorder_buffer);
+  tcase_add_test (tc_chain, test_shared_resources);
+  tcase_add_test (tc_chain, test_shared_program_output);
+  tcase_add_test (tc_chain, test_yv12_pool_buffers);
   /* FIXME add YUV <--> RGB conversion tests */
 
   return s;
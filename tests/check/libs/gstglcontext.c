@@ -485,6 +485,119 @@ GST_START_TEST (test_context_can_share)
 
 GST_END_TEST;
 
+#define N_QUEUED 16
+
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  gboolean blocked;
+  gint order[N_QUEUED];
+  gint n_run;
+  gint n_notified;
+} QueueData;
+
+static void
+_block_queue (GstGLContext * context, QueueData * data)
+{
+  g_mutex_lock (&data->lock);
+  while (data->blocked)
+    g_cond_wait (&data->cond, &data->lock);
+  g_mutex_unlock (&data->lock);
+}
+
+static void
+_run_queued (GstGLContext * context, QueueData * data)
+{
+  fail_unless (gst_gl_context_get_current () == context);
+  data->order[data->n_run] = data->n_run;
+  data->n_run++;
+}
+
+static void
+_notify_queued (QueueData * data)
+{
+  data->n_notified++;
+}
+
+static void
+_check_queued (GstGLContext * context, QueueData * data)
+{
+  /* everything queued before has run */
+  fail_unless_equals_int (data->n_run, N_QUEUED);
+}
+
+static guint64
+_get_thread_stat (GstGLContext * context, const gchar * name)
+{
+  GstStructure *stats = gst_gl_context_get_thread_stats (context);
+  guint64 val = 0;
+
+  fail_unless (gst_structure_get_uint64 (stats, name, &val));
+  gst_structure_free (stats);
+
+  return val;
+}
+
+GST_START_TEST (test_thread_add_async)
+{
+  GstGLContext *context;
+  GError *error = NULL;
+  QueueData data = { {0,}, };
+  guint64 serial = 0, round_trips;
+  gint i;
+
+  context = gst_gl_context_new (display);
+  gst_gl_context_create (context, NULL, &error);
+  fail_if (error != NULL, "Error creating context %s\n",
+      error ? error->message : "Unknown Error");
+
+  g_mutex_init (&data.lock);
+  g_cond_init (&data.cond);
+  round_trips = _get_thread_stat (context, "round-trips");
+
+  /* keep the gl thread busy so that everything after ends up in one batch */
+  data.blocked = TRUE;
+  gst_gl_context_thread_add_async (context,
+      (GstGLContextThreadFunc) _block_queue, &data, NULL);
+
+  for (i = 0; i < N_QUEUED; i++)
+    serial = gst_gl_context_thread_add_async (context,
+        (GstGLContextThreadFunc) _run_queued, &data,
+        (GDestroyNotify) _notify_queued);
+
+  g_mutex_lock (&data.lock);
+  data.blocked = FALSE;
+  g_cond_signal (&data.cond);
+  g_mutex_unlock (&data.lock);
+
+  gst_gl_context_thread_wait (context, serial);
+  fail_unless_equals_int (data.n_run, N_QUEUED);
+  fail_unless_equals_int (data.n_notified, N_QUEUED);
+  for (i = 0; i < N_QUEUED; i++)
+    fail_unless_equals_int (data.order[i], i);
+
+  fail_unless_equals_int (_get_thread_stat (context, "async"), N_QUEUED + 1);
+  fail_unless_equals_int (_get_thread_stat (context, "batches"), 1);
+  fail_unless_equals_int (_get_thread_stat (context, "round-trips"),
+      round_trips);
+
+  /* a synchronous call runs after the queued ones */
+  data.n_run = N_QUEUED - 1;
+  gst_gl_context_thread_add_async (context,
+      (GstGLContextThreadFunc) _run_queued, &data, NULL);
+  gst_gl_context_thread_add (context,
+      (GstGLContextThreadFunc) _check_queued, &data);
+  fail_unless_equals_int (_get_thread_stat (context, "round-trips"),
+      round_trips + 1);
+
+  g_mutex_clear (&data.lock);
+  g_cond_clear (&data.cond);
+  gst_object_unref (context);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_gl_context_suite (void)
 {
@@ -497,6 +610,7 @@ gst_gl_context_suite (void)
   tcase_add_test (tc_chain, test_wrapped_context);
   tcase_add_test (tc_chain, test_current_context);
   tcase_add_test (tc_chain, test_context_can_share);
+  tcase_add_test (tc_chain, test_thread_add_async);
 
   return s;
 }
@@ -0,0 +1,206 @@
+/* GStreamer
+ *
+ * unit test for GstGLShader
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+
+#include <gst/gl/gl.h>
+
+#include <glib/gstdio.h>
+
+static GstGLDisplay *display;
+static GstGLContext *context;
+static gchar *cache_dir;
+
+/* *INDENT-OFF* */
+static const gchar *fragment_src =
+    "#ifdef GL_ES\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "varying vec2 v_texcoord;\n"
+    "uniform sampler2D tex;\n"
+    "uniform float alpha;\n"
+    "void main()\n"
+    "{\n"
+    "  gl_FragColor = texture2D(tex, v_texcoord) * alpha;\n"
+    "}";
+/* *INDENT-ON* */
+
+static void
+setup (void)
+{
+  GError *error = NULL;
+
+  display = gst_gl_display_new ();
+  context = gst_gl_context_new (display);
+
+  gst_gl_context_create (context, 0, &error);
+
+  fail_if (error != NULL, "Error creating context: %s\n",
+      error ? error->message : "Unknown Error");
+}
+
+static void
+teardown (void)
+{
+  GDir *dir = g_dir_open (cache_dir, 0, NULL);
+  const gchar *name;
+
+  gst_object_unref (context);
+  gst_object_unref (display);
+
+  while (dir && (name = g_dir_read_name (dir))) {
+    gchar *filename = g_build_filename (cache_dir, name, NULL);
+
+    g_remove (filename);
+    g_free (filename);
+  }
+  if (dir)
+    g_dir_close (dir);
+  g_rmdir (cache_dir);
+}
+
+typedef struct
+{
+  GstGLShader *shader;
+  gboolean compiled;
+  GLint pos_loc, tex_loc;
+  GLfloat alpha;
+  GLenum error;
+} ShaderData;
+
+static void
+_compile_shader (GstGLContext * context, ShaderData * data)
+{
+  data->shader = gst_gl_shader_new (context);
+  data->compiled =
+      gst_gl_shader_compile_with_default_v_and_check (data->shader,
+      fragment_src, &data->pos_loc, &data->tex_loc);
+}
+
+static void
+_set_uniforms (GstGLContext * context, ShaderData * data)
+{
+  const GstGLFuncs *gl = context->gl_vtable;
+  GLuint program = gst_gl_shader_get_program_handle (data->shader);
+  gint i;
+
+  gst_gl_shader_use (data->shader);
+  for (i = 0; i < 3; i++) {
+    gst_gl_shader_set_uniform_1i (data->shader, "tex", 0);
+    /* a different value each time, set through the cached location */
+    gst_gl_shader_set_uniform_1f (data->shader, "alpha", 0.25 * (i + 1));
+    /* not in the program, which is not an error */
+    gst_gl_shader_set_uniform_1f (data->shader, "unknown", 1.0);
+
+    fail_unless_equals_int (gst_gl_shader_get_attribute_location
+        (data->shader, "a_position"), data->pos_loc);
+  }
+
+  gl->GetUniformfv (program, gl->GetUniformLocation (program, "alpha"),
+      &data->alpha);
+  gst_gl_context_clear_shader (context);
+
+  data->error = context->gl_vtable->GetError ();
+}
+
+GST_START_TEST (test_uniforms)
+{
+  ShaderData data = { NULL, };
+
+  gst_gl_context_thread_add (context,
+      (GstGLContextThreadFunc) _compile_shader, &data);
+  fail_unless (data.compiled);
+  fail_unless (data.pos_loc >= 0);
+  fail_unless (data.tex_loc >= 0);
+
+  gst_gl_context_thread_add (context,
+      (GstGLContextThreadFunc) _set_uniforms, &data);
+  fail_unless_equals_int (data.error, GL_NONE);
+  /* the last value set ended up in the program */
+  fail_unless (data.alpha == 0.75f);
+
+  gst_object_unref (data.shader);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_program_cache)
+{
+  ShaderData first = { NULL, };
+  ShaderData second = { NULL, };
+  const gchar *name;
+  GDir *dir;
+  guint n_files = 0;
+
+  gst_gl_context_thread_add (context,
+      (GstGLContextThreadFunc) _compile_shader, &first);
+  fail_unless (first.compiled);
+
+  /* the same sources again, which may come from the cache */
+  gst_gl_context_thread_add (context,
+      (GstGLContextThreadFunc) _compile_shader, &second);
+  fail_unless (second.compiled);
+  fail_unless_equals_int (second.pos_loc, first.pos_loc);
+  fail_unless_equals_int (second.tex_loc, first.tex_loc);
+
+  gst_gl_context_thread_add (context,
+      (GstGLContextThreadFunc) _set_uniforms, &second);
+  fail_unless_equals_int (second.error, GL_NONE);
+
+  /* at most one binary, and none if the driver has no binary formats */
+  dir = g_dir_open (cache_dir, 0, NULL);
+  while (dir && (name = g_dir_read_name (dir))) {
+    fail_unless (g_str_has_suffix (name, ".bin"));
+    n_files++;
+  }
+  if (dir)
+    g_dir_close (dir);
+  fail_unless (n_files <= 1);
+
+  gst_object_unref (first.shader);
+  gst_object_unref (second.shader);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_gl_shader_suite (void)
+{
+  Suite *s = suite_create ("GstGLShader");
+  TCase *tc_chain = tcase_create ("shader");
+
+  /* read on the first compile, which creates the directory */
+  cache_dir = g_build_filename (g_get_tmp_dir (), "glshader-cache", NULL);
+  g_setenv ("GST_GL_SHADER_CACHE_DIR", cache_dir, TRUE);
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_checked_fixture (tc_chain, setup, teardown);
+  tcase_add_test (tc_chain, test_uniforms);
+  tcase_add_test (tc_chain, test_program_cache);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_gl_shader);
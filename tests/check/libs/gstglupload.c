@@ -18,6 +18,10 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#ifndef _GNU_SOURCE
+#  define _GNU_SOURCE           /* for memfd_create () */
+#endif
+
 #ifdef HAVE_CONFIG_H
 #  include "config.h"
 #endif
@@ -29,6 +33,20 @@
 
 #include <stdio.h>
 
+#if GST_GL_HAVE_DMABUF
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <gst/gl/egl/gsteglimagememory.h>
+#ifdef HAVE_LINUX_UDMABUF_H
+#define TEST_DMABUF 1
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/udmabuf.h>
+#include <gst/allocators/gstdmabuf.h>
+#endif
+#endif
+
 #if GST_GL_HAVE_GLES2
 /* *INDENT-OFF* */
 static const gchar *vertex_shader_str_gles2 =
@@ -381,6 +399,215 @@ GST_START_TEST (test_upload_meta_producer)
 GST_END_TEST;
 
 
+#ifdef TEST_DMABUF
+/* a dmabuf backed by a memfd, so the test can run without a GPU */
+static gint
+create_udmabuf (gsize size, gint * memfd)
+{
+  struct udmabuf_create create = { 0, };
+  gint dev, fd;
+
+  dev = open ("/dev/udmabuf", O_RDWR);
+  if (dev < 0)
+    return -1;
+
+  *memfd = memfd_create ("gstglupload", MFD_ALLOW_SEALING);
+  if (*memfd < 0) {
+    close (dev);
+    return -1;
+  }
+
+  fail_unless (ftruncate (*memfd, size) == 0);
+  fail_unless (fcntl (*memfd, F_ADD_SEALS, F_SEAL_SHRINK) == 0);
+
+  create.memfd = *memfd;
+  create.size = size;
+  fd = ioctl (dev, UDMABUF_CREATE, &create);
+  close (dev);
+
+  if (fd < 0)
+    close (*memfd);
+
+  return fd;
+}
+
+static guint
+upload_dmabuf (GstBuffer * buffer, const gchar * expected)
+{
+  GstBuffer *outbuf;
+  GstMemory *mem;
+  GstMapInfo map_info;
+  guint tex;
+  gboolean res;
+
+  res = gst_gl_upload_perform_with_buffer (upload, buffer, &outbuf);
+  fail_if (res == FALSE, "Failed to upload buffer: %s\n",
+      gst_gl_context_get_error ());
+
+  mem = gst_buffer_peek_memory (outbuf, 0);
+  fail_unless (gst_is_gl_memory (mem));
+
+  fail_unless (gst_memory_map (mem, &map_info, GST_MAP_READ | GST_MAP_GL));
+  tex = *(guint *) map_info.data;
+  gst_memory_unmap (mem, &map_info);
+
+  fail_unless (gst_memory_map (mem, &map_info, GST_MAP_READ));
+  fail_unless (memcmp (map_info.data, expected, WIDTH * HEIGHT * 4) == 0);
+  gst_memory_unmap (mem, &map_info);
+
+  gst_gl_upload_release_buffer (upload);
+  gst_buffer_unref (outbuf);
+
+  return tex;
+}
+
+GST_START_TEST (test_upload_dmabuf)
+{
+  GstCaps *in_caps, *out_caps;
+  GstAllocator *allocator;
+  GstVideoInfo in_info;
+  GstBuffer *buffer;
+  gchar blue_data[WIDTH * HEIGHT * 4];
+  gsize size;
+  gint fd, memfd, i;
+  guint tex1, tex2;
+
+  if (!gst_gl_context_check_feature (context, "EGL_EXT_image_dma_buf_import")) {
+    GST_INFO ("dmabuf import is not supported, skipping");
+    return;
+  }
+
+  size = GST_ROUND_UP_N (WIDTH * HEIGHT * 4, 4096);
+  fd = create_udmabuf (size, &memfd);
+  if (fd < 0) {
+    GST_INFO ("cannot create a udmabuf, skipping");
+    return;
+  }
+  fail_unless (pwrite (memfd, rgba_data, sizeof (rgba_data), 0) ==
+      sizeof (rgba_data));
+
+  in_caps = gst_caps_from_string ("video/x-raw,format=RGBA,"
+      "width=10,height=10");
+  out_caps = gst_caps_from_string ("video/x-raw(memory:GLMemory),"
+      "format=RGBA,width=10,height=10");
+  gst_video_info_from_caps (&in_info, in_caps);
+  gst_gl_upload_set_caps (upload, in_caps, out_caps);
+
+  allocator = gst_dmabuf_allocator_new ();
+  buffer = gst_buffer_new ();
+  gst_buffer_append_memory (buffer, gst_dmabuf_allocator_alloc (allocator, fd,
+          size));
+  gst_buffer_add_video_meta_full (buffer, 0, GST_VIDEO_FORMAT_RGBA, WIDTH,
+      HEIGHT, 1, in_info.offset, in_info.stride);
+
+  tex1 = upload_dmabuf (buffer, rgba_data);
+
+  /* the texture shares its storage with the dmabuf, new contents show up
+   * without another import */
+  for (i = 0; i < WIDTH * HEIGHT; i++) {
+    const guint8 blue[] = { BLUE };
+    memcpy (&blue_data[i * 4], blue, 4);
+  }
+  fail_unless (pwrite (memfd, blue_data, sizeof (blue_data), 0) ==
+      sizeof (blue_data));
+
+  tex2 = upload_dmabuf (buffer, blue_data);
+  fail_unless_equals_int (tex1, tex2);
+
+  gst_buffer_unref (buffer);
+  gst_object_unref (allocator);
+  gst_caps_unref (in_caps);
+  gst_caps_unref (out_caps);
+  close (memfd);
+}
+
+GST_END_TEST;
+#endif
+
+#if GST_GL_HAVE_DMABUF
+struct ExportDmabuf
+{
+  GstGLMemory *gl_mem;
+  gint fd;
+  gint stride;
+  gsize offset;
+  gboolean result;
+};
+
+static void
+export_dmabuf_gl_thread (GstGLContext * context, struct ExportDmabuf *data)
+{
+  data->result = gst_egl_image_memory_export_dmabuf (data->gl_mem, &data->fd,
+      &data->stride, &data->offset);
+  if (data->result)
+    context->gl_vtable->Finish ();
+}
+
+GST_START_TEST (test_export_dmabuf)
+{
+  struct ExportDmabuf data = { NULL, -1, 0, 0, FALSE };
+  GstCaps *in_caps, *out_caps;
+  GstBuffer *inbuf, *outbuf;
+  GstMapInfo map_info;
+  guint8 *map;
+  gsize size;
+  gint y;
+
+  if (!gst_gl_context_check_feature (context,
+          "EGL_MESA_image_dma_buf_export")) {
+    GST_INFO ("dmabuf export is not supported, skipping");
+    return;
+  }
+
+  in_caps = gst_caps_from_string ("video/x-raw,format=RGBA,"
+      "width=10,height=10");
+  out_caps = gst_caps_from_string ("video/x-raw(memory:GLMemory),"
+      "format=RGBA,width=10,height=10");
+  gst_gl_upload_set_caps (upload, in_caps, out_caps);
+
+  inbuf = gst_buffer_new_wrapped_full (0, rgba_data, WIDTH * HEIGHT * 4,
+      0, WIDTH * HEIGHT * 4, NULL, NULL);
+  fail_unless (gst_gl_upload_perform_with_buffer (upload, inbuf, &outbuf));
+
+  /* makes sure the texture holds the data */
+  data.gl_mem = (GstGLMemory *) gst_buffer_peek_memory (outbuf, 0);
+  fail_unless (gst_is_gl_memory ((GstMemory *) data.gl_mem));
+  fail_unless (gst_memory_map ((GstMemory *) data.gl_mem, &map_info,
+          GST_MAP_READ | GST_MAP_GL));
+  gst_memory_unmap ((GstMemory *) data.gl_mem, &map_info);
+
+  gst_gl_context_thread_add (context,
+      (GstGLContextThreadFunc) export_dmabuf_gl_thread, &data);
+
+  /* drivers are free to lay the texture out in tiles, which must not be
+   * exported */
+  if (!data.result) {
+    GST_INFO ("the texture is not linear, skipping");
+    goto done;
+  }
+
+  /* the dmabuf shares the storage of the texture */
+  fail_unless (data.fd >= 0);
+  fail_unless (data.stride >= WIDTH * 4);
+  size = data.offset + data.stride * HEIGHT;
+  map = mmap (NULL, size, PROT_READ, MAP_SHARED, data.fd, 0);
+  fail_unless (map != MAP_FAILED);
+  for (y = 0; y < HEIGHT; y++)
+    fail_unless (memcmp (map + data.offset + y * data.stride,
+            &rgba_data[y * WIDTH * 4], WIDTH * 4) == 0);
+  munmap (map, size);
+  close (data.fd);
+
+done:
+  gst_buffer_unref (inbuf);
+  gst_buffer_unref (outbuf);
+  gst_caps_unref (in_caps);
+  gst_caps_unref (out_caps);
+}
+
+GST_END_TEST;
+#endif
+
 static Suite *
 gst_gl_upload_suite (void)
 {
@@ -392,6 +619,12 @@ gst_gl_upload_suite (void)
   tcase_add_test (tc_chain, test_upload_data);
   tcase_add_test (tc_chain, test_upload_buffer);
   tcase_add_test (tc_chain, test_upload_meta_producer);
+#ifdef TEST_DMABUF
+  tcase_add_test (tc_chain, test_upload_dmabuf);
+#endif
+#if GST_GL_HAVE_DMABUF
+  tcase_add_test (tc_chain, test_export_dmabuf);
+#endif
 
   return s;
 }
@@ -0,0 +1,262 @@
+/* GStreamer
+ *
+ * unit test for the video frame statistics kernels and meta
+ * Copyright (C) 2016 Renesas Electronics Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/video/gstvideoframestats.h>
+
+#define WIDTH 723
+#define HEIGHT 67
+#define STRIDE 736
+
+static guint8 *
+make_plane (guint32 seed)
+{
+  GRand *rand = g_rand_new_with_seed (seed);
+  guint8 *plane = g_malloc (STRIDE * HEIGHT);
+  gint i;
+
+  for (i = 0; i < STRIDE * HEIGHT; i++)
+    plane[i] = g_rand_int_range (rand, 0, 256);
+  g_rand_free (rand);
+
+  return plane;
+}
+
+GST_START_TEST (test_sad_ssd)
+{
+  guint8 *p1 = make_plane (1);
+  guint8 *p2 = make_plane (2);
+  guint64 sad = 0, ssd = 0;
+  gint i, j;
+
+  for (j = 0; j < HEIGHT; j++) {
+    for (i = 0; i < WIDTH; i++) {
+      gint d = p1[j * STRIDE + i] - p2[j * STRIDE + i];
+      sad += ABS (d);
+      ssd += d * d;
+    }
+  }
+
+  fail_unless_equals_uint64 (gst_video_frame_stats_sad (p1, STRIDE, p2,
+          STRIDE, WIDTH, HEIGHT), sad);
+  fail_unless_equals_uint64 (gst_video_frame_stats_ssd (p1, STRIDE, p2,
+          STRIDE, WIDTH, HEIGHT), ssd);
+  fail_unless_equals_uint64 (gst_video_frame_stats_sad (p1, STRIDE, p1,
+          STRIDE, WIDTH, HEIGHT), 0);
+
+  g_free (p1);
+  g_free (p2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_comb)
+{
+  guint8 *p = make_plane (3);
+  guint8 mask[WIDTH];
+  gint runs[WIDTH], ref_runs[WIDTH];
+  guint score = 0, ref_score = 0;
+  gint i, j;
+
+  /* a combed area on top of the noise */
+  for (j = 10; j < 40; j++)
+    for (i = 100; i < 400; i++)
+      p[j * STRIDE + i] = (j & 1) ? 235 : 16;
+
+  memset (runs, 0, sizeof (runs));
+  memset (ref_runs, 0, sizeof (ref_runs));
+
+  for (j = 1; j < HEIGHT - 1; j++) {
+    const guint8 *s1 = p + (j - 1) * STRIDE;
+    const guint8 *s2 = p + j * STRIDE;
+    const guint8 *s3 = p + (j + 1) * STRIDE;
+
+    gst_video_frame_stats_comb_mask (mask, s1, s2, s3, WIDTH, 5);
+    for (i = 0; i < WIDTH; i++) {
+      gboolean combed = s2[i] < MIN (s1[i], s3[i]) - 5 ||
+          s2[i] > MAX (s1[i], s3[i]) + 5;
+      fail_unless_equals_int (mask[i], combed ? 0xff : 0);
+
+      if (combed) {
+        if (i > 0)
+          ref_runs[i] += ref_runs[i - 1];
+        ref_runs[i]++;
+        if (ref_runs[i] > 1000)
+          ref_runs[i] = 1000;
+      } else {
+        ref_runs[i] = 0;
+      }
+      if (ref_runs[i] > 100)
+        ref_score++;
+    }
+    score += gst_video_frame_stats_comb_runs (runs, mask, WIDTH);
+  }
+
+  fail_unless (ref_score > 0);
+  fail_unless_equals_int (score, ref_score);
+
+  g_free (p);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_histogram)
+{
+  guint8 *p = make_plane (4);
+  guint32 hist[GST_VIDEO_FRAME_STATS_HISTOGRAM_BINS];
+  guint32 ref[GST_VIDEO_FRAME_STATS_HISTOGRAM_BINS];
+  gint i, j;
+
+  memset (ref, 0, sizeof (ref));
+  for (j = 0; j < HEIGHT; j++)
+    for (i = 0; i < WIDTH; i++)
+      ref[p[j * STRIDE + i]]++;
+
+  gst_video_frame_stats_histogram (hist, p, STRIDE, WIDTH, HEIGHT);
+  for (i = 0; i < GST_VIDEO_FRAME_STATS_HISTOGRAM_BINS; i++)
+    fail_unless_equals_int (hist[i], ref[i]);
+
+  g_free (p);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_meta)
+{
+  GstBuffer *buffer, *copy;
+  GstVideoFrameStatsMeta *meta;
+
+  buffer = gst_buffer_new_allocate (NULL, 64, NULL);
+  fail_unless (gst_buffer_get_video_frame_stats_meta (buffer) == NULL);
+
+  meta = gst_buffer_add_video_frame_stats_meta (buffer);
+  fail_unless (meta != NULL);
+  fail_unless_equals_int (meta->flags, GST_VIDEO_FRAME_STATS_NONE);
+  fail_unless (meta->reference_pts == GST_CLOCK_TIME_NONE);
+
+  meta->flags = GST_VIDEO_FRAME_STATS_SAD | GST_VIDEO_FRAME_STATS_COMB;
+  meta->reference_pts = 40 * GST_MSECOND;
+  meta->sad = 12345;
+  meta->comb_score = 17;
+
+  copy = gst_buffer_copy (buffer);
+  meta = gst_buffer_get_video_frame_stats_meta (copy);
+  fail_unless (meta != NULL);
+  fail_unless_equals_int (meta->flags,
+      GST_VIDEO_FRAME_STATS_SAD | GST_VIDEO_FRAME_STATS_COMB);
+  fail_unless_equals_uint64 (meta->reference_pts, 40 * GST_MSECOND);
+  fail_unless_equals_uint64 (meta->sad, 12345);
+  fail_unless_equals_int (meta->comb_score, 17);
+  gst_buffer_unref (copy);
+
+  /* statistics don't describe a part of the frame */
+  copy = gst_buffer_copy_region (buffer, GST_BUFFER_COPY_ALL, 0, 32);
+  fail_unless (gst_buffer_get_video_frame_stats_meta (copy) == NULL);
+  gst_buffer_unref (copy);
+
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+#define BENCH_WIDTH 1920
+#define BENCH_HEIGHT 1080
+#define BENCH_LOOPS 10
+
+#define BENCH(name, code) G_STMT_START { \
+  gint64 start = g_get_monotonic_time (); \
+  gint n; \
+  for (n = 0; n < BENCH_LOOPS; n++) { \
+    code; \
+  } \
+  GST_INFO ("%s: %" G_GINT64_FORMAT " us/frame", name, \
+      (g_get_monotonic_time () - start) / BENCH_LOOPS); \
+} G_STMT_END
+
+static guint
+comb_score (const guint8 * p, guint8 * mask, gint * runs)
+{
+  guint score = 0;
+  gint j;
+
+  for (j = 1; j < BENCH_HEIGHT - 1; j++) {
+    gst_video_frame_stats_comb_mask (mask, p + (j - 1) * BENCH_WIDTH,
+        p + j * BENCH_WIDTH, p + (j + 1) * BENCH_WIDTH, BENCH_WIDTH, 5);
+    score += gst_video_frame_stats_comb_runs (runs, mask, BENCH_WIDTH);
+  }
+
+  return score;
+}
+
+GST_START_TEST (test_benchmark)
+{
+  guint8 *p1 = g_malloc0 (BENCH_WIDTH * BENCH_HEIGHT);
+  guint8 *p2 = g_malloc0 (BENCH_WIDTH * BENCH_HEIGHT);
+  guint8 *mask = g_malloc (BENCH_WIDTH);
+  gint *runs = g_new0 (gint, BENCH_WIDTH);
+  guint32 hist[GST_VIDEO_FRAME_STATS_HISTOGRAM_BINS];
+  guint64 res = 0;
+
+  BENCH ("sad", res += gst_video_frame_stats_sad (p1, BENCH_WIDTH, p2,
+          BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT));
+  BENCH ("ssd", res += gst_video_frame_stats_ssd (p1, BENCH_WIDTH, p2,
+          BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT));
+  BENCH ("comb", res += comb_score (p1, mask, runs));
+  BENCH ("histogram", gst_video_frame_stats_histogram (hist, p1,
+          BENCH_WIDTH, BENCH_WIDTH, BENCH_HEIGHT));
+
+  /* all planes are black */
+  fail_unless_equals_uint64 (res, 0);
+  fail_unless_equals_int (hist[0], BENCH_WIDTH * BENCH_HEIGHT);
+
+  g_free (p1);
+  g_free (p2);
+  g_free (mask);
+  g_free (runs);
+}
+
+GST_END_TEST;
+
+static Suite *
+videoframestats_suite (void)
+{
+  Suite *s = suite_create ("Video frame statistics library");
+
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_sad_ssd);
+  tcase_add_test (tc_chain, test_comb);
+  tcase_add_test (tc_chain, test_histogram);
+  tcase_add_test (tc_chain, test_meta);
+  tcase_add_test (tc_chain, test_benchmark);
+
+  return s;
+}
+
+GST_CHECK_MAIN (videoframestats);